@@ -0,0 +1,272 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2013-2017 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "BenchmarkSupport.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <list>
+#include <sstream>
+#include <vector>
+
+#include <QtCore/QDateTime>
+#include <QtCore/QString>
+#include <QtCore/QThread>
+
+#include "Global/FStreamsSupport.h"
+
+NATRON_NAMESPACE_ENTER;
+
+// Keep growing the iterations count of a benchmark until its measurement loop runs
+// at least this amount of time, in seconds
+#define NATRON_BENCHMARK_MIN_TIME 0.5
+
+// Never run more iterations than this, so a benchmark with a very cheap workload
+// still terminates
+#define NATRON_BENCHMARK_MAX_ITERATIONS 1000000000ULL
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+struct RegisteredBenchmark
+{
+    std::string name;
+    BenchmarkFunc func;
+};
+
+struct BenchmarkResult
+{
+    std::string name;
+    unsigned long long iterations;
+    double totalTime;
+
+    // Time of one iteration, in seconds
+    double timePerIteration;
+
+    // 0 if the benchmark did not call setItemsProcessed()
+    double itemsPerSecond;
+};
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+// The registrars run from static initializers: use a function local static so the list
+// is constructed before the first one registers itself
+static std::list<RegisteredBenchmark>&
+getBenchmarksRegistry()
+{
+    static std::list<RegisteredBenchmark> registry;
+
+    return registry;
+}
+
+BenchmarkState::BenchmarkState(unsigned long long maxIterations)
+: _maxIterations(maxIterations)
+, _iterationsDone(0)
+, _itemsProcessed(0)
+, _startTimeStamp()
+, _timeElapsed(0)
+{
+}
+
+bool
+BenchmarkState::keepRunning()
+{
+    if (_iterationsDone == 0) {
+        _startTimeStamp = getTimestampInSeconds();
+    }
+    if (_iterationsDone == _maxIterations) {
+        _timeElapsed = getTimeElapsed( _startTimeStamp, getTimestampInSeconds(), getPerformanceFrequency() );
+
+        return false;
+    }
+    ++_iterationsDone;
+
+    return true;
+}
+
+void
+BenchmarkState::setItemsProcessed(unsigned long long nItems)
+{
+    _itemsProcessed = nItems;
+}
+
+unsigned long long
+BenchmarkState::getIterationsCount() const
+{
+    return _iterationsDone;
+}
+
+double
+BenchmarkState::getTimeElapsedSeconds() const
+{
+    return _timeElapsed;
+}
+
+unsigned long long
+BenchmarkState::getItemsProcessed() const
+{
+    return _itemsProcessed;
+}
+
+BenchmarkRegistrar::BenchmarkRegistrar(const std::string& name,
+                                       BenchmarkFunc func)
+{
+    RegisteredBenchmark b;
+
+    b.name = name;
+    b.func = func;
+    getBenchmarksRegistry().push_back(b);
+}
+
+static BenchmarkResult
+runOneBenchmark(const RegisteredBenchmark& benchmark)
+{
+    // Run with a growing number of iterations until the measurement is long enough
+    // to be significant
+    unsigned long long iterations = 1;
+    double totalTime = 0;
+    unsigned long long itemsProcessed = 0;
+
+    for (;;) {
+        BenchmarkState state(iterations);
+        benchmark.func(state);
+        assert(state.getIterationsCount() == iterations);
+        totalTime = state.getTimeElapsedSeconds();
+        itemsProcessed = state.getItemsProcessed();
+        if ( (totalTime >= NATRON_BENCHMARK_MIN_TIME) || (iterations >= NATRON_BENCHMARK_MAX_ITERATIONS) ) {
+            break;
+        }
+
+        // Estimate the iterations needed to reach the minimum time, with some margin
+        // since short runs under-estimate the per-iteration time
+        unsigned long long next;
+        if (totalTime <= 0) {
+            next = iterations * 100;
+        } else {
+            next = (unsigned long long)(iterations * (NATRON_BENCHMARK_MIN_TIME / totalTime) * 1.4) + 1;
+        }
+        iterations = std::min<unsigned long long>(std::max(next, iterations + 1), NATRON_BENCHMARK_MAX_ITERATIONS);
+    }
+
+    BenchmarkResult result;
+    result.name = benchmark.name;
+    result.iterations = iterations;
+    result.totalTime = totalTime;
+    result.timePerIteration = totalTime / iterations;
+    result.itemsPerSecond = (itemsProcessed > 0 && totalTime > 0) ? itemsProcessed / totalTime : 0;
+
+    return result;
+}
+
+static void
+printResult(const BenchmarkResult& result)
+{
+    std::cout << result.name << ": "
+              << QString::number(result.timePerIteration * 1.e9, 'f', 0).toStdString() << " ns/iter, "
+              << result.iterations << " iters";
+    if (result.itemsPerSecond > 0) {
+        std::cout << ", " << QString::number(result.itemsPerSecond / 1.e6, 'f', 2).toStdString() << " Mitems/s";
+    }
+    std::cout << std::endl;
+}
+
+static void
+writeResultsToJSONFile(const std::list<BenchmarkResult>& results,
+                       const std::string& filePath)
+{
+    FStreamsSupport::ofstream ofile;
+
+    FStreamsSupport::open(&ofile, filePath);
+    if (!ofile) {
+        std::cerr << "Failed to open " << filePath << std::endl;
+
+        return;
+    }
+
+    // Same overall layout as google-benchmark JSON reports, so existing tooling that
+    // tracks per-commit results can be pointed at these files
+    ofile << "{\n";
+    ofile << "  \"context\": {\n";
+    ofile << "    \"date\": \"" << QDateTime::currentDateTime().toString(Qt::ISODate).toStdString() << "\",\n";
+    ofile << "    \"num_cpus\": " << QThread::idealThreadCount() << "\n";
+    ofile << "  },\n";
+    ofile << "  \"benchmarks\": [\n";
+    for (std::list<BenchmarkResult>::const_iterator it = results.begin(); it != results.end(); ++it) {
+        if ( it != results.begin() ) {
+            ofile << ",\n";
+        }
+        ofile << "    {\n";
+        ofile << "      \"name\": \"" << it->name << "\",\n";
+        ofile << "      \"iterations\": " << it->iterations << ",\n";
+        ofile << "      \"real_time\": " << QString::number(it->timePerIteration * 1.e9, 'f', 3).toStdString() << ",\n";
+        ofile << "      \"time_unit\": \"ns\"";
+        if (it->itemsPerSecond > 0) {
+            ofile << ",\n      \"items_per_second\": " << QString::number(it->itemsPerSecond, 'f', 3).toStdString();
+        }
+        ofile << "\n    }";
+    }
+    ofile << "\n  ]\n";
+    ofile << "}\n";
+}
+
+int
+runBenchmarks(int argc,
+              char** argv)
+{
+    std::string filter, jsonFilePath;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg(argv[i]);
+        if ( (arg == "--filter") && (i + 1 < argc) ) {
+            filter = argv[++i];
+        } else if ( (arg == "--json") && (i + 1 < argc) ) {
+            jsonFilePath = argv[++i];
+        }
+    }
+
+    std::list<BenchmarkResult> results;
+    const std::list<RegisteredBenchmark>& registry = getBenchmarksRegistry();
+    for (std::list<RegisteredBenchmark>::const_iterator it = registry.begin(); it != registry.end(); ++it) {
+        if ( !filter.empty() && (it->name.find(filter) == std::string::npos) ) {
+            continue;
+        }
+        BenchmarkResult result = runOneBenchmark(*it);
+        printResult(result);
+        results.push_back(result);
+    }
+
+    if (results.empty()) {
+        std::cerr << "No benchmark matched" << std::endl;
+
+        return 1;
+    }
+
+    if ( !jsonFilePath.empty() ) {
+        writeResultsToJSONFile(results, jsonFilePath);
+    }
+
+    return 0;
+}
+
+NATRON_NAMESPACE_EXIT;
@@ -0,0 +1,113 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2013-2017 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef NATRON_BENCHMARKS_BENCHMARKSUPPORT_H
+#define NATRON_BENCHMARKS_BENCHMARKSUPPORT_H
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <string>
+
+#include "Engine/Timer.h"
+
+NATRON_NAMESPACE_ENTER;
+
+/**
+ * @brief Passed to each benchmark function to control its measurement loop.
+ * The body of the benchmark must be written as:
+ *
+ *     while ( state.keepRunning() ) {
+ *         // workload
+ *     }
+ *
+ * The timer starts at the first call to keepRunning() and stops when it returns false,
+ * so the setup code before the loop is not measured.
+ * The runner calls the benchmark function several times with a growing number of
+ * iterations until the measured time is large enough to be significant.
+ **/
+class BenchmarkState
+{
+public:
+
+    BenchmarkState(unsigned long long maxIterations);
+
+    bool keepRunning();
+
+    /**
+     * @brief May be called after the loop to report a throughput (e.g: in pixels
+     * per second) in addition to the per-iteration time.
+     **/
+    void setItemsProcessed(unsigned long long nItems);
+
+    /**
+     * @brief Returns the number of times keepRunning() returned true.
+     **/
+    unsigned long long getIterationsCount() const;
+
+    /**
+     * @brief Returns the time spent in the measurement loop in seconds.
+     * Only valid once keepRunning() has returned false.
+     **/
+    double getTimeElapsedSeconds() const;
+
+    unsigned long long getItemsProcessed() const;
+
+private:
+
+    unsigned long long _maxIterations;
+    unsigned long long _iterationsDone;
+    unsigned long long _itemsProcessed;
+    TimestampVal _startTimeStamp;
+    double _timeElapsed;
+};
+
+typedef void (*BenchmarkFunc)(BenchmarkState& state);
+
+/**
+ * @brief Registers a benchmark function so that runBenchmarks() picks it up.
+ * Use the NATRON_BENCHMARK macro instead of instantiating this directly.
+ **/
+struct BenchmarkRegistrar
+{
+    BenchmarkRegistrar(const std::string& name, BenchmarkFunc func);
+};
+
+// Benchmark translation units are expected to use NATRON_NAMESPACE_USING
+#define NATRON_BENCHMARK(func) \
+    static void func(BenchmarkState& state); \
+    static const BenchmarkRegistrar func ## _registrar(#func, func); \
+    static void func(BenchmarkState& state)
+
+/**
+ * @brief Runs all registered benchmarks and prints a report on the standard output.
+ * Understands the following arguments:
+ * --filter <substring>: only run the benchmarks whose name contains the sub-string
+ * --json <file>: also write the results as JSON, so successive runs can be compared per commit
+ * Returns 0 on success.
+ **/
+int runBenchmarks(int argc, char** argv);
+
+NATRON_NAMESPACE_EXIT;
+
+#endif // NATRON_BENCHMARKS_BENCHMARKSUPPORT_H
@@ -0,0 +1,49 @@
+# ***** BEGIN LICENSE BLOCK *****
+# This file is part of Natron <http://www.natron.fr/>,
+# Copyright (C) 2013-2017 INRIA and Alexandre Gauthier-Foichat
+#
+# Natron is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# Natron is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+# ***** END LICENSE BLOCK *****
+
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+# Cairo is still the default renderer for Roto
+!enable-osmesa {
+   CONFIG += enable-cairo
+}
+CONFIG += moc rcc
+CONFIG += boost opengl qt python shiboken pyside osmesa fontconfig
+enable-cairo: CONFIG += cairo
+CONFIG += static-yaml-cpp static-gui static-engine static-serialization static-host-support static-breakpadclient static-libmv static-openmvg static-ceres static-libtess
+QT += gui core opengl network
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets concurrent
+
+CONFIG += openmvg-flags glad-flags
+
+!noexpat: CONFIG += expat
+
+include(../global.pri)
+
+SOURCES += \
+    BenchmarkSupport.cpp \
+    Cache_Bench.cpp \
+    Curve_Bench.cpp \
+    Hash64_Bench.cpp \
+    ImageKernels_Bench.cpp \
+    Lut_Bench.cpp \
+    main.cpp
+
+HEADERS += \
+    BenchmarkSupport.h
@@ -0,0 +1,88 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2013-2017 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <string>
+#include <vector>
+
+#include <QtCore/QThread>
+#include <QFuture>
+#include <QtConcurrentRun> // QtCore on Qt4, QtConcurrent on Qt5
+
+#include "Engine/AppManager.h"
+#include "Engine/Cache.h"
+#include "Engine/EffectInstanceActionResults.h"
+#include "Engine/ImagePlaneDesc.h"
+#include "Engine/TimeValue.h"
+#include "Engine/ViewIdx.h"
+
+#include "BenchmarkSupport.h"
+
+NATRON_NAMESPACE_USING
+
+// Benchmark of the general purpose cache under contention: all hardware threads
+// concurrently get/insert small entries over a shared set of keys, the same pattern
+// as render threads looking up action results.
+
+// Number of get/insert operations each thread performs per iteration
+static const int kCacheOpsPerThread = 256;
+
+// Number of distinct keys shared by all threads. Smaller than kCacheOpsPerThread so
+// that hits, misses and pending entries all occur
+static const int kCacheKeysCount = 64;
+
+static void
+cacheGetInsertWorker()
+{
+    for (int i = 0; i < kCacheOpsPerThread; ++i) {
+        IsIdentityKeyPtr key( new IsIdentityKey( (U64)(i % kCacheKeysCount), TimeValue(0), ImagePlaneDesc::getRGBAComponents(), std::string("benchmark") ) );
+        IsIdentityResultsPtr entry = IsIdentityResults::create(key);
+        CacheEntryLockerBasePtr cacheAccess = appPTR->getGeneralPurposeCache()->get(entry);
+        CacheEntryLockerBase::CacheEntryStatusEnum status = cacheAccess->getStatus();
+        while (status == CacheEntryLockerBase::eCacheEntryStatusComputationPending) {
+            status = cacheAccess->waitForPendingEntry();
+        }
+        if (status == CacheEntryLockerBase::eCacheEntryStatusMustCompute) {
+            entry->setIdentityData( -1, TimeValue(0), ViewIdx(0), ImagePlaneDesc::getRGBAComponents() );
+            cacheAccess->insertInCache();
+        }
+    }
+}
+
+NATRON_BENCHMARK(BM_CacheGetInsertContended)
+{
+    const int nThreads = QThread::idealThreadCount();
+
+    while ( state.keepRunning() ) {
+        std::vector<QFuture<void> > tasks(nThreads);
+        for (int i = 0; i < nThreads; ++i) {
+            tasks[i] = QtConcurrent::run(&cacheGetInsertWorker);
+        }
+        for (int i = 0; i < nThreads; ++i) {
+            tasks[i].waitForFinished();
+        }
+    }
+    state.setItemsProcessed( state.getIterationsCount() * (unsigned long long)nThreads * kCacheOpsPerThread );
+}
@@ -0,0 +1,80 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2013-2017 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <cmath>
+#include <vector>
+
+#include "Engine/Curve.h"
+
+#include "BenchmarkSupport.h"
+
+NATRON_NAMESPACE_USING
+
+// Benchmarks of Engine/Curve.cpp evaluation on a fixed synthetic animation of 100
+// smooth keyframes, the typical size of a tracked curve.
+
+static const int kKeyFramesCount = 100;
+static const int kSamplesCount = 1000;
+
+static void
+makeCurve(Curve* curve)
+{
+    for (int i = 0; i < kKeyFramesCount; ++i) {
+        bool ok = curve->addKeyFrame( KeyFrame( i * 10, std::sin(i * 0.1) ) );
+        Q_UNUSED(ok);
+    }
+}
+
+NATRON_BENCHMARK(BM_CurveGetValueAt)
+{
+    Curve curve;
+
+    makeCurve(&curve);
+
+    // Sample the curve at times in-between keyframes so the interpolation is exercised
+    double sink = 0;
+    unsigned long long i = 0;
+    while ( state.keepRunning() ) {
+        TimeValue t( (double)(i % kSamplesCount) );
+        sink += curve.getValueAt(t, false /*clamp*/);
+        ++i;
+    }
+    Q_UNUSED(sink);
+    state.setItemsProcessed( state.getIterationsCount() );
+}
+
+NATRON_BENCHMARK(BM_CurveGetValueAtBatch)
+{
+    Curve curve;
+
+    makeCurve(&curve);
+
+    std::vector<double> samples(kSamplesCount);
+    while ( state.keepRunning() ) {
+        curve.getValueAtBatch(TimeValue(0), TimeValue(kSamplesCount), kSamplesCount, false /*clamp*/, &samples[0]);
+    }
+    state.setItemsProcessed(state.getIterationsCount() * kSamplesCount);
+}
@@ -0,0 +1,56 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2013-2017 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include "Engine/Hash64.h"
+
+#include "BenchmarkSupport.h"
+
+NATRON_NAMESPACE_USING
+
+// Benchmark of Engine/Hash64.cpp on a synthetic hash of 64 values, in the ballpark
+// of the number of knob values hashed for a node with a few dozen parameters.
+
+static const int kHashedValuesCount = 64;
+
+NATRON_BENCHMARK(BM_Hash64AppendAndCompute)
+{
+    U64 sink = 0;
+
+    while ( state.keepRunning() ) {
+        Hash64 hash;
+        for (int i = 0; i < kHashedValuesCount; ++i) {
+            if (i % 2 == 0) {
+                hash.append<U64>(i);
+            } else {
+                hash.append<double>(i * 0.1);
+            }
+        }
+        hash.computeHash();
+        sink ^= hash.value();
+    }
+    Q_UNUSED(sink);
+    state.setItemsProcessed( state.getIterationsCount() );
+}
@@ -0,0 +1,164 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2013-2017 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <bitset>
+#include <cassert>
+
+#include "Engine/Image.h"
+#include "Engine/ImagePlaneDesc.h"
+#include "Engine/RectI.h"
+
+#include "BenchmarkSupport.h"
+
+NATRON_NAMESPACE_USING
+
+// Benchmarks of the host image kernels (Engine/ImageFill.cpp, Engine/ImageConvert.cpp,
+// Engine/ImageCopyChannels.cpp, Engine/ImageMaskMix.cpp) on a fixed synthetic input:
+// a single-tiled 512x512 RAM image, the size of one viewer tile update.
+
+// The bounds of all benchmarked images
+static const RectI kImageBounds(0, 0, 512, 512);
+
+static ImagePtr
+makeImage(const ImagePlaneDesc& plane,
+          ImageBitDepthEnum bitdepth)
+{
+    Image::InitStorageArgs initArgs;
+
+    initArgs.bounds = kImageBounds;
+    initArgs.plane = plane;
+    initArgs.bitdepth = bitdepth;
+    ImagePtr ret = Image::create(initArgs);
+    assert(ret);
+
+    return ret;
+}
+
+NATRON_BENCHMARK(BM_ImageFill)
+{
+    ImagePtr image = makeImage(ImagePlaneDesc::getRGBAComponents(), eImageBitDepthFloat);
+
+    while ( state.keepRunning() ) {
+        ActionRetCodeEnum stat = image->fill(kImageBounds, 0.25f, 0.5f, 0.75f, 1.f);
+        assert( !isFailureRetCode(stat) );
+        Q_UNUSED(stat);
+    }
+    state.setItemsProcessed( state.getIterationsCount() * (unsigned long long)kImageBounds.area() );
+}
+
+NATRON_BENCHMARK(BM_ImageFillZero)
+{
+    ImagePtr image = makeImage(ImagePlaneDesc::getRGBAComponents(), eImageBitDepthFloat);
+
+    while ( state.keepRunning() ) {
+        ActionRetCodeEnum stat = image->fillZero(kImageBounds);
+        assert( !isFailureRetCode(stat) );
+        Q_UNUSED(stat);
+    }
+    state.setItemsProcessed( state.getIterationsCount() * (unsigned long long)kImageBounds.area() );
+}
+
+NATRON_BENCHMARK(BM_ImageConvertFloatToByte)
+{
+    ImagePtr src = makeImage(ImagePlaneDesc::getRGBAComponents(), eImageBitDepthFloat);
+    ImagePtr dst = makeImage(ImagePlaneDesc::getRGBAComponents(), eImageBitDepthByte);
+    ActionRetCodeEnum stat = src->fill(kImageBounds, 0.25f, 0.5f, 0.75f, 1.f);
+
+    assert( !isFailureRetCode(stat) );
+
+    Image::CopyPixelsArgs copyArgs;
+    copyArgs.roi = kImageBounds;
+
+    while ( state.keepRunning() ) {
+        stat = dst->copyPixels(*src, copyArgs);
+        assert( !isFailureRetCode(stat) );
+    }
+    Q_UNUSED(stat);
+    state.setItemsProcessed( state.getIterationsCount() * (unsigned long long)kImageBounds.area() );
+}
+
+NATRON_BENCHMARK(BM_ImageConvertRGBAToRGB)
+{
+    ImagePtr src = makeImage(ImagePlaneDesc::getRGBAComponents(), eImageBitDepthFloat);
+    ImagePtr dst = makeImage(ImagePlaneDesc::getRGBComponents(), eImageBitDepthFloat);
+    ActionRetCodeEnum stat = src->fill(kImageBounds, 0.25f, 0.5f, 0.75f, 1.f);
+
+    assert( !isFailureRetCode(stat) );
+
+    Image::CopyPixelsArgs copyArgs;
+    copyArgs.roi = kImageBounds;
+
+    while ( state.keepRunning() ) {
+        stat = dst->copyPixels(*src, copyArgs);
+        assert( !isFailureRetCode(stat) );
+    }
+    Q_UNUSED(stat);
+    state.setItemsProcessed( state.getIterationsCount() * (unsigned long long)kImageBounds.area() );
+}
+
+NATRON_BENCHMARK(BM_ImageCopyUnProcessedChannels)
+{
+    ImagePtr image = makeImage(ImagePlaneDesc::getRGBAComponents(), eImageBitDepthFloat);
+    ImagePtr original = makeImage(ImagePlaneDesc::getRGBAComponents(), eImageBitDepthFloat);
+    ActionRetCodeEnum stat = image->fill(kImageBounds, 0.25f, 0.5f, 0.75f, 1.f);
+
+    assert( !isFailureRetCode(stat) );
+    stat = original->fill(kImageBounds, 1.f, 0.75f, 0.5f, 0.25f);
+    assert( !isFailureRetCode(stat) );
+
+    // Process R and B: G and A are copied over from the original image
+    std::bitset<4> processChannels;
+    processChannels[0] = true;
+    processChannels[2] = true;
+
+    while ( state.keepRunning() ) {
+        stat = image->copyUnProcessedChannels(kImageBounds, processChannels, original);
+        assert( !isFailureRetCode(stat) );
+    }
+    Q_UNUSED(stat);
+    state.setItemsProcessed( state.getIterationsCount() * (unsigned long long)kImageBounds.area() );
+}
+
+NATRON_BENCHMARK(BM_ImageApplyMaskMix)
+{
+    ImagePtr image = makeImage(ImagePlaneDesc::getRGBAComponents(), eImageBitDepthFloat);
+    ImagePtr original = makeImage(ImagePlaneDesc::getRGBAComponents(), eImageBitDepthFloat);
+    ImagePtr mask = makeImage(ImagePlaneDesc::getAlphaComponents(), eImageBitDepthFloat);
+    ActionRetCodeEnum stat = image->fill(kImageBounds, 0.25f, 0.5f, 0.75f, 1.f);
+
+    assert( !isFailureRetCode(stat) );
+    stat = original->fill(kImageBounds, 1.f, 0.75f, 0.5f, 0.25f);
+    assert( !isFailureRetCode(stat) );
+    stat = mask->fill(kImageBounds, 0.f, 0.f, 0.f, 0.5f);
+    assert( !isFailureRetCode(stat) );
+
+    while ( state.keepRunning() ) {
+        stat = image->applyMaskMix(kImageBounds, mask, original, true /*masked*/, false /*maskInvert*/, 0.5f /*mix*/);
+        assert( !isFailureRetCode(stat) );
+    }
+    Q_UNUSED(stat);
+    state.setItemsProcessed( state.getIterationsCount() * (unsigned long long)kImageBounds.area() );
+}
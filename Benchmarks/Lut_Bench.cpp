@@ -0,0 +1,108 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2013-2017 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <vector>
+
+#include "Engine/Lut.h"
+#include "Engine/RectI.h"
+
+#include "BenchmarkSupport.h"
+
+NATRON_NAMESPACE_USING
+
+// Benchmarks of the packed buffer color-space conversions of Engine/Lut.cpp with the
+// sRGB lut, on a fixed synthetic 512x512 RGBA buffer.
+
+static const RectI kLutBounds(0, 0, 512, 512);
+
+static void
+fillFloatBuffer(std::vector<float>* buf)
+{
+    buf->resize( (std::size_t)kLutBounds.area() * 4 );
+    for (std::size_t i = 0; i < buf->size(); ++i) {
+        (*buf)[i] = (i % 256) / 255.f;
+    }
+}
+
+static void
+fillByteBuffer(std::vector<unsigned char>* buf)
+{
+    buf->resize( (std::size_t)kLutBounds.area() * 4 );
+    for (std::size_t i = 0; i < buf->size(); ++i) {
+        (*buf)[i] = (unsigned char)(i % 256);
+    }
+}
+
+NATRON_BENCHMARK(BM_LutToBytePacked)
+{
+    const Color::Lut* lut = Color::LutManager::sRGBLut();
+
+    lut->validate();
+
+    std::vector<float> src;
+    fillFloatBuffer(&src);
+    std::vector<unsigned char> dst( src.size() );
+
+    while ( state.keepRunning() ) {
+        lut->to_byte_packed(&dst[0], &src[0], kLutBounds, kLutBounds, kLutBounds,
+                            Color::ePixelPackingRGBA, Color::ePixelPackingRGBA, false /*invertY*/, false /*premult*/);
+    }
+    state.setItemsProcessed( state.getIterationsCount() * (unsigned long long)kLutBounds.area() );
+}
+
+NATRON_BENCHMARK(BM_LutFromBytePacked)
+{
+    const Color::Lut* lut = Color::LutManager::sRGBLut();
+
+    lut->validate();
+
+    std::vector<unsigned char> src;
+    fillByteBuffer(&src);
+    std::vector<float> dst( src.size() );
+
+    while ( state.keepRunning() ) {
+        lut->from_byte_packed(&dst[0], &src[0], kLutBounds, kLutBounds, kLutBounds,
+                              Color::ePixelPackingRGBA, Color::ePixelPackingRGBA, false /*invertY*/, false /*premult*/);
+    }
+    state.setItemsProcessed( state.getIterationsCount() * (unsigned long long)kLutBounds.area() );
+}
+
+NATRON_BENCHMARK(BM_LutToFloatPacked)
+{
+    const Color::Lut* lut = Color::LutManager::sRGBLut();
+
+    lut->validate();
+
+    std::vector<float> src;
+    fillFloatBuffer(&src);
+    std::vector<float> dst( src.size() );
+
+    while ( state.keepRunning() ) {
+        lut->to_float_packed(&dst[0], &src[0], kLutBounds, kLutBounds, kLutBounds,
+                             Color::ePixelPackingRGBA, Color::ePixelPackingRGBA, false /*invertY*/, false /*premult*/);
+    }
+    state.setItemsProcessed( state.getIterationsCount() * (unsigned long long)kLutBounds.area() );
+}
@@ -0,0 +1,55 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2013-2017 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+
+#include "Engine/AppManager.h"
+#include "Engine/CLArgs.h"
+
+#include "BenchmarkSupport.h"
+
+NATRON_NAMESPACE_USING
+
+int
+main(int argc,
+     char** argv)
+{
+    // Load a background AppManager the same way the unit tests do, so the benchmarks
+    // exercising the multi-threaded image processors and the cache run in the same
+    // environment as a render. The cache is cleared so timings start from a known state.
+    AppManager manager;
+    int fakeArgc = 0;
+    QStringList appArgs;
+
+    appArgs << QString::fromUtf8("--clear-cache");
+    CLArgs cl(appArgs, true);
+    if ( !manager.load(fakeArgc, 0, cl) ) {
+        return 1;
+    }
+
+    return runBenchmarks(argc, argv);
+}
@@ -35,9 +35,16 @@ struct AnimatingObjectIPrivate
     mutable QMutex viewsMutex;
     std::list<ViewIdx> views;
 
+    // When true, the views list can no longer change and may be read without taking viewsMutex.
+    // This is set on render clones: their views list is copied from the main instance once at
+    // construction and views are never split/unsplit on a clone afterwards, yet the fallback
+    // view must be resolved on every knob value read from the render threads.
+    bool viewsImmutable;
+
     AnimatingObjectIPrivate()
     : viewsMutex()
     , views()
+    , viewsImmutable(false)
     {
         views.push_back(ViewIdx(0));
     }
@@ -45,6 +52,7 @@ struct AnimatingObjectIPrivate
     AnimatingObjectIPrivate(const AnimatingObjectIPrivate& other)
     : viewsMutex()
     , views()
+    , viewsImmutable(false)
     {
         QMutexLocker k(&other.viewsMutex);
         views = other.views;
@@ -53,7 +61,7 @@ struct AnimatingObjectIPrivate
     ViewIdx findMatchingView(ViewIdx inView) const
     {
         // Private - should not lock
-        assert(!viewsMutex.tryLock());
+        assert(viewsImmutable || !viewsMutex.tryLock());
 
         std::list<ViewIdx>::const_iterator foundView = std::find(views.begin(), views.end(), inView);
 
@@ -74,7 +82,8 @@ AnimatingObjectI::AnimatingObjectI()
 AnimatingObjectI::AnimatingObjectI(const boost::shared_ptr<AnimatingObjectI>& other, const FrameViewRenderKey& /*key*/)
 : _imp(new AnimatingObjectIPrivate(*other->_imp))
 {
-
+    // This is a render clone: its views list is frozen, see AnimatingObjectIPrivate::viewsImmutable
+    _imp->viewsImmutable = true;
 }
 
 AnimatingObjectI::~AnimatingObjectI()
@@ -85,6 +94,9 @@ AnimatingObjectI::~AnimatingObjectI()
 std::list<ViewIdx>
 AnimatingObjectI::getViewsList() const
 {
+    if (_imp->viewsImmutable) {
+        return _imp->views;
+    }
     QMutexLocker k(&_imp->viewsMutex);
     return _imp->views;
 }
@@ -92,6 +104,11 @@ AnimatingObjectI::getViewsList() const
 ViewIdx
 AnimatingObjectI::checkIfViewExistsOrFallbackMainView(ViewIdx view) const
 {
+    // On render clones the views list is immutable: skip the lock, this is called on every
+    // knob value read from the render threads.
+    if (_imp->viewsImmutable) {
+        return _imp->findMatchingView(view);
+    }
 
     // Find the view. If it is not in the split views, fallback on the main view.
     QMutexLocker k(&_imp->viewsMutex);
@@ -107,6 +124,7 @@ AnimatingObjectI::splitView(ViewIdx view)
     }
     {
         QMutexLocker k(&_imp->viewsMutex);
+        assert(!_imp->viewsImmutable);
         for (std::list<ViewIdx>::iterator it = _imp->views.begin(); it!=_imp->views.end(); ++it) {
             if (*it == view) {
                 return false;
@@ -132,6 +150,7 @@ AnimatingObjectI::unSplitView(ViewIdx view)
     bool viewFound = false;
     {
         QMutexLocker k(&_imp->viewsMutex);
+        assert(!_imp->viewsImmutable);
         for (std::list<ViewIdx>::iterator it = _imp->views.begin(); it!=_imp->views.end(); ++it) {
             if (*it == view) {
                 _imp->views.erase(it);
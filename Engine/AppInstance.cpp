@@ -57,6 +57,7 @@ CLANG_DIAG_ON(unknown-pragmas)
 
 #include "Global/QtCompat.h" // removeFileExtension
 
+#include "Engine/CacheWarmupQueue.h"
 #include "Engine/CLArgs.h"
 #include "Engine/CreateNodeArgs.h"
 #include "Engine/FileDownloader.h"
@@ -235,6 +236,8 @@ public:
 
     RenderQueuePtr renderQueue;
 
+    CacheWarmupQueuePtr cacheWarmupQueue;
+
 
     // Stack to recursively keep track of created nodes
     CreateNodeStack createNodeStack;
@@ -534,6 +537,7 @@ AppInstance::load(const CLArgs& cl,
     _imp->_currentProject->initializeKnobsPublic();
 
     _imp->renderQueue.reset(new RenderQueue(shared_from_this()));
+    _imp->cacheWarmupQueue.reset(new CacheWarmupQueue(shared_from_this()));
 
     loadInternal(cl, makeEmptyInstance);
 }
@@ -1380,6 +1384,12 @@ AppInstance::getRenderQueue() const
     return _imp->renderQueue;
 }
 
+CacheWarmupQueuePtr
+AppInstance::getCacheWarmupQueue() const
+{
+    return _imp->cacheWarmupQueue;
+}
+
 void
 AppInstance::errorDialog(const std::string & title,
                          const std::string & message,
@@ -1483,6 +1493,11 @@ AppInstance::clearAllLastRenderedImages()
 void
 AppInstance::aboutToQuit()
 {
+    // Abort the background cache warm-up renders and wait for them before tearing down nodes
+    if (_imp->cacheWarmupQueue) {
+        _imp->cacheWarmupQueue->quit();
+    }
+
     ///Clear nodes now, not in the destructor of the project as
     ///deleting nodes might reference the project.
     _imp->_currentProject->reset(true /*aboutToQuit*/, /*blocking*/true);
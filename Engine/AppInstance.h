@@ -146,6 +146,8 @@ public:
 
     RenderQueuePtr getRenderQueue() const;
 
+    CacheWarmupQueuePtr getCacheWarmupQueue() const;
+
     /*true if the user is NOT scrubbing the timeline*/
     virtual bool shouldRefreshPreview() const
     {
@@ -64,6 +64,9 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 #include <ceres/version.h>
 #include <openMVG/version.hpp>
 
+#include <QtConcurrentMap> // QtCore on Qt4, QtConcurrent on Qt5
+#include <QtConcurrentRun> // QtCore on Qt4, QtConcurrent on Qt5
+
 #include <QtCore/QDateTime>
 #include <QtCore/QDebug>
 #include <QtCore/QDir>
@@ -104,13 +107,18 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 #include "Engine/Log.h"
 #include "Engine/MemoryInfo.h" // getSystemTotalRAM, printAsRAM
 #include "Engine/Node.h"
+#include "Engine/NodeGroup.h"
 #include "Engine/OfxImageEffectInstance.h"
 #include "Engine/OfxEffectInstance.h"
 #include "Engine/OfxHost.h"
 #include "Engine/OSGLContext.h"
 #include "Engine/OSGLFunctions.h"
 #include "Engine/OneViewNode.h"
+#include "Engine/PixelExprNode.h"
+#include "Engine/PluginMemory.h"
+#include "Engine/ProcessFrameRing.h"
 #include "Engine/ProcessHandler.h" // ProcessInputChannel
+#include "Engine/RenderWorkerServer.h"
 #include "Engine/Project.h"
 #include "Engine/PrecompNode.h"
 #include "Engine/ReadNode.h"
@@ -121,14 +129,17 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 #include "Engine/StandardPaths.h"
 #include "Engine/StubNode.h"
 #include "Engine/Settings.h"
+#include "Engine/Timer.h"
 #include "Engine/TrackerNode.h"
 #include "Engine/ThreadPool.h"
+#include "Engine/UndoStateStore.h"
 #include "Engine/ViewIdx.h"
 #include "Engine/ViewerInstance.h" // RenderStatsMap
 #include "Engine/ViewerNode.h"
 #include "Engine/WriteNode.h"
 
 #include "Serialization/NodeSerialization.h"
+#include "Serialization/SerializationBinary.h"
 #include "Serialization/SerializationIO.h"
 
 #include "sbkversion.h" // shiboken/pyside version
@@ -408,7 +419,11 @@ void
 AppManager::loadProjectFromFileFunction(std::istream& ifile, const std::string& filename, const AppInstancePtr& /*app*/, SERIALIZATION_NAMESPACE::ProjectSerialization* obj)
 {
     try {
-        SERIALIZATION_NAMESPACE::read(NATRON_PROJECT_FILE_HEADER,  ifile, obj);
+        if ( SERIALIZATION_NAMESPACE::isBinarySerializationStream(ifile) ) {
+            SERIALIZATION_NAMESPACE::readBinary(NATRON_PROJECT_FILE_HEADER, ifile, obj);
+        } else {
+            SERIALIZATION_NAMESPACE::read(NATRON_PROJECT_FILE_HEADER,  ifile, obj);
+        }
     } catch (SERIALIZATION_NAMESPACE::InvalidSerializationFileException& e) {
         throw std::runtime_error(tr("Failed to open %1: This file does not appear to be a %2 project file").arg(QString::fromUtf8(filename.c_str())).arg(QString::fromUtf8(NATRON_APPLICATION_NAME)).toStdString());
     }
@@ -628,7 +643,12 @@ AppManager::~AppManager()
         }
     }
 
+    _imp->_workerServer.reset();
     _imp->_backgroundIPC.reset();
+    _imp->_backgroundFrameRing.reset();
+
+    // Remove the undo states spill directory from the disk cache location
+    _imp->undoStateStore.reset();
 
     // Ensure the cache is synced on disk when exiting.
     _imp->tileCache->flushCacheOnDisk(false /*async*/);
@@ -873,8 +893,11 @@ AppManager::loadInternal(const CLArgs& cl)
     Q_UNUSED(mustSetSignalsHandlers);
 # endif
 
+    _imp->startupProfileEnabled = cl.isStartupProfileRequested();
+    TimeLapse phaseTimer;
+
     // Settings: we must load these and set the custom settings (using python) ASAP, before creating the OFX Plugin Cache
-    
+
     _imp->_settings = Settings::create();
     _imp->_settings->initializeKnobsPublic();
 
@@ -893,6 +916,7 @@ AppManager::loadInternal(const CLArgs& cl)
         ///Call restore after initializing knobs
         _imp->_settings->loadSettingsFromFile(Settings::eLoadSettingsTypeKnobs);
     }
+    _imp->recordStartupPhase( "Settings load", phaseTimer.getTimeElapsedReset() );
 
     if (cl.isCacheClearRequestedOnLaunch()) {
         // Clear the cache before attempting to load any data.
@@ -901,24 +925,17 @@ AppManager::loadInternal(const CLArgs& cl)
         Cache<true>::clearDiskCache();
     }
 
-    // Create cache once we loaded the cache directory path wanted by the user
-    _imp->generalPurposeCache = Cache<false>::create(false /*enableTileStorage*/);
-    try {
-
-        // If the cache is busy because another process is using it and we are not compiled
-        // with NATRON_CACHE_INTERPROCESS_ROBUST, just create a process local cache instead.
-        _imp->tileCache = Cache<true>::create(true /*enableTileStorage*/);
-#ifdef NATRON_CACHE_INTERPROCESS_ROBUST
-        _imp->mappedProcessWatcher.reset(new MappedProcessWatcherThread);
-        _imp->mappedProcessWatcher->startWatching();
-#endif
-    } catch (const BusyCacheException&) {
-        _imp->tileCache = Cache<false>::create(true /*enableTileStorage*/);
-    }
-
+    // Create the caches once we loaded the cache directory path wanted by the user.
+    // This only reads the settings and restores the disk cache index, which no other startup
+    // phase needs until the first application instance is created: run it on the thread-pool
+    // concurrently with the plug-ins load. getGeneralPurposeCache()/getTileCache() join on the
+    // future for anything that would need the caches earlier.
+    _imp->cacheCreationFuture = QtConcurrent::run(_imp.get(), &AppManagerPrivate::createCaches);
 
-    _imp->tileCache->setMaximumCacheSize(_imp->_settings->getTileCacheSize());
-    _imp->generalPurposeCache->setMaximumCacheSize(_imp->_settings->getGeneralPurposeCacheSize());
+    // Warm-up the fontconfig font caches concurrently too: fontconfig persists them on disk
+    // and memory-maps them, so once a process rebuilt them every subsequent process (e.g the
+    // renderers spawned per chunk on a render-farm) shares them instead of re-scanning the fonts.
+    _imp->fontconfigWarmupFuture = QtConcurrent::run(_imp.get(), &AppManagerPrivate::warmupFontconfigCache);
 
     _imp->storageDeleteThread.reset(new StorageDeleterThread);
 
@@ -1152,6 +1169,15 @@ AppManager::loadInternalAfterInitGui(const CLArgs& cl)
         _imp->initProcessInputChannel( cl.getIPCPipeName() );
     }
 
+    if ( isBackground() && !cl.getFrameRingName().isEmpty() ) {
+        _imp->_backgroundFrameRing.reset( new ProcessFrameRing( cl.getFrameRingName().toStdString() ) );
+        if ( !_imp->_backgroundFrameRing->isValid() ) {
+            // The GUI process did not create the segment (or removed it already): render
+            // without publishing previews.
+            _imp->_backgroundFrameRing.reset();
+        }
+    }
+
 
     if ( cl.isInterpreterMode() ) {
         _imp->_appType = eAppTypeInterpreter;
@@ -1178,7 +1204,26 @@ AppManager::loadInternalAfterInitGui(const CLArgs& cl)
         args = cl;
     }
 
+    // Join point for the caches created concurrently in loadInternal(): the first application
+    // instance may use them right away.
+    {
+        TimeLapse joinTimer;
+        _imp->cacheCreationFuture.waitForFinished();
+        _imp->recordStartupPhase( "Caches creation (join)", joinTimer.getTimeSinceCreation() );
+    }
+
+    // Join point for the fontconfig warm-up: in GUI mode it already completed behind the
+    // splash-screen, in background mode wait so plug-ins using fontconfig (e.g the Text
+    // plug-in) find a warm cache instead of paying the font scan during the first render.
+    {
+        TimeLapse joinTimer;
+        _imp->fontconfigWarmupFuture.waitForFinished();
+        _imp->recordStartupPhase( "Fontconfig warm-up (join)", joinTimer.getTimeSinceCreation() );
+    }
+
+    TimeLapse phaseTimer;
     AppInstancePtr mainInstance = newAppInstance(args, false);
+    _imp->recordStartupPhase( "Main instance creation", phaseTimer.getTimeSinceCreation() );
 
     hideSplashScreen();
 
@@ -1188,6 +1233,19 @@ AppManager::loadInternalAfterInitGui(const CLArgs& cl)
         return false;
     } else {
         onLoadCompleted();
+        _imp->dumpStartupProfile();
+
+        // In render farm worker mode, start the http server: the process stays alive and
+        // renders the jobs it is assigned, see RenderWorkerServer. The caller is expected
+        // to run the event loop (see NatronRenderer_main.cpp).
+        if ( args.getWorkerPort() > 0 ) {
+            _imp->_workerServer.reset( new RenderWorkerServer( args.getWorkerPort() ) );
+            if ( !_imp->_workerServer->isListening() ) {
+                _imp->_workerServer.reset();
+
+                return false;
+            }
+        }
 
         ///In background project auto-run the rendering is finished at this point, just exit the instance
         if ( ( (_imp->_appType == eAppTypeBackgroundAutoRun) ||
@@ -1428,6 +1486,12 @@ AppManager::writeToOutputPipe(const QString & longMessage,
     return true;
 }
 
+ProcessFrameRing*
+AppManager::getBackgroundFrameRing() const
+{
+    return _imp->_backgroundFrameRing.get();
+}
+
 
 void
 AppManager::loadAllPlugins()
@@ -1435,18 +1499,24 @@ AppManager::loadAllPlugins()
     assert( _imp->_plugins.empty() );
     assert( _imp->_formats.empty() );
 
+    TimeLapse phaseTimer;
+
     // Load plug-ins bundled into Natron
     loadBuiltinNodePlugins(&_imp->readerPlugins, &_imp->writerPlugins);
+    _imp->recordStartupPhase( "Built-in plug-ins load", phaseTimer.getTimeElapsedReset() );
 
     // Load OpenFX plug-ins
     _imp->ofxHost->loadOFXPlugins( &_imp->readerPlugins, &_imp->writerPlugins);
+    _imp->recordStartupPhase( "OpenFX plug-ins load", phaseTimer.getTimeElapsedReset() );
 
     // Load PyPlugs and init.py & initGui.py scripts
     // Should be done after settings are declared
     loadPythonGroups();
+    _imp->recordStartupPhase( "Python scripts & PyPlugs load", phaseTimer.getTimeElapsedReset() );
 
     // Load presets after all plug-ins are loaded
     loadNodesPresets();
+    _imp->recordStartupPhase( "Node presets load", phaseTimer.getTimeElapsedReset() );
 
     _imp->_settings->loadSettingsFromFile(Settings::eLoadSettingsTypePlugins);
 
@@ -1634,6 +1704,7 @@ AppManager::loadBuiltinNodePlugins(IOPluginsMap* /*readersMap*/,
     registerPlugin(TrackerNode::createPlugin());
     registerPlugin(JoinViewsNode::createPlugin());
     registerPlugin(OneViewNode::createPlugin());
+    registerPlugin(PixelExprNode::createPlugin());
     registerPlugin(ReadNode::createPlugin());
     registerPlugin(RemovePlaneNode::createPlugin());
     registerPlugin(StubNode::createPlugin());
@@ -1911,6 +1982,24 @@ AppManager::findAllPresetsRecursive(const QDir& directory,
     }
 }
 
+static SERIALIZATION_NAMESPACE::NodeSerializationPtr
+loadPresetFileFunctor(const QString& presetFile)
+{
+    FStreamsSupport::ifstream ifile;
+    FStreamsSupport::open( &ifile, presetFile.toStdString() );
+    if (!ifile) {
+        return SERIALIZATION_NAMESPACE::NodeSerializationPtr();
+    }
+    SERIALIZATION_NAMESPACE::NodeSerializationPtr obj( new SERIALIZATION_NAMESPACE::NodeSerialization() );
+    try {
+        SERIALIZATION_NAMESPACE::read( NATRON_PRESETS_FILE_HEADER, ifile, obj.get() );
+    } catch (...) {
+        return SERIALIZATION_NAMESPACE::NodeSerializationPtr();
+    }
+
+    return obj;
+}
+
 void
 AppManager::loadNodesPresets()
 {
@@ -1922,19 +2011,18 @@ AppManager::loadNodesPresets()
         findAllPresetsRecursive(d, presetFiles);
     }
 
-    Q_FOREACH(const QString &presetFile, presetFiles) {
+    // Parsing preset files is independent per-file: fan it out across the thread pool.
+    // Registration below stays serial since it mutates the plug-ins registry.
+    const QList<SERIALIZATION_NAMESPACE::NodeSerializationPtr> parsedPresets =
+        QtConcurrent::blockingMapped< QList<SERIALIZATION_NAMESPACE::NodeSerializationPtr> >(presetFiles, loadPresetFileFunctor);
 
-        FStreamsSupport::ifstream ifile;
-        FStreamsSupport::open(&ifile, presetFile.toStdString());
-        if (!ifile) {
-            continue;
-        }
-        SERIALIZATION_NAMESPACE::NodeSerialization obj;
-        try {
-            SERIALIZATION_NAMESPACE::read(NATRON_PRESETS_FILE_HEADER, ifile, &obj);
-        } catch (...) {
+    for (int presetIndex = 0; presetIndex < presetFiles.size(); ++presetIndex) {
+        const QString& presetFile = presetFiles[presetIndex];
+
+        if ( !parsedPresets[presetIndex] ) {
             continue;
         }
+        const SERIALIZATION_NAMESPACE::NodeSerialization& obj = *parsedPresets[presetIndex];
 
         if (!obj._presetsIdentifierLabel.empty()) {
             // If the preset label is set, append as a preset of an existing plug-in
@@ -2037,6 +2125,169 @@ AppManager::loadNodesPresets()
     }
 }
 
+static bool
+getPyPlugReturnLiteral(const QStringList& scriptLines,
+                       const QString& functionName,
+                       QString* literal)
+{
+    const QString defLine = QString::fromUtf8("def %1():").arg(functionName);
+
+    for (int i = 0; i < scriptLines.size(); ++i) {
+        if (scriptLines[i].trimmed() != defLine) {
+            continue;
+        }
+        // The exporter writes the return statement on the line right after the def, possibly
+        // preceded by comment lines.
+        for (int j = i + 1; j < scriptLines.size(); ++j) {
+            QString line = scriptLines[j].trimmed();
+            if ( line.isEmpty() || line.startsWith( QLatin1Char('#') ) ) {
+                continue;
+            }
+            if ( !line.startsWith( QString::fromUtf8("return ") ) ) {
+                return false;
+            }
+            *literal = line.mid(7).trimmed();
+
+            return true;
+        }
+
+        return false;
+    }
+
+    return false;
+}
+
+static bool
+decodePyPlugStringLiteral(const QString& literal,
+                          std::string* value)
+{
+    if (literal.size() < 2) {
+        return false;
+    }
+    QChar quote = literal[0];
+    if ( ( quote != QLatin1Char('"') && quote != QLatin1Char('\'') ) || literal[literal.size() - 1] != quote ) {
+        return false;
+    }
+    QString decoded;
+    for (int i = 1; i < literal.size() - 1; ++i) {
+        QChar c = literal[i];
+        if (c == quote) {
+            // An unescaped quote before the end: this is not a single string literal
+            return false;
+        }
+        if ( c == QLatin1Char('\\') && (i + 1 < literal.size() - 1) ) {
+            ++i;
+            QChar escaped = literal[i];
+            if ( escaped == QLatin1Char('n') ) {
+                c = QLatin1Char('\n');
+            } else if ( escaped == QLatin1Char('t') ) {
+                c = QLatin1Char('\t');
+            } else {
+                c = escaped;
+            }
+        }
+        decoded.append(c);
+    }
+    *value = decoded.toStdString();
+
+    return true;
+}
+
+/**
+ * @brief Attempts to read the manifest functions (getPluginID, getLabel, getVersion, getIconPath,
+ * getGrouping, getPluginDescription, getIsToolset) of a deprecated Python-script PyPlug without
+ * running it through the interpreter. The PyPlug exporter emits each of these functions as a
+ * "def getXxx():" line followed by a single "return <literal>" line, so for machine-generated
+ * scripts the values can be recovered textually; importing the module instead executes its
+ * top-level statements (and everything it imports), which makes startup time grow with the
+ * number of PyPlugs found in the search paths.
+ * @returns false if the script does not follow the generated layout, in which case the caller
+ * should fall back to NATRON_PYTHON_NAMESPACE::getGroupInfos().
+ **/
+static bool
+getPyPlugManifestWithoutPython(const QStringList& scriptLines,
+                               const QString& modulePath,
+                               std::string* pluginID,
+                               std::string* pluginLabel,
+                               std::string* iconFilePath,
+                               std::string* grouping,
+                               std::string* description,
+                               bool* isToolset,
+                               unsigned int* version)
+{
+    // Same requirement as getGroupInfos(): without a createInstance function this is not a
+    // loadable PyPlug.
+    bool hasCreateInstance = false;
+    Q_FOREACH(const QString &line, scriptLines) {
+        if ( line.startsWith( QString::fromUtf8("def createInstance(") ) ) {
+            hasCreateInstance = true;
+            break;
+        }
+    }
+    if (!hasCreateInstance) {
+        return false;
+    }
+
+    QString literal;
+    if ( !getPyPlugReturnLiteral(scriptLines, QString::fromUtf8("getLabel"), &literal) ||
+         !decodePyPlugStringLiteral(literal, pluginLabel) ) {
+        return false;
+    }
+
+    // The plug-in ID defaults to the label, as in getGroupInfos()
+    *pluginID = *pluginLabel;
+    if ( getPyPlugReturnLiteral(scriptLines, QString::fromUtf8("getPluginID"), &literal) ) {
+        if ( !decodePyPlugStringLiteral(literal, pluginID) ) {
+            return false;
+        }
+    }
+
+    *version = 1;
+    if ( getPyPlugReturnLiteral(scriptLines, QString::fromUtf8("getVersion"), &literal) ) {
+        bool ok;
+        *version = literal.toUInt(&ok);
+        if (!ok) {
+            return false;
+        }
+    }
+
+    *isToolset = false;
+    if ( getPyPlugReturnLiteral(scriptLines, QString::fromUtf8("getIsToolset"), &literal) ) {
+        if ( literal == QString::fromUtf8("True") ) {
+            *isToolset = true;
+        } else if ( literal != QString::fromUtf8("False") ) {
+            return false;
+        }
+    }
+
+    if ( getPyPlugReturnLiteral(scriptLines, QString::fromUtf8("getIconPath"), &literal) ) {
+        std::string iconRelativePath;
+        if ( !decodePyPlugStringLiteral(literal, &iconRelativePath) ) {
+            return false;
+        }
+        QFileInfo iconInfo( modulePath + QString::fromUtf8( iconRelativePath.c_str() ) );
+        *iconFilePath = iconInfo.canonicalFilePath().toStdString();
+    }
+
+    if ( getPyPlugReturnLiteral(scriptLines, QString::fromUtf8("getGrouping"), &literal) ) {
+        if ( !decodePyPlugStringLiteral(literal, grouping) ) {
+            return false;
+        }
+    }
+    if ( grouping->empty() ) {
+        *grouping = PLUGIN_GROUP_OTHER;
+    }
+
+    if ( getPyPlugReturnLiteral(scriptLines, QString::fromUtf8("getPluginDescription"), &literal) ||
+         getPyPlugReturnLiteral(scriptLines, QString::fromUtf8("getDescription"), &literal) ) { // Check old function name for compat
+        if ( !decodePyPlugStringLiteral(literal, description) ) {
+            return false;
+        }
+    }
+
+    return true;
+} // getPyPlugManifestWithoutPython
+
 void
 AppManager::loadPythonGroups()
 {
@@ -2173,6 +2424,7 @@ AppManager::loadPythonGroups()
         }
 
         std::string pluginLabel, pluginID, pluginGrouping, iconFilePath, pluginDescription, pluginPath;
+        QStringList scriptLines;
 
         {
             // Open the file and check for a line that imports NatronGui, if so do not attempt to load the script.
@@ -2192,6 +2444,7 @@ AppManager::loadPythonGroups()
                 if (line.startsWith(QString::fromUtf8("# This file was automatically generated by Natron PyPlug exporter"))) {
                     isPyPlug = true;
                 }
+                scriptLines.push_back(line);
 
             }
             if (appPTR->isBackground() && gotNatronGuiImport) {
@@ -2204,7 +2457,16 @@ AppManager::loadPythonGroups()
 
         unsigned int version;
         bool isToolset;
-        bool gotInfos = NATRON_PYTHON_NAMESPACE::getGroupInfos(moduleName.toStdString(), &pluginID, &pluginLabel, &iconFilePath, &pluginGrouping, &pluginDescription, &pluginPath, &isToolset, &version);
+
+        // First try to read the manifest directly off the script text so that registering the
+        // plug-in does not require importing the module: the script itself only gets executed
+        // when the PyPlug is first instantiated, see AppInstance::createNodeFromPyPlug().
+        // Scripts whose manifest the text scan cannot parse (e.g. hand-edited ones computing
+        // their values) still go through the interpreter as before.
+        bool gotInfos = getPyPlugManifestWithoutPython(scriptLines, modulePath, &pluginID, &pluginLabel, &iconFilePath, &pluginGrouping, &pluginDescription, &isToolset, &version);
+        if (!gotInfos) {
+            gotInfos = NATRON_PYTHON_NAMESPACE::getGroupInfos(moduleName.toStdString(), &pluginID, &pluginLabel, &iconFilePath, &pluginGrouping, &pluginDescription, &pluginPath, &isToolset, &version);
+        }
 
 
         if (!gotInfos) {
@@ -2472,14 +2734,37 @@ AppManager::getPluginBinary(const QString & pluginId,
 }
 
 
+// Plug-ins that shape the node-graph structure: in fast project open mode these are still
+// created for real so the graph hierarchy remains browsable, everything else is loaded as a Stub.
+static bool
+isGraphStructurePluginID(const std::string& pluginID)
+{
+    return (pluginID == PLUGINID_NATRON_GROUP ||
+            pluginID == PLUGINID_NATRON_DOT ||
+            pluginID == PLUGINID_NATRON_BACKDROP ||
+            pluginID == PLUGINID_NATRON_VIEWER_GROUP ||
+            pluginID == PLUGINID_NATRON_VIEWER_INTERNAL ||
+            pluginID == PLUGINID_NATRON_INPUT ||
+            pluginID == PLUGINID_NATRON_OUTPUT ||
+            pluginID == PLUGINID_NATRON_STUB);
+}
+
 NodePtr
 AppManager::createNodeForProjectLoading(const SERIALIZATION_NAMESPACE::NodeSerializationPtr& serialization, const NodeCollectionPtr& group)
 {
 
     NodePtr retNode = group->getNodeByName(serialization->_nodeScriptName);
 
+    // In fast project open mode, do not instantiate the plug-in at all: create a Stub node
+    // holding the serialization right away. The user may create the real node later by
+    // double-clicking the stub, see recreateNodeFromStub().
+    bool loadAsStub = false;
+    if ( getCurrentSettings()->isFastProjectOpenEnabled() &&
+         group->getApplication()->getProject()->isLoadingProject() ) {
+        loadAsStub = !isGraphStructurePluginID(serialization->_pluginID);
+    }
 
-    {
+    if (!loadAsStub) {
         CreateNodeArgsPtr args(CreateNodeArgs::create(serialization->_pluginID, group));
         args->setProperty<int>(kCreateNodeArgsPropPluginVersion, serialization->_pluginMajorVersion, 0);
         args->setProperty<int>(kCreateNodeArgsPropPluginVersion, serialization->_pluginMinorVersion, 1);
@@ -2488,12 +2773,13 @@ AppManager::createNodeForProjectLoading(const SERIALIZATION_NAMESPACE::NodeSeria
         args->setProperty<bool>(kCreateNodeArgsPropAddUndoRedoCommand, false);
         args->setProperty<bool>(kCreateNodeArgsPropAllowNonUserCreatablePlugins, true); // also load deprecated plugins
         retNode =  group->getApplication()->createNode(args);
+
+        if (retNode) {
+            return retNode;
+        }
     }
-    if (retNode) {
-        return retNode;
-    }
-    
-    // If the node could not be created, make a Stub node
+
+    // If the node could not be created (or fast project open requested a stand-in), make a Stub node
     {
         CreateNodeArgsPtr args(CreateNodeArgs::create(PLUGINID_NATRON_STUB, group));
 
@@ -2515,18 +2801,95 @@ AppManager::createNodeForProjectLoading(const SERIALIZATION_NAMESPACE::NodeSeria
     return retNode;
 }
 
+NodePtr
+AppManager::recreateNodeFromStub(const NodePtr& node)
+{
+    if (!node) {
+        return node;
+    }
+    StubNodePtr stub = node->isEffectStubNode();
+    if (!stub) {
+        return node;
+    }
+    SERIALIZATION_NAMESPACE::NodeSerializationPtr serialization = stub->getNodeSerialization();
+    if (!serialization) {
+        return node;
+    }
+
+    // If the plug-in is still not available, the stub keeps standing in
+    try {
+        getPluginBinary(QString::fromUtf8( serialization->_pluginID.c_str() ), serialization->_pluginMajorVersion, -1, false);
+    } catch (const std::exception&) {
+        return node;
+    }
+
+    NodeCollectionPtr group = node->getGroup();
+    if (!group) {
+        return node;
+    }
+
+    // Record the nodes fed by the stub: destroying it disconnects them
+    OutputNodesMap outputs;
+    node->getOutputs(outputs);
+
+    node->destroyNode();
+
+    // Re-create the real node the same way the project load would have without fast open:
+    // this also restores the input connections and knob links from the serialization
+    SERIALIZATION_NAMESPACE::NodeSerializationList serializationList;
+    serializationList.push_back(serialization);
+    NodesList createdNodes;
+    group->createNodesFromSerialization(serializationList, NodeCollection::eCreateNodesFromSerializationFlagsConnectToExternalNodes, &createdNodes);
+    if ( createdNodes.empty() || !createdNodes.front() ) {
+        return NodePtr();
+    }
+    NodePtr newNode = createdNodes.front();
+
+    // Plug the new node back into the outputs that were fed by the stub
+    for (OutputNodesMap::const_iterator it = outputs.begin(); it != outputs.end(); ++it) {
+        for (std::list<int>::const_iterator it2 = it->second.begin(); it2 != it->second.end(); ++it2) {
+            it->first->swapInput(newNode, *it2);
+        }
+    }
+
+    return newNode;
+} // AppManager::recreateNodeFromStub
+
 CacheBasePtr
 AppManager::getGeneralPurposeCache() const
 {
+    // The caches are created on the thread-pool during startup, see loadInternal()
+    _imp->cacheCreationFuture.waitForFinished();
+
     return _imp->generalPurposeCache;
 }
 
 CacheBasePtr
 AppManager::getTileCache() const
 {
+    // The caches are created on the thread-pool during startup, see loadInternal()
+    _imp->cacheCreationFuture.waitForFinished();
+
     return _imp->tileCache;
 }
 
+UndoStateStorePtr
+AppManager::getUndoStateStore() const
+{
+    assert( QThread::currentThread() == qApp->thread() );
+    if (!_imp->undoStateStore) {
+        _imp->undoStateStore.reset( new UndoStateStore() );
+    }
+
+    return _imp->undoStateStore;
+}
+
+QFuture<void>
+AppManager::getFontconfigWarmupFuture() const
+{
+    return _imp->fontconfigWarmupFuture;
+}
+
 void
 AppManager::deleteCacheEntriesInSeparateThread(const std::list<ImageStorageBasePtr> & entriesToDelete)
 {
@@ -2539,6 +2902,14 @@ AppManager::checkCachesMemory()
     _imp->storageDeleteThread->checkCachesMemory();
 }
 
+void
+AppManager::appendStorageToFlushQueue(const MemoryFilePtr& storage,
+                                      char* ptr,
+                                      std::size_t nBytes)
+{
+    _imp->storageDeleteThread->appendToFlushQueue(storage, ptr, nBytes);
+}
+
 void
 AppManager::printCacheMemoryStats() const
 {
@@ -2576,6 +2947,25 @@ AppManager::printCacheMemoryStats() const
     reportStr += QLatin1String("--> ");
     reportStr += printAsRAM(totalBytes);
     reportStr += tr(" taken by %1 cache entries.").arg(QString::number(totalNEntries));
+    reportStr += QLatin1String("\n");
+
+    // Plug-in scratch memory allocated through the memory suite: it is counted against the
+    // cache budget (see CacheBase::registerExternalMemory()) so that allocation pressure
+    // from plug-ins evicts cache entries first.
+    std::map<std::string, PluginMemoryUsageInfo> pluginMemInfos;
+    PluginMemory::getPerPluginMemoryUsage(&pluginMemInfos);
+    if ( !pluginMemInfos.empty() ) {
+        reportStr += QLatin1String("\n");
+        reportStr += tr("Plug-in memory (counted against the cache budget):");
+        reportStr += QLatin1String("\n");
+        for (std::map<std::string, PluginMemoryUsageInfo>::iterator it = pluginMemInfos.begin(); it != pluginMemInfos.end(); ++it) {
+            reportStr += QString::fromUtf8( it->first.c_str() );
+            reportStr += QLatin1String("--> ");
+            reportStr += printAsRAM(it->second.nBytes);
+            reportStr += tr(" (peak %1)").arg( printAsRAM(it->second.peakNBytes) );
+            reportStr += QLatin1String("\n");
+        }
+    }
 
     appPTR->writeToErrorLog_mt_safe(tr("Cache Report"), QDateTime::currentDateTime(), reportStr);
 
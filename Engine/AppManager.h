@@ -40,6 +40,7 @@ CLANG_DIAG_ON(deprecated)
 #include <QtCore/QStringList>
 #include <QtCore/QString>
 #include <QtCore/QProcess>
+#include <QtCore/QFuture>
 
 #if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
 #include <boost/scoped_ptr.hpp>
@@ -184,6 +185,19 @@ public:
 
     CacheBasePtr getTileCache() const;
 
+    /**
+     * @brief Returns the store retaining the serialized states held by undo commands,
+     * creating it on first use, see UndoStateStore. Only callable on the main-thread.
+     **/
+    UndoStateStorePtr getUndoStateStore() const;
+
+    /**
+     * @brief The fontconfig cache warm-up launched in loadInternal(): fontconfig persists its
+     * font caches on disk and memory-maps them, so once warmed they are shared by every
+     * subsequent process. The GUI gates its load on this future behind the splash-screen.
+     **/
+    QFuture<void> getFontconfigWarmupFuture() const;
+
     void deleteCacheEntriesInSeparateThread(const std::list<ImageStorageBasePtr> & entriesToDelete);
 
     /**
@@ -192,6 +206,12 @@ public:
      **/
     void checkCachesMemory();
 
+    /**
+     * @brief Appends a dirty byte range of a memory mapped cache storage file to the write-behind
+     * flusher of the StorageDeleterThread. See StorageDeleterThread::appendToFlushQueue
+     **/
+    void appendStorageToFlushQueue(const MemoryFilePtr& storage, char* ptr, std::size_t nBytes);
+
     SettingsPtr getCurrentSettings() const WARN_UNUSED_RETURN;
     const KnobFactory & getKnobFactory() const WARN_UNUSED_RETURN;
 
@@ -203,6 +223,13 @@ public:
      **/
     bool writeToOutputPipe(const QString & longMessage, const QString & shortMessage, bool printIfNoChannel);
 
+    /**
+     * @brief If the current process is a background process launched from the GUI with a
+     * shared memory frame ring, returns the ring where rendered frame previews should be
+     * published, see ProcessFrameRing. Returns NULL otherwise.
+     **/
+    ProcessFrameRing* getBackgroundFrameRing() const;
+
     /**
      * @brief Abort any processing on all AppInstance. It is called in some very rare cases
      * such as when changing the number of threads used by the application or when a background render
@@ -460,6 +487,14 @@ public:
 
     virtual NodePtr createNodeForProjectLoading(const SERIALIZATION_NAMESPACE::NodeSerializationPtr& serialization, const NodeCollectionPtr& group);
 
+    /**
+     * @brief If the given node is a Stub (created either because its plug-in was missing or by
+     * the fast project open mode), re-create the real node from the serialization held by the
+     * stub and plug it back into the graph in place of the stub. Returns the given node
+     * unchanged if it is not a stub or if the plug-in is still unavailable.
+     **/
+    NodePtr recreateNodeFromStub(const NodePtr& node);
+
     virtual void aboutToSaveProject(SERIALIZATION_NAMESPACE::ProjectSerialization* /*serialization*/) {}
 
     static void setApplicationLocale();
@@ -36,6 +36,10 @@
 #include <cassert>
 #include <stdexcept>
 #include <sstream> // stringstream
+#include <iostream>
+#include <iomanip> // setw, left
+
+#include <fontconfig/fontconfig.h>
 
 #include <QtCore/QDebug>
 #include <QtCore/QProcess>
@@ -59,8 +63,11 @@
 #include "Engine/OfxHost.h"
 #include "Engine/OSGLContext.h"
 #include "Engine/Settings.h"
+#include "Engine/ProcessFrameRing.h"
 #include "Engine/ProcessHandler.h" // ProcessInputChannel
+#include "Engine/RenderWorkerServer.h"
 #include "Engine/StandardPaths.h"
+#include "Engine/Timer.h"
 
 #include "Serialization/SerializationIO.h"
 
@@ -87,7 +94,12 @@ AppManagerPrivate::AppManagerPrivate()
     , _knobFactory( new KnobFactory() )
     , generalPurposeCache()
     , tileCache()
+    , cacheCreationFuture()
+    , fontconfigWarmupFuture()
+    , undoStateStore()
     , _backgroundIPC()
+    , _backgroundFrameRing()
+    , _workerServer()
     , _loaded(false)
     , binaryPath()
     , errorLogMutex()
@@ -112,6 +124,9 @@ AppManagerPrivate::AppManagerPrivate()
     , glVersionMinor(0)
     , renderingContextPool()
     , openGLRenderers()
+    , startupProfileEnabled(false)
+    , startupProfileMutex()
+    , startupPhaseTimes()
 {
     setMaxCacheFiles();
 }
@@ -285,6 +300,69 @@ AppManagerPrivate::declareSettingsToPython()
     }
 }
 
+void
+AppManagerPrivate::createCaches()
+{
+    TimeLapse phaseTimer;
+
+    generalPurposeCache = Cache<false>::create(false /*enableTileStorage*/);
+    try {
+
+        // If the cache is busy because another process is using it and we are not compiled
+        // with NATRON_CACHE_INTERPROCESS_ROBUST, just create a process local cache instead.
+        tileCache = Cache<true>::create(true /*enableTileStorage*/);
+#ifdef NATRON_CACHE_INTERPROCESS_ROBUST
+        mappedProcessWatcher.reset(new MappedProcessWatcherThread);
+        mappedProcessWatcher->startWatching();
+#endif
+    } catch (const BusyCacheException&) {
+        tileCache = Cache<false>::create(true /*enableTileStorage*/);
+    }
+
+    tileCache->setMaximumCacheSize( _settings->getTileCacheSize() );
+    generalPurposeCache->setMaximumCacheSize( _settings->getGeneralPurposeCacheSize() );
+
+    recordStartupPhase( "Caches creation (concurrent)", phaseTimer.getTimeSinceCreation() );
+}
+
+void
+AppManagerPrivate::warmupFontconfigCache()
+{
+    TimeLapse phaseTimer;
+
+    qDebug() << "Building Fontconfig fonts...";
+    FcConfig* fcConfig = FcInitLoadConfig();
+    FcConfigBuildFonts(fcConfig);
+    FcConfigDestroy(fcConfig);
+    qDebug() << "Fontconfig fonts built";
+
+    recordStartupPhase( "Fontconfig cache warm-up (concurrent)", phaseTimer.getTimeSinceCreation() );
+}
+
+void
+AppManagerPrivate::recordStartupPhase(const std::string& phaseName,
+                                      double timeSpentSec)
+{
+    if (!startupProfileEnabled) {
+        return;
+    }
+    QMutexLocker k(&startupProfileMutex);
+    startupPhaseTimes.push_back( std::make_pair(phaseName, timeSpentSec) );
+}
+
+void
+AppManagerPrivate::dumpStartupProfile() const
+{
+    if (!startupProfileEnabled) {
+        return;
+    }
+    QMutexLocker k(&startupProfileMutex);
+    std::cout << "Startup profile:" << std::endl;
+    for (std::list<std::pair<std::string, double> >::const_iterator it = startupPhaseTimes.begin(); it != startupPhaseTimes.end(); ++it) {
+        std::cout << "  " << std::setw(44) << std::left << it->first << Timer::printAsTime(it->second, false).toStdString() << std::endl;
+    }
+}
+
 
 void
 AppManagerPrivate::setMaxCacheFiles()
@@ -37,6 +37,7 @@ CLANG_DIAG_OFF(uninitialized)
 #include <QtCore/QString>
 #include <QtCore/QAtomicInt>
 #include <QtCore/QCoreApplication>
+#include <QtCore/QFuture>
 CLANG_DIAG_ON(uninitialized)
 
 
@@ -117,12 +118,28 @@ public:
 
     CacheBasePtr generalPurposeCache, tileCache;
 
+    // The caches are created by createCaches() running on the thread-pool concurrently with the
+    // plug-ins load, see AppManager::loadInternal(): wait on this future before accessing
+    // generalPurposeCache or tileCache.
+    QFuture<void> cacheCreationFuture;
+
+    // Fontconfig cache warm-up running on the thread-pool, see warmupFontconfigCache()
+    QFuture<void> fontconfigWarmupFuture;
+
     boost::scoped_ptr<MappedProcessWatcherThread> mappedProcessWatcher;
 
     boost::scoped_ptr<StorageDeleterThread> storageDeleteThread; // thread used to kill cache entries without blocking a render thread
 
+    // Storage for the serialized states retained by undo commands, created lazily,
+    // see AppManager::getUndoStateStore(). Only used on the main-thread
+    UndoStateStorePtr undoStateStore;
+
     boost::scoped_ptr<ProcessInputChannel> _backgroundIPC; //< object used to communicate with the main app
 
+    boost::scoped_ptr<ProcessFrameRing> _backgroundFrameRing; //< shared memory ring where rendered frame previews are published for the main app
+
+    boost::scoped_ptr<RenderWorkerServer> _workerServer; //< the http server of the render farm worker mode (--worker)
+
     //if this app is background, see the ProcessInputChannel def
     bool _loaded; //< true when the first instance is completly loaded.
 
@@ -202,6 +219,13 @@ public:
     // User add custom menu entries that point to python commands
     std::list<PythonUserCommand> pythonCommands;
 
+    // When --startup-profile is passed on the command-line, the wall-clock time (in seconds)
+    // spent in each startup phase, in completion order. Phases running concurrently overlap,
+    // hence the sum of the phases may exceed the actual startup time.
+    bool startupProfileEnabled;
+    mutable QMutex startupProfileMutex;
+    std::list<std::pair<std::string, double> > startupPhaseTimes;
+
 
 public:
     AppManagerPrivate();
@@ -224,6 +248,29 @@ public:
 
     void declareSettingsToPython();
 
+    /**
+     * @brief Creates the general purpose and tile caches. This only depends on the settings
+     * (which hold the cache storage location and maximum sizes) hence may run on the
+     * thread-pool concurrently with the rest of the startup, see AppManager::loadInternal().
+     **/
+    void createCaches();
+
+    /**
+     * @brief Builds the fontconfig font caches, which fontconfig persists on disk and
+     * memory-maps: once a process rebuilt them, all subsequent processes (e.g the renderers
+     * spawned for each chunk on a render-farm) map the caches instead of re-scanning the
+     * fonts. This may take a while the first time (or whenever fonts changed) hence runs on
+     * the thread-pool concurrently with the rest of the startup, so that plug-ins using
+     * fontconfig (e.g the Text plug-in) find a warm cache instead of paying the scan in the
+     * middle of the first render.
+     **/
+    void warmupFontconfigCache();
+
+    // The 2 functions below are no-ops unless --startup-profile was passed on the command-line
+    void recordStartupPhase(const std::string& phaseName, double timeSpentSec);
+
+    void dumpStartupProfile() const;
+
 #ifdef NATRON_USE_BREAKPAD
     void initBreakpad(const QString& breakpadPipePath, const QString& breakpadComPipePath, int breakpad_client_fd);
 
@@ -32,6 +32,15 @@
 #include <cassert>
 #include <stdexcept>
 
+// SSE2 is part of the x86-64 baseline ABI, use it for the batched segment evaluation below.
+#if defined(__SSE2__) || defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 2 )
+#define NATRON_BEZIER_EVAL_USE_SSE2
+#endif
+
+#ifdef NATRON_BEZIER_EVAL_USE_SSE2
+#include <emmintrin.h> // SSE2
+#endif
+
 #include <QtCore/QThread>
 #include <QCoreApplication>
 #include <QtCore/QLineF>
@@ -130,12 +139,17 @@ struct BezierPrivate
     // When it is a render clone, we cache the result of getBoundingBox()
     boost::scoped_ptr<std::map<TimeValue,RectD> > renderCloneBBoxCache;
 
+    // When it is a render clone, we also cache the result of isClockwiseOriented()
+    // which is queried for each motion-blur sample
+    boost::scoped_ptr<std::map<TimeValue,bool> > renderCloneClockwiseCache;
+
     BezierPrivate(const std::string& baseName, bool isOpenBezier)
     : itemMutex()
     , viewShapes()
     , isOpenBezier(isOpenBezier)
     , baseName(baseName)
     , renderCloneBBoxCache()
+    , renderCloneClockwiseCache()
     {
         viewShapes.insert(std::make_pair(ViewIdx(0), BezierShape()));
     }
@@ -144,6 +158,7 @@ struct BezierPrivate
     : itemMutex()
     , viewShapes()
     , renderCloneBBoxCache()
+    , renderCloneClockwiseCache()
     {
         isOpenBezier = other.isOpenBezier;
         baseName = other.baseName;
@@ -452,7 +467,6 @@ Bezier::bezierPoint(const Point & p0,
     bezierFullPoint(p0, p1, p2, p3, t, &p0p1, &p1p2, &p2p3, &p0p1_p1p2, &p1p2_p2p3, dest);
 }
 
-#if 0 //UNUSED CODE
 // compute polynomial coefficients so that
 // P(t) = A*t^3 + B*t^2 + C*t + D
 static inline void
@@ -486,7 +500,44 @@ bezierPolyCoeffs(double p0,
     *a = p3 - 3 * p2 + 3 * p1 - p0;
 }
 
+// evaluate the segment at multiple parameter values at once: the power-basis coefficients are
+// computed a single time for the whole batch so that each point costs one polynomial evaluation
+// instead of the full de Casteljau cascade.
+void
+Bezier::bezierPointBatch(const Point & p0,
+                         const Point & p1,
+                         const Point & p2,
+                         const Point & p3,
+                         const double* t,
+                         int nbValues,
+                         Point* dest)
+{
+    double ax, bx, cx, dx, ay, by, cy, dy;
+
+    bezierPolyCoeffs(p0.x, p1.x, p2.x, p3.x, &ax, &bx, &cx, &dx);
+    bezierPolyCoeffs(p0.y, p1.y, p2.y, p3.y, &ay, &by, &cy, &dy);
+
+#ifdef NATRON_BEZIER_EVAL_USE_SSE2
+    // Evaluate both coordinates at once with Horner's scheme, the x/y pair packed in one register
+    const __m128d a = _mm_set_pd(ay, ax);
+    const __m128d b = _mm_set_pd(by, bx);
+    const __m128d c = _mm_set_pd(cy, cx);
+    const __m128d d = _mm_set_pd(dy, dx);
+    for (int i = 0; i < nbValues; ++i) {
+        const __m128d tv = _mm_set1_pd(t[i]);
+        __m128d r = _mm_add_pd(_mm_mul_pd(a, tv), b);
+        r = _mm_add_pd(_mm_mul_pd(r, tv), c);
+        r = _mm_add_pd(_mm_mul_pd(r, tv), d);
+        _mm_storeu_pd(&dest[i].x, r);
+    }
+#else
+    for (int i = 0; i < nbValues; ++i) {
+        const double tv = t[i];
+        dest[i].x = ( (ax * tv + bx) * tv + cx ) * tv + dx;
+        dest[i].y = ( (ay * tv + by) * tv + cy ) * tv + dy;
+    }
 #endif
+} // bezierPointBatch
 
 // compute polynomial coefficients so that
 // P'(t) = A*t^2 + B*t + C
@@ -1037,16 +1088,26 @@ bezierSegmentEval(const Point& p0,
             }
 
             double incr = 1. / (double)(nbPointsPerSegment - 1);
-            Point cur;
-            for (int i = skipFirstPoint ? 1 : 0; i < nbPointsPerSegment; ++i) {
-                ParametricPoint p;
-                p.t = incr * i;
-                Bezier::bezierPoint(p0, p1, p2, p3, p.t, &cur);
-                p.t += segmentIndex;
-                p.x = cur.x;
-                p.y = cur.y;
-                assert(!bbox || bbox->contains(p.x, p.y));
-                points->push_back(p);
+
+            // Evaluate the whole segment in one batch: the polynomial coefficients are computed
+            // once instead of running the de Casteljau cascade for each point.
+            const int firstPoint = skipFirstPoint ? 1 : 0;
+            if (firstPoint < nbPointsPerSegment) {
+                std::vector<double> ts(nbPointsPerSegment - firstPoint);
+                for (std::size_t i = 0; i < ts.size(); ++i) {
+                    ts[i] = incr * (firstPoint + i);
+                }
+                std::vector<Point> evaluated( ts.size() );
+                Bezier::bezierPointBatch(p0, p1, p2, p3, &ts[0], (int)ts.size(), &evaluated[0]);
+
+                for (std::size_t i = 0; i < ts.size(); ++i) {
+                    ParametricPoint p;
+                    p.t = ts[i] + segmentIndex;
+                    p.x = evaluated[i].x;
+                    p.y = evaluated[i].y;
+                    assert(!bbox || bbox->contains(p.x, p.y));
+                    points->push_back(p);
+                }
             }
         }   break;
 
@@ -1089,12 +1150,6 @@ bezierSegmentMeetsPoint(const BezierCP & first,
     p2 = Transform::matApply(transform, p2);
     p3 = Transform::matApply(transform, p3);
 
-    ///Use the control polygon to approximate segment length
-    double length = ( std::sqrt( (p1.x - p0.x) * (p1.x - p0.x) + (p1.y - p0.y) * (p1.y - p0.y) ) +
-                      std::sqrt( (p2.x - p1.x) * (p2.x - p1.x) + (p2.y - p1.y) * (p2.y - p1.y) ) +
-                      std::sqrt( (p3.x - p2.x) * (p3.x - p2.x) + (p3.y - p2.y) * (p3.y - p2.y) ) );
-    // increment is the distance divided by the  segment length
-    double incr = length == 0. ? 1. : distance / length;
     Point p02d, p12d, p22d, p32d;
     {
         p02d.x = p0.x; p02d.y = p0.y;
@@ -1102,6 +1157,25 @@ bezierSegmentMeetsPoint(const BezierCP & first,
         p22d.x = p2.x; p22d.y = p2.y;
         p32d.x = p3.x; p32d.y = p3.y;
     }
+
+    // First reject the segment if the point is not even close to its control polygon bounding box:
+    // the curve is contained in the convex hull of its control polygon so this is conservative.
+    // This makes hit-testing over shapes with many segments O(1) for every segment away from the
+    // point instead of subdividing each of them.
+    {
+        RectD segmentBbox = Bezier::getBezierSegmentControlPolygonBbox(p02d, p12d, p22d, p32d);
+        segmentBbox.addPadding(distance, distance);
+        if ( !segmentBbox.contains(x, y) ) {
+            return false;
+        }
+    }
+
+    ///Use the control polygon to approximate segment length
+    double length = ( std::sqrt( (p1.x - p0.x) * (p1.x - p0.x) + (p1.y - p0.y) * (p1.y - p0.y) ) +
+                      std::sqrt( (p2.x - p1.x) * (p2.x - p1.x) + (p2.y - p1.y) * (p2.y - p1.y) ) +
+                      std::sqrt( (p3.x - p2.x) * (p3.x - p2.x) + (p3.y - p2.y) * (p3.y - p2.y) ) );
+    // increment is the distance divided by the  segment length
+    double incr = length == 0. ? 1. : distance / length;
     ///the minimum square distance between a decasteljau point an the given (x,y) point
     ///we save a sqrt call
     double sqDistance = distance * distance;
@@ -1113,16 +1187,23 @@ bezierSegmentMeetsPoint(const BezierCP & first,
     // 1/incr = 2.0 -> 3 points   +        o       o
     // 1/incr = 2.1 -> 4 points   +       o       o+
     int nbPoints = std::ceil(1. / incr) + 1;
+
+    // Batch-evaluate the whole subdivision at once, see bezierPointBatch
+    std::vector<double> ts(nbPoints);
     for (int i = 0; i < nbPoints; ++i) {
-        double t = std::min(i * incr, 1.);
+        ts[i] = std::min(i * incr, 1.);
         // the last point should be t == 1;
-        assert( t < 1 || (t == 1. && i == nbPoints - 1) );
-        Point p;
-        Bezier::bezierPoint(p02d, p12d, p22d, p32d, t, &p);
+        assert( ts[i] < 1 || (ts[i] == 1. && i == nbPoints - 1) );
+    }
+    std::vector<Point> evaluated(nbPoints);
+    Bezier::bezierPointBatch(p02d, p12d, p22d, p32d, &ts[0], nbPoints, &evaluated[0]);
+
+    for (int i = 0; i < nbPoints; ++i) {
+        const Point& p = evaluated[i];
         double sqdist = (p.x - x) * (p.x - x) + (p.y - y) * (p.y - y);
         if ( (sqdist <= sqDistance) && (sqdist < minSqDistance) ) {
             minSqDistance = sqdist;
-            tForMin = t;
+            tForMin = ts[i];
         }
     }
 
@@ -3810,7 +3891,16 @@ bool
 Bezier::isClockwiseOriented(TimeValue time, ViewIdx view) const
 {
     ViewIdx view_i = checkIfViewExistsOrFallbackMainView(view);
+    bool renderClone = isRenderClone();
     QMutexLocker k(&_imp->itemMutex);
+    if (renderClone) {
+        if (_imp->renderCloneClockwiseCache) {
+            std::map<TimeValue,bool>::iterator foundTime = _imp->renderCloneClockwiseCache->find(time);
+            if (foundTime != _imp->renderCloneClockwiseCache->end()) {
+                return foundTime->second;
+            }
+        }
+    }
     const BezierShape* shape = _imp->getViewShape(view_i);
     if (!shape) {
         return false;
@@ -3818,7 +3908,7 @@ Bezier::isClockwiseOriented(TimeValue time, ViewIdx view) const
 
     if (shape->points.size() <= 1) {
         return false;
-    } 
+    }
 
     const BezierCPs& cps = shape->points;
     double polygonSurface = 0.;
@@ -3891,10 +3981,18 @@ Bezier::isClockwiseOriented(TimeValue time, ViewIdx view) const
             //Since a triangle is half a parallelogram, just half the cross-product
             double crossProduct = v.y * u.x - v.x * u.y;
             polygonSurface += (crossProduct / 2.);
-            
+
+        }
+    }
+
+    bool clockWise = polygonSurface < 0;
+    if (renderClone) {
+        if (!_imp->renderCloneClockwiseCache) {
+            _imp->renderCloneClockwiseCache.reset(new std::map<TimeValue,bool>);
         }
+        _imp->renderCloneClockwiseCache->insert(std::make_pair(time, clockWise));
     }
-    return polygonSurface < 0;
+    return clockWise;
 
 
 } // isFeatherPolygonClockwiseOriented
@@ -134,6 +134,20 @@ public:
                             double t,
                             Point *dest);
 
+    /**
+     * @brief Evaluates the segment at the nbValues parameter values in t at once.
+     * The power-basis coefficients of the segment are computed a single time for the whole batch
+     * so that each point costs one polynomial evaluation instead of the full de Casteljau cascade:
+     * the rasterization and hit-testing paths evaluate thousands of points per shape per frame.
+     **/
+    static void bezierPointBatch(const Point & p0,
+                                 const Point & p1,
+                                 const Point & p2,
+                                 const Point & p3,
+                                 const double* t,
+                                 int nbValues,
+                                 Point* dest);
+
     static RectD getBezierSegmentControlPolygonBbox(const Point & p0,
                                                     const Point & p1,
                                                     const Point & p2,
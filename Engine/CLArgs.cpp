@@ -62,7 +62,10 @@ public:
     bool useDefaultSettings;
     bool clearCacheOnLaunch;
     bool clearPluginCacheOnLaunch;
+    bool startupProfileEnabled;
     QString ipcPipe;
+    QString frameRingName;
+    int workerPort;
     int error;
     bool isInterpreterMode;
     std::list<std::pair<int, std::pair<int, int> > > frameRanges;
@@ -76,6 +79,7 @@ public:
     QString breakpadProcessFilePath;
     qint64 breakpadProcessPID;
     QString exportDocsPath;
+    QString perfLogFilePath;
 
     CLArgsPrivate()
         : args()
@@ -90,7 +94,10 @@ public:
         , useDefaultSettings(false)
         , clearCacheOnLaunch(false)
         , clearPluginCacheOnLaunch(false)
+        , startupProfileEnabled(false)
         , ipcPipe()
+        , frameRingName()
+        , workerPort(0)
         , error(0)
         , isInterpreterMode(false)
         , frameRanges()
@@ -104,6 +111,7 @@ public:
         , breakpadProcessFilePath()
         , breakpadProcessPID(-1)
         , exportDocsPath()
+        , perfLogFilePath()
     {
     }
 
@@ -221,12 +229,16 @@ CLArgs::operator=(const CLArgs& other)
     _imp->isPythonScript = other._imp->isPythonScript;
     _imp->defaultOnProjectLoadedScript = other._imp->defaultOnProjectLoadedScript;
     _imp->clearCacheOnLaunch = other._imp->clearCacheOnLaunch;
+    _imp->clearPluginCacheOnLaunch = other._imp->clearPluginCacheOnLaunch;
+    _imp->startupProfileEnabled = other._imp->startupProfileEnabled;
     _imp->writers = other._imp->writers;
     _imp->readers = other._imp->readers;
     _imp->pythonCommands = other._imp->pythonCommands;
     _imp->settingCommands = other._imp->settingCommands;
     _imp->isBackground = other._imp->isBackground;
     _imp->ipcPipe = other._imp->ipcPipe;
+    _imp->frameRingName = other._imp->frameRingName;
+    _imp->workerPort = other._imp->workerPort;
     _imp->error = other._imp->error;
     _imp->isInterpreterMode = other._imp->isInterpreterMode;
     _imp->frameRanges = other._imp->frameRanges;
@@ -235,6 +247,7 @@ CLArgs::operator=(const CLArgs& other)
     _imp->isEmpty = other._imp->isEmpty;
     _imp->imageFilename = other._imp->imageFilename;
     _imp->exportDocsPath = other._imp->exportDocsPath;
+    _imp->perfLogFilePath = other._imp->perfLogFilePath;
 }
 
 bool
@@ -283,10 +296,23 @@ CLArgs::printUsage(const std::string& programName)
         "    script: it must be started explicitely.\n"
         "    %1Renderer and %1 do the same thing in this mode, only the\n"
         "    init.py script is loaded.\n"
+        "  --worker <port>\n"
+        "    Enable render farm worker mode (implies -b): the process stays alive and\n"
+        "    listens on the given TCP port for render jobs (project and frame range\n"
+        "    assignments) instead of rendering a project given on the command line.\n"
+        "    Per-frame status is streamed back over HTTP with chunked encoding.\n"
+        "    Keeping the worker process alive between jobs avoids paying the startup\n"
+        "    cost (plug-in loading, cache opening) once per chunk of frames.\n"
         "  --clear-cache\n"
         "    Clears the cache on startup.\n"
         "  --clear-plugins-cache\n"
         "    Clears the plug-ins load cache on startup, forcing them to reload entirely.\n"
+        "  --startup-profile\n"
+        "    Print the time spent in each startup phase once %1 has finished loading.\n"
+        "  --perf-log <file path>\n"
+        "    Once the background render is finished, write a JSON file with process\n"
+        "    performance metrics (wall/CPU time, peak memory, cache activity) to the\n"
+        "    given path. Used by the regression harness in tools/perf.\n"
         "  --no-settings\n"
         "    When passed on the command-line, the %1 settings will not be restored\n"
         "    from the preferences file on disk so that %1 uses the default ones.\n"
@@ -458,6 +484,12 @@ CLArgs::isPluginLoadCacheClearRequestedOnLaunch() const
     return _imp->clearPluginCacheOnLaunch;
 }
 
+bool
+CLArgs::isStartupProfileRequested() const
+{
+    return _imp->startupProfileEnabled;
+}
+
 bool
 CLArgs::isBackgroundMode() const
 {
@@ -515,6 +547,18 @@ CLArgs::getIPCPipeName() const
     return _imp->ipcPipe;
 }
 
+const QString&
+CLArgs::getFrameRingName() const
+{
+    return _imp->frameRingName;
+}
+
+int
+CLArgs::getWorkerPort() const
+{
+    return _imp->workerPort;
+}
+
 bool
 CLArgs::areRenderStatsEnabled() const
 {
@@ -563,6 +607,12 @@ CLArgs::getExportDocsPath() const
     return _imp->exportDocsPath;
 }
 
+const QString &
+CLArgs::getPerfLogFilePath() const
+{
+    return _imp->perfLogFilePath;
+}
+
 QStringList::iterator
 CLArgsPrivate::findFileNameWithExtension(const QString& extension)
 {
@@ -775,6 +825,14 @@ CLArgsPrivate::parse()
         }
     }
 
+    {
+        QStringList::iterator it = hasToken( QString::fromUtf8("startup-profile"), QString() );
+        if ( it != args.end() ) {
+            startupProfileEnabled = true;
+            args.erase(it);
+        }
+    }
+
 
 
     {
@@ -804,6 +862,25 @@ CLArgsPrivate::parse()
         }
     }
 
+    {
+        QStringList::iterator it = hasToken( QString::fromUtf8("worker"), QString() );
+        if ( it != args.end() ) {
+            ++it;
+            bool ok = false;
+            if ( it != args.end() ) {
+                workerPort = it->toInt(&ok);
+                args.erase(it);
+            }
+            if (!ok || workerPort <= 0) {
+                std::cout << tr("You must specify the TCP port of the worker server").toStdString() << std::endl;
+                error = 1;
+
+                return;
+            }
+            isBackground = true;
+        }
+    }
+
     {
         QStringList::iterator it = hasToken( QString::fromUtf8("render-stats"), QString::fromUtf8("s") );
         if ( it != args.end() ) {
@@ -892,6 +969,22 @@ CLArgsPrivate::parse()
         }
     }
 
+    {
+        QStringList::iterator it = hasToken( QString::fromUtf8("perf-log"), QString() );
+        if ( it != args.end() ) {
+            ++it;
+            if ( it != args.end() ) {
+                perfLogFilePath = *it;
+                args.erase(it);
+            } else {
+                std::cout << tr("You must specify a file path with the --perf-log option").toStdString() << std::endl;
+                error = 1;
+
+                return;
+            }
+        }
+    }
+
     {
         QStringList::iterator it = hasToken( QString::fromUtf8("export-docs"), QString() );
         if ( it != args.end() ) {
@@ -924,6 +1017,22 @@ CLArgsPrivate::parse()
         }
     }
 
+    {
+        QStringList::iterator it = hasToken( QString::fromUtf8("IPCframering"), QString() );
+        if ( it != args.end() ) {
+            ++it;
+            if ( it != args.end() ) {
+                frameRingName = *it;
+                args.erase(it);
+            } else {
+                std::cout << tr("You must specify the shared memory frame ring name").toStdString() << std::endl;
+                error = 1;
+
+                return;
+            }
+        }
+    }
+
     {
         QStringList::iterator it = hasToken( QString::fromUtf8("onload"), QString::fromUtf8("l") );
         if ( it != args.end() ) {
@@ -961,7 +1070,8 @@ CLArgsPrivate::parse()
         QStringList::iterator it = findFileNameWithExtension( QString::fromUtf8(NATRON_PROJECT_FILE_EXT) );
         if ( it == args.end() ) {
             it = findFileNameWithExtension( QString::fromUtf8("py") );
-            if ( ( it == args.end() ) && !isInterpreterMode && isBackground ) {
+            // In worker mode there is no project on the command line, jobs assign one later
+            if ( ( it == args.end() ) && !isInterpreterMode && (workerPort == 0) && isBackground ) {
                 std::cout << tr("You must specify the filename of a script or %1 project. (.%2)").arg( QString::fromUtf8(NATRON_APPLICATION_NAME) ).arg( QString::fromUtf8(NATRON_PROJECT_FILE_EXT) ).toStdString() << std::endl;
                 error = 1;
 
@@ -114,6 +114,8 @@ public:
 
     bool isPluginLoadCacheClearRequestedOnLaunch() const;
 
+    bool isStartupProfileRequested() const;
+
     /*
      * @brief Has a Natron project or Python script been passed to the command line ?
      */
@@ -127,6 +129,13 @@ public:
     const QString& getImageFilename() const;
     const QString& getDefaultOnProjectLoadedScript() const;
     const QString& getIPCPipeName() const;
+    const QString& getFrameRingName() const;
+
+    /**
+     * @brief The TCP port given with the --worker option, 0 when not in render farm
+     * worker mode. See RenderWorkerServer.
+     **/
+    int getWorkerPort() const;
 
     bool isPythonScript() const;
 
@@ -142,6 +151,12 @@ public:
     const QString& getBreakpadComPipeFilePath() const;
     const QString& getExportDocsPath() const;
 
+    /*
+     * @brief If non empty, NatronRenderer writes a JSON file with process-wide
+     * performance metrics to this path once the background render is finished.
+     */
+    const QString& getPerfLogFilePath() const;
+
 private:
 
     boost::scoped_ptr<CLArgsPrivate> _imp;
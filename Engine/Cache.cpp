@@ -33,6 +33,7 @@
 #include <time.h>
 #endif
 
+#include <QAtomicInt>
 #include <QMutex>
 #include <QDir>
 #include <QWaitCondition>
@@ -101,10 +102,21 @@ GCC_DIAG_ON(unused-parameter)
 #define NATRON_CACHE_BUCKET_TOC_FILE_GROW_N_BYTES 524288 // = 512 * 1024
 
 // Used to prevent loading older caches when we change the serialization scheme
+#ifdef NATRON_HASH64_USE_LEGACY_CRC
+// With the legacy CRC-64 backend of Hash64, cache keys match those persisted by older builds,
+// so the caches they wrote may still be loaded.
 #define NATRON_CACHE_SERIALIZATION_VERSION 5
+#else
+// The xxHash64 backend of Hash64 produces different keys, see Hash64::computeHash()
+#define NATRON_CACHE_SERIALIZATION_VERSION 6
+#endif
 
 // If we change the MemorySegmentEntryHeader struct, we must increment this version so we do not attempt to read an invalid structure.
-#define NATRON_MEMORY_SEGMENT_ENTRY_HEADER_VERSION 2
+#define NATRON_MEMORY_SEGMENT_ENTRY_HEADER_VERSION 3
+
+// Maximum number of LRU list nodes that evictLRUEntries may give a second chance to
+// in a single sweep of a bucket before picking a victim anyway.
+#define NATRON_CACHE_CLOCK_MAX_SECOND_CHANCES 100
 
 
 // After this amount of milliseconds, if a thread is not able to access a mutex, the cache is assumed to be inconsistent
@@ -118,7 +130,7 @@ GCC_DIAG_ON(unused-parameter)
 // of the first bucket.
 #define NATRON_NUM_TILES_PER_BUCKET_FILE 256
 #define NATRON_NUM_TILES_PER_FILE (NATRON_NUM_TILES_PER_BUCKET_FILE * NATRON_CACHE_BUCKETS_COUNT)
-#define NATRON_TILE_STORAGE_FILE_SIZE (NATRON_TILE_SIZE_BYTES * NATRON_NUM_TILES_PER_FILE)
+#define NATRON_TILE_STORAGE_FILE_SIZE (NATRON_TILE_STORAGE_BYTES * NATRON_NUM_TILES_PER_FILE)
 
 //#define CACHE_TRACE_ENTRY_ACCESS
 //#define CACHE_TRACE_TIMEOUTS
@@ -566,10 +578,18 @@ struct LRUListNode
     LRUListNodePtr prev, next;
     U64 hash;
 
+    // CLOCK (second-chance) flag: set on a cache hit instead of re-linking the node
+    // to the back of the list, so that the get() fast path does not need to take the
+    // lruListMutex in write mode. The evictLRUEntries function clears the flag and
+    // does the re-ordering when looking for a victim, where contention does not matter.
+    // This is only a hint: concurrent unguarded writes at worst lose a hit.
+    bool visited;
+
     LRUListNode()
     : prev(0)
     , next(0)
     , hash(0)
+    , visited(false)
     {
 
     }
@@ -920,16 +940,57 @@ struct CacheBucket
     // as long as tocFile is mapped
     IPCData *ipc;
 
+    // Process-local RCU-style read index over the ready entries of this bucket.
+    // Only used when the cache is non-persistent: in this mode a cache hit is the
+    // overwhelmingly common case during playback and should not contend on the
+    // bucketMutex. The map pointed to is immutable once published: writers (which
+    // already hold the bucketMutex in write mode) swap in a whole new map with
+    // boost::atomic_store and readers fetch the current one with boost::atomic_load,
+    // hence the hit path is wait-free.
+    typedef std::map<U64, CacheEntryBasePtr> WaitFreeReadIndex;
+    boost::shared_ptr<const WaitFreeReadIndex> waitFreeReadIndex;
+
     CacheBucket()
     : cache()
     , tocFileManager()
     , bucketIndex(-1)
     , tocFile()
     , ipc(0)
+    , waitFreeReadIndex()
     {
 
     }
 
+    /**
+     * @brief Attempts a wait-free lookup of the given hash in the process-local read index.
+     * This does not take any lock. Note that a hit through this path does not refresh the
+     * LRU position of the entry: this is an accepted trade-off, the entry timestamp is still
+     * refreshed whenever the entry goes through the regular locked look-up.
+     * @returns A null pointer if the entry is not published in the index, in which case the
+     * caller must go through the regular locked look-up. Always returns a null pointer for
+     * the persistent cache.
+     **/
+    CacheEntryBasePtr waitFreeLookup(U64 hash) const;
+
+    /**
+     * @brief Publishes the given ready entry in the wait-free read index.
+     * The caller is assumed to hold the bucketMutex in write mode.
+     * No-op for the persistent cache.
+     **/
+    void publishWaitFreeEntry(U64 hash, const EntryTypePtr& entry);
+
+    /**
+     * @brief Retires the given hash from the wait-free read index.
+     * The caller is assumed to hold the bucketMutex in write mode.
+     * No-op for the persistent cache.
+     **/
+    void retireWaitFreeEntry(U64 hash);
+
+    /**
+     * @brief Drops the whole wait-free read index, e.g: when the bucket is cleared.
+     **/
+    void resetWaitFreeIndex();
+
     /**
      * @brief Deallocates the cache entry pointed to by cacheEntryIt from the ToC memory mapped file.
      * This function assumes that tocData.segmentMutex must be taken in write mode
@@ -1320,6 +1381,13 @@ struct CachePrivate
 
     bool useTileStorage;
 
+    // Live activity counters, exposed by getActivityStats(). Lock-free so the get()
+    // fast path does not gain a process-wide mutex.
+    QAtomicInt nHitsCounter;
+    QAtomicInt nMissesCounter;
+    QAtomicInt nPendingWaitsCounter;
+    QAtomicInt nEvictionsCounter;
+
     CachePrivate(Cache<persistent>* publicInterface, bool enableTileStorage)
     : _publicInterface(publicInterface)
     , maximumSize((std::size_t)8 * 1024 * 1024 * 1024) // 8GB max by default
@@ -1343,6 +1411,10 @@ struct CachePrivate
     , nThreadsTimedOutFailedCond()
 #endif
     , useTileStorage(enableTileStorage)
+    , nHitsCounter()
+    , nMissesCounter()
+    , nPendingWaitsCounter()
+    , nEvictionsCounter()
     {
         boost::uuids::random_generator gen;
         sessionUUID = gen();
@@ -1374,6 +1446,15 @@ struct CachePrivate
     // This function may throw a AbandonnedLockException
     void clearCacheBucket(int bucket_i);
 
+    /**
+     * @brief Called at the end of initialize() for a persistent cache when this process
+     * is the only one mapping the cache: removes entries that a previous session left in
+     * a non-ready state (crash or interrupted render). After this pass, every entry
+     * advertised by the restored table of contents is guaranteed to have its data on disk,
+     * so the session starts with a warm cache without having to re-validate entries lazily.
+     **/
+    void cleanupIncompleteEntriesOnStartup();
+
     /**
      * @brief Ensure the cache returns to a correct state. Currently it wipes the cache.
      **/
@@ -1532,6 +1613,19 @@ CacheEntryLocker<persistent>::create(const boost::shared_ptr<Cache<persistent> >
     std::size_t timeSpentWaiting = 0;
     ret->_imp->lookupAndSetStatus(&timeSpentWaiting, 0);
 
+    // Update the live activity counters with the result of the look-up
+    switch (ret->_imp->status) {
+        case CacheEntryLockerBase::eCacheEntryStatusCached:
+            cache->_imp->nHitsCounter.fetchAndAddRelaxed(1);
+            break;
+        case CacheEntryLockerBase::eCacheEntryStatusMustCompute:
+            cache->_imp->nMissesCounter.fetchAndAddRelaxed(1);
+            break;
+        case CacheEntryLockerBase::eCacheEntryStatusComputationPending:
+            cache->_imp->nPendingWaitsCounter.fetchAndAddRelaxed(1);
+            break;
+    }
+
     return ret;
 }
 
@@ -1544,6 +1638,78 @@ CacheEntryLocker<persistent>::getComputeProcessUUID() const
 }
 #endif
 
+template <>
+CacheEntryBasePtr
+CacheBucket<true>::waitFreeLookup(U64 /*hash*/) const
+{
+    // The persistent cache entries live in shared memory and must be deserialized
+    // under the bucketMutex, they cannot be served from a process-local index.
+    return CacheEntryBasePtr();
+}
+
+template <>
+CacheEntryBasePtr
+CacheBucket<false>::waitFreeLookup(U64 hash) const
+{
+    boost::shared_ptr<const WaitFreeReadIndex> index = boost::atomic_load(&waitFreeReadIndex);
+    if (!index) {
+        return CacheEntryBasePtr();
+    }
+    WaitFreeReadIndex::const_iterator found = index->find(hash);
+    if (found == index->end()) {
+        return CacheEntryBasePtr();
+    }
+    return found->second;
+}
+
+template <>
+void
+CacheBucket<true>::publishWaitFreeEntry(U64 /*hash*/, const EntryTypePtr& /*entry*/)
+{
+}
+
+template <>
+void
+CacheBucket<false>::publishWaitFreeEntry(U64 hash, const EntryTypePtr& entry)
+{
+    assert(entry->nonPersistentEntry);
+    boost::shared_ptr<const WaitFreeReadIndex> oldIndex = boost::atomic_load(&waitFreeReadIndex);
+    boost::shared_ptr<WaitFreeReadIndex> newIndex;
+    if (oldIndex) {
+        newIndex.reset(new WaitFreeReadIndex(*oldIndex));
+    } else {
+        newIndex.reset(new WaitFreeReadIndex);
+    }
+    (*newIndex)[hash] = entry->nonPersistentEntry;
+    boost::atomic_store(&waitFreeReadIndex, boost::shared_ptr<const WaitFreeReadIndex>(newIndex));
+}
+
+template <>
+void
+CacheBucket<true>::retireWaitFreeEntry(U64 /*hash*/)
+{
+}
+
+template <>
+void
+CacheBucket<false>::retireWaitFreeEntry(U64 hash)
+{
+    boost::shared_ptr<const WaitFreeReadIndex> oldIndex = boost::atomic_load(&waitFreeReadIndex);
+    if (!oldIndex || oldIndex->find(hash) == oldIndex->end()) {
+        return;
+    }
+    boost::shared_ptr<WaitFreeReadIndex> newIndex(new WaitFreeReadIndex(*oldIndex));
+    newIndex->erase(hash);
+    boost::atomic_store(&waitFreeReadIndex, boost::shared_ptr<const WaitFreeReadIndex>(newIndex));
+}
+
+template <bool persistent>
+void
+CacheBucket<persistent>::resetWaitFreeIndex()
+{
+    boost::atomic_store(&waitFreeReadIndex, boost::shared_ptr<const WaitFreeReadIndex>());
+}
+
 template <bool persistent>
 bool
 CacheBucket<persistent>::isToCFileMappingValid() const
@@ -1713,6 +1879,18 @@ void flushMemory(const MemoryFilePtr& storage, int flag, char* ptr, std::size_t
 template <>
 void flushMemory(const ProcessLocalBufferPtr& /*storage*/, int /*flag*/, char* /*ptr*/, std::size_t /*numBytes*/) {}
 
+template <typename StoragePtrType>
+void scheduleWriteBehindFlush(const StoragePtrType& storage, char* ptr, std::size_t numBytes);
+
+template <>
+void scheduleWriteBehindFlush(const MemoryFilePtr& storage, char* ptr, std::size_t numBytes)
+{
+    appPTR->appendStorageToFlushQueue(storage, ptr, numBytes);
+}
+
+template <>
+void scheduleWriteBehindFlush(const ProcessLocalBufferPtr& /*storage*/, char* /*ptr*/, std::size_t /*numBytes*/) {}
+
 
 template <bool persistent>
 void
@@ -1898,40 +2076,15 @@ CacheBucket<persistent>::readFromSharedMemoryEntryImpl(EntryType* cacheEntry,
     } // persistent
 
 
-    // Update LRU record if this item is not already at the tail of the list
-    //
-    // Take the LRU list mutex
-    {
-        boost::scoped_ptr<ExclusiveLock> lruWriteLock;
-        createLock<ExclusiveLock>(c->_imp.get(), lruWriteLock, &c->_imp->ipc->bucketsData[bucketIndex].lruListMutex);
-
-        // Ensure the back pointer doesn't have a next element
-        assert(ipc->lruListBack && !ipc->lruListBack->next);
-
-        // Make this node is the back node
-        if (getRawPointer(ipc->lruListBack) != &cacheEntry->lruNode) {
-
-            // If we are not the back pointer we must have a next element.
-            assert(cacheEntry->lruNode.next);
+    // Record the hit with the CLOCK (second-chance) policy: just raise the visited flag
+    // instead of re-linking the node to the back of the list, which would require taking
+    // the lruListMutex in write mode on every single get() and was a measurable source of
+    // contention on many-core renders. The list is lazily re-ordered in evictLRUEntries.
+    cacheEntry->lruNode.visited = true;
 
-            LRUListNodePtr entryNode(&cacheEntry->lruNode);
-
-            if (&cacheEntry->lruNode == getRawPointer(ipc->lruListFront)) {
-                // We are the first node, we can't have a previous entry
-                assert(!cacheEntry->lruNode.prev);
-                ipc->lruListFront = cacheEntry->lruNode.next;
-            }
-
-            disconnectLinkedListNode(entryNode);
-
-            // And push_back to the tail of the list...
-            appendLinkedListNode(entryNode, ipc->lruListBack);
-            ipc->lruListBack = entryNode;
-        }
-
-        // Update the entry access timestamp
-        cacheEntry->timestamp = getTimestampInSeconds();
-    } // lruWriteLock
+    // Update the entry access timestamp. This is unguarded on purpose: a torn read in
+    // evictLRUEntries at worst mis-orders two candidate victims across buckets.
+    cacheEntry->timestamp = getTimestampInSeconds();
 
     return eShmEntryReadRetCodeOk;
 
@@ -1964,12 +2117,15 @@ CacheBucket<persistent>::deallocateCacheEntryImpl(typename EntriesMap::iterator
 
     assert(cacheEntryIt != storage->end());
 
+    // Make sure the wait-free hit path can no longer return this entry.
+    retireWaitFreeEntry(cacheEntryIt->first);
+
     ipc->size -= cacheEntryIt->second->size;
 
     // Clear allocated tiles for this entry
     if (!cacheEntryIt->second->tileIndices.empty()) {
 
-        ipc->size -= cacheEntryIt->second->tileIndices.size() * NATRON_TILE_SIZE_BYTES;
+        ipc->size -= cacheEntryIt->second->tileIndices.size() * NATRON_TILE_STORAGE_BYTES;
 
         // Take the tilesStorageMutex in read mode to indicate that we are operating on it (flush)
         boost::scoped_ptr<Sharable_ReadLock> tileAlignedFileLock;
@@ -1987,8 +2143,8 @@ CacheBucket<persistent>::deallocateCacheEntryImpl(typename EntriesMap::iterator
                     storage = c->_imp->tilesStorage[fileIndex];
                 }
                 if (storage) {
-                    std::size_t dataOffset = tileIndex * NATRON_TILE_SIZE_BYTES;
-                    flushMemory(storage, (int)MemoryFile::eFlushTypeInvalidate, storage->getData() + dataOffset, NATRON_TILE_SIZE_BYTES);
+                    std::size_t dataOffset = tileIndex * NATRON_TILE_STORAGE_BYTES;
+                    flushMemory(storage, (int)MemoryFile::eFlushTypeInvalidate, storage->getData() + dataOffset, NATRON_TILE_STORAGE_BYTES);
                 }
                 
             }
@@ -2415,6 +2571,17 @@ CacheEntryLockerPrivate<persistent>::lookupAndSetStatus(std::size_t* timeSpentWa
         bucket = &cache->_imp->buckets[CacheBase::getBucketCacheBucketIndex(hash)];
     }
 
+    if (!persistent) {
+        // Fast path: during playback the overwhelmingly common case is a cache hit,
+        // serve it from the wait-free read index without ever touching the bucketMutex.
+        CacheEntryBasePtr cachedEntry = bucket->waitFreeLookup(hash);
+        if (cachedEntry) {
+            processLocalEntry = cachedEntry;
+            status = CacheEntryLockerBase::eCacheEntryStatusCached;
+            return;
+        }
+    }
+
 #ifdef NATRON_CACHE_INTERPROCESS_ROBUST
     boost::scoped_ptr<SharedMemoryProcessLocalReadLocker<persistent> > shmAccess(new SharedMemoryProcessLocalReadLocker<persistent>(cache->_imp.get()));
 #endif
@@ -2607,6 +2774,7 @@ CacheEntryLockerPrivate<persistent>::insertInternal()
         cacheEntryIt->second->lruNode.prev = 0;
         cacheEntryIt->second->lruNode.next = 0;
         cacheEntryIt->second->lruNode.hash = hash;
+        cacheEntryIt->second->lruNode.visited = false;
 
         LRUListNodePtr thisNodePtr = LRUListNodePtr(&cacheEntryIt->second->lruNode);
         if (!bucket->ipc->lruListBack) {
@@ -2633,6 +2801,9 @@ CacheEntryLockerPrivate<persistent>::insertInternal()
     cacheEntryIt->second->computeThreadMagic = 0;
     cacheEntryIt->second->status = MemorySegmentEntryHeaderBase::eEntryStatusReady;
 
+    // The entry is ready: make it visible to the wait-free hit path.
+    bucket->publishWaitFreeEntry(hash, cacheEntryIt->second);
+
     status = CacheEntryLockerBase::eCacheEntryStatusCached;
     
 #ifdef CACHE_TRACE_ENTRY_ACCESS
@@ -2928,6 +3099,56 @@ Cache<persistent>::isUUIDCurrentlyActive(const boost::uuids::uuid& tag) const
 }
 #endif
 
+template <bool persistent>
+void
+CachePrivate<persistent>::cleanupIncompleteEntriesOnStartup()
+{
+#ifdef NATRON_CACHE_INTERPROCESS_ROBUST
+    boost::scoped_ptr<SharedMemoryProcessLocalReadLocker<persistent> > shmReader(new SharedMemoryProcessLocalReadLocker<persistent>(this));
+#endif
+
+    for (int bucket_i = 0; bucket_i < NATRON_CACHE_BUCKETS_COUNT; ++bucket_i) {
+        CacheBucket<persistent>& bucket = buckets[bucket_i];
+
+        try {
+            // Take the read lock on the toc file mapping
+            boost::scoped_ptr<Sharable_ReadLock> tocReadLock;
+            boost::scoped_ptr<Sharable_WriteLock> tocWriteLock;
+            bucket.checkToCMemorySegmentStatus(&tocReadLock, &tocWriteLock);
+
+            // Take write lock on the bucket
+            boost::scoped_ptr<Sharable_WriteLock> bucketLock;
+            createLock<Sharable_WriteLock>(this, bucketLock, &ipc->bucketsData[bucket_i].bucketMutex);
+
+            BucketStateHandler_RAII<persistent> bucketStateHandler(&bucket);
+
+            typedef typename CacheBucket<persistent>::EntryType EntryType;
+            typename CacheBucket<persistent>::EntriesMap::iterator it = bucket.ipc->entriesMap.begin();
+            while ( it != bucket.ipc->entriesMap.end() ) {
+                if (it->second->status != EntryType::eEntryStatusReady) {
+                    // The entry was still being computed (or was never computed) when the
+                    // previous session ended: its data cannot be trusted, reclaim it along
+                    // with its tiles.
+                    typename CacheBucket<persistent>::EntriesMap::iterator next = it;
+                    ++next;
+                    bucket.deallocateCacheEntryImpl(it, &bucket.ipc->entriesMap);
+                    it = next;
+                } else {
+                    ++it;
+                }
+            }
+        } catch (...) {
+            // Any exception caught here means the cache is corrupted
+            recoverFromInconsistentState(
+#ifdef NATRON_CACHE_INTERPROCESS_ROBUST
+                                         shmReader
+#endif
+                                         );
+            return;
+        }
+    } // for each bucket
+} // cleanupIncompleteEntriesOnStartup
+
 template <bool persistent>
 void
 Cache<persistent>::initialize(const boost::shared_ptr<Cache<persistent> >& thisShared)
@@ -3164,9 +3385,16 @@ Cache<persistent>::initialize(const boost::shared_ptr<Cache<persistent> >& thisS
         } catch (...) {
             clear();
         }
+
+        if (gotFileLock) {
+            // We are the only process mapping the cache: purge entries that a previous
+            // session (which may have crashed) left in a non-ready state so that the
+            // table of contents we just restored only advertises usable entries.
+            _imp->cleanupIncompleteEntriesOnStartup();
+        }
     } // persistent
-    
-    
+
+
 
 } // initialize
 
@@ -3512,8 +3740,8 @@ Cache<persistent>::retrieveAndLockTiles(const CacheEntryBasePtr& entry,
                 char* data = (*storage)->getData();
 
                 // Set the tile index on the entry so we can free it afterwards.
-                char* ptr = data + tileIndex * NATRON_TILE_SIZE_BYTES;
-                assert((ptr >= data) && (ptr < (data + NATRON_NUM_TILES_PER_FILE * NATRON_TILE_SIZE_BYTES)));
+                char* ptr = data + tileIndex * NATRON_TILE_STORAGE_BYTES;
+                assert((ptr >= data) && (ptr < (data + NATRON_NUM_TILES_PER_FILE * NATRON_TILE_STORAGE_BYTES)));
                 (*allocatedTilesData)[i] = std::make_pair(freeTileEncodedIndex, ptr);
 
             } // for each tile to allocate
@@ -3560,7 +3788,7 @@ Cache<persistent>::retrieveAndLockTiles(const CacheEntryBasePtr& entry,
                 cacheEntry = found->second.get();
 
                 // Increment the size of the entry in the cache
-                bucket.ipc->size += tilesToAlloc->size() * NATRON_TILE_SIZE_BYTES;
+                bucket.ipc->size += tilesToAlloc->size() * NATRON_TILE_STORAGE_BYTES;
             }
 
             // Actually add the allocated tile indices in the cache entry so that we can free them when the cache entry gets destroyed.
@@ -3637,8 +3865,17 @@ Cache<persistent>::retrieveAndLockTiles(const CacheEntryBasePtr& entry,
 
         if (tileIndices && !tileIndices->empty()) {
             existingTilesData->resize(tileIndices->size());
+
+            // For the persistent cache, gather the tile ranges per storage file so we can issue
+            // a single batched asynchronous read-ahead per file below. Without it, the first
+            // access to each tile in the copy loop triggers a blocking page-fault, which
+            // serializes dozens of small reads per frame when the cache sits on a slow or
+            // network filesystem.
+            typedef std::map<typename CachePrivate<persistent>::StoragePtrType, std::vector<char*> > PerStorageTilePtrsMap;
+            PerStorageTilePtrsMap tilesToPrefetch;
+
             for (std::size_t i = 0; i < tileIndices->size(); ++i) {
-                
+
                 U32 fileIndex, tileIndex;
                 getTileIndex((*tileIndices)[i], &tileIndex, &fileIndex);
                 typename CachePrivate<persistent>::StoragePtrType* storage = 0;
@@ -3652,10 +3889,30 @@ Cache<persistent>::retrieveAndLockTiles(const CacheEntryBasePtr& entry,
 
 
                 char* data = (*storage)->getData();
-                char* tileDataPtr = data + tileIndex * NATRON_TILE_SIZE_BYTES;
-                assert((tileDataPtr >= data) && (tileDataPtr < (data + NATRON_NUM_TILES_PER_FILE * NATRON_TILE_SIZE_BYTES)));
+                char* tileDataPtr = data + tileIndex * NATRON_TILE_STORAGE_BYTES;
+                assert((tileDataPtr >= data) && (tileDataPtr < (data + NATRON_NUM_TILES_PER_FILE * NATRON_TILE_STORAGE_BYTES)));
                 (*existingTilesData)[i] = tileDataPtr;
+                if (persistent) {
+                    tilesToPrefetch[*storage].push_back(tileDataPtr);
+                }
             } // for each tile indices
+
+            // Submit the read-ahead of all fetched tiles in one pass, coalescing contiguous
+            // tiles into a single range. The kernel overlaps these reads with whatever the
+            // caller does next (typically rendering the non-cached tiles).
+            for (typename PerStorageTilePtrsMap::iterator it = tilesToPrefetch.begin(); it != tilesToPrefetch.end(); ++it) {
+                std::vector<char*>& ptrs = it->second;
+                std::sort(ptrs.begin(), ptrs.end());
+                std::size_t rangeStart_i = 0;
+                for (std::size_t i = 1; i <= ptrs.size(); ++i) {
+                    if (i < ptrs.size() && ptrs[i] == ptrs[i - 1] + NATRON_TILE_STORAGE_BYTES) {
+                        continue;
+                    }
+                    std::size_t rangeNBytes = (i - rangeStart_i) * NATRON_TILE_STORAGE_BYTES;
+                    flushMemory(it->first, (int)MemoryFile::eFlushTypePrefetch, ptrs[rangeStart_i], rangeNBytes);
+                    rangeStart_i = i;
+                }
+            }
         }
     } catch (...) {
 
@@ -3692,8 +3949,8 @@ Cache<persistent>::checkTileIndex(U64 encodedIndex) const
         return false;
     }
     char* data = _imp->tilesStorage[fileIndex]->getData();
-    char* tileDataPtr = data + tileIndex * NATRON_TILE_SIZE_BYTES;
-    if (tileDataPtr < data || tileDataPtr >= (data + NATRON_NUM_TILES_PER_FILE * NATRON_TILE_SIZE_BYTES)) {
+    char* tileDataPtr = data + tileIndex * NATRON_TILE_STORAGE_BYTES;
+    if (tileDataPtr < data || tileDataPtr >= (data + NATRON_NUM_TILES_PER_FILE * NATRON_TILE_STORAGE_BYTES)) {
         assert(false);
         return false;
     }
@@ -3936,6 +4193,34 @@ CacheBase::getBucketCacheBucketIndex(U64 hash)
     return getBucketStorageIndex<7>(hash);
 }
 
+// Bytes registered by registerExternalMemory(). This is process-local: each process accounts
+// its own plug-in allocations against its own view of the cache budget.
+static QMutex externalMemorySizeMutex;
+static std::size_t externalMemorySize = 0;
+
+void
+CacheBase::registerExternalMemory(std::size_t nBytes)
+{
+    QMutexLocker k(&externalMemorySizeMutex);
+    externalMemorySize += nBytes;
+}
+
+void
+CacheBase::unregisterExternalMemory(std::size_t nBytes)
+{
+    QMutexLocker k(&externalMemorySizeMutex);
+    assert(externalMemorySize >= nBytes);
+    externalMemorySize -= nBytes;
+}
+
+std::size_t
+CacheBase::getExternalMemorySize()
+{
+    QMutexLocker k(&externalMemorySizeMutex);
+
+    return externalMemorySize;
+}
+
 bool
 CacheBase::fileExists(const std::string& filename)
 {
@@ -4284,6 +4569,8 @@ CachePrivate<persistent>::clearCacheBucket(int bucket_i)
         openStorage(bucket.tocFile, tocFilePath, (int)MemoryFile::eFileOpenModeOpenTruncateOrCreate);
         bucket.remapToCMemoryFile(*tocWriteLock, 0);
 
+        bucket.resetWaitFreeIndex();
+
     }
 
 } // clearCacheBucket
@@ -4389,6 +4676,18 @@ Cache<persistent>::evictLRUEntries(std::size_t nBytesToFree)
         return;
     }
 
+    // Memory registered against the cache budget by external holders (plug-in scratch
+    // buffers, see registerExternalMemory()) shrinks the budget available to cached
+    // entries, so that allocation pressure from plug-ins evicts entries first.
+    {
+        std::size_t externalSize = getExternalMemorySize();
+        if (externalSize >= maxSize) {
+            maxSize = 0;
+        } else {
+            maxSize = maxSize - externalSize;
+        }
+    }
+
     if (nBytesToFree >= maxSize) {
         maxSize = 0;
     } else {
@@ -4431,6 +4730,27 @@ Cache<persistent>::evictLRUEntries(std::size_t nBytesToFree)
 
                     boost::scoped_ptr<ExclusiveLock> lruWriteLock;
                     createLock<ExclusiveLock>(_imp.get(), lruWriteLock, &_imp->ipc->bucketsData[bucket_i].lruListMutex);
+
+                    // Apply the pending second-chance bits now that we hold the list mutex:
+                    // cache hits only raise lruNode.visited (see readFromSharedMemoryEntryImpl),
+                    // so nodes that were hit since the last sweep get re-linked to the back of
+                    // the list here instead of on the get() fast path.
+                    // The loop terminates because moving a node clears its flag, but bound it
+                    // anyway in case concurrent hits keep re-raising flags behind us.
+                    int maxSecondChances = NATRON_CACHE_CLOCK_MAX_SECOND_CHANCES;
+                    while (bucket.ipc->lruListFront &&
+                           bucket.ipc->lruListFront->visited &&
+                           getRawPointer(bucket.ipc->lruListFront) != getRawPointer(bucket.ipc->lruListBack) &&
+                           maxSecondChances > 0) {
+                        LRUListNodePtr entryNode = bucket.ipc->lruListFront;
+                        entryNode->visited = false;
+                        bucket.ipc->lruListFront = entryNode->next;
+                        disconnectLinkedListNode(entryNode);
+                        appendLinkedListNode(entryNode, bucket.ipc->lruListBack);
+                        bucket.ipc->lruListBack = entryNode;
+                        --maxSecondChances;
+                    }
+
                     // The least recently used entry is the one at the front of the linked list
                     if (bucket.ipc->lruListFront) {
                         hash = bucket.ipc->lruListFront->hash;
@@ -4505,9 +4825,11 @@ Cache<persistent>::evictLRUEntries(std::size_t nBytesToFree)
             // We evicted one, decrease the size
             std::size_t entrySize = cacheEntryIt->second->size;
             curSize -= entrySize;
-            curSize -= cacheEntryIt->second->tileIndices.size() * NATRON_TILE_SIZE_BYTES;
+            curSize -= cacheEntryIt->second->tileIndices.size() * NATRON_TILE_STORAGE_BYTES;
 
             bucket.deallocateCacheEntryImpl(cacheEntryIt, storage);
+
+            _imp->nEvictionsCounter.fetchAndAddRelaxed(1);
         } catch (...) {
             // Any exception caught here means the cache is corrupted
             _imp->recoverFromInconsistentState(
@@ -4559,7 +4881,7 @@ Cache<persistent>::getMemoryStats(std::map<std::string, CacheReportInfo>* infos)
                     CacheReportInfo& entryData = (*infos)[pluginID];
                     ++entryData.nEntries;
                     entryData.nBytes += cacheEntryIt->second->size;
-                    entryData.nBytes += cacheEntryIt->second->tileIndices.size() * NATRON_TILE_SIZE_BYTES;
+                    entryData.nBytes += cacheEntryIt->second->tileIndices.size() * NATRON_TILE_STORAGE_BYTES;
                 }
                 it = it->next;
             }
@@ -4578,6 +4900,65 @@ Cache<persistent>::getMemoryStats(std::map<std::string, CacheReportInfo>* infos)
     } // for each bucket
 } // getMemoryStats
 
+template <bool persistent>
+void
+Cache<persistent>::getActivityStats(CacheActivityStats* stats) const
+{
+    // The counters wrap at 2^32: the caller derives rates from deltas so this is harmless
+    stats->nHits = (unsigned int)(int)_imp->nHitsCounter;
+    stats->nMisses = (unsigned int)(int)_imp->nMissesCounter;
+    stats->nPendingWaits = (unsigned int)(int)_imp->nPendingWaitsCounter;
+    stats->nEvictions = (unsigned int)(int)_imp->nEvictionsCounter;
+}
+
+template <bool persistent>
+void
+Cache<persistent>::flushTilesWriteBehind(const std::vector<U64>& tileIndices)
+{
+    if (!persistent || tileIndices.empty()) {
+        return;
+    }
+
+    // Take the tilesStorageMutex in read mode to indicate that we are operating on it (flush)
+    boost::scoped_ptr<Sharable_ReadLock> tileAlignedFileLock;
+    createLock<Sharable_ReadLock>(_imp.get(), tileAlignedFileLock, &_imp->ipc->tilesStorageMutex);
+
+    // Gather the tile ranges per storage file and coalesce contiguous tiles into a single range,
+    // the same way the read-ahead of retrieveAndLockTiles does, so that each range results in a
+    // single sequential write when the kernel performs the writeback.
+    typedef std::map<typename CachePrivate<persistent>::StoragePtrType, std::vector<char*> > PerStorageTilePtrsMap;
+    PerStorageTilePtrsMap dirtyTiles;
+
+    for (std::size_t i = 0; i < tileIndices.size(); ++i) {
+        U32 fileIndex, tileIndex;
+        getTileIndex(tileIndices[i], &tileIndex, &fileIndex);
+
+        // The cache may have been cleared since the tiles were inserted
+        if (fileIndex >= _imp->tilesStorage.size()) {
+            continue;
+        }
+        typename CachePrivate<persistent>::StoragePtrType storage = _imp->tilesStorage[fileIndex];
+        if (!storage) {
+            continue;
+        }
+        dirtyTiles[storage].push_back(storage->getData() + tileIndex * NATRON_TILE_STORAGE_BYTES);
+    }
+
+    for (typename PerStorageTilePtrsMap::iterator it = dirtyTiles.begin(); it != dirtyTiles.end(); ++it) {
+        std::vector<char*>& ptrs = it->second;
+        std::sort(ptrs.begin(), ptrs.end());
+        std::size_t rangeStart_i = 0;
+        for (std::size_t i = 1; i <= ptrs.size(); ++i) {
+            if (i < ptrs.size() && ptrs[i] == ptrs[i - 1] + NATRON_TILE_STORAGE_BYTES) {
+                continue;
+            }
+            std::size_t rangeNBytes = (i - rangeStart_i) * NATRON_TILE_STORAGE_BYTES;
+            scheduleWriteBehindFlush(it->first, ptrs[rangeStart_i], rangeNBytes);
+            rangeStart_i = i;
+        }
+    }
+} // flushTilesWriteBehind
+
 template <bool persistent>
 void
 Cache<persistent>::flushCacheOnDisk(bool async)
@@ -4620,8 +5001,8 @@ Cache<persistent>::flushCacheOnDisk(bool async)
                         continue;
                     }
                     CachePrivate::TileAlignedData* storage = &_imp->tilesStorage[fileIndex];
-                    std::size_t dataOffset = tileIndex * NATRON_TILE_SIZE_BYTES;
-                    storage->tileAlignedFile->flush(MemoryFile::eFlushTypeInvalidate, storage->tileAlignedFile->data() + dataOffset, NATRON_TILE_SIZE_BYTES);
+                    std::size_t dataOffset = tileIndex * NATRON_TILE_STORAGE_BYTES;
+                    storage->tileAlignedFile->flush(MemoryFile::eFlushTypeInvalidate, storage->tileAlignedFile->data() + dataOffset, NATRON_TILE_STORAGE_BYTES);
 
                 }
             }
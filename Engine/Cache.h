@@ -66,6 +66,27 @@
 
 #define NATRON_TILE_SIZE_BYTES (NATRON_TILE_SIZE_X_8_BIT * NATRON_TILE_SIZE_Y_8_BIT)
 
+// When defined, the pixel payload of each tile of the tile storage is transparently
+// compressed with LZ4 when written to the cache and decompressed when read back.
+// Compressed tiles only touch the pages actually needed by the compressed payload,
+// which multiplies the effective capacity of the persistent cache on disk and cuts
+// the disk bandwidth accordingly. Incompressible tiles are stored raw.
+// This is a format change of the tile storage files: caches written with and without
+// this option are incompatible.
+//#define NATRON_CACHE_TILES_COMPRESSION
+
+#ifdef NATRON_CACHE_TILES_COMPRESSION
+// Compressed tile slots are prefixed with a small header holding the compressed payload size.
+#define NATRON_TILE_STORAGE_HEADER_BYTES 8
+#else
+#define NATRON_TILE_STORAGE_HEADER_BYTES 0
+#endif
+
+// The number of bytes taken by a tile slot in the tile storage files: this is the unit
+// of all offset computations in the tile storage. The pixel payload of a tile is always
+// NATRON_TILE_SIZE_BYTES once decompressed.
+#define NATRON_TILE_STORAGE_BYTES (NATRON_TILE_SIZE_BYTES + NATRON_TILE_STORAGE_HEADER_BYTES)
+
 
 // The name of the directory containing all buckets on disk
 #define NATRON_CACHE_DIRECTORY_NAME "Cache"
@@ -120,6 +141,35 @@ struct CacheReportInfo
     }
 };
 
+/**
+ * @brief Live counters of the cache activity, cumulative since the process start.
+ * The caller is expected to poll them periodically and derive per-second rates from
+ * the deltas between two polls.
+ **/
+struct CacheActivityStats
+{
+    // Number of look-ups that found the entry in the cache
+    unsigned long long nHits;
+
+    // Number of look-ups that returned eCacheEntryStatusMustCompute
+    unsigned long long nMisses;
+
+    // Number of look-ups that had to wait on an entry being computed by another thread/process
+    unsigned long long nPendingWaits;
+
+    // Number of entries that were evicted to keep the cache within its maximum size
+    unsigned long long nEvictions;
+
+    CacheActivityStats()
+    : nHits(0)
+    , nMisses(0)
+    , nPendingWaits(0)
+    , nEvictions(0)
+    {
+
+    }
+};
+
 template <bool persistent>
 struct CacheBucket;
 
@@ -298,6 +348,21 @@ public:
      **/
     static int getBucketCacheBucketIndex(U64 hash);
 
+    /**
+     * @brief Account memory allocated outside of the cache but competing with it for RAM
+     * (e.g: plug-in scratch buffers allocated through the memory suite, see PluginMemory)
+     * against the cache budget: evictLRUEntries() deduces the registered bytes from the
+     * maximum cache size, so external allocation pressure evicts cache entries first
+     * instead of growing the process footprint unbounded.
+     **/
+    static void registerExternalMemory(std::size_t nBytes);
+    static void unregisterExternalMemory(std::size_t nBytes);
+
+    /**
+     * @brief The total bytes currently registered by registerExternalMemory().
+     **/
+    static std::size_t getExternalMemorySize();
+
 
     /**
      * @brief Returns the tile size (of one dimension) in pixels for the given bitdepth/
@@ -432,11 +497,25 @@ public:
      **/
     virtual void flushCacheOnDisk(bool async) = 0;
 
+    /**
+     * @brief Schedule a write-behind flush of the given cache tiles: their dirty pages are handed
+     * to the flusher of the StorageDeleterThread which writes them on disk in rate limited batches,
+     * without blocking the calling (render) thread. For a non-persistent cache this is a no-op.
+     * @param tileIndices Tile indices as returned in allocatedTilesData by retrieveAndLockTiles().
+     * This must be called after the corresponding unLockTiles() call.
+     **/
+    virtual void flushTilesWriteBehind(const std::vector<U64>& tileIndices) = 0;
+
     /**
      * @brief Returns cache stats for each plug-in
      **/
     virtual void getMemoryStats(std::map<std::string, CacheReportInfo>* infos) const = 0;
 
+    /**
+     * @brief Returns the live activity counters (hits, misses, pending-waits, evictions).
+     **/
+    virtual void getActivityStats(CacheActivityStats* stats) const = 0;
+
 #ifdef NATRON_CACHE_INTERPROCESS_ROBUST
     /**
      * @brief Scans the set of currently registered processes to check if they are still alive.
@@ -546,7 +625,9 @@ public:
     virtual void clear() OVERRIDE FINAL;
     virtual void removeEntry(const CacheEntryBasePtr& entry) OVERRIDE FINAL;
     virtual void flushCacheOnDisk(bool async) OVERRIDE FINAL;
+    virtual void flushTilesWriteBehind(const std::vector<U64>& tileIndices) OVERRIDE FINAL;
     virtual void getMemoryStats(std::map<std::string, CacheReportInfo>* infos) const OVERRIDE FINAL;
+    virtual void getActivityStats(CacheActivityStats* stats) const OVERRIDE FINAL;
 #ifdef NATRON_CACHE_INTERPROCESS_ROBUST
     virtual void cleanupMappedProcessList() OVERRIDE FINAL;
     virtual boost::uuids::uuid getCurrentProcessUUID() const OVERRIDE FINAL WARN_UNUSED_RETURN;
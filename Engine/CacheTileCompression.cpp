@@ -0,0 +1,331 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2013-2017 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "CacheTileCompression.h"
+
+#include <cstring> // memcpy, memset
+#include <cassert>
+#include <algorithm> // min
+
+#include "Engine/Cache.h"
+
+NATRON_NAMESPACE_ENTER;
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+// LZ4 block format constants, see
+// https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md
+static const std::size_t lz4MinMatch = 4;
+
+// The last match must start at least 12 bytes before the end of the block
+static const std::size_t lz4MFLimit = 12;
+
+// The last 5 bytes of a block are always literals
+static const std::size_t lz4LastLiterals = 5;
+
+static const std::size_t lz4MaxDistance = 65535;
+
+static const int lz4HashLog = 12;
+
+inline U32
+read32(const unsigned char* p)
+{
+    U32 v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline U32
+hashPosition(const unsigned char* p)
+{
+    // Fibonacci hashing of the 4 bytes at p
+    return (read32(p) * 2654435761U) >> (32 - lz4HashLog);
+}
+
+// Appends a length using the 255-run encoding of LZ4, returns false on overflow of dst
+inline bool
+writeLengthBytes(std::size_t length, unsigned char*& dst, const unsigned char* dstEnd)
+{
+    while (length >= 255) {
+        if (dst >= dstEnd) {
+            return false;
+        }
+        *dst++ = 255;
+        length -= 255;
+    }
+    if (dst >= dstEnd) {
+        return false;
+    }
+    *dst++ = (unsigned char)length;
+    return true;
+}
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+std::size_t
+CacheTileCompression::compress(const void* srcBuf, std::size_t srcSize, void* dstBuf, std::size_t dstCapacity)
+{
+    const unsigned char* src = (const unsigned char*)srcBuf;
+    unsigned char* dst = (unsigned char*)dstBuf;
+    unsigned char* const dstEnd = dst + dstCapacity;
+
+    // Positions + 1 of previously seen 4-bytes sequences, 0 means empty
+    U32 hashTable[1 << lz4HashLog];
+    std::memset(hashTable, 0, sizeof(hashTable));
+
+    std::size_t anchor = 0;
+    std::size_t ip = 0;
+
+    if (srcSize > lz4MFLimit) {
+
+        const std::size_t matchLimit = srcSize - lz4LastLiterals;
+        const std::size_t mfLimit = srcSize - lz4MFLimit;
+
+        while (ip <= mfLimit) {
+
+            const U32 h = hashPosition(src + ip);
+            const U32 candidatePlusOne = hashTable[h];
+            hashTable[h] = (U32)(ip + 1);
+
+            if ( !candidatePlusOne || ( ip - (candidatePlusOne - 1) > lz4MaxDistance ) ||
+                 ( read32(src + candidatePlusOne - 1) != read32(src + ip) ) ) {
+                ++ip;
+                continue;
+            }
+
+            std::size_t ref = candidatePlusOne - 1;
+
+            // Extend the match forward
+            std::size_t matchLen = lz4MinMatch;
+            while (ip + matchLen < matchLimit && src[ref + matchLen] == src[ip + matchLen]) {
+                ++matchLen;
+            }
+
+            // Extend the match backward over pending literals
+            while (ip > anchor && ref > 0 && src[ip - 1] == src[ref - 1]) {
+                --ip;
+                --ref;
+                ++matchLen;
+            }
+
+            // Emit the sequence
+            const std::size_t litLen = ip - anchor;
+            const std::size_t matchLenCode = matchLen - lz4MinMatch;
+
+            if (dst >= dstEnd) {
+                return 0;
+            }
+            unsigned char* token = dst++;
+            *token = (unsigned char)( (std::min<std::size_t>(litLen, 15) << 4) | std::min<std::size_t>(matchLenCode, 15) );
+
+            if (litLen >= 15) {
+                if ( !writeLengthBytes(litLen - 15, dst, dstEnd) ) {
+                    return 0;
+                }
+            }
+            if (dst + litLen > dstEnd) {
+                return 0;
+            }
+            std::memcpy(dst, src + anchor, litLen);
+            dst += litLen;
+
+            const std::size_t offset = ip - ref;
+            assert(offset >= 1 && offset <= lz4MaxDistance);
+            if (dst + 2 > dstEnd) {
+                return 0;
+            }
+            *dst++ = (unsigned char)(offset & 0xff);
+            *dst++ = (unsigned char)(offset >> 8);
+
+            if (matchLenCode >= 15) {
+                if ( !writeLengthBytes(matchLenCode - 15, dst, dstEnd) ) {
+                    return 0;
+                }
+            }
+
+            ip += matchLen;
+            anchor = ip;
+        }
+    }
+
+    // Emit the trailing literals
+    {
+        const std::size_t litLen = srcSize - anchor;
+        if (dst >= dstEnd) {
+            return 0;
+        }
+        unsigned char* token = dst++;
+        *token = (unsigned char)(std::min<std::size_t>(litLen, 15) << 4);
+        if (litLen >= 15) {
+            if ( !writeLengthBytes(litLen - 15, dst, dstEnd) ) {
+                return 0;
+            }
+        }
+        if (dst + litLen > dstEnd) {
+            return 0;
+        }
+        std::memcpy(dst, src + anchor, litLen);
+        dst += litLen;
+    }
+
+    return (std::size_t)(dst - (unsigned char*)dstBuf);
+} // compress
+
+std::size_t
+CacheTileCompression::decompress(const void* srcBuf, std::size_t srcSize, void* dstBuf, std::size_t dstCapacity)
+{
+    const unsigned char* src = (const unsigned char*)srcBuf;
+    const unsigned char* const srcEnd = src + srcSize;
+    unsigned char* dst = (unsigned char*)dstBuf;
+    unsigned char* const dstStart = dst;
+    unsigned char* const dstEnd = dst + dstCapacity;
+
+    while (src < srcEnd) {
+
+        const unsigned char token = *src++;
+
+        // Literals
+        std::size_t litLen = token >> 4;
+        if (litLen == 15) {
+            unsigned char c;
+            do {
+                if (src >= srcEnd) {
+                    return 0;
+                }
+                c = *src++;
+                litLen += c;
+            } while (c == 255);
+        }
+        if (src + litLen > srcEnd || dst + litLen > dstEnd) {
+            return 0;
+        }
+        std::memcpy(dst, src, litLen);
+        src += litLen;
+        dst += litLen;
+
+        if (src == srcEnd) {
+            // Last sequence of the block: literals only
+            break;
+        }
+
+        // Match
+        if (src + 2 > srcEnd) {
+            return 0;
+        }
+        const std::size_t offset = (std::size_t)src[0] | ( (std::size_t)src[1] << 8 );
+        src += 2;
+        if ( offset == 0 || offset > (std::size_t)(dst - dstStart) ) {
+            return 0;
+        }
+
+        std::size_t matchLen = (token & 0xf);
+        if (matchLen == 15) {
+            unsigned char c;
+            do {
+                if (src >= srcEnd) {
+                    return 0;
+                }
+                c = *src++;
+                matchLen += c;
+            } while (c == 255);
+        }
+        matchLen += lz4MinMatch;
+
+        if (dst + matchLen > dstEnd) {
+            return 0;
+        }
+        // Byte-per-byte copy: matches may overlap with the output when offset < matchLen
+        const unsigned char* match = dst - offset;
+        for (std::size_t i = 0; i < matchLen; ++i) {
+            dst[i] = match[i];
+        }
+        dst += matchLen;
+    }
+
+    return (std::size_t)(dst - dstStart);
+} // decompress
+
+#ifdef NATRON_CACHE_TILES_COMPRESSION
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+// Guards against reading slots written by a build without compression support
+static const U32 tileSlotMagic = 0x4E54434C; // "NTCL"
+
+struct TileSlotHeader
+{
+    U32 magic;
+
+    // Size in bytes of the LZ4 payload following the header, 0 if the payload is stored raw
+    U32 compressedSize;
+};
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+void
+CacheTileCompression::compressTileToSlot(const void* tilePixels, void* slot)
+{
+    TileSlotHeader header;
+    header.magic = tileSlotMagic;
+
+    unsigned char* payload = (unsigned char*)slot + sizeof(TileSlotHeader);
+
+    const std::size_t compressedSize = compress(tilePixels, NATRON_TILE_SIZE_BYTES, payload, NATRON_TILE_SIZE_BYTES);
+    if (compressedSize == 0) {
+        // Incompressible: store raw
+        header.compressedSize = 0;
+        std::memcpy(payload, tilePixels, NATRON_TILE_SIZE_BYTES);
+    } else {
+        header.compressedSize = (U32)compressedSize;
+    }
+    std::memcpy(slot, &header, sizeof(TileSlotHeader));
+}
+
+bool
+CacheTileCompression::decompressTileFromSlot(const void* slot, void* tilePixels)
+{
+    TileSlotHeader header;
+    std::memcpy(&header, slot, sizeof(TileSlotHeader));
+
+    const unsigned char* payload = (const unsigned char*)slot + sizeof(TileSlotHeader);
+
+    if (header.magic != tileSlotMagic || header.compressedSize > NATRON_TILE_SIZE_BYTES) {
+        std::memset(tilePixels, 0, NATRON_TILE_SIZE_BYTES);
+        return false;
+    }
+    if (header.compressedSize == 0) {
+        std::memcpy(tilePixels, payload, NATRON_TILE_SIZE_BYTES);
+        return true;
+    }
+    const std::size_t decompressedSize = decompress(payload, header.compressedSize, tilePixels, NATRON_TILE_SIZE_BYTES);
+    if (decompressedSize != NATRON_TILE_SIZE_BYTES) {
+        std::memset(tilePixels, 0, NATRON_TILE_SIZE_BYTES);
+        return false;
+    }
+    return true;
+}
+
+#endif // NATRON_CACHE_TILES_COMPRESSION
+
+NATRON_NAMESPACE_EXIT;
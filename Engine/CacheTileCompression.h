@@ -0,0 +1,87 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2013-2017 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef Engine_CacheTileCompression_h
+#define Engine_CacheTileCompression_h
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <cstddef>
+
+#include "Global/GlobalDefines.h"
+
+#include "Engine/EngineFwd.h"
+
+NATRON_NAMESPACE_ENTER;
+
+/**
+ * @brief Transparent per-tile compression of the cache tile storage.
+ *
+ * When NATRON_CACHE_TILES_COMPRESSION is defined in Cache.h, each tile slot of the
+ * tile storage files is NATRON_TILE_STORAGE_BYTES long: a small header followed by
+ * the LZ4 block-compressed pixel payload (or the raw payload when it did not
+ * compress). Compressed tiles only dirty the pages actually covered by the
+ * compressed payload, which multiplies the effective on-disk capacity of the
+ * persistent cache and cuts the disk bandwidth accordingly.
+ *
+ * The codec is a self-contained implementation of the LZ4 block format
+ * (https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md).
+ **/
+class CacheTileCompression
+{
+public:
+
+    /**
+     * @brief Compresses the given buffer into dst using the LZ4 block format.
+     * @returns The number of bytes written to dst, or 0 if the compressed data
+     * would not fit in dstCapacity bytes.
+     **/
+    static std::size_t compress(const void* src, std::size_t srcSize, void* dst, std::size_t dstCapacity);
+
+    /**
+     * @brief Decompresses an LZ4 block of srcSize bytes into dst.
+     * @returns The number of bytes written to dst, or 0 if the block is corrupted
+     * or decompresses to more than dstCapacity bytes.
+     **/
+    static std::size_t decompress(const void* src, std::size_t srcSize, void* dst, std::size_t dstCapacity);
+
+    /**
+     * @brief Compresses the NATRON_TILE_SIZE_BYTES pixel payload of a tile into the
+     * given NATRON_TILE_STORAGE_BYTES storage slot. If the payload does not compress,
+     * it is stored raw; the header keeps track of which case was taken.
+     **/
+    static void compressTileToSlot(const void* tilePixels, void* slot);
+
+    /**
+     * @brief Decompresses the given storage slot into tilePixels, which must be at
+     * least NATRON_TILE_SIZE_BYTES long.
+     * @returns False if the slot content is corrupted, in which case tilePixels is
+     * filled with zeroes.
+     **/
+    static bool decompressTileFromSlot(const void* slot, void* tilePixels);
+};
+
+NATRON_NAMESPACE_EXIT;
+
+#endif // Engine_CacheTileCompression_h
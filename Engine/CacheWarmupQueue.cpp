@@ -0,0 +1,330 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "CacheWarmupQueue.h"
+
+#include <list>
+#include <map>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <QMutex>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+#include "Engine/AppManager.h"
+#include "Engine/Cache.h"
+#include "Engine/EffectInstance.h"
+#include "Engine/EffectInstanceActionResults.h"
+#include "Engine/Hash64.h"
+#include "Engine/ImageCacheKey.h"
+#include "Engine/ImagePlaneDesc.h"
+#include "Engine/Node.h"
+#include "Engine/TreeRender.h"
+
+NATRON_NAMESPACE_ENTER;
+
+struct CacheWarmupQueuePrivate
+{
+    AppInstanceWPtr app;
+
+    mutable QMutex lock;
+
+    // Signaled when nActiveTasks drops to 0
+    QWaitCondition allTasksDoneCond;
+
+    // Number of submitted tasks that did not return yet
+    int nActiveTasks;
+
+    // Set by quit(): no task may be submitted nor dequeue frames anymore
+    bool mustQuit;
+
+    // The epoch of each group, incremented by cancelGroup() so that the tasks
+    // submitted before the cancellation stop dequeuing frames
+    std::map<std::string, U64> groupEpochs;
+
+    // The in-flight renders and the group they belong to, so they can be aborted
+    // upon cancellation
+    std::list<std::pair<std::string, TreeRenderPtr> > activeRenders;
+
+    CacheWarmupQueuePrivate(const AppInstancePtr& app)
+    : app(app)
+    , lock()
+    , allTasksDoneCond()
+    , nActiveTasks(0)
+    , mustQuit(false)
+    , groupEpochs()
+    , activeRenders()
+    {
+    }
+
+    // The caller must hold lock
+    U64 getGroupEpoch(const std::string& group) const
+    {
+        std::map<std::string, U64>::const_iterator found = groupEpochs.find(group);
+
+        return found == groupEpochs.end() ? 0 : found->second;
+    }
+};
+
+/**
+ * @brief Renders the frames of one submission sequentially and drops the images in the cache.
+ **/
+class CacheWarmupQueueRunnable
+    : public QRunnable
+{
+    CacheWarmupQueuePrivate* _imp;
+    NodePtr _treeRoot;
+    std::vector<TimeValue> _frames;
+    unsigned int _mipMapLevel;
+    std::string _group;
+    U64 _epoch;
+
+public:
+
+    CacheWarmupQueueRunnable(CacheWarmupQueuePrivate* imp,
+                             const NodePtr& treeRoot,
+                             const std::vector<TimeValue>& frames,
+                             unsigned int mipMapLevel,
+                             const std::string& group,
+                             U64 epoch)
+    : QRunnable()
+    , _imp(imp)
+    , _treeRoot(treeRoot)
+    , _frames(frames)
+    , _mipMapLevel(mipMapLevel)
+    , _group(group)
+    , _epoch(epoch)
+    {
+    }
+
+    virtual ~CacheWarmupQueueRunnable()
+    {
+    }
+
+    virtual void run() OVERRIDE FINAL
+    {
+        for (std::size_t i = 0; i < _frames.size(); ++i) {
+
+            // Stop dequeuing frames if the group was cancelled or the application is quitting
+            {
+                QMutexLocker k(&_imp->lock);
+                if ( _imp->mustQuit || (_imp->getGroupEpoch(_group) != _epoch) ) {
+                    break;
+                }
+            }
+
+            TreeRender::CtorArgsPtr args(new TreeRender::CtorArgs);
+            args->treeRootEffect = _treeRoot->getEffectInstance();
+            args->time = _frames[i];
+            args->view = ViewIdx(0);
+            args->mipMapLevel = _mipMapLevel;
+            args->proxyScale = RenderScale(1.);
+            args->draftMode = false;
+            args->playback = false;
+            args->byPassCache = false;
+
+            TreeRenderPtr render;
+            try {
+                render = TreeRender::create(args);
+            } catch (const std::exception& /*e*/) {
+                break;
+            }
+            if (!render) {
+                break;
+            }
+
+            // Register the render so it can be aborted by cancelGroup()
+            {
+                QMutexLocker k(&_imp->lock);
+                if ( _imp->mustQuit || (_imp->getGroupEpoch(_group) != _epoch) ) {
+                    break;
+                }
+                _imp->activeRenders.push_back( std::make_pair(_group, render) );
+            }
+
+            FrameViewRequestPtr outputRequest;
+            render->launchRender(&outputRequest);
+
+            // The resulting image is dropped on purpose: it now sits in the cache.
+            {
+                QMutexLocker k(&_imp->lock);
+                for (std::list<std::pair<std::string, TreeRenderPtr> >::iterator it = _imp->activeRenders.begin(); it != _imp->activeRenders.end(); ++it) {
+                    if (it->second == render) {
+                        _imp->activeRenders.erase(it);
+                        break;
+                    }
+                }
+            }
+        }
+
+        {
+            QMutexLocker k(&_imp->lock);
+            --_imp->nActiveTasks;
+            if (_imp->nActiveTasks == 0) {
+                _imp->allTasksDoneCond.wakeAll();
+            }
+        }
+    } // run
+};
+
+CacheWarmupQueue::CacheWarmupQueue(const AppInstancePtr& app)
+: _imp( new CacheWarmupQueuePrivate(app) )
+{
+}
+
+CacheWarmupQueue::~CacheWarmupQueue()
+{
+    quit();
+}
+
+void
+CacheWarmupQueue::submitWork(const NodePtr& treeRoot,
+                             TimeValue firstFrame,
+                             TimeValue lastFrame,
+                             TimeValue frameStep,
+                             unsigned int mipMapLevel,
+                             int priority,
+                             const std::string& group)
+{
+    if ( !treeRoot || !treeRoot->getEffectInstance() ) {
+        return;
+    }
+
+    double step = (double)frameStep;
+    if (step <= 0) {
+        step = 1.;
+    }
+
+    std::vector<TimeValue> frames;
+    for (double t = firstFrame; t <= (double)lastFrame; t += step) {
+        frames.push_back( TimeValue(t) );
+    }
+    if ( frames.empty() ) {
+        return;
+    }
+
+    U64 epoch;
+    {
+        QMutexLocker k(&_imp->lock);
+        if (_imp->mustQuit) {
+            return;
+        }
+        // Ensure the group has an epoch entry so that cancelGroup("") can bump it
+        epoch = _imp->groupEpochs[group];
+        ++_imp->nActiveTasks;
+    }
+
+    CacheWarmupQueueRunnable* task = new CacheWarmupQueueRunnable(_imp.get(), treeRoot, frames, mipMapLevel, group, epoch);
+    // The task is auto-deleted by the thread-pool once run
+    QThreadPool::globalInstance()->start(task, priority);
+}
+
+void
+CacheWarmupQueue::cancelGroup(const std::string& group)
+{
+    std::list<TreeRenderPtr> toAbort;
+    {
+        QMutexLocker k(&_imp->lock);
+        for (std::map<std::string, U64>::iterator it = _imp->groupEpochs.begin(); it != _imp->groupEpochs.end(); ++it) {
+            if ( group.empty() || (it->first == group) ) {
+                ++it->second;
+            }
+        }
+        for (std::list<std::pair<std::string, TreeRenderPtr> >::const_iterator it = _imp->activeRenders.begin(); it != _imp->activeRenders.end(); ++it) {
+            if ( group.empty() || (it->first == group) ) {
+                toAbort.push_back(it->second);
+            }
+        }
+    }
+    for (std::list<TreeRenderPtr>::const_iterator it = toAbort.begin(); it != toAbort.end(); ++it) {
+        (*it)->setRenderAborted();
+    }
+}
+
+void
+CacheWarmupQueue::quit()
+{
+    {
+        QMutexLocker k(&_imp->lock);
+        _imp->mustQuit = true;
+    }
+    cancelGroup( std::string() );
+    {
+        QMutexLocker k(&_imp->lock);
+        while (_imp->nActiveTasks > 0) {
+            _imp->allTasksDoneCond.wait(&_imp->lock);
+        }
+    }
+}
+
+bool
+CacheWarmupQueue::isFrameCached(const NodePtr& treeRoot,
+                                TimeValue time,
+                                ViewIdx view) const
+{
+    EffectInstancePtr effect = treeRoot ? treeRoot->getEffectInstance() : EffectInstancePtr();
+
+    if (!effect) {
+        return false;
+    }
+
+    // The plane that an interactive render of the tree root would produce: the first
+    // produced plane, falling back to the color plane, see TreeRenderPrivate::getTreeRootPlane
+    ImagePlaneDesc plane = ImagePlaneDesc::getRGBAComponents();
+    {
+        GetComponentsResultsPtr results;
+        ActionRetCodeEnum stat = effect->getLayersProducedAndNeeded_public(time, view, &results);
+        if ( !isFailureRetCode(stat) && results && !results->getProducedPlanes().empty() ) {
+            plane = results->getProducedPlanes().front();
+        }
+    }
+
+    // Rebuild the key of the image tiles entry the same way the render would,
+    // see ImagePrivate::initAndFetchFromCache
+    U64 nodeTimeViewVariantHash;
+    {
+        HashableObject::ComputeHashArgs hashArgs;
+        hashArgs.hashType = HashableObject::eComputeHashTypeTimeViewVariant;
+        hashArgs.time = time;
+        hashArgs.view = view;
+        nodeTimeViewVariantHash = effect->computeHash(hashArgs);
+    }
+
+    U64 layerID;
+    {
+        Hash64 hash;
+        Hash64::appendQString(QString::fromUtf8( plane.getPlaneID().c_str() ), &hash);
+        hash.computeHash();
+        layerID = hash.value();
+    }
+
+    ImageCacheKey key( nodeTimeViewVariantHash, layerID, RenderScale(1.), treeRoot->getPluginID() );
+
+    return appPTR->getTileCache()->hasCacheEntryForHash( key.getHash() );
+}
+
+NATRON_NAMESPACE_EXIT;
@@ -0,0 +1,110 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef NATRON_ENGINE_CACHEWARMUPQUEUE_H
+#define NATRON_ENGINE_CACHEWARMUPQUEUE_H
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <string>
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/scoped_ptr.hpp>
+#endif
+
+#include "Engine/TimeValue.h"
+#include "Engine/ViewIdx.h"
+
+#include "Engine/EngineFwd.h"
+
+NATRON_NAMESPACE_ENTER;
+
+// The group of the warm-up renders submitted for frames skipped by realtime playback,
+// see ViewerDisplayScheduler::onRenderStopped
+#define kCacheWarmupGroupPlaybackSkippedFrames "PlaybackSkippedFrames"
+
+/**
+ * @brief Background cache warm-up renders submitted from pipeline scripts.
+ *
+ * Each submission renders the frames of a node tree on the global thread-pool at a chosen
+ * priority and drops the produced images: the point is to fill the cache so that a later
+ * interactive render of the same frames is a cache hit (e.g: warming the next shot while
+ * the current one is reviewed in a dailies session).
+ * Submissions carry a group label so that a script can cancel a whole group at once when
+ * it becomes irrelevant.
+ **/
+struct CacheWarmupQueuePrivate;
+class CacheWarmupQueue
+{
+public:
+
+    CacheWarmupQueue(const AppInstancePtr& app);
+
+    ~CacheWarmupQueue();
+
+    /**
+     * @brief Submits a background render of the tree rooted at treeRoot for the given frame
+     * range at the given mipmap level. The produced images are dropped: they only sit in the
+     * cache afterwards. Frames of a submission are rendered sequentially in a single
+     * thread-pool task.
+     * @param priority The QThreadPool priority of the task: a negative priority runs below
+     * the interactive renders, which is what cache warming generally wants.
+     * @param group An arbitrary label identifying the submission for cancelGroup().
+     **/
+    void submitWork(const NodePtr& treeRoot,
+                    TimeValue firstFrame,
+                    TimeValue lastFrame,
+                    TimeValue frameStep,
+                    unsigned int mipMapLevel,
+                    int priority,
+                    const std::string& group);
+
+    /**
+     * @brief Cancels the submissions carrying the given group label and aborts their
+     * in-flight renders. An empty group cancels all submissions.
+     **/
+    void cancelGroup(const std::string& group);
+
+    /**
+     * @brief Cancels everything and waits for the in-flight tasks to return. Called when
+     * the application instance is about to quit.
+     **/
+    void quit();
+
+    /**
+     * @brief Returns whether the cache holds tiles of the first plane produced by the given
+     * node at the given time and view, i.e: whether an interactive render of that frame
+     * would at least partially be a cache hit.
+     **/
+    bool isFrameCached(const NodePtr& treeRoot, TimeValue time, ViewIdx view) const;
+
+private:
+
+    friend class CacheWarmupQueueRunnable;
+    boost::scoped_ptr<CacheWarmupQueuePrivate> _imp;
+};
+
+NATRON_NAMESPACE_EXIT;
+
+#endif // NATRON_ENGINE_CACHEWARMUPQUEUE_H
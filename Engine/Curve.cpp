@@ -233,6 +233,7 @@ Curve::setPeriodic(bool periodic)
     QMutexLocker k(&_imp->_lock);
     _imp->isPeriodic = periodic;
     _imp->keyFrames.clear();
+    onCurveChanged();
 }
 
 bool
@@ -253,6 +254,7 @@ Curve::clearKeyFrames()
     QMutexLocker l(&_imp->_lock);
 
     _imp->keyFrames.clear();
+    onCurveChanged();
 }
 
 bool
@@ -335,6 +337,8 @@ Curve::cloneAndCheckIfChanged(const Curve& other, double offset, const RangeD* r
             ++oit;
         }
     }
+    onCurveChanged();
+
     return hasChanged;
 }
 
@@ -922,24 +926,62 @@ Curve::getValueAt(TimeValue t,
         TimeValue tcur, tnext;
         double vcurDerivRight, vnextDerivLeft, vcur, vnext;
         KeyframeTypeEnum interp, interpNext;
-        KeyFrame k(t, 0.);
-        // find the first keyframe with time greater than t
-        KeyFrameSet::const_iterator itup;
-        itup = _imp->keyFrames.upper_bound(k);
-        interParams(_imp->keyFrames,
-                    _imp->isPeriodic,
-                    _imp->xMin,
-                    _imp->xMax,
-                    &t,
-                    itup,
-                    &tcur,
-                    &vcur,
-                    &vcurDerivRight,
-                    &interp,
-                    &tnext,
-                    &vnext,
-                    &vnextDerivLeft,
-                    &interpNext);
+        if ( _imp->hasLastInterval && (t >= _imp->lastIntervalStart) && (t < _imp->lastIntervalEnd) ) {
+            // Still in the interval evaluated last, reuse its parameters and skip the search
+            tcur = _imp->lastTcur;
+            tnext = _imp->lastTnext;
+            vcur = _imp->lastVcur;
+            vnext = _imp->lastVnext;
+            vcurDerivRight = _imp->lastVcurDerivRight;
+            vnextDerivLeft = _imp->lastVnextDerivLeft;
+            interp = _imp->lastInterp;
+            interpNext = _imp->lastInterpNext;
+        } else {
+            KeyFrame k(t, 0.);
+            // find the first keyframe with time greater than t
+            KeyFrameSet::const_iterator itup;
+            itup = _imp->keyFrames.upper_bound(k);
+            interParams(_imp->keyFrames,
+                        _imp->isPeriodic,
+                        _imp->xMin,
+                        _imp->xMax,
+                        &t,
+                        itup,
+                        &tcur,
+                        &vcur,
+                        &vcurDerivRight,
+                        &interp,
+                        &tnext,
+                        &vnext,
+                        &vnextDerivLeft,
+                        &interpNext);
+
+            // Remember the interval for the next evaluation. A periodic curve remaps the time
+            // into the keyframes range, do not bother caching it.
+            if (!_imp->isPeriodic) {
+                if ( itup == _imp->keyFrames.begin() ) {
+                    // Valid for any time before the first keyframe
+                    _imp->lastIntervalStart = -std::numeric_limits<double>::infinity();
+                    _imp->lastIntervalEnd = tnext;
+                } else if ( itup == _imp->keyFrames.end() ) {
+                    // Valid for any time at or past the last keyframe
+                    _imp->lastIntervalStart = tcur;
+                    _imp->lastIntervalEnd = std::numeric_limits<double>::infinity();
+                } else {
+                    _imp->lastIntervalStart = tcur;
+                    _imp->lastIntervalEnd = tnext;
+                }
+                _imp->lastTcur = tcur;
+                _imp->lastTnext = tnext;
+                _imp->lastVcur = vcur;
+                _imp->lastVnext = vnext;
+                _imp->lastVcurDerivRight = vcurDerivRight;
+                _imp->lastVnextDerivLeft = vnextDerivLeft;
+                _imp->lastInterp = interp;
+                _imp->lastInterpNext = interpNext;
+                _imp->hasLastInterval = true;
+            }
+        }
 
         v = Interpolation::interpolate(tcur, vcur,
                                        vcurDerivRight,
@@ -971,6 +1013,100 @@ Curve::getValueAt(TimeValue t,
     }
 } // getValueAt
 
+void
+Curve::getValueAtBatch(TimeValue tStart,
+                       TimeValue tEnd,
+                       int nSamples,
+                       bool doClamp,
+                       double* samples) const
+{
+    if (nSamples <= 0) {
+        return;
+    }
+
+    QMutexLocker l(&_imp->_lock);
+
+    if ( _imp->keyFrames.empty() ) {
+        // A curve with no control points is considered to be 0, see getValueAt()
+        for (int i = 0; i < nSamples; ++i) {
+            samples[i] = 0.;
+        }
+
+        return;
+    }
+
+    const double dt = nSamples > 1 ? (tEnd - tStart) / (double)(nSamples - 1) : 0.;
+    int i = 0;
+    while (i < nSamples) {
+        TimeValue t = TimeValue(tStart + i * dt);
+
+        // Resolve the keyframe segment enclosing t
+        TimeValue tcur, tnext;
+        double vcurDerivRight, vnextDerivLeft, vcur, vnext;
+        KeyframeTypeEnum interp, interpNext;
+        KeyFrameSet::const_iterator itup = _imp->keyFrames.upper_bound( KeyFrame(t, 0.) );
+        interParams(_imp->keyFrames,
+                    _imp->isPeriodic,
+                    _imp->xMin,
+                    _imp->xMax,
+                    &t,
+                    itup,
+                    &tcur,
+                    &vcur,
+                    &vcurDerivRight,
+                    &interp,
+                    &tnext,
+                    &vnext,
+                    &vnextDerivLeft,
+                    &interpNext);
+
+        // Extend the run to all the samples falling in the same segment. A periodic curve
+        // remaps the time inside interParams, evaluate only the current sample then.
+        int runEnd = i + 1;
+        if (!_imp->isPeriodic) {
+            // Before the first keyframe the virtual segment is valid for any time < tnext,
+            // past the last keyframe it is valid forever
+            const double segmentEnd = itup == _imp->keyFrames.end() ? std::numeric_limits<double>::infinity() : (double)tnext;
+            while ( runEnd < nSamples && (tStart + runEnd * dt) < segmentEnd ) {
+                ++runEnd;
+            }
+        }
+
+        Interpolation::interpolateBatch(tcur, vcur,
+                                        vcurDerivRight,
+                                        vnextDerivLeft,
+                                        tnext, vnext,
+                                        t,
+                                        t + (runEnd - 1 - i) * dt,
+                                        runEnd - i,
+                                        interp,
+                                        interpNext,
+                                        samples + i);
+
+        for (int j = i; j < runEnd; ++j) {
+            double v = samples[j];
+            if (doClamp) {
+                v = clampValueToCurveYRange(v);
+            }
+
+            switch (_imp->type) {
+            case Curve::eCurveTypeString:
+            case Curve::eCurveTypeInt:
+                v = std::floor(v + 0.5);
+                break;
+            case Curve::eCurveTypeBool:
+                v = v >= 0.5 ? 1. : 0.;
+                break;
+            default:
+                break;
+            }
+            samples[j] = v;
+        }
+
+        i = runEnd;
+    }
+} // getValueAtBatch
+
 double
 Curve::getDerivativeAt(TimeValue t) const
 {
@@ -1187,6 +1323,7 @@ Curve::setXRange(double a,
 
     _imp->xMin = a;
     _imp->xMax = b;
+    onCurveChanged();
 }
 
 std::pair<double, double> Curve::getXRange() const
@@ -1917,6 +2054,7 @@ Curve::onCurveChanged()
 #ifdef NATRON_CURVE_USE_CACHE
     _imp->resultCache.clear();
 #endif
+    _imp->hasLastInterval = false;
 }
 
 void
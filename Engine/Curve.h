@@ -289,6 +289,14 @@ public:
      */
     double getValueAt(TimeValue t, bool clamp = true) const WARN_UNUSED_RETURN;
 
+    /*
+     * Samples the curve at nSamples times regularly spaced from tStart (included) to tEnd
+     * (included when nSamples > 1) and writes the results to samples[0 .. nSamples - 1].
+     * The keyframe segment enclosing each run of samples is resolved once for the whole run
+     * instead of once per sample, see Interpolation::interpolateBatch().
+     */
+    void getValueAtBatch(TimeValue tStart, TimeValue tEnd, int nSamples, bool clamp, double* samples) const;
+
     double getDerivativeAt(TimeValue t) const WARN_UNUSED_RETURN;
 
     double getIntegrateFromTo(TimeValue t1, TimeValue t2) const WARN_UNUSED_RETURN;
@@ -62,6 +62,18 @@ struct CurvePrivate
     bool isPeriodic;
     bool canMoveY;
 
+    // Interpolation parameters of the interval that was evaluated last and the time range
+    // [lastIntervalStart, lastIntervalEnd) in which they remain valid. Knob evaluation during
+    // render calls getValueAt at monotonically advancing times, hitting the same interval many
+    // times in a row: this skips the search in the keyframes set. Guarded by _lock, only used
+    // for non periodic curves and invalidated by onCurveChanged().
+    mutable bool hasLastInterval;
+    mutable double lastIntervalStart, lastIntervalEnd;
+    mutable TimeValue lastTcur, lastTnext;
+    mutable double lastVcur, lastVnext;
+    mutable double lastVcurDerivRight, lastVnextDerivLeft;
+    mutable KeyframeTypeEnum lastInterp, lastInterpNext;
+
     CurvePrivate()
     : keyFrames()
 #ifdef NATRON_CURVE_USE_CACHE
@@ -77,6 +89,17 @@ struct CurvePrivate
     , _lock(QMutex::Recursive)
     , isPeriodic(false)
     , canMoveY(true)
+    , hasLastInterval(false)
+    , lastIntervalStart(0.)
+    , lastIntervalEnd(0.)
+    , lastTcur(0.)
+    , lastTnext(0.)
+    , lastVcur(0.)
+    , lastVnext(0.)
+    , lastVcurDerivRight(0.)
+    , lastVnextDerivLeft(0.)
+    , lastInterp(eKeyframeTypeNone)
+    , lastInterpNext(eKeyframeTypeNone)
     {
     }
 
@@ -98,6 +121,8 @@ struct CurvePrivate
         displayMax = other.displayMax;
         isPeriodic = other.isPeriodic;
         canMoveY = other.canMoveY;
+        // Do not copy the last evaluated interval, just invalidate it
+        hasLastInterval = false;
     }
 
     
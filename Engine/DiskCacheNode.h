@@ -95,6 +95,17 @@ public:
         return false;
     }
 
+    /**
+     * This node does nothing but pushing its input planes to the disk cache: by working in the
+     * mono channel layout, which is the storage format of the cache tiles themselves, the input
+     * planes are deinterleaved once upstream and both the render action and the cache insertion
+     * become straight per-channel row copies instead of an RGBA (de)interleave per frame.
+     **/
+    virtual ImageBufferLayoutEnum getPreferredBufferLayout() const OVERRIDE FINAL WARN_UNUSED_RETURN
+    {
+        return eImageBufferLayoutMonoChannelFullRect;
+    }
+
     virtual bool supportsMultiResolution() const OVERRIDE FINAL WARN_UNUSED_RETURN
     {
         return true;
@@ -78,21 +78,17 @@ Distortion2DStack::pushDistortionFunction(const DistortionFunction2DPtr& distort
 void
 Distortion2DStack::pushTransformMatrix(const Transform::Matrix3x3& transfo)
 {
-    if (_imp->stack.empty()) {
+    // If the last pushed distortion is a matrix and this distortion is also a matrix, concatenate:
+    // a whole chain of transform effects (Transform/CornerPin/Reformat...) thus collapses to a
+    // single matrix, i.e: a single resample with one filter application.
+    if ( !_imp->stack.empty() && _imp->stack.back()->transformMatrix ) {
+        const DistortionFunction2DPtr& lastDistort = _imp->stack.back();
+        *lastDistort->transformMatrix = Transform::matMul(*lastDistort->transformMatrix, transfo);
+    } else {
+        // Cannot concatenate, append
         DistortionFunction2DPtr disto(new DistortionFunction2D);
         disto->transformMatrix.reset(new Transform::Matrix3x3(transfo));
-    } else {
-        // If the last pushed distortion is a matrix and this distortion is also a matrix, concatenate
-        DistortionFunction2DPtr lastDistort = _imp->stack.back();
-        if (lastDistort->transformMatrix) {
-            *lastDistort->transformMatrix = Transform::matMul(*lastDistort->transformMatrix, transfo);
-        } else {
-            // Cannot concatenate, append
-            DistortionFunction2DPtr disto(new DistortionFunction2D);
-            disto->transformMatrix.reset(new Transform::Matrix3x3(transfo));
-            _imp->stack.push_back(disto);
-        }
-        
+        _imp->stack.push_back(disto);
     }
 }
 
@@ -101,7 +97,13 @@ Distortion2DStack::pushDistortionStack(const Distortion2DStack& stack)
 {
     const std::list<DistortionFunction2DPtr>& distos = stack.getStack();
     for (std::list<DistortionFunction2DPtr>::const_iterator it = distos.begin(); it != distos.end(); ++it) {
-        pushDistortionFunction(*it);
+        // Dispatch on the entry type: matrices go through pushTransformMatrix so that adjacent
+        // matrices across the boundary of the 2 stacks get concatenated together too.
+        if ( (*it)->transformMatrix ) {
+            pushTransformMatrix( *(*it)->transformMatrix );
+        } else {
+            pushDistortionFunction(*it);
+        }
     }
 }
 
@@ -175,11 +177,12 @@ Distortion2DStack::applyDistortionStack(double distortedX, double distortedY, co
                 jacobianSet = true;
                 memcpy(jacobian, J, sizeof(double) * 4);
             } else {
-                // Concatenate jacobians
-                jacobian[0] = J[0] * jacobian[0] + J[1] * jacobian[2];
-                jacobian[1] = J[0] * jacobian[1] + J[1] * jacobian[3];
-                jacobian[2] = J[2] * jacobian[0] + J[3] * jacobian[2];
-                jacobian[3] = J[2] * jacobian[1] + J[3] * jacobian[3];
+                // Concatenate jacobians: work on a copy since the product is computed in-place
+                double prev[4] = {jacobian[0], jacobian[1], jacobian[2], jacobian[3]};
+                jacobian[0] = J[0] * prev[0] + J[1] * prev[2];
+                jacobian[1] = J[0] * prev[1] + J[1] * prev[3];
+                jacobian[2] = J[2] * prev[0] + J[3] * prev[2];
+                jacobian[3] = J[2] * prev[1] + J[3] * prev[3];
             }
         }
     }
@@ -187,4 +190,45 @@ Distortion2DStack::applyDistortionStack(double distortedX, double distortedY, co
     *undistortedY = p.y;
 } // applyDistortionStack
 
+void
+Distortion2DStack::applyDistortionStack(const double* distortedX, const double* distortedY, int pointsCount, const Distortion2DStack& stack, double* undistortedX, double* undistortedY)
+{
+    // Start from the distorted positions and refine them in-place, one stack entry at a time.
+    // Inverting the loops (stack entries outer, positions inner) hoists the per-entry setup out of
+    // the inner loop, instead of paying the list walk and type dispatch for every pixel.
+    for (int i = 0; i < pointsCount; ++i) {
+        undistortedX[i] = distortedX[i];
+        undistortedY[i] = distortedY[i];
+    }
+
+    for (std::list<DistortionFunction2DPtr>::const_reverse_iterator it = stack._imp->stack.rbegin(); it != stack._imp->stack.rend(); ++it) {
+        if ((*it)->transformMatrix) {
+            const Transform::Matrix3x3 H = *(*it)->transformMatrix;
+            if ( (H(2,0) == 0.) && (H(2,1) == 0.) && (H(2,2) == 1.) ) {
+                // Affine matrix: no perspective divide needed, the loop body is pure arithmetic
+                // on independent positions and vectorizes.
+                for (int i = 0; i < pointsCount; ++i) {
+                    double x = undistortedX[i];
+                    double y = undistortedY[i];
+                    undistortedX[i] = H(0,0) * x + H(0,1) * y + H(0,2);
+                    undistortedY[i] = H(1,0) * x + H(1,1) * y + H(1,2);
+                }
+            } else {
+                for (int i = 0; i < pointsCount; ++i) {
+                    Transform::Point3D p(undistortedX[i], undistortedY[i], 1.);
+                    p = Transform::matApply(H, p);
+                    undistortedX[i] = p.x / p.z;
+                    undistortedY[i] = p.y / p.z;
+                }
+            }
+        } else {
+            OfxInverseDistortionFunctionV1 func = (*it)->func;
+            void* customData = (*it)->customData;
+            for (int i = 0; i < pointsCount; ++i) {
+                func(customData, undistortedX[i], undistortedY[i], false, &undistortedX[i], &undistortedY[i], 0, 0);
+            }
+        }
+    }
+} // applyDistortionStack
+
 NATRON_NAMESPACE_EXIT;
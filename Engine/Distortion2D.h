@@ -110,6 +110,15 @@ public:
      **/
     static void applyDistortionStack(double distortedX, double distortedY, const Distortion2DStack& stack, double* undistortedX, double* undistortedY, bool wantsJacobian, bool* gotJacobian, double jacobian[4]);
 
+    /**
+     * @brief Applies a distortion stack onto multiple 2D positions in canonical coordinates, e.g: a whole scanline.
+     * Unlike the per-pixel variant above, the stack is only walked once: for each entry the setup
+     * (matrix coefficients fetch, function dispatch) is hoisted out of the inner loop over the positions,
+     * which for matrix entries reduces to straight arithmetic that the compiler can vectorize.
+     * Jacobians are not computed: callers needing them should use the per-pixel variant.
+     **/
+    static void applyDistortionStack(const double* distortedX, const double* distortedY, int pointsCount, const Distortion2DStack& stack, double* undistortedX, double* undistortedY);
+
 private:
 
     boost::scoped_ptr<Distortion2DStackPrivate> _imp;
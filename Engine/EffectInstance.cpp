@@ -63,6 +63,7 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 #include "Engine/Log.h"
 #include "Engine/MemoryInfo.h" // printAsRAM
 #include "Engine/Node.h"
+#include "Engine/NodeGroup.h"
 #include "Engine/OfxEffectInstance.h"
 #include "Engine/OfxOverlayInteract.h"
 #include "Engine/OfxImageEffectInstance.h"
@@ -151,8 +152,77 @@ EffectInstance::createRenderCopy(const FrameViewRenderKey& key) const
         return KnobHolderPtr();
     }
 
-    EffectInstancePtr clone = createFunc(boost::const_pointer_cast<EffectInstance>(shared_from_this()), key);
-    
+    EffectInstancePtr thisShared = boost::const_pointer_cast<EffectInstance>(shared_from_this());
+
+    // The knob values of a clone are frozen against the frame/view variant hash, hence a clone
+    // retired from a previous render may be re-used as long as the hash did not change, saving
+    // the construction of all knob clones on each playback frame. Effects with a knob items
+    // table (e.g: RotoPaint) are excluded: their table item clones are created per render key
+    // and cannot be re-used.
+    U64 warmCloneHash = 0;
+    if (!getItemsTable()) {
+        ComputeHashArgs hashArgs;
+        hashArgs.time = key.time;
+        hashArgs.view = key.view;
+        hashArgs.hashType = HashableObject::eComputeHashTypeTimeViewVariant;
+        warmCloneHash = thisShared->computeHash(hashArgs);
+    }
+
+    EffectInstancePtr clone;
+    if (warmCloneHash != 0) {
+        QMutexLocker k(&_imp->common->warmRenderClonesMutex);
+        for (std::list<EffectInstancePtr>::iterator it = _imp->common->warmRenderClones.begin(); it != _imp->common->warmRenderClones.end(); ++it) {
+            if ((*it)->_imp->renderData->warmCloneHash == warmCloneHash) {
+                clone = *it;
+                _imp->common->warmRenderClones.erase(it);
+                break;
+            }
+        }
+    }
+
+    if (clone) {
+        // Re-key the clone for the new render and register its knob clones again:
+        // they were unregistered when the clone was retired.
+        clone->updateRenderCloneKey(key);
+
+        KnobsVec mainKnobs = getKnobs_mt_safe();
+        for (KnobsVec::const_iterator it = mainKnobs.begin(); it != mainKnobs.end(); ++it) {
+            if ( !(*it)->getEvaluateOnChange() ) {
+                // The main instance knob itself serves as the clone for non-evaluating knobs
+                (*it)->setActualCloneForHolder(clone);
+            }
+        }
+        KnobsVec cloneKnobs = clone->getKnobs_mt_safe();
+        for (KnobsVec::const_iterator it = cloneKnobs.begin(); it != cloneKnobs.end(); ++it) {
+            (*it)->setActualCloneForHolder(clone);
+        }
+
+        // Reset the per-render data. Everything covered by the hash is kept, but the requests
+        // and input clones reference objects of the previous render. The frame range and
+        // time invariant metadata results are kept: they are plain results of state entirely
+        // covered by the matching hash, so re-using them skips the metadata and frame range
+        // actions (and the hash computations keying their cache entries) on each playback frame.
+        {
+            QMutexLocker k(&clone->_imp->renderData->lock);
+            clone->_imp->renderData->requests.clear();
+            clone->_imp->renderData->mainInstanceInputs.clear();
+            clone->_imp->renderData->renderInputs.clear();
+        }
+        {
+            QMutexLocker k(&_imp->common->pluginsPropMutex);
+            clone->_imp->renderData->props = _imp->common->props;
+        }
+
+        // The clone was not re-initialized, batch-evaluate its Python driven knobs for the
+        // new frame/view, see KnobHolder::prefetchPythonExpressionsResults()
+        clone->prefetchPythonExpressionsResults();
+    } else {
+        clone = createFunc(thisShared, key);
+        if (clone && clone->_imp->renderData) {
+            clone->_imp->renderData->warmCloneHash = warmCloneHash;
+        }
+    }
+
 
     // Make a copy of the main instance input locally so the state of the graph does not change throughout the render
     int nInputs = getMaxInputCount();
@@ -173,9 +243,51 @@ EffectInstance::createRenderCopy(const FrameViewRenderKey& key) const
         }
     }
 
+    // If this effect is the internal decoder of a ReadNode, notify the container that a render
+    // was requested at that frame: during playback it may schedule decodes of the upcoming
+    // frames ahead of the render threads, see ReadNode::onDecoderRenderRequested()
+    {
+        NodePtr ioContainer = node->getIOContainer();
+        if (ioContainer) {
+            ReadNodePtr isReadNode = ioContainer->isEffectReadNode();
+            if (isReadNode) {
+                TreeRenderPtr render = key.render.lock();
+                if ( render && render->isPlayback() ) {
+                    isReadNode->onDecoderRenderRequested(key.time, key.view, render);
+                }
+            }
+        }
+    }
+
     return clone;
 }
 
+void
+EffectInstance::onRenderCloneRetired(const KnobHolderPtr& clone)
+{
+    EffectInstancePtr effectClone = toEffectInstance(clone);
+    if (!effectClone || !effectClone->_imp->renderData || effectClone->_imp->renderData->warmCloneHash == 0) {
+        return;
+    }
+    QMutexLocker k(&_imp->common->warmRenderClonesMutex);
+    _imp->common->warmRenderClones.push_front(effectClone);
+    while ( (int)_imp->common->warmRenderClones.size() > NATRON_MAX_WARM_RENDER_CLONES ) {
+        _imp->common->warmRenderClones.pop_back();
+    }
+}
+
+void
+EffectInstance::clearWarmRenderClones()
+{
+    std::list<EffectInstancePtr> clones;
+    {
+        QMutexLocker k(&_imp->common->warmRenderClonesMutex);
+        clones.swap(_imp->common->warmRenderClones);
+    }
+    // Let the clones die outside of the lock
+    clones.clear();
+}
+
 RenderEngine*
 EffectInstance::createRenderEngine()
 {
@@ -287,6 +399,82 @@ EffectInstance::appendToHash(const ComputeHashArgs& args, Hash64* hash)
 
 } // appendToHash
 
+bool
+EffectInstance::isHashTimeVariant(ViewIdx view) const
+{
+    {
+        QMutexLocker k(&_imp->common->hashTimeVariantMutex);
+        std::map<ViewIdx, bool>::const_iterator found = _imp->common->hashTimeVariant.find(view);
+        if ( found != _imp->common->hashTimeVariant.end() ) {
+            return found->second;
+        }
+    }
+
+    bool timeVariant = const_cast<EffectInstance*>(this)->isHashTimeVariantInternal(view);
+
+    {
+        QMutexLocker k(&_imp->common->hashTimeVariantMutex);
+        _imp->common->hashTimeVariant[view] = timeVariant;
+    }
+
+    return timeVariant;
+}
+
+bool
+EffectInstance::isHashTimeVariantInternal(ViewIdx view)
+{
+    // When frame varying, appendToHash appends the render time directly.
+    if ( isFrameVarying() ) {
+        return true;
+    }
+
+    // The project parameters are part of the hash.
+    if ( getApp()->getProject()->hasTimeVariantKnobHash(view) ) {
+        return true;
+    }
+
+    // Animated parameters and expressions.
+    if ( hasTimeVariantKnobHash(view) ) {
+        return true;
+    }
+
+    // The disabled state is part of the hash and may vary over time even with constant
+    // parameters, see isNodeDisabledForFrame().
+    {
+        int lifeTimeFirst, lifeTimeEnd;
+        if ( isLifetimeActivated(&lifeTimeFirst, &lifeTimeEnd) ) {
+            return true;
+        }
+
+        NodeGroupPtr isContainerGrp = toNodeGroup( getNode()->getGroup() );
+        if ( isContainerGrp && isContainerGrp->isHashTimeVariant(view) ) {
+            return true;
+        }
+
+        NodePtr ioContainer = getNode()->getIOContainer();
+        if ( ioContainer && ioContainer->getEffectInstance()->isHashTimeVariant(view) ) {
+            return true;
+        }
+
+        // Paint strokes and roto shapes have a per-frame activation state.
+        if ( getAttachedRotoItem() ) {
+            return true;
+        }
+    }
+
+    // Finally the hash depends on the hash of the inputs at the frames needed: if none of
+    // them varies over time, neither does this effect, whatever the frames needed resolve to.
+    int nInputs = getMaxInputCount();
+    for (int i = 0; i < nInputs; ++i) {
+        EffectInstancePtr input = getInputRenderEffectAtAnyTimeView(i);
+        if ( input && input->isHashTimeVariant(view) ) {
+            return true;
+        }
+    }
+
+    return false;
+} // isHashTimeVariantInternal
+
 bool
 EffectInstance::invalidateHashCacheRecursive(const bool recurse, std::set<HashableObject*>* invalidatedObjects)
 {
@@ -296,6 +484,24 @@ EffectInstance::invalidateHashCacheRecursive(const bool recurse, std::set<Hashab
         return false;
     }
 
+    {
+        QMutexLocker k(&_imp->common->hashTimeVariantMutex);
+        _imp->common->hashTimeVariant.clear();
+    }
+
+    // The kept result image of a frame invariant effect is keyed by its hash: drop it along
+    // with the hash cache. Swap so the images are not destroyed under the mutex.
+    {
+        std::map<ViewIdx, EffectInstanceCommonData::PerPlaneTimeInvariantResultMap> droppedResults;
+        {
+            QMutexLocker k(&_imp->common->timeInvariantResultsMutex);
+            droppedResults.swap(_imp->common->timeInvariantResults);
+        }
+    }
+
+    // The knob values of warm render clones are no longer up to date
+    clearWarmRenderClones();
+
     //qDebug() << "Invalidate hash of" << getScriptName_mt_safe().c_str();
 
 
@@ -446,6 +652,17 @@ EffectInstance::shouldCacheOutput(bool isFrameVaryingOrAnimated,
 
     NodePtr node = getNode();
 
+    {
+        // Always cache the decoder embedded in a Read node: decoding a file is expensive, and
+        // since images are cached at tile granularity, viewing a small region of a large plate
+        // only ever decodes each tile-aligned region once, subsequent pans/zooms fetch the
+        // decoded sub-tiles back from the cache instead of re-decoding the source file.
+        NodePtr ioContainer = node->getIOContainer();
+        if ( ioContainer && toReadNode( ioContainer->getEffectInstance() ) ) {
+            return true;
+        }
+    }
+
     OutputNodesMap outputs;
     node->getOutputs(outputs);
     std::size_t nOutputNodes = outputs.size();
@@ -923,8 +1140,14 @@ EffectInstance::getImagePlane(const GetImageInArgs& inArgs, GetImageOutArgs* out
         ImagePlaneDesc plane, pairedPlane;
         getMetadataComponents(inArgs.inputNb, &plane, &pairedPlane);
         if (outArgs->image->getLayer() != plane) {
-            mustConvertImage = true;
             preferredLayer = plane;
+            // Only copy if the pixel layout actually differs: if the planes have the same number
+            // of components, the buffer can be handed to the plug-in as is since the components
+            // advertised on the clip image are taken from the clip metadata, not from the layer
+            // of the image. A copy here would only relabel the plane.
+            if (outArgs->image->getLayer().getNumComponents() != plane.getNumComponents()) {
+                mustConvertImage = true;
+            }
         }
     }
     ImageBitDepthEnum thisBitDepth = getBitDepth(inArgs.inputNb);
@@ -1021,8 +1244,18 @@ EffectInstance::getImagePlane(const GetImageInArgs& inArgs, GetImageOutArgs* out
         }
         ActionRetCodeEnum stat = convertedImage->copyPixels(*outArgs->image, copyArgs);
         if (isFailureRetCode(stat)) {
-            return false;   
+            return false;
+        }
+
+        // Report forced bit-depth conversions in the render statistics: they do not appear
+        // anywhere in the node-graph and can add up to a significant part of the frame time.
+        if ( (thisBitDepth != outArgs->image->getBitDepth()) && currentRender ) {
+            RenderStatsPtr stats = currentRender->getStatsObject();
+            if ( stats && stats->isInDepthProfilingEnabled() ) {
+                stats->addBitDepthConversionForNode( getNode() );
+            }
         }
+
         outArgs->image = convertedImage;
     } // mustConvertImage
 
@@ -1160,6 +1393,9 @@ EffectInstance::evaluate(bool isSignificant,
         onMetadataChanged_recursive_public();
     }
 
+    // A knob changed: the serialization cached for differential auto-saves is stale
+    node->invalidateAutoSaveSerialization();
+
     if (isSignificant) {
         getApp()->triggerAutoSave();
     }
@@ -1169,6 +1405,9 @@ EffectInstance::evaluate(bool isSignificant,
 
     // Get the connected viewers downstream and re-render or redraw them.
     if (isSignificant) {
+        // If the user is dragging a parameter with draft render enabled, start or update the interactive
+        // parameter edit session so that the renders issued below only re-render the spatial footprint of the edit.
+        _imp->updateInteractiveParamEditSession();
         getApp()->renderAllViewers();
     } else {
         getApp()->redrawAllViewers();
@@ -1230,6 +1469,10 @@ PluginMemoryPtr
 EffectInstance::createMemoryChunk(size_t nBytes)
 {
     PluginMemoryPtr mem = createPluginMemory();
+    NodePtr node = getNode();
+    if (node) {
+        mem->setMemoryAttribution( node->getFullyQualifiedName(), node->getPluginID() );
+    }
     PluginMemAllocateMemoryArgs args(nBytes);
     mem->allocateMemory(args);
     QMutexLocker k(&_imp->pluginMemoryChunksMutex);
@@ -1426,6 +1669,75 @@ EffectInstance::setCurrentCursor(const QString& customCursorFilePath)
 }
 
 
+// The application-wide accumulation generation: bumped whenever accumulation buffers must be discarded
+// tree-wide because their content may no longer reflect the current state of the node-graph, e.g: when
+// a new interactive parameter edit session starts, see Implementation::updateInteractiveParamEditSession()
+static QMutex g_accumulationGenerationMutex;
+static U64 g_accumulationGeneration = 0;
+
+static U64
+getAccumulationGeneration()
+{
+    QMutexLocker k(&g_accumulationGenerationMutex);
+
+    return g_accumulationGeneration;
+}
+
+static void
+incrementAccumulationGeneration()
+{
+    QMutexLocker k(&g_accumulationGenerationMutex);
+
+    ++g_accumulationGeneration;
+}
+
+void
+EffectInstance::Implementation::updateInteractiveParamEditSession()
+{
+    assert( QThread::currentThread() == qApp->thread() );
+
+    AppInstancePtr app = _publicInterface->getApp();
+    if ( !app || appPTR->isBackground() || !app->isDraftRenderEnabled() ) {
+        // The user is not dragging a parameter: close any active session. The regular render that
+        // follows will re-render everything without accumulation.
+        QMutexLocker k(&common->paramEditAccumMutex);
+        common->paramEditAccumActive = false;
+        return;
+    }
+
+    TimeValue time( app->getTimeLine()->currentFrame() );
+
+    // The spatial footprint of the edit is at most the union of the RoD of this effect before and
+    // after the parameter change: outside of it, this effect has no contribution either way.
+    RectD rod;
+    {
+        GetRegionOfDefinitionResultsPtr results;
+        ActionRetCodeEnum stat = _publicInterface->getRegionOfDefinition_public(time, RenderScale(1.), ViewIdx(0), &results);
+        if ( isFailureRetCode(stat) ) {
+            QMutexLocker k(&common->paramEditAccumMutex);
+            common->paramEditAccumActive = false;
+            return;
+        }
+        rod = results->getRoD();
+    }
+
+    QMutexLocker k(&common->paramEditAccumMutex);
+    if (!common->paramEditAccumActive || common->paramEditAccumTime != time) {
+        // This is a new session (or the timeline was moved in-between): accumulation buffers made by former
+        // sessions may be stale because of edits made since they were rendered, discard them tree-wide so
+        // that the first draft render of the session renders from scratch.
+        common->paramEditAccumActive = true;
+        common->paramEditAccumTime = time;
+        common->paramEditAccumUpdateArea = rod;
+        incrementAccumulationGeneration();
+    } else {
+        // Subsequent changes of the session: only the union of the previous and the new RoD may have changed.
+        common->paramEditAccumUpdateArea = common->paramEditAccumLastRoD;
+        common->paramEditAccumUpdateArea.merge(rod);
+    }
+    common->paramEditAccumLastRoD = rod;
+} // updateInteractiveParamEditSession
+
 void
 EffectInstance::clearLastRenderedImage()
 {
@@ -1436,6 +1748,10 @@ EffectInstance::clearLastRenderedImage()
         _imp->common->accumBuffer.clear();
     }
     accumBuffer.clear();
+
+    // Also release any warm render clone kept for later renders: they hold a shared pointer
+    // to the node.
+    clearWarmRenderClones();
 }
 
 void
@@ -1450,6 +1766,7 @@ EffectInstance::setAccumBuffer(const ImagePlaneDesc& plane, const ImagePtr& accu
             _imp->common->accumBuffer.erase(found);
         }
         _imp->common->accumBuffer.insert(std::make_pair(plane, accumBuffer));
+        _imp->common->accumBufferGeneration = getAccumulationGeneration();
     }
     // Ensure it is not destroyed while under the mutex, this could lead to a deadlock if the OpenGL context
     // switches during the texture destruction.
@@ -1461,46 +1778,187 @@ EffectInstance::getAccumBuffer(const ImagePlaneDesc& plane) const
 {
     {
         QMutexLocker k(&_imp->common->accumBufferMutex);
-        std::map<ImagePlaneDesc,ImagePtr>::const_iterator found = _imp->common->accumBuffer.find(plane);
-        if (found != _imp->common->accumBuffer.end()) {
-            return found->second;
+
+        // If the buffer was made under another accumulation generation, something else than the accumulated
+        // region changed since it was rendered: its content is possibly stale and must not be re-used.
+        if (_imp->common->accumBufferGeneration == getAccumulationGeneration()) {
+            std::map<ImagePlaneDesc,ImagePtr>::const_iterator found = _imp->common->accumBuffer.find(plane);
+            if (found != _imp->common->accumBuffer.end()) {
+                return found->second;
+            }
         }
 
     }
     return ImagePtr();
 }
 
+void
+EffectInstance::setTimeInvariantResultImage(ViewIdx view,
+                                            const ImagePlaneDesc& plane,
+                                            U64 hash,
+                                            unsigned int mipMapLevel,
+                                            const RenderScale& proxyScale,
+                                            const ImagePtr& image)
+{
+    ImagePtr curImage;
+    {
+        QMutexLocker k(&_imp->common->timeInvariantResultsMutex);
+        EffectInstanceCommonData::TimeInvariantRenderResult& result = _imp->common->timeInvariantResults[view][plane];
+        curImage = result.image;
+        result.hash = hash;
+        result.mipMapLevel = mipMapLevel;
+        result.proxyScale = proxyScale;
+        result.image = image;
+    }
+    // Ensure the previous image is not destroyed while under the mutex
+    curImage.reset();
+}
+
+ImagePtr
+EffectInstance::getTimeInvariantResultImage(ViewIdx view,
+                                            const ImagePlaneDesc& plane,
+                                            U64 hash,
+                                            unsigned int mipMapLevel,
+                                            const RenderScale& proxyScale) const
+{
+    QMutexLocker k(&_imp->common->timeInvariantResultsMutex);
+    std::map<ViewIdx, EffectInstanceCommonData::PerPlaneTimeInvariantResultMap>::const_iterator foundView = _imp->common->timeInvariantResults.find(view);
+
+    if ( foundView == _imp->common->timeInvariantResults.end() ) {
+        return ImagePtr();
+    }
+    EffectInstanceCommonData::PerPlaneTimeInvariantResultMap::const_iterator foundPlane = foundView->second.find(plane);
+    if ( foundPlane == foundView->second.end() ) {
+        return ImagePtr();
+    }
+    const EffectInstanceCommonData::TimeInvariantRenderResult& result = foundPlane->second;
+    if ( (result.hash != hash) ||
+         (result.mipMapLevel != mipMapLevel) ||
+         (result.proxyScale.x != proxyScale.x) ||
+         (result.proxyScale.y != proxyScale.y) ) {
+        return ImagePtr();
+    }
+
+    return result.image;
+}
+
 bool
 EffectInstance::isAccumulationEnabled() const
 {
-    return isDuringPaintStrokeCreation();
+    return isDuringPaintStrokeCreation() || isDuringInteractiveParamEditAccumulation();
 }
 
+/**
+ * @brief Recursively look upstream (including the given effect) for active interactive parameter edit sessions
+ * and merge their update areas in updateArea. Modeled on hasActiveStrokeItemNodeDrawingUpstream().
+ * @returns True if at least one session was found, in which case updateArea is set.
+ **/
+static bool getUpstreamParamEditSessionsUpdateArea(const EffectInstancePtr& effect,
+                                                   std::set<EffectInstancePtr>* markedEffects,
+                                                   bool* updateAreaSet,
+                                                   RectD* updateArea)
+{
+    if (markedEffects->find(effect) != markedEffects->end()) {
+        return *updateAreaSet;
+    }
+
+    markedEffects->insert(effect);
+
+    RectD sessionArea;
+    if ( effect->getInteractiveParamEditSessionUpdateArea(effect->getCurrentRenderTime(), &sessionArea) ) {
+        if (*updateAreaSet) {
+            updateArea->merge(sessionArea);
+        } else {
+            *updateArea = sessionArea;
+            *updateAreaSet = true;
+        }
+    }
+
+    int nInputs = effect->getMaxInputCount();
+    for (int i = 0; i < nInputs; ++i) {
+        EffectInstancePtr inputEffect = effect->getInputRenderEffectAtAnyTimeView(i);
+        if (!inputEffect) {
+            continue;
+        }
+        getUpstreamParamEditSessionsUpdateArea(inputEffect, markedEffects, updateAreaSet, updateArea);
+    }
+
+
+    return *updateAreaSet;
+} // getUpstreamParamEditSessionsUpdateArea
+
 bool
-EffectInstance::getAccumulationUpdateRoI(RectD* updateArea) const
+EffectInstance::isDuringInteractiveParamEditAccumulation() const
 {
     TreeRenderPtr render = getCurrentRender();
     if (!render) {
+        // Not during a render
         return false;
     }
 
-    RotoDrawableItemPtr activeItem = render->getCurrentlyDrawingItem();
-    if (!activeItem) {
+    if ( !render->isDraftRender() ) {
+        // Interactive parameter edits only accumulate in draft renders: the regular render issued
+        // when the user releases the parameter re-renders everything
         return false;
     }
 
-    FrameViewRenderKey renderKey;
-    renderKey.render = render;
-    renderKey.time = getCurrentRenderTime();
-    renderKey.view = getCurrentRenderView();
-    RotoStrokeItemPtr attachedStroke = toRotoStrokeItem(activeItem->createRenderClone(renderKey));
-    if (!attachedStroke) {
+    if ( render->getCurrentlyDrawingItem() ) {
+        // Painting takes precedence
         return false;
     }
-    *updateArea = attachedStroke->getLastStrokeMovementBbox();
+
+    std::set<EffectInstancePtr> markedEffects;
+    bool updateAreaSet = false;
+    RectD updateArea;
+
+    return getUpstreamParamEditSessionsUpdateArea(boost::const_pointer_cast<EffectInstance>(shared_from_this()), &markedEffects, &updateAreaSet, &updateArea);
+}
+
+bool
+EffectInstance::getInteractiveParamEditSessionUpdateArea(TimeValue time, RectD* updateArea) const
+{
+    QMutexLocker k(&_imp->common->paramEditAccumMutex);
+    if (!_imp->common->paramEditAccumActive) {
+        return false;
+    }
+    if (_imp->common->paramEditAccumTime != time) {
+        // The accumulated image is only valid at the time the session was made for
+        return false;
+    }
+    *updateArea = _imp->common->paramEditAccumUpdateArea;
     return true;
 }
 
+bool
+EffectInstance::getAccumulationUpdateRoI(RectD* updateArea) const
+{
+    TreeRenderPtr render = getCurrentRender();
+    if (!render) {
+        return false;
+    }
+
+    RotoDrawableItemPtr activeItem = render->getCurrentlyDrawingItem();
+    if (activeItem) {
+        FrameViewRenderKey renderKey;
+        renderKey.render = render;
+        renderKey.time = getCurrentRenderTime();
+        renderKey.view = getCurrentRenderView();
+        RotoStrokeItemPtr attachedStroke = toRotoStrokeItem(activeItem->createRenderClone(renderKey));
+        if (!attachedStroke) {
+            return false;
+        }
+        *updateArea = attachedStroke->getLastStrokeMovementBbox();
+        return true;
+    }
+
+    // Not painting: if this effect or effects upstream have an active interactive parameter edit session,
+    // the update area is the union of the spatial footprint of their last parameter change.
+    std::set<EffectInstancePtr> markedEffects;
+    bool updateAreaSet = false;
+
+    return getUpstreamParamEditSessionsUpdateArea(boost::const_pointer_cast<EffectInstance>(shared_from_this()), &markedEffects, &updateAreaSet, updateArea);
+}
+
 static bool hasActiveStrokeItemNodeDrawingUpstream(const EffectInstancePtr& effect,
                                             const RotoDrawableItemPtr& activeItem,
                                             std::set<EffectInstancePtr>* markedEffects)
@@ -122,6 +122,7 @@ NATRON_NAMESPACE_ENTER;
 #define PLUGINID_NATRON_READ                (NATRON_ORGANIZATION_DOMAIN_TOPLEVEL "." NATRON_ORGANIZATION_DOMAIN_SUB ".built-in.Read")
 #define PLUGINID_NATRON_WRITE               (NATRON_ORGANIZATION_DOMAIN_TOPLEVEL "." NATRON_ORGANIZATION_DOMAIN_SUB ".built-in.Write")
 #define PLUGINID_NATRON_ONEVIEW             (NATRON_ORGANIZATION_DOMAIN_TOPLEVEL "." NATRON_ORGANIZATION_DOMAIN_SUB ".built-in.OneView")
+#define PLUGINID_NATRON_PIXELEXPR           (NATRON_ORGANIZATION_DOMAIN_TOPLEVEL "." NATRON_ORGANIZATION_DOMAIN_SUB ".built-in.PixelExpr")
 #define PLUGINID_NATRON_STUB                (NATRON_ORGANIZATION_DOMAIN_TOPLEVEL "." NATRON_ORGANIZATION_DOMAIN_SUB ".built-in.Stub")
 
 #define kReaderParamNameOriginalFrameRange "originalFrameRange"
@@ -837,6 +838,13 @@ public:
 
     void onMetadataChanged_recursive_public();
 
+    /**
+     * @brief Same as onMetadataChanged_recursive_public() except that the set of already
+     * visited nodes is provided by the caller, so that the roots of a batched graph edit
+     * (see Project::beginGraphEditTransaction()) can share a single downstream pass.
+     **/
+    void onMetadataChanged_recursive_public(std::set<NodePtr>* markedNodes);
+
     void onMetadataChanged_nonRecursive_public();
 
 protected:
@@ -926,6 +934,20 @@ public:
 
     virtual void appendToHash(const ComputeHashArgs& args, Hash64* hash) OVERRIDE;
 
+    /**
+     * @brief The frame/view variant hash of an effect is time invariant when neither its
+     * parameters, its state (disabled, lifetime range...) nor any upstream effect depend
+     * on the time: a single hash per view is then cached instead of one per frame.
+     * During playback, all hash-keyed action and image cache look-ups of a frame invariant
+     * branch then hit the entries computed for the first frame, so the request pass does
+     * not re-resolve the branch on every frame.
+     **/
+    virtual bool isHashTimeVariant(ViewIdx view) const OVERRIDE WARN_UNUSED_RETURN;
+
+private:
+
+    bool isHashTimeVariantInternal(ViewIdx view);
+
 public:
 
     /**
@@ -1232,7 +1254,16 @@ protected:
 
     virtual KnobHolderPtr createRenderCopy(const FrameViewRenderKey& key) const OVERRIDE;
 
-    
+    virtual void onRenderCloneRetired(const KnobHolderPtr& clone) OVERRIDE FINAL;
+
+public:
+
+    /**
+     * @brief Release the warm render clones kept for re-use by later renders.
+     * This is called whenever the hash is invalidated or the node is destroyed.
+     **/
+    void clearWarmRenderClones();
+
 private:
 
     ActionRetCodeEnum launchRenderInternal(const RequestPassSharedDataPtr& requestPassSharedData, const FrameViewRequestPtr& requestData);
@@ -1737,7 +1768,22 @@ public:
     bool isDuringPaintStrokeCreation() const;
 
     /**
-     * @brief Virtual function that may be implemented that can enable accumulation. By default, it calls isDuringPaintStrokeCreation()
+     * @brief Returns whether this render may accumulate because the user is dragging a parameter of this effect
+     * or of an effect upstream with draft render enabled. In this case only the spatial footprint of the edit
+     * (the union of the RoD of the edited effect before and after the change) needs to be re-rendered, the rest
+     * of the image is re-used from the accumulation buffer, exactly like during painting.
+     **/
+    bool isDuringInteractiveParamEditAccumulation() const;
+
+    /**
+     * @brief If this effect has an active interactive parameter edit session (see Implementation::updateInteractiveParamEditSession)
+     * valid for the given time, set updateArea to the spatial footprint of the last parameter change and return true.
+     **/
+    bool getInteractiveParamEditSessionUpdateArea(TimeValue time, RectD* updateArea) const;
+
+    /**
+     * @brief Virtual function that may be implemented that can enable accumulation. By default, it returns true
+     * if isDuringPaintStrokeCreation() or isDuringInteractiveParamEditAccumulation() returns true
      **/
     virtual bool isAccumulationEnabled() const WARN_UNUSED_RETURN;
 
@@ -1748,6 +1794,16 @@ public:
     void setAccumBuffer(const ImagePlaneDesc& plane, const ImagePtr& lastRenderedImage);
     ImagePtr getAccumBuffer(const ImagePlaneDesc& plane) const;
 
+    /**
+     * @brief For frame invariant effects (see isHashTimeVariant()), the image produced by the
+     * last successful render for the given view and plane. It is returned only if it was rendered
+     * with the given hash and scale; since the hash of such an effect is the same for every frame,
+     * any other frame of the sequence may then be served this image directly without probing the
+     * cache again.
+     **/
+    ImagePtr getTimeInvariantResultImage(ViewIdx view, const ImagePlaneDesc& plane, U64 hash, unsigned int mipMapLevel, const RenderScale& proxyScale) const;
+    void setTimeInvariantResultImage(ViewIdx view, const ImagePlaneDesc& plane, U64 hash, unsigned int mipMapLevel, const RenderScale& proxyScale, const ImagePtr& image);
+
 
     /***
      * @brief For a plug-in that accumates, this function may set in updateArea an update portion for the image instead of rendering the whole RoI.
@@ -55,15 +55,29 @@ EffectInstanceActionKeyBase::appendToHash(Hash64* hash) const
 }
 
 void
-EffectInstanceActionKeyBase::toMemorySegment(IPCPropertyMap* /*properties*/) const
-{
-    throw std::runtime_error("EffectInstanceActionKeyBase::toMemorySegment serialization to a persistent cache unimplemented");
+EffectInstanceActionKeyBase::toMemorySegment(IPCPropertyMap* properties) const
+{
+    // Encode everything as a single U64 property: the key may share its property map with the
+    // results of the action (e.g: NodeMetadata) which imports any int, double or string
+    // property it finds when deserializing.
+    std::vector<U64> keyData(3);
+    keyData[0] = _data.nodeTimeViewVariantHash;
+    keyData[1] = Hash64::toU64(_data.scale.x);
+    keyData[2] = Hash64::toU64(_data.scale.y);
+    properties->setIPCPropertyN("ActionKey", keyData);
 } // toMemorySegment
 
 CacheEntryKeyBase::FromMemorySegmentRetCodeEnum
-EffectInstanceActionKeyBase::fromMemorySegment(const IPCPropertyMap& /*properties*/)
+EffectInstanceActionKeyBase::fromMemorySegment(const IPCPropertyMap& properties)
 {
-    throw std::runtime_error("EffectInstanceActionKeyBase::fromMemorySegment serialization to a persistent cache unimplemented");
+    std::vector<U64> keyData;
+    if (!properties.getIPCPropertyN("ActionKey", &keyData) || keyData.size() != 3) {
+        return eFromMemorySegmentRetCodeFailed;
+    }
+    _data.nodeTimeViewVariantHash = keyData[0];
+    _data.scale.x = Hash64::fromU64<double>(keyData[1]);
+    _data.scale.y = Hash64::fromU64<double>(keyData[2]);
+    return eFromMemorySegmentRetCodeOk;
 } // fromMemorySegment
 
 
@@ -264,7 +278,9 @@ GetFramesNeededResults::fromMemorySegment(bool /*isLockedForWriting*/,
 
 
 GetFrameRangeResults::GetFrameRangeResults()
-: CacheEntryBase(appPTR->getGeneralPurposeCache())
+// Store in the persistent cache: the frame range is time invariant and can be re-used
+// across sessions when re-opening a project.
+: CacheEntryBase(appPTR->getTileCache())
 , _range()
 {
     _range.min = _range.max = 0;
@@ -293,24 +309,34 @@ GetFrameRangeResults::setFrameRangeResults(const RangeD &range)
 }
 
 void
-GetFrameRangeResults::toMemorySegment(IPCPropertyMap* /*properties*/) const
+GetFrameRangeResults::toMemorySegment(IPCPropertyMap* properties) const
 {
-    assert(false);
-    throw std::runtime_error("GetFrameRangeResults::toMemorySegment serialization to a persistent cache unimplemented");
+    std::vector<double> rangeVec(2);
+    rangeVec[0] = _range.min;
+    rangeVec[1] = _range.max;
+    properties->setIPCPropertyN("FrameRange", rangeVec);
+    CacheEntryBase::toMemorySegment(properties);
 } // toMemorySegment
 
 CacheEntryBase::FromMemorySegmentRetCodeEnum
-GetFrameRangeResults::fromMemorySegment(bool /*isLockedForWriting*/,
-                                        const IPCPropertyMap& /*properties*/)
+GetFrameRangeResults::fromMemorySegment(bool isLockedForWriting,
+                                        const IPCPropertyMap& properties)
 {
-    assert(false);
-    throw std::runtime_error("GetFrameRangeResults::fromMemorySegment serialization from a persistent cache unimplemented");
+    std::vector<double> rangeVec;
+    if (!properties.getIPCPropertyN("FrameRange", &rangeVec) || rangeVec.size() != 2) {
+        return eFromMemorySegmentRetCodeFailed;
+    }
+    _range.min = rangeVec[0];
+    _range.max = rangeVec[1];
+    return CacheEntryBase::fromMemorySegment(isLockedForWriting, properties);
 } // fromMemorySegment
 
 
 
 GetTimeInvariantMetadataResults::GetTimeInvariantMetadataResults()
-: CacheEntryBase(appPTR->getGeneralPurposeCache())
+// Store in the persistent cache: this avoids re-running the metadata (getClipPreferences)
+// pass on every node of a project when re-opening it.
+: CacheEntryBase(appPTR->getTileCache())
 , _metadata()
 {
 
@@ -1803,6 +1803,12 @@ EffectInstance::onMetadataChanged_recursive_public()
 
 }
 
+void
+EffectInstance::onMetadataChanged_recursive_public(std::set<NodePtr>* markedNodes)
+{
+    onMetadataChanged_recursive(markedNodes);
+}
+
 void
 EffectInstance::onMetadataChanged_nonRecursive_public()
 {
@@ -30,6 +30,7 @@
 #include <QDebug>
 
 #include "Engine/AppInstance.h"
+#include "Engine/ImageCacheEntry.h"
 #include "Engine/Node.h"
 #include "Engine/NodeGroup.h"
 #include "Engine/OSGLContext.h"
@@ -268,6 +269,7 @@ EffectInstance::Implementation::tiledRenderingFunctor(const RectToRender & rectT
                                                       const TiledRenderingFunctorArgs& args)
 {
 
+    ScopedProfilerSample profilerSample(eProfilerCategoryRender, "EffectInstance::tiledRenderingFunctor");
 
     TreeRenderPtr render = _publicInterface->getCurrentRender();
 
@@ -309,8 +311,25 @@ EffectInstance::Implementation::tiledRenderingFunctor(const RectToRender & rectT
     }
 
 
+    // This rectangle is complete: publish its tiles right away so that concurrent renders
+    // waiting on them do not have to wait for the rest of the region.
+    if (args.incrementalTilesStatePublish && !render->isRenderAborted()) {
+        for (std::map<ImagePlaneDesc, ImagePtr>::const_iterator it = args.cachedPlanes.begin(); it != args.cachedPlanes.end(); ++it) {
+            it->second->getCacheEntry()->markCacheTilesInRegionAsRendered(rectToRender.rect);
+        }
+    }
+
     if (timeRecorder) {
-        stats->addRenderInfosForNode(_publicInterface->getNode(), timeRecorder->getTimeSinceCreation());
+        double timeSpent = timeRecorder->getTimeSinceCreation();
+        stats->addRenderInfosForNode(_publicInterface->getNode(), timeSpent);
+
+        // Also record a span for the timeline view of the frame: all requested planes
+        // are produced by the same render action, label the span with the first one.
+        std::string planeName;
+        if ( !args.cachedPlanes.empty() ) {
+            planeName = args.cachedPlanes.begin()->first.getPlaneLabel();
+        }
+        stats->addRenderSpanForNode(_publicInterface->getNode(), planeName, rectToRender.rect, timeSpent);
     }
     return render->isRenderAborted() ? eActionStatusAborted : eActionStatusOK;
 } // tiledRenderingFunctor
@@ -566,6 +585,21 @@ EffectInstance::Implementation::renderHandlerPlugin(const RectToRender & rectToR
                 setupGLForRender<GL_CPU>(osmesaRenderImage, args.glContext, actionArgs.roi, _publicInterface->getNode()->isGLFinishRequiredBeforeRender(), &contextAttacher);
             }
         }
+
+        // When in-depth profiling is on, measure the GPU time of the render action with a
+        // timer query so viewer latency can be attributed between CPU render and GPU shading
+        RenderStatsPtr stats = render->getStatsObject();
+        boost::scoped_ptr<OSGLTimeElapsedQuery<true> > gpuRenderTimer;
+        boost::scoped_ptr<OSGLTimeElapsedQuery<false> > osmesaRenderTimer;
+        if ( stats && stats->isInDepthProfilingEnabled() &&
+             (args.backendType == eRenderBackendTypeOpenGL || args.backendType == eRenderBackendTypeOSMesa) ) {
+            if ( args.glContext->isGPUContext() ) {
+                gpuRenderTimer.reset( new OSGLTimeElapsedQuery<true>() );
+            } else {
+                osmesaRenderTimer.reset( new OSGLTimeElapsedQuery<false>() );
+            }
+        }
+
         ActionRetCodeEnum stat = _publicInterface->render_public(actionArgs);
 
         if (args.backendType == eRenderBackendTypeOpenGL ||
@@ -580,6 +614,14 @@ EffectInstance::Implementation::renderHandlerPlugin(const RectToRender & rectToR
             }
         }
 
+        // Read back and destroy the timer queries while the GL context is still current
+        if (gpuRenderTimer || osmesaRenderTimer) {
+            double gpuTimeSec = gpuRenderTimer ? gpuRenderTimer->getTimeElapsedSeconds() : osmesaRenderTimer->getTimeElapsedSeconds();
+            stats->addGLRenderSpanForNode(_publicInterface->getNode(), actionArgs.outputPlanes.front().first.getPlaneLabel(), actionArgs.roi, gpuTimeSec);
+            gpuRenderTimer.reset();
+            osmesaRenderTimer.reset();
+        }
+
         if (osmesaRenderImage) {
             Image::CopyPixelsArgs cpyArgs;
             cpyArgs.roi = actionArgs.roi;
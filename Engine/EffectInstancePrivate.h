@@ -50,6 +50,9 @@
 
 #include "Engine/EngineFwd.h"
 
+// Maximum number of retired render clones kept warm per node for re-use by later renders
+#define NATRON_MAX_WARM_RENDER_CLONES 4
+
 NATRON_NAMESPACE_ENTER;
 
 struct RectToRender
@@ -255,6 +258,66 @@ struct EffectInstanceCommonData
     mutable QMutex accumBufferMutex;
     std::map<ImagePlaneDesc,ImagePtr> accumBuffer;
 
+    // Generation of the accumulation buffer: when it no longer matches the application-wide
+    // accumulation generation, the buffer contents may be stale (something else than the
+    // accumulated region changed since it was rendered) and it must not be re-used.
+    // Also protected by accumBufferMutex
+    U64 accumBufferGeneration;
+
+    // Protects the interactive parameter edit session data below
+    mutable QMutex paramEditAccumMutex;
+
+    // True whilst the user is dragging a significant parameter of this effect with draft render
+    // enabled: renders downstream of this effect may then accumulate like during painting and
+    // re-render only the portion of the image that the edit may have changed
+    bool paramEditAccumActive;
+
+    // The timeline time at which the session was last updated: accumulation is only valid
+    // for renders at that exact time
+    TimeValue paramEditAccumTime;
+
+    // Union of the RoD of this effect before and after the last parameter change of the session:
+    // this is the spatial footprint of the edit, i.e: the only region that needs to be re-rendered
+    RectD paramEditAccumUpdateArea;
+
+    // The RoD of this effect as of the last parameter change, used to compute the update area of
+    // the next change of the session
+    RectD paramEditAccumLastRoD;
+
+    // Protects hashTimeVariant
+    mutable QMutex hashTimeVariantMutex;
+
+    // Memoized per-view results of isHashTimeVariant(): determining it recurses upstream, so
+    // cache it here (shared with render clones) and clear it whenever the hash cache is invalidated.
+    std::map<ViewIdx, bool> hashTimeVariant;
+
+    // Protects timeInvariantResults
+    mutable QMutex timeInvariantResultsMutex;
+
+    // The image produced by the last successful render of a frame invariant effect
+    // (see isHashTimeVariant()), per view and plane, along with the parameters it was rendered
+    // with. The hash of such an effect is the same for every frame, so any other frame of the
+    // sequence requesting a contained region at the same scale is served this image directly,
+    // without probing the cache tiles state again. Cleared whenever the hash cache is
+    // invalidated; the recorded hash guards against stale re-use.
+    struct TimeInvariantRenderResult
+    {
+        U64 hash;
+        unsigned int mipMapLevel;
+        RenderScale proxyScale;
+        ImagePtr image;
+
+        TimeInvariantRenderResult()
+        : hash(0)
+        , mipMapLevel(0)
+        , proxyScale(1.)
+        , image()
+        {
+        }
+    };
+    typedef std::map<ImagePlaneDesc, TimeInvariantRenderResult> PerPlaneTimeInvariantResultMap;
+    std::map<ViewIdx, PerPlaneTimeInvariantResultMap> timeInvariantResults;
+
     // Active Viewer interacts, only accessed on the main thread
     std::list<OverlayInteractBasePtr> interacts;
 
@@ -268,6 +331,15 @@ struct EffectInstanceCommonData
     // we keep another shared pointer for render clones only, in  RenderCloneData
     NodeWPtr node;
 
+    // Protects warmRenderClones
+    mutable QMutex warmRenderClonesMutex;
+
+    // A small pool of warm render clones retired from finished renders, most recently retired
+    // first. createRenderCopy() re-uses them for renders with an equal frame/view variant hash
+    // to amortize clone construction across playback frames. The pool is cleared whenever the
+    // hash is invalidated or the node is destroyed.
+    std::list<EffectInstancePtr> warmRenderClones;
+
     EffectInstanceCommonData()
     : attachedContextsMutex(QMutex::Recursive)
     , attachedContexts()
@@ -282,9 +354,21 @@ struct EffectInstanceCommonData
     , paintStroke()
     , accumBufferMutex()
     , accumBuffer()
+    , accumBufferGeneration(0)
+    , paramEditAccumMutex()
+    , paramEditAccumActive(false)
+    , paramEditAccumTime(0)
+    , paramEditAccumUpdateArea()
+    , paramEditAccumLastRoD()
+    , hashTimeVariantMutex()
+    , hashTimeVariant()
+    , timeInvariantResultsMutex()
+    , timeInvariantResults()
     , interacts()
     , timelineInteracts()
     , node()
+    , warmRenderClonesMutex()
+    , warmRenderClones()
     {
 
     }
@@ -370,6 +454,10 @@ struct RenderCloneData
     // A shared pointer to the node, to ensure it does not get deleted while rendering
     NodePtr node;
 
+    // When non zero, the frame/view variant hash against which the knob values of this clone
+    // were built: once retired, the clone may be re-used by another render with an equal hash.
+    U64 warmCloneHash;
+
     RenderCloneData()
     : lock()
     , instanceSafeRenderMutex()
@@ -380,6 +468,7 @@ struct RenderCloneData
     , metadataResults()
     , props()
     , node()
+    , warmCloneHash(0)
     {
 
     }
@@ -500,6 +589,14 @@ public:
      **/
     CacheAccessModeEnum shouldRenderUseCache(const RequestPassSharedDataPtr& requestPassSharedData, const FrameViewRequestPtr& requestPassData);
 
+    /**
+     * @brief Called on the main-thread whenever a significant parameter of this effect is changed by the user.
+     * If draft render is enabled (i.e: the user is dragging the parameter), this starts or updates the interactive
+     * parameter edit session so that subsequent draft renders accumulate and re-render only the spatial footprint
+     * of the edit, see EffectInstance::isAccumulationEnabled()
+     **/
+    void updateInteractiveParamEditSession();
+
     ActionRetCodeEnum handleUpstreamFramesNeeded(const RequestPassSharedDataPtr& requestPassSharedData,
                                                  const FrameViewRequestPtr& requestPassData,
                                                  const RenderScale& proxyScale,
@@ -611,6 +708,16 @@ public:
 
         // For identity rectangles, this is the input identity image for each plane
         IdentityPlanesMap identityPlanes;
+
+        // When true, each rectangle is published in the tiles state map as soon as it is
+        // rendered instead of once when the whole requested region is done, so that
+        // concurrent renders waiting on these tiles can consume them earlier.
+        bool incrementalTilesStatePublish;
+
+        TiledRenderingFunctorArgs()
+        : incrementalTilesStatePublish(false)
+        {
+        }
     };
 
     ActionRetCodeEnum tiledRenderingFunctor(const RectToRender & rectToRender,
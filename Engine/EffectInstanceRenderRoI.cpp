@@ -240,6 +240,67 @@ EffectInstance::Implementation::handleIdentityEffect(double par,
             return eActionStatusInputDisconnected;
         }
 
+        // Walk up identity chains: graphs with many disabled nodes commonly chain dozens of
+        // identity effects, and requesting each of them would create a FrameViewRequest per node
+        // only to forward the image one edge at a time. Instead, resolve the first non-identity
+        // effect upstream here and request it directly: the requester then depends on it through
+        // a single pass-through edge. Each step goes through the render clone of the effect so it
+        // evaluates exactly as if it had been requested itself, and both the isIdentity and
+        // getRegionOfDefinition calls are cached against the effect's hash: once a chain has been
+        // resolved, walking it again at another mipmap level or for the next frame costs a few
+        // cache look-ups.
+        while (identityInput) {
+            FrameViewRenderKey frameViewKey = {inputTimeIdentity, inputIdentityView, requestPassSharedData->getTreeRender()};
+            EffectInstancePtr inputClone = toEffectInstance( identityInput->createRenderClone(frameViewKey) );
+            if (!inputClone) {
+                break;
+            }
+
+            // The RoD is needed to evaluate isIdentity. If the action fails or returns an empty
+            // RoD, stop and request the effect normally: its own requestRender will deal with it.
+            RectI inputPixelRoD;
+            {
+                GetRegionOfDefinitionResultsPtr rodResults;
+                ActionRetCodeEnum stat = inputClone->getRegionOfDefinition_public(inputTimeIdentity, combinedScale, inputIdentityView, &rodResults);
+                if (isFailureRetCode(stat)) {
+                    break;
+                }
+                RectD inputRoD = rodResults->getRoD();
+                if (inputRoD.isNull()) {
+                    break;
+                }
+                inputRoD.toPixelEnclosing(combinedScale, inputClone->getAspectRatio(-1), &inputPixelRoD);
+            }
+
+            int nextInputNb;
+            TimeValue nextTime;
+            ViewIdx nextView;
+            ImagePlaneDesc nextPlane;
+            {
+                IsIdentityResultsPtr results;
+                ActionRetCodeEnum stat = inputClone->isIdentity_public(true, inputTimeIdentity, combinedScale, inputPixelRoD, inputIdentityView, identityPlane, &results);
+                if (isFailureRetCode(stat)) {
+                    break;
+                }
+                results->getIdentityData(&nextInputNb, &nextTime, &nextView, &nextPlane);
+            }
+
+            // Stop on a non-identity effect, or on an effect identity on itself at another
+            // time (-2): the latter must get a request of its own so that its frame is cached.
+            if (nextInputNb < 0) {
+                break;
+            }
+
+            EffectInstancePtr nextInput = identityInput->getInputMainInstance(nextInputNb);
+            if (!nextInput) {
+                return eActionStatusInputDisconnected;
+            }
+            identityInput = nextInput;
+            inputTimeIdentity = nextTime;
+            inputIdentityView = nextView;
+            identityPlane = nextPlane;
+        }
+
         FrameViewRequestPtr createdRequest;
         return identityInput->requestRender(inputTimeIdentity, inputIdentityView, requestData->getProxyScale(), requestData->getMipMapLevel(), identityPlane, canonicalRoi, inputNbIdentity, requestData, requestPassSharedData, &createdRequest, 0);
 
@@ -599,7 +660,7 @@ EffectInstance::Implementation::checkRestToRender(bool updateTilesStateFromCache
 
     // Now we try to reduce the unrendered tiles in bigger rectangles so that there's a lot less calls to
     // the render action.
-    std::list<RectI> reducedRects;
+    std::vector<RectI> reducedRects;
     ImageTilesState::getMinimalRectsToRenderFromTilesState(renderMappedRoI, tilesState, &reducedRects);
 
     if (reducedRects.empty()) {
@@ -609,7 +670,7 @@ EffectInstance::Implementation::checkRestToRender(bool updateTilesStateFromCache
     // If there's an identity rect covered by a rectangle to render, remove it
     for (std::list<RectToRender>::const_iterator it = identityRects.begin(); it != identityRects.end(); ++it) {
         bool hasRectContainingIdentityRect = false;
-        for (std::list<RectI>::const_iterator it2 = reducedRects.begin(); it2 != reducedRects.end(); ++it2) {
+        for (std::vector<RectI>::const_iterator it2 = reducedRects.begin(); it2 != reducedRects.end(); ++it2) {
             if (it2->contains(it->rect)) {
                 hasRectContainingIdentityRect = true;
                 break;
@@ -628,9 +689,10 @@ EffectInstance::Implementation::checkRestToRender(bool updateTilesStateFromCache
         // in the number of available threads in the thread-pool
 
         const unsigned int nThreads = MultiThread::getNCPUsAvailable();
-        reducedRects = mainRenderRect.splitIntoSmallerRects(nThreads);
+        std::list<RectI> splits = mainRenderRect.splitIntoSmallerRects(nThreads);
+        reducedRects.assign( splits.begin(), splits.end() );
     }
-    for (std::list<RectI>::const_iterator it = reducedRects.begin(); it != reducedRects.end(); ++it) {
+    for (std::vector<RectI>::const_iterator it = reducedRects.begin(); it != reducedRects.end(); ++it) {
         if (!it->isNull()) {
             RectToRender r;
             r.rect = *it;
@@ -1355,6 +1417,7 @@ EffectInstance::requestRenderInternal(const RectD & roiCanonical,
 
             accumBuffer->updateRenderCloneAndImage(shared_from_this());
             // When drawing with a paint brush, we may only render the bounding box of the un-rendered points.
+            // Similarly, when the user is dragging a parameter, we may only render the spatial footprint of the edit.
             RectD updateAreaCanonical;
             if (getAccumulationUpdateRoI(&updateAreaCanonical)) {
                 
@@ -1385,6 +1448,38 @@ EffectInstance::requestRenderInternal(const RectD & roiCanonical,
 
         } // isAccumulating
 
+        // If the output of this effect cannot vary over time, serve the image kept from the
+        // render of a previous frame directly: the frame/view variant hash of a frame invariant
+        // branch is the same for every frame so the result could not differ, and this skips the
+        // per-frame cache tiles probe and the request pass of the whole branch.
+        if ( !isAccumulating && !render->isDraftRender() && (cachePolicy == eCacheAccessModeReadWrite) &&
+             !isHashTimeVariant( getCurrentRenderView() ) ) {
+            U64 timeInvariantHash;
+            {
+                ComputeHashArgs hashArgs;
+                hashArgs.hashType = HashableObject::eComputeHashTypeTimeViewVariant;
+                hashArgs.time = getCurrentRenderTime();
+                hashArgs.view = getCurrentRenderView();
+                timeInvariantHash = computeHash(hashArgs);
+            }
+            ImagePtr timeInvariantImage = getTimeInvariantResultImage(getCurrentRenderView(), requestData->getPlaneDesc(), timeInvariantHash, requestData->getMipMapLevel(), proxyScale);
+            if (timeInvariantImage) {
+                if ( ( !requestedImageScale || (requestedImageScale == timeInvariantImage) ) &&
+                     ( timeInvariantImage->getStorageMode() == EffectInstance::Implementation::storageModeFromBackendType(backendType) ) &&
+                     timeInvariantImage->getBounds().contains(downscaledRoI) ) {
+                    requestData->setRequestedScaleImagePlane(timeInvariantImage);
+                    requestData->initStatus(FrameViewRequest::eFrameViewRequestStatusRendered);
+                    return eActionStatusOK;
+                }
+                if (requestedImageScale == timeInvariantImage) {
+                    // The RoI grew beyond the kept image: start over with a fresh cache-backed
+                    // image, the kept image may be concurrently served to other frames and must
+                    // not be resized.
+                    requestedImageScale.reset();
+                    fullScaleImage.reset();
+                }
+            }
+        }
 
         // Evaluate the tiles state map on the image to check what's left to render and fetch tiles from cache
         // Note that no memory allocation is done here, only existing tiles are fetched from the cache.
@@ -1472,8 +1567,33 @@ EffectInstance::launchRender(const RequestPassSharedDataPtr& requestPassSharedDa
     }
     ActionRetCodeEnum stat = launchRenderInternal(requestPassSharedData, requestData);
 
+    if (stat == eActionStatusWaitingForResults) {
+        // The render did neither fail nor complete: everything left to render is pending in
+        // the cache, being computed by other threads. Reset the status so that the scheduler
+        // re-queues this request and calls launchRender() again later.
+        requestData->notifyRenderPostponed();
+        return stat;
+    }
+
     // Notify that we are done rendering
     requestData->notifyRenderFinished(stat);
+
+    // Keep the result image of a frame invariant effect so that requestRenderInternal() serves
+    // it to the other frames of the sequence directly.
+    if ( !isFailureRetCode(stat) &&
+         (requestData->getCachePolicy() == eCacheAccessModeReadWrite) &&
+         !isAccumulationEnabled() &&
+         !getCurrentRender()->isDraftRender() &&
+         !isHashTimeVariant( getCurrentRenderView() ) ) {
+        ImagePtr image = requestData->getRequestedScaleImagePlane();
+        if (image) {
+            ComputeHashArgs hashArgs;
+            hashArgs.hashType = HashableObject::eComputeHashTypeTimeViewVariant;
+            hashArgs.time = getCurrentRenderTime();
+            hashArgs.view = getCurrentRenderView();
+            setTimeInvariantResultImage(getCurrentRenderView(), requestData->getPlaneDesc(), computeHash(hashArgs), requestData->getMipMapLevel(), requestData->getProxyScale(), image);
+        }
+    }
     return stat;
 } // launchRender
 
@@ -1585,8 +1705,9 @@ EffectInstance::launchRenderInternal(const RequestPassSharedDataPtr& /*requestPa
     bool hasPendingTiles;
 
     // Initialize what's left to render, without fetching the tiles state map from the cache because it was already fetched in
-    // requestRender()
-    renderRetCode = _imp->checkRestToRender(false /*updateTilesStateFromCache*/, requestData, renderMappedRoI, mappedCombinedScale, cachedImagePlanes, &renderRects, &hasPendingTiles);
+    // requestRender(). However if this render was postponed and re-queued on the scheduler because of pending tiles,
+    // refresh the state from the cache: the pending tiles may have been rendered (or aborted) since.
+    renderRetCode = _imp->checkRestToRender(requestData->wasRenderPostponed() /*updateTilesStateFromCache*/, requestData, renderMappedRoI, mappedCombinedScale, cachedImagePlanes, &renderRects, &hasPendingTiles);
     if (isFailureRetCode(renderRetCode)) {
         finishProducedPlanesTilesStatesMap(cachedImagePlanes, true);
         return renderRetCode;
@@ -1596,6 +1717,15 @@ EffectInstance::launchRenderInternal(const RequestPassSharedDataPtr& /*requestPa
 
     while ((!renderRects.empty() || hasPendingTiles) && !isRenderAborted()) {
 
+        // If there is nothing we can render ourselves and all tiles left in the requested
+        // region are being computed by other threads, hand the request back to the scheduler
+        // instead of parking this thread in waitForPendingTiles(): the request gets re-queued
+        // and this thread can process another dependency-free request meanwhile.
+        // This is bounded (see canSchedulePendingRetry()) to guarantee progress.
+        if (renderRects.empty() && requestData->canSchedulePendingRetry()) {
+            return eActionStatusWaitingForResults;
+        }
+
         // There may be no rectangles to render if all rectangles are pending (i.e: this render should wait for another thread
         // to complete the render first)
         if (!renderRects.empty()) {
@@ -1841,6 +1971,17 @@ EffectInstance::Implementation::launchPluginRenderAndHostFrameThreading(const Fr
     functorArgs->cachedPlanes = cachedPlanes;
     functorArgs->backendType = backendType;
 
+    // For multi-thread safe plug-ins rendering multiple rectangles on the CPU, publish each
+    // rectangle in the tiles state map as soon as it is rendered: concurrent renders needing
+    // these tiles poll the state map (see checkRestToRender/waitForPendingTiles) and can thus
+    // consume a finished tile immediately instead of waiting for the whole region.
+    {
+        RenderSafetyEnum safety = _publicInterface->getCurrentRenderThreadSafety();
+        functorArgs->incrementalTilesStatePublish = renderRects.size() > 1 &&
+                                                    backendType == eRenderBackendTypeCPU &&
+                                                    (safety == eRenderSafetyFullySafe || safety == eRenderSafetyFullySafeFrame);
+    }
+
     // Pre-fetch all input images that will be needed by identity rectangles so that the call to getImagePlane
     // is done once for each of them.
 
@@ -1901,6 +2042,18 @@ EffectInstance::Implementation::launchPluginRenderAndHostFrameThreading(const Fr
         }
     }
 
+    // Pre-fetch the value of each parameter at the render time/view on this thread: plug-ins
+    // typically read all of their parameters once per rectangle (and once per thread spawned
+    // with the multi-thread suite), and seeding the render-local values cache before any render
+    // thread is launched turns those reads into plain lock-free cache lookups.
+    {
+        ViewIdx view = _publicInterface->getCurrentRenderView();
+        const KnobsVec& knobs = _publicInterface->getKnobs();
+        for (KnobsVec::const_iterator it = knobs.begin(); it != knobs.end(); ++it) {
+            (*it)->seedRenderValuesCache(time, view);
+        }
+    }
+
     if (!attemptHostFrameThreading) {
 
         for (std::list<RectToRender>::const_iterator it = renderRects.begin(); it != renderRects.end(); ++it) {
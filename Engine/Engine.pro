@@ -69,6 +69,9 @@ INCLUDEPATH += $$PWD/../google-breakpad/src
 # hoedown
 INCLUDEPATH += $$PWD/../libs/hoedown/src
 
+# qhttpserver (RenderWorkerServer)
+INCLUDEPATH += $$PWD/../libs/qhttpserver/src
+
 #To overcome wrongly generated #include <...> by shiboken
 INCLUDEPATH += $$PWD
 INCLUDEPATH += $$PWD/NatronEngine
@@ -101,6 +104,8 @@ SOURCES += \
     Cache.cpp \
     CacheEntryBase.cpp \
     CacheEntryKeyBase.cpp \
+    CacheTileCompression.cpp \
+    CacheWarmupQueue.cpp \
     CLArgs.cpp \
     CoonsRegularization.cpp \
     ColorParser.cpp \
@@ -128,6 +133,7 @@ SOURCES += \
     FrameViewRequest.cpp \
     GenericSchedulerThread.cpp \
     GenericSchedulerThreadWatcher.cpp \
+    GLShaderChain.cpp \
     GPUContextPool.cpp \
     GroupInput.cpp \
     GroupOutput.cpp \
@@ -147,6 +153,7 @@ SOURCES += \
     ImageStorage.cpp \
     ImageTilesState.cpp \
     IPCCommon.cpp \
+    InteractionLatency.cpp \
     Interpolation.cpp \
     JoinViewsNode.cpp \
     KeybindShortcut.cpp \
@@ -195,10 +202,12 @@ SOURCES += \
     OneViewNode.cpp \
     OutputSchedulerThread.cpp \
     OverlayInteractBase.cpp \
+    PixelExprNode.cpp \
     PointOverlayInteract.cpp \
     Plugin.cpp \
     PluginMemory.cpp \
     PrecompNode.cpp \
+    ProcessFrameRing.cpp \
     ProcessHandler.cpp \
     Project.cpp \
     ProjectPrivate.cpp \
@@ -215,12 +224,15 @@ SOURCES += \
     PySideCompat.cpp \
     PyTracker.cpp \
     QtEnumConvert.cpp \
+    RamBuffer.cpp \
     ReadNode.cpp \
     RectD.cpp \
     RectI.cpp \
     RemovePlaneNode.cpp \
+    RenderImageArena.cpp \
     RenderStats.cpp \
     RenderQueue.cpp \
+    RenderWorkerServer.cpp \
     RotoBezierTriangulation.cpp \
     RotoDrawableItem.cpp \
     RotoItem.cpp \
@@ -237,6 +249,7 @@ SOURCES += \
     ScriptObject.cpp \
     Settings.cpp \
     SerializableWindow.cpp \
+    SharedCacheTier.cpp \
     SplitterI.cpp \
     Smooth1D.cpp \
     StandardPaths.cpp \
@@ -262,6 +275,7 @@ SOURCES += \
     TLSHolder.cpp \
     Transform.cpp \
     TransformOverlayInteract.cpp \
+    UndoStateStore.cpp \
     Utils.cpp \
     ViewerInstance.cpp \
     ViewerNode.cpp \
@@ -349,6 +363,8 @@ HEADERS += \
     Cache.h \
     CacheEntryBase.h \
     CacheEntryKeyBase.h \
+    CacheTileCompression.h \
+    CacheWarmupQueue.h \
     CoonsRegularization.h \
     CornerPinOverlayInteract.h \
     ChoiceOption.h \
@@ -378,9 +394,11 @@ HEADERS += \
     GenericSchedulerThread.h \
     GenericSchedulerThreadWatcher.h \
     GLShader.h \
+    GLShaderChain.h \
     GPUContextPool.h \
     GroupInput.h \
     GroupOutput.h \
+    HalfFloat.h \
     HashableObject.h \
     Hash64.h \
     HistogramCPU.h \
@@ -390,6 +408,8 @@ HEADERS += \
     ImageCacheKey.h \
     ImagePrivate.h \
     ImagePlaneDesc.h \
+    ImageSamplingKernels.h \
+    InteractionLatency.h \
     Interpolation.h \
     IPCCommon.h \
     ImageStorage.h \
@@ -446,11 +466,13 @@ HEADERS += \
     OutputSchedulerThread.h \
     OverlaySupport.h \
     OverlayInteractBase.h \
+    PixelExprNode.h \
     PointOverlayInteract.h \
     Plugin.h \
     PluginActionShortcut.h \
     PluginMemory.h \
     PrecompNode.h \
+    ProcessFrameRing.h \
     ProcessHandler.h \
     Project.h \
     ProjectPrivate.h \
@@ -473,8 +495,10 @@ HEADERS += \
     ReadNode.h \
     RectD.h \
     RectI.h \
+    RenderImageArena.h \
     RenderStats.h \
     RenderQueue.h \
+    RenderWorkerServer.h \
     RotoBezierTriangulation.h \
     RotoDrawableItem.h \
     RotoLayer.h \
@@ -492,6 +516,7 @@ HEADERS += \
     ScriptObject.h \
     Settings.h \
     SerializableWindow.h \
+    SharedCacheTier.h \
     Singleton.h \
     SplitterI.h \
     StandardPaths.h \
@@ -522,6 +547,7 @@ HEADERS += \
     TLSHolderImpl.h \
     Transform.h \
     UndoCommand.h \
+    UndoStateStore.h \
     Utils.h \
     Variant.h \
     ViewerInstance.h \
@@ -141,6 +141,7 @@ class CacheEntryKeyBase;
 class CacheEntryBase;
 class CacheEntryLockerBase;
 template<bool persistent> class CacheEntryLocker;
+class CacheWarmupQueue;
 class CompNodeItem;
 class CreateNodeArgs;
 class Curve;
@@ -162,6 +163,7 @@ struct FrameViewRenderKey;
 class FrameViewRequest;
 class GLRendererID;
 class GLShaderBase;
+class GLShaderChain;
 class GLImageStorage;
 class GPUContextPool;
 class GenericActionTLSArgs;
@@ -251,11 +253,13 @@ class OpenGLRendererInfo;
 class OpenGLViewerI;
 class OverlayInteractBase;
 class OverlaySupport;
+class PixelExprNode;
 class PlanarTrackLayer;
 class Plugin;
 class PluginGroupNode;
 class PluginMemory;
 class PrecompNode;
+class ProcessFrameRing;
 class ProcessHandler;
 class ProcessInputChannel;
 class Project;
@@ -266,10 +270,12 @@ class ReadNode;
 class RectD;
 class RectI;
 class RenderEngine;
+class RenderImageArena;
 class RenderStats;
 class RenderActionTLSData;
 class RotoDrawableItem;
 class RenderQueue;
+class RenderWorkerServer;
 class RequestPassSharedData;
 class RotoItem;
 class RotoLayer;
@@ -302,6 +308,9 @@ class TrackerParamsProviderBase;
 class TrackerParamsProvider;
 class TreeRender;
 class UndoCommand;
+struct UndoNodeState;
+class UndoStatePayload;
+class UndoStateStore;
 class ViewIdx;
 class ViewerCurrentFrameRequestSchedulerStartArgs;
 class ViewerInstance;
@@ -337,6 +346,7 @@ typedef boost::shared_ptr<CacheBase> CacheBasePtr;
 typedef boost::shared_ptr<Curve> CurvePtr;
 typedef boost::shared_ptr<CacheEntryKeyBase> CacheEntryKeyBasePtr;
 typedef boost::shared_ptr<CacheEntryBase> CacheEntryBasePtr;
+typedef boost::shared_ptr<CacheWarmupQueue> CacheWarmupQueuePtr;
 typedef boost::shared_ptr<CreateNodeArgs> CreateNodeArgsPtr;
 typedef boost::shared_ptr<DiskCacheNode> DiskCacheNodePtr;
 typedef boost::shared_ptr<DistortionFunction2D> DistortionFunction2DPtr;
@@ -366,6 +376,7 @@ typedef boost::shared_ptr<GetComponentsKey> GetComponentsKeyPtr;
 typedef boost::shared_ptr<GetComponentsResults> GetComponentsResultsPtr;
 typedef boost::shared_ptr<GLImageStorage> GLImageStoragePtr;
 typedef boost::shared_ptr<GLShaderBase> GLShaderBasePtr;
+typedef boost::shared_ptr<GLShaderChain> GLShaderChainPtr;
 typedef boost::shared_ptr<GroupInput> GroupInputPtr;
 typedef boost::shared_ptr<GroupOutput> GroupOutputPtr;
 typedef boost::shared_ptr<HashableObject> HashableObjectPtr;
@@ -423,7 +434,9 @@ typedef boost::shared_ptr<OSGLContext> OSGLContextPtr;
 typedef boost::shared_ptr<OSGLContextAttacher> OSGLContextAttacherPtr;
 typedef boost::shared_ptr<OverlayInteractBase> OverlayInteractBasePtr;
 typedef boost::shared_ptr<OfxOverlayInteract> OfxOverlayInteractPtr;
+typedef boost::shared_ptr<PixelExprNode> PixelExprNodePtr;
 typedef boost::shared_ptr<PrecompNode> PrecompNodePtr;
+typedef boost::shared_ptr<ProcessFrameRing> ProcessFrameRingPtr;
 typedef boost::shared_ptr<ProcessHandler> ProcessHandlerPtr;
 typedef boost::shared_ptr<Project> ProjectPtr;
 typedef boost::shared_ptr<Plugin> PluginPtr;
@@ -432,6 +445,7 @@ typedef boost::shared_ptr<PluginMemory> PluginMemoryPtr;
 typedef boost::shared_ptr<RAMImageStorage> RAMImageStoragePtr;
 typedef boost::shared_ptr<ReadNode> ReadNodePtr;
 typedef boost::shared_ptr<RenderEngine> RenderEnginePtr;
+typedef boost::shared_ptr<RenderImageArena> RenderImageArenaPtr;
 typedef boost::shared_ptr<RenderActionTLSData> RenderActionTLSDataPtr;
 typedef boost::shared_ptr<RequestPassSharedData> RequestPassSharedDataPtr;
 typedef boost::shared_ptr<RenderStats> RenderStatsPtr;
@@ -463,6 +477,9 @@ typedef boost::shared_ptr<TrackMarkerAndOptions> TrackMarkerAndOptionsPtr;
 typedef boost::shared_ptr<TrackMarkerPM> TrackMarkerPMPtr;
 typedef boost::shared_ptr<TreeRender> TreeRenderPtr;
 typedef boost::shared_ptr<UndoCommand> UndoCommandPtr;
+typedef boost::shared_ptr<UndoNodeState> UndoNodeStatePtr;
+typedef boost::shared_ptr<UndoStatePayload> UndoStatePayloadPtr;
+typedef boost::shared_ptr<UndoStateStore> UndoStateStorePtr;
 typedef boost::shared_ptr<ViewerInstance> ViewerInstancePtr;
 typedef boost::shared_ptr<ViewerNode> ViewerNodePtr;
 typedef boost::shared_ptr<WriteNode> WriteNodePtr;
@@ -517,6 +534,7 @@ typedef boost::weak_ptr<TrackerParamsProvider> TrackerParamsProviderWPtr;
 typedef boost::weak_ptr<TrackerHelper> TrackerHelperWPtr;
 typedef boost::weak_ptr<TrackMarker> TrackMarkerWPtr;
 typedef boost::weak_ptr<TreeRender> TreeRenderWPtr;
+typedef boost::weak_ptr<UndoStatePayload> UndoStatePayloadWPtr;
 typedef boost::weak_ptr<ViewerInstance> ViewerInstanceWPtr;
 typedef boost::weak_ptr<ViewerNode> ViewerNodeWPtr;
 typedef std::list<ImagePtr> ImageList;
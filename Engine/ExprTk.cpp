@@ -115,6 +115,8 @@ typedef vector<pair<string, exprtk_ivararg_function_ptr > > exprtk_ivararg_funct
 typedef vector<pair<string, exprtk_ifunction_ptr > > exprtk_ifunction_table_t;
 
 struct KnobValueFunction;
+struct random_func;
+struct randomInt_func;
 
 NATRON_NAMESPACE_ANONYMOUS_EXIT
 
@@ -148,6 +150,27 @@ struct NATRON_NAMESPACE::KnobExprExprTk::ExpressionData
 
     // Hold in the same way vector variables locally
     std::vector<std::vector<double> > vectorVariables;
+
+    // Pre-resolved slots, filled the first time the expression is evaluated: in steady state
+    // the per-evaluation updates go directly through them instead of searching the symbol
+    // table and function tables by name.
+    double* frameVarRef;
+    shared_ptr<random_func> randomFunction;
+    shared_ptr<randomInt_func> randomIntFunction;
+
+    ExpressionData()
+    : expressionObject()
+    , functions()
+    , varargFunctions()
+    , genericFunctions()
+    , knobFunctions()
+    , projectViewNames()
+    , vectorVariables()
+    , frameVarRef(0)
+    , randomFunction()
+    , randomIntFunction()
+    {
+    }
 };
 
 KnobExprExprTk::ExpressionDataPtr
@@ -897,11 +920,16 @@ resetStateFunctions(const KnobExprExprTk::ExpressionDataPtr& data,
                     const FrameViewRenderKey& renderKey,
                     std::string* error)
 {
-    boost::shared_ptr<random_func> randomFunction = boost::dynamic_pointer_cast<random_func>(findGenericFunction("random", data));
-    boost::shared_ptr<randomInt_func> randomIntFunction = boost::dynamic_pointer_cast<randomInt_func>(findGenericFunction("randomInt", data));
+    if (!data->randomFunction) {
+        // Resolve the functions once for this compiled expression: subsequent evaluations
+        // reset them through the cached pointers without searching the function table
+        data->randomFunction = boost::dynamic_pointer_cast<random_func>( findGenericFunction("random", data) );
+        data->randomIntFunction = boost::dynamic_pointer_cast<randomInt_func>( findGenericFunction("randomInt", data) );
+        assert(data->randomFunction && data->randomIntFunction);
+    }
 
-    randomFunction->resetHash(time);
-    randomIntFunction->resetHash(time);
+    data->randomFunction->resetHash(time);
+    data->randomIntFunction->resetHash(time);
 
 
 
@@ -1757,6 +1785,7 @@ KnobHelperPrivate::validateExprTkExpression(const string& expression,
     {
         double time_f = (double)time;
         symbol_table.create_variable("frame", time_f);
+        data->frameVarRef = &symbol_table.variable_ref("frame");
     }
     string viewName = publicInterface->getHolder()->getApp()->getProject()->getViewName(view);
     symbol_table.create_stringvar("view", viewName);
@@ -1885,8 +1914,10 @@ KnobHelper::executeExprTkExpression(TimeValue time,
 
 
     if (existingExpression) {
-        // Update the frame & view in the table
-        symbol_table->variable_ref("frame") = (double)time;
+        // Update the frame in the table through the slot resolved when the expression
+        // was built, bypassing the symbol table lookup
+        assert(data->frameVarRef);
+        *data->frameVarRef = (double)time;
 
         // Remove from the symbol table functions that hold a state, and re-add a new fresh local copy of them so that the state
         // is local to this thread.
@@ -1899,6 +1930,7 @@ KnobHelper::executeExprTkExpression(TimeValue time,
         data->projectViewNames = getHolder()->getApp()->getProject()->getProjectViewNames();
         double time_f = (double)time;
         symbol_table->create_variable("frame", time_f);
+        data->frameVarRef = &symbol_table->variable_ref("frame");
         string viewName = getHolder()->getApp()->getProject()->getViewName(view);
         symbol_table->create_stringvar("view", viewName);
 
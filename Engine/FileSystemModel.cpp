@@ -50,6 +50,8 @@ CLANG_DIAG_ON(uninitialized)
 
 #include <SequenceParsing.h>
 
+#include "Engine/Timer.h"
+
 
 NATRON_NAMESPACE_ENTER;
 
@@ -93,6 +95,123 @@ getSplitPath(const QString& path)
     return splitPath;
 }
 
+// A shared index of directory content keyed by absolute path: scanning a large directory
+// (typically plates on a network file-system) is expensive and is done both by the file
+// dialog's gathering thread and by filesListFromPattern() every time a file knob needs to
+// resolve its frame range. Cached entries are revalidated cheaply against the directory
+// modification time instead of rescanning.
+namespace {
+
+struct DirectoryIndexKey
+{
+    QString path;
+    QDir::Filters filters;
+    QDir::SortFlags sort;
+
+    bool operator<(const DirectoryIndexKey& other) const
+    {
+        if (path < other.path) {
+            return true;
+        }
+        if (other.path < path) {
+            return false;
+        }
+        if ((int)filters < (int)other.filters) {
+            return true;
+        }
+        if ((int)other.filters < (int)filters) {
+            return false;
+        }
+
+        return (int)sort < (int)other.sort;
+    }
+};
+
+struct DirectoryIndexEntry
+{
+    // Modification time of the directory when it was scanned
+    QDateTime lastModified;
+    QFileInfoList content;
+};
+
+typedef std::map<DirectoryIndexKey, DirectoryIndexEntry> DirectoryIndexMap;
+
+} // anonymous namespace
+
+// Do not let the index grow unbounded: when full it is simply reset
+#define NATRON_DIRECTORY_INDEX_MAX_DIRS 128
+
+static QMutex directoryIndexMutex;
+static DirectoryIndexMap directoryIndex;
+
+static QFileInfoList
+getDirectoryContentCached(const QString& path,
+                          QDir::Filters filters,
+                          QDir::SortFlags sort)
+{
+    QDir dir(path);
+    const QDateTime lastModified = QFileInfo(path).lastModified();
+    DirectoryIndexKey key;
+
+    key.path = dir.absolutePath();
+    key.filters = filters;
+    key.sort = sort;
+
+    // The modification time check cannot detect a directory modified twice within the time stamp
+    // granularity of the file-system (usually 1 second): do not trust entries whose recorded
+    // time is too close to now.
+    const bool canTrustLastModified = lastModified.isValid() && lastModified.secsTo( QDateTime::currentDateTime() ) > 2;
+
+    {
+        QMutexLocker k(&directoryIndexMutex);
+        DirectoryIndexMap::iterator found = directoryIndex.find(key);
+        if ( found != directoryIndex.end() ) {
+            if (canTrustLastModified && (found->second.lastModified == lastModified)) {
+                return found->second.content;
+            }
+            directoryIndex.erase(found);
+        }
+    }
+
+    QFileInfoList content = dir.entryInfoList(filters, sort);
+
+    if (canTrustLastModified) {
+        QMutexLocker k(&directoryIndexMutex);
+        if ( (int)directoryIndex.size() >= NATRON_DIRECTORY_INDEX_MAX_DIRS ) {
+            directoryIndex.clear();
+        }
+        DirectoryIndexEntry& entry = directoryIndex[key];
+        entry.lastModified = lastModified;
+        entry.content = content;
+    }
+
+    return content;
+} // getDirectoryContentCached
+
+void
+FileSystemModel::invalidateDirectoryIndex(const QString& directory)
+{
+    QMutexLocker k(&directoryIndexMutex);
+
+    if ( directory.isEmpty() ) {
+        directoryIndex.clear();
+
+        return;
+    }
+    const QString absolute = QDir(directory).absolutePath();
+    DirectoryIndexMap::iterator it = directoryIndex.begin();
+    while ( it != directoryIndex.end() ) {
+        if (it->first.path == absolute) {
+            DirectoryIndexMap::iterator next = it;
+            ++next;
+            directoryIndex.erase(it);
+            it = next;
+        } else {
+            ++it;
+        }
+    }
+}
+
 struct FileSystemModelPrivate
 {
     FileSystemModel* _publicInterface; // can not be a smart ptr
@@ -382,9 +501,10 @@ FileSystemItem::addChild(const SequenceParsing::SequenceFromFilesPtr& sequence,
     }
 
 
+    std::vector<FileSystemItemPtr >::iterator foundExistingChild = _imp->children.end();
     for (std::vector<FileSystemItemPtr >::iterator it = _imp->children.begin(); it != _imp->children.end(); ++it) {
         if ( (*it)->fileName() == filename ) {
-            _imp->children.erase(it);
+            foundExistingChild = it;
             break;
         }
     }
@@ -409,7 +529,14 @@ FileSystemItem::addChild(const SequenceParsing::SequenceFromFilesPtr& sequence,
                                                                  size,
                                                                  shared_from_this() ) );
     model->_imp->registerItem(child);
-    _imp->children.push_back(child);
+
+    // Replace an existing child in place (e.g: a file sequence that has grown since it was
+    // added) so the children keep the order in which the directory was scanned
+    if ( foundExistingChild != _imp->children.end() ) {
+        *foundExistingChild = child;
+    } else {
+        _imp->children.push_back(child);
+    }
 } // FileSystemItem::addChild
 
 void
@@ -1224,6 +1351,7 @@ FileSystemModel::initGatherer()
         _imp->gatherer.reset( new FileGathererThread( shared_from_this() ) );
         assert(_imp->gatherer);
         QObject::connect( _imp->gatherer.get(), SIGNAL(directoryLoaded(QString)), this, SLOT(onDirectoryLoadedByGatherer(QString)) );
+        QObject::connect( _imp->gatherer.get(), SIGNAL(directoryUpdated(QString)), this, SLOT(onDirectoryUpdatedByGatherer(QString)) );
     }
 }
 
@@ -1257,9 +1385,28 @@ FileSystemModel::onDirectoryLoadedByGatherer(const QString& directory)
     Q_EMIT directoryLoaded(directory);
 }
 
+void
+FileSystemModel::onDirectoryUpdatedByGatherer(const QString& directory)
+{
+    if (directory != _imp->currentRootPath) {
+        return;
+    }
+
+    // The gathering thread pushed a new batch of children: between 2 batches rows are only
+    // appended (or refreshed in place), so a reset is enough to keep the views consistent
+    // without waiting for the whole directory to be scanned.
+    beginResetModel();
+    endResetModel();
+
+    Q_EMIT directoryLoaded(directory);
+}
+
 void
 FileSystemModel::onWatchedDirectoryChanged(const QString& directory)
 {
+    // The watcher is more reliable than the directory modification time: drop the index
+    invalidateDirectoryIndex(directory);
+
     FileSystemItemPtr item = _imp->getItemFromPath(directory);
 
     if (item) {
@@ -1544,7 +1691,21 @@ isVideoFileExtension(const std::string& ext)
     return false;
 }
 
-typedef std::list< std::pair< SequenceParsing::SequenceFromFilesPtr, QFileInfo > > FileSequences;
+// An entry gathered from the directory: a file sequence (or single file/directory) along with
+// whether it changed since it was last pushed to the file-system item
+struct GatheredFileEntry
+{
+    SequenceParsing::SequenceFromFilesPtr sequence;
+    QFileInfo info;
+    bool dirty;
+};
+
+typedef std::list<GatheredFileEntry> FileSequences;
+
+// Interval (in seconds) at which the gathering thread pushes the entries discovered so far to
+// the model, so that the file dialog displays a large directory progressively instead of
+// blocking until the whole scan is done
+#define NATRON_FILE_GATHERER_BATCH_INTERVAL_SEC 0.1
 
 #define KERNEL_INCR() \
     switch (viewOrder) \
@@ -1591,8 +1752,8 @@ FileGathererThread::gatheringKernel(const FileSystemItemPtr& item)
     sort |= QDir::IgnoreCase;
     sort |= QDir::DirsFirst;
 
-    ///All entries in the directory
-    QFileInfoList all = dir.entryInfoList(model->filter(), sort);
+    ///All entries in the directory, from the shared index when the directory did not change
+    QFileInfoList all = getDirectoryContentCached(dir.absolutePath(), model->filter(), sort);
 
     ///List of all possible file sequences in the directory or directories
     FileSequences sequences;
@@ -1609,6 +1770,9 @@ FileGathererThread::gatheringKernel(const FileSystemItemPtr& item)
         break;
     }
 
+    TimeLapse batchTimer;
+    double timeSinceLastBatch = 0;
+
     int i = start;
     while (i != end) {
         ///If we must abort we do it now
@@ -1618,7 +1782,8 @@ FileGathererThread::gatheringKernel(const FileSystemItemPtr& item)
 
         if ( all[i].isDir() ) {
             ///This is a directory
-            sequences.push_back( std::make_pair(SequenceParsing::SequenceFromFilesPtr(), all[i]) );
+            GatheredFileEntry entry = {SequenceParsing::SequenceFromFilesPtr(), all[i], true};
+            sequences.push_back(entry);
         } else {
             QString filename = all[i].fileName();
             /// If the item does not match the filter regexp set by the user, discard it
@@ -1629,7 +1794,8 @@ FileGathererThread::gatheringKernel(const FileSystemItemPtr& item)
 
             /// If file sequence fetching is disabled, accept it
             if ( !model->isSequenceModeEnabled() ) {
-                sequences.push_back( std::make_pair(SequenceParsing::SequenceFromFilesPtr(), all[i]) );
+                GatheredFileEntry entry = {SequenceParsing::SequenceFromFilesPtr(), all[i], true};
+                sequences.push_back(entry);
                 KERNEL_INCR();
                 continue;
             }
@@ -1644,7 +1810,8 @@ FileGathererThread::gatheringKernel(const FileSystemItemPtr& item)
             if ( !isVideoFileExtension( fileContent.getExtension() ) ) {
                 ///Note that we use a reverse iterator because we have more chance to find a match in the last recently added entries
                 for (FileSequences::reverse_iterator it = sequences.rbegin(); it != sequences.rend(); ++it) {
-                    if ( it->first && it->first->tryInsertFile(fileContent, false) ) {
+                    if ( it->sequence && it->sequence->tryInsertFile(fileContent, false) ) {
+                        it->dirty = true;
                         foundMatchingSequence = true;
                         break;
                     }
@@ -1653,15 +1820,38 @@ FileGathererThread::gatheringKernel(const FileSystemItemPtr& item)
 
             if (!foundMatchingSequence) {
                 SequenceParsing::SequenceFromFilesPtr newSequence( new SequenceParsing::SequenceFromFiles(fileContent, true) );
-                sequences.push_back( std::make_pair(newSequence, all[i]) );
+                GatheredFileEntry entry = {newSequence, all[i], true};
+                sequences.push_back(entry);
             }
         }
+
+        ///Push periodically the entries gathered so far to the item so they show-up in the
+        ///dialog right away: addChild() replaces in place a sequence that has grown since it
+        ///was pushed in a previous batch.
+        timeSinceLastBatch += batchTimer.getTimeElapsedReset();
+        if (timeSinceLastBatch > NATRON_FILE_GATHERER_BATCH_INTERVAL_SEC) {
+            timeSinceLastBatch = 0;
+            bool hasNewEntries = false;
+            for (FileSequences::iterator it = sequences.begin(); it != sequences.end(); ++it) {
+                if (it->dirty) {
+                    item->addChild(it->sequence, it->info);
+                    it->dirty = false;
+                    hasNewEntries = true;
+                }
+            }
+            if (hasNewEntries) {
+                Q_EMIT directoryUpdated( item->absoluteFilePath() );
+            }
+        }
+
         KERNEL_INCR();
     }
 
     ///Now iterate through the sequences and create the children as necessary
     for (FileSequences::iterator it = sequences.begin(); it != sequences.end(); ++it) {
-        item->addChild(it->first, it->second);
+        if (it->dirty) {
+            item->addChild(it->sequence, it->info);
+        }
     }
 
     Q_EMIT directoryLoaded( item->absoluteFilePath() );
@@ -1696,11 +1886,11 @@ FileSystemModel::filesListFromPattern(const std::string& pattern, SequenceParsin
         return false;
     }
 
-    QStringList files = dir.entryList(QDir::Files | QDir::NoDotAndDotDot);
+    QFileInfoList files = getDirectoryContentCached(dir.absolutePath(), QDir::Files | QDir::NoDotAndDotDot, QDir::Name);
 
     StringList filesList;
-    for (QStringList::iterator it = files.begin(); it!=files.end(); ++it) {
-        filesList.push_back(it->toStdString());
+    for (QFileInfoList::iterator it = files.begin(); it != files.end(); ++it) {
+        filesList.push_back( it->fileName().toStdString() );
     }
     return SequenceParsing::filesListFromPattern_fast(pattern, filesList, sequence);
 }
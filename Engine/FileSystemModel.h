@@ -165,8 +165,13 @@ public:
     bool isWorking() const;
 Q_SIGNALS:
 
+    // Emitted when the directory was entirely gathered
     void directoryLoaded(QString);
 
+    // Emitted periodically while gathering a large directory, after the entries discovered so
+    // far were pushed to the file-system item, so that views can display them progressively
+    void directoryUpdated(QString);
+
 private:
 
     virtual void run() OVERRIDE FINAL;
@@ -329,11 +334,21 @@ public:
 
     static bool filesListFromPattern(const std::string& pattern,  std::map<int,std::map<int,std::string> >* sequence);
 
+    /**
+     * @brief Removes the given directory (or every directory if empty) from the shared directory
+     * content index used by filesListFromPattern() and the file gathering thread. The index is
+     * normally revalidated automatically from the directory modification time, this is only
+     * needed when a change must be picked-up immediately (e.g: from a file-system watcher).
+     **/
+    static void invalidateDirectoryIndex( const QString& directory = QString() );
+
 
 public Q_SLOTS:
 
     void onDirectoryLoadedByGatherer(const QString& directory);
 
+    void onDirectoryUpdatedByGatherer(const QString& directory);
+
     void onWatchedDirectoryChanged(const QString& directory);
 
     void onWatchedFileChanged(const QString& file);
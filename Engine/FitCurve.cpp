@@ -26,12 +26,20 @@
 
 #include <cmath>
 #include <cassert>
+#include <map>
 #include <stdexcept>
 
+#include <QtCore/QThreadPool>
+#include <QtConcurrentRun> // QtCore on Qt4, QtConcurrent on Qt5
+
 #ifndef M_PI_2
 #define M_PI_2      1.57079632679489661923132169163975144   /* pi/2           */
 #endif
 
+// Below this number of points on both sides of a split, fitting the two halves
+// concurrently is not worth the cost of spawning a thread-pool task
+#define NATRON_FIT_CUBIC_PARALLEL_MIN_POINTS 64
+
 using namespace NATRON_NAMESPACE::FitCurve;
 NATRON_NAMESPACE_ENTER;
 
@@ -461,10 +469,28 @@ fit_cubic_internal(const std::vector<Point>& points,
     }
 
     std::vector<SimpleBezierCP> first, second;
-    fit_cubic_internal(firstSplit, tHat1, tHatCenter, error, &first);
-    tHatCenter.x = -tHatCenter.x;
-    tHatCenter.y = -tHatCenter.y;
-    fit_cubic_internal(secondSplit, tHatCenter, tHat2, error, &second);
+
+    // The two halves of the split are completely independent, so when they are both large
+    // enough and the application-wide thread-pool has threads to spare, fit them concurrently:
+    // this keeps the UI responsive when converting a multi-thousand points tablet stroke.
+    QThreadPool* tp = QThreadPool::globalInstance();
+    if ( (firstSplit.size() >= NATRON_FIT_CUBIC_PARALLEL_MIN_POINTS) &&
+         (secondSplit.size() >= NATRON_FIT_CUBIC_PARALLEL_MIN_POINTS) &&
+         ( tp->activeThreadCount() < tp->maxThreadCount() ) ) {
+        // QtConcurrent::run copies its arguments at call time, so negate the center tangent
+        // on a copy instead of in-place.
+        QFuture<void> firstFuture = QtConcurrent::run(fit_cubic_internal, firstSplit, tHat1, tHatCenter, error, &first);
+        Point tHatCenterNeg;
+        tHatCenterNeg.x = -tHatCenter.x;
+        tHatCenterNeg.y = -tHatCenter.y;
+        fit_cubic_internal(secondSplit, tHatCenterNeg, tHat2, error, &second);
+        firstFuture.waitForFinished();
+    } else {
+        fit_cubic_internal(firstSplit, tHat1, tHatCenter, error, &first);
+        tHatCenter.x = -tHatCenter.x;
+        tHatCenter.y = -tHatCenter.y;
+        fit_cubic_internal(secondSplit, tHatCenter, tHat2, error, &second);
+    }
     generatedBezier->clear();
     if ( !first.empty() ) {
         generatedBezier->insert( generatedBezier->end(), first.begin(), first.end() );
@@ -517,17 +543,36 @@ FitCurve::fit_cubic(const std::vector<Point>& points,
     }
 
     //First remove (almost) duplicate points
+    //Bin the points kept so far on a grid of the duplicate tolerance: a duplicate of a point
+    //can only lie in the 3x3 cells neighborhood of that point, so each incoming point is
+    //compared against a handful of points instead of every point kept so far.
     std::list<Point> newPoints;
-    for (std::vector<Point>::const_iterator it = points.begin(); it != points.end(); ++it) {
-        bool foundDuplicate = false;
-        for (std::list<Point>::const_iterator it2 = newPoints.begin(); it2 != newPoints.end(); ++it2) {
-            if ( (std::abs(it2->x - it->x) < 1e-4) && (std::abs(it2->y - it->y) < 1e-4) ) {
-                foundDuplicate = true;
-                break;
+    {
+        const double tolerance = 1e-4;
+        typedef std::map<std::pair<long long, long long>, std::vector<Point> > PointsGridMap;
+        PointsGridMap grid;
+        for (std::vector<Point>::const_iterator it = points.begin(); it != points.end(); ++it) {
+            long long cellX = (long long)std::floor(it->x / tolerance);
+            long long cellY = (long long)std::floor(it->y / tolerance);
+            bool foundDuplicate = false;
+            for (long long i = cellX - 1; i <= cellX + 1 && !foundDuplicate; ++i) {
+                for (long long j = cellY - 1; j <= cellY + 1 && !foundDuplicate; ++j) {
+                    PointsGridMap::const_iterator foundCell = grid.find( std::make_pair(i, j) );
+                    if ( foundCell == grid.end() ) {
+                        continue;
+                    }
+                    for (std::vector<Point>::const_iterator it2 = foundCell->second.begin(); it2 != foundCell->second.end(); ++it2) {
+                        if ( (std::abs(it2->x - it->x) < tolerance) && (std::abs(it2->y - it->y) < tolerance) ) {
+                            foundDuplicate = true;
+                            break;
+                        }
+                    }
+                }
+            }
+            if (!foundDuplicate) {
+                grid[std::make_pair(cellX, cellY)].push_back(*it);
+                newPoints.push_back(*it);
             }
-        }
-        if (!foundDuplicate) {
-            newPoints.push_back(*it);
         }
     }
 
@@ -63,6 +63,10 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 
 NATRON_NAMESPACE_ENTER;
 
+// Maximum number of times a frame/view render hitting only cache tiles pending in other
+// threads may be re-queued on the scheduler instead of blocking in waitForPendingTiles().
+#define NATRON_FRAME_VIEW_REQUEST_MAX_PENDING_RETRIES 3
+
 bool
 FrameView_compare_less::operator() (const FrameViewPair & lhs,
                                     const FrameViewPair & rhs) const
@@ -180,6 +184,11 @@ struct FrameViewRequestPrivate
     // The retCode of the launchRender function
     ActionRetCodeEnum retCode;
 
+    // Number of times the render of this frame/view was postponed and re-queued on the
+    // scheduler because all tiles left to render were pending in the cache.
+    // See canSchedulePendingRetry()
+    int numPendingRetries;
+
     // The full scale image is used for effects that do not support renderscale.
     // The requestedScaleImage is the final image
     ImagePtr fullScaleImage, requestedScaleImage;
@@ -229,6 +238,7 @@ struct FrameViewRequestPrivate
     , fallbackRenderDevice(eRenderBackendTypeCPU)
     , fallbackRenderDeviceEnabled(false)
     , retCode(eActionStatusOK)
+    , numPendingRetries(0)
     , fullScaleImage()
     , requestedScaleImage()
     , finalRoi()
@@ -412,6 +422,29 @@ FrameViewRequest::notifyRenderFinished(ActionRetCodeEnum stat)
     _imp->status = FrameViewRequest::eFrameViewRequestStatusRendered;
 }
 
+void
+FrameViewRequest::notifyRenderPostponed()
+{
+    QMutexLocker k(&_imp->lock);
+    assert(_imp->status == FrameViewRequest::eFrameViewRequestStatusPending);
+    ++_imp->numPendingRetries;
+    _imp->status = FrameViewRequest::eFrameViewRequestStatusNotRendered;
+}
+
+bool
+FrameViewRequest::canSchedulePendingRetry() const
+{
+    QMutexLocker k(&_imp->lock);
+    return _imp->numPendingRetries < NATRON_FRAME_VIEW_REQUEST_MAX_PENDING_RETRIES;
+}
+
+bool
+FrameViewRequest::wasRenderPostponed() const
+{
+    QMutexLocker k(&_imp->lock);
+    return _imp->numPendingRetries > 0;
+}
+
 
 RectD
 FrameViewRequest::getCurrentRoI() const
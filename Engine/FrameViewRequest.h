@@ -182,6 +182,28 @@ public:
      **/
     void notifyRenderFinished(ActionRetCodeEnum stat);
 
+    /**
+     * @brief Called when launchRender() returns eActionStatusWaitingForResults: the render
+     * did neither fail nor complete, all tiles left to render are pending in the cache,
+     * being computed by other threads. This resets the status so that the scheduler can
+     * re-queue this object and call launchRender() again later.
+     **/
+    void notifyRenderPostponed();
+
+    /**
+     * @brief Returns true if launchRender() may return eActionStatusWaitingForResults to get
+     * re-queued on the scheduler instead of blocking the thread on pending cache tiles.
+     * To guarantee progress, this only returns true for a limited number of retries, after
+     * which the render must block in waitForPendingTiles().
+     **/
+    bool canSchedulePendingRetry() const;
+
+    /**
+     * @brief Returns true if notifyRenderPostponed() was called at least once, i.e: this
+     * request was re-queued on the scheduler and launchRender() is being called again.
+     **/
+    bool wasRenderPostponed() const;
+
     /**
      * @brief Get the render mapped mipmap level (i.e: 0 if the node
      * does not support render scale)
@@ -0,0 +1,192 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2013-2017 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "GLShaderChain.h"
+
+#include <list>
+
+#include "Engine/GLShader.h"
+#include "Engine/OSGLContext.h"
+#include "Engine/OSGLFunctions.h"
+#include "Engine/Texture.h"
+
+NATRON_NAMESPACE_ENTER;
+
+struct GLShaderChainPrivate
+{
+    OSGLContextWPtr glContext;
+    std::list<GLShaderChain::PassPtr> passes;
+
+    // Scratch texture used to ping-pong intermediate results between passes,
+    // lazily allocated and kept across renders so repeated chains do not reallocate it.
+    GLTexturePtr pingPongTexture;
+
+    GLShaderChainPrivate(const OSGLContextPtr& glContext)
+    : glContext(glContext)
+    , passes()
+    , pingPongTexture()
+    {
+    }
+};
+
+GLShaderChain::GLShaderChain(const OSGLContextPtr& glContext)
+: _imp( new GLShaderChainPrivate(glContext) )
+{
+}
+
+GLShaderChain::~GLShaderChain()
+{
+}
+
+void
+GLShaderChain::appendPass(const PassPtr& pass)
+{
+    assert(pass);
+    _imp->passes.push_back(pass);
+}
+
+void
+GLShaderChain::clearPasses()
+{
+    _imp->passes.clear();
+}
+
+template <typename GL>
+static ActionRetCodeEnum
+renderPassInternal(const GLShaderChain::PassPtr& pass,
+                   const GLTexturePtr& srcTexture,
+                   const GLTexturePtr& dstTexture,
+                   const RectI& roi,
+                   const OSGLContextPtr& glContext)
+{
+    // Texture targets must be the same
+    int target = srcTexture->getTexTarget();
+    assert(target == dstTexture->getTexTarget());
+
+    GLShaderBasePtr shader = pass->getOrCreateShader(glContext);
+    if (!shader) {
+        return eActionStatusFailed;
+    }
+
+    GLuint fboID = glContext->getOrCreateFBOId();
+    GL::Disable(GL_SCISSOR_TEST);
+    GL::BindFramebuffer(GL_FRAMEBUFFER, fboID);
+    GL::Enable(target);
+    GL::ActiveTexture(GL_TEXTURE0);
+
+    U32 dstTexID = dstTexture->getTexID();
+    U32 srcTexID = srcTexture->getTexID();
+
+    GL::BindTexture( target, dstTexID );
+
+    GL::TexParameteri (target, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    GL::TexParameteri (target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    GL::TexParameteri (target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    GL::TexParameteri (target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    GL::FramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, target, dstTexID, 0 /*LoD*/);
+    glCheckFramebufferError(GL);
+    GL::BindTexture( target, srcTexID );
+
+    GL::TexParameteri (target, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    GL::TexParameteri (target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    GL::TexParameteri (target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    GL::TexParameteri (target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    shader->bind();
+    shader->setUniform("srcTex", 0);
+    pass->setUniforms(shader);
+
+    OSGLContext::applyTextureMapping<GL>(srcTexture->getBounds(), dstTexture->getBounds(), roi);
+
+    shader->unbind();
+    GL::BindTexture(target, 0);
+
+    glCheckError(GL);
+
+    return eActionStatusOK;
+} // renderPassInternal
+
+ActionRetCodeEnum
+GLShaderChain::render(const GLTexturePtr& srcTexture,
+                      const GLTexturePtr& dstTexture,
+                      const RectI& roi)
+{
+    OSGLContextPtr glContext = _imp->glContext.lock();
+    if ( !glContext || _imp->passes.empty() ) {
+        return eActionStatusFailed;
+    }
+
+    // Save the current context
+    OSGLContextSaver saveCurrentContext;
+
+    {
+        // Ensure this context is attached
+        OSGLContextAttacherPtr contextAttacher = OSGLContextAttacher::create(glContext);
+        contextAttacher->attach();
+
+        const int nPasses = (int)_imp->passes.size();
+
+        // Intermediate results ping-pong between the destination texture and the scratch
+        // texture: the i-th pass renders to the destination when an even number of passes
+        // remains after it, so the last one always lands in dstTexture.
+        if (nPasses > 1) {
+            if (!_imp->pingPongTexture) {
+                _imp->pingPongTexture.reset( new Texture(dstTexture->getTexTarget(),
+                                                         GL_NONE,
+                                                         GL_NONE,
+                                                         GL_NONE,
+                                                         dstTexture->getBitDepth(),
+                                                         dstTexture->getFormat(),
+                                                         dstTexture->getInternalFormat(),
+                                                         dstTexture->getGLType(),
+                                                         glContext->isGPUContext() /*useOpenGL*/) );
+            }
+            _imp->pingPongTexture->ensureTextureHasSize(dstTexture->getBounds(), 0);
+        }
+
+        GLTexturePtr input = srcTexture;
+        int i = 0;
+        for (std::list<PassPtr>::const_iterator it = _imp->passes.begin(); it != _imp->passes.end(); ++it, ++i) {
+            GLTexturePtr output = ( ( (nPasses - 1 - i) % 2 ) == 0 ) ? dstTexture : _imp->pingPongTexture;
+
+            ActionRetCodeEnum stat;
+            if ( glContext->isGPUContext() ) {
+                stat = renderPassInternal<GL_GPU>(*it, input, output, roi, glContext);
+            } else {
+                stat = renderPassInternal<GL_CPU>(*it, input, output, roi, glContext);
+            }
+            if ( isFailureRetCode(stat) ) {
+                return stat;
+            }
+            input = output;
+        }
+    }
+
+    return eActionStatusOK;
+} // render
+
+NATRON_NAMESPACE_EXIT;
@@ -0,0 +1,116 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2013-2017 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef Engine_GLShaderChain_h
+#define Engine_GLShaderChain_h
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#endif
+
+#include "Global/Enums.h"
+
+#include "Engine/EngineFwd.h"
+
+NATRON_NAMESPACE_ENTER;
+
+/**
+ * @brief A chainable GPU image-op stage: applies a sequence of shaders over a texture,
+ * ping-ponging intermediate results between the destination texture and a scratch
+ * texture attached to a FBO, without any CPU readback between the stages.
+ * This lets host-side operations (premult, lut, mix, channel shuffle...) run entirely
+ * on the GPU when the image is already destined for it, instead of a CPU pass each.
+ **/
+struct GLShaderChainPrivate;
+class GLShaderChain
+{
+public:
+
+    /**
+     * @brief One stage of the chain: provides the shader to run and sets its
+     * pass-specific uniforms. The shader samples its input on texture unit 0,
+     * which the chain exposes through the uniform "srcTex".
+     **/
+    class Pass
+    {
+    public:
+
+        Pass()
+        {
+        }
+
+        virtual ~Pass()
+        {
+        }
+
+        /**
+         * @brief Returns the shader to run for this pass. Implementations should cache
+         * the compiled shader on the context, e.g: as done by OSGLContext::getOrCreateCopyTexShader.
+         **/
+        virtual GLShaderBasePtr getOrCreateShader(const OSGLContextPtr& glContext) = 0;
+
+        /**
+         * @brief Called when the shader is bound and its input texture attached on unit 0:
+         * set the pass-specific uniforms here. The uniform "srcTex" is set by the chain.
+         **/
+        virtual void setUniforms(const GLShaderBasePtr& shader)
+        {
+            Q_UNUSED(shader);
+        }
+    };
+
+    typedef boost::shared_ptr<Pass> PassPtr;
+
+    GLShaderChain(const OSGLContextPtr& glContext);
+
+    ~GLShaderChain();
+
+    /**
+     * @brief Appends a pass to run after the ones already registered.
+     **/
+    void appendPass(const PassPtr& pass);
+
+    void clearPasses();
+
+    /**
+     * @brief Runs all registered passes over srcTexture for the given roi, the result of
+     * the last pass landing in dstTexture. The source is uploaded/bound once: intermediate
+     * results stay on the GPU, ping-ponging between dstTexture and a lazily allocated
+     * scratch texture that is kept across renders.
+     * The textures must belong to the context given to the constructor, which must not
+     * necessarily be attached when calling this.
+     **/
+    ActionRetCodeEnum render(const GLTexturePtr& srcTexture, const GLTexturePtr& dstTexture, const RectI& roi);
+
+private:
+
+    boost::scoped_ptr<GLShaderChainPrivate> _imp;
+};
+
+NATRON_NAMESPACE_EXIT;
+
+#endif // Engine_GLShaderChain_h
@@ -26,6 +26,7 @@
 
 #include <set>
 #include <stdexcept>
+#include <vector>
 
 #include <QMutex>
 #include <QWaitCondition>
@@ -58,6 +59,21 @@ struct GPUContextPoolPrivate
 
     std::map<QThread*, OSGLContextAttacherWPtr> perThreadsActiveContext;
 
+    // The context assigned to each render thread by getOrCreateOpenGLContext(): a thread keeps
+    // the same context across renders so that concurrent GPU renders launched from different
+    // threads do not cycle through (and queue on) each other's contexts.
+    std::map<QThread*, OSGLContextWPtr> perThreadGLContext;
+
+    // When multi-device rendering is enabled, the renderer ID of each detected device and one
+    // share context per device: OpenGL images cannot be shared across devices, hence each
+    // device forms its own share group. Since a render only ever uses a single context, this
+    // distributes independent renders across the devices.
+    std::vector<GLRendererID> deviceRendererIDs;
+    std::vector<OSGLContextWPtr> perDeviceGLShareContext;
+
+    // The device on which the next GPU context is created, cycled round-robin
+    std::size_t nextDeviceIndex;
+
     GPUContextPoolPrivate()
     : contextPoolMutex(QMutex::Recursive)
     , glContextPool()
@@ -66,10 +82,70 @@ struct GPUContextPoolPrivate
     , cpuGLContextPool()
     , lastUsedCPUGLContext()
     , cpuGLShareContext()
+    , deviceRendererIDs()
+    , perDeviceGLShareContext()
+    , nextDeviceIndex(0)
     {
     }
+
+    // Creates a new GPU context, alternating devices if multi-device rendering is enabled, and
+    // inserts it in the pool. The caller must hold contextPoolMutex.
+    OSGLContextPtr createGLContext(const SettingsPtr& settings);
 };
 
+OSGLContextPtr
+GPUContextPoolPrivate::createGLContext(const SettingsPtr& settings)
+{
+    // Pick the device to create the context on: either the renderer selected in the settings,
+    // or the next device in the round-robin when renders are distributed across all devices.
+    GLRendererID rendererID;
+    int deviceIndex = -1;
+    if (settings) {
+        if ( settings->isMultiOpenGLDeviceRenderingEnabled() ) {
+            if ( deviceRendererIDs.empty() ) {
+                const std::list<OpenGLRendererInfo>& renderers = appPTR->getOpenGLRenderers();
+                for (std::list<OpenGLRendererInfo>::const_iterator it = renderers.begin(); it != renderers.end(); ++it) {
+                    deviceRendererIDs.push_back(it->rendererID);
+                }
+                perDeviceGLShareContext.resize( deviceRendererIDs.size() );
+            }
+            if ( !deviceRendererIDs.empty() ) {
+                deviceIndex = nextDeviceIndex % deviceRendererIDs.size();
+                rendererID = deviceRendererIDs[deviceIndex];
+            }
+        } else {
+            rendererID = settings->getActiveOpenGLRendererID();
+        }
+    }
+
+    // All contexts of a device are created in the same share group: with per-thread contexts,
+    // textures rendered by one thread (e.g accumulated or cached GL images) may be consumed by
+    // a render running on another thread's context.
+    OSGLContextPtr shareContext = deviceIndex == -1 ? glShareContext.lock() : perDeviceGLShareContext[deviceIndex].lock();
+    OSGLContextPtr newContext = OSGLContext::create( FramebufferConfig(), shareContext.get(), true /*useGPU*/, -1, -1, rendererID );
+    glContextPool.insert(newContext);
+
+    if (settings) {
+        // Initialize once static max size props
+        (void)newContext->getMaxOpenGLHeight();
+        (void)newContext->getMaxOpenGLWidth();
+    }
+
+    // If this is the first context of its device, set it as the sharing context
+    if (!shareContext) {
+        if (deviceIndex == -1) {
+            glShareContext = newContext;
+        } else {
+            perDeviceGLShareContext[deviceIndex] = newContext;
+        }
+    }
+    if (deviceIndex != -1) {
+        ++nextDeviceIndex;
+    }
+
+    return newContext;
+} // GPUContextPoolPrivate::createGLContext
+
 GPUContextPool::GPUContextPool()
     : _imp( new GPUContextPoolPrivate() )
 {
@@ -133,6 +209,7 @@ GPUContextPool::clear()
     QMutexLocker k(&_imp->contextPoolMutex);
 
     _imp->glContextPool.clear();
+    _imp->perThreadGLContext.clear();
 }
 
 OSGLContextPtr
@@ -141,6 +218,8 @@ GPUContextPool::getOrCreateOpenGLContext(bool retrieveLastContext, bool checkIfG
     if (checkIfGLLoaded && (!appPTR->isOpenGLLoaded() || !appPTR->getCurrentSettings()->isOpenGLRenderingEnabled())) {
         return OSGLContextPtr();
     }
+    QThread* curThread = QThread::currentThread();
+
     QMutexLocker k(&_imp->contextPoolMutex);
 
     if (retrieveLastContext) {
@@ -150,21 +229,30 @@ GPUContextPool::getOrCreateOpenGLContext(bool retrieveLastContext, bool checkIfG
         }
     }
 
-    // Context-sharing disabled as it is not needed
-    OSGLContextPtr shareContext;// _imp->glShareContext.lock();
+    // If this thread was already assigned a context, stick to it
+    {
+        std::map<QThread*, OSGLContextWPtr>::iterator foundThread = _imp->perThreadGLContext.find(curThread);
+        if ( foundThread != _imp->perThreadGLContext.end() ) {
+            OSGLContextPtr stickyContext = foundThread->second.lock();
+            if ( stickyContext && _imp->glContextPool.count(stickyContext) ) {
+                _imp->lastUsedGLContext = stickyContext;
+
+                return stickyContext;
+            }
+            // The context was evicted from the pool (e.g the maximum contexts count was lowered):
+            // assign a new one below
+            _imp->perThreadGLContext.erase(foundThread);
+        }
+    }
+
     OSGLContextPtr newContext;
     SettingsPtr settings =  appPTR->getCurrentSettings();
-    GLRendererID rendererID;
-    if (settings) {
-        rendererID = settings->getActiveOpenGLRendererID();
-    }
 
     int maxContexts = settings ? std::max(settings->getMaxOpenGLContexts(), 1) : 1;
 
     if ( (int)_imp->glContextPool.size() < maxContexts ) {
         //  Create a new one
-        newContext = OSGLContext::create( FramebufferConfig(), shareContext.get(), true /*useGPU*/, -1, -1, rendererID );
-        _imp->glContextPool.insert(newContext);
+        newContext = _imp->createGLContext(settings);
     } else {
         while ((int)_imp->glContextPool.size() > maxContexts) {
             _imp->glContextPool.erase(_imp->glContextPool.begin());
@@ -192,22 +280,44 @@ GPUContextPool::getOrCreateOpenGLContext(bool retrieveLastContext, bool checkIfG
 
     assert(newContext);
 
-    if (settings) {
-        // Initialize once static max size props
-        (void)newContext->getMaxOpenGLHeight();
-        (void)newContext->getMaxOpenGLWidth();
+    _imp->perThreadGLContext[curThread] = newContext;
+    _imp->lastUsedGLContext = newContext;
+
+    return newContext;
+} // GPUContextPool::attachGLContextToRender
+
+OSGLContextPtr
+GPUContextPool::getIdleOpenGLContext()
+{
+    if ( !appPTR->isOpenGLLoaded() || !appPTR->getCurrentSettings()->isOpenGLRenderingEnabled() ) {
+        return OSGLContextPtr();
     }
 
-    // If this is the first context, set it as the sharing context
-    if (!shareContext) {
-        _imp->glShareContext = newContext;
+    QMutexLocker k(&_imp->contextPoolMutex);
+
+    // Re-use an idle context if there's one
+    for (std::set<OSGLContextPtr>::const_iterator it = _imp->glContextPool.begin(); it != _imp->glContextPool.end(); ++it) {
+        if ( !(*it)->isBusyWithAnotherThread() ) {
+            _imp->lastUsedGLContext = *it;
+
+            return *it;
+        }
     }
 
+    SettingsPtr settings =  appPTR->getCurrentSettings();
+    int maxContexts = settings ? std::max(settings->getMaxOpenGLContexts(), 1) : 1;
+    if ( (int)_imp->glContextPool.size() >= maxContexts ) {
+        // The pool is saturated: the caller should fall back to its CPU code path rather
+        // than queue behind the renders owning the contexts.
+        return OSGLContextPtr();
+    }
+
+    OSGLContextPtr newContext = _imp->createGLContext(settings);
+
     _imp->lastUsedGLContext = newContext;
 
     return newContext;
-} // GPUContextPool::attachGLContextToRender
-
+} // GPUContextPool::getIdleOpenGLContext
 
 OSGLContextPtr
 GPUContextPool::getOrCreateCPUOpenGLContext(bool retrieveLastContext)
@@ -56,6 +56,15 @@ public:
      **/
     OSGLContextPtr getOrCreateOpenGLContext(bool retrieveLastContext = false, bool checkIfGLLoaded = true);
 
+    /**
+     * @brief Returns an OpenGL context of the GPU pool that is not currently owned by another
+     * thread, creating a new one if the pool did not reach its maximum size yet.
+     * Unlike getOrCreateOpenGLContext, when the pool is saturated (all contexts busy rendering)
+     * this returns NULL instead of handing out a context that would block on attach: callers
+     * with a CPU implementation of their operation should fall back to it in that case.
+     **/
+    OSGLContextPtr getIdleOpenGLContext();
+
     /**
      * @brief Get an existing OpenGL OSMA context in the GPU pool or create a new one.
      * This function cycles through existing contexts so that each contexts gets to work.
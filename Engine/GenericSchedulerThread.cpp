@@ -76,11 +76,16 @@ struct GenericSchedulerThreadPrivate
     GenericSchedulerThread::ThreadStateEnum threadState;
     mutable QMutex threadStateMutex;
 
-    // The tasks queue, protected by enqueuedTasksMutex
+    // The tasks queue, protected by enqueuedTasksMutex. Producers only ever push in O(1):
+    // the scheduler thread splices the whole list out and does the task selection on
+    // localTasks below, so that startTask() never waits behind the worker.
     std::list<GenericThreadStartArgsPtr> enqueuedTasks, queuedTaskWhileProcessingAbort;
     QWaitCondition tasksEmptyCond;
     mutable QMutex enqueuedTasksMutex;
 
+    // Tasks spliced out of enqueuedTasks, only accessed by the scheduler thread itself: no lock needed
+    std::list<GenericThreadStartArgsPtr> localTasks;
+
     // true when the main-thread is calling executeOnMainThread
     bool executingOnMainThread;
     QWaitCondition executingOnMainThreadCond;
@@ -105,6 +110,7 @@ struct GenericSchedulerThreadPrivate
     , queuedTaskWhileProcessingAbort()
     , tasksEmptyCond()
     , enqueuedTasksMutex()
+    , localTasks()
     , executingOnMainThread(false)
     , executingOnMainThreadCond()
     , executingOnMainThreadMutex()
@@ -446,29 +452,41 @@ GenericSchedulerThread::run()
         {
             GenericThreadStartArgsPtr args;
             {
+                // Move the newly enqueued tasks to the thread-local list in O(1) so that producers
+                // calling startTask() never wait behind the task selection below.
                 QMutexLocker k(&_imp->enqueuedTasksMutex);
-                switch (behavior) {
-                    case eTaskQueueBehaviorProcessInOrder: {
-                        if ( !_imp->enqueuedTasks.empty() ) {
-                            args = _imp->enqueuedTasks.front();
-                            _imp->enqueuedTasks.pop_front();
-                        }
-                        break;
+                _imp->localTasks.splice( _imp->localTasks.end(), _imp->enqueuedTasks );
+            }
+
+            // If quitThread() was called, it cleared the shared queue and pushed a stub request:
+            // also discard the tasks already moved to the local list.
+            if ( mustQuitThread() && _imp->localTasks.size() > 1 ) {
+                GenericThreadStartArgsPtr stubArgs = _imp->localTasks.back();
+                _imp->localTasks.clear();
+                _imp->localTasks.push_back(stubArgs);
+            }
+
+            switch (behavior) {
+                case eTaskQueueBehaviorProcessInOrder: {
+                    if ( !_imp->localTasks.empty() ) {
+                        args = _imp->localTasks.front();
+                        _imp->localTasks.pop_front();
                     }
-                    case eTaskQueueBehaviorSkipToMostRecent: {
-                        if ( !_imp->enqueuedTasks.empty() ) {
-                            args = _imp->enqueuedTasks.back();
-                            _imp->enqueuedTasks.pop_back();
-                            std::list<GenericThreadStartArgsPtr> unskippableTasks;
-                            for (std::list<GenericThreadStartArgsPtr>::iterator it = _imp->enqueuedTasks.begin(); it != _imp->enqueuedTasks.end(); ++it) {
-                                if (!(*it)->isSkippable()) {
-                                    unskippableTasks.push_back(*it);
-                                }
+                    break;
+                }
+                case eTaskQueueBehaviorSkipToMostRecent: {
+                    if ( !_imp->localTasks.empty() ) {
+                        args = _imp->localTasks.back();
+                        _imp->localTasks.pop_back();
+                        std::list<GenericThreadStartArgsPtr> unskippableTasks;
+                        for (std::list<GenericThreadStartArgsPtr>::iterator it = _imp->localTasks.begin(); it != _imp->localTasks.end(); ++it) {
+                            if (!(*it)->isSkippable()) {
+                                unskippableTasks.push_back(*it);
                             }
-                            _imp->enqueuedTasks = unskippableTasks;
                         }
-                        break;
+                        _imp->localTasks.swap(unskippableTasks);
                     }
+                    break;
                 }
             }
             {
@@ -526,10 +544,10 @@ GenericSchedulerThread::run()
 #endif
                 if (behavior == eTaskQueueBehaviorProcessInOrder) {
                     _imp->enqueuedTasks.clear();
+                    _imp->localTasks.clear();
                 }
 
-                _imp->enqueuedTasks.insert( _imp->enqueuedTasks.end(), _imp->queuedTaskWhileProcessingAbort.begin(), _imp->queuedTaskWhileProcessingAbort.end() );
-                _imp->queuedTaskWhileProcessingAbort.clear();
+                _imp->enqueuedTasks.splice( _imp->enqueuedTasks.end(), _imp->queuedTaskWhileProcessingAbort );
             } else {
 #ifdef TRACE_GENERIC_SCHEDULER_THREAD
                 qDebug() << getThreadName().c_str() << ": Thread going idle normally.";
@@ -542,7 +560,7 @@ GenericSchedulerThread::run()
             }
         }
 
-        while (_imp->enqueuedTasks.empty() && _imp->queuedTaskWhileProcessingAbort.empty()) {
+        while (_imp->localTasks.empty() && _imp->enqueuedTasks.empty() && _imp->queuedTaskWhileProcessingAbort.empty()) {
             _imp->tasksEmptyCond.wait(&_imp->enqueuedTasksMutex);
         }
 #ifdef TRACE_GENERIC_SCHEDULER_THREAD
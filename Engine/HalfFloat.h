@@ -0,0 +1,210 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2013-2017 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef NATRON_ENGINE_HALFFLOAT_H
+#define NATRON_ENGINE_HALFFLOAT_H
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <cstddef>
+#include <cstring>
+
+// When the build targets F16C capable hardware (-mf16c, implied by -mavx2), the span
+// converters below use the hardware float<->half instructions.
+#ifdef __F16C__
+#include <immintrin.h>
+#endif
+
+#include "Engine/EngineFwd.h"
+
+NATRON_NAMESPACE_ENTER;
+
+/**
+ * @brief Converts a 16-bit IEEE 754 half precision value to single precision.
+ * Signed zeroes, subnormals, infinities and NaNs are preserved.
+ **/
+inline float
+halfToFloat(unsigned short h)
+{
+    unsigned int sign = (unsigned int)(h >> 15) << 31;
+    unsigned int exponent = (h >> 10) & 0x1f;
+    unsigned int mantissa = h & 0x3ff;
+    unsigned int bits;
+
+    if (exponent == 0) {
+        if (mantissa == 0) {
+            // +-0
+            bits = sign;
+        } else {
+            // Subnormal half: normalize
+            exponent = 127 - 15 + 1;
+            while ( (mantissa & 0x400) == 0 ) {
+                mantissa <<= 1;
+                --exponent;
+            }
+            mantissa &= 0x3ff;
+            bits = sign | (exponent << 23) | (mantissa << 13);
+        }
+    } else if (exponent == 0x1f) {
+        // Infinity or NaN
+        bits = sign | 0x7f800000 | (mantissa << 13);
+    } else {
+        bits = sign | ( (exponent - 15 + 127) << 23 ) | (mantissa << 13);
+    }
+
+    float ret;
+    std::memcpy( &ret, &bits, sizeof(ret) );
+    return ret;
+}
+
+/**
+ * @brief Converts a single precision value to 16-bit IEEE 754 half precision, with
+ * round to nearest even. Values outside of the half range become infinities.
+ **/
+inline unsigned short
+floatToHalf(float f)
+{
+    unsigned int bits;
+    std::memcpy( &bits, &f, sizeof(bits) );
+
+    unsigned short sign = (unsigned short)( (bits >> 16) & 0x8000 );
+    int exponent = (int)( (bits >> 23) & 0xff ) - 127 + 15;
+    unsigned int mantissa = bits & 0x7fffff;
+
+    if (exponent >= 0x1f) {
+        if ( ( (bits & 0x7f800000) == 0x7f800000 ) && mantissa ) {
+            // NaN
+            return sign | 0x7e00;
+        }
+        // Infinity or overflow
+        return sign | 0x7c00;
+    }
+    if (exponent <= 0) {
+        if (exponent < -10) {
+            // Underflows to +-0
+            return sign;
+        }
+        // Subnormal half
+        mantissa |= 0x800000;
+        unsigned int shift = 14 - exponent;
+        unsigned short ret = sign | (unsigned short)(mantissa >> shift);
+        unsigned int rem = mantissa & ( (1u << shift) - 1 );
+        unsigned int halfway = 1u << (shift - 1);
+        if ( rem > halfway || ( rem == halfway && (ret & 1) ) ) {
+            ++ret;
+        }
+        return ret;
+    }
+
+    unsigned short ret = sign | (unsigned short)(exponent << 10) | (unsigned short)(mantissa >> 13);
+    // Round to nearest even. A carry propagating into the exponent yields the correct result,
+    // including the rounding of the largest normal values to infinity.
+    unsigned int rem = mantissa & 0x1fff;
+    if ( rem > 0x1000 || ( rem == 0x1000 && (ret & 1) ) ) {
+        ++ret;
+    }
+    return ret;
+}
+
+/**
+ * @brief Converts a contiguous span of half values to floats
+ **/
+inline void
+halfToFloatSpan(const unsigned short* src,
+                float* dst,
+                std::size_t nElements)
+{
+    std::size_t i = 0;
+#ifdef __F16C__
+    for (; i + 4 <= nElements; i += 4) {
+        _mm_storeu_ps( dst + i, _mm_cvtph_ps( _mm_loadl_epi64( (const __m128i*)(src + i) ) ) );
+    }
+#endif
+    for (; i < nElements; ++i) {
+        dst[i] = halfToFloat(src[i]);
+    }
+}
+
+/**
+ * @brief Converts a contiguous span of float values to halfs
+ **/
+inline void
+floatToHalfSpan(const float* src,
+                unsigned short* dst,
+                std::size_t nElements)
+{
+    std::size_t i = 0;
+#ifdef __F16C__
+    for (; i + 4 <= nElements; i += 4) {
+        _mm_storel_epi64( (__m128i*)(dst + i), _mm_cvtps_ph( _mm_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC ) );
+    }
+#endif
+    for (; i < nElements; ++i) {
+        dst[i] = floatToHalf(src[i]);
+    }
+}
+
+/**
+ * @brief A 16-bit IEEE 754 half precision pixel. Converts implicitly to and from float
+ * so that it can be used as the PIX type of the depth-templated kernels operating on
+ * raw buffers of eImageBitDepthHalf images.
+ **/
+class HalfFloat
+{
+public:
+
+    HalfFloat()
+    : _bits(0)
+    {
+    }
+
+    HalfFloat(float v)
+    : _bits( floatToHalf(v) )
+    {
+    }
+
+    HalfFloat& operator=(float v)
+    {
+        _bits = floatToHalf(v);
+        return *this;
+    }
+
+    operator float() const
+    {
+        return halfToFloat(_bits);
+    }
+
+    unsigned short bits() const
+    {
+        return _bits;
+    }
+
+private:
+
+    unsigned short _bits;
+};
+
+NATRON_NAMESPACE_EXIT;
+
+#endif // NATRON_ENGINE_HALFFLOAT_H
@@ -26,11 +26,14 @@
 
 #include <algorithm>  // for std::for_each
 #include <cassert>
+#include <cstring>  // for std::memcpy
 #include <stdexcept>
 
+#ifdef NATRON_HASH64_USE_LEGACY_CRC
 #if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
 #include <boost/crc.hpp>
 #endif
+#endif
 #include <QtCore/QString>
 
 #include "Engine/Node.h"
@@ -38,6 +41,130 @@
 
 NATRON_NAMESPACE_ENTER;
 
+#ifndef NATRON_HASH64_USE_LEGACY_CRC
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER;
+
+// The backend below is the 64-bit variant of xxHash by Yann Collet
+// (https://github.com/Cyan4973/xxHash), rewritten against the specification.
+// Unlike the bit-oriented CRC-64 it replaces, it consumes the buffered values
+// in 32-byte stripes over 4 independent accumulators, which is an order of
+// magnitude faster on the multi-megabyte buffers produced by graph hashing.
+
+static const U64 xxh64Prime1 = 11400714785074694791ULL;
+static const U64 xxh64Prime2 = 14029467366897019727ULL;
+static const U64 xxh64Prime3 = 1609587929392839161ULL;
+static const U64 xxh64Prime4 = 9650029242287828579ULL;
+static const U64 xxh64Prime5 = 2870177450012600261ULL;
+
+static inline U64
+xxh64Rotl(U64 x, int r)
+{
+    return (x << r) | ( x >> (64 - r) );
+}
+
+static inline U64
+xxh64Read64(const unsigned char* p)
+{
+    U64 ret;
+
+    std::memcpy( &ret, p, sizeof(ret) );
+
+    return ret;
+}
+
+static inline U32
+xxh64Read32(const unsigned char* p)
+{
+    U32 ret;
+
+    std::memcpy( &ret, p, sizeof(ret) );
+
+    return ret;
+}
+
+static inline U64
+xxh64Round(U64 acc, U64 input)
+{
+    acc += input * xxh64Prime2;
+    acc = xxh64Rotl(acc, 31);
+    acc *= xxh64Prime1;
+
+    return acc;
+}
+
+static inline U64
+xxh64MergeRound(U64 acc, U64 val)
+{
+    acc ^= xxh64Round(0, val);
+    acc = acc * xxh64Prime1 + xxh64Prime4;
+
+    return acc;
+}
+
+static U64
+xxh64(const unsigned char* data, std::size_t len, U64 seed)
+{
+    const unsigned char* p = data;
+    const unsigned char* const end = data + len;
+    U64 h;
+
+    if (len >= 32) {
+        const unsigned char* const stripesEnd = end - 32;
+        U64 v1 = seed + xxh64Prime1 + xxh64Prime2;
+        U64 v2 = seed + xxh64Prime2;
+        U64 v3 = seed;
+        U64 v4 = seed - xxh64Prime1;
+
+        do {
+            v1 = xxh64Round( v1, xxh64Read64(p) ); p += 8;
+            v2 = xxh64Round( v2, xxh64Read64(p) ); p += 8;
+            v3 = xxh64Round( v3, xxh64Read64(p) ); p += 8;
+            v4 = xxh64Round( v4, xxh64Read64(p) ); p += 8;
+        } while (p <= stripesEnd);
+
+        h = xxh64Rotl(v1, 1) + xxh64Rotl(v2, 7) + xxh64Rotl(v3, 12) + xxh64Rotl(v4, 18);
+        h = xxh64MergeRound(h, v1);
+        h = xxh64MergeRound(h, v2);
+        h = xxh64MergeRound(h, v3);
+        h = xxh64MergeRound(h, v4);
+    } else {
+        h = seed + xxh64Prime5;
+    }
+
+    h += (U64)len;
+
+    while (p + 8 <= end) {
+        h ^= xxh64Round( 0, xxh64Read64(p) );
+        h = xxh64Rotl(h, 27) * xxh64Prime1 + xxh64Prime4;
+        p += 8;
+    }
+
+    if (p + 4 <= end) {
+        h ^= (U64)xxh64Read32(p) * xxh64Prime1;
+        h = xxh64Rotl(h, 23) * xxh64Prime2 + xxh64Prime3;
+        p += 4;
+    }
+
+    while (p < end) {
+        h ^= (U64)(*p) * xxh64Prime5;
+        h = xxh64Rotl(h, 11) * xxh64Prime1;
+        ++p;
+    }
+
+    h ^= h >> 33;
+    h *= xxh64Prime2;
+    h ^= h >> 29;
+    h *= xxh64Prime3;
+    h ^= h >> 32;
+
+    return h;
+}
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT;
+
+#endif // !NATRON_HASH64_USE_LEGACY_CRC
+
 void
 Hash64::computeHash()
 {
@@ -49,12 +176,30 @@ Hash64::computeHash()
     }
 
     const unsigned char* data = reinterpret_cast<const unsigned char*>( &node_values.front() );
+#ifdef NATRON_HASH64_USE_LEGACY_CRC
+    // The historical backend: kept so that cache keys persisted by older builds remain valid,
+    // see NATRON_CACHE_SERIALIZATION_VERSION in Cache.cpp.
     boost::crc_optimal<64, 0x42F0E1EBA9EA3693ULL, 0, 0, false, false> crc_64;
     crc_64.process_bytes(data, node_values.size() * sizeof(node_values[0]));
     hash = crc_64.checksum();
+#else
+    hash = xxh64(data, node_values.size() * sizeof(node_values[0]), 0);
+#endif
     hashValid = true;
 }
 
+U64
+Hash64::hashRawBuffer(const void* data, std::size_t size)
+{
+#ifdef NATRON_HASH64_USE_LEGACY_CRC
+    boost::crc_optimal<64, 0x42F0E1EBA9EA3693ULL, 0, 0, false, false> crc_64;
+    crc_64.process_bytes(data, size);
+    return crc_64.checksum();
+#else
+    return xxh64(reinterpret_cast<const unsigned char*>(data), size, 0);
+#endif
+}
+
 void
 Hash64::reset()
 {
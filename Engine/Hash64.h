@@ -42,6 +42,11 @@ NATRON_NAMESPACE_ENTER;
 /*The hash of a Node is the checksum of the vector of data containing:
     - the values of the current knob for this node + the name of the node
     - the hash values for the  tree upstream
+
+   Appends are buffered in a vector and checksummed in a single bulk pass by computeHash().
+   The checksum is xxHash64 by default; build with NATRON_HASH64_USE_LEGACY_CRC defined to
+   get back the historical CRC-64 backend, e.g: to keep the keys of a disk cache persisted
+   by an older build valid.
  */
 
 class Hash64
@@ -124,6 +129,13 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
         hashValid = false;
     }
 
+    /**
+     * @brief Checksums an arbitrary byte buffer in one bulk pass with the same backend
+     * as computeHash(), without going through the buffered appends. This is meant for
+     * integrity checksums of large payloads, e.g: cache tiles.
+     **/
+    static U64 hashRawBuffer(const void* data, std::size_t size);
+
     static void appendQString(const QString & str, Hash64* hash);
 
     static void appendCurve(const CurvePtr& curve, Hash64* hash);
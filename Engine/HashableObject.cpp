@@ -24,6 +24,7 @@
 
 #include "HashableObject.h"
 #include <list>
+#include <map>
 #include <QMutex>
 
 #include "Engine/Hash64.h"
@@ -40,6 +41,11 @@ struct HashableObjectPrivate
     // The hash cache
     mutable FrameViewHashMap timeViewVariantHashCache;
 
+    // Cache for eComputeHashTypeTimeViewVariant hashes of objects whose isHashTimeVariant()
+    // returns false: their hash is the same at any time, so a single value per view is
+    // cached instead of one per frame/view pair.
+    mutable std::map<ViewIdx, U64> viewVariantTimeInvariantHashCache;
+
     U64 timeViewInvariantCache;
 
     bool timeViewInvariantCacheValid;
@@ -58,6 +64,7 @@ struct HashableObjectPrivate
     : listeners()
     , dependencies()
     , timeViewVariantHashCache()
+    , viewVariantTimeInvariantHashCache()
     , timeViewInvariantCache(0)
     , timeViewInvariantCacheValid(false)
     , metadataSlaveCache(0)
@@ -72,6 +79,7 @@ struct HashableObjectPrivate
     : listeners()
     , dependencies()
     , timeViewVariantHashCache()
+    , viewVariantTimeInvariantHashCache()
     , timeViewInvariantCache()
     , timeViewInvariantCacheValid(false)
     , metadataSlaveCache()
@@ -81,6 +89,7 @@ struct HashableObjectPrivate
     {
         QMutexLocker k(&other.hashCacheMutex);
         timeViewVariantHashCache = other.timeViewVariantHashCache;
+        viewVariantTimeInvariantHashCache = other.viewVariantTimeInvariantHashCache;
         timeViewInvariantCache = other.timeViewInvariantCache;
         timeViewInvariantCacheValid = other.timeViewInvariantCacheValid;
         metadataSlaveCache = other.metadataSlaveCache;
@@ -88,7 +97,7 @@ struct HashableObjectPrivate
         hashCacheEnabled = other.hashCacheEnabled;
     }
 
-    bool findCachedHashInternal(const HashableObject::FindHashArgs& args, U64 *hash) const;
+    bool findCachedHashInternal(const HashableObject::FindHashArgs& args, bool timeVariant, U64 *hash) const;
 
     bool computeCachingEnabled() const;
 
@@ -136,10 +145,19 @@ HashableObject::addHashDependency(const HashableObjectPtr& dep)
 }
 
 bool
-HashableObjectPrivate::findCachedHashInternal(const HashableObject::FindHashArgs& args, U64 *hash) const
+HashableObjectPrivate::findCachedHashInternal(const HashableObject::FindHashArgs& args, bool timeVariant, U64 *hash) const
 {
     switch (args.hashType) {
         case HashableObject::eComputeHashTypeTimeViewVariant:
+            if (!timeVariant) {
+                // The hash does not depend on the time: a single value per view is cached
+                std::map<ViewIdx, U64>::const_iterator found = viewVariantTimeInvariantHashCache.find(args.view);
+                if ( found == viewVariantTimeInvariantHashCache.end() ) {
+                    return false;
+                }
+                *hash = found->second;
+                return true;
+            }
             return findFrameViewHash(args.time, args.view, timeViewVariantHashCache, hash);
         case HashableObject::eComputeHashTypeTimeViewInvariant:
             if (!timeViewInvariantCacheValid) {
@@ -165,8 +183,15 @@ HashableObjectPrivate::findCachedHashInternal(const HashableObject::FindHashArgs
 bool
 HashableObject::findCachedHash(const FindHashArgs& args, U64 *hash) const
 {
+    const bool timeVariant = args.hashType != eComputeHashTypeTimeViewVariant || isHashTimeVariant(args.view);
     QMutexLocker k(&_imp->hashCacheMutex);
-    return _imp->findCachedHashInternal(args, hash);
+    return _imp->findCachedHashInternal(args, timeVariant, hash);
+}
+
+bool
+HashableObject::isHashTimeVariant(ViewIdx /*view*/) const
+{
+    return true;
 }
 
 
@@ -182,6 +207,7 @@ HashableObject::computeHash_noCache(const ComputeHashArgs& args, Hash64* hash)
 U64
 HashableObject::computeHash(const ComputeHashArgs& args)
 {
+    const bool timeVariant = args.hashType != eComputeHashTypeTimeViewVariant || isHashTimeVariant(args.view);
     {
         // Find a hash in the cache.
         QMutexLocker k(&_imp->hashCacheMutex);
@@ -191,7 +217,7 @@ HashableObject::computeHash(const ComputeHashArgs& args)
             findArgs.time = args.time;
             findArgs.view = args.view;
             findArgs.hashType = args.hashType;
-            if (_imp->findCachedHashInternal(findArgs, &hashValue)) {
+            if (_imp->findCachedHashInternal(findArgs, timeVariant, &hashValue)) {
                 return hashValue;
             }
         }
@@ -216,8 +242,12 @@ HashableObject::computeHash(const ComputeHashArgs& args)
                 _imp->metadataSlaveCacheValid = true;
                 break;
             case eComputeHashTypeTimeViewVariant:
-                FrameViewPair fv = {roundImageTimeToEpsilon(args.time), args.view};
-                _imp->timeViewVariantHashCache[fv] = hashValue;
+                if (timeVariant) {
+                    FrameViewPair fv = {roundImageTimeToEpsilon(args.time), args.view};
+                    _imp->timeViewVariantHashCache[fv] = hashValue;
+                } else {
+                    _imp->viewVariantTimeInvariantHashCache[args.view] = hashValue;
+                }
                 break;
         }
 
@@ -251,6 +281,7 @@ HashableObject::invalidateHashCacheInternal(std::set<HashableObject*>* invalidat
         }
 #endif
         _imp->timeViewVariantHashCache.clear();
+        _imp->viewVariantTimeInvariantHashCache.clear();
         _imp->timeViewInvariantCacheValid = false;
         _imp->metadataSlaveCacheValid = false;
     }
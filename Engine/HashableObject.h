@@ -175,6 +175,18 @@ protected:
      **/
     virtual void appendToHash(const ComputeHashArgs& args, Hash64* hash) = 0;
 
+    /**
+     * @brief May be overriden to return false when the hash computed by appendToHash for
+     * eComputeHashTypeTimeViewVariant does not actually depend on the time in the arguments.
+     * In that case, computeHash caches a single hash per view instead of one per frame/view
+     * pair: during playback the object is then only re-hashed when its hash cache gets
+     * invalidated, not once per frame.
+     * The default implementation conservatively returns true. Overrides must return true
+     * whenever in doubt: wrongly returning false would make different frames share the
+     * same hash.
+     **/
+    virtual bool isHashTimeVariant(ViewIdx view) const;
+
 private:
 
     friend struct HashableObjectPrivate;
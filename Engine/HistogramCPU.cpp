@@ -28,10 +28,18 @@
 #include <cassert>
 #include <stdexcept>
 
+// SSE2 is the baseline for all x86-64 targets, this only excludes ancient 32-bit builds from the
+// vectorized binning below.
+#if defined(__SSE2__) || defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 2 )
+#define NATRON_HISTOGRAM_USE_SSE2
+#include <emmintrin.h>
+#endif
+
 #include <QtCore/QMutex>
 #include <QtCore/QWaitCondition>
 
 #include "Engine/Image.h"
+#include "Engine/MultiThread.h"
 #include "Engine/Smooth1D.h"
 #include "Engine/Node.h"
 #include "Engine/TreeRender.h"
@@ -50,6 +58,7 @@ struct HistogramRequest
     double vmin;
     double vmax;
     int smoothingKernelSize;
+    bool gpuBinning;
 
     HistogramRequest()
     : binsCount(0)
@@ -60,9 +69,10 @@ struct HistogramRequest
     , vmin(0)
     , vmax(0)
     , smoothingKernelSize(0)
+    , gpuBinning(false)
     {
     }
-    
+
     HistogramRequest(int binsCount,
                      int mode,
                      const ViewerNodePtr & viewer,
@@ -70,7 +80,8 @@ struct HistogramRequest
                      const RectD& roiParam,
                      double vmin,
                      double vmax,
-                     int smoothingKernelSize)
+                     int smoothingKernelSize,
+                     bool gpuBinning)
     : binsCount(binsCount)
     , mode(mode)
     , viewer(viewer)
@@ -79,6 +90,7 @@ struct HistogramRequest
     , vmin(vmin)
     , vmax(vmax)
     , smoothingKernelSize(smoothingKernelSize)
+    , gpuBinning(gpuBinning)
     {
     }
 };
@@ -94,6 +106,13 @@ struct FinishedHistogram
     double vmin, vmax;
     unsigned int mipMapLevel;
 
+    // For requests with gpuBinning: the image to bin is handed back to the caller along with the
+    // region to bin and the smoothing kernel size instead of being binned on the CPU,
+    // see getMostRecentlyProducedHistogram()
+    ImagePtr imageForGPUBinning;
+    RectI roiForGPUBinning;
+    int smoothingKernelSize;
+
     FinishedHistogram()
         : histogram1()
         , histogram2()
@@ -104,6 +123,9 @@ struct FinishedHistogram
         , vmin(0)
         , vmax(0)
         , mipMapLevel(0)
+        , imageForGPUBinning()
+        , roiForGPUBinning()
+        , smoothingKernelSize(0)
     {
     }
 };
@@ -153,7 +175,8 @@ HistogramCPU::computeHistogram(int mode,      //< corresponds to the enum Histog
                                int binsCount,
                                double vmin,
                                double vmax,
-                               int smoothingKernelSize)
+                               int smoothingKernelSize,
+                               bool gpuBinning)
 {
     /*Starting or waking-up the thread*/
     bool mustQuit;
@@ -163,7 +186,7 @@ HistogramCPU::computeHistogram(int mode,      //< corresponds to the enum Histog
     }
 
     QMutexLocker locker(&_imp->requestMutex);
-    _imp->requests.push_back( HistogramRequest(binsCount, mode, viewer, viewerInputNb, roiParam, vmin, vmax, smoothingKernelSize) );
+    _imp->requests.push_back( HistogramRequest(binsCount, mode, viewer, viewerInputNb, roiParam, vmin, vmax, smoothingKernelSize, gpuBinning) );
     if (!isRunning() && !mustQuit) {
         start(HighestPriority);
     } else {
@@ -181,7 +204,7 @@ HistogramCPU::quitAnyComputation()
 
         ///post a fake request to wakeup the thread
         l.unlock();
-        computeHistogram(0, ViewerNodePtr(), -1, RectD(), 0, 0, 0, 0);
+        computeHistogram(0, ViewerNodePtr(), -1, RectD(), 0, 0, 0, 0, false);
         l.relock();
         while (_imp->mustQuit) {
             _imp->mustQuitCond.wait(&_imp->mustQuitMutex);
@@ -206,7 +229,10 @@ HistogramCPU::getMostRecentlyProducedHistogram(std::vector<float>* histogram1,
                                                int* mode,
                                                double* vmin,
                                                double* vmax,
-                                               unsigned int* mipMapLevel)
+                                               unsigned int* mipMapLevel,
+                                               ImagePtr* imageForGPUBinning,
+                                               RectI* roiForGPUBinning,
+                                               int* smoothingKernelSize)
 {
     assert(histogram1 && histogram2 && histogram3 && binsCount && pixelsCount && mode && vmin && vmax);
 
@@ -226,12 +252,83 @@ HistogramCPU::getMostRecentlyProducedHistogram(std::vector<float>* histogram1,
     *vmin = h->vmin;
     *vmax = h->vmax;
     *mipMapLevel = h->mipMapLevel;
+    if (imageForGPUBinning) {
+        *imageForGPUBinning = h->imageForGPUBinning;
+    }
+    if (roiForGPUBinning) {
+        *roiForGPUBinning = h->roiForGPUBinning;
+    }
+    if (smoothingKernelSize) {
+        *smoothingKernelSize = h->smoothingKernelSize;
+    }
     _imp->produced.pop_back();
 
     return true;
 }
 
 
+/*
+ Bin a span of pixel values into the histogram.
+ Quantization is done in single precision: a value lying exactly on a bin boundary may land
+ in the neighbouring bin compared to the double precision computation of the generic loop,
+ which is harmless for a visualization histogram.
+ */
+static void
+histogramBinSpan(const float* src,
+                 int pixelStride,
+                 std::size_t nPixels,
+                 float vmin,
+                 float vmax,
+                 float binSize,
+                 std::vector<float>& histo)
+{
+    const int lastBin = (int)histo.size() - 1;
+    std::size_t i = 0;
+
+#ifdef NATRON_HISTOGRAM_USE_SSE2
+    {
+        const __m128 vminV = _mm_set1_ps(vmin);
+        const __m128 vmaxV = _mm_set1_ps(vmax);
+        const __m128 binSizeV = _mm_set1_ps(binSize);
+        for (; i + 4 <= nPixels; i += 4) {
+            __m128 v;
+            if (pixelStride == 1) {
+                v = _mm_loadu_ps(src + i);
+            } else {
+                v = _mm_setr_ps(src[i * pixelStride],
+                                src[(i + 1) * pixelStride],
+                                src[(i + 2) * pixelStride],
+                                src[(i + 3) * pixelStride]);
+            }
+
+            // One bit per lane set if vmin <= v < vmax
+            int inRange = _mm_movemask_ps( _mm_and_ps( _mm_cmple_ps(vminV, v), _mm_cmplt_ps(v, vmaxV) ) );
+            if (!inRange) {
+                continue;
+            }
+            __m128i indexV = _mm_cvttps_epi32( _mm_div_ps( _mm_sub_ps(v, vminV), binSizeV ) );
+            int indices[4];
+            _mm_storeu_si128( (__m128i*)indices, indexV );
+
+            // The increments themselves are a scatter, SSE2 cannot help here
+            for (int k = 0; k < 4; ++k) {
+                if ( inRange & (1 << k) ) {
+                    histo[std::min(indices[k], lastBin)] += 1.f;
+                }
+            }
+        }
+    }
+#endif
+
+    for (; i < nPixels; ++i) {
+        float v = src[i * pixelStride];
+        if ( (vmin <= v) && (v < vmax) ) {
+            int index = (int)( (v - vmin) / binSize );
+            histo[std::min(index, lastBin)] += 1.f;
+        }
+    }
+} // histogramBinSpan
+
 template <int srcNComps, int mode>
 void
 computeHisto_internal(const HistogramRequest & request,
@@ -249,6 +346,46 @@ computeHisto_internal(const HistogramRequest & request,
     const float* src_pixels[4];
     Image::getChannelPointers<float>((const float**)imageData.ptrs, roi.x1, roi.y1, imageData.bounds, imageData.nComps, (float**)src_pixels, &pixelStride);
 
+    // When the mode displays a single channel that exists in the image, bin each scan-line
+    // with the vectorized span helper. Synthesized values (missing channel, luminance) go
+    // through the generic loop below.
+    {
+        const float* channelPtr = 0;
+        switch (mode) {
+            case 1: // A
+                if (srcNComps == 1) {
+                    channelPtr = src_pixels[0];
+                } else if (srcNComps == 4) {
+                    channelPtr = src_pixels[3];
+                }
+                break;
+            case 3: // R
+                if (srcNComps > 1) {
+                    channelPtr = src_pixels[0];
+                }
+                break;
+            case 4: // G
+                if (srcNComps > 1) {
+                    channelPtr = src_pixels[1];
+                }
+                break;
+            case 5: // B
+                if (srcNComps > 2) {
+                    channelPtr = src_pixels[2];
+                }
+                break;
+            default:
+                break;
+        }
+        if (channelPtr) {
+            const std::size_t rowElements = (std::size_t)imageData.bounds.width() * pixelStride;
+            for (int y = roi.y1; y < roi.y2; ++y, channelPtr += rowElements) {
+                histogramBinSpan(channelPtr, pixelStride, roi.width(), (float)request.vmin, (float)request.vmax, (float)binSize, *histo);
+            }
+            return;
+        }
+    }
+
     for (int y = roi.y1; y < roi.y2; ++y) {
 
         for (int x = roi.x1; x < roi.x2; ++x) {
@@ -293,7 +430,7 @@ computeHisto_internal(const HistogramRequest & request,
                     if (srcNComps < 3) {
                         v = 0;
                     } else {
-                        v = *src_pixels[3];
+                        v = *src_pixels[2];
                     }
                     break;
                 default:
@@ -358,6 +495,75 @@ computeHistoForNComps(const HistogramRequest & request,
 }
 
 
+class ComputeHistogramProcessor : public ImageMultiThreadProcessorBase
+{
+    HistogramRequest _request;
+    int _mode;
+    Image::CPUData _imageData;
+    int _upscale;
+
+    mutable QMutex _resultMutex;
+    std::vector<float> _result;
+
+public:
+
+    ComputeHistogramProcessor(const EffectInstancePtr& renderArgs)
+    : ImageMultiThreadProcessorBase(renderArgs)
+    , _mode(0)
+    , _upscale(1)
+    {
+    }
+
+    virtual ~ComputeHistogramProcessor()
+    {
+    }
+
+    void setValues(const HistogramRequest & request, int mode, const Image::CPUData& imageData, int upscale)
+    {
+        _request = request;
+        _mode = mode;
+        _imageData = imageData;
+        _upscale = upscale;
+    }
+
+    const std::vector<float>& getResults() const
+    {
+        return _result;
+    }
+
+private:
+
+    virtual ActionRetCodeEnum multiThreadProcessImages(const RectI& renderWindow) OVERRIDE FINAL
+    {
+        std::vector<float> localHisto;
+        switch (_imageData.nComps) {
+            case 1:
+                computeHistoForNComps<1>(_request, _mode, _imageData, renderWindow, _upscale, &localHisto);
+                break;
+            case 2:
+                computeHistoForNComps<2>(_request, _mode, _imageData, renderWindow, _upscale, &localHisto);
+                break;
+            case 3:
+                computeHistoForNComps<3>(_request, _mode, _imageData, renderWindow, _upscale, &localHisto);
+                break;
+            case 4:
+                computeHistoForNComps<4>(_request, _mode, _imageData, renderWindow, _upscale, &localHisto);
+                break;
+        }
+
+        QMutexLocker k(&_resultMutex);
+        if ( _result.empty() ) {
+            _result.swap(localHisto);
+        } else {
+            assert( _result.size() == localHisto.size() );
+            for (std::size_t i = 0; i < _result.size(); ++i) {
+                _result[i] += localHisto[i];
+            }
+        }
+        return eActionStatusOK;
+    }
+};
+
 static void
 computeHistogramStatic(const HistogramRequest & request,
                        int mode,
@@ -390,19 +596,21 @@ computeHistogramStatic(const HistogramRequest & request,
     // a histogram with upscale more bins
     std::vector<float> histo_upscaled;
 
-    switch (imageData.nComps) {
-        case 1:
-            computeHistoForNComps<1>(request, mode, imageData, roi, upscale, &histo_upscaled);
-            break;
-        case 2:
-            computeHistoForNComps<2>(request, mode, imageData, roi, upscale, &histo_upscaled);
-            break;
-        case 3:
-            computeHistoForNComps<3>(request, mode, imageData, roi, upscale, &histo_upscaled);
-            break;
-        case 4:
-            computeHistoForNComps<4>(request, mode, imageData, roi, upscale, &histo_upscaled);
-            break;
+    {
+        // Partition the scan-lines of the roi across the thread pool: each thread bins
+        // into a thread-local histogram, merged once per thread in multiThreadProcessImages.
+        ComputeHistogramProcessor processor( EffectInstancePtr() );
+        processor.setValues(request, mode, imageData, upscale);
+        processor.setRenderWindow(roi);
+        ActionRetCodeEnum stat = processor.process();
+        if ( isFailureRetCode(stat) ) {
+            return;
+        }
+        histo_upscaled = processor.getResults();
+    }
+    if ( histo_upscaled.empty() ) {
+        // No scan-line was processed (empty roi)
+        histo_upscaled.resize( (std::size_t)request.binsCount * upscale, 0.f );
     }
 
 
@@ -537,22 +745,39 @@ HistogramCPU::run()
             roiPixels.intersect(imageData.bounds, &roiPixels);
         }
 
-        switch (request.mode) {
-        case 0:     //< RGB
-            computeHistogramStatic(request, 3, imageData, roiPixels, ret, 1);
-            computeHistogramStatic(request, 4, imageData, roiPixels, ret, 2);
-            computeHistogramStatic(request, 5, imageData, roiPixels, ret, 3);
-            break;
-        case 1:
-        case 2:
-        case 3:
-        case 4:
-        case 5:
-            computeHistogramStatic(request, request.mode, imageData, roiPixels, ret, 1);
-            break;
-        default:
-            assert(false);     //< unknown case.
-            break;
+        bool gpuBinning = request.gpuBinning;
+        if (gpuBinning) {
+            // The GPU binning path uploads the buffer directly with glTexImage2D and addresses
+            // pixels with 16-bit vertex coordinates: it needs a packed RGBA buffer of a
+            // reasonable size. Bin unsuitable images on the CPU instead.
+            if ( (imageData.nComps != 4) || imageData.ptrs[1] || (roiPixels.width() > 32767) || (roiPixels.height() > 32767) ) {
+                gpuBinning = false;
+            }
+        }
+        if (gpuBinning) {
+            // The caller bins on the GPU: just hand back the image along with the request parameters
+            ret->imageForGPUBinning = image;
+            ret->roiForGPUBinning = roiPixels;
+            ret->smoothingKernelSize = request.smoothingKernelSize;
+            ret->pixelsCount = roiPixels.area();
+        } else {
+            switch (request.mode) {
+            case 0:     //< RGB
+                computeHistogramStatic(request, 3, imageData, roiPixels, ret, 1);
+                computeHistogramStatic(request, 4, imageData, roiPixels, ret, 2);
+                computeHistogramStatic(request, 5, imageData, roiPixels, ret, 3);
+                break;
+            case 1:
+            case 2:
+            case 3:
+            case 4:
+            case 5:
+                computeHistogramStatic(request, request.mode, imageData, roiPixels, ret, 1);
+                break;
+            default:
+                assert(false);     //< unknown case.
+                break;
+            }
         }
 
 
@@ -62,7 +62,8 @@ public:
                           int binsCount,
                           double vmin,
                           double vmax,
-                          int smoothingKernelSize);
+                          int smoothingKernelSize,
+                          bool gpuBinning);
 
     ////Returns true if a new histogram fully computed is available
     bool hasProducedHistogram() const;
@@ -74,13 +75,20 @@ public:
     ///to the histogramProduced signal.
     ///
     ///This function returns in histogram1 the first histogram of the produced histogram
+    ///
+    ///If the histogram was requested with gpuBinning, the histograms are left empty and the
+    ///image to bin is returned in imageForGPUBinning instead, along with the region to bin and
+    ///the smoothing kernel size of the request: the caller is expected to perform the binning
+    ///itself on the GPU.
     bool getMostRecentlyProducedHistogram(std::vector<float>* histogram1,
                                           std::vector<float>* histogram2,
                                           std::vector<float>* histogram3,
                                           unsigned int* binsCount,
                                           unsigned int* pixelsCount,
                                           int* mode,
-                                          double* vmin, double* vmax, unsigned int* mipMapLevel);
+                                          double* vmin, double* vmax, unsigned int* mipMapLevel,
+                                          ImagePtr* imageForGPUBinning, RectI* roiForGPUBinning,
+                                          int* smoothingKernelSize);
 
     void quitAnyComputation();
 
@@ -194,6 +194,7 @@ Image::CopyPixelsArgs::CopyPixelsArgs()
 , srcColorspace(eViewerColorSpaceLinear)
 , dstColorspace(eViewerColorSpaceLinear)
 , unPremultIfNeeded(false)
+, premultIfNeeded(false)
 , forceCopyEvenIfBuffersHaveSameLayout(false)
 {
 
@@ -616,6 +617,8 @@ Image::getChannelPointers(const void* ptrs[4],
             getChannelPointers<unsigned char>((const unsigned char**)ptrs, x, y, bounds, nComps, (unsigned char**)outPtrs, pixelStride);
             break;
         case eImageBitDepthShort:
+        case eImageBitDepthHalf:
+            // Halfs are laid out like any other 16-bit channel
             getChannelPointers<unsigned short>((const unsigned short**)ptrs, x, y, bounds, nComps, (unsigned short**)outPtrs, pixelStride);
             break;
         case eImageBitDepthFloat:
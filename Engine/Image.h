@@ -349,6 +349,14 @@ public:
         // Default - false
         bool unPremultIfNeeded;
 
+        // When converting to an image with an alpha channel, if set to true
+        // the RGB channels will be multiplied by the alpha channel in the same pass,
+        // after the conversion to linear. This avoids a separate premultiplication
+        // pass over the image after the conversion.
+        //
+        // Default - false
+        bool premultIfNeeded;
+
         // If this image and the other image have the same number of components,
         // same buffer layout, same bitdepth and same bounds
         // by default the memory buffer pointers will be copied instead of all pixels.
@@ -509,6 +517,68 @@ public:
                                    void* outPtrs[4],
                                    int* pixelStride);
 
+    /**
+     * @brief Iterates the scanlines of an image buffer over a region starting at (x1, y1).
+     * The buffer layout, strides and bounds are resolved once by the constructor with
+     * getChannelPointers: moving to the next scanline or to a column within the current one
+     * is then plain pointer arithmetic, so inner loops do not pay a per-row (or worse,
+     * per-pixel) address computation.
+     * As with getChannelPointers, pointers to read-only buffers are cast by the caller.
+     **/
+    template <typename PIX>
+    class ScanlineIterator
+    {
+        PIX* _rowPtrs[4];
+        int _pixelStride;
+        int _rowElements;
+
+    public:
+
+        ScanlineIterator(const PIX* ptrs[4],
+                         int x1, int y1,
+                         const RectI& bounds,
+                         int nComps)
+        {
+            getChannelPointers<PIX>(ptrs, x1, y1, bounds, nComps, _rowPtrs, &_pixelStride);
+            _rowElements = bounds.width() * _pixelStride;
+        }
+
+        int getPixelStride() const
+        {
+            return _pixelStride;
+        }
+
+        /**
+         * @brief The channel pointers at the start (column x1) of the current scanline.
+         **/
+        PIX* const* rowPixels() const
+        {
+            return _rowPtrs;
+        }
+
+        /**
+         * @brief Set in outPtrs the channel pointers at column x1 + deltaX of the current scanline.
+         **/
+        void pixelsAt(int deltaX,
+                      PIX* outPtrs[4]) const
+        {
+            for (int c = 0; c < 4; ++c) {
+                outPtrs[c] = _rowPtrs[c] ? _rowPtrs[c] + deltaX * _pixelStride : 0;
+            }
+        }
+
+        /**
+         * @brief Advance the iterator to the next scanline.
+         **/
+        void nextRow()
+        {
+            for (int c = 0; c < 4; ++c) {
+                if (_rowPtrs[c]) {
+                    _rowPtrs[c] += _rowElements;
+                }
+            }
+        }
+    };
 
     struct CPUData
     {
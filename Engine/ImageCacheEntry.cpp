@@ -30,6 +30,8 @@
 
 #include <QThread>
 #include <QDebug>
+#include <QMutex>
+#include <QWaitCondition>
 
 #include <boost/thread/shared_mutex.hpp> // local r-w mutex
 #include <boost/thread/mutex.hpp> // local  mutex
@@ -38,6 +40,8 @@
 #include "Engine/AppManager.h"
 #include "Engine/Cache.h"
 #include "Engine/CacheEntryBase.h"
+#include "Engine/CacheTileCompression.h"
+#include "Engine/HalfFloat.h"
 #include "Engine/Hash64.h"
 #include "Engine/ImageCacheKey.h"
 #include "Engine/ImageStorage.h"
@@ -45,6 +49,7 @@
 #include "Engine/ImageCacheEntryProcessing.h"
 #include "Engine/ImageTilesState.h"
 #include "Engine/MultiThread.h"
+#include "Engine/SharedCacheTier.h"
 #include "Engine/ThreadPool.h"
 #include "Engine/Timer.h"
 
@@ -60,6 +65,14 @@
 
 NATRON_NAMESPACE_ENTER;
 
+// Threads in waitForPendingTiles() are woken up through this condition whenever any render marks
+// tiles as rendered or aborted, so that concurrent renders waiting on each other's tiles (e.g two
+// viewers displaying the same node) resume as soon as the results are published instead of
+// sleeping through the whole polling interval. The polling is kept as a fallback: updates made by
+// another process on a persistent cache never signal this condition.
+static QMutex pendingTilesUpdatedMutex;
+static QWaitCondition pendingTilesUpdatedCond;
+
 struct TileCoord
 {
     int tx,ty;
@@ -470,6 +483,14 @@ struct ImageCacheEntryPrivate
      **/
     void updateCachedTilesStateMap(const std::vector<TilesSet>& tilesToUpdate, bool updateAllTilesRegardless);
 
+    /**
+     * @brief Attempts to fetch the tiles marked eTileStatusNotRendered at mipMapLevel from the shared
+     * farm tier, see SharedCacheTier. The payloads of the tiles whose every channel was found and
+     * verified are copied to the local image and their bounds returned in fetchedTiles: they still
+     * have to be published to the local cache with markCacheTilesAsRenderedInternal().
+     **/
+    void fetchTilesFromSharedTier(std::vector<RectI>* fetchedTiles);
+
     enum LookupTileStateRetCodeEnum
     {
         eLookupTileStateRetCodeUpToDate,
@@ -672,6 +693,13 @@ class CachePixelsTransferProcessorBase : public MultiThreadProcessorBase
 {
 protected:
     std::vector<boost::shared_ptr<TileData> > _tasks;
+
+    // For each task, the tile bounds expanded to a full tile and the portion of the tile
+    // to actually copy, clipped against the RoI. They are batch-computed once in setValues()
+    // instead of being re-derived for every task in each worker thread.
+    std::vector<RectI> _tileBoundsRounded;
+    std::vector<RectI> _taskRenderWindows;
+
     ImageCacheEntryPrivate* _imp;
     void* _localBuffers[4];
     int _pixelStride;
@@ -680,6 +708,8 @@ public:
     CachePixelsTransferProcessorBase(const EffectInstancePtr& renderClone)
     : MultiThreadProcessorBase(renderClone)
     , _tasks()
+    , _tileBoundsRounded()
+    , _taskRenderWindows()
     , _imp(0)
     , _localBuffers()
     , _pixelStride(0)
@@ -692,11 +722,24 @@ public:
     }
 
     void setValues(ImageCacheEntryPrivate* imp,
+                   bool copyToCache,
                    const std::vector<boost::shared_ptr<TileData> >& tasks)
     {
         _imp = imp;
         _tasks = tasks;
 
+        // When copying to the cache, always copy full tiles, but ensure we do not copy outside
+        // of the bounds of the RoI for tiles on the border.
+        // When copying from the cache, clip to the tile bounds for the tiles on the border.
+        _tileBoundsRounded.resize( tasks.size() );
+        _taskRenderWindows.resize( tasks.size() );
+        for (std::size_t i = 0; i < tasks.size(); ++i) {
+            _tileBoundsRounded[i] = tasks[i]->bounds;
+            _tileBoundsRounded[i].roundToTileSize(imp->localTilesState.tileSizeX, imp->localTilesState.tileSizeY);
+            _taskRenderWindows[i] = copyToCache ? _tileBoundsRounded[i] : tasks[i]->bounds;
+        }
+        RectI::intersectMany(imp->roi, &_taskRenderWindows);
+
         // Extract channel pointers
         Image::CPUData data;
         ImagePrivate::getCPUDataInternal(_imp->roi, _imp->nComps, _imp->imageBuffers, _imp->bitdepth, _imp->format, &data);
@@ -726,37 +769,59 @@ public:
                                                   unsigned int nThreads) OVERRIDE FINAL WARN_UNUSED_RETURN
     {
 
-        
+
         int fromIndex, toIndex;
         ImageMultiThreadProcessorBase::getThreadRange(threadID, nThreads, 0, _tasks.size(), &fromIndex, &toIndex);
+
+#ifdef NATRON_CACHE_TILES_COMPRESSION
+        // Tiles are stored compressed in the cache: stage the pixel payload in a
+        // process local buffer on either side of the transfer.
+        std::vector<char> tileStagingBuf(NATRON_TILE_SIZE_BYTES);
+#endif
+
         for (int i = fromIndex; i < toIndex; ++i) {
 
             const TileData& task = *_tasks[i];
-            
+
             assert(task.tileCache_i != (U64)-1);
-            
-            // Intersect the tile bounds
-            RectI tileBoundsRounded = task.bounds;
-            tileBoundsRounded.roundToTileSize(_imp->localTilesState.tileSizeX, _imp->localTilesState.tileSizeY);
+
+            // The tile bounds and the window to copy were batch-computed in setValues()
+            const RectI& tileBoundsRounded = _tileBoundsRounded[i];
+            const RectI& renderWindow = _taskRenderWindows[i];
+            assert( !renderWindow.isNull() );
 
             if (copyToCache) {
 
-                // When copying to the cache, always copy full tiles, but ensure we do not copy outside of the bounds of the RoI for tiles on the border
-                RectI renderWindow;
-                tileBoundsRounded.intersect(_imp->roi, &renderWindow);
+#ifdef NATRON_CACHE_TILES_COMPRESSION
+                // Zero-out the staging tile so the portions outside the RoI compress to nothing
+                memset(&tileStagingBuf[0], 0, tileStagingBuf.size());
+                PIX* tileBuf = (PIX*)&tileStagingBuf[0];
+#else
+                PIX* tileBuf = (PIX*)task.ptr;
+#endif
 
                 const PIX* localPix = (const PIX*)Image::pixelAtStatic(renderWindow.x1, renderWindow.y1, _imp->roi, _imp->nComps, sizeof(PIX), (const unsigned char*)_localBuffers[task.channel_i]);
                 assert(localPix);
 
-                PIX* tilePix = ImageCacheEntryProcessing::getPix((PIX*)task.ptr, renderWindow.x1, renderWindow.y1, tileBoundsRounded);
+                PIX* tilePix = ImageCacheEntryProcessing::getPix(tileBuf, renderWindow.x1, renderWindow.y1, tileBoundsRounded);
                 assert(tilePix);
+#ifdef NATRON_CACHE_TILES_COMPRESSION
+                // The staging tile is immediately re-read by compressTileToSlot: keep it cached
                 ImageCacheEntryProcessing::copyPixelsForDepth<PIX>(renderWindow, localPix, _pixelStride, _imp->roi.width() * _pixelStride, tilePix, 1, _imp->localTilesState.tileSizeX);
-                
+#else
+                // The cache tile is not read back by this thread: bypass the caches with streaming stores
+                ImageCacheEntryProcessing::copyPixelsStreamingForDepth<PIX>(renderWindow, localPix, _pixelStride, _imp->roi.width() * _pixelStride, tilePix, 1, _imp->localTilesState.tileSizeX);
+#endif
+
                 // When inserting a tile in the cache, if this is a tile in the border, repeat edges
                 if (task.bounds.width() != _imp->localTilesState.tileSizeX ||
                     task.bounds.height() != _imp->localTilesState.tileSizeY) {
-                    ImageCacheEntryProcessing::repeatEdgesForDepth<PIX>((PIX*)task.ptr, task.bounds, _imp->localTilesState.tileSizeX, _imp->localTilesState.tileSizeY);
+                    ImageCacheEntryProcessing::repeatEdgesForDepth<PIX>(tileBuf, task.bounds, _imp->localTilesState.tileSizeX, _imp->localTilesState.tileSizeY);
                 }
+
+#ifdef NATRON_CACHE_TILES_COMPRESSION
+                CacheTileCompression::compressTileToSlot(tileBuf, task.ptr);
+#endif
             } else {
 
 
@@ -764,11 +829,15 @@ public:
                 if (_effect && _effect->isRenderAborted()) {
                     return eActionStatusAborted;
                 }
-                // When copying from the cache, clip to the tile bounds for the tiles on the border
-                RectI renderWindow;
-                task.bounds.intersect(_imp->roi, &renderWindow);
-         
-                const PIX* tilePix = ImageCacheEntryProcessing::getPix((const PIX*)task.ptr, renderWindow.x1, renderWindow.y1, tileBoundsRounded);
+
+#ifdef NATRON_CACHE_TILES_COMPRESSION
+                CacheTileCompression::decompressTileFromSlot(task.ptr, &tileStagingBuf[0]);
+                const PIX* tileBuf = (const PIX*)&tileStagingBuf[0];
+#else
+                const PIX* tileBuf = (const PIX*)task.ptr;
+#endif
+
+                const PIX* tilePix = ImageCacheEntryProcessing::getPix(tileBuf, renderWindow.x1, renderWindow.y1, tileBoundsRounded);
                 assert(tilePix);
 
                 PIX* localPix = (PIX*)Image::pixelAtStatic(renderWindow.x1, renderWindow.y1, _imp->roi, _imp->nComps, sizeof(PIX), (const unsigned char*)_localBuffers[task.channel_i]);
@@ -838,6 +907,13 @@ public:
 
         int fromIndex, toIndex;
         ImageMultiThreadProcessorBase::getThreadRange(threadID, nThreads, 0, _tasks.size(), &fromIndex, &toIndex);
+
+#ifdef NATRON_CACHE_TILES_COMPRESSION
+        // Tiles are stored compressed in the cache: stage the 4 source tiles and the
+        // destination tile in process local buffers.
+        std::vector<char> tilesStagingBuf(NATRON_TILE_SIZE_BYTES * 5);
+#endif
+
         for (int i = fromIndex; i < toIndex; ++i) {
 
             // When reading from the cache, if aborted don't continue
@@ -855,7 +931,24 @@ public:
                 task.srcTiles[2] ? task.srcTiles[2]->ptr : 0,
                 task.srcTiles[3] ? task.srcTiles[3]->ptr : 0};
 
-            ImageCacheEntryProcessing::downscaleMipMapForDepth<PIX>((const PIX**)srcPtrs, (PIX*)task.ptr, task.bounds, _tileSizeX, _tileSizeY);
+#ifdef NATRON_CACHE_TILES_COMPRESSION
+            for (int c = 0; c < 4; ++c) {
+                if (srcPtrs[c]) {
+                    char* stagedSrc = &tilesStagingBuf[c * NATRON_TILE_SIZE_BYTES];
+                    CacheTileCompression::decompressTileFromSlot(srcPtrs[c], stagedSrc);
+                    srcPtrs[c] = stagedSrc;
+                }
+            }
+            PIX* dstBuf = (PIX*)&tilesStagingBuf[4 * NATRON_TILE_SIZE_BYTES];
+#else
+            PIX* dstBuf = (PIX*)task.ptr;
+#endif
+
+            ImageCacheEntryProcessing::downscaleMipMapForDepth<PIX>((const PIX**)srcPtrs, dstBuf, task.bounds, _tileSizeX, _tileSizeY);
+
+#ifdef NATRON_CACHE_TILES_COMPRESSION
+            CacheTileCompression::compressTileToSlot(dstBuf, task.ptr);
+#endif
         }
         return eActionStatusOK;
     } // multiThreadFunction
@@ -1551,6 +1644,9 @@ ImageCacheEntryPrivate::fetchAndCopyCachedTiles()
             case eImageBitDepthFloat:
                 processor.reset(new DownscaleMipMapProcessor<float>(renderClone));
                 break;
+            case eImageBitDepthHalf:
+                processor.reset(new DownscaleMipMapProcessor<HalfFloat>(renderClone));
+                break;
             default:
                 break;
         }
@@ -1638,10 +1734,13 @@ ImageCacheEntryPrivate::fetchAndCopyCachedTiles()
         case eImageBitDepthFloat:
             processor.reset(new CachePixelsTransferProcessor<false /*copyToCache*/, float>(renderClone));
             break;
+        case eImageBitDepthHalf:
+            processor.reset(new CachePixelsTransferProcessor<false /*copyToCache*/, HalfFloat>(renderClone));
+            break;
         default:
             break;
     }
-    processor->setValues(this, tilesToCopy);
+    processor->setValues(this, false /*copyToCache*/, tilesToCopy);
     ActionRetCodeEnum stat = processor->launchThreadsBlocking();
 
 
@@ -1658,6 +1757,96 @@ ImageCacheEntryPrivate::fetchAndCopyCachedTiles()
 
 } // fetchAndCopyCachedTiles
 
+void
+ImageCacheEntryPrivate::fetchTilesFromSharedTier(std::vector<RectI>* fetchedTiles)
+{
+    // Protect all local structures against multiple threads using this object.
+    boost::unique_lock<boost::mutex> locker(lock);
+
+    if ( mipMapLevel >= markedTiles.size() || markedTiles[mipMapLevel].empty() ) {
+        return;
+    }
+
+    const U64 entryHash = internalCacheEntry->getHashKey();
+
+    // Gather the tier key of each channel of each un-rendered tile. The keys match those
+    // used by the bake side in markCacheTilesAsRenderedInternal().
+    std::vector<U64> tileKeys;
+    std::vector<RectI> candidateBounds;
+    tileKeys.reserve(markedTiles[mipMapLevel].size() * nComps);
+    for (TilesSet::const_iterator it = markedTiles[mipMapLevel].begin(); it != markedTiles[mipMapLevel].end(); ++it) {
+        const TileState* tile = localTilesState.getTileAt(it->tx, it->ty);
+        candidateBounds.push_back(tile->bounds);
+        for (int c = 0; c < nComps; ++c) {
+            tileKeys.push_back( makeTileCacheIndex(tile->bounds.x1, tile->bounds.y1, mipMapLevel, c) );
+        }
+    }
+
+    // The tier stores whole tile storage slots, so that a slot baked from a compressed
+    // cache restores byte-identical in ours.
+    std::vector<char> payloads(tileKeys.size() * NATRON_TILE_STORAGE_BYTES);
+    std::vector<void*> buffers( tileKeys.size() );
+    for (std::size_t i = 0; i < buffers.size(); ++i) {
+        buffers[i] = &payloads[i * NATRON_TILE_STORAGE_BYTES];
+    }
+
+    std::vector<bool> fetched;
+    SharedCacheTier::fetchTiles(entryHash, tileKeys, NATRON_TILE_STORAGE_BYTES, buffers, &fetched);
+
+    // Only keep the tiles whose every channel was found and checksum-verified
+    std::vector<boost::shared_ptr<TileData> > tilesToCopy;
+    for (std::size_t i = 0; i < candidateBounds.size(); ++i) {
+        bool allChannelsFetched = true;
+        for (int c = 0; c < nComps; ++c) {
+            allChannelsFetched = allChannelsFetched && fetched[i * nComps + c];
+        }
+        if (!allChannelsFetched) {
+            continue;
+        }
+        for (int c = 0; c < nComps; ++c) {
+            boost::shared_ptr<TileData> data(new TileData);
+            data->ptr = buffers[i * nComps + c];
+            data->tileCache_i = tileKeys[i * nComps + c];
+            data->bounds = candidateBounds[i];
+            data->channel_i = c;
+            tilesToCopy.push_back(data);
+        }
+        fetchedTiles->push_back(candidateBounds[i]);
+    }
+
+    if ( tilesToCopy.empty() ) {
+        return;
+    }
+
+    // We are going to copy the payloads to our local buffers, ensure they are allocated
+    image.lock()->ensureBuffersAllocated();
+
+    EffectInstancePtr renderClone = effect.lock();
+
+    boost::scoped_ptr<CachePixelsTransferProcessorBase> processor;
+    switch (bitdepth) {
+        case eImageBitDepthByte:
+            processor.reset(new CachePixelsTransferProcessor<false /*copyToCache*/, unsigned char>(renderClone));
+            break;
+        case eImageBitDepthShort:
+            processor.reset(new CachePixelsTransferProcessor<false /*copyToCache*/, unsigned short>(renderClone));
+            break;
+        case eImageBitDepthFloat:
+            processor.reset(new CachePixelsTransferProcessor<false /*copyToCache*/, float>(renderClone));
+            break;
+        case eImageBitDepthHalf:
+            processor.reset(new CachePixelsTransferProcessor<false /*copyToCache*/, HalfFloat>(renderClone));
+            break;
+        default:
+            break;
+    }
+    processor->setValues(this, false /*copyToCache*/, tilesToCopy);
+    ActionRetCodeEnum stat = processor->launchThreadsBlocking();
+    if ( isFailureRetCode(stat) ) {
+        fetchedTiles->clear();
+    }
+} // fetchTilesFromSharedTier
+
 ActionRetCodeEnum
 ImageCacheEntry::fetchCachedTilesAndUpdateStatus(TileStateHeader* tileStatus, bool* hasUnRenderedTile, bool *hasPendingResults)
 {
@@ -1665,6 +1854,7 @@ ImageCacheEntry::fetchCachedTilesAndUpdateStatus(TileStateHeader* tileStatus, bo
     _imp->writeDebugStatus("fetchCachedTilesAndUpdateStatus", true);
 #endif
 
+    ScopedProfilerSample profilerSample(eProfilerCategoryCache, "ImageCacheEntry::fetchCachedTilesAndUpdateStatus");
 
     // Protect all local structures against multiple threads using this object.
     {
@@ -1835,7 +2025,18 @@ ImageCacheEntry::fetchCachedTilesAndUpdateStatus(TileStateHeader* tileStatus, bo
         } // _imp->cachePolicy = eCacheAccessModeNone
 
     } // locker
-    
+
+    // If a shared farm tier is configured, attempt to fetch the tiles that are still un-rendered
+    // from it. Publishing them as rendered promotes their payload to the local cache and wakes up
+    // concurrent renders waiting on them, so each tile crosses the network only once per host.
+    if ( _imp->cachePolicy != eCacheAccessModeNone && SharedCacheTier::isReadEnabled() ) {
+        std::vector<RectI> tilesFromTier;
+        _imp->fetchTilesFromSharedTier(&tilesFromTier);
+        for (std::size_t i = 0; i < tilesFromTier.size(); ++i) {
+            markCacheTilesAsRenderedInternal(&tilesFromTier[i], true /*fromSharedTier*/);
+        }
+    }
+
     getStatus(tileStatus, hasUnRenderedTile, hasPendingResults);
     return eActionStatusOK;
 } // fetchCachedTilesAndUpdateStatus
@@ -1926,6 +2127,10 @@ ImageCacheEntry::markCacheTilesAsAborted()
 
     _imp->markedTiles.clear();
 
+    if (didSomething) {
+        // The tiles are available again for rendering: wake up concurrent renders waiting on them
+        pendingTilesUpdatedCond.wakeAll();
+    }
 
 } // markCacheTilesAsAborted
 
@@ -2104,14 +2309,33 @@ ImageCacheEntry::markCacheTilesInRegionAsNotRendered(const RectI& roi)
         }
     }
 
+    if (hasModifiedTileMap) {
+        // The tiles are available again for rendering: wake up concurrent renders waiting on them
+        pendingTilesUpdatedCond.wakeAll();
+    }
+
 } // markCacheTilesInRegionAsNotRendered
 
 void
 ImageCacheEntry::markCacheTilesAsRendered()
+{
+    markCacheTilesAsRenderedInternal(NULL, false /*fromSharedTier*/);
+}
+
+void
+ImageCacheEntry::markCacheTilesInRegionAsRendered(const RectI& roi)
+{
+    markCacheTilesAsRenderedInternal(&roi, false /*fromSharedTier*/);
+}
+
+void
+ImageCacheEntry::markCacheTilesAsRenderedInternal(const RectI* subRegion, bool fromSharedTier)
 {
     // Make sure to call fetchCachedTilesAndUpdateStatus() first
     assert(_imp->internalCacheEntry);
 
+    ScopedProfilerSample profilerSample(eProfilerCategoryCache, "ImageCacheEntry::markCacheTilesAsRendered");
+
     // Protect all local structures against multiple threads using this object.
     boost::unique_lock<boost::mutex> locker(_imp->lock);
     
@@ -2144,12 +2368,23 @@ ImageCacheEntry::markCacheTilesAsRendered()
 
     std::vector<boost::shared_ptr<TileData> > tilesToCopy;
 
+    // When publishing a sub-region only, the tiles actually published below
+    TilesSet processedTiles;
+
     {
 
         TileStateHeader cacheStateMap = TileStateHeader(_imp->localTilesState.tileSizeX, _imp->localTilesState.tileSizeY, &_imp->internalCacheEntry->perMipMapTilesState[_imp->mipMapLevel]);
 
         for (TilesSet::iterator it = _imp->markedTiles[_imp->mipMapLevel].begin(); it != _imp->markedTiles[_imp->mipMapLevel].end(); ++it) {
 
+            // Only publish the tiles of the sub-region, the others are still being rendered
+            if ( subRegion && !subRegion->contains( _imp->localTilesState.getTileAt(it->tx, it->ty)->bounds ) ) {
+                continue;
+            }
+            if (subRegion) {
+                processedTiles.insert(*it);
+            }
+
             TileState* cacheTileState = cacheStateMap.getTileAt(it->tx, it->ty);
 
             // We marked the cache tile status to eTileStatusPending previously in
@@ -2187,19 +2422,30 @@ ImageCacheEntry::markCacheTilesAsRendered()
         }
     }
 
-    std::vector<TilesSet> tilesToUpdate = _imp->markedTiles;
-    _imp->markedTiles.clear();
+    std::vector<TilesSet> tilesToUpdate;
+    if (!subRegion) {
+        tilesToUpdate = _imp->markedTiles;
+        _imp->markedTiles.clear();
+    } else {
+        tilesToUpdate.resize(_imp->markedTiles.size());
+        tilesToUpdate[_imp->mipMapLevel] = processedTiles;
+        for (TilesSet::const_iterator it = processedTiles.begin(); it != processedTiles.end(); ++it) {
+            _imp->markedTiles[_imp->mipMapLevel].erase(*it);
+        }
+    }
 
 #ifdef DEBUG
-    // Check that all tiles are marked either rendered or pending
-    RectI roiRounded = _imp->roi;
-    roiRounded.roundToTileSize(_imp->localTilesState.tileSizeX, _imp->localTilesState.tileSizeY);
-    for (int ty = roiRounded.y1; ty < roiRounded.y2; ty += _imp->localTilesState.tileSizeY) {
-        for (int tx = roiRounded.x1; tx < roiRounded.x2; tx += _imp->localTilesState.tileSizeX) {
-
-            assert(tx % _imp->localTilesState.tileSizeX == 0 && ty % _imp->localTilesState.tileSizeY == 0);
-            TileState* localTileState = _imp->localTilesState.getTileAt(tx, ty);
-            assert(localTileState->status == eTileStatusPending || localTileState->status == eTileStatusRenderedHighestQuality || localTileState->status == eTileStatusRenderedLowQuality);
+    if (!subRegion) {
+        // Check that all tiles are marked either rendered or pending
+        RectI roiRounded = _imp->roi;
+        roiRounded.roundToTileSize(_imp->localTilesState.tileSizeX, _imp->localTilesState.tileSizeY);
+        for (int ty = roiRounded.y1; ty < roiRounded.y2; ty += _imp->localTilesState.tileSizeY) {
+            for (int tx = roiRounded.x1; tx < roiRounded.x2; tx += _imp->localTilesState.tileSizeX) {
+
+                assert(tx % _imp->localTilesState.tileSizeX == 0 && ty % _imp->localTilesState.tileSizeY == 0);
+                TileState* localTileState = _imp->localTilesState.getTileAt(tx, ty);
+                assert(localTileState->status == eTileStatusPending || localTileState->status == eTileStatusRenderedHighestQuality || localTileState->status == eTileStatusRenderedLowQuality);
+            }
         }
     }
 #endif
@@ -2270,26 +2516,54 @@ ImageCacheEntry::markCacheTilesAsRendered()
         case eImageBitDepthFloat:
             processor.reset(new CachePixelsTransferProcessor<true /*copyToCache*/, float>(renderClone));
             break;
+        case eImageBitDepthHalf:
+            processor.reset(new CachePixelsTransferProcessor<true /*copyToCache*/, HalfFloat>(renderClone));
+            break;
         default:
             break;
     }
 
-    processor->setValues(_imp.get(), tilesToCopy);
+    processor->setValues(_imp.get(), true /*copyToCache*/, tilesToCopy);
     ActionRetCodeEnum stat = processor->launchThreadsBlocking();
 
     // We never abort when copying tiles to the cache since they are anyway already rendered.
     assert(stat != eActionStatusAborted);
     (void)stat;
 
+    // Designated farm bake jobs also append the freshly cached tile slots to the shared tier,
+    // except of course the tiles that were just fetched from the tier itself.
+    if ( !fromSharedTier && !tilesToCopy.empty() && SharedCacheTier::isBakeEnabled() ) {
+        std::vector<std::pair<U64, const void*> > tierTiles( tilesToCopy.size() );
+        for (std::size_t i = 0; i < tilesToCopy.size(); ++i) {
+            U64 tierKey = makeTileCacheIndex(tilesToCopy[i]->bounds.x1, tilesToCopy[i]->bounds.y1, _imp->mipMapLevel, tilesToCopy[i]->channel_i);
+            tierTiles[i] = std::make_pair( tierKey, (const void*)tilesToCopy[i]->ptr );
+        }
+        SharedCacheTier::bakeTiles(_imp->internalCacheEntry->getHashKey(), tierTiles, NATRON_TILE_STORAGE_BYTES);
+    }
+
     // We must delete the CacheDataLock_RAII now because updateCachedTilesStateMap may attempt to get a write lock on an already taken read lock
 
     cacheDataDeleter.reset();
 
+    // The tiles we just copied are dirty pages of the memory mapped tile files: schedule their
+    // write-behind flush so the writeback happens off the render threads instead of synchronously
+    // competing with cache reads during heavy cache-write phases.
+    if ( _imp->internalCacheEntry->isPersistent() ) {
+        std::vector<U64> flushIndices( allocatedTiles.size() );
+        for (std::size_t i = 0; i < allocatedTiles.size(); ++i) {
+            flushIndices[i] = allocatedTiles[i].first;
+        }
+        cache->flushTilesWriteBehind(flushIndices);
+    }
+
     // In persistent mode we have to actually copy the cache entry tiles state map to the cache
     if (_imp->internalCacheEntry->isPersistent()) {
         _imp->updateCachedTilesStateMap(tilesToUpdate, false);
     }
-} // markCacheTilesAsRendered
+
+    // The tiles are now published: wake up concurrent renders waiting on them
+    pendingTilesUpdatedCond.wakeAll();
+} // markCacheTilesAsRenderedInternal
 
 bool
 ImageCacheEntry::waitForPendingTiles()
@@ -2340,7 +2614,13 @@ ImageCacheEntry::waitForPendingTiles()
         if (hasPendingResults) {
 
             timeSpentWaitingForPendingEntryMS += timeToWaitMS;
-            CacheEntryLockerBase::sleep_milliseconds(timeToWaitMS);
+            {
+                // Wait until a concurrent render publishes tiles, or for the timeout to expire:
+                // updates made by another process on a persistent cache only ever get picked up
+                // by the polling.
+                QMutexLocker k(&pendingTilesUpdatedMutex);
+                pendingTilesUpdatedCond.wait(&pendingTilesUpdatedMutex, timeToWaitMS);
+            }
 
             // Increase the time to wait at the next iteration
             timeToWaitMS *= 1.2;
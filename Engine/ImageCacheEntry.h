@@ -129,6 +129,14 @@ public:
      **/
     void markCacheTilesAsRendered();
 
+    /**
+     * @brief Same as markCacheTilesAsRendered() except that only the tiles contained in the given RoI are
+     * published; the other tiles remain pending. This can be called repeatedly while the effect is still
+     * rendering the rest of the region so that concurrent renders waiting on these tiles can consume them
+     * without waiting for the whole region to be done.
+     **/
+    void markCacheTilesInRegionAsRendered(const RectI& roi);
+
     /**
      * @brief This function should be called if the render was aborted to mark tiles that were marked pending
      * in an unrendered state.
@@ -154,6 +162,8 @@ public:
 
 private:
 
+    void markCacheTilesAsRenderedInternal(const RectI* subRegion, bool fromSharedTier);
+
     boost::scoped_ptr<ImageCacheEntryPrivate> _imp;
 };
 NATRON_NAMESPACE_EXIT;
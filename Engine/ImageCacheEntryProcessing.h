@@ -27,6 +27,13 @@
 #include <Python.h>
 // ***** END PYTHON BLOCK *****
 
+// SSE2 is the baseline for all x86-64 targets, this only excludes ancient 32-bit builds from the
+// streaming store copy below.
+#if defined(__SSE2__) || defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 2 )
+#define NATRON_CACHE_PROCESSING_USE_SSE2
+#include <emmintrin.h>
+#endif
+
 #include "Engine/EngineFwd.h"
 #include "Engine/RectI.h"
 #include "Global/GlobalDefines.h"
@@ -74,6 +81,59 @@ static void copyPixelsForDepth(const RectI& renderWindow,
     }
 } // copyPixelsForDepth
 
+/**
+ * @brief Variant of copyPixelsForDepth for destination buffers that the copying thread does not
+ * read back, such as cache tiles being packed for insertion: rows are written with non-temporal
+ * (streaming) stores so copying a full frame worth of tiles does not evict the working set of
+ * concurrently rendering nodes from L2/L3.
+ * Cache tiles have power of two row strides and are allocated on at least 64 byte boundaries, so
+ * full tiles always take the streaming path; if the destination pointer or stride is not 16 byte
+ * aligned (tiles on the border of the RoI) this falls back on the regular copy.
+ **/
+template <typename PIX>
+static void copyPixelsStreamingForDepth(const RectI& renderWindow,
+                                        const PIX* srcPixelsData,
+                                        int srcXStride,
+                                        int srcYStride,
+                                        PIX* dstPixelsData,
+                                        int dstXStride,
+                                        int dstYStride)
+{
+#ifdef NATRON_CACHE_PROCESSING_USE_SSE2
+    const std::size_t rowBytes = renderWindow.width() * sizeof(PIX);
+    if ( (srcXStride == 1) && (dstXStride == 1) &&
+         ( ( (std::size_t)dstPixelsData & 15 ) == 0 ) &&
+         ( ( (std::size_t)dstYStride * sizeof(PIX) ) % 16 == 0 ) &&
+         (rowBytes >= 16) ) {
+        const PIX* src_pixels = srcPixelsData;
+        PIX* dst_pixels = dstPixelsData;
+        for (int y = renderWindow.y1; y < renderWindow.y2; ++y,
+             src_pixels += srcYStride,
+             dst_pixels += dstYStride) {
+
+            const char* src = (const char*)src_pixels;
+            char* dst = (char*)dst_pixels;
+            std::size_t nBytes = rowBytes;
+            while (nBytes >= 16) {
+                _mm_stream_si128( (__m128i*)dst, _mm_loadu_si128( (const __m128i*)src ) );
+                src += 16;
+                dst += 16;
+                nBytes -= 16;
+            }
+            if (nBytes > 0) {
+                memcpy(dst, src, nBytes);
+            }
+        }
+
+        // Order the streaming stores before the tile is published to other threads
+        _mm_sfence();
+
+        return;
+    }
+#endif
+    copyPixelsForDepth<PIX>(renderWindow, srcPixelsData, srcXStride, srcYStride, dstPixelsData, dstXStride, dstYStride);
+} // copyPixelsStreamingForDepth
+
 static void copyPixels(const RectI& renderWindow,
                        ImageBitDepthEnum depth,
                        const void* srcPixelsData,
@@ -28,6 +28,13 @@
 #include <cassert>
 #include <stdexcept>
 
+// SSE2 is part of the x86-64 baseline ABI, use it to vectorize the bit-depth
+// conversion kernels below.
+#if defined(__SSE2__) || defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 2 )
+#define NATRON_IMAGE_CONVERT_USE_SSE2
+#include <emmintrin.h>
+#endif
+
 #if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
 GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_OFF
 #include <boost/math/special_functions/fpclassify.hpp>
@@ -37,6 +44,9 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 #include <QtCore/QDebug>
 
 #include "Engine/AppManager.h"
+#include "Engine/GLShaderChain.h"
+#include "Engine/HalfFloat.h"
+#include "Engine/RamBuffer.h"
 #include "Engine/Texture.h"
 #include "Engine/Lut.h"
 
@@ -109,6 +119,143 @@ Image::convertPixelDepth(float pix)
     return pix;
 }
 
+/**
+ * @brief Applies convertPixelDepth over a contiguous span of @param nElements components.
+ * This is only correct when no colorspace conversion is involved: the bit-depth conversion
+ * operates on each component independently, so a packed RGBA scan-line can be processed
+ * as a flat array. The common depth pairs are specialized with SSE2 below.
+ **/
+template <typename SRCPIX, typename DSTPIX>
+static void
+convertPixelDepthSpan(const SRCPIX* src,
+                      DSTPIX* dst,
+                      std::size_t nElements)
+{
+    for (std::size_t i = 0; i < nElements; ++i) {
+        assert(src[i] == src[i]); // check for NaNs
+        dst[i] = Image::convertPixelDepth<SRCPIX, DSTPIX>(src[i]);
+    }
+}
+
+#ifdef NATRON_IMAGE_CONVERT_USE_SSE2
+
+// float -> byte: clamp to [0,1] then scale and round, same as Color::floatToInt<256>
+template <>
+void
+convertPixelDepthSpan(const float* src,
+                      unsigned char* dst,
+                      std::size_t nElements)
+{
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.f);
+    const __m128 scale = _mm_set1_ps(255.f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    std::size_t i = 0;
+
+    for (; i + 16 <= nElements; i += 16) {
+        __m128i quads[4];
+        for (int j = 0; j < 4; ++j) {
+            __m128 v = _mm_loadu_ps(src + i + j * 4);
+            v = _mm_min_ps(_mm_max_ps(v, zero), one);
+            quads[j] = _mm_cvttps_epi32( _mm_add_ps(_mm_mul_ps(v, scale), half) );
+        }
+        __m128i lo = _mm_packs_epi32(quads[0], quads[1]);
+        __m128i hi = _mm_packs_epi32(quads[2], quads[3]);
+        _mm_storeu_si128( (__m128i*)(dst + i), _mm_packus_epi16(lo, hi) );
+    }
+    for (; i < nElements; ++i) {
+        assert(src[i] == src[i]); // check for NaNs
+        dst[i] = Image::convertPixelDepth<float, unsigned char>(src[i]);
+    }
+}
+
+// float -> short: clamp to [0,1] then scale and round, same as Color::floatToInt<65536>
+template <>
+void
+convertPixelDepthSpan(const float* src,
+                      unsigned short* dst,
+                      std::size_t nElements)
+{
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.f);
+    const __m128 scale = _mm_set1_ps(65535.f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    // SSE2 has no unsigned 32 -> 16 pack: bias the values into the signed range before
+    // packing and flip the sign bit afterwards to undo it.
+    const __m128i bias = _mm_set1_epi32(32768);
+    const __m128i signFlip = _mm_set1_epi16( (short)0x8000 );
+    std::size_t i = 0;
+
+    for (; i + 8 <= nElements; i += 8) {
+        __m128i quads[2];
+        for (int j = 0; j < 2; ++j) {
+            __m128 v = _mm_loadu_ps(src + i + j * 4);
+            v = _mm_min_ps(_mm_max_ps(v, zero), one);
+            quads[j] = _mm_cvttps_epi32( _mm_add_ps(_mm_mul_ps(v, scale), half) );
+        }
+        __m128i packed = _mm_packs_epi32( _mm_sub_epi32(quads[0], bias), _mm_sub_epi32(quads[1], bias) );
+        _mm_storeu_si128( (__m128i*)(dst + i), _mm_xor_si128(packed, signFlip) );
+    }
+    for (; i < nElements; ++i) {
+        assert(src[i] == src[i]); // check for NaNs
+        dst[i] = Image::convertPixelDepth<float, unsigned short>(src[i]);
+    }
+}
+
+// byte -> float: divide by 255, same as Color::intToFloat<256>
+template <>
+void
+convertPixelDepthSpan(const unsigned char* src,
+                      float* dst,
+                      std::size_t nElements)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 maxValue = _mm_set1_ps(255.f);
+    std::size_t i = 0;
+
+    for (; i + 16 <= nElements; i += 16) {
+        __m128i bytes = _mm_loadu_si128( (const __m128i*)(src + i) );
+        __m128i words[2] = {
+            _mm_unpacklo_epi8(bytes, zero),
+            _mm_unpackhi_epi8(bytes, zero)
+        };
+        for (int j = 0; j < 2; ++j) {
+            __m128 lo = _mm_cvtepi32_ps( _mm_unpacklo_epi16(words[j], zero) );
+            __m128 hi = _mm_cvtepi32_ps( _mm_unpackhi_epi16(words[j], zero) );
+            _mm_storeu_ps( dst + i + j * 8, _mm_div_ps(lo, maxValue) );
+            _mm_storeu_ps( dst + i + j * 8 + 4, _mm_div_ps(hi, maxValue) );
+        }
+    }
+    for (; i < nElements; ++i) {
+        dst[i] = Image::convertPixelDepth<unsigned char, float>(src[i]);
+    }
+}
+
+// short -> float: divide by 65535, same as Color::intToFloat<65536>
+template <>
+void
+convertPixelDepthSpan(const unsigned short* src,
+                      float* dst,
+                      std::size_t nElements)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 maxValue = _mm_set1_ps(65535.f);
+    std::size_t i = 0;
+
+    for (; i + 8 <= nElements; i += 8) {
+        __m128i words = _mm_loadu_si128( (const __m128i*)(src + i) );
+        __m128 lo = _mm_cvtepi32_ps( _mm_unpacklo_epi16(words, zero) );
+        __m128 hi = _mm_cvtepi32_ps( _mm_unpackhi_epi16(words, zero) );
+        _mm_storeu_ps( dst + i, _mm_div_ps(lo, maxValue) );
+        _mm_storeu_ps( dst + i + 4, _mm_div_ps(hi, maxValue) );
+    }
+    for (; i < nElements; ++i) {
+        dst[i] = Image::convertPixelDepth<unsigned short, float>(src[i]);
+    }
+}
+
+#endif // NATRON_IMAGE_CONVERT_USE_SSE2
+
 static const Color::Lut*
 lutFromColorspace(ViewerColorSpaceEnum cs)
 {
@@ -139,6 +286,8 @@ ActionRetCodeEnum
 convertToFormatInternal_sameComps(const RectI & renderWindow,
                                   ViewerColorSpaceEnum srcColorSpace,
                                   ViewerColorSpaceEnum dstColorSpace,
+                                  bool requiresUnpremult,
+                                  bool requiresPremult,
                                   const void* srcBufPtrs[4],
                                   int nComp,
                                   const RectI& srcBounds,
@@ -155,53 +304,62 @@ convertToFormatInternal_sameComps(const RectI & renderWindow,
     const Color::Lut* const srcLut = (srcLut_ == dstLut_) ? 0 : srcLut_;
     const Color::Lut* const dstLut = (srcLut_ == dstLut_) ? 0 : dstLut_;
 
+    // The alpha operations only make sense when there's an alpha channel to multiply/divide by
+    const bool hasAlphaOps = (requiresUnpremult || requiresPremult) && nComp == 4;
+
     int srcDataSizeOf = sizeof(SRCPIX);
 
+    // Resolve the buffer layouts once for the whole region: scanlines are walked with the iterators
+    Image::ScanlineIterator<SRCPIX> srcIt((const SRCPIX**)srcBufPtrs, renderWindow.x1, renderWindow.y1, srcBounds, nComp);
+    Image::ScanlineIterator<DSTPIX> dstIt((const DSTPIX**)dstBufPtrs, renderWindow.x1, renderWindow.y1, dstBounds, nComp);
+    const int srcPixelStride = srcIt.getPixelStride();
+    const int dstPixelStride = dstIt.getPixelStride();
 
-    for (int y = renderWindow.y1; y < renderWindow.y2; ++y) {
+    for (int y = renderWindow.y1; y < renderWindow.y2; ++y, srcIt.nextRow(), dstIt.nextRow()) {
 
         if (renderClone && renderClone->isRenderAborted()) {
             return eActionStatusAborted;
         }
 
-        if (srcMaxValue == dstMaxValue && !srcLut && !dstLut) {
-            // Use memcpy when possible
-
-            const SRCPIX* srcPixelPtrs[4];
-            int srcPixelStride;
-            Image::getChannelPointers<SRCPIX>((const SRCPIX**)srcBufPtrs, renderWindow.x1, y, srcBounds, nComp, (SRCPIX**)srcPixelPtrs, &srcPixelStride);
+        if (!srcLut && !dstLut && !hasAlphaOps) {
+            // No colorspace conversion: at most a bit-depth conversion is needed, which operates
+            // on each component independently. Use memcpy when the bit-depth is the same,
+            // otherwise process the scan-line as a flat span with convertPixelDepthSpan.
 
-            DSTPIX* dstPixelPtrs[4];
-            int dstPixelStride;
-            Image::getChannelPointers<DSTPIX>((const DSTPIX**)dstBufPtrs, renderWindow.x1, y, dstBounds, nComp, (DSTPIX**)dstPixelPtrs, &dstPixelStride);
+            const SRCPIX* const* srcPixelPtrs = srcIt.rowPixels();
+            DSTPIX* const* dstPixelPtrs = dstIt.rowPixels();
 
 
-            // If the pixel stride is the same, use memcpy
+            // If the pixel stride is the same, whole scan-line portions are contiguous
             if (srcPixelStride == dstPixelStride) {
                 if (srcPixelStride == 1) {
-                    std::size_t nBytesToCopy = renderWindow.width() * srcDataSizeOf;
-                    // Ok we are in coplanar mode, copy each channel individually
+                    // Ok we are in coplanar mode, process each channel individually
                     for (int c = 0; c < 4; ++c) {
                         if (srcPixelPtrs[c] && dstPixelPtrs[c]) {
-                            memcpy(dstPixelPtrs[c], srcPixelPtrs[c], nBytesToCopy);
+                            if (srcMaxValue == dstMaxValue) {
+                                memcpy(dstPixelPtrs[c], srcPixelPtrs[c], renderWindow.width() * srcDataSizeOf);
+                            } else {
+                                convertPixelDepthSpan<SRCPIX, DSTPIX>( srcPixelPtrs[c], dstPixelPtrs[c], (std::size_t)renderWindow.width() );
+                            }
                         }
                     }
                 } else {
-                    std::size_t nBytesToCopy = renderWindow.width() * nComp * srcDataSizeOf;
-
-                    // In packed RGBA mode or single channel coplanar a single call to memcpy is needed per scan-line
-                    memcpy(dstPixelPtrs[0], srcPixelPtrs[0], nBytesToCopy);
+                    // In packed RGBA mode or single channel coplanar a single call is needed per scan-line
+                    if (srcMaxValue == dstMaxValue) {
+                        memcpy(dstPixelPtrs[0], srcPixelPtrs[0], renderWindow.width() * nComp * srcDataSizeOf);
+                    } else {
+                        convertPixelDepthSpan<SRCPIX, DSTPIX>( srcPixelPtrs[0], dstPixelPtrs[0], (std::size_t)renderWindow.width() * nComp );
+                    }
                 }
             } else {
-                // Different strides, copy manually
+                // Different strides, convert manually
                 for (int c = 0; c < 4; ++c) {
                     if (srcPixelPtrs[c] && dstPixelPtrs[c]) {
                         const SRCPIX* src_pix = srcPixelPtrs[c];
                         DSTPIX* dst_pix = dstPixelPtrs[c];
                         for (int x = renderWindow.x1; x < renderWindow.x2; ++x) {
-                            // They are of the same bitdepth since srcMaxValue == dstMaxValue was checked above
                             assert(*src_pix == *src_pix); // check for NaNs
-                            *dst_pix = (DSTPIX)*src_pix;
+                            *dst_pix = Image::convertPixelDepth<SRCPIX, DSTPIX>(*src_pix);
                             src_pix += srcPixelStride;
                             dst_pix += dstPixelStride;
                         }
@@ -215,12 +373,10 @@ convertToFormatInternal_sameComps(const RectI & renderWindow,
             int start = rand() % renderWindow.width() + renderWindow.x1;
 
             const SRCPIX* srcPixelPtrs[4];
-            int srcPixelStride;
-            Image::getChannelPointers<SRCPIX>((const SRCPIX**)srcBufPtrs, start, y, srcBounds, nComp, (SRCPIX**)srcPixelPtrs, &srcPixelStride);
+            srcIt.pixelsAt(start - renderWindow.x1, (SRCPIX**)srcPixelPtrs);
 
             DSTPIX* dstPixelPtrs[4];
-            int dstPixelStride;
-            Image::getChannelPointers<DSTPIX>((const DSTPIX**)dstBufPtrs, start, y, dstBounds, nComp, (DSTPIX**)dstPixelPtrs, &dstPixelStride);
+            dstIt.pixelsAt(start - renderWindow.x1, dstPixelPtrs);
 
             const SRCPIX* srcPixelStart[4];
             DSTPIX* dstPixelStart[4];
@@ -236,6 +392,15 @@ convertToFormatInternal_sameComps(const RectI & renderWindow,
                 };
 
                 while (x != end) {
+
+                    // This is only used if hasAlphaOps is true
+                    float alphaForUnPremult;
+                    if (hasAlphaOps && srcPixelPtrs[3]) {
+                        alphaForUnPremult = Image::convertPixelDepth<SRCPIX, float>(*srcPixelPtrs[3]);
+                    } else {
+                        alphaForUnPremult = 1.;
+                    }
+
                     for (int k = 0; k < nComp; ++k) {
 
                         if (!dstPixelPtrs[k]) {
@@ -250,12 +415,19 @@ convertToFormatInternal_sameComps(const RectI & renderWindow,
                         }
 
                         DSTPIX pix;
-                        if ( (k == 3) || (!srcLut && !dstLut) ) {
+                        if ( (k == 3) || (!srcLut && !dstLut && !hasAlphaOps) ) {
                             pix = Image::convertPixelDepth<SRCPIX, DSTPIX>(sourcePixel);
                         } else {
                             float pixFloat;
 
-                            if (srcLut) {
+                            // Unpremult before doing colorspace conversion from linear to X
+                            if (hasAlphaOps && requiresUnpremult) {
+                                pixFloat = Image::convertPixelDepth<SRCPIX, float>(sourcePixel);
+                                pixFloat = alphaForUnPremult == 0.f ? 0. : pixFloat / alphaForUnPremult;
+                                if (srcLut) {
+                                    pixFloat = srcLut->fromColorSpaceFloatToLinearFloat(pixFloat);
+                                }
+                            } else if (srcLut) {
                                 if (srcMaxValue == 255) {
                                     pixFloat = srcLut->fromColorSpaceUint8ToLinearFloatFast(sourcePixel);
                                 } else if (srcMaxValue == 65535) {
@@ -267,6 +439,12 @@ convertToFormatInternal_sameComps(const RectI & renderWindow,
                                 pixFloat = Image::convertPixelDepth<SRCPIX, float>(sourcePixel);
                             }
 
+                            // Premult in linear before applying the dst colorspace,
+                            // consistently with Lut::to_byte_packed
+                            if (hasAlphaOps && requiresPremult) {
+                                pixFloat *= alphaForUnPremult;
+                            }
+
                             if (dstMaxValue == 255) {
                                 ///small increase in perf we use Luts. This should be anyway the most used case.
                                 error[k] = (error[k] & 0xff) + ( dstLut ? dstLut->toColorSpaceUint8xxFromLinearFloatFast(pixFloat) :
@@ -331,6 +509,7 @@ convertToFormatInternal(const RectI & renderWindow,
                                ViewerColorSpaceEnum srcColorSpace,
                                ViewerColorSpaceEnum dstColorSpace,
                                bool requiresUnpremult,
+                               bool requiresPremult,
                                int conversionChannel,
                                Image::AlphaChannelHandlingEnum alphaHandling,
                                const void* srcBufPtrs[4],
@@ -345,7 +524,13 @@ convertToFormatInternal(const RectI & renderWindow,
     const Color::Lut* const srcLut = lutFromColorspace( (ViewerColorSpaceEnum)srcColorSpace );
     const Color::Lut* const dstLut = lutFromColorspace( (ViewerColorSpaceEnum)dstColorSpace );
 
-    for (int y = renderWindow.y1; y < renderWindow.y2; ++y) {
+    // Resolve the buffer layouts once for the whole region: scanlines are walked with the iterators
+    Image::ScanlineIterator<SRCPIX> srcIt((const SRCPIX**)srcBufPtrs, renderWindow.x1, renderWindow.y1, srcBounds, srcNComps);
+    Image::ScanlineIterator<DSTPIX> dstIt((const DSTPIX**)dstBufPtrs, renderWindow.x1, renderWindow.y1, dstBounds, dstNComps);
+    const int srcPixelStride = srcIt.getPixelStride();
+    const int dstPixelStride = dstIt.getPixelStride();
+
+    for (int y = renderWindow.y1; y < renderWindow.y2; ++y, srcIt.nextRow(), dstIt.nextRow()) {
         // Start of the line for error diffusion
         // coverity[dont_call]
 
@@ -356,12 +541,10 @@ convertToFormatInternal(const RectI & renderWindow,
         int start = rand() % renderWindow.width() + renderWindow.x1;
 
         const SRCPIX* srcPixelPtrs[4];
-        int srcPixelStride;
-        Image::getChannelPointers<SRCPIX, srcNComps>((const SRCPIX**)srcBufPtrs, start, y, srcBounds, (SRCPIX**)srcPixelPtrs, &srcPixelStride);
+        srcIt.pixelsAt(start - renderWindow.x1, (SRCPIX**)srcPixelPtrs);
 
         DSTPIX* dstPixelPtrs[4];
-        int dstPixelStride;
-        Image::getChannelPointers<DSTPIX, dstNComps>((const DSTPIX**)dstBufPtrs, start, y, dstBounds, (DSTPIX**)dstPixelPtrs, &dstPixelStride);
+        dstIt.pixelsAt(start - renderWindow.x1, dstPixelPtrs);
 
         const SRCPIX* srcPixelStart[4];
         DSTPIX* dstPixelStart[4];
@@ -385,9 +568,9 @@ convertToFormatInternal(const RectI & renderWindow,
                 // We've XY, RGB or RGBA input and outputs
                 assert(srcNComps != dstNComps);
 
-                // This is only set if unpremultChannel is true
+                // This is only used if requiresUnpremult or requiresPremult is true
                 float alphaForUnPremult;
-                if (requiresUnpremult && srcPixelPtrs[3]) {
+                if ((requiresUnpremult || requiresPremult) && srcPixelPtrs[3]) {
                     alphaForUnPremult = Image::convertPixelDepth<SRCPIX, float>(*srcPixelPtrs[3]);
                 } else {
                     alphaForUnPremult = 1.;
@@ -402,7 +585,7 @@ convertToFormatInternal(const RectI & renderWindow,
                     SRCPIX sourcePixel = srcPixelPtrs[k] ? *srcPixelPtrs[k] : 0;
 
                     DSTPIX pix;
-                    if (!srcLut && !dstLut) {
+                    if (!srcLut && !dstLut && !requiresUnpremult && !requiresPremult) {
                         if (dstMaxValue == 255) {
                             float pixFloat = Image::convertPixelDepth<SRCPIX, float>(sourcePixel);
                             error[k] = (error[k] & 0xff) + Color::floatToInt<0xff01>(pixFloat);
@@ -433,6 +616,12 @@ convertToFormatInternal(const RectI & renderWindow,
                             pixFloat = Image::convertPixelDepth<SRCPIX, float>(sourcePixel);
                         }
 
+                        // Premult in linear before applying the dst colorspace,
+                        // consistently with Lut::to_byte_packed
+                        if (requiresPremult) {
+                            pixFloat *= alphaForUnPremult;
+                        }
+
                         ///Apply dst color-space
                         if (dstMaxValue == 255) {
                             assert(k < 3);
@@ -532,7 +721,13 @@ convertToMonoImage(const RectI & renderWindow,
 
     DSTPIX pix;
 
-    for (int y = renderWindow.y1; y < renderWindow.y2; ++y) {
+    // Resolve the buffer layouts once for the whole region: scanlines are walked with the iterators
+    Image::ScanlineIterator<SRCPIX> srcIt((const SRCPIX**)srcBufPtrs, renderWindow.x1, renderWindow.y1, srcBounds, srcNComps);
+    Image::ScanlineIterator<DSTPIX> dstIt((const DSTPIX**)dstBufPtrs, renderWindow.x1, renderWindow.y1, dstBounds, 1);
+    const int srcPixelStride = srcIt.getPixelStride();
+    const int dstPixelStride = dstIt.getPixelStride();
+
+    for (int y = renderWindow.y1; y < renderWindow.y2; ++y, srcIt.nextRow(), dstIt.nextRow()) {
         // Start of the line for error diffusion
         // coverity[dont_call]
 
@@ -542,12 +737,10 @@ convertToMonoImage(const RectI & renderWindow,
         }
 
         const SRCPIX* srcPixelPtrs[4];
-        int srcPixelStride;
-        Image::getChannelPointers<SRCPIX, srcNComps>((const SRCPIX**)srcBufPtrs, renderWindow.x1, y, srcBounds, (SRCPIX**)srcPixelPtrs, &srcPixelStride);
+        srcIt.pixelsAt(0, (SRCPIX**)srcPixelPtrs);
 
         DSTPIX* dstPixelPtrs[4];
-        int dstPixelStride;
-        Image::getChannelPointers<DSTPIX, 1>((const DSTPIX**)dstBufPtrs, renderWindow.x1, y, dstBounds, (DSTPIX**)dstPixelPtrs, &dstPixelStride);
+        dstIt.pixelsAt(0, dstPixelPtrs);
 
 
         for (int x = renderWindow.x1; x < renderWindow.x2; ++x) {
@@ -590,7 +783,13 @@ convertFromMonoImage(const RectI & renderWindow,
 
     DSTPIX pix;
 
-    for (int y = renderWindow.y1; y < renderWindow.y2; ++y) {
+    // Resolve the buffer layouts once for the whole region: scanlines are walked with the iterators
+    Image::ScanlineIterator<SRCPIX> srcIt((const SRCPIX**)srcBufPtrs, renderWindow.x1, renderWindow.y1, srcBounds, 1);
+    Image::ScanlineIterator<DSTPIX> dstIt((const DSTPIX**)dstBufPtrs, renderWindow.x1, renderWindow.y1, dstBounds, dstNComps);
+    const int srcPixelStride = srcIt.getPixelStride();
+    const int dstPixelStride = dstIt.getPixelStride();
+
+    for (int y = renderWindow.y1; y < renderWindow.y2; ++y, srcIt.nextRow(), dstIt.nextRow()) {
         // Start of the line for error diffusion
         // coverity[dont_call]
 
@@ -599,12 +798,10 @@ convertFromMonoImage(const RectI & renderWindow,
         }
 
         const SRCPIX* srcPixelPtrs[4];
-        int srcPixelStride;
-        Image::getChannelPointers<SRCPIX, 1>((const SRCPIX**)srcBufPtrs, renderWindow.x1, y, srcBounds, (SRCPIX**)srcPixelPtrs, &srcPixelStride);
+        srcIt.pixelsAt(0, (SRCPIX**)srcPixelPtrs);
 
         DSTPIX* dstPixelPtrs[4];
-        int dstPixelStride;
-        Image::getChannelPointers<DSTPIX, dstNComps>((const DSTPIX**)dstBufPtrs, renderWindow.x1, y, dstBounds, (DSTPIX**)dstPixelPtrs, &dstPixelStride);
+        dstIt.pixelsAt(0, dstPixelPtrs);
 
         for (int x = renderWindow.x1; x < renderWindow.x2; ++x) {
 
@@ -677,6 +874,7 @@ convertToFormatInternalForSrcComps(const RectI & renderWindow,
                                    ViewerColorSpaceEnum srcColorSpace,
                                    ViewerColorSpaceEnum dstColorSpace,
                                    bool requiresUnpremult,
+                                   bool requiresPremult,
                                    int conversionChannel,
                                    Image::AlphaChannelHandlingEnum alphaHandling,
                                    const void* srcBufPtrs[4],
@@ -701,11 +899,11 @@ convertToFormatInternalForSrcComps(const RectI & renderWindow,
             }
         }   break;
         case 2:
-            return convertToFormatInternal<SRCPIX, srcMaxValue, DSTPIX, dstMaxValue, srcNComps, 2>(renderWindow, srcColorSpace, dstColorSpace, requiresUnpremult, conversionChannel, alphaHandling, srcBufPtrs, srcBounds, dstBufPtrs, dstBounds, renderClone);
+            return convertToFormatInternal<SRCPIX, srcMaxValue, DSTPIX, dstMaxValue, srcNComps, 2>(renderWindow, srcColorSpace, dstColorSpace, requiresUnpremult, requiresPremult, conversionChannel, alphaHandling, srcBufPtrs, srcBounds, dstBufPtrs, dstBounds, renderClone);
         case 3:
-            return convertToFormatInternal<SRCPIX, srcMaxValue, DSTPIX, dstMaxValue, srcNComps, 3>(renderWindow, srcColorSpace, dstColorSpace, requiresUnpremult, conversionChannel, alphaHandling, srcBufPtrs, srcBounds, dstBufPtrs, dstBounds, renderClone);
+            return convertToFormatInternal<SRCPIX, srcMaxValue, DSTPIX, dstMaxValue, srcNComps, 3>(renderWindow, srcColorSpace, dstColorSpace, requiresUnpremult, requiresPremult, conversionChannel, alphaHandling, srcBufPtrs, srcBounds, dstBufPtrs, dstBounds, renderClone);
         case 4:
-            return convertToFormatInternal<SRCPIX, srcMaxValue, DSTPIX, dstMaxValue, srcNComps, 4>(renderWindow, srcColorSpace, dstColorSpace, requiresUnpremult, conversionChannel, alphaHandling, srcBufPtrs, srcBounds, dstBufPtrs, dstBounds, renderClone);
+            return convertToFormatInternal<SRCPIX, srcMaxValue, DSTPIX, dstMaxValue, srcNComps, 4>(renderWindow, srcColorSpace, dstColorSpace, requiresUnpremult, requiresPremult, conversionChannel, alphaHandling, srcBufPtrs, srcBounds, dstBufPtrs, dstBounds, renderClone);
         default:
             assert(false);
             break;
@@ -719,6 +917,7 @@ convertToFormatInternalForDstDepth(const RectI & renderWindow,
                                    ViewerColorSpaceEnum srcColorSpace,
                                    ViewerColorSpaceEnum dstColorSpace,
                                    bool requiresUnpremult,
+                                   bool requiresPremult,
                                    int conversionChannel,
                                    Image::AlphaChannelHandlingEnum alphaHandling,
                                    Image::MonoToPackedConversionEnum monoConversion,
@@ -733,7 +932,7 @@ convertToFormatInternalForDstDepth(const RectI & renderWindow,
 
     if (srcNComps == dstNComps) {
         // Optimize same number of components
-        return convertToFormatInternal_sameComps<SRCPIX, srcMaxValue, DSTPIX, dstMaxValue>(renderWindow, srcColorSpace, dstColorSpace, srcBufPtrs, srcNComps, srcBounds, dstBufPtrs, dstBounds, renderClone);
+        return convertToFormatInternal_sameComps<SRCPIX, srcMaxValue, DSTPIX, dstMaxValue>(renderWindow, srcColorSpace, dstColorSpace, requiresUnpremult, requiresPremult, srcBufPtrs, srcNComps, srcBounds, dstBufPtrs, dstBounds, renderClone);
     }
 
     if (srcNComps == 1) {
@@ -750,11 +949,11 @@ convertToFormatInternalForDstDepth(const RectI & renderWindow,
     switch (srcNComps) {
 
         case 2:
-            return convertToFormatInternalForSrcComps<SRCPIX, srcMaxValue, DSTPIX, dstMaxValue, 2>(renderWindow, srcColorSpace, dstColorSpace, requiresUnpremult, conversionChannel, alphaHandling, srcBufPtrs, srcBounds, dstBufPtrs, dstNComps, dstBounds, renderClone);
+            return convertToFormatInternalForSrcComps<SRCPIX, srcMaxValue, DSTPIX, dstMaxValue, 2>(renderWindow, srcColorSpace, dstColorSpace, requiresUnpremult, requiresPremult, conversionChannel, alphaHandling, srcBufPtrs, srcBounds, dstBufPtrs, dstNComps, dstBounds, renderClone);
         case 3:
-            return convertToFormatInternalForSrcComps<SRCPIX, srcMaxValue, DSTPIX, dstMaxValue, 3>(renderWindow, srcColorSpace, dstColorSpace, requiresUnpremult, conversionChannel, alphaHandling, srcBufPtrs, srcBounds, dstBufPtrs, dstNComps, dstBounds, renderClone);
+            return convertToFormatInternalForSrcComps<SRCPIX, srcMaxValue, DSTPIX, dstMaxValue, 3>(renderWindow, srcColorSpace, dstColorSpace, requiresUnpremult, requiresPremult, conversionChannel, alphaHandling, srcBufPtrs, srcBounds, dstBufPtrs, dstNComps, dstBounds, renderClone);
         case 4:
-            return convertToFormatInternalForSrcComps<SRCPIX, srcMaxValue, DSTPIX, dstMaxValue, 4>(renderWindow, srcColorSpace, dstColorSpace, requiresUnpremult, conversionChannel, alphaHandling, srcBufPtrs, srcBounds, dstBufPtrs, dstNComps, dstBounds, renderClone);
+            return convertToFormatInternalForSrcComps<SRCPIX, srcMaxValue, DSTPIX, dstMaxValue, 4>(renderWindow, srcColorSpace, dstColorSpace, requiresUnpremult, requiresPremult, conversionChannel, alphaHandling, srcBufPtrs, srcBounds, dstBufPtrs, dstNComps, dstBounds, renderClone);
         default:
             break;
     }
@@ -767,6 +966,7 @@ convertToFormatInternalForSrcDepth(const RectI & renderWindow,
                                    ViewerColorSpaceEnum srcColorSpace,
                                    ViewerColorSpaceEnum dstColorSpace,
                                    bool requiresUnpremult,
+                                   bool requiresPremult,
                                    int conversionChannel,
                                    Image::AlphaChannelHandlingEnum alphaHandling,
                                    Image::MonoToPackedConversionEnum monoConversion,
@@ -782,24 +982,100 @@ convertToFormatInternalForSrcDepth(const RectI & renderWindow,
     switch ( dstBitDepth ) {
         case eImageBitDepthByte:
             ///Same as a copy
-            return convertToFormatInternalForDstDepth<SRCPIX, srcMaxValue, unsigned char, 255>(renderWindow, srcColorSpace, dstColorSpace, requiresUnpremult, conversionChannel, alphaHandling, monoConversion, srcBufPtrs, srcNComps, srcBounds, dstBufPtrs, dstNComps, dstBounds, renderClone);
+            return convertToFormatInternalForDstDepth<SRCPIX, srcMaxValue, unsigned char, 255>(renderWindow, srcColorSpace, dstColorSpace, requiresUnpremult, requiresPremult, conversionChannel, alphaHandling, monoConversion, srcBufPtrs, srcNComps, srcBounds, dstBufPtrs, dstNComps, dstBounds, renderClone);
         case eImageBitDepthShort:
-            return convertToFormatInternalForDstDepth<SRCPIX, srcMaxValue, unsigned short, 65535>(renderWindow, srcColorSpace, dstColorSpace, requiresUnpremult, conversionChannel, alphaHandling, monoConversion, srcBufPtrs, srcNComps, srcBounds, dstBufPtrs, dstNComps, dstBounds, renderClone);
+            return convertToFormatInternalForDstDepth<SRCPIX, srcMaxValue, unsigned short, 65535>(renderWindow, srcColorSpace, dstColorSpace, requiresUnpremult, requiresPremult, conversionChannel, alphaHandling, monoConversion, srcBufPtrs, srcNComps, srcBounds, dstBufPtrs, dstNComps, dstBounds, renderClone);
         case eImageBitDepthHalf:
             break;
         case eImageBitDepthFloat:
-            return convertToFormatInternalForDstDepth<SRCPIX, srcMaxValue, float, 1>(renderWindow, srcColorSpace, dstColorSpace, requiresUnpremult, conversionChannel, alphaHandling, monoConversion, srcBufPtrs, srcNComps, srcBounds, dstBufPtrs, dstNComps, dstBounds, renderClone);
+            return convertToFormatInternalForDstDepth<SRCPIX, srcMaxValue, float, 1>(renderWindow, srcColorSpace, dstColorSpace, requiresUnpremult, requiresPremult, conversionChannel, alphaHandling, monoConversion, srcBufPtrs, srcNComps, srcBounds, dstBufPtrs, dstNComps, dstBounds, renderClone);
         case eImageBitDepthNone:
             break;
     }
     return eActionStatusFailed;
 }
 
+/*
+ Converts the renderWindow of a half image (any layout) into one contiguous float plane
+ per channel laid out over renderWindow, so that the staging image can be fed back to
+ convertCPUImage with a float depth.
+ */
+static void
+halfImageToFloatPlanes(const void* srcBufPtrs[4],
+                       int srcNComps,
+                       const RectI& srcBounds,
+                       const RectI& renderWindow,
+                       float* tmpBuf,
+                       float* tmpPtrs[4])
+{
+    const std::size_t planeSize = (std::size_t)renderWindow.width() * renderWindow.height();
+    for (int c = 0; c < 4; ++c) {
+        tmpPtrs[c] = (c < srcNComps) ? tmpBuf + c * planeSize : 0;
+    }
+
+    Image::ScanlineIterator<unsigned short> srcIt((const unsigned short**)srcBufPtrs, renderWindow.x1, renderWindow.y1, srcBounds, srcNComps);
+    const int pixelStride = srcIt.getPixelStride();
+
+    for (int y = renderWindow.y1; y < renderWindow.y2; ++y, srcIt.nextRow()) {
+        const unsigned short* const* srcPixelPtrs = srcIt.rowPixels();
+
+        for (int c = 0; c < srcNComps; ++c) {
+            if (!srcPixelPtrs[c]) {
+                continue;
+            }
+            float* dstRow = tmpPtrs[c] + (std::size_t)(y - renderWindow.y1) * renderWindow.width();
+            if (pixelStride == 1) {
+                halfToFloatSpan(srcPixelPtrs[c], dstRow, renderWindow.width());
+            } else {
+                const unsigned short* src_pix = srcPixelPtrs[c];
+                for (int x = 0; x < renderWindow.width(); ++x, src_pix += pixelStride) {
+                    dstRow[x] = halfToFloat(*src_pix);
+                }
+            }
+        }
+    }
+} // halfImageToFloatPlanes
+
+/*
+ Quantizes per-channel float planes laid out over renderWindow (as produced above) into
+ the renderWindow of a half image of any layout.
+ */
+static void
+floatPlanesToHalfImage(float* const tmpPtrs[4],
+                       int dstNComps,
+                       const RectI& renderWindow,
+                       void* dstBufPtrs[4],
+                       const RectI& dstBounds)
+{
+    Image::ScanlineIterator<unsigned short> dstIt((const unsigned short**)dstBufPtrs, renderWindow.x1, renderWindow.y1, dstBounds, dstNComps);
+    const int pixelStride = dstIt.getPixelStride();
+
+    for (int y = renderWindow.y1; y < renderWindow.y2; ++y, dstIt.nextRow()) {
+        unsigned short* const* dstPixelPtrs = dstIt.rowPixels();
+
+        for (int c = 0; c < dstNComps; ++c) {
+            if (!dstPixelPtrs[c] || !tmpPtrs[c]) {
+                continue;
+            }
+            const float* srcRow = tmpPtrs[c] + (std::size_t)(y - renderWindow.y1) * renderWindow.width();
+            if (pixelStride == 1) {
+                floatToHalfSpan(srcRow, dstPixelPtrs[c], renderWindow.width());
+            } else {
+                unsigned short* dst_pix = dstPixelPtrs[c];
+                for (int x = 0; x < renderWindow.width(); ++x, dst_pix += pixelStride) {
+                    *dst_pix = floatToHalf(srcRow[x]);
+                }
+            }
+        }
+    }
+} // floatPlanesToHalfImage
+
 ActionRetCodeEnum
 ImagePrivate::convertCPUImage(const RectI & renderWindow,
                               ViewerColorSpaceEnum srcColorSpace,
                               ViewerColorSpaceEnum dstColorSpace,
                               bool requiresUnpremult,
+                              bool requiresPremult,
                               int conversionChannel,
                               Image::AlphaChannelHandlingEnum alphaHandling,
                               Image::MonoToPackedConversionEnum monoConversion,
@@ -815,16 +1091,63 @@ ImagePrivate::convertCPUImage(const RectI & renderWindow,
 {
     assert( srcBounds.contains(renderWindow) && dstBounds.contains(renderWindow) );
 
+    // Half is a storage depth only: the conversion kernels work on the other 3 depths.
+    // Stage through a temporary float image laid out over renderWindow, one contiguous
+    // plane per channel so that the half<->float passes are flat spans.
+    if ( (srcBitDepth == eImageBitDepthHalf) || (dstBitDepth == eImageBitDepthHalf) ) {
+
+        const std::size_t planeSize = (std::size_t)renderWindow.width() * renderWindow.height();
+
+        RamBuffer<float> srcTmpStorage;
+        const void* actualSrcPtrs[4] = {srcBufPtrs[0], srcBufPtrs[1], srcBufPtrs[2], srcBufPtrs[3]};
+        RectI actualSrcBounds = srcBounds;
+        ImageBitDepthEnum actualSrcDepth = srcBitDepth;
+
+        if (srcBitDepth == eImageBitDepthHalf) {
+            srcTmpStorage.resize(planeSize * srcNComps);
+            float* srcTmpPtrs[4];
+            halfImageToFloatPlanes(srcBufPtrs, srcNComps, srcBounds, renderWindow, srcTmpStorage.getData(), srcTmpPtrs);
+            for (int c = 0; c < 4; ++c) {
+                actualSrcPtrs[c] = srcTmpPtrs[c];
+            }
+            actualSrcBounds = renderWindow;
+            actualSrcDepth = eImageBitDepthFloat;
+        }
+
+        if (dstBitDepth != eImageBitDepthHalf) {
+            return convertCPUImage(renderWindow, srcColorSpace, dstColorSpace, requiresUnpremult, requiresPremult, conversionChannel, alphaHandling, monoConversion, actualSrcPtrs, srcNComps, actualSrcDepth, actualSrcBounds, dstBufPtrs, dstNComps, dstBitDepth, dstBounds, renderClone);
+        }
+
+        // The destination is half: run the conversion to float planes, then quantize
+        RamBuffer<float> dstTmpStorage;
+        dstTmpStorage.resize(planeSize * dstNComps);
+        float* dstTmpPtrs[4];
+        void* dstTmpVoidPtrs[4];
+        for (int c = 0; c < 4; ++c) {
+            dstTmpPtrs[c] = (c < dstNComps) ? dstTmpStorage.getData() + c * planeSize : 0;
+            dstTmpVoidPtrs[c] = dstTmpPtrs[c];
+        }
+
+        ActionRetCodeEnum stat = convertCPUImage(renderWindow, srcColorSpace, dstColorSpace, requiresUnpremult, requiresPremult, conversionChannel, alphaHandling, monoConversion, actualSrcPtrs, srcNComps, actualSrcDepth, actualSrcBounds, dstTmpVoidPtrs, dstNComps, eImageBitDepthFloat, renderWindow, renderClone);
+        if ( isFailureRetCode(stat) ) {
+            return stat;
+        }
+
+        floatPlanesToHalfImage(dstTmpPtrs, dstNComps, renderWindow, dstBufPtrs, dstBounds);
+
+        return eActionStatusOK;
+    }
+
     switch ( srcBitDepth ) {
         case eImageBitDepthByte:
             ///Same as a copy
-            return convertToFormatInternalForSrcDepth<unsigned char, 255>(renderWindow, srcColorSpace, dstColorSpace, requiresUnpremult, conversionChannel, alphaHandling, monoConversion, srcBufPtrs, srcNComps, srcBounds, dstBufPtrs, dstNComps, dstBitDepth, dstBounds, renderClone);
+            return convertToFormatInternalForSrcDepth<unsigned char, 255>(renderWindow, srcColorSpace, dstColorSpace, requiresUnpremult, requiresPremult, conversionChannel, alphaHandling, monoConversion, srcBufPtrs, srcNComps, srcBounds, dstBufPtrs, dstNComps, dstBitDepth, dstBounds, renderClone);
         case eImageBitDepthShort:
-            return convertToFormatInternalForSrcDepth<unsigned short, 65535>(renderWindow, srcColorSpace, dstColorSpace, requiresUnpremult, conversionChannel, alphaHandling, monoConversion, srcBufPtrs, srcNComps, srcBounds, dstBufPtrs, dstNComps, dstBitDepth, dstBounds, renderClone);
+            return convertToFormatInternalForSrcDepth<unsigned short, 65535>(renderWindow, srcColorSpace, dstColorSpace, requiresUnpremult, requiresPremult, conversionChannel, alphaHandling, monoConversion, srcBufPtrs, srcNComps, srcBounds, dstBufPtrs, dstNComps, dstBitDepth, dstBounds, renderClone);
         case eImageBitDepthHalf:
             break;
         case eImageBitDepthFloat:
-            return convertToFormatInternalForSrcDepth<float, 1>(renderWindow, srcColorSpace, dstColorSpace, requiresUnpremult, conversionChannel, alphaHandling, monoConversion, srcBufPtrs, srcNComps, srcBounds, dstBufPtrs, dstNComps, dstBitDepth, dstBounds, renderClone);
+            return convertToFormatInternalForSrcDepth<float, 1>(renderWindow, srcColorSpace, dstColorSpace, requiresUnpremult, requiresPremult, conversionChannel, alphaHandling, monoConversion, srcBufPtrs, srcNComps, srcBounds, dstBufPtrs, dstNComps, dstBitDepth, dstBounds, renderClone);
         case eImageBitDepthNone:
             break;
     }
@@ -916,6 +1239,49 @@ copyGLTextureWrapper(const GLImageStoragePtr& from,
 
 }
 
+// GLShaderChain pass running the analytic colorspace conversion shader
+class ColorspaceConversionPass : public GLShaderChain::Pass
+{
+    ViewerColorSpaceEnum _srcColorSpace, _dstColorSpace;
+
+public:
+
+    ColorspaceConversionPass(ViewerColorSpaceEnum srcColorSpace, ViewerColorSpaceEnum dstColorSpace)
+    : _srcColorSpace(srcColorSpace)
+    , _dstColorSpace(dstColorSpace)
+    {
+    }
+
+    virtual GLShaderBasePtr getOrCreateShader(const OSGLContextPtr& glContext) OVERRIDE FINAL
+    {
+        return glContext->getOrCreateColorspaceConversionShader(_srcColorSpace, _dstColorSpace);
+    }
+};
+
+ActionRetCodeEnum
+ImagePrivate::convertGLTextureColorspace(const GLTexturePtr& from,
+                                         const GLTexturePtr& to,
+                                         ViewerColorSpaceEnum srcColorSpace,
+                                         ViewerColorSpaceEnum dstColorSpace,
+                                         const RectI& roi,
+                                         const OSGLContextPtr& glContext)
+{
+    if (srcColorSpace == dstColorSpace) {
+        // Nothing to convert, plain copy
+        OSGLContextSaver saveCurrentContext;
+        OSGLContextAttacherPtr contextAttacher = OSGLContextAttacher::create(glContext);
+        contextAttacher->attach();
+        copyGLTexture(from, to, roi, glContext);
+
+        return eActionStatusOK;
+    }
+
+    GLShaderChain chain(glContext);
+    chain.appendPass( GLShaderChain::PassPtr( new ColorspaceConversionPass(srcColorSpace, dstColorSpace) ) );
+
+    return chain.render(from, to, roi);
+}
+
 template <typename GL>
 ActionRetCodeEnum
 convertRGBAPackedCPUBufferToGLTextureInternal(const float* srcData,
@@ -1170,6 +1536,7 @@ private:
                                       _copyArgs.srcColorspace,
                                       _copyArgs.dstColorspace,
                                       _copyArgs.unPremultIfNeeded,
+                                      _copyArgs.premultIfNeeded,
                                       _copyArgs.conversionChannel,
                                       _copyArgs.alphaHandling,
                                       _copyArgs.monoConversion,
@@ -27,6 +27,12 @@
 #include <cassert>
 #include <stdexcept>
 
+// SSE2 is part of the x86-64 baseline ABI, use it for the packed RGBA masked copy below.
+#if defined(__SSE2__) || defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 2 )
+#define NATRON_COPY_CHANNELS_USE_SSE2
+#include <emmintrin.h>
+#endif
+
 #include <QtCore/QDebug>
 
 #include "Engine/OSGLContext.h"
@@ -47,6 +53,43 @@ GCC_DIAG_OFF(unused-but-set-variable) // only on gcc >= 4.6
 
 NATRON_NAMESPACE_ENTER;
 
+#ifdef NATRON_COPY_CHANNELS_USE_SSE2
+
+// SIMD masked copy of a packed RGBA scan-line portion: each component is selected from
+// either the source or the destination with a constant mask, 4 components at once.
+// Only implemented for the float bit-depth, the other depths return false and take the
+// generic code path.
+static bool
+copyUnProcessedChannelsPackedSpan(const unsigned char* /*src*/, unsigned char* /*dst*/, int /*nPixels*/,
+                                  bool /*doR*/, bool /*doG*/, bool /*doB*/, bool /*doA*/)
+{
+    return false;
+}
+
+static bool
+copyUnProcessedChannelsPackedSpan(const unsigned short* /*src*/, unsigned short* /*dst*/, int /*nPixels*/,
+                                  bool /*doR*/, bool /*doG*/, bool /*doB*/, bool /*doA*/)
+{
+    return false;
+}
+
+static bool
+copyUnProcessedChannelsPackedSpan(const float* src, float* dst, int nPixels,
+                                  bool doR, bool doG, bool doB, bool doA)
+{
+    const __m128 mask = _mm_castsi128_ps( _mm_setr_epi32(doR ? -1 : 0, doG ? -1 : 0, doB ? -1 : 0, doA ? -1 : 0) );
+
+    for (int i = 0; i < nPixels; ++i, src += 4, dst += 4) {
+        __m128 s = _mm_loadu_ps(src);
+        __m128 d = _mm_loadu_ps(dst);
+        _mm_storeu_ps( dst, _mm_or_ps( _mm_and_ps(mask, s), _mm_andnot_ps(mask, d) ) );
+    }
+
+    return true;
+}
+
+#endif // NATRON_COPY_CHANNELS_USE_SSE2
+
 template <typename PIX, int maxValue, int srcNComps, int dstNComps, bool doR, bool doG, bool doB, bool doA>
 static ActionRetCodeEnum
 copyUnProcessedChannels_templated(const void* originalImgPtrs[4],
@@ -57,17 +100,11 @@ copyUnProcessedChannels_templated(const void* originalImgPtrs[4],
                                   const EffectInstancePtr& renderClone)
 {
 
-    PIX* dstPixelPtrs[4];
-    int dstPixelStride;
-    Image::getChannelPointers<PIX, dstNComps>((const PIX**)dstImgPtrs, roi.x1, roi.y1, dstBounds, (PIX**)dstPixelPtrs, &dstPixelStride);
-
-    PIX* srcPixelPtrs[4];
-    int srcPixelStride;
-    Image::getChannelPointers<PIX, srcNComps>((const PIX**)originalImgPtrs, roi.x1, roi.y1, originalImgBounds, (PIX**)srcPixelPtrs, &srcPixelStride);
-
-
-    const int dstRowElements = dstPixelStride * dstBounds.width();
-    const int srcRowElements = srcPixelStride * originalImgBounds.width();
+    // Resolve the buffer layouts once for the whole region: scanlines are walked with the iterators
+    Image::ScanlineIterator<PIX> dstIt((const PIX**)dstImgPtrs, roi.x1, roi.y1, dstBounds, dstNComps);
+    Image::ScanlineIterator<PIX> srcIt((const PIX**)originalImgPtrs, roi.x1, roi.y1, originalImgBounds, srcNComps);
+    const int dstPixelStride = dstIt.getPixelStride();
+    const int srcPixelStride = srcIt.getPixelStride();
 
     for ( int y = roi.y1; y < roi.y2; ++y) {
 
@@ -75,6 +112,24 @@ copyUnProcessedChannels_templated(const void* originalImgPtrs[4],
             return eActionStatusAborted;
         }
 
+        PIX* dstPixelPtrs[4];
+        dstIt.pixelsAt(0, dstPixelPtrs);
+        dstIt.nextRow();
+
+        PIX* srcPixelPtrs[4];
+        srcIt.pixelsAt(0, srcPixelPtrs);
+        srcIt.nextRow();
+
+#if defined(NATRON_COPY_CHANNELS_USE_SSE2) && !defined(NATRON_COPY_CHANNELS_UNPREMULT)
+        // In packed RGBA to RGBA mode the copy is a masked move, process the whole scan-line with SSE2
+        if ( (srcNComps == 4) && (dstNComps == 4) && (srcPixelStride == 4) && (dstPixelStride == 4) ) {
+            if ( copyUnProcessedChannelsPackedSpan( srcPixelPtrs[0], dstPixelPtrs[0], roi.width(), doR, doG, doB, doA ) ) {
+                // Go to the next scan-line
+                continue;
+            }
+        }
+#endif
+
         for (int x = roi.x1; x < roi.x2; ++x) {
 
             // be opaque for anything that doesn't contain alpha
@@ -239,16 +294,6 @@ copyUnProcessedChannels_templated(const void* originalImgPtrs[4],
 
         } // for each pixel on a scan-line
 
-        // Remove what was done in the iteration and go to the next scan-line
-        for (int c = 0; c < 4; ++c) {
-            if (srcPixelPtrs[c]) {
-                srcPixelPtrs[c] += (srcRowElements - roi.width() * srcPixelStride);
-            }
-            if (dstPixelPtrs[c]) {
-                dstPixelPtrs[c] += (dstRowElements - roi.width() * dstPixelStride);
-            }
-        }
-        
     } // for each scan-line
     return eActionStatusOK;
 } // copyUnProcessedChannels_templated
@@ -271,18 +316,11 @@ copyUnProcessedChannels_nonTemplated(const void* originalImgPtrs[4],
     const bool doB = !processChannels[2] && (dstNComps >= 3);
     const bool doA = !processChannels[3] && (dstNComps == 1 || dstNComps == 4);
 
-    PIX* dstPixelPtrs[4];
-    int dstPixelStride;
-    Image::getChannelPointers<PIX, dstNComps>((const PIX**)dstImgPtrs, roi.x1, roi.y1, dstBounds, (PIX**)dstPixelPtrs, &dstPixelStride);
-
-    PIX* srcPixelPtrs[4];
-    int srcPixelStride;
-    Image::getChannelPointers<PIX, srcNComps>((const PIX**)originalImgPtrs, roi.x1, roi.y1, originalImgBounds, (PIX**)srcPixelPtrs, &srcPixelStride);
-
-
-    const int dstRowElements = dstPixelStride * dstBounds.width();
-    const int srcRowElements = srcPixelStride * originalImgBounds.width();
-
+    // Resolve the buffer layouts once for the whole region: scanlines are walked with the iterators
+    Image::ScanlineIterator<PIX> dstIt((const PIX**)dstImgPtrs, roi.x1, roi.y1, dstBounds, dstNComps);
+    Image::ScanlineIterator<PIX> srcIt((const PIX**)originalImgPtrs, roi.x1, roi.y1, originalImgBounds, srcNComps);
+    const int dstPixelStride = dstIt.getPixelStride();
+    const int srcPixelStride = srcIt.getPixelStride();
 
     for ( int y = roi.y1; y < roi.y2; ++y) {
 
@@ -290,6 +328,23 @@ copyUnProcessedChannels_nonTemplated(const void* originalImgPtrs[4],
             return eActionStatusAborted;
         }
 
+        PIX* dstPixelPtrs[4];
+        dstIt.pixelsAt(0, dstPixelPtrs);
+        dstIt.nextRow();
+
+        PIX* srcPixelPtrs[4];
+        srcIt.pixelsAt(0, srcPixelPtrs);
+        srcIt.nextRow();
+
+#if defined(NATRON_COPY_CHANNELS_USE_SSE2) && !defined(NATRON_COPY_CHANNELS_UNPREMULT)
+        // In packed RGBA to RGBA mode the copy is a masked move, process the whole scan-line with SSE2
+        if ( (srcNComps == 4) && (dstNComps == 4) && (srcPixelStride == 4) && (dstPixelStride == 4) ) {
+            if ( copyUnProcessedChannelsPackedSpan( srcPixelPtrs[0], dstPixelPtrs[0], roi.width(), doR, doG, doB, doA ) ) {
+                // Go to the next scan-line
+                continue;
+            }
+        }
+#endif
 
         for (int x = roi.x1; x < roi.x2; ++x) {
 
@@ -399,15 +454,6 @@ copyUnProcessedChannels_nonTemplated(const void* originalImgPtrs[4],
             }
         } // for each pixels in a scan-line
 
-        // Remove what was done in the iteration and go to the next scan-line
-        for (int c = 0; c < 4; ++c) {
-            if (srcPixelPtrs[c]) {
-                srcPixelPtrs[c] += (srcRowElements - roi.width() * srcPixelStride);
-            }
-            if (dstPixelPtrs[c]) {
-                dstPixelPtrs[c] += (dstRowElements - roi.width() * dstPixelStride);
-            }
-        }
     } // for each scan-line
     return eActionStatusOK;
 } // copyUnProcessedChannels_nonTemplated
@@ -182,19 +182,15 @@ fillForDepthForComponents(void* ptrs[4],
         nComps == 1 ? a * maxValue : r * maxValue, g * maxValue, b * maxValue, a * maxValue
     };
 
-    int nCompsPerBuffer = nComps;
-    if (nComps > 1 && ptrs[1]) {
-        nCompsPerBuffer = 1;
+    // Quantize the fill color once instead of once per pixel
+    PIX fillValuePix[4];
+    for (int c = 0; c < 4; ++c) {
+        fillValuePix[c] = fillValue[c];
     }
 
-
-    // now we're safe: the image contains the area in roi
-    PIX* dstPixelPtrs[4];
-    int dstPixelStride;
-    Image::getChannelPointers<PIX>((const PIX**)ptrs, roi.x1, roi.y1, bounds, nComps, (PIX**)dstPixelPtrs, &dstPixelStride);
-
-    std::size_t nElementsPerRow = nCompsPerBuffer * dstPixelStride;
-
+    // All rows of the roi are identical: fill the first one per-pixel and replicate it
+    // with memcpy at memory bandwidth.
+    PIX* firstRowPtrs[4] = {0, 0, 0, 0};
 
     for (int y = roi.y1; y < roi.y2; ++y) {
 
@@ -202,17 +198,41 @@ fillForDepthForComponents(void* ptrs[4],
             return eActionStatusAborted;
         }
 
-        for (int x = roi.x1; x < roi.x2; ++x) {
-            for (int c = 0; c < 4; ++c) {
-                if (dstPixelPtrs[c]) {
-                    *dstPixelPtrs[c] = fillValue[c];
-                    dstPixelPtrs[c] += dstPixelStride;
+        PIX* dstPixelPtrs[4];
+        int dstPixelStride;
+        Image::getChannelPointers<PIX>((const PIX**)ptrs, roi.x1, y, bounds, nComps, (PIX**)dstPixelPtrs, &dstPixelStride);
+
+        if (y == roi.y1) {
+            memcpy(firstRowPtrs, dstPixelPtrs, sizeof(PIX*) * 4);
+
+            if (dstPixelStride == nComps) {
+                // Packed: write the color pattern sequentially
+                PIX* p = dstPixelPtrs[0];
+                for (int x = roi.x1; x < roi.x2; ++x) {
+                    for (int c = 0; c < nComps; ++c) {
+                        *p++ = fillValuePix[c];
+                    }
+                }
+            } else {
+                // Coplanar: fill each channel individually
+                for (int c = 0; c < 4; ++c) {
+                    if (dstPixelPtrs[c]) {
+                        PIX* p = dstPixelPtrs[c];
+                        for (int x = roi.x1; x < roi.x2; ++x, p += dstPixelStride) {
+                            *p = fillValuePix[c];
+                        }
+                    }
                 }
             }
-        }
-        for (int c = 0; c < 4; ++c) {
-            if (dstPixelPtrs[c]) {
-                dstPixelPtrs[c] += nElementsPerRow - roi.width() * dstPixelStride;
+        } else {
+            if (dstPixelStride == nComps) {
+                memcpy(dstPixelPtrs[0], firstRowPtrs[0], roi.width() * nComps * sizeof(PIX));
+            } else {
+                for (int c = 0; c < 4; ++c) {
+                    if (dstPixelPtrs[c]) {
+                        memcpy(dstPixelPtrs[c], firstRowPtrs[c], roi.width() * sizeof(PIX));
+                    }
+                }
             }
         }
     }
@@ -24,8 +24,63 @@
 
 #include "ImagePrivate.h"
 
+// SSE2 is part of the x86-64 baseline ABI, use it for the packed RGBA mix below.
+#if defined(__SSE2__) || defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 2 )
+#define NATRON_MASK_MIX_USE_SSE2
+#include <emmintrin.h>
+#endif
+
 NATRON_NAMESPACE_ENTER;
 
+#ifdef NATRON_MASK_MIX_USE_SSE2
+
+// SIMD mix of a packed RGBA scan-line portion: the 4 components of a pixel share the same
+// mix factor, so they are blended in a single vector op. Only implemented for the float
+// bit-depth, the other depths return false and take the generic code path.
+template <bool masked, bool maskInvert>
+static bool
+applyMaskMixPackedSpan(const unsigned char* /*src*/, const unsigned char* /*mask*/, int /*maskStride*/,
+                       unsigned char* /*dst*/, int /*nPixels*/, float /*mix*/)
+{
+    return false;
+}
+
+template <bool masked, bool maskInvert>
+static bool
+applyMaskMixPackedSpan(const unsigned short* /*src*/, const unsigned short* /*mask*/, int /*maskStride*/,
+                       unsigned short* /*dst*/, int /*nPixels*/, float /*mix*/)
+{
+    return false;
+}
+
+template <bool masked, bool maskInvert>
+static bool
+applyMaskMixPackedSpan(const float* src, const float* mask, int maskStride,
+                       float* dst, int nPixels, float mix)
+{
+    const __m128 one = _mm_set1_ps(1.f);
+
+    for (int i = 0; i < nPixels; ++i, src += 4, dst += 4) {
+        float alpha = mix;
+        if (masked) {
+            float maskScale = *mask;
+            if (maskInvert) {
+                maskScale = 1.f - maskScale;
+            }
+            alpha *= maskScale;
+            mask += maskStride;
+        }
+        __m128 alphaV = _mm_set1_ps(alpha);
+        __m128 d = _mm_loadu_ps(dst);
+        __m128 s = _mm_loadu_ps(src);
+        _mm_storeu_ps( dst, _mm_add_ps( _mm_mul_ps(d, alphaV), _mm_mul_ps( s, _mm_sub_ps(one, alphaV) ) ) );
+    }
+
+    return true;
+}
+
+#endif // NATRON_MASK_MIX_USE_SSE2
+
 template<int srcNComps, int dstNComps, typename PIX, int maxValue, bool masked, bool maskInvert>
 static ActionRetCodeEnum
 applyMaskMixForMaskInvert(const void* originalImgPtrs[4],
@@ -39,44 +94,51 @@ applyMaskMixForMaskInvert(const void* originalImgPtrs[4],
                           const EffectInstancePtr& renderClone)
 {
 
-    PIX* dstPixelPtrs[4];
-    int dstPixelStride;
-    Image::getChannelPointers<PIX, dstNComps>((const PIX**)dstImgPtrs, roi.x1, roi.y1, bounds, (PIX**)dstPixelPtrs, &dstPixelStride);
+    // Resolve the buffer layouts once for the whole region: scanlines are walked with the iterators
+    Image::ScanlineIterator<PIX> srcIt((const PIX**)originalImgPtrs, roi.x1, roi.y1, originalImgBounds, srcNComps);
+    Image::ScanlineIterator<PIX> dstIt((const PIX**)dstImgPtrs, roi.x1, roi.y1, bounds, dstNComps);
+    const int srcPixelStride = srcIt.getPixelStride();
+    const int dstPixelStride = dstIt.getPixelStride();
 
-    const std::size_t dstRowElements = (std::size_t)bounds.width() * dstPixelStride;
+    // When not masked the mask pointers are all NULL and the iterator is a no-op
+    Image::ScanlineIterator<PIX> maskIt((const PIX**)maskImgPtrs, roi.x1, roi.y1, maskImgBounds, 1);
+    const int maskPixelStride = masked ? maskIt.getPixelStride() : 0;
 
     for ( int y = roi.y1; y < roi.y2; ++y) {
 
         if (renderClone && renderClone->isRenderAborted()) {
             return eActionStatusAborted;
         }
-        for (int x = roi.x1; x < roi.x2; ++x) {
 
-            PIX* srcPixelPtrs[4];
-            int srcPixelStride;
-            Image::getChannelPointers<PIX, srcNComps>((const PIX**)originalImgPtrs, roi.x1, roi.y1, originalImgBounds, (PIX**)srcPixelPtrs, &srcPixelStride);
+        PIX* srcPixelPtrs[4];
+        srcIt.pixelsAt(0, srcPixelPtrs);
+        srcIt.nextRow();
 
-            float maskScale = 1.f;
-            if (!masked) {
-                // just mix
-                float alpha = mix;
-                for (int c = 0; c < dstNComps; ++c) {
-                    if (srcPixelPtrs[c]) {
-                        float dstF = Image::convertPixelDepth<PIX, float>(*dstPixelPtrs[c]);
-                        float srcF = Image::convertPixelDepth<PIX, float>(*srcPixelPtrs[c]);
-                        float v = dstF * alpha + (1.f - alpha) * srcF;
-                        *dstPixelPtrs[c] = Image::convertPixelDepth<float, PIX>(v);
-
-                        dstPixelPtrs[c] += dstPixelStride;
-                        srcPixelPtrs[c] += srcPixelStride;
-                    }
-                }
-            } else {
+        PIX* maskPixelPtrs[4] = {0, 0, 0, 0};
+        if (masked) {
+            maskIt.pixelsAt(0, maskPixelPtrs);
+            maskIt.nextRow();
+        }
+
+        PIX* dstPixelPtrs[4];
+        dstIt.pixelsAt(0, dstPixelPtrs);
+        dstIt.nextRow();
+
+#ifdef NATRON_MASK_MIX_USE_SSE2
+        // In packed RGBA mode the mix is the same vector op for all components, process the
+        // whole scan-line with SSE2
+        if ( (srcNComps == 4) && (dstNComps == 4) && (srcPixelStride == 4) && (dstPixelStride == 4) &&
+             ( !masked || maskPixelPtrs[0] ) ) {
+            if ( applyMaskMixPackedSpan<masked, maskInvert>( srcPixelPtrs[0], maskPixelPtrs[0], maskPixelStride, dstPixelPtrs[0], roi.width(), (float)mix ) ) {
+                continue;
+            }
+        }
+#endif
 
-                PIX* maskPixelPtrs[4];
-                int maskPixelStride;
-                Image::getChannelPointers<PIX, 1>((const PIX**)maskImgPtrs, roi.x1, roi.y1, maskImgBounds, (PIX**)maskPixelPtrs, &maskPixelStride);
+        for (int x = roi.x1; x < roi.x2; ++x) {
 
+            float maskScale = 1.f;
+            if (masked) {
                 // figure the scale factor from that pixel
                 if (maskPixelPtrs[0] == 0) {
                     maskScale = maskInvert ? 1.f : 0.f;
@@ -85,25 +147,25 @@ applyMaskMixForMaskInvert(const void* originalImgPtrs[4],
                     if (maskInvert) {
                         maskScale = 1.f - maskScale;
                     }
+                    maskPixelPtrs[0] += maskPixelStride;
                 }
-                float alpha = mix * maskScale;
-                for (int c = 0; c < dstNComps; ++c) {
-                    if (srcPixelPtrs[c]) {
-                        float dstF = Image::convertPixelDepth<PIX, float>(*dstPixelPtrs[c]);
-                        float srcF = Image::convertPixelDepth<PIX, float>(*srcPixelPtrs[c]);
-                        float v = dstF * alpha + (1.f - alpha) * srcF;
-                        *dstPixelPtrs[c] = Image::convertPixelDepth<float, PIX>(v);
-
-                        dstPixelPtrs[c] += dstPixelStride;
-                        srcPixelPtrs[c] += srcPixelStride;
-                        maskPixelPtrs[c] += maskPixelStride;
-                    }
+            }
+            float alpha = mix * maskScale;
+
+            for (int c = 0; c < dstNComps; ++c) {
+                if (srcPixelPtrs[c]) {
+                    float dstF = Image::convertPixelDepth<PIX, float>(*dstPixelPtrs[c]);
+                    float srcF = Image::convertPixelDepth<PIX, float>(*srcPixelPtrs[c]);
+                    float v = dstF * alpha + (1.f - alpha) * srcF;
+                    *dstPixelPtrs[c] = Image::convertPixelDepth<float, PIX>(v);
+
+                    srcPixelPtrs[c] += srcPixelStride;
+                }
+                if (dstPixelPtrs[c]) {
+                    dstPixelPtrs[c] += dstPixelStride;
                 }
             }
         }
-        for (int c = 0; c < dstNComps; ++c) {
-            dstPixelPtrs[c] += (dstRowElements - roi.width() * dstPixelStride);
-        }
     }
     return eActionStatusOK;
 } // applyMaskMixForMaskInvert
@@ -25,8 +25,12 @@
 
 #include "ImagePrivate.h"
 
+#include <algorithm>
+
 #include "Engine/Hash64.h"
+#include "Engine/ImageSamplingKernels.h"
 #include "Engine/Node.h"
+#include "Engine/TreeRender.h"
 #include <QDebug>
 #include <QThread>
 
@@ -102,9 +106,10 @@ ImagePrivate::initAndFetchFromCache(const Image::InitStorageArgs& args)
 
 
     EffectInstancePtr effect = renderClone.lock();
-    std::string pluginID;
+    std::string pluginID, nodeName;
     if (effect) {
         pluginID = effect->getNode()->getPluginID();
+        nodeName = effect->getNode()->getFullyQualifiedName();
     }
 
 
@@ -136,6 +141,16 @@ ImagePrivate::initAndFetchFromCache(const Image::InitStorageArgs& args)
                     } else {
                         a->numComponents = 1;
                     }
+
+                    // Temporary images that are not to be cached are allocated from the
+                    // per-render arena: buffers of cached images are adopted by the cache
+                    // and may outlive the render by far.
+                    if (cachePolicy == eCacheAccessModeNone && effect) {
+                        TreeRenderPtr render = effect->getCurrentRender();
+                        if (render) {
+                            a->arena = render->getImageArena();
+                        }
+                    }
                     allocArgs = a;
                 }   break;
                 case eStorageModeNone:
@@ -143,6 +158,12 @@ ImagePrivate::initAndFetchFromCache(const Image::InitStorageArgs& args)
             }
             assert(allocArgs && channels[c]);
 
+            // Attribute the buffer to the node being rendered, whether the allocation
+            // happens now or is delayed.
+            if (effect) {
+                channels[c]->setMemoryAttribution(nodeName, pluginID);
+            }
+
             if (tilesAllocated) {
                 // Allocate the memory for the tile.
                 // This may throw a std::bad_alloc
@@ -356,6 +377,13 @@ halveImageForInternal(const void* srcPtrs[4],
     const int dstRowElementsCount = dstBounds.width() * dstPixelStride;
     const int srcRowElementsCount = srcBounds.width() * srcPixelStride;
 
+    // The span of dst columns for which the 4 source taps are all within srcBounds: border
+    // checks are only needed outside of it, the interior goes through the branch-free
+    // ImageSamplingKernels. Shifts instead of divisions so the rounding is correct for
+    // negative bounds too: x1 is rounded up (a dst col needs src col x*2 >= srcBounds.x1),
+    // x2 is rounded down (it needs src col x*2+1 < srcBounds.x2).
+    const int interiorX1 = std::max( dstBounds.x1, (srcBounds.x1 >> 1) + (srcBounds.x1 & 1) );
+    const int interiorX2 = std::min( dstBounds.x2, srcBounds.x2 >> 1 );
 
     for (int y = dstBounds.y1; y < dstBounds.y2; ++y) {
 
@@ -375,6 +403,32 @@ halveImageForInternal(const void* srcPtrs[4],
 
         for (int x = dstBounds.x1; x < dstBounds.x2; ++x) {
 
+            // Take the un-checked kernels over the interior span when both rows are picked.
+            if ( (x == interiorX1) && (interiorX2 > interiorX1) && pickThisRow && pickNextRow ) {
+
+                const int nPixels = interiorX2 - interiorX1;
+
+                bool done = false;
+#ifdef NATRON_IMAGE_SAMPLING_USE_SSE2
+                // For a packed buffer the channel pointers are contiguous: average the 4
+                // components of a pixel in a single vector op.
+                if ( (nComps == 4) && (srcPixelStride == 4) && (dstPixelStride == 4) &&
+                     (srcPixelPtrs[1] == srcPixelPtrs[0] + 1) && (dstPixelPtrs[1] == dstPixelPtrs[0] + 1) ) {
+                    done = ImageSamplingKernels::halveScanlineInteriorPacked(srcPixelPtrs[0], srcPixelPtrs[0] + srcRowElementsCount, dstPixelPtrs[0], nPixels);
+                }
+#endif
+                if (!done) {
+                    ImageSamplingKernels::halveScanlineInterior<PIX, nComps>(srcPixelPtrs, srcPixelStride, srcRowElementsCount, dstPixelPtrs, dstPixelStride, nPixels);
+                }
+
+                for (int k = 0; k < nComps; ++k) {
+                    srcPixelPtrs[k] += srcPixelStride * 2 * nPixels;
+                    dstPixelPtrs[k] += dstPixelStride * nPixels;
+                }
+                x += nPixels - 1;
+                continue;
+            }
+
             // The current dst col, at y, covers the src cols x*2 (thisCol) and x*2+1 (nextCol).
             const int srcx = x * 2;
 
@@ -166,11 +166,16 @@ struct ImagePrivate
      *
      * @param requiresUnpremult If true, if a component conversion from RGBA to RGB happens
      * the RGB channels will be divided by the alpha channel when copied to the output image
+     *
+     * @param requiresPremult If true, if the output image has an alpha channel the RGB
+     * channels will be multiplied by the alpha channel in the same pass, after the
+     * conversion to linear
      **/
     static ActionRetCodeEnum convertCPUImage(const RectI & renderWindow,
                                              ViewerColorSpaceEnum srcColorSpace,
                                              ViewerColorSpaceEnum dstColorSpace,
                                              bool requiresUnpremult,
+                                             bool requiresPremult,
                                              int conversionChannel,
                                              Image::AlphaChannelHandlingEnum alphaHandling,
                                              Image::MonoToPackedConversionEnum monoConversion,
@@ -259,6 +264,21 @@ struct ImagePrivate
                               const RectI& roi,
                               const OSGLContextPtr& glContext);
 
+    /**
+     * @brief Converts the RGB channels of a texture from srcColorSpace to dstColorSpace on the
+     * GPU (or through OSMesa), using the analytic transfer functions of the Color::Lut code so
+     * the result does not depend on driver texture filtering, i.e: it is deterministic.
+     * Callers without a context at hand should request one with
+     * GPUContextPool::getIdleOpenGLContext() and fall back to the Lut-based CPU conversion when
+     * it returns NULL because the pool is saturated.
+     **/
+    static ActionRetCodeEnum convertGLTextureColorspace(const GLTexturePtr& from,
+                                                        const GLTexturePtr& to,
+                                                        ViewerColorSpaceEnum srcColorSpace,
+                                                        ViewerColorSpaceEnum dstColorSpace,
+                                                        const RectI& roi,
+                                                        const OSGLContextPtr& glContext);
+
 
     static ActionRetCodeEnum convertRGBAPackedCPUBufferToGLTexture(const float* srcData,
                                                                    const RectI& srcBounds,
@@ -0,0 +1,129 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2013-2017 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef IMAGESAMPLINGKERNELS_H
+#define IMAGESAMPLINGKERNELS_H
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+// SSE2 is part of the x86-64 baseline ABI, use it for the packed RGBA kernels below.
+#if defined(__SSE2__) || defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 2 )
+#define NATRON_IMAGE_SAMPLING_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+#include "Global/GlobalDefines.h"
+
+#include "Engine/EngineFwd.h"
+
+NATRON_NAMESPACE_ENTER;
+
+/**
+ * @brief Scanline resampling kernels shared by the image scaling code paths, e.g: the
+ * mipmap downscale of Image. Border handling is resolved by the caller: the spans for
+ * which all source taps are within bounds go through the branch-free kernels below,
+ * which the compiler can vectorize (or the SSE2 specializations for packed RGBA float),
+ * while the border pixels take the caller's checked scalar path.
+ **/
+class ImageSamplingKernels
+{
+public:
+
+    ImageSamplingKernels();
+
+/**
+ * @brief 2x2 box average of a scanline span: dst[x] = average of the 4 source pixels
+ * covered, i.e: columns x*2 and x*2+1 of the two given source rows. All taps must be
+ * within the source bounds, which the caller guarantees: the loop is free of border
+ * checks.
+ **/
+template <typename PIX, int nComps>
+static void halveScanlineInterior(const PIX* const srcPixelPtrs[4],
+                                  int srcPixelStride,
+                                  int srcRowElements,
+                                  PIX* const dstPixelPtrs[4],
+                                  int dstPixelStride,
+                                  int nPixels)
+{
+    for (int k = 0; k < nComps; ++k) {
+        const PIX* src = srcPixelPtrs[k];
+        PIX* dst = dstPixelPtrs[k];
+        for (int x = 0; x < nPixels; ++x) {
+            const PIX a = *src;
+            const PIX b = *(src + srcPixelStride);
+            const PIX c = *(src + srcRowElements);
+            const PIX d = *(src + srcRowElements + srcPixelStride);
+            *dst = (a + b + c + d) / 4;
+            src += srcPixelStride * 2;
+            dst += dstPixelStride;
+        }
+    }
+} // halveScanlineInterior
+
+#ifdef NATRON_IMAGE_SAMPLING_USE_SSE2
+
+/**
+ * @brief SIMD version of halveScanlineInterior for packed pixels: the 4 components of
+ * a destination pixel are averaged in a single vector op. Only implemented for the
+ * float bit-depth, the other depths return false and take the generic kernel.
+ **/
+static bool halveScanlineInteriorPacked(const unsigned char* /*srcThisRow*/,
+                                        const unsigned char* /*srcNextRow*/,
+                                        unsigned char* /*dst*/,
+                                        int /*nPixels*/)
+{
+    return false;
+}
+
+static bool halveScanlineInteriorPacked(const unsigned short* /*srcThisRow*/,
+                                        const unsigned short* /*srcNextRow*/,
+                                        unsigned short* /*dst*/,
+                                        int /*nPixels*/)
+{
+    return false;
+}
+
+static bool halveScanlineInteriorPacked(const float* srcThisRow,
+                                        const float* srcNextRow,
+                                        float* dst,
+                                        int nPixels)
+{
+    const __m128 quarter = _mm_set1_ps(0.25f);
+
+    for (int x = 0; x < nPixels; ++x, srcThisRow += 8, srcNextRow += 8, dst += 4) {
+        __m128 a = _mm_loadu_ps(srcThisRow);
+        __m128 b = _mm_loadu_ps(srcThisRow + 4);
+        __m128 c = _mm_loadu_ps(srcNextRow);
+        __m128 d = _mm_loadu_ps(srcNextRow + 4);
+        _mm_storeu_ps( dst, _mm_mul_ps( _mm_add_ps( _mm_add_ps(a, b), _mm_add_ps(c, d) ), quarter ) );
+    }
+
+    return true;
+}
+
+#endif // NATRON_IMAGE_SAMPLING_USE_SSE2
+
+};
+
+NATRON_NAMESPACE_EXIT;
+
+#endif // IMAGESAMPLINGKERNELS_H
@@ -25,19 +25,88 @@
 
 #include "ImageStorage.h"
 
+#include <algorithm>
+#include <sstream> // stringstream
+#include <vector>
+
 #include <QMutex>
 #include <QThread>
 #include <QCoreApplication>
 
 #include "Engine/AppManager.h"
 #include "Engine/Cache.h"
+#include "Engine/MemoryInfo.h" // printAsRAM
 #include "Engine/OSGLContext.h"
 #include "Engine/RamBuffer.h"
+#include "Engine/RenderImageArena.h"
 #include "Engine/Texture.h"
 
 
 NATRON_NAMESPACE_ENTER;
 
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+// Process-wide record of the live bytes allocated by each node, maintained by
+// ImageStorageBase::allocateMemory()/deallocateMemory()
+struct MemoryAttributionRegistry
+{
+    QMutex lock;
+    std::map<std::string, MemoryAttributionInfo> infos;
+
+    MemoryAttributionRegistry()
+    : lock()
+    , infos()
+    {
+    }
+};
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+static MemoryAttributionRegistry&
+getMemoryAttributionRegistry()
+{
+    static MemoryAttributionRegistry registry;
+
+    return registry;
+}
+
+static void
+registerAttributedBytes(const std::string& nodeName,
+                        const std::string& pluginID,
+                        std::size_t nBytes)
+{
+    MemoryAttributionRegistry& registry = getMemoryAttributionRegistry();
+    QMutexLocker k(&registry.lock);
+    MemoryAttributionInfo& info = registry.infos[nodeName.empty() ? NATRON_MEMORY_ATTRIBUTION_UNTAGGED_NAME : nodeName];
+
+    info.pluginID = pluginID;
+    info.nBytes += nBytes;
+    info.nBuffers += 1;
+}
+
+static void
+unregisterAttributedBytes(const std::string& nodeName,
+                          std::size_t nBytes)
+{
+    MemoryAttributionRegistry& registry = getMemoryAttributionRegistry();
+    QMutexLocker k(&registry.lock);
+    std::map<std::string, MemoryAttributionInfo>::iterator found = registry.infos.find(nodeName.empty() ? NATRON_MEMORY_ATTRIBUTION_UNTAGGED_NAME : nodeName);
+
+    if ( found == registry.infos.end() ) {
+        assert(false);
+
+        return;
+    }
+    assert(found->second.nBytes >= nBytes && found->second.nBuffers >= 1);
+    found->second.nBytes -= nBytes;
+    found->second.nBuffers -= 1;
+
+    // Remove nodes that no longer hold any buffer so that a stale entry in the map
+    // always designates live memory.
+    if (found->second.nBuffers == 0) {
+        registry.infos.erase(found);
+    }
+}
 
 struct ImageStorageBasePrivate
 {
@@ -46,11 +115,22 @@ struct ImageStorageBasePrivate
     ImageBitDepthEnum bitdepth;
     boost::shared_ptr<AllocateMemoryArgs> allocArgs;
 
+    // The node on behalf of which the memory is allocated, see setMemoryAttribution()
+    std::string attributionNodeName;
+    std::string attributionPluginID;
+
+    // The amount of bytes recorded in the attribution registry for this storage, so that
+    // exactly what was registered gets unregistered even if getBufferSize() changes.
+    std::size_t attributedBytes;
+
     ImageStorageBasePrivate()
     : allocated(false)
     , allocatedLock()
     , bitdepth()
     , allocArgs()
+    , attributionNodeName()
+    , attributionPluginID()
+    , attributedBytes(0)
     {
 
     }
@@ -64,9 +144,103 @@ ImageStorageBase::ImageStorageBase()
 
 ImageStorageBase::~ImageStorageBase()
 {
+    // Sub-classes release their buffer in their own destructor without going through
+    // deallocateMemory(): make sure the attributed bytes do not outlive the storage.
+    if (_imp->attributedBytes > 0) {
+        unregisterAttributedBytes(_imp->attributionNodeName, _imp->attributedBytes);
+    }
+}
+
+void
+ImageStorageBase::setMemoryAttribution(const std::string& nodeName,
+                                       const std::string& pluginID)
+{
+    QMutexLocker k(&_imp->allocatedLock);
+
+    if (_imp->attributedBytes > 0) {
+        // Already accounted for: move the bytes to the new node
+        unregisterAttributedBytes(_imp->attributionNodeName, _imp->attributedBytes);
+        registerAttributedBytes(nodeName, pluginID, _imp->attributedBytes);
+    }
+    _imp->attributionNodeName = nodeName;
+    _imp->attributionPluginID = pluginID;
+}
+
+std::string
+ImageStorageBase::getMemoryAttributionPluginID() const
+{
+    QMutexLocker k(&_imp->allocatedLock);
 
+    return _imp->attributionPluginID;
 }
 
+void
+ImageStorageBase::getMemoryAttribution(std::map<std::string, MemoryAttributionInfo>* attribution)
+{
+    MemoryAttributionRegistry& registry = getMemoryAttributionRegistry();
+    QMutexLocker k(&registry.lock);
+
+    *attribution = registry.infos;
+}
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+struct MemoryAttributionRow
+{
+    std::string nodeName;
+    MemoryAttributionInfo info;
+};
+
+struct MemoryAttributionRow_CompareDecreasingBytes
+{
+    bool operator() (const MemoryAttributionRow& lhs,
+                     const MemoryAttributionRow& rhs) const
+    {
+        return lhs.info.nBytes > rhs.info.nBytes;
+    }
+};
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+std::string
+ImageStorageBase::dumpMemoryAttribution()
+{
+    std::map<std::string, MemoryAttributionInfo> attribution;
+
+    getMemoryAttribution(&attribution);
+
+    std::vector<MemoryAttributionRow> rows;
+    rows.reserve( attribution.size() );
+    for (std::map<std::string, MemoryAttributionInfo>::const_iterator it = attribution.begin(); it != attribution.end(); ++it) {
+        MemoryAttributionRow row;
+        row.nodeName = it->first;
+        row.info = it->second;
+        rows.push_back(row);
+    }
+    std::sort( rows.begin(), rows.end(), MemoryAttributionRow_CompareDecreasingBytes() );
+
+    std::stringstream finalStream;
+
+    finalStream << "Image memory per node:" << std::endl;
+    finalStream << "_______________________________________________________________________________________" << std::endl;
+    finalStream << "| Memory       | Buffers      | Node (Plug-in)" << std::endl;
+    finalStream << "_______________________________________________________________________________________" << std::endl;
+
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+        finalStream << "  " <<
+        printAsRAM(rows[i].info.nBytes).toStdString() << "\t\t" <<
+        rows[i].info.nBuffers << "\t\t" <<
+        rows[i].nodeName;
+        if ( !rows[i].info.pluginID.empty() ) {
+            finalStream << " (" << rows[i].info.pluginID << ")";
+        }
+        finalStream << std::endl;
+        finalStream << "_______________________________________________________________________________________" <<  std::endl;
+    }
+
+    return finalStream.str();
+} // dumpMemoryAttribution
+
 ImageBitDepthEnum
 ImageStorageBase::getBitDepth() const
 {
@@ -127,9 +301,13 @@ ImageStorageBase::allocateMemory(const AllocateMemoryArgs& args)
     _imp->bitdepth = args.bitDepth;
     allocateMemoryImpl(args);
 
+    std::size_t allocatedBytes = getBufferSize();
+
     {
         QMutexLocker k(&_imp->allocatedLock);
         _imp->allocated = true;
+        _imp->attributedBytes = allocatedBytes;
+        registerAttributedBytes(_imp->attributionNodeName, _imp->attributionPluginID, allocatedBytes);
     }
 
 }
@@ -144,6 +322,14 @@ ImageStorageBase::deallocateMemory()
 
     deallocateMemoryImpl();
 
+    {
+        QMutexLocker k(&_imp->allocatedLock);
+        if (_imp->attributedBytes > 0) {
+            unregisterAttributedBytes(_imp->attributionNodeName, _imp->attributedBytes);
+            _imp->attributedBytes = 0;
+        }
+    }
+
 }
 
 
@@ -151,9 +337,15 @@ ImageStorageBase::deallocateMemory()
 struct RAMImageStoragePrivate
 {
 
-    // Set if externalBuffer is not set
+    // Set if externalBuffer and arena are not set
     boost::scoped_ptr<RamBuffer<char> > buffer;
 
+    // Set if the buffer was allocated from a per-render arena. The arena reference
+    // keeps the slabs alive for as long as this storage is.
+    RenderImageArenaPtr arena;
+    char* arenaBuffer;
+    std::size_t arenaBufferSize;
+
     // Set if buffer is not set
     void* externalBuffer;
     std::size_t externalBufferSize;
@@ -166,6 +358,9 @@ struct RAMImageStoragePrivate
 
     RAMImageStoragePrivate()
     : buffer()
+    , arena()
+    , arenaBuffer(0)
+    , arenaBufferSize(0)
     , externalBuffer(0)
     , externalBufferSize(0)
     , externalBufferFreeFunc(0)
@@ -187,7 +382,10 @@ RAMImageStorage::RAMImageStorage()
 
 RAMImageStorage::~RAMImageStorage()
 {
-
+    if (_imp->arenaBuffer) {
+        // Hand the buffer back to the arena free-list so it can be recycled
+        _imp->arena->release(_imp->arenaBuffer);
+    }
 }
 
 RectI
@@ -219,6 +417,8 @@ RAMImageStorage::getBufferSize() const
 {
     if (_imp->buffer) {
         return _imp->buffer->size();
+    } else if (_imp->arenaBuffer) {
+        return _imp->arenaBufferSize;
     } else if (_imp->externalBuffer) {
         return _imp->externalBufferSize;
     } else {
@@ -232,6 +432,8 @@ RAMImageStorage::getData() const
 {
     if (_imp->buffer) {
         return _imp->buffer->getData();
+    } else if (_imp->arenaBuffer) {
+        return _imp->arenaBuffer;
     } else if (_imp->externalBuffer) {
         return (const char*)_imp->externalBuffer;
     } else {
@@ -244,6 +446,8 @@ RAMImageStorage::getData()
 {
     if (_imp->buffer) {
         return _imp->buffer->getData();
+    } else if (_imp->arenaBuffer) {
+        return _imp->arenaBuffer;
     } else if (_imp->externalBuffer) {
         return (char*)_imp->externalBuffer;
     } else {
@@ -271,13 +475,19 @@ RAMImageStorage::allocateMemoryImpl(const AllocateMemoryArgs& args)
     assert(!_imp->externalBuffer || _imp->externalBufferFreeFunc);
 
     if (!_imp->externalBuffer) {
-        _imp->buffer.reset(new RamBuffer<char>);
         std::size_t nBytes = getSizeOfForBitDepth(_imp->bitDepth) * _imp->numComps;
 
         nBytes *= ramArgs->bounds.width();
         nBytes *= ramArgs->bounds.height();
 
-        _imp->buffer->resize(nBytes);
+        if (ramArgs->arena) {
+            _imp->arena = ramArgs->arena;
+            _imp->arenaBuffer = (char*)_imp->arena->allocate(nBytes);
+            _imp->arenaBufferSize = nBytes;
+        } else {
+            _imp->buffer.reset(new RamBuffer<char>);
+            _imp->buffer->resize(nBytes);
+        }
     }
 }
 
@@ -286,6 +496,11 @@ RAMImageStorage::deallocateMemoryImpl()
 {
     if (_imp->buffer) {
         _imp->buffer.reset();
+    } else if (_imp->arenaBuffer) {
+        _imp->arena->release(_imp->arenaBuffer);
+        _imp->arenaBuffer = 0;
+        _imp->arenaBufferSize = 0;
+        _imp->arena.reset();
     } else if (_imp->externalBuffer) {
         if (_imp->externalBufferFreeFunc) {
             // Call the user provided delete func
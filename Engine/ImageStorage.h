@@ -27,6 +27,9 @@
 
 #include "Global/Macros.h"
 
+#include <map>
+#include <string>
+
 #include "Global/GlobalDefines.h"
 
 #include "Engine/CacheEntryBase.h"
@@ -35,6 +38,31 @@
 
 NATRON_NAMESPACE_ENTER;
 
+// Storage that was never tagged with setMemoryAttribution() is aggregated under this name
+#define NATRON_MEMORY_ATTRIBUTION_UNTAGGED_NAME "<untagged>"
+
+/**
+ * @brief Live memory figures attributed to one node, see ImageStorageBase::getMemoryAttribution()
+ **/
+struct MemoryAttributionInfo
+{
+    // The ID of the plug-in held by the node
+    std::string pluginID;
+
+    // Bytes currently allocated on behalf of the node
+    unsigned long long nBytes;
+
+    // Number of live buffers holding those bytes
+    unsigned long long nBuffers;
+
+    MemoryAttributionInfo()
+    : pluginID()
+    , nBytes(0)
+    , nBuffers(0)
+    {
+    }
+};
+
 
 /**
  * @brief Sub-class this class to pass custom args to the allocateMemory() function of
@@ -97,6 +125,32 @@ public:
      **/
     bool isAllocated() const;
 
+    /**
+     * @brief Tag this storage with the node on behalf of which it is allocated so that its
+     * bytes show up in getMemoryAttribution(). May be called before or after the memory is
+     * allocated: bytes already accounted for are moved to the new node.
+     * Untagged storage is aggregated under a single generic entry.
+     **/
+    void setMemoryAttribution(const std::string& nodeName, const std::string& pluginID);
+
+    /**
+     * @brief The ID of the plug-in set by setMemoryAttribution(), empty if untagged.
+     **/
+    std::string getMemoryAttributionPluginID() const;
+
+    /**
+     * @brief Returns the live bytes currently allocated by all storage instances, keyed by
+     * the fully qualified name of the owning node. Nodes whose buffers have all been freed
+     * are removed from the map: an entry that keeps growing across renders is a leak.
+     **/
+    static void getMemoryAttribution(std::map<std::string, MemoryAttributionInfo>* attribution);
+
+    /**
+     * @brief Returns the memory attribution formatted as a plain text table, sorted by
+     * decreasing byte count. This is what the Python function dumpMemoryAttribution() returns.
+     **/
+    static std::string dumpMemoryAttribution();
+
     /**
      * @brief Set arguments to be passed to allocateMemory() later on.
      * Once allocateMemoryFromSetArgs the arguments will be removed.
@@ -190,6 +244,12 @@ public:
     // When allocating an image that is not to be in the cache, this is the number of packed components (e.g: RGB) to allocate the buffer for
     std::size_t numComponents;
 
+    // If set, the buffer is allocated from (and released to) this per-render arena
+    // instead of the general heap. The storage keeps a reference on the arena so the
+    // buffer stays valid even if the render finishes first.
+    // Ignored if externalBuffer is set.
+    RenderImageArenaPtr arena;
+
     // This is possible to create a RAMImageStorage above an existing buffer. This enable caching of external data
     // If not set, a buffer covering the area of the bounds time the num components and the bitdepth will be allocated.
     void* externalBuffer;
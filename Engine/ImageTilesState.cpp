@@ -269,12 +269,16 @@ ImageTilesState::getMinimalBboxToRenderFromTilesState(const RectI& roi, const Ti
 } // getMinimalBboxToRenderFromTilesState
 
 void
-ImageTilesState::getMinimalRectsToRenderFromTilesState(const RectI& roi, const TileStateHeader& stateMap, std::list<RectI>* rectsToRender)
+ImageTilesState::getMinimalRectsToRenderFromTilesState(const RectI& roi, const TileStateHeader& stateMap, std::vector<RectI>* rectsToRender)
 {
     if (stateMap.state->tiles.empty()) {
         return;
     }
 
+    // The rectangles found below (at most 5), before they are clipped to the roi and coalesced
+    std::vector<RectI> foundRects;
+    foundRects.reserve(5);
+
     // The roi must be rounded to the tile size and clipped the pixel RoD
     assert(roi.x1 % stateMap.tileSizeX == 0 || roi.x1 == stateMap.state->bounds.x1);
     assert(roi.y1 % stateMap.tileSizeY == 0 || roi.y1 == stateMap.state->bounds.y1);
@@ -333,10 +337,7 @@ ImageTilesState::getMinimalRectsToRenderFromTilesState(const RectI& roi, const T
         }
     }
     if ( !bboxA.isNull() ) { // empty boxes should not be pushed
-        // Ensure the bbox lies in the RoI since we rounded to tile size earlier
-        RectI bboxAIntersected;
-        bboxA.intersect(roi, &bboxAIntersected);
-        rectsToRender->push_back(bboxAIntersected);
+        foundRects.push_back(bboxA);
     }
 
     // Now, find the "B" rectangle
@@ -363,10 +364,7 @@ ImageTilesState::getMinimalRectsToRenderFromTilesState(const RectI& roi, const T
     }
 
     if ( !bboxB.isNull() ) { // empty boxes should not be pushed
-        // Ensure the bbox lies in the RoI since we rounded to tile size earlier
-        RectI bboxBIntersected;
-        bboxB.intersect(roi, &bboxBIntersected);
-        rectsToRender->push_back(bboxBIntersected);
+        foundRects.push_back(bboxB);
     }
 
     //find left
@@ -393,10 +391,7 @@ ImageTilesState::getMinimalRectsToRenderFromTilesState(const RectI& roi, const T
         }
     }
     if ( !bboxC.isNull() ) { // empty boxes should not be pushed
-        // Ensure the bbox lies in the RoI since we rounded to tile size earlier
-        RectI bboxCIntersected;
-        bboxC.intersect(roi, &bboxCIntersected);
-        rectsToRender->push_back(bboxCIntersected);
+        foundRects.push_back(bboxC);
     }
 
     //find right
@@ -422,10 +417,7 @@ ImageTilesState::getMinimalRectsToRenderFromTilesState(const RectI& roi, const T
         }
     }
     if ( !bboxD.isNull() ) { // empty boxes should not be pushed
-        // Ensure the bbox lies in the RoI since we rounded to tile size earlier
-        RectI bboxDIntersected;
-        bboxD.intersect(roi, &bboxDIntersected);
-        rectsToRender->push_back(bboxDIntersected);
+        foundRects.push_back(bboxD);
     }
 
     assert( bboxA.bottom() == bboxM.bottom() );
@@ -452,12 +444,17 @@ ImageTilesState::getMinimalRectsToRenderFromTilesState(const RectI& roi, const T
     bboxX = getMinimalBboxToRenderFromTilesState(bboxX, stateMap);
 
     if ( !bboxX.isNull() ) { // empty boxes should not be pushed
-        // Ensure the bbox lies in the RoI since we rounded to tile size earlier
-        RectI bboxXIntersected;
-        bboxX.intersect(roi, &bboxXIntersected);
-        rectsToRender->push_back(bboxXIntersected);
+        foundRects.push_back(bboxX);
     }
-    
+
+    // Ensure the bboxes lie in the RoI since we rounded to tile size earlier, then
+    // merge back adjacent rectangles (e.g. when A and X span the same columns) so
+    // that the caller issues as few renders as possible.
+    RectI::intersectMany(roi, &foundRects);
+    RectI::coalesceAdjacent(&foundRects);
+
+    rectsToRender->insert( rectsToRender->end(), foundRects.begin(), foundRects.end() );
+
 } // getMinimalRectsToRenderFromTilesState
 
 
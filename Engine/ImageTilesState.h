@@ -193,8 +193,11 @@ public:
      * CXXXXXXXXXXDDD
      * CXXXXXXXXXXDDD
      * AAAAAAAAAAAAAA
+     *
+     * The rectangles are appended clipped to the roi and coalesced with
+     * RectI::coalesceAdjacent so the caller issues as few renders as possible.
      **/
-    static void getMinimalRectsToRenderFromTilesState(const RectI& roi, const TileStateHeader& stateMap, std::list<RectI>* rectsToRender);
+    static void getMinimalRectsToRenderFromTilesState(const RectI& roi, const TileStateHeader& stateMap, std::vector<RectI>* rectsToRender);
 
     /*
      Compute the rectangles (A,B,C,D) where to set the image to 0
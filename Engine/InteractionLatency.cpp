@@ -0,0 +1,207 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2013-2017 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "InteractionLatency.h"
+
+#include <algorithm> // sort
+#include <cassert>
+#include <map>
+#include <vector>
+
+#include <QtCore/QMutex>
+
+#include "Engine/Timer.h"
+
+NATRON_NAMESPACE_ENTER;
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+// Size of the sliding window the percentiles are computed from. At a typical
+// interactive rate this covers the last few minutes of work.
+#define NATRON_INTERACTION_LATENCY_WINDOW_SIZE 512
+
+// Interactions still waiting for a frame beyond this count are dropped: they were
+// superseded long ago (e.g: edits whilst the viewer was paused) and would only grow
+// the map.
+#define NATRON_INTERACTION_LATENCY_MAX_IN_FLIGHT 1024
+
+struct InteractionLatencyRegistry
+{
+    QMutex lock;
+
+    // Identifier of the most recent interaction, 0 until the user interacts
+    U64 currentId;
+
+    // Identifier of the last interaction for which a frame was displayed
+    U64 lastDisplayedId;
+
+    // Start timestamp of each interaction for which no frame was displayed yet
+    std::map<U64, TimestampVal> inFlight;
+
+    // Sliding window of latency samples in seconds, written circularly
+    std::vector<double> samples;
+    std::size_t nextSampleIndex;
+
+    unsigned long long nInteractionsStarted;
+    unsigned long long nInteractionsDisplayed;
+    double lastSeconds;
+
+    double timerFrequency;
+
+    InteractionLatencyRegistry()
+    : lock()
+    , currentId(0)
+    , lastDisplayedId(0)
+    , inFlight()
+    , samples()
+    , nextSampleIndex(0)
+    , nInteractionsStarted(0)
+    , nInteractionsDisplayed(0)
+    , lastSeconds(0)
+    , timerFrequency( getPerformanceFrequency() )
+    {
+    }
+};
+
+static InteractionLatencyRegistry&
+getInteractionLatencyRegistry()
+{
+    static InteractionLatencyRegistry registry;
+
+    return registry;
+}
+
+// Returns the value at the given percentile (in [0,1]) of a sorted sample vector
+static double
+percentileOfSorted(const std::vector<double>& sortedSamples,
+                   double percentile)
+{
+    assert( !sortedSamples.empty() );
+    std::size_t index = (std::size_t)( percentile * (sortedSamples.size() - 1) + 0.5 );
+    if ( index >= sortedSamples.size() ) {
+        index = sortedSamples.size() - 1;
+    }
+
+    return sortedSamples[index];
+}
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+
+U64
+InteractionLatencyTracker::notifyInteractionStarted()
+{
+    TimestampVal now = getTimestampInSeconds();
+    InteractionLatencyRegistry& registry = getInteractionLatencyRegistry();
+    QMutexLocker k(&registry.lock);
+
+    ++registry.currentId;
+    ++registry.nInteractionsStarted;
+    registry.inFlight[registry.currentId] = now;
+
+    // Forget the oldest superseded interactions if no frame was displayed for a long time
+    while (registry.inFlight.size() > NATRON_INTERACTION_LATENCY_MAX_IN_FLIGHT) {
+        registry.inFlight.erase( registry.inFlight.begin() );
+    }
+
+    return registry.currentId;
+}
+
+U64
+InteractionLatencyTracker::getCurrentInteractionId()
+{
+    InteractionLatencyRegistry& registry = getInteractionLatencyRegistry();
+    QMutexLocker k(&registry.lock);
+
+    return registry.currentId;
+}
+
+void
+InteractionLatencyTracker::notifyFrameDisplayed(U64 interactionId)
+{
+    if (interactionId == 0) {
+        return;
+    }
+
+    TimestampVal now = getTimestampInSeconds();
+    InteractionLatencyRegistry& registry = getInteractionLatencyRegistry();
+    QMutexLocker k(&registry.lock);
+
+    if (interactionId <= registry.lastDisplayedId) {
+        // A stale frame of an interaction that was superseded by a newer edit
+        // which already reached the screen
+        return;
+    }
+    registry.lastDisplayedId = interactionId;
+
+    std::map<U64, TimestampVal>::iterator found = registry.inFlight.find(interactionId);
+    if ( found == registry.inFlight.end() ) {
+        return;
+    }
+
+    const double latency = getTimeElapsed(found->second, now, registry.timerFrequency);
+
+    // The displayed frame also covers all older interactions: remove them along with
+    // the sampled one
+    registry.inFlight.erase( registry.inFlight.begin(), ++found );
+
+    ++registry.nInteractionsDisplayed;
+    registry.lastSeconds = latency;
+
+    if (registry.samples.size() < NATRON_INTERACTION_LATENCY_WINDOW_SIZE) {
+        registry.samples.push_back(latency);
+    } else {
+        registry.samples[registry.nextSampleIndex] = latency;
+    }
+    registry.nextSampleIndex = (registry.nextSampleIndex + 1) % NATRON_INTERACTION_LATENCY_WINDOW_SIZE;
+}
+
+void
+InteractionLatencyTracker::getStats(InteractionLatencyStats* stats)
+{
+    std::vector<double> samples;
+    {
+        InteractionLatencyRegistry& registry = getInteractionLatencyRegistry();
+        QMutexLocker k(&registry.lock);
+
+        stats->nInteractionsStarted = registry.nInteractionsStarted;
+        stats->nInteractionsDisplayed = registry.nInteractionsDisplayed;
+        stats->lastSeconds = registry.lastSeconds;
+        samples = registry.samples;
+    }
+
+    stats->nSamplesInWindow = (int)samples.size();
+    if ( samples.empty() ) {
+        stats->p50Seconds = stats->p90Seconds = stats->p99Seconds = 0.;
+
+        return;
+    }
+
+    std::sort( samples.begin(), samples.end() );
+    stats->p50Seconds = percentileOfSorted(samples, 0.50);
+    stats->p90Seconds = percentileOfSorted(samples, 0.90);
+    stats->p99Seconds = percentileOfSorted(samples, 0.99);
+}
+
+NATRON_NAMESPACE_EXIT;
@@ -0,0 +1,97 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2013-2017 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef Natron_Engine_InteractionLatency_h
+#define Natron_Engine_InteractionLatency_h
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+#include "Global/GlobalDefines.h"
+
+#include "Engine/EngineFwd.h"
+
+NATRON_NAMESPACE_ENTER;
+
+/**
+ * @brief Interactive latency figures of the viewer, as recorded by InteractionLatencyTracker.
+ * The percentiles are computed over a sliding window of the most recent samples, the counters
+ * are cumulative.
+ **/
+struct InteractionLatencyStats
+{
+    // Number of user interactions that started a tagged render
+    unsigned long long nInteractionsStarted;
+
+    // Number of interactions for which a frame reached the viewer. Interactions
+    // superseded by a newer edit before their render finished are not counted.
+    unsigned long long nInteractionsDisplayed;
+
+    // Latency in seconds of the last displayed interaction
+    double lastSeconds;
+
+    // Median, 90th and 99th percentile of the latency over the sample window
+    double p50Seconds;
+    double p90Seconds;
+    double p99Seconds;
+
+    // Number of samples currently in the window the percentiles are computed from
+    int nSamplesInWindow;
+};
+
+/**
+ * @brief Measures the end to end latency of user interactions: the time between a user
+ * driven parameter change and the moment the resulting frame is flipped to the front
+ * texture of the viewer.
+ *
+ * Each user edit is given a monotonically increasing identifier. A non-playback render
+ * picks up the identifier of the most recent edit when it is created and carries it
+ * down to the texture transfer of the viewer, which closes the sample. When the user
+ * scrubs a slider faster than frames can be rendered, intermediate edits are
+ * superseded: only the identifier carried by a frame that actually reached the screen
+ * produces a sample, which is exactly the latency the user perceives.
+ *
+ * The begin/displayed functions are called once per user edit and once per displayed
+ * frame respectively, so the mutex they take is not on any per-pixel path.
+ **/
+class InteractionLatencyTracker
+{
+public:
+
+    // A user edited a parameter: starts a new interaction and returns its identifier
+    static U64 notifyInteractionStarted();
+
+    // Returns the identifier of the most recent interaction, so that a render request
+    // can be tagged with it. Returns 0 if the user did not interact yet.
+    static U64 getCurrentInteractionId();
+
+    // A frame produced by a render tagged with the given identifier was flipped to the
+    // front texture of the viewer. Identifiers of 0 (untagged renders) and identifiers
+    // older than the last displayed one (a stale frame of a superseded edit) are ignored.
+    static void notifyFrameDisplayed(U64 interactionId);
+
+    static void getStats(InteractionLatencyStats* stats);
+};
+
+NATRON_NAMESPACE_EXIT;
+
+#endif // Natron_Engine_InteractionLatency_h
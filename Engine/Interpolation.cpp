@@ -40,6 +40,13 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 GCC_DIAG_ON(unused-parameter)
 #endif
 
+// SSE2 is part of the x86-64 baseline ABI, use it to batch the cubic evaluation over samples
+// in interpolateBatch()
+#if defined(__SSE2__) || defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 2 )
+#define NATRON_INTERPOLATION_USE_SSE2
+#include <emmintrin.h>
+#endif
+
 #ifndef M_PI
 #define M_PI        3.14159265358979323846264338327950288   /* pi             */
 #endif
@@ -468,6 +475,78 @@ Interpolation::interpolate(double tcur,
     return ret;
 }
 
+/**
+ * @brief Evaluates the same curve segment as interpolate() at nSamples times regularly
+ * spaced from tStart (included) to tEnd (included when nSamples > 1).
+ * The Hermite form is resolved to cubic coefficients once for the whole batch.
+ **/
+void
+Interpolation::interpolateBatch(double tcur,
+                                const double vcur,              //start control point
+                                const double vcurDerivRight, //being the derivative dv/dt at tcur
+                                const double vnextDerivLeft, //being the derivative dv/dt at tnext
+                                double tnext,
+                                const double vnext,               //end control point
+                                double tStart,
+                                double tEnd,
+                                int nSamples,
+                                KeyframeTypeEnum interp,
+                                KeyframeTypeEnum interpNext,
+                                double* samples)
+{
+    double P0 = vcur;
+    double P3 = vnext;
+    // Hermite coefficients P0' and P3' are the derivatives with respect to x \in [0,1]
+    double P0pr = vcurDerivRight * (tnext - tcur); // normalize for x \in [0,1]
+    double P3pl = vnextDerivLeft * (tnext - tcur); // normalize for x \in [0,1]
+
+    // after the last / before the first keyframe, derivatives are wrt currentTime (i.e. non-normalized)
+    if (interp == eKeyframeTypeNone) {
+        // virtual previous frame at t-1
+        P0 = P3 - P3pl;
+        P0pr = P3pl;
+        tcur = tnext - 1.;
+    } else if (interp == eKeyframeTypeConstant) {
+        P0pr = 0.;
+        P3pl = 0.;
+        P3 = P0;
+    }
+    if (interpNext == eKeyframeTypeNone) {
+        // virtual next frame at t+1
+        P3pl = P0pr;
+        P3 = P0 + P0pr;
+        tnext = tcur + 1;
+    }
+    double c0, c1, c2, c3;
+    hermiteToCubicCoeffs(P0, P0pr, P3pl, P3, &c0, &c1, &c2, &c3);
+
+    // Normalized parameter of the first sample and per-sample increment
+    const double t0 = (tStart - tcur) / (tnext - tcur);
+    const double dt = nSamples > 1 ? ( (tEnd - tStart) / (nSamples - 1) ) / (tnext - tcur) : 0.;
+    int i = 0;
+#ifdef NATRON_INTERPOLATION_USE_SSE2
+    {
+        const __m128d vc0 = _mm_set1_pd(c0);
+        const __m128d vc1 = _mm_set1_pd(c1);
+        const __m128d vc2 = _mm_set1_pd(c2);
+        const __m128d vc3 = _mm_set1_pd(c3);
+        const __m128d step = _mm_set1_pd(2. * dt);
+        __m128d t = _mm_setr_pd(t0, t0 + dt);
+        for (; i + 1 < nSamples; i += 2) {
+            // Horner form: c0 + t * (c1 + t * (c2 + t * c3))
+            __m128d v = _mm_add_pd( vc2, _mm_mul_pd(t, vc3) );
+            v = _mm_add_pd( vc1, _mm_mul_pd(t, v) );
+            v = _mm_add_pd( vc0, _mm_mul_pd(t, v) );
+            _mm_storeu_pd(samples + i, v);
+            t = _mm_add_pd(t, step);
+        }
+    }
+#endif
+    for (; i < nSamples; ++i) {
+        samples[i] = cubicEval(c0, c1, c2, c3, t0 + i * dt);
+    }
+} // interpolateBatch
+
 /// derive at currentTime. The derivative is with respect to currentTime
 double
 Interpolation::derive(double tcur,
@@ -50,6 +50,25 @@ double interpolate(double tcur, const double vcur, //start control point
                    KeyframeTypeEnum interp,
                    KeyframeTypeEnum interpNext) WARN_UNUSED_RETURN;
 
+/**
+ * @brief Evaluates the same curve segment as interpolate() at nSamples times regularly
+ * spaced from tStart (included) to tEnd (included when nSamples > 1), writing the results
+ * to samples[0 .. nSamples - 1]. All the sample times must lie within the segment.
+ * The Hermite form is resolved to cubic coefficients once for the whole batch and the
+ * cubic is evaluated in a tight loop over the samples, which is much cheaper than calling
+ * interpolate() once per sample.
+ **/
+void interpolateBatch(double tcur, const double vcur, //start control point
+                      const double vcurDerivRight, //being the derivative dv/dt at tcur
+                      const double vnextDerivLeft, //being the derivative dv/dt at tnext
+                      double tnext, const double vnext, //end control point
+                      double tStart,
+                      double tEnd,
+                      int nSamples,
+                      KeyframeTypeEnum interp,
+                      KeyframeTypeEnum interpNext,
+                      double* samples);
+
 /// derive at currentTime. The derivative is with respect to currentTime
 double derive(double tcur, const double vcur, //start control point
               const double vcurDerivRight, //being the derivative dv/dt at tcur
@@ -109,6 +109,10 @@
 #define kShortcutActionShowCacheReportLabel "Show Cache Report"
 #define kShortcutActionShowCacheReportHint "Show a window with a report about the cache memory usage"
 
+#define kShortcutActionShowCacheActivity "showCacheActivity"
+#define kShortcutActionShowCacheActivityLabel "Show Cache Activity"
+#define kShortcutActionShowCacheActivityHint "Show a window with live statistics about the cache activity: hit/miss/eviction rates and memory usage per node"
+
 #define kShortcutActionShowAbout "showAbout"
 #define kShortcutActionShowAboutLabel "About Natron"
 #define kShortcutActionShowAboutHint "Show the about window"
@@ -48,6 +48,7 @@
 #include "Engine/FrameViewRequest.h"
 #include "Engine/OverlayInteractBase.h"
 #include "Engine/Hash64.h"
+#include "Engine/InteractionLatency.h"
 #include "Engine/KnobFile.h"
 #include "Engine/KnobGuiI.h"
 #include "Engine/KnobTypes.h"
@@ -977,6 +978,13 @@ KnobHelper::evaluateValueChangeInternal(DimSpec dimension,
         return true;
     }
 
+    // Start a latency interaction: any non-playback render issued below (when the
+    // enclosing ScopedChanges_RAII evaluates) picks up its identifier and carries it
+    // down to the viewer texture swap, see InteractionLatencyTracker.
+    if (reason == eValueChangedReasonUserEdited) {
+        InteractionLatencyTracker::notifyInteractionStarted();
+    }
+
     AppInstancePtr app = holder->getApp();
     bool didSomething;
     {
@@ -2242,6 +2250,22 @@ KnobHelper::invalidateHashCacheInternal(std::set<HashableObject*>* invalidatedOb
     return HashableObject::invalidateHashCacheInternal(invalidatedObjects);
 }
 
+bool
+KnobHelper::isHashTimeVariant(ViewIdx view) const
+{
+    // The time is only used by appendToHash when a dimension is animated (see
+    // Knob<T>::appendToHash). An expression may also reference the timeline time,
+    // so stay conservative whenever one is set.
+    int nDims = getNDimensions();
+    for (int i = 0; i < nDims; ++i) {
+        if ( isAnimated(DimIdx(i), view) || hasExpression(DimIdx(i), view) ) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 //The knob in parameter will "listen" to this knob. Hence this knob is a dependency of the knob in parameter.
 void
 KnobHelper::addListener(const DimIdx listenerDimension,
@@ -5069,6 +5093,10 @@ KnobHolder::initializeKnobsPublic()
 
         // Force the clone to fetch its parameters
         fetchRenderCloneKnobs();
+
+        // Batch-evaluate the Python driven knobs while still in the requests pass so that
+        // render threads never have to take the GIL
+        prefetchPythonExpressionsResults();
     }
     _imp->knobsInitialized = true;
 }
@@ -5104,11 +5132,19 @@ KnobHolder::removeRenderClone(const TreeRenderPtr& render)
                 k->_imp->common->renderClonesMap.erase(found);
             }
         }
+        onRenderCloneRetired(*it);
     }
 
     return true;
 }
 
+void
+KnobHolder::updateRenderCloneKey(const FrameViewRenderKey& key)
+{
+    assert(_imp->mainInstance);
+    _imp->currentRender = key;
+}
+
 KnobHolderPtr
 KnobHolder::createRenderClone(const FrameViewRenderKey& key) const
 {
@@ -5177,6 +5213,45 @@ KnobHolder::fetchRenderCloneKnobs()
     }
 }
 
+void
+KnobHolder::prefetchPythonExpressionsResults()
+{
+    assert(_imp->mainInstance);
+
+    TimeValue time = _imp->currentRender.time;
+    ViewIdx view = _imp->currentRender.view;
+
+    // Gather the dimensions that are driven by a Python expression first: most holders
+    // have none and must not pay for a GIL acquisition
+    std::list<std::pair<KnobIPtr, DimIdx> > toEvaluate;
+    for (std::size_t i = 0; i < _imp->knobs.size(); ++i) {
+        if ( !_imp->knobs[i]->isExpressionsResultsCachingEnabled() ) {
+            continue;
+        }
+        int nDims = _imp->knobs[i]->getNDimensions();
+        for (int d = 0; d < nDims; ++d) {
+            if ( !_imp->knobs[i]->hasExpression(DimIdx(d), view) ) {
+                continue;
+            }
+            if (_imp->knobs[i]->getExpressionLanguage(view, DimIdx(d)) != eExpressionLanguagePython) {
+                continue;
+            }
+            toEvaluate.push_back( std::make_pair(_imp->knobs[i], DimIdx(d)) );
+        }
+    }
+    if ( toEvaluate.empty() ) {
+        return;
+    }
+
+    // Take the GIL once for all expressions of this holder. Each result is snapshotted in the
+    // expressions results cache of the knob, from which the render threads consume it without
+    // re-entering the interpreter.
+    PythonGILLocker pgl;
+    for (std::list<std::pair<KnobIPtr, DimIdx> >::const_iterator it = toEvaluate.begin(); it != toEvaluate.end(); ++it) {
+        ignore_result( it->first->evaluateExpressionToCache(time, view, it->second) );
+    }
+} // prefetchPythonExpressionsResults
+
 void
 KnobHolder::refreshAfterTimeChange(bool isPlayback,
                                    TimeValue time)
@@ -5387,6 +5462,21 @@ KnobHolder::appendToHash(const ComputeHashArgs& args, Hash64* hash)
 
 } // appendToHash
 
+bool
+KnobHolder::hasTimeVariantKnobHash(ViewIdx view) const
+{
+    KnobsVec knobs = getKnobs_mt_safe();
+    for (KnobsVec::const_iterator it = knobs.begin(); it != knobs.end(); ++it) {
+        if (!(*it)->getEvaluateOnChange()) {
+            continue;
+        }
+        if ((*it)->isHashTimeVariant(view)) {
+            return true;
+        }
+    }
+    return false;
+}
+
 bool
 KnobHolder::isFullAnimationToHashEnabled() const
 {
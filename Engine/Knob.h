@@ -750,6 +750,14 @@ public:
     virtual void setExpressionsResultsCachingEnabled(bool enabled) = 0;
     virtual bool isExpressionsResultsCachingEnabled() const = 0;
 
+    /**
+     * @brief Evaluates the expression set on the given dimension/view (if any) at the given time
+     * and inserts the result in the expressions results cache, exactly as if it had been evaluated
+     * through getValueAtTime. This is used by KnobHolder::prefetchPythonExpressionsResults() to
+     * batch the evaluation of all Python expressions of a render clone under a single GIL lock.
+     **/
+    virtual bool evaluateExpressionToCache(TimeValue time, ViewIdx view, DimIdx dimension) = 0;
+
     /**
      * @brief Checks that the given expr for the given dimension will produce a correct behaviour.
      * On success this function returns correctly, otherwise an exception is thrown with the error.
@@ -1154,6 +1162,15 @@ public:
 
     virtual void clearRenderValuesCache() = 0;
 
+    /**
+     * @brief On a render clone, reads all dimensions of the knob at the given time and view so
+     * that they get inserted in the render values cache. Subsequent calls to getValue or
+     * getValueAtTime for the same time/view are then plain cache lookups that do not take any
+     * lock, even when the plug-in reads its parameters concurrently from multiple render threads.
+     * This is a no-op on the main instance.
+     **/
+    virtual void seedRenderValuesCache(TimeValue time, ViewIdx view) = 0;
+
     template <typename K>
     boost::shared_ptr<K> getCloneForHolder(const KnobHolderPtr& holder) const
     {
@@ -1732,6 +1749,8 @@ private:
 
     virtual bool invalidateHashCacheInternal(std::set<HashableObject*>* invalidatedObjects) OVERRIDE FINAL;
 
+    virtual bool isHashTimeVariant(ViewIdx view) const OVERRIDE FINAL WARN_UNUSED_RETURN;
+
 
     bool cloneValueInternal(const KnobIPtr& other, ViewIdx view, ViewIdx otherView, DimIdx dimension, DimIdx otherDimension, const RangeD* range, double offset);
     bool cloneValues(const KnobIPtr& other, ViewSetSpec view, ViewSetSpec otherView, DimSpec dimension, DimSpec otherDimension, const RangeD* range, double offset);
@@ -2284,8 +2303,21 @@ public:
         }
     }
 
+    virtual void seedRenderValuesCache(TimeValue time, ViewIdx view) OVERRIDE
+    {
+        if (!_valuesCache) {
+            return;
+        }
+        int nDims = getNDimensions();
+        for (int i = 0; i < nDims; ++i) {
+            ignore_result( getValueAtTime(time, DimIdx(i), view) );
+        }
+    }
+
     virtual void clearExpressionsResults(DimSpec dimension, ViewSetSpec view) OVERRIDE FINAL;
 
+    virtual bool evaluateExpressionToCache(TimeValue time, ViewIdx view, DimIdx dimension) OVERRIDE FINAL;
+
     virtual void refreshStaticValue(TimeValue time) OVERRIDE FINAL;
 
 protected:
@@ -2847,6 +2879,12 @@ public:
 
     virtual void appendToHash(const ComputeHashArgs& args, Hash64* hash) OVERRIDE;
 
+    /**
+     * @brief Returns whether any knob of this holder taking part in the hash has a hash varying
+     * over time (animation or expression). Helper for isHashTimeVariant() implementations.
+     **/
+    bool hasTimeVariantKnobHash(ViewIdx view) const;
+
     /**
      * @brief If this function returns true, all knobs of thie KnobHolder will have their curve appended to their hash
      * regardless of their hashing strategy.
@@ -3015,8 +3053,34 @@ public:
      **/
     KnobHolderPtr getRenderClone(const FrameViewRenderKey& key) const;
 
+    /**
+     * @brief Update the frame/view/render key of this render clone so that it can be re-used
+     * by another render. Can only be called on a render clone that is no longer registered
+     * to any render.
+     **/
+    void updateRenderCloneKey(const FrameViewRenderKey& key);
+
+    /**
+     * @brief Evaluates on a render clone all knob dimensions driven by a Python expression at
+     * the frame/view of the current render key and snapshots the results in the expressions
+     * results cache of each knob. The GIL is taken once for the whole holder: without this,
+     * render threads evaluating the knobs lazily would each re-acquire the GIL and re-enter
+     * the interpreter per knob evaluation. Called when the clone is created or re-keyed
+     * during the requests pass.
+     **/
+    void prefetchPythonExpressionsResults();
+
 protected:
 
+    /**
+     * @brief Called on the main instance for each clone that was just unregistered by
+     * removeRenderClone(). Derived classes may use it to retain the clone for a later render.
+     **/
+    virtual void onRenderCloneRetired(const KnobHolderPtr& clone)
+    {
+        Q_UNUSED(clone);
+    }
+
 
     /**
      * @brief Must be implemented to initialize any knob using the
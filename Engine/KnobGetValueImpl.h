@@ -31,6 +31,7 @@
 
 #include "Engine/EffectInstance.h"
 #include "Engine/KnobItemsTable.h"
+#include "Engine/Timer.h" // ScopedProfilerSample
 
 #include "Engine/EngineFwd.h"
 
@@ -109,6 +110,18 @@ Knob<T>::getValueFromExpression(TimeValue time,
     return true;
 } // getValueFromExpression
 
+template <typename T>
+bool
+Knob<T>::evaluateExpressionToCache(TimeValue time,
+                                   ViewIdx view,
+                                   DimIdx dimension)
+{
+    T ret;
+
+    // getValueFromExpression already inserts the result in the expressions results cache
+    return getValueFromExpression(time, view, dimension, false /*clamp*/, &ret);
+}
+
 template <>
 bool
 KnobStringBase::getValueFromExpression_pod(TimeValue time,
@@ -264,14 +277,11 @@ Knob<T>::getValue(DimIdx dimension,
         throw std::invalid_argument("Knob::getValue: dimension out of range");
     }
 
-
+    ScopedProfilerSample profilerSample(eProfilerCategoryKnob, "Knob::getValue");
 
     // Figure out the view to read
     ViewIdx view_i = checkIfViewExistsOrFallbackMainView(view);
 
-    boost::shared_ptr<Knob<T> > thisShared = boost::dynamic_pointer_cast<Knob<T> >(shared_from_this());
-
-
     TimeValue currentTime = getCurrentRenderTime();
     // Check if value is already in TLS when rendering
     if (_valuesCache) {
@@ -445,8 +455,6 @@ Knob<T>::getValueAtTime(TimeValue time,
     // Figure out the view to read
     ViewIdx view_i = checkIfViewExistsOrFallbackMainView(view);
 
-    boost::shared_ptr<Knob<T> > thisShared = boost::dynamic_pointer_cast<Knob<T> >(shared_from_this());
-
     // Check if value is already in TLS when rendering
     if (_valuesCache) {
         DimTimeView key;
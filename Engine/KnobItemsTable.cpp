@@ -92,6 +92,12 @@ struct KnobItemsTableCommon
     // Used to prevent updates on the master knob
     int masterKnobUpdatesBlocked;
 
+    // Used to bracket bulk insertions/removals of items, see beginBulkItemEdits
+    int bulkItemEditsCounter;
+
+    // Track items that were inserted/removed during a begin/endBulkItemEdits bracket
+    std::list<KnobTableItemPtr> bulkInsertedItems, bulkRemovedItems;
+
     // track items that were added/removed during the full change of a begin/end selection
     std::set<KnobTableItemPtr> newItemsInSelection, itemsRemovedFromSelection;
 
@@ -120,6 +126,9 @@ struct KnobItemsTableCommon
     , beginSelectionCounter(0)
     , selectionRecursion(0)
     , masterKnobUpdatesBlocked(0)
+    , bulkItemEditsCounter(0)
+    , bulkInsertedItems()
+    , bulkRemovedItems()
     , newItemsInSelection()
     , itemsRemovedFromSelection()
     , perItemMasterKnobs()
@@ -496,15 +505,26 @@ KnobItemsTable::insertItem(int index, const KnobTableItemPtr& item, const KnobTa
 
     item->ensureItemInitialized();
 
+    const bool bulkEdit = _imp->common->bulkItemEditsCounter > 0;
 
-    if (!getPythonPrefix().empty()) {
+    // In a bulk edit, the Python declaration is deferred to endBulkItemEdits()
+    if (!bulkEdit && !getPythonPrefix().empty()) {
         declareItemAsPythonField(item);
     }
 
     item->onItemInsertedInModel_recursive();
 
-    Q_EMIT itemInserted(index, item, reason);
-    
+    NodePtr node = getNode();
+    if (node) {
+        node->invalidateAutoSaveSerialization();
+    }
+
+    if (bulkEdit) {
+        _imp->common->bulkInsertedItems.push_back(item);
+    } else {
+        Q_EMIT itemInserted(index, item, reason);
+    }
+
 }
 
 
@@ -529,15 +549,59 @@ KnobItemsTable::removeItem(const KnobTableItemPtr& item, TableChangeReasonEnum r
         }
     }
     if (removed) {
-        Q_EMIT itemRemoved(item, reason);
+        if (_imp->common->bulkItemEditsCounter > 0) {
+            // If the item was inserted within the same bracket, it must not be notified at all
+            _imp->common->bulkInsertedItems.remove(item);
+            _imp->common->bulkRemovedItems.push_back(item);
+        } else {
+            Q_EMIT itemRemoved(item, reason);
+        }
 
         if (!getPythonPrefix().empty()) {
             removeItemAsPythonField(item);
         }
         item->onItemRemovedFromModel_recursive();
+
+        NodePtr node = getNode();
+        if (node) {
+            node->invalidateAutoSaveSerialization();
+        }
     }
 }
 
+void
+KnobItemsTable::beginBulkItemEdits()
+{
+    ++_imp->common->bulkItemEditsCounter;
+}
+
+void
+KnobItemsTable::endBulkItemEdits(TableChangeReasonEnum reason)
+{
+    assert(_imp->common->bulkItemEditsCounter > 0);
+    if (_imp->common->bulkItemEditsCounter > 0 && --_imp->common->bulkItemEditsCounter > 0) {
+        return;
+    }
+
+    std::list<KnobTableItemPtr> insertedItems, removedItems;
+    insertedItems.swap(_imp->common->bulkInsertedItems);
+    removedItems.swap(_imp->common->bulkRemovedItems);
+
+    if (insertedItems.empty() && removedItems.empty()) {
+        return;
+    }
+
+    // Declare the inserted items to Python now: they were recorded in insertion order so a
+    // parent is always declared before its children
+    if (!getPythonPrefix().empty()) {
+        for (std::list<KnobTableItemPtr>::const_iterator it = insertedItems.begin(); it != insertedItems.end(); ++it) {
+            declareItemAsPythonField(*it);
+        }
+    }
+
+    Q_EMIT bulkItemsEdited(insertedItems, removedItems, reason);
+}
+
 void
 KnobItemsTable::resetModel(TableChangeReasonEnum reason)
 {
@@ -2884,12 +2948,14 @@ KnobItemsTable::fromSerialization(const SERIALIZATION_NAMESPACE::SerializationOb
     // It would create errors because children would attempt to be declared to Python recursively before their parent.
     // Instead we manually call it once all items are deserialized.
     _imp->common->pythonPrefix.clear();
+    beginBulkItemEdits();
     for (std::list<SERIALIZATION_NAMESPACE::KnobTableItemSerializationPtr>::const_iterator it = serialization->items.begin(); it != serialization->items.end(); ++it) {
         KnobTableItemPtr item = createItemFromSerialization(*it);
         if (item) {
             addItem(item, KnobTableItemPtr(), eTableChangeReasonInternal);
         }
     }
+    endBulkItemEdits(eTableChangeReasonInternal);
     declareItemsToPython();
 }
 
@@ -638,6 +638,18 @@ public:
      **/
     void insertItem(int index, const KnobTableItemPtr& item, const KnobTableItemPtr& parent, TableChangeReasonEnum reason);
 
+    /**
+     * @brief Bulk insertion/removal support. When inserting or removing many items at once
+     * (e.g: importing a tracker file with thousands of markers) bracket the calls to
+     * addItem/insertItem/removeItem with beginBulkItemEdits/endBulkItemEdits: the per-item
+     * itemInserted/itemRemoved signals are not emitted and the Python declaration of each
+     * inserted item is deferred. When the outermost bracket closes, the inserted items are
+     * declared to Python and a single bulkItemsEdited signal is emitted with all changes.
+     * Brackets may be nested.
+     **/
+    void beginBulkItemEdits();
+    void endBulkItemEdits(TableChangeReasonEnum reason);
+
     /**
      * @brief Returns a vector with all top level items in the model in order.
      **/
@@ -814,6 +826,10 @@ Q_SIGNALS:
     void itemRemoved(KnobTableItemPtr, TableChangeReasonEnum);
     void itemInserted(int index, KnobTableItemPtr, TableChangeReasonEnum);
 
+    // Emitted instead of itemInserted/itemRemoved for all items that changed within a
+    // beginBulkItemEdits/endBulkItemEdits bracket
+    void bulkItemsEdited(std::list<KnobTableItemPtr> insertedItems, std::list<KnobTableItemPtr> removedItems, TableChangeReasonEnum reason);
+
 protected:
 
     /**
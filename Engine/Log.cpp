@@ -28,69 +28,151 @@
 
 #include <cstdio>
 #include <cstdarg>
-#include <memory>
+#include <cstring> // strncpy
 #include <cstdlib>
 #include <string>
 #include <cassert>
 #include <stdexcept>
 
+#include <QtCore/QAtomicInt>
+#include <QtCore/QCoreApplication>
 #include <QtCore/QFile>
-#include <QtCore/QTextStream>
 #include <QtCore/QMutex>
+#include <QtCore/QTextStream>
+#include <QtCore/QThread>
+#include <QtCore/QWaitCondition>
 
 #include "Global/GlobalDefines.h"
 
+// Number of records in the ring buffer between the logging threads and the writer
+// thread. Must be a power of two. When the writer thread cannot keep up and the ring
+// fills, new records are dropped (and the drops reported in the log): a log statement
+// must never block a render thread.
+#define NATRON_LOG_RING_SIZE 1024
+
+// Maximum stored size of one message, longer messages are truncated
+#define NATRON_LOG_MESSAGE_MAX_SIZE 512
+
+// Maximum stored size of a caller name
+#define NATRON_LOG_CALLER_MAX_SIZE 128
+
 NATRON_NAMESPACE_ENTER;
 
-// see second answer of http://stackoverflow.com/questions/2342162/stdstring-formatting-like-sprintf
-static
-std::string
-string_format(const std::string fmt,
-              ...)
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+enum LogRecordTypeEnum
 {
-    int size = ( (int)fmt.size() ) * 2 + 50;   // Use a rubric appropriate for your code
-    std::string str;
-    va_list ap;
-
-    while (1) {     // Maximum two passes on a POSIX system...
-        str.resize(size);
-        va_start(ap, fmt);
-        int n = vsnprintf( (char *)str.data(), size, fmt.c_str(), ap );
-        va_end(ap);
-        if ( (n > -1) && (n < size) ) {  // Everything worked
-            str.resize(n);
-
-            return str;
-        }
-        if (n > -1) { // Needed size returned
-            size = n + 1;   // For null char
-        } else {
-            size *= 2;      // Guess at a larger size (OS specific)
-        }
+    eLogRecordTypeOpen,
+    eLogRecordTypeBeginFunction,
+    eLogRecordTypePrint,
+    eLogRecordTypeEndFunction,
+};
+
+struct LogRecord
+{
+    // Slot sequence number of the bounded MPSC queue (see LogPrivate::acquireRecord):
+    // producers claim a slot by advancing the enqueue position and publish the record
+    // by storing its sequence + 1 here, the writer thread stores sequence + ring size
+    // when the slot may be reused.
+    QAtomicInt seq;
+
+    LogRecordTypeEnum type;
+
+    // The caller name for begin/end records
+    char caller[NATRON_LOG_CALLER_MAX_SIZE];
+
+    // The message, function name, or filename for open records
+    char text[NATRON_LOG_MESSAGE_MAX_SIZE];
+};
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+
+class LogWriterThread
+    : public QThread
+{
+    LogPrivate* _imp;
+
+public:
+
+    LogWriterThread(LogPrivate* imp)
+        : QThread()
+        , _imp(imp)
+    {
+        setObjectName( QString::fromUtf8("Logger") );
     }
 
-    return str;
-}
+    virtual ~LogWriterThread()
+    {
+    }
+
+private:
+
+    virtual void run() OVERRIDE FINAL;
+};
 
 class LogPrivate
 {
 public:
 
-    QMutex _lock;
+    // The ring buffer between the logging threads and the writer thread
+    LogRecord ring[NATRON_LOG_RING_SIZE];
+
+    // Next sequence number to be claimed by a producer
+    QAtomicInt enqueuePos;
+
+    // Number of records committed to the ring and not yet written out
+    QAtomicInt nPending;
+
+    // Number of records dropped because the ring was full
+    QAtomicInt nDropped;
+
+    // To wake up the writer thread when a record is committed to an empty ring
+    QMutex wakeMutex;
+    QWaitCondition wakeCond;
+    bool mustQuit; // protected by wakeMutex
+
+    LogWriterThread* writerThread;
+
+    // State below is only accessed by the writer thread
+    int dequeuePos;
     QFile* _file;
     QTextStream* _stream;
     int _beginsCount;
+    int nDroppedReported;
 
     LogPrivate()
-        : _lock()
+        : enqueuePos()
+        , nPending()
+        , nDropped()
+        , wakeMutex()
+        , wakeCond()
+        , mustQuit(false)
+        , writerThread(NULL)
+        , dequeuePos(0)
         , _file(NULL)
         , _stream(NULL)
         , _beginsCount(0)
+        , nDroppedReported(0)
     {
+        for (int i = 0; i < NATRON_LOG_RING_SIZE; ++i) {
+            ring[i].seq = i;
+        }
+        writerThread = new LogWriterThread(this);
+        writerThread->start();
     }
 
     ~LogPrivate()
     {
+        {
+            QMutexLocker k(&wakeMutex);
+            mustQuit = true;
+            wakeCond.wakeAll();
+        }
+        // The writer thread drains the pending records before exiting
+        writerThread->wait();
+        delete writerThread;
+
         delete _stream;
         if (_file) {
             _file->close();
@@ -98,10 +180,105 @@ public:
         }
     }
 
-    void open(const std::string & fileName)
+    ////////// Producer side, called from any thread
+
+    /**
+     * @brief Claims a free slot of the ring, or NULL if the ring is full in which case
+     * the record is accounted as dropped. On success the caller fills the record and
+     * must publish it with commitRecord(). This is the enqueue of a bounded MPSC queue
+     * (single consumer variant of Vyukov's bounded MPMC queue): no lock is taken and
+     * the only atomic written on the fast path is the enqueue position.
+     **/
+    LogRecord* acquireRecord(int* recordSeq)
+    {
+        int pos = (int)enqueuePos;
+
+        for (;;) {
+            LogRecord& record = ring[pos & (NATRON_LOG_RING_SIZE - 1)];
+            int seq = record.seq.fetchAndAddAcquire(0);
+            int dif = seq - pos;
+            if (dif == 0) {
+                // The slot is free: try to claim it
+                if ( enqueuePos.testAndSetOrdered(pos, pos + 1) ) {
+                    *recordSeq = pos;
+
+                    return &record;
+                }
+                // Another thread claimed it first
+                pos = (int)enqueuePos;
+            } else if (dif < 0) {
+                // The ring is full: drop the record rather than block the calling thread
+                nDropped.fetchAndAddRelease(1);
+
+                return NULL;
+            } else {
+                // The slot was claimed by another thread, move on to the next one
+                pos = (int)enqueuePos;
+            }
+        }
+    }
+
+    void commitRecord(LogRecord* record,
+                      int recordSeq)
+    {
+        record->seq.fetchAndStoreRelease(recordSeq + 1);
+
+        // Wake up the writer thread if it may be asleep. The mutex is only taken when
+        // the ring was empty, i.e when the writer has caught up and the lock is
+        // uncontended: on a busy render the fast path is lock-free.
+        if (nPending.fetchAndAddRelease(1) == 0) {
+            QMutexLocker k(&wakeMutex);
+            wakeCond.wakeAll();
+        }
+    }
+
+    void pushRecord(LogRecordTypeEnum type,
+                    const char* caller,
+                    const char* text)
+    {
+        int recordSeq;
+        LogRecord* record = acquireRecord(&recordSeq);
+
+        if (!record) {
+            return;
+        }
+        record->type = type;
+        if (caller) {
+            strncpy(record->caller, caller, NATRON_LOG_CALLER_MAX_SIZE - 1);
+            record->caller[NATRON_LOG_CALLER_MAX_SIZE - 1] = 0;
+        } else {
+            record->caller[0] = 0;
+        }
+        if (text) {
+            strncpy(record->text, text, NATRON_LOG_MESSAGE_MAX_SIZE - 1);
+            record->text[NATRON_LOG_MESSAGE_MAX_SIZE - 1] = 0;
+        } else {
+            record->text[0] = 0;
+        }
+        commitRecord(record, recordSeq);
+    }
+
+    void pushPrintf(const char* format,
+                    va_list args)
     {
-        QMutexLocker locker(&_lock);
+        int recordSeq;
+        LogRecord* record = acquireRecord(&recordSeq);
+
+        if (!record) {
+            return;
+        }
+        record->type = eLogRecordTypePrint;
+        record->caller[0] = 0;
+        // Format directly into the record slot: no allocation on the calling thread
+        vsnprintf(record->text, NATRON_LOG_MESSAGE_MAX_SIZE, format, args);
+        record->text[NATRON_LOG_MESSAGE_MAX_SIZE - 1] = 0;
+        commitRecord(record, recordSeq);
+    }
+
+    ////////// Consumer side, only called by the writer thread
 
+    void openFile(const std::string & fileName)
+    {
         if (_file) {
             return;
         }
@@ -110,74 +287,137 @@ public:
         _stream = new QTextStream(_file);
     }
 
-    void beginFunction(const std::string & callerName,
-                       const std::string & function)
+    void ensureFileOpen()
     {
-        if (!_file) {
-            QString filename(NATRON_APPLICATION_NAME + QString("_log") + QString::number( QCoreApplication::instance()->applicationPid() ) + ".txt");
-            open( filename.toStdString() );
-        }
-        QMutexLocker locker(&_lock);
-        _stream->operator <<("********************************************************************************\n");
-        for (int i = 0; i < _beginsCount; ++i) {
-            _stream->operator <<("    ");
+        if (_file) {
+            return;
         }
-        _stream->operator <<("START ");
-        _stream->operator <<( callerName.c_str() );
-        _stream->operator <<("    ");
-        _stream->operator <<( function.c_str() );
-        _stream->operator <<('\n');
-        _stream->flush();
-        ++_beginsCount;
+        QString filename(NATRON_APPLICATION_NAME + QString::fromUtf8("_log") + QString::number( QCoreApplication::instance()->applicationPid() ) + QString::fromUtf8(".txt") );
+        openFile( filename.toStdString() );
     }
 
-    void print(const std::string & log)
+    void writeIndent()
     {
-        QMutexLocker locker(&_lock);
-
-        assert(_file);
         for (int i = 0; i < _beginsCount; ++i) {
             _stream->operator <<("    ");
         }
-        QString str( log.c_str() );
-        for (int i = 0; i < str.size(); ++i) {
-            _stream->operator <<( str.at(i).toLatin1() );
-            if ( (i % 80 == 0) && (i != 0) ) { // format to 80 columns
-                /*Find closest word end and insert a new line*/
-                ++i;
-                while ( i < str.size() && str.at(i) != QChar(' ') ) {
-                    _stream->operator <<( str.at(i).toLatin1() );
-                    ++i;
-                }
+    }
+
+    void writeMessage(const char* text)
+    {
+        ensureFileOpen();
+        writeIndent();
+        // Format the content to 80 columns, breaking at the closest word end
+        int col = 0;
+        for (const char* c = text; *c; ++c) {
+            _stream->operator <<(*c);
+            ++col;
+            if ( (col >= 80) && (*c == ' ') ) {
                 _stream->operator <<('\n');
-                for (int i = 0; i < _beginsCount; ++i) {
-                    _stream->operator <<("    ");
-                }
+                writeIndent();
+                col = 0;
             }
         }
-        _stream->operator <<( log.c_str() );
         _stream->operator <<('\n');
-        _stream->flush();
     }
 
-    void endFunction(const std::string & callerName,
-                     const std::string & function)
+    void processRecord(const LogRecord& record)
     {
-        QMutexLocker locker(&_lock);
-
-        --_beginsCount;
-        for (int i = 0; i < _beginsCount; ++i) {
+        switch (record.type) {
+        case eLogRecordTypeOpen:
+            openFile( std::string(record.text) );
+            break;
+        case eLogRecordTypeBeginFunction:
+            ensureFileOpen();
+            _stream->operator <<("********************************************************************************\n");
+            writeIndent();
+            _stream->operator <<("START ");
+            _stream->operator <<(record.caller);
             _stream->operator <<("    ");
+            _stream->operator <<(record.text);
+            _stream->operator <<('\n');
+            ++_beginsCount;
+            break;
+        case eLogRecordTypePrint:
+            writeMessage(record.text);
+            break;
+        case eLogRecordTypeEndFunction:
+            ensureFileOpen();
+            --_beginsCount;
+            writeIndent();
+            _stream->operator <<("STOP ");
+            _stream->operator <<(record.caller);
+            _stream->operator <<("    ");
+            _stream->operator <<(record.text);
+            _stream->operator <<('\n');
+            break;
+        }
+    }
+
+    /**
+     * @brief Writes out the next committed record, or returns false if none is
+     * available yet.
+     **/
+    bool processNextRecord()
+    {
+        LogRecord& record = ring[dequeuePos & (NATRON_LOG_RING_SIZE - 1)];
+        int seq = record.seq.fetchAndAddAcquire(0);
+
+        if (seq - (dequeuePos + 1) != 0) {
+            // The next record is not committed yet
+            return false;
+        }
+        processRecord(record);
+        // Mark the slot free for the producers, one ring revolution later
+        record.seq.fetchAndStoreRelease(dequeuePos + NATRON_LOG_RING_SIZE);
+        ++dequeuePos;
+        nPending.fetchAndAddRelease(-1);
+
+        return true;
+    }
+
+    void reportDroppedRecords()
+    {
+        int dropped = (int)nDropped;
+
+        if (dropped != nDroppedReported) {
+            ensureFileOpen();
+            writeIndent();
+            _stream->operator <<("[");
+            _stream->operator <<(dropped - nDroppedReported);
+            _stream->operator <<(" message(s) dropped because the log ring buffer was full]\n");
+            nDroppedReported = dropped;
         }
-        _stream->operator <<("STOP ");
-        _stream->operator <<( callerName.c_str() );
-        _stream->operator <<("    ");
-        _stream->operator <<( function.c_str() );
-        _stream->operator <<('\n');
-        _stream->flush();
     }
 };
 
+void
+LogWriterThread::run()
+{
+    for (;;) {
+        // Drain every committed record, then flush once: flushing per record would
+        // throttle the writer thread and fill the ring much sooner
+        bool didSomething = false;
+        while ( _imp->processNextRecord() ) {
+            didSomething = true;
+        }
+        _imp->reportDroppedRecords();
+        if (didSomething && _imp->_stream) {
+            _imp->_stream->flush();
+        }
+
+        QMutexLocker k(&_imp->wakeMutex);
+        if ( (int)_imp->nPending > 0 ) {
+            // A record was committed while we were flushing
+            continue;
+        }
+        if (_imp->mustQuit) {
+            return;
+        }
+        _imp->wakeCond.wait(&_imp->wakeMutex);
+    }
+}
+
 Log::Log()
     : Singleton<Log>(), _imp( new LogPrivate() )
 {
@@ -191,20 +431,20 @@ Log::~Log()
 void
 Log::open(const std::string & fileName)
 {
-    Log::instance()->_imp->open(fileName);
+    Log::instance()->_imp->pushRecord( eLogRecordTypeOpen, NULL, fileName.c_str() );
 }
 
 void
 Log::beginFunction(const std::string & callerName,
                    const std::string & function)
 {
-    Log::instance()->_imp->beginFunction(callerName, function);
+    Log::instance()->_imp->pushRecord( eLogRecordTypeBeginFunction, callerName.c_str(), function.c_str() );
 }
 
 void
 Log::print(const std::string & log)
 {
-    Log::instance()->_imp->print(log);
+    Log::instance()->_imp->pushRecord( eLogRecordTypePrint, NULL, log.c_str() );
 }
 
 void
@@ -214,16 +454,15 @@ Log::print(const char *format,
     va_list args;
 
     va_start(args, format);
-    std::string str = string_format(format, args);
+    Log::instance()->_imp->pushPrintf(format, args);
     va_end(args);
-    Log::print(str);
 }
 
 void
 Log::endFunction(const std::string & callerName,
                  const std::string & function)
 {
-    Log::instance()->_imp->endFunction(callerName, function);
+    Log::instance()->_imp->pushRecord( eLogRecordTypeEndFunction, callerName.c_str(), function.c_str() );
 }
 
 NATRON_NAMESPACE_EXIT;
@@ -37,6 +37,14 @@
 NATRON_NAMESPACE_ENTER;
 
 class LogPrivate;
+
+/**
+ * @brief Verbose logging facility. Log statements are cheap enough to leave enabled
+ * during renders: the calling thread only stores a record into a lock-free ring
+ * buffer, the formatting and file I/O are done by a background writer thread.
+ * Records are dropped (and the drops reported in the log) if the writer cannot
+ * keep up, a log statement never blocks.
+ **/
 class Log
     : public Singleton<Log>
 {
@@ -28,6 +28,14 @@
 #include <algorithm> // min, max
 #include <cassert>
 #include <stdexcept>
+#include <vector>
+
+// SSE2 is part of the x86-64 baseline ABI, use it to batch the float quantization
+// in to_byte_packed below.
+#if defined(__SSE2__) || defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 2 )
+#define NATRON_LUT_USE_SSE2
+#include <emmintrin.h>
+#endif
 
 #include "Engine/RectI.h"
 
@@ -93,6 +101,33 @@ hipart(const float f)
     }
 }
 
+// Applies hipart() to a span of floats: the index is just the high 16 bits of the float
+// bit pattern, so 8 values can be extracted at once with a shift and a pack.
+static void
+hipart_span(const float* from,
+            unsigned short* to,
+            std::size_t nElements)
+{
+    std::size_t i = 0;
+
+#ifdef NATRON_LUT_USE_SSE2
+    // _mm_packs_epi32 saturates to the signed range: bias the values before packing and
+    // flip the sign bit afterwards to undo it.
+    const __m128i bias = _mm_set1_epi32(0x8000);
+    const __m128i signFlip = _mm_set1_epi16( (short)0x8000 );
+
+    for (; i + 8 <= nElements; i += 8) {
+        __m128i lo = _mm_srli_epi32( _mm_castps_si128( _mm_loadu_ps(from + i) ), 16 );
+        __m128i hi = _mm_srli_epi32( _mm_castps_si128( _mm_loadu_ps(from + i + 4) ), 16 );
+        __m128i packed = _mm_packs_epi32( _mm_sub_epi32(lo, bias), _mm_sub_epi32(hi, bias) );
+        _mm_storeu_si128( (__m128i*)(to + i), _mm_xor_si128(packed, signFlip) );
+    }
+#endif
+    for (; i < nElements; ++i) {
+        to[i] = hipart(from[i]);
+    }
+}
+
 static float
 index_to_float(const unsigned short i)
 {
@@ -132,6 +167,8 @@ index_to_float(const unsigned short i)
 LutManager LutManager::m_instance = LutManager();
 LutManager::LutManager()
     : luts()
+    , insertMutex()
+    , retiredMaps()
 {
     // Create lut objects without initializing them
     sRGBLut();
@@ -152,29 +189,53 @@ LutManager::getLut(const std::string & name,
                    fromColorSpaceFunctionV1 fromFunc,
                    toColorSpaceFunctionV1 toFunc)
 {
-    QMutexLocker k(&LutManager::m_instance.lutsMutex);
-    LutsMap::iterator found = LutManager::m_instance.luts.find(name);
+    LutManager& m = LutManager::m_instance;
 
-    if ( found != LutManager::m_instance.luts.end() ) {
-        return found->second;
-    } else {
-        std::pair<LutsMap::iterator, bool> ret =
-            LutManager::m_instance.luts.insert( std::make_pair( name, new Lut(name, fromFunc, toFunc) ) );
-        assert(ret.second);
+    // Lock-free fast path: readers only ever see fully built map copies
+    {
+        const LutsMap* currentLuts = (const LutsMap*)m.luts;
+        if (currentLuts) {
+            LutsMap::const_iterator found = currentLuts->find(name);
+            if ( found != currentLuts->end() ) {
+                return found->second;
+            }
+        }
+    }
+
+    // The lut doesn't exist yet: take the insertion lock and look-up again, another
+    // thread may have published it in-between (double-checked).
+    QMutexLocker k(&m.insertMutex);
+    const LutsMap* currentLuts = (const LutsMap*)m.luts;
+    if (currentLuts) {
+        LutsMap::const_iterator found = currentLuts->find(name);
+        if ( found != currentLuts->end() ) {
+            return found->second;
+        }
+    }
 
-        return ret.first->second;
+    // Publish a new copy of the map with the lut added: concurrent readers keep using
+    // the old copy, which is retired and deleted at destruction only. Insertions happen
+    // at most once per colorspace name so the copies are cheap.
+    const Lut* lut = new Lut(name, fromFunc, toFunc);
+    LutsMap* newLuts = currentLuts ? new LutsMap(*currentLuts) : new LutsMap;
+    newLuts->insert( std::make_pair(name, lut) );
+    m.luts.fetchAndStoreRelease(newLuts);
+    if (currentLuts) {
+        m.retiredMaps.push_back(currentLuts);
     }
 
-    return NULL;
+    return lut;
 }
 
 const Lut*
 LutManager::findLut(const std::string& name)
 {
-    LutsMap::const_iterator found = LutManager::m_instance.luts.find(name);
-    QMutexLocker k(&LutManager::m_instance.lutsMutex);
-    if ( found != LutManager::m_instance.luts.end() ) {
-        return found->second;
+    const LutsMap* currentLuts = (const LutsMap*)LutManager::m_instance.luts;
+    if (currentLuts) {
+        LutsMap::const_iterator found = currentLuts->find(name);
+        if ( found != currentLuts->end() ) {
+            return found->second;
+        }
     }
     return 0;
 }
@@ -185,8 +246,16 @@ LutManager::~LutManager()
     ////This is because the Lut holds a OFX::MultiThread::Mutex and it can't be deleted
     //// by this singleton because it makes their destruction time uncertain regarding to
     ///the host multi-thread suite.
-    for (LutsMap::iterator it = luts.begin(); it != luts.end(); ++it) {
-        delete it->second;
+    const LutsMap* currentLuts = (const LutsMap*)luts;
+    if (currentLuts) {
+        for (LutsMap::const_iterator it = currentLuts->begin(); it != currentLuts->end(); ++it) {
+            delete it->second;
+        }
+        delete currentLuts;
+    }
+    for (std::list<const LutsMap*>::iterator it = retiredMaps.begin(); it != retiredMaps.end(); ++it) {
+        // Retired copies only hold pointers already deleted above
+        delete *it;
     }
 }
 
@@ -488,6 +557,16 @@ Lut::to_byte_packed(unsigned char* to,
 
     validate();
 
+    // Quantize whole scan-line portions up-front: the expensive part of the conversion
+    // (premultiplication and hipart extraction) vectorizes once it is separated from the
+    // serial error diffusion, which then reduces to a few integer ops per component.
+    const std::size_t spanSize = (std::size_t)(rect.x2 - rect.x1) * inPackingSize;
+    std::vector<unsigned short> hiparts(spanSize);
+    std::vector<float> premultiplied;
+    if (inputHasAlpha && premult) {
+        premultiplied.resize(spanSize);
+    }
+
     for (int y = rect.y1; y < rect.y2; ++y) {
         // coverity[dont_call]
         int start = rand() % (rect.x2 - rect.x1) + rect.x1;
@@ -502,38 +581,60 @@ Lut::to_byte_packed(unsigned char* to,
         int dstY = dstBounds.y2 - y - 1;
         const float *src_pixels = from + (srcY * (srcBounds.x2 - srcBounds.x1) * inPackingSize);
         unsigned char *dst_pixels = to + (dstY * (dstBounds.x2 - dstBounds.x1) * outPackingSize);
+
+        const float* span = src_pixels + rect.x1 * inPackingSize;
+        if (inputHasAlpha && premult) {
+            assert(inPackingSize == 4 && inAOffset == 3);
+#ifdef NATRON_LUT_USE_SSE2
+            for (std::size_t i = 0; i < spanSize; i += 4) {
+                __m128 v = _mm_loadu_ps(span + i);
+                _mm_storeu_ps( &premultiplied[i], _mm_mul_ps( v, _mm_shuffle_ps( v, v, _MM_SHUFFLE(3, 3, 3, 3) ) ) );
+            }
+#else
+            for (std::size_t i = 0; i < spanSize; i += 4) {
+                float a = span[i + 3];
+                premultiplied[i] = span[i] * a;
+                premultiplied[i + 1] = span[i + 1] * a;
+                premultiplied[i + 2] = span[i + 2] * a;
+                premultiplied[i + 3] = a;
+            }
+#endif
+            span = &premultiplied[0];
+        }
+        hipart_span(span, &hiparts[0], spanSize);
+
         /* go fowards from starting point to end of line: */
         for (int x = start; x < rect.x2; ++x) {
-            int inCol = x * inPackingSize;
+            int inCol = (x - rect.x1) * inPackingSize;
             int outCol = x * outPackingSize;
-            float a = (inputHasAlpha && premult) ? src_pixels[inCol + inAOffset] : 1.f;
-            error_r = (error_r & 0xff) + toFunc_hipart_to_uint8xx[hipart(src_pixels[inCol + inROffset] * a)];
-            error_g = (error_g & 0xff) + toFunc_hipart_to_uint8xx[hipart(src_pixels[inCol + inGOffset] * a)];
-            error_b = (error_b & 0xff) + toFunc_hipart_to_uint8xx[hipart(src_pixels[inCol + inBOffset] * a)];
+            error_r = (error_r & 0xff) + toFunc_hipart_to_uint8xx[hiparts[inCol + inROffset]];
+            error_g = (error_g & 0xff) + toFunc_hipart_to_uint8xx[hiparts[inCol + inGOffset]];
+            error_b = (error_b & 0xff) + toFunc_hipart_to_uint8xx[hiparts[inCol + inBOffset]];
             assert(error_r < 0x10000 && error_g < 0x10000 && error_b < 0x10000);
             dst_pixels[outCol + outROffset] = (unsigned char)(error_r >> 8);
             dst_pixels[outCol + outGOffset] = (unsigned char)(error_g >> 8);
             dst_pixels[outCol + outBOffset] = (unsigned char)(error_b >> 8);
             if (outputHasAlpha) {
                 // alpha is linear and should not be dithered
+                float a = (inputHasAlpha && premult) ? src_pixels[x * inPackingSize + inAOffset] : 1.f;
                 dst_pixels[outCol + outAOffset] = floatToInt<256>(a);
             }
         }
         /* go backwards from starting point to start of line: */
         error_r = error_g = error_b = 0x80;
         for (int x = start - 1; x >= rect.x1; --x) {
-            int inCol = x * inPackingSize;
+            int inCol = (x - rect.x1) * inPackingSize;
             int outCol = x * outPackingSize;
-            float a = (inputHasAlpha && premult) ? src_pixels[inCol + inAOffset] : 1.f;
-            error_r = (error_r & 0xff) + toFunc_hipart_to_uint8xx[hipart(src_pixels[inCol + inROffset] * a)];
-            error_g = (error_g & 0xff) + toFunc_hipart_to_uint8xx[hipart(src_pixels[inCol + inGOffset] * a)];
-            error_b = (error_b & 0xff) + toFunc_hipart_to_uint8xx[hipart(src_pixels[inCol + inBOffset] * a)];
+            error_r = (error_r & 0xff) + toFunc_hipart_to_uint8xx[hiparts[inCol + inROffset]];
+            error_g = (error_g & 0xff) + toFunc_hipart_to_uint8xx[hiparts[inCol + inGOffset]];
+            error_b = (error_b & 0xff) + toFunc_hipart_to_uint8xx[hiparts[inCol + inBOffset]];
             assert(error_r < 0x10000 && error_g < 0x10000 && error_b < 0x10000);
             dst_pixels[outCol + outROffset] = (unsigned char)(error_r >> 8);
             dst_pixels[outCol + outGOffset] = (unsigned char)(error_g >> 8);
             dst_pixels[outCol + outBOffset] = (unsigned char)(error_b >> 8);
             if (outputHasAlpha) {
                 // alpha is linear and should not be dithered
+                float a = (inputHasAlpha && premult) ? src_pixels[x * inPackingSize + inAOffset] : 1.f;
                 dst_pixels[outCol + outAOffset] = floatToInt<256>(a);
             }
         }
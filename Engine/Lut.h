@@ -32,10 +32,13 @@
 ///
 
 #include <cmath>
+#include <list>
 #include <map>
 #include <string>
 
 CLANG_DIAG_OFF(deprecated)
+#include <QtCore/QAtomicInt>
+#include <QtCore/QAtomicPointer>
 #include <QtCore/QMutex>
 CLANG_DIAG_ON(deprecated)
 
@@ -68,8 +71,8 @@ typedef float (*toColorSpaceFunctionV1)(float v);
 
 // a Singleton that holds precomputed LUTs for the whole application.
 // The m_instance member is static and is thus built before the first call to Instance().
-// WARNING : This class is not thread-safe and calling getLut must not be done in a function called
-// by multiple thread at once!
+// Lut retrieval is lock-free: render threads may safely fetch luts on demand, the tables
+// themselves are built lazily on first use of the lut.
 class Lut;
 class LutManager
 {
@@ -82,7 +85,8 @@ public:
     /**
      * @brief Returns a pointer to a lut with the given name and the given from and to functions.
      * If a lut with the same name didn't already exist, then it will create one.
-     * WARNING : NOT THREAD-SAFE
+     * This is thread-safe and lock-free when the lut already exists, which is always the case
+     * for the built-ins below since they are created by the constructor.
      **/
     static const Lut * getLut(const std::string & name, fromColorSpaceFunctionV1 fromFunc, toColorSpaceFunctionV1 toFunc);
 
@@ -120,10 +124,16 @@ private:
     ///the host multi-thread suite.
     ~LutManager();
 
-    //each lut with a ref count mapped against their name
-    mutable QMutex lutsMutex;
+    //each lut mapped against their name.
+    // The map is never modified in-place: getLut() publishes a new copy atomically whenever
+    // a lut is added, so concurrent readers never need a lock. Superseded copies are retired
+    // and only deleted at destruction, i.e: a reader holding the old copy stays valid.
     typedef std::map<std::string, const Lut * > LutsMap;
-    LutsMap luts;
+    QAtomicPointer<const LutsMap> luts;
+
+    //serializes insertions in getLut() and protects retiredMaps
+    mutable QMutex insertMutex;
+    std::list<const LutsMap*> retiredMaps;
 };
 
 
@@ -141,8 +151,8 @@ class Lut
     /// and never change afterwards
     mutable unsigned short toFunc_hipart_to_uint8xx[0x10000];         /// contains  2^16 = 65536 values between 0-255
     mutable float fromFunc_uint8_to_float[256];         /// values between 0-1.f
-    mutable bool init_;         ///< false if the tables are not yet initialized
-    mutable QMutex _lock;         ///< protects init_
+    mutable QAtomicInt init_;         ///< 0 if the tables are not yet initialized
+    mutable QMutex _lock;         ///< serializes fillTables()
 
     friend class LutManager;
     ///private constructor, used by LutManager
@@ -152,7 +162,7 @@ class Lut
         : _name(name)
         , _fromFunc(fromFunc)
         , _toFunc(toFunc)
-        , init_(false)
+        , init_()
         , _lock()
     {
     }
@@ -185,13 +195,18 @@ public:
     //Called by all public members
     void validate() const
     {
+        // Lock-free fast path: the tables never change once built, so after the first call
+        // render threads no longer serialize on the mutex. The mutex is only there so that
+        // a single thread fills the tables on first touch (double-checked).
+        if ( (int)init_ > 0 ) {
+            return;
+        }
         QMutexLocker g(&_lock);
-
-        if (init_) {
+        if ( (int)init_ > 0 ) {
             return;
         }
         fillTables();
-        init_ = true;
+        init_.fetchAndStoreRelease(1);
     }
 
     const std::string & getName() const
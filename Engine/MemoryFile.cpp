@@ -89,6 +89,70 @@ MemoryFile::MemoryFile()
 {
 }
 
+void
+MemoryFile::advise(AdviceTypeEnum type, void* data, std::size_t size) const
+{
+    void* ptr = data ? data : _imp->data;
+    if (!ptr) {
+        return;
+    }
+    std::size_t n = data ? size : _imp->size;
+#if defined(__NATRON_UNIX__)
+    int rc = 0;
+    switch (type) {
+        case eAdviceTypeNormal:
+#ifdef POSIX_MADV_NORMAL
+            rc = posix_madvise(ptr, n, POSIX_MADV_NORMAL);
+#else
+            rc = madvise(ptr, n, MADV_NORMAL);
+#endif
+            break;
+        case eAdviceTypeSequential:
+#ifdef POSIX_MADV_SEQUENTIAL
+            rc = posix_madvise(ptr, n, POSIX_MADV_SEQUENTIAL);
+#else
+            rc = madvise(ptr, n, MADV_SEQUENTIAL);
+#endif
+            break;
+        case eAdviceTypeRandom:
+#ifdef POSIX_MADV_RANDOM
+            rc = posix_madvise(ptr, n, POSIX_MADV_RANDOM);
+#else
+            rc = madvise(ptr, n, MADV_RANDOM);
+#endif
+            break;
+        case eAdviceTypeHugePage:
+#ifdef MADV_HUGEPAGE
+            rc = madvise(ptr, n, MADV_HUGEPAGE);
+#endif
+            break;
+    }
+    Q_UNUSED(rc);
+#else
+    // No equivalent hints on Windows: large pages require a privileged
+    // non-pageable allocation which cannot back a file mapping.
+    Q_UNUSED(type);
+    Q_UNUSED(n);
+#endif
+} // advise
+
+// 2 MiB, the (default) size of a transparent huge page on Linux
+#define NATRON_MEMORY_FILE_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+static void
+adviseMappingDefaults(const MemoryFile* file, char* data, std::size_t size)
+{
+    if (!data) {
+        return;
+    }
+    // Cache storage files are accessed tile by tile in no particular order: disable read-ahead.
+    file->advise(MemoryFile::eAdviceTypeRandom, data, size);
+    if (size >= NATRON_MEMORY_FILE_HUGE_PAGE_SIZE) {
+        // Large mappings measurably suffer from TLB misses with 4K pages
+        file->advise(MemoryFile::eAdviceTypeHugePage, data, size);
+    }
+}
+
 void
 MemoryFile::open(const std::string & filepath,
                  FileOpenModeEnum open_mode)
@@ -98,6 +162,7 @@ MemoryFile::open(const std::string & filepath,
     }
     _imp->path = filepath;
     _imp->openInternal(open_mode);
+    adviseMappingDefaults(this, _imp->data, _imp->size);
 }
 
 void
@@ -290,6 +355,7 @@ MemoryFile::remap()
 
     // re-open it
     _imp->openInternal(eFileOpenModeOpen);
+    adviseMappingDefaults(this, _imp->data, _imp->size);
 }
 
 void
@@ -334,6 +400,7 @@ MemoryFile::resize(size_t new_size, bool preserve)
         throw std::bad_alloc();
     }
     _imp->size = new_size;
+    adviseMappingDefaults(this, _imp->data, _imp->size);
 }
 
 void
@@ -405,6 +472,15 @@ MemoryFile::flush(FlushTypeEnum type, void* data, std::size_t size)
         // https://groups.google.com/forum/#!topic/comp.unix.programmer/reGmzSHKBHETE
         //return ::msync(ptr, n, MS_INVALIDATE) == 0;
         break;
+        case eFlushTypePrefetch: {
+            int rc;
+#ifdef POSIX_MADV_WILLNEED
+            rc = posix_madvise(ptr, n, POSIX_MADV_WILLNEED);
+#else
+            rc = madvise(ptr, n, MADV_WILLNEED);
+#endif
+            return rc == 0;
+        }
     }
 #elif defined(__NATRON_WIN32__)
     switch (type) {
@@ -420,6 +496,18 @@ MemoryFile::flush(FlushTypeEnum type, void* data, std::size_t size)
             break;
         case eFlushTypeInvalidate:
             break;
+        case eFlushTypePrefetch: {
+#if _WIN32_WINNT >= 0x0602
+            // PrefetchVirtualMemory is the overlapped-I/O analogue for mapped views:
+            // the system issues all page reads in one asynchronous batch.
+            WIN32_MEMORY_RANGE_ENTRY range;
+            range.VirtualAddress = ptr;
+            range.NumberOfBytes = n;
+            return (bool)::PrefetchVirtualMemory(::GetCurrentProcess(), 1, &range, 0) != 0;
+#else
+            break;
+#endif
+        }
     }
 #endif
     return false;
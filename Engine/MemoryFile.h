@@ -122,7 +122,12 @@ public:
     {
         eFlushTypeSync,
         eFlushTypeAsync,
-        eFlushTypeInvalidate
+        eFlushTypeInvalidate,
+
+        // Hints the OS that the given range is about to be read so it can schedule
+        // the disk reads asynchronously in one batch instead of serving a blocking
+        // page-fault per page when the range is first accessed.
+        eFlushTypePrefetch
     };
     /**
      * @brief Ensures that the backing file is in sync. with the data in memory
@@ -131,6 +136,30 @@ public:
      **/
     bool flush(FlushTypeEnum type, void* data, std::size_t size);
 
+    enum AdviceTypeEnum
+    {
+        // Reset to the default kernel paging behavior
+        eAdviceTypeNormal,
+
+        // The range is about to be read front to back: enables aggressive read-ahead
+        eAdviceTypeSequential,
+
+        // The range is accessed in no particular order (e.g: cache tiles): disables read-ahead
+        eAdviceTypeRandom,
+
+        // Ask the kernel to back the range with transparent huge pages to reduce
+        // TLB misses on multi-gigabyte mappings. Only effective on Linux.
+        eAdviceTypeHugePage
+    };
+
+    /**
+     * @brief Advises the kernel about the expected access pattern of the mapping.
+     * This is only a hint: unsupported advices on the platform are no-ops.
+     * @param data If non null, only the portion starting at data and spanning size bytes
+     * is advised, otherwise the whole mapping is.
+     **/
+    void advise(AdviceTypeEnum type, void* data = 0, std::size_t size = 0) const;
+
     /**
      * @brief Returns the filepath of the backing file.
      **/
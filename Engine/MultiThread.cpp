@@ -32,14 +32,17 @@ CLANG_DIAG_OFF(deprecated)
 CLANG_DIAG_OFF(uninitialized)
 CLANG_DIAG_OFF(deprecated-register) //'register' storage class specifier is deprecated
 CLANG_DIAG_OFF(uninitialized)
+#include <QtCore/QAtomicInt>
 #include <QtCore/QMutex>
 #include <QtCore/QThreadPool>
 #include <QtCore/QCoreApplication>
 #include <QtCore/QDebug>
 #include <QtCore/QThread>
 #include <QtCore/QReadWriteLock>
+#include <QtCore/QRunnable>
 #include <QtCore/QThreadStorage>
-#include <QtConcurrentMap> // QtCore on Qt4, QtConcurrent on Qt5
+#include <QtCore/QVector>
+#include <QtCore/QWaitCondition>
 CLANG_DIAG_ON(deprecated-register)
 CLANG_DIAG_ON(uninitialized)
 
@@ -56,10 +59,17 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 #include "Engine/TLSHolder.h"
 #include "Engine/EffectInstanceTLSData.h"
 #include "Engine/ThreadPool.h"
+#include "Engine/Timer.h"
+#include "Engine/TreeRender.h"
 
 // An effect may not use more than this amount of threads
 #define NATRON_MULTI_THREAD_SUITE_MAX_NUM_CPU 4
 
+// Number of times the thread waiting for completion re-checks the tasks counter before blocking
+// on a wait condition. Kernels dispatched through the multi-thread suite are often well under a
+// millisecond: for these, a brief busy-spin is cheaper than a mutex + wait condition round-trip.
+#define NATRON_MULTI_THREAD_SUITE_SPIN_COUNT 1000
+
 
 NATRON_NAMESPACE_ENTER;
 
@@ -147,8 +157,8 @@ static void copyOFXRenderTLS(const EffectInstancePtr& effect,
 
 }
 
-// Using QtConcurrent doesn't work with The Foundry Furnace plug-ins because they expect fresh threads
-// to be created. As QtConcurrent's thread-pool recycles thread, it seems to make Furnace crash.
+// Using the thread pool doesn't work with The Foundry Furnace plug-ins because they expect fresh threads
+// to be created. As the thread-pool recycles threads, it seems to make Furnace crash.
 // We think this is because Furnace must keep an internal thread-local state that becomes then dirty
 // if we re-use the same thread.
 
@@ -258,6 +268,133 @@ private:
     ActionRetCodeEnum *_stat;
 };
 
+// State shared between the runnables of a single launchThreadsInternal() call.
+// Each task writes its status in its own pre-sized slot so that no locking is needed:
+// the mutex and wait condition are only touched when a waiter actually has to block.
+struct MultiThreadJobState
+{
+    QAtomicInt nTasksRemaining;
+    QMutex tasksDoneMutex;
+    QWaitCondition tasksDoneCond;
+    std::vector<ActionRetCodeEnum> results;
+
+    MultiThreadJobState()
+    : nTasksRemaining()
+    , tasksDoneMutex()
+    , tasksDoneCond()
+    , results()
+    {
+    }
+
+    void notifyTaskDone()
+    {
+        // fetchAndAddRelease returns the previous value: the last task to finish wakes the waiter
+        if (nTasksRemaining.fetchAndAddRelease(-1) == 1) {
+            QMutexLocker k(&tasksDoneMutex);
+            tasksDoneCond.wakeAll();
+        }
+    }
+
+    void waitForAllTasksDone()
+    {
+        // Busy-spin briefly before blocking: sub-millisecond kernels generally finish
+        // within the spin, in which case the wait condition costs more than the job itself.
+        for (int i = 0; i < NATRON_MULTI_THREAD_SUITE_SPIN_COUNT; ++i) {
+            if ((int)nTasksRemaining <= 0) {
+                return;
+            }
+            QThread::yieldCurrentThread();
+        }
+
+        // If this thread is a thread-pool thread, let the pool start another runnable while
+        // we are blocked, otherwise tasks of concurrent launchThreads() calls could wait on
+        // each other with no thread left in the pool to run them.
+        // The time spent blocked is idle-waiting on the tasks of this call: report it to
+        // the pool activity stats when this thread belongs to the pool.
+        const bool isThreadPoolThread = isRunningInThreadPoolThread();
+        boost::scoped_ptr<TimeLapse> waitTimer;
+        if (isThreadPoolThread) {
+            QThreadPool::globalInstance()->releaseThread();
+            waitTimer.reset(new TimeLapse);
+        }
+        {
+            QMutexLocker k(&tasksDoneMutex);
+            while ((int)nTasksRemaining > 0) {
+                tasksDoneCond.wait(&tasksDoneMutex);
+            }
+        }
+        if (isThreadPoolThread) {
+            QThreadPool::globalInstance()->reserveThread();
+            ThreadPoolActivity::notifyIdleWait( waitTimer->getTimeSinceCreation() );
+        }
+    }
+};
+typedef boost::shared_ptr<MultiThreadJobState> MultiThreadJobStatePtr;
+
+// Runs one iteration of the functor on a (persistent) thread of the global thread pool.
+// This is cheaper than going through QtConcurrent which allocates a QFuture and its
+// result store for every call.
+class MultiThreadJobRunnable : public QRunnable
+{
+    MultiThreadPrivate* _imp;
+    MultiThreadJobStatePtr _state;
+    MultiThread::ThreadFunctor *_func;
+    unsigned int _threadIndex;
+    unsigned int _threadMax;
+    QThread* _spawnerThread;
+    EffectInstancePtr _effect;
+    void* _customArg;
+
+public:
+
+    MultiThreadJobRunnable(MultiThreadPrivate* imp,
+                           const MultiThreadJobStatePtr& state,
+                           MultiThread::ThreadFunctor func,
+                           unsigned int threadIndex,
+                           unsigned int threadMax,
+                           QThread* spawnerThread,
+                           const EffectInstancePtr& effect,
+                           void* customArg)
+    : QRunnable()
+    , _imp(imp)
+    , _state(state)
+    , _func(func)
+    , _threadIndex(threadIndex)
+    , _threadMax(threadMax)
+    , _spawnerThread(spawnerThread)
+    , _effect(effect)
+    , _customArg(customArg)
+    {
+    }
+
+    virtual ~MultiThreadJobRunnable()
+    {
+    }
+
+    virtual void run() OVERRIDE FINAL
+    {
+        ThreadPoolActivity::notifyTaskStarted();
+        TimeLapse taskTimer;
+
+        ActionRetCodeEnum stat = threadFunctionWrapper(_imp, _func, _threadIndex, _threadMax, _spawnerThread, _effect, _customArg);
+        _state->results[_threadIndex] = stat;
+
+        const double timeSpent = taskTimer.getTimeSinceCreation();
+        ThreadPoolActivity::notifyTaskDone(timeSpent);
+
+        // Attribute the time spent to the render: the iteration executed by the spawner
+        // thread itself is already accounted for in the span of its own pool task.
+        if (_effect) {
+            TreeRenderPtr render = _effect->getCurrentRender();
+            if (render) {
+                render->addCpuTimeSpent(timeSpent);
+            }
+        }
+
+        _state->notifyTaskDone();
+    }
+};
+
 NATRON_NAMESPACE_ANONYMOUS_EXIT
 
 
@@ -275,13 +412,11 @@ MultiThread::~MultiThread()
 
 struct MultiThreadFuturePrivate
 {
-    boost::scoped_ptr<QFuture<ActionRetCodeEnum> > future;
-    std::vector<unsigned int> threadIndices;
+    MultiThreadJobStatePtr jobState;
     ActionRetCodeEnum status;
 
     MultiThreadFuturePrivate(ActionRetCodeEnum initialStatus)
-    : future()
-    , threadIndices()
+    : jobState()
     , status(initialStatus)
     {
 
@@ -297,14 +432,14 @@ MultiThreadFuture::MultiThreadFuture(ActionRetCodeEnum initialStatus)
 ActionRetCodeEnum
 MultiThreadFuture::waitForFinished()
 {
-    if (_imp->future) {
-        _imp->future->waitForFinished();
+    if (_imp->jobState) {
+        _imp->jobState->waitForAllTasksDone();
 
         if (isFailureRetCode(_imp->status)) {
             return _imp->status;
         }
-        for (QFuture<ActionRetCodeEnum>::const_iterator it = _imp->future->begin(); it != _imp->future->end(); ++it) {
-            ActionRetCodeEnum stat = *it;
+        for (std::size_t i = 0; i < _imp->jobState->results.size(); ++i) {
+            ActionRetCodeEnum stat = _imp->jobState->results[i];
             if (isFailureRetCode(stat)) {
                 return stat;
             }
@@ -375,23 +510,32 @@ MultiThread::launchThreadsInternal(MultiThread::ThreadFunctor func, unsigned int
 
     if (useThreadPool) {
 
-        ret->_imp->threadIndices.resize(nThreads);
-        for (unsigned int i = 0; i < nThreads; ++i) {
-            ret->_imp->threadIndices[i] = i;
-        }
-
         // If the current thread is a thread-pool thread, make it also do an iteration instead
         // of waiting for other threads
         bool isThreadPoolThread = isRunningInThreadPoolThread();
+
+        unsigned int nTasksToLaunch = nThreads;
         if (isThreadPoolThread) {
-            ret->_imp->threadIndices.pop_back();
+            --nTasksToLaunch;
         }
 
+        MultiThreadJobStatePtr state(new MultiThreadJobState);
+        state->nTasksRemaining.fetchAndStoreAcquire(nTasksToLaunch);
+        state->results.resize(nThreads, eActionStatusOK);
+        ret->_imp->jobState = state;
+
         // DON'T set the maximum thread count: this is a global application setting, and see the documentation excerpt above
         // QThreadPool::globalInstance()->setMaxThreadCount(nThreads);
 
-        ret->_imp->future.reset(new QFuture<ActionRetCodeEnum>);
-        *ret->_imp->future = QtConcurrent::mapped( ret->_imp->threadIndices, boost::bind(threadFunctionWrapper, imp, func, _1, nThreads, spawnerThread, effect, customArg) );
+        // Dispatch each iteration directly as a runnable on the (persistent) global thread pool:
+        // this avoids the QFuture allocation and result store that QtConcurrent sets up for
+        // every call, which is measurable when plug-ins call the multi-thread suite for small
+        // regions many times per frame.
+        for (unsigned int i = 0; i < nTasksToLaunch; ++i) {
+            QRunnable* runnable = new MultiThreadJobRunnable(imp, state, func, i, nThreads, spawnerThread, effect, customArg);
+            ThreadPoolActivity::notifyTaskDispatched();
+            QThreadPool::globalInstance()->start(runnable);
+        }
 
         // Do one iteration in this thread
         if (isThreadPoolThread) {
@@ -399,8 +543,8 @@ MultiThread::launchThreadsInternal(MultiThread::ThreadFunctor func, unsigned int
             if (isFailureRetCode(stat)) {
                 // This thread failed, wait for other threads and exit
                 ret->_imp->status = stat;
-                ret->_imp->future->waitForFinished();
-                ret->_imp->future.reset();
+                state->waitForAllTasksDone();
+                ret->_imp->jobState.reset();
                 return ret;
             }
         }
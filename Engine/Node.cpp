@@ -1424,18 +1424,24 @@ Node::getPosition(double *x,
 void
 Node::onNodeUIPositionChanged(double x, double y)
 {
-    QMutexLocker k(&_imp->nodeUIDataMutex);
-    _imp->nodePositionCoords[0] = x;
-    _imp->nodePositionCoords[1] = y;
+    {
+        QMutexLocker k(&_imp->nodeUIDataMutex);
+        _imp->nodePositionCoords[0] = x;
+        _imp->nodePositionCoords[1] = y;
+    }
+    invalidateAutoSaveSerialization();
 }
 
 void
 Node::onNodeUISizeChanged(double w,
               double h)
 {
-    QMutexLocker k(&_imp->nodeUIDataMutex);
-    _imp->nodeSize[0] = w;
-    _imp->nodeSize[1] = h;
+    {
+        QMutexLocker k(&_imp->nodeUIDataMutex);
+        _imp->nodeSize[0] = w;
+        _imp->nodeSize[1] = h;
+    }
+    invalidateAutoSaveSerialization();
 }
 
 
@@ -1538,11 +1544,13 @@ Node::onNodeUIColorChanged(double r,
                            double g,
                            double b)
 {
-    QMutexLocker k(&_imp->nodeUIDataMutex);
-    _imp->nodeColor[0] = r;
-    _imp->nodeColor[1] = g;
-    _imp->nodeColor[2] = b;
-
+    {
+        QMutexLocker k(&_imp->nodeUIDataMutex);
+        _imp->nodeColor[0] = r;
+        _imp->nodeColor[1] = g;
+        _imp->nodeColor[2] = b;
+    }
+    invalidateAutoSaveSerialization();
 }
 
 
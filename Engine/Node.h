@@ -183,6 +183,20 @@ public:
      **/
     virtual void fromSerialization(const SERIALIZATION_NAMESPACE::SerializationObjectBase& serializationBase) OVERRIDE FINAL;
 
+    /**
+     * @brief Returns the serialization of this node cached by a previous auto-save, or
+     * serializes the node and caches the result if nothing was cached. Used by the project
+     * auto-save to only re-serialize the nodes that changed since the last auto-save.
+     **/
+    SERIALIZATION_NAMESPACE::NodeSerializationPtr getOrCreateAutoSaveSerialization();
+
+    /**
+     * @brief Drops the cached auto-save serialization. Called whenever something serializable
+     * changes on the node: knob changes, label/script-name changes, input connections, node
+     * UI changes and items table edits.
+     **/
+    void invalidateAutoSaveSerialization();
+
     void loadInternalNodeGraph(bool initialSetupAllowed,
                                const SERIALIZATION_NAMESPACE::NodeSerialization* projectSerialization,
                                const SERIALIZATION_NAMESPACE::NodeSerialization* pyPlugSerialization);
@@ -710,6 +724,14 @@ public:
      **/
     bool makePreviewImage(TimeValue time, int width, int height, unsigned int* buf);
 
+    /**
+     * @brief Converts an already rendered image into a width x height ARGB32 preview,
+     * with the same format and fitting as makePreviewImage(). This is the conversion
+     * part of makePreviewImage() without the render, used to publish previews of frames
+     * rendered by a background process, see ProcessFrameRing.
+     **/
+    static bool makePreviewFromImage(const ImagePtr& image, bool convertToSrgb, int width, int height, unsigned int* buf);
+
     /**
      * @brief Returns true if the node is currently rendering a preview image.
      **/
@@ -55,11 +55,16 @@
 #include "Engine/RotoLayer.h"
 #include "Engine/Settings.h"
 #include "Engine/TimeLine.h"
+#include "Engine/Timer.h"
 #include "Engine/ViewIdx.h"
 #include "Engine/ViewerInstance.h"
 
 #include "Serialization/NodeSerialization.h"
 
+// While loading a project, minimum interval (in seconds) between 2 refreshes of the UI in
+// NodeCollection::createNodesFromSerialization()
+#define NATRON_PROJECT_LOAD_UI_REFRESH_INTERVAL_SEC 0.1
+
 NATRON_NAMESPACE_ENTER;
 
 struct NodeCollectionPrivate
@@ -165,6 +170,12 @@ NodeCollection::addNode(const NodePtr& node)
         QMutexLocker k(&_imp->nodesMutex);
         _imp->nodes.push_back(node);
     }
+
+    // If this collection is a group node, its serialization contains the child nodes
+    NodeGroupPtr isGroup = toNodeGroup( getThisShared() );
+    if (isGroup) {
+        isGroup->getNode()->invalidateAutoSaveSerialization();
+    }
 }
 
 
@@ -175,14 +186,22 @@ NodeCollection::removeNode(const Node* node)
     if (!node) {
         return;
     }
-    QMutexLocker k(&_imp->nodesMutex);
-    for (NodesList::iterator it =_imp->nodes.begin(); it != _imp->nodes.end();++it) {
-        if ( it->get() == node ) {
-            _imp->nodes.erase(it);
-            break;
+    {
+        QMutexLocker k(&_imp->nodesMutex);
+        for (NodesList::iterator it =_imp->nodes.begin(); it != _imp->nodes.end();++it) {
+            if ( it->get() == node ) {
+                _imp->nodes.erase(it);
+                break;
+            }
         }
+        onNodeRemoved(node);
+    }
+
+    // If this collection is a group node, its serialization contains the child nodes
+    NodeGroupPtr isGroup = toNodeGroup( getThisShared() );
+    if (isGroup) {
+        isGroup->getNode()->invalidateAutoSaveSerialization();
     }
-    onNodeRemoved(node);
 }
 
 void
@@ -1765,10 +1784,20 @@ NodeCollection::createNodesFromSerialization(const SERIALIZATION_NAMESPACE::Node
 
     std::map<SERIALIZATION_NAMESPACE::NodeSerializationPtr, NodePtr> localCreatedNodes;
 
+    // Refresh the UI periodically while creating nodes so that the node-graph appears
+    // progressively and stays responsive on big projects instead of freezing until the whole
+    // group is restored.
+    TimeLapse lastUIRefresh;
 
     // Loop over all node serialization and create them first
     for (SERIALIZATION_NAMESPACE::NodeSerializationList::const_iterator it = serializedNodes.begin(); it != serializedNodes.end(); ++it) {
-        
+
+        if ( ( QThread::currentThread() == qApp->thread() ) && ( lastUIRefresh.getTimeSinceCreation() >= NATRON_PROJECT_LOAD_UI_REFRESH_INTERVAL_SEC ) ) {
+            getApplication()->updateProjectLoadStatus( tr("Creating node %1 in group: %2").arg( QString::fromUtf8( (*it)->_nodeScriptName.c_str() ) ).arg(groupStatusLabel) );
+            QCoreApplication::processEvents();
+            lastUIRefresh = TimeLapse();
+        }
+
         NodePtr node = appPTR->createNodeForProjectLoading(*it, thisShared);
         if (createdNodesOut) {
             createdNodesOut->push_back(node);
@@ -1822,6 +1851,14 @@ NodeCollection::createNodesFromSerialization(const SERIALIZATION_NAMESPACE::Node
 
     NodesList allNodesInGroup = getNodes();
 
+    // Restore all connections and links inside a single graph edit transaction: each connection
+    // made below would otherwise trigger its own downstream metadata refresh and hash
+    // invalidation, which costs O(edges * graph depth) on big pastes and template loads.
+    ProjectPtr project = getApplication()->getProject();
+    if (project) {
+        project->beginGraphEditTransaction();
+    }
+
     // Connect the nodes together
     for (std::map<SERIALIZATION_NAMESPACE::NodeSerializationPtr, NodePtr>::const_iterator it = localCreatedNodes.begin(); it != localCreatedNodes.end(); ++it) {
 
@@ -1841,6 +1878,11 @@ NodeCollection::createNodesFromSerialization(const SERIALIZATION_NAMESPACE::Node
 
     // We may now restore all links
     restoreLinksRecursive(thisShared, serializedNodes, &localCreatedNodes);
+
+    if (project) {
+        project->endGraphEditTransaction();
+    }
+
     return !hasError;
 
 } // createNodesFromSerialization
@@ -25,6 +25,7 @@
 #include "NodePrivate.h"
 
 #include <QDebug>
+#include <QtCore/QAtomicInt>
 
 #include "Engine/GroupOutput.h"
 #include "Engine/PrecompNode.h"
@@ -32,6 +33,19 @@
 
 NATRON_NAMESPACE_ENTER;
 
+// Process-wide generation of the node-graph topology: incremented whenever a connection
+// changes or the inputs of a node are (re-)initialized anywhere in the application.
+// Group redirections (NodeGroup/GroupInput/GroupOutput passthrough chains) resolved by
+// getInputInternal() are cached on each node against this generation, so that deeply
+// nested groups are flattened once per graph edit instead of on every frame request.
+static QAtomicInt graphTopologyGeneration(1);
+
+static void
+invalidateGroupRedirectionCaches()
+{
+    graphTopologyGeneration.fetchAndAddOrdered(1);
+}
+
 
 void
 Node::initializeInputs()
@@ -81,6 +95,10 @@ Node::initializeInputs()
     }
     _imp->inputsInitialized = true;
 
+    // The number of inputs of this node changed: if this is a group (or a node inside
+    // one) the cached group redirections may now resolve differently
+    invalidateGroupRedirectionCaches();
+
     Q_EMIT inputsInitialized();
 } // Node::initializeInputs
 
@@ -217,14 +235,42 @@ Node::getInputInternal(bool useGroupRedirections,
     }
 
 
-    QMutexLocker l(&_imp->inputsMutex);
-    if ( ( index >= (int)_imp->inputs.size() ) || (index < 0) ) {
-        return NodePtr();
-    }
+    NodePtr ret;
+    {
+        QMutexLocker l(&_imp->inputsMutex);
+        if ( ( index >= (int)_imp->inputs.size() ) || (index < 0) ) {
+            return NodePtr();
+        }
 
-    NodePtr ret =  _imp->inputs[index].lock();
+        ret = _imp->inputs[index].lock();
+    }
     if (ret && useGroupRedirections) {
+        // Read the generation before resolving: if a connection changes concurrently the
+        // entry is stored against a stale generation and simply recomputed next time.
+        const int generation = (int)graphTopologyGeneration;
+        {
+            QMutexLocker l(&_imp->redirectedInputsMutex);
+            if ( (generation == _imp->redirectedInputsGeneration) && ( index < (int)_imp->redirectedInputs.size() ) ) {
+                NodePtr cached = _imp->redirectedInputs[index].lock();
+                if (cached) {
+                    return cached;
+                }
+            }
+        }
+
         ret = applyNodeRedirectionsUpstream(ret);
+
+        if (ret) {
+            QMutexLocker l(&_imp->redirectedInputsMutex);
+            if (_imp->redirectedInputsGeneration != generation) {
+                _imp->redirectedInputs.clear();
+                _imp->redirectedInputsGeneration = generation;
+            }
+            if ( index >= (int)_imp->redirectedInputs.size() ) {
+                _imp->redirectedInputs.resize(index + 1);
+            }
+            _imp->redirectedInputs[index] = ret;
+        }
     }
 
     return ret;
@@ -716,6 +762,8 @@ Node::replaceInputInternal(const NodePtr& input, int inputNumber, bool failIfExi
         }
     }
 
+    invalidateGroupRedirectionCaches();
+
     if (destroyed) {
         // Don't do more if the node is destroyed because we would run code that is not needed on the node.
         return true;
@@ -729,6 +777,8 @@ Node::replaceInputInternal(const NodePtr& input, int inputNumber, bool failIfExi
         QObject::connect( input.get(), SIGNAL(labelChanged(QString,QString)), this, SLOT(onInputLabelChanged(QString, QString)),Qt::UniqueConnection );
     }
 
+    invalidateAutoSaveSerialization();
+
     // Notify the GUI
     Q_EMIT inputChanged(inputNumber);
 
@@ -737,8 +787,14 @@ Node::replaceInputInternal(const NodePtr& input, int inputNumber, bool failIfExi
     // Call the instance changed action with a reason clip changed
     onInputChanged(inputNumber);
 
-    // Notify cache
-    _imp->effect->invalidateHashCache();
+    // Notify cache. Inside a graph edit transaction, the invalidation is deferred and run
+    // once for the whole batch of topology changes, see Project::endGraphEditTransaction()
+    ProjectPtr project = getApp()->getProject();
+    if ( project && project->isDoingGraphEditTransaction() ) {
+        project->addNodeToGraphEditTransaction( shared_from_this() );
+    } else {
+        _imp->effect->invalidateHashCache();
+    }
 
     // Run Python callback
     std::string inputChangedCB = _imp->effect->getInputChangedCallback();
@@ -836,6 +892,8 @@ Node::switchInput0And1()
 
 
     }
+    invalidateGroupRedirectionCaches();
+    invalidateAutoSaveSerialization();
     Q_EMIT inputChanged(inputAIndex);
     Q_EMIT inputChanged(inputBIndex);
 
@@ -844,8 +902,14 @@ Node::switchInput0And1()
     onInputChanged(inputBIndex);
 
 
-    // Notify cache
-    _imp->effect->invalidateHashCache();
+    // Notify cache. Inside a graph edit transaction, the invalidation is deferred and run
+    // once for the whole batch of topology changes, see Project::endGraphEditTransaction()
+    ProjectPtr project = getApp()->getProject();
+    if ( project && project->isDoingGraphEditTransaction() ) {
+        project->addNodeToGraphEditTransaction( shared_from_this() );
+    } else {
+        _imp->effect->invalidateHashCache();
+    }
 
 
 
@@ -1201,16 +1265,25 @@ Node::endInputEdition(bool triggerRender)
         bool hasChanged = !_imp->inputsModified.empty();
         _imp->inputsModified.clear();
 
-        if (hasChanged) {
+        ProjectPtr project = getApp()->getProject();
+        const bool inGraphEditTransaction = project && project->isDoingGraphEditTransaction();
 
-            // Force a refresh of the meta-datas
+        if (hasChanged) {
+            if (inGraphEditTransaction) {
+                // Defer the downstream metadata pass: it is run once for the whole batch of
+                // topology changes, see Project::endGraphEditTransaction()
+                project->addNodeToGraphEditTransaction( shared_from_this() );
+            } else {
+                // Force a refresh of the meta-datas
 
-            _imp->effect->onMetadataChanged_recursive_public();
+                _imp->effect->onMetadataChanged_recursive_public();
 
-            _imp->effect->refreshDynamicProperties();
+                _imp->effect->refreshDynamicProperties();
+            }
         }
 
-        triggerRender = triggerRender && hasChanged;
+        // The transaction triggers a single render of the viewers once the batch is done
+        triggerRender = triggerRender && hasChanged && !inGraphEditTransaction;
 
         if (triggerRender) {
             getApp()->renderAllViewers();
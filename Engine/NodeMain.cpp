@@ -765,6 +765,52 @@ Node::toSerialization(SERIALIZATION_NAMESPACE::SerializationObjectBase* serializ
 
 } // Node::toSerialization
 
+SERIALIZATION_NAMESPACE::NodeSerializationPtr
+Node::getOrCreateAutoSaveSerialization()
+{
+    U64 dirtyCount;
+    {
+        QMutexLocker k(&_imp->autoSaveSerializationMutex);
+        if (_imp->autoSaveSerialization) {
+            return _imp->autoSaveSerialization;
+        }
+        dirtyCount = _imp->autoSaveSerializationDirty;
+    }
+
+    SERIALIZATION_NAMESPACE::NodeSerializationPtr ret( new SERIALIZATION_NAMESPACE::NodeSerialization );
+    toSerialization( ret.get() );
+
+    {
+        QMutexLocker k(&_imp->autoSaveSerializationMutex);
+
+        // Only cache the serialization if the node was not invalidated concurrently while
+        // we were serializing it
+        if (dirtyCount == _imp->autoSaveSerializationDirty) {
+            _imp->autoSaveSerialization = ret;
+        }
+    }
+
+    return ret;
+}
+
+void
+Node::invalidateAutoSaveSerialization()
+{
+    {
+        QMutexLocker k(&_imp->autoSaveSerializationMutex);
+
+        ++_imp->autoSaveSerializationDirty;
+        _imp->autoSaveSerialization.reset();
+    }
+
+    // Nodes within a group are serialized within the serialization of the group node
+    // itself: invalidate it too
+    NodeGroupPtr isParentGroup = toNodeGroup( getGroup() );
+    if (isParentGroup) {
+        isParentGroup->getNode()->invalidateAutoSaveSerialization();
+    }
+}
+
 void
 Node::fromSerialization(const SERIALIZATION_NAMESPACE::SerializationObjectBase& serializationBase)
 {
@@ -181,6 +181,7 @@ Node::setLabel(const std::string& label)
     if (collection) {
         collection->notifyNodeLabelChanged( shared_from_this() );
     }
+    invalidateAutoSaveSerialization();
     Q_EMIT labelChanged(curLabel, newLabel );
 }
 
@@ -348,6 +349,7 @@ Node::setNameInternal(const std::string& name,
     }
 
     QString qnewName = QString::fromUtf8( newName.c_str() );
+    invalidateAutoSaveSerialization();
     Q_EMIT scriptNameChanged(qnewName);
     if (labelSet) {
         Q_EMIT labelChanged(oldLabel, qnewName);
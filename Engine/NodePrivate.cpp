@@ -52,6 +52,9 @@ NodePrivate::NodePrivate(Node* publicInterface,
 , outputs()
 , inputsMutex()
 , inputs()
+, redirectedInputsMutex()
+, redirectedInputs()
+, redirectedInputsGeneration(0)
 , effect()
 , duringInteractAction(false)
 , nameMutex()
@@ -94,6 +97,9 @@ NodePrivate::NodePrivate(Node* publicInterface,
 , overlayActionsDraftEnabled(true)
 , nodeIsSelected(false)
 , restoringDefaults(false)
+, autoSaveSerializationMutex()
+, autoSaveSerialization()
+, autoSaveSerializationDirty(0)
 {
     nodePositionCoords[0] = nodePositionCoords[1] = INT_MIN;
     nodeSize[0] = nodeSize[1] = -1;
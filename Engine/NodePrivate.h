@@ -156,6 +156,16 @@ public:
     // vector of weak references to input nodes
     InputsV inputs;
 
+    // Protects redirectedInputs and redirectedInputsGeneration
+    mutable QMutex redirectedInputsMutex;
+
+    // Cache of the inputs with group redirections applied, i.e with the
+    // NodeGroup/GroupInput/GroupOutput passthrough chain already resolved to the node
+    // that actually renders. Only valid while redirectedInputsGeneration matches the
+    // process-wide graph topology generation, see Node::getInputInternal().
+    std::vector<NodeWPtr> redirectedInputs;
+    int redirectedInputsGeneration;
+
     // Pointer to the effect hosted by this node.
     // This is the main effect and cannot be used to render, instead
     // small lightweights render clones are created to render.
@@ -298,6 +308,14 @@ public:
     // True when restoreNodeToDefault is called
     bool restoringDefaults;
 
+    // Serialization of this node cached for differential auto-saves: auto-save reuses it
+    // instead of re-serializing every knob when nothing changed on the node since the last
+    // auto-save. Invalidation bumps autoSaveSerializationDirty so that a concurrent
+    // serialization cannot store a stale cache.
+    mutable QMutex autoSaveSerializationMutex;
+    SERIALIZATION_NAMESPACE::NodeSerializationPtr autoSaveSerialization;
+    U64 autoSaveSerializationDirty;
+
 };
 
 
@@ -311,9 +311,23 @@ Node::makePreviewImage(TimeValue time,
     // we convert only when input is Linear.
     // Rec709 and sRGB is acceptable for preview
     bool convertToSrgb = getApp()->getDefaultColorSpaceForBitDepth( img->getBitDepth() ) == eViewerColorSpaceLinear;
-    
+
+    return makePreviewFromImage(img, convertToSrgb, width, height, buf);
+} // makePreviewImage
+
+bool
+Node::makePreviewFromImage(const ImagePtr& image,
+                           bool convertToSrgb,
+                           int width,
+                           int height,
+                           unsigned int* buf)
+{
+    if (!image) {
+        return false;
+    }
+
     // Ensure we have an untiled format
-    ImagePtr imageForPreview = img;
+    ImagePtr imageForPreview = image;
     if (imageForPreview->getStorageMode() != eStorageModeRAM) {
 
         {
@@ -333,7 +347,7 @@ Node::makePreviewImage(TimeValue time,
         {
             Image::CopyPixelsArgs cpyArgs;
             cpyArgs.roi = imageForPreview->getBounds();
-            imageForPreview->copyPixels(*img, cpyArgs);
+            imageForPreview->copyPixels(*image, cpyArgs);
         }
 
     }
@@ -342,9 +356,9 @@ Node::makePreviewImage(TimeValue time,
     imageForPreview->getCPUData(&tileData);
 
     renderPreviewInternal((const void**)tileData.ptrs, tileData.bitDepth, tileData.bounds, tileData.nComps, width, height, convertToSrgb, buf);
-    
+
     return true;
-} // makePreviewImage
+} // makePreviewFromImage
 
 void
 Node::refreshPreviewsAfterProjectLoad()
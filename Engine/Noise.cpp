@@ -23,7 +23,9 @@
 #ifdef SEEXPR_USE_SSE
 #include <smmintrin.h>
 #endif
+#include <algorithm>
 #include <cmath>
+#include <vector>
 
 #ifndef  SEEXPR_USE_SSE
 GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_OFF
@@ -165,7 +167,85 @@ T noiseHelper(const T* X, const int* period = 0) {
     return vals[0];
 }
 
+//! Batched version of noiseHelper: evaluates a block of points per pass.
+//! The per-point work is split in passes over the block (lattice indices and weights,
+//! corner hashing, gradient dot products, multilinear interpolation): each pass is a
+//! tight loop over the points whose arithmetic the compiler can vectorize, only the
+//! permutation table lookups of the hash remain scalar. Performs exactly the same
+//! operations per point as noiseHelper so results are bit-exact with the scalar path.
+template <int d, class T>
+void noiseHelperMulti(const T* X, T* out, int nPoints) {
+    enum { blockSize = 8 };
+    const int num = 1 << d;
 
+    T weights[2][d][blockSize];  // lower and upper weights
+    int index[d][blockSize];
+    unsigned char lookups[1 << d][blockSize];
+    T vals[1 << d][blockSize];
+    T alphas[d][blockSize];
+
+    for (int start = 0; start < nPoints; start += blockSize) {
+        const int n = std::min(nPoints - start, (int)blockSize);
+        const T* Xblock = X + start * d;
+
+        // find lattice indices and weights
+        for (int k = 0; k < d; k++) {
+            for (int i = 0; i < n; i++) {
+                T x = Xblock[i * d + k];
+                T f = floorSSE(x);
+                index[k][i] = (int)f;
+                weights[0][k][i] = x - f;
+                weights[1][k][i] = weights[0][k][i] - 1;  // dist to cell with index one above
+            }
+        }
+        // hash each lattice corner of each point to get its gradient index
+        for (int dummy = 0; dummy < num; dummy++) {
+            for (int i = 0; i < n; i++) {
+                int latticeIndex[d];
+                for (int k = 0; k < d; k++) {
+                    latticeIndex[k] = index[k][i] + ((dummy & (1 << k)) != 0);
+                }
+                lookups[dummy][i] = hashReduceChar<d>(latticeIndex);
+            }
+        }
+        // compute function values propagated from zero from each node
+        for (int dummy = 0; dummy < num; dummy++) {
+            for (int i = 0; i < n; i++) {
+                T val = 0;
+                for (int k = 0; k < d; k++) {
+                    double grad = NOISE_TABLES<d>::g[lookups[dummy][i]][k];
+                    double weight = weights[(dummy & (1 << k)) != 0][k][i];
+                    val += grad * weight;
+                }
+                vals[dummy][i] = val;
+            }
+        }
+        // compute linear interpolation coefficients
+        for (int k = 0; k < d; k++) {
+            for (int i = 0; i < n; i++) {
+                alphas[k][i] = s_curve(weights[0][k][i]);
+            }
+        }
+        // perform multilinear interpolation (i.e. linear, bilinear, trilinear, quadralinear)
+        for (int newd = d - 1; newd >= 0; newd--) {
+            int newnum = 1 << newd;
+            int k = (d - newd - 1);
+            for (int dummy = 0; dummy < newnum; dummy++) {
+                int idx = dummy * (1 << (d - newd));
+                int otherIndex = idx + (1 << k);
+                for (int i = 0; i < n; i++) {
+                    T alpha = alphas[k][i];
+                    T beta = T(1) - alpha;
+                    vals[idx][i] = beta * vals[idx][i] + alpha * vals[otherIndex][i];
+                }
+            }
+        }
+        // store reduced versions
+        for (int i = 0; i < n; i++) {
+            out[start + i] = vals[0][i];
+        }
+    }
+}
 
 
 //! Computes cellular noise (non-interpolated piecewise constant cell random values)
@@ -238,6 +318,42 @@ void FBM(const T* in, T* out, int octaves, T lacunarity, T gain) {
     }
 }
 
+//! Batched Noise with d_in dimensional domain, d_out dimensional abcissa
+//! If turbulence is true then Perlin's turbulence is computed
+//! Applies the same per-octave and per-dimension position updates as FBM/Noise,
+//! in the same order, so results are bit-exact with the scalar path.
+template <int d_in, int d_out, bool turbulence, class T>
+void FBMMulti(const T* in, T* out, int nPoints, int octaves, T lacunarity, T gain) {
+    std::vector<T> P( in, in + (size_t)nPoints * d_in );
+    std::vector<T> Pdim( (size_t)nPoints * d_in );
+    std::vector<T> localResult(nPoints);
+
+    T scale = 1;
+    for (size_t k = 0, kmax = (size_t)nPoints * d_out; k < kmax; k++) out[k] = 0;
+    int octave = 0;
+    while (1) {
+        Pdim = P;
+        int dim = 0;
+        while (1) {
+            noiseHelperMulti<d_in, T>(&Pdim[0], &localResult[0], nPoints);
+            if (turbulence)
+                for (int i = 0; i < nPoints; i++) out[i * d_out + dim] += fabs(localResult[i]) * scale;
+            else
+                for (int i = 0; i < nPoints; i++) out[i * d_out + dim] += localResult[i] * scale;
+            if (++dim >= d_out) break;
+            // coverity[dead_error_begin]
+            for (int i = 0; i < nPoints; i++)
+                for (int k = 0; k < d_out; k++) Pdim[i * d_in + k] += (T)1000;
+        }
+        if (++octave >= octaves) break;
+        scale *= gain;
+        for (size_t k = 0, kmax = (size_t)nPoints * d_in; k < kmax; k++) {
+            P[k] *= lacunarity;
+            P[k] += (T)1234;
+        }
+    }
+}
+
 // Explicit instantiations
 template void CellNoise<3, 1, double>(const double*, double*);
 template void CellNoise<3, 3, double>(const double*, double*);
@@ -254,6 +370,12 @@ template void FBM<3, 3, false, double>(const double*, double*, int, double, doub
 template void FBM<3, 3, true, double>(const double*, double*, int, double, double);
 template void FBM<4, 1, false, double>(const double*, double*, int, double, double);
 template void FBM<4, 3, false, double>(const double*, double*, int, double, double);
+template void FBMMulti<3, 1, false, double>(const double*, double*, int, int, double, double);
+template void FBMMulti<3, 1, true, double>(const double*, double*, int, int, double, double);
+template void FBMMulti<3, 3, false, double>(const double*, double*, int, int, double, double);
+template void FBMMulti<3, 3, true, double>(const double*, double*, int, int, double, double);
+template void FBMMulti<4, 1, false, double>(const double*, double*, int, int, double, double);
+template void FBMMulti<4, 3, false, double>(const double*, double*, int, int, double, double);
 NATRON_NAMESPACE_EXIT
 
 #ifdef MAINTEST
@@ -61,6 +61,14 @@ void PNoise(const T* in, const int* period, T* out);
 template <int d_in, int d_out, bool turbulence, class T>
 void FBM(const T* in, T* out, int octaves, T lacunarity, T gain);
 
+//! Batched Fractional Brownian Motion: evaluates nPoints positions per call.
+//! in points to nPoints*d_in contiguous coordinates, out to nPoints*d_out results.
+//! This is bit-exact with calling FBM() on each point: the batched kernels perform
+//! the same operations in the same order, only restructured in passes over blocks
+//! of points so that the lattice, gradient and interpolation arithmetic vectorizes.
+template <int d_in, int d_out, bool turbulence, class T>
+void FBMMulti(const T* in, T* out, int nPoints, int octaves, T lacunarity, T gain);
+
 //! Cellular noise with input and output dimensionality
 template <int d_in, int d_out, class T>
 void CellNoise(const T* in, T* out);
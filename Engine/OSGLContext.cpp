@@ -48,6 +48,7 @@
 
 #include "Engine/AppManager.h"
 #include "Engine/GPUContextPool.h"
+#include "Engine/Timer.h" // ScopedProfilerSample
 
 #include "Global/GLIncludes.h"
 
@@ -118,6 +119,33 @@ static  const char* copyTex_FragmentShader =
 "   gl_FragColor = texture2D(srcTex,gl_TexCoord[0].st);\n"
 "}";
 
+// The transfer functions below match the formulas used by the Color::Lut code
+// (Engine/Lut.h and Engine/Lut.cpp), evaluated analytically per pixel.
+static const char* colorspaceConversion_FragmentShader =
+"uniform sampler2D srcTex;\n"
+"\n"
+"float fromSRGB(float v) { return (v < 0.04045) ? ((v < 0.0) ? 0.0 : v / 12.92) : pow((v + 0.055) / 1.055, 2.4); }\n"
+"float toSRGB(float v) { return (v < 0.0031308) ? ((v < 0.0) ? 0.0 : v * 12.92) : 1.055 * pow(v, 1.0 / 2.4) - 0.055; }\n"
+"float fromRec709(float v) { return (v < 0.08145) ? ((v < 0.0) ? 0.0 : v / 4.5) : pow((v + 0.0993) / 1.0993, 1.0 / 0.45); }\n"
+"float toRec709(float v) { return (v < 0.0181) ? ((v < 0.0) ? 0.0 : v * 4.5) : 1.0993 * pow(v, 0.45) - 0.0993; }\n"
+"\n"
+"void main() {\n"
+"   vec4 c = texture2D(srcTex,gl_TexCoord[0].st);\n"
+"#ifdef SRC_SRGB\n"
+"   c.rgb = vec3(fromSRGB(c.r), fromSRGB(c.g), fromSRGB(c.b));\n"
+"#endif\n"
+"#ifdef SRC_REC709\n"
+"   c.rgb = vec3(fromRec709(c.r), fromRec709(c.g), fromRec709(c.b));\n"
+"#endif\n"
+"#ifdef DST_SRGB\n"
+"   c.rgb = vec3(toSRGB(c.r), toSRGB(c.g), toSRGB(c.b));\n"
+"#endif\n"
+"#ifdef DST_REC709\n"
+"   c.rgb = vec3(toRec709(c.r), toRec709(c.g), toRec709(c.b));\n"
+"#endif\n"
+"   gl_FragColor = c;\n"
+"}";
+
 
 
 const FramebufferConfig&
@@ -313,6 +341,7 @@ struct OSGLContextPrivate
     GLShaderBasePtr copyTexShader;
     std::vector<GLShaderBasePtr> applyMaskMixShader;
     std::vector<GLShaderBasePtr> copyUnprocessedChannelsShader;
+    std::vector<GLShaderBasePtr> colorspaceConversionShader;
 
     OSGLContextPrivate(bool useGPUContext)
         : useGPUContext(useGPUContext)
@@ -333,6 +362,7 @@ struct OSGLContextPrivate
         , fillImageShader()
         , applyMaskMixShader(4)
         , copyUnprocessedChannelsShader(16)
+        , colorspaceConversionShader(9)
     {
 
     }
@@ -651,6 +681,13 @@ OSGLContext::getCurrentThread() const
     return _imp->threadOwningContext;
 }
 
+bool
+OSGLContext::isBusyWithAnotherThread() const
+{
+    QMutexLocker k(&_imp->threadOwningContextMutex);
+    return _imp->threadOwningContext != 0 && _imp->threadOwningContext != QThread::currentThread();
+}
+
 
 bool
 OSGLContext::stringInExtensionString(const char* string,
@@ -909,6 +946,78 @@ OSGLContext::getOrCreateMaskMixShader(bool maskEnabled, bool maskInvert)
     return _imp->applyMaskMixShader[shader_i];
 }
 
+GLShaderBasePtr
+OSGLContext::getOrCreateColorspaceConversionShader(ViewerColorSpaceEnum srcColorSpace,
+                                                   ViewerColorSpaceEnum dstColorSpace)
+{
+    int shader_i = (int)srcColorSpace * 3 + (int)dstColorSpace;
+    assert( shader_i >= 0 && shader_i < (int)_imp->colorspaceConversionShader.size() );
+    if (_imp->colorspaceConversionShader[shader_i]) {
+        return _imp->colorspaceConversionShader[shader_i];
+    }
+    if (_imp->useGPUContext) {
+        _imp->colorspaceConversionShader[shader_i] = getOrCreateColorspaceConversionShaderInternal<GL_GPU>(srcColorSpace, dstColorSpace);
+    } else {
+        _imp->colorspaceConversionShader[shader_i] = getOrCreateColorspaceConversionShaderInternal<GL_CPU>(srcColorSpace, dstColorSpace);
+    }
+
+    return _imp->colorspaceConversionShader[shader_i];
+}
+
+template <typename GL>
+static boost::shared_ptr<GLShader<GL> >
+getOrCreateColorspaceConversionShaderInternal(ViewerColorSpaceEnum srcColorSpace, ViewerColorSpaceEnum dstColorSpace)
+{
+    boost::shared_ptr<GLShader<GL> > shader( new GLShader<GL>() );
+
+    std::string fragmentSource;
+    switch (srcColorSpace) {
+        case eViewerColorSpaceSRGB:
+            fragmentSource += "#define SRC_SRGB\n";
+            break;
+        case eViewerColorSpaceRec709:
+            fragmentSource += "#define SRC_REC709\n";
+            break;
+        case eViewerColorSpaceLinear:
+            break;
+    }
+    switch (dstColorSpace) {
+        case eViewerColorSpaceSRGB:
+            fragmentSource += "#define DST_SRGB\n";
+            break;
+        case eViewerColorSpaceRec709:
+            fragmentSource += "#define DST_REC709\n";
+            break;
+        case eViewerColorSpaceLinear:
+            break;
+    }
+
+    fragmentSource += std::string(colorspaceConversion_FragmentShader);
+
+#ifdef DEBUG
+    std::string error;
+    bool ok = shader->addShader(GLShader<GL>::eShaderTypeFragment, fragmentSource.c_str(), &error);
+    if (!ok) {
+        qDebug() << error.c_str();
+    }
+#else
+    bool ok = shader->addShader(GLShader<GL>::eShaderTypeFragment, fragmentSource.c_str(), 0);
+#endif
+    assert(ok);
+#ifdef DEBUG
+    ok = shader->link(&error);
+    if (!ok) {
+        qDebug() << error.c_str();
+    }
+#else
+    ok = shader->link();
+#endif
+    assert(ok);
+    Q_UNUSED(ok);
+
+    return shader;
+}
+
 GLShaderBasePtr
 OSGLContext::getOrCreateCopyUnprocessedChannelsShader(bool doR,
                                                                   bool doG,
@@ -1017,6 +1126,7 @@ void
 OSGLContextAttacher::attach()
 {
     if (!_attached) {
+        ScopedProfilerSample profilerSample(eProfilerCategoryGL, "OSGLContextAttacher::attach");
         appPTR->getGPUContextPool()->registerContextForThread(shared_from_this());
         _c->setContextCurrentInternal(_width, _height, _rowWidth, _buffer);
         _attached = true;
@@ -139,6 +139,14 @@ public:
                                                              bool doB,
                                                              bool doA);
 
+    /**
+     * @brief Returns a shader converting RGB from srcColorSpace to dstColorSpace, leaving alpha
+     * untouched. The transfer functions are evaluated analytically per pixel with the same
+     * formulas as the Color::Lut code: unlike sampling an interpolated 1D lut texture, the
+     * result does not depend on the driver's texture filtering precision.
+     **/
+    GLShaderBasePtr getOrCreateColorspaceConversionShader(ViewerColorSpaceEnum srcColorSpace, ViewerColorSpaceEnum dstColorSpace);
+
 
 
     static void unsetCurrentContextNoRenderInternal(bool useGPU, OSGLContext* context);
@@ -150,6 +158,14 @@ public:
 
     QThread* getCurrentThread() const;
 
+    /**
+     * @brief Returns true if the context is currently made current by a thread other than the
+     * calling one, in which case attaching it would block until that render finishes.
+     * This is a best-effort hint: the context may be grabbed by another thread right after
+     * this returns.
+     **/
+    bool isBusyWithAnotherThread() const;
+
     /**
      * @brief Helper function to setup the OpenGL viewport when doing processing on a texture
      **/
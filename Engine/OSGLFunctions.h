@@ -652,6 +652,17 @@ public:
         return USEOPENGL;
     }
 
+    static bool isTimerQueryAvailable()
+    {
+        // The pointers are left null by load_functions() when the driver does not
+        // expose ARB_timer_query (e.g: some OSMesa builds)
+        return getInstance()._glGenQueries &&
+               getInstance()._glDeleteQueries &&
+               getInstance()._glBeginQuery &&
+               getInstance()._glEndQuery &&
+               getInstance()._glGetQueryObjectuiv;
+    }
+
     static void CullFace(GLenum mode)
     {
         getInstance()._glCullFace(mode);
@@ -4597,6 +4608,78 @@ public:
 typedef OSGLFunctions<true> GL_GPU;
 typedef OSGLFunctions<false> GL_CPU;
 
+// Defined by ARB_timer_query, which may be absent from the headers we generate from
+#ifndef GL_TIME_ELAPSED
+#define GL_TIME_ELAPSED 0x88BF
+#endif
+
+/**
+ * @brief Measures the time spent by the GPU executing the GL commands issued between the
+ * construction and stop() (or destruction) of this object, with a GL_TIME_ELAPSED query.
+ * If the driver does not support timer queries this class does nothing and reports 0.
+ * The GL context must be current for the whole lifetime of the object and timer queries
+ * cannot be nested.
+ **/
+template <bool USEOPENGL>
+class OSGLTimeElapsedQuery
+{
+public:
+
+    OSGLTimeElapsedQuery()
+    : _queryID(0)
+    , _running(false)
+    {
+        if ( OSGLFunctions<USEOPENGL>::isTimerQueryAvailable() ) {
+            OSGLFunctions<USEOPENGL>::GenQueries(1, &_queryID);
+            OSGLFunctions<USEOPENGL>::BeginQuery(GL_TIME_ELAPSED, _queryID);
+            _running = true;
+        }
+    }
+
+    ~OSGLTimeElapsedQuery()
+    {
+        stop();
+        if (_queryID) {
+            OSGLFunctions<USEOPENGL>::DeleteQueries(1, &_queryID);
+        }
+    }
+
+    /**
+     * @brief Stops measuring: GL commands issued after this call are not accounted for
+     **/
+    void stop()
+    {
+        if (_running) {
+            OSGLFunctions<USEOPENGL>::EndQuery(GL_TIME_ELAPSED);
+            _running = false;
+        }
+    }
+
+    /**
+     * @brief Returns the GPU time elapsed in seconds, blocking until the commands have
+     * completed on the device. The 32 bit query result wraps above ~4 seconds of GPU
+     * work, which is far beyond any render action we time.
+     **/
+    double getTimeElapsedSeconds()
+    {
+        if (!_queryID) {
+            return 0.;
+        }
+        stop();
+
+        // The result is expressed in nanoseconds
+        GLuint nanoSeconds = 0;
+        OSGLFunctions<USEOPENGL>::GetQueryObjectuiv(_queryID, GL_QUERY_RESULT, &nanoSeconds);
+
+        return nanoSeconds * 1e-9;
+    }
+
+private:
+
+    GLuint _queryID;
+    bool _running;
+};
+
 NATRON_NAMESPACE_EXIT;
 
 #endif // OSGLFUNCTIONS_H
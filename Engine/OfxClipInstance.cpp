@@ -1306,6 +1306,18 @@ static void ofxaApplyDistortionStack(double distortedX, double distortedY, const
     Distortion2DStack::applyDistortionStack(distortedX, distortedY, *dstack, undistortedX, undistortedY, wantsJacobian, gotJacobianOut, jacobian);
 }
 
+// Scanline-batched counterpart of kOfxPropInverseDistortionFunction, so that plug-ins walking their
+// render window can undistort a whole scanline per call instead of paying the function call and the
+// distortion stack walk per pixel. Jacobians are not computed, plug-ins needing them should use the
+// per-pixel function. Defined here until it is added to ofxNatron.h next to the per-pixel extension.
+#define kOfxPropInverseDistortionFunctionMultiV1 "OfxPropInverseDistortionFunctionMultiV1"
+
+static void ofxaApplyDistortionStackMulti(const double* distortedX, const double* distortedY, int pointsCount, const void* stack, double* undistortedX, double* undistortedY)
+{
+    const Distortion2DStack* dstack = (const Distortion2DStack*)stack;
+    Distortion2DStack::applyDistortionStack(distortedX, distortedY, pointsCount, *dstack, undistortedX, undistortedY);
+}
+
 OfxImageCommon::OfxImageCommon(const EffectInstancePtr& outputClipEffect,
                                int inputNb,
                                OFX::Host::ImageEffect::ImageBase* ofxImageBase,
@@ -1479,6 +1491,8 @@ OfxImageCommon::OfxImageCommon(const EffectInstancePtr& outputClipEffect,
                 { kOfxPropInverseDistortionFunction, OFX::Host::Property::ePointer, 1, true, NULL },
                 // if kOfxPropDistortionFunction is set, this a pointer to the data that must be passed to the distortion function
                 { kOfxPropInverseDistortionFunctionData, OFX::Host::Property::ePointer, 1, true, NULL },
+                // Batched variant of kOfxPropInverseDistortionFunction operating on arrays of positions, taking the same data pointer
+                { kOfxPropInverseDistortionFunctionMultiV1, OFX::Host::Property::ePointer, 1, true, NULL },
                 OFX::Host::Property::propSpecEnd
             };
             ofxImageBase->addProperties(propSpec);
@@ -1486,6 +1500,7 @@ OfxImageCommon::OfxImageCommon(const EffectInstancePtr& outputClipEffect,
 
             ofxImageBase->setPointerProperty(kOfxPropInverseDistortionFunction, (void*)&ofxaApplyDistortionStack);
             ofxImageBase->setPointerProperty(kOfxPropInverseDistortionFunctionData, (void*)distortion.get());
+            ofxImageBase->setPointerProperty(kOfxPropInverseDistortionFunctionMultiV1, (void*)&ofxaApplyDistortionStackMulti);
         }
 
 
@@ -879,11 +879,18 @@ OfxHost::loadOFXPlugins(IOPluginsMap* readersMap,
     qDebug() << "Load OFX Plugins: scan plugins... done!";
     _imp->loadingPluginID.clear(); // finished loading plugins
 
-    // write the cache NOW (it won't change anyway)
-    qDebug() << "Load OFX Plugins: writing cache file" << ofxCacheFilePath;
-    /// flush out the current cache
-    writeOFXCache();
-    qDebug() << "Load OFX Plugins: writing cache file... done!";
+    // Write the cache NOW (it won't change anyway), but only if the scan actually
+    // invalidated it: on a warm start with an unchanged plug-ins install, the cache
+    // is clean and serializing it again would just rewrite the same (potentially
+    // large) XML file on every launch.
+    if ( pluginCache->dirty() ) {
+        qDebug() << "Load OFX Plugins: writing cache file" << ofxCacheFilePath;
+        /// flush out the current cache
+        writeOFXCache();
+        qDebug() << "Load OFX Plugins: writing cache file... done!";
+    } else {
+        qDebug() << "Load OFX Plugins: cache is up-to-date, no need to write it";
+    }
 
     /*Filling node name list and plugin grouping*/
     typedef std::map<OFX::Host::ImageEffect::MajorPlugin, OFX::Host::ImageEffect::ImageEffectPlugin *> PMap;
@@ -32,6 +32,7 @@ CLANG_DIAG_OFF(deprecated)
 CLANG_DIAG_ON(deprecated)
 
 #include "Engine/EffectInstance.h"
+#include "Engine/Node.h"
 
 NATRON_NAMESPACE_ENTER;
 
@@ -42,7 +43,14 @@ OfxMemory::OfxMemory(const EffectInstancePtr& effect)
     , _lock()
     , _lockedCount(0)
 {
-    
+    // Attribute the memory to the effect right away: allocations made directly through the
+    // OFX memory suite do not go through EffectInstance::createMemoryChunk()
+    if (effect) {
+        NodePtr node = effect->getNode();
+        if (node) {
+            setMemoryAttribution( node->getFullyQualifiedName(), node->getPluginID() );
+        }
+    }
 }
 
 OfxMemory::~OfxMemory()
@@ -132,6 +132,15 @@ public:
         // of the tree. This is used in turn by the timeline to update the cached frames line.
         ImageCacheKeyPtr viewerProcessNodeKey;
 
+        // If true, the image was rendered with the cache disabled (e.g: from the refresh button):
+        // the viewer must not serve this frame from a previously uploaded texture.
+        bool byPassCache;
+
+        // The identifier of the user interaction the render of this image was tagged with,
+        // 0 if untagged. When the texture is flipped to the front the viewer reports the
+        // latency of the interaction, see InteractionLatencyTracker.
+        U64 interactionId;
+
         TextureTransferArgs()
         : type(eTextureTransferTypeReplace)
         , textureIndex(0)
@@ -144,6 +153,8 @@ public:
         , recenterViewer(false)
         , viewportCenter()
         , viewerProcessNodeKey()
+        , byPassCache(false)
+        , interactionId(0)
         {
 
         }
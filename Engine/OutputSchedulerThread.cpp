@@ -29,6 +29,7 @@
 #include <list>
 #include <algorithm> // min, max
 #include <cassert>
+#include <climits> // INT_MIN
 #include <stdexcept>
 #include <sstream> // stringstream
 
@@ -44,7 +45,9 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 #include <QtCore/QWaitCondition>
 #include <QtCore/QCoreApplication>
 #include <QtCore/QString>
+#include <QtCore/QThread>
 #include <QtCore/QThreadPool>
+#include <QtCore/QTimer>
 #include <QtCore/QDebug>
 #include <QtCore/QTextStream>
 #include <QtCore/QRunnable>
@@ -59,6 +62,9 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 
 #include "Engine/AppManager.h"
 #include "Engine/AppInstance.h"
+#include "Engine/Cache.h"
+#include "Engine/CacheWarmupQueue.h"
+#include "Engine/DiskCacheNode.h"
 #include "Engine/EffectInstance.h"
 #include "Engine/FrameViewRequest.h"
 #include "Engine/ImageCacheKey.h"
@@ -68,11 +74,14 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 #include "Engine/Node.h"
 #include "Engine/KnobItemsTable.h"
 #include "Engine/OpenGLViewerI.h"
+#include "Engine/ProcessFrameRing.h"
 #include "Global/FStreamsSupport.h"
 #include "Engine/GenericSchedulerThreadWatcher.h"
 #include "Engine/Project.h"
+#include "Engine/RenderQueue.h"
 #include "Engine/RenderStats.h"
 #include "Engine/Settings.h"
+#include "Engine/ThreadPool.h"
 #include "Engine/Timer.h"
 #include "Engine/TimeLine.h"
 #include "Engine/TreeRender.h"
@@ -93,6 +102,18 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 
 #define NATRON_SCHEDULER_ABORT_AFTER_X_UNSUCCESSFUL_ITERATIONS 5000
 
+// The maximum number of frames that may be rendered concurrently by the adaptive scheduler
+#define NATRON_SCHEDULER_MAX_CONCURRENT_FRAMES 8
+
+// Smoothing factor of the per-frame render time and memory growth moving averages
+#define NATRON_SCHEDULER_STATS_EMA_WEIGHT 0.25
+
+// Number of nodes retained per frame by the frame-budget watchdog when a frame misses its deadline
+#define NATRON_SCHEDULER_BUDGET_TOP_NODES 5
+
+// Maximum number of missed frames kept in the rolling log of the frame-budget watchdog
+#define NATRON_SCHEDULER_BUDGET_LOG_SIZE 100
+
 NATRON_NAMESPACE_ENTER;
 
 
@@ -118,8 +139,135 @@ public:
     }
 };
 
+// One node entry of a missed frame: how long the node spent rendering within the frame
+struct FrameBudgetNodeTime
+{
+    std::string nodeName;
+    double timeSpentSec;
+
+    FrameBudgetNodeTime()
+    : nodeName()
+    , timeSpentSec(0)
+    {
+    }
+};
+
+struct FrameBudgetNodeTime_CompareDecreasingTime
+{
+    bool operator() (const FrameBudgetNodeTime& lhs,
+                     const FrameBudgetNodeTime& rhs) const
+    {
+        return lhs.timeSpentSec > rhs.timeSpentSec;
+    }
+};
+
+// A frame that took longer to render than the playback frame budget (1/fps)
+struct MissedFrameRecord
+{
+    TimeValue frame;
+    double renderTimeSec;
+    double budgetSec;
+
+    // The most expensive nodes of the frame, by decreasing time spent. Only filled
+    // when in-depth render stats were enabled for the render.
+    std::vector<FrameBudgetNodeTime> slowestNodes;
+
+    MissedFrameRecord()
+    : frame(0)
+    , renderTimeSec(0)
+    , budgetSec(0)
+    , slowestNodes()
+    {
+    }
+};
+
+// Cumulated figures of one node across all missed frames of the session
+struct FrameBudgetNodeStat
+{
+    U64 nFramesOverBudget;
+    double timeSpentSec;
+
+    FrameBudgetNodeStat()
+    : nFramesOverBudget(0)
+    , timeSpentSec(0)
+    {
+    }
+};
+
+// Session-wide record of the frames that missed their playback budget, shared by all
+// schedulers and maintained by OutputSchedulerThread::notifyFrameRendered()
+struct FrameBudgetLog
+{
+    QMutex lock;
+
+    // Rolling log of the last missed frames
+    std::list<MissedFrameRecord> missedFrames;
+
+    // Total number of missed frames, including those evicted from the rolling log
+    U64 nMissedFrames;
+
+    // Per-node figures cumulated over all missed frames
+    std::map<std::string, FrameBudgetNodeStat> slowNodes;
+
+    FrameBudgetLog()
+    : lock()
+    , missedFrames()
+    , nMissedFrames(0)
+    , slowNodes()
+    {
+    }
+};
+
 NATRON_NAMESPACE_ANONYMOUS_EXIT
 
+static FrameBudgetLog&
+getFrameBudgetLog()
+{
+    static FrameBudgetLog log;
+
+    return log;
+}
+
+static void
+recordFrameOverBudget(TimeValue frame,
+                      double renderTimeSec,
+                      double budgetSec,
+                      const std::map<NodePtr, NodeRenderStats>& statsMap)
+{
+    MissedFrameRecord record;
+
+    record.frame = frame;
+    record.renderTimeSec = renderTimeSec;
+    record.budgetSec = budgetSec;
+
+    std::vector<FrameBudgetNodeTime> nodeTimes;
+    nodeTimes.reserve( statsMap.size() );
+    for (std::map<NodePtr, NodeRenderStats>::const_iterator it = statsMap.begin(); it != statsMap.end(); ++it) {
+        FrameBudgetNodeTime t;
+        t.nodeName = it->first->getScriptName_mt_safe();
+        t.timeSpentSec = it->second.getTotalTimeSpentRendering();
+        nodeTimes.push_back(t);
+    }
+    std::sort( nodeTimes.begin(), nodeTimes.end(), FrameBudgetNodeTime_CompareDecreasingTime() );
+    if ( (int)nodeTimes.size() > NATRON_SCHEDULER_BUDGET_TOP_NODES ) {
+        nodeTimes.resize(NATRON_SCHEDULER_BUDGET_TOP_NODES);
+    }
+    record.slowestNodes = nodeTimes;
+
+    FrameBudgetLog& log = getFrameBudgetLog();
+    QMutexLocker k(&log.lock);
+
+    ++log.nMissedFrames;
+    log.missedFrames.push_back(record);
+    if (log.missedFrames.size() > NATRON_SCHEDULER_BUDGET_LOG_SIZE) {
+        log.missedFrames.pop_front();
+    }
+    for (std::size_t i = 0; i < nodeTimes.size(); ++i) {
+        FrameBudgetNodeStat& stat = log.slowNodes[nodeTimes[i].nodeName];
+        ++stat.nFramesOverBudget;
+        stat.timeSpentSec += nodeTimes[i].timeSpentSec;
+    }
+} // recordFrameOverBudget
 
 static MetaTypesRegistration registration;
 struct RenderThread
@@ -170,6 +318,10 @@ struct OutputSchedulerThreadPrivate
     QWaitCondition bufEmptyCondition;
     mutable QMutex bufMutex;
 
+    // The frames skipped by realtime playback because their render missed the frame deadline,
+    // collected so they can be warmed in the cache once playback stops. Protected by bufMutex
+    std::set<double> skippedPlaybackFrames;
+
     //doesn't need any protection since it never changes and is set in the constructor
     OutputSchedulerThread::ProcessFrameModeEnum mode; //is the frame to be processed on the main-thread (i.e OpenGL rendering) or on the scheduler thread
     boost::scoped_ptr<Timer> timer; // Timer regulating the engine execution. It is controlled by the GUI and MT-safe.
@@ -229,6 +381,22 @@ struct OutputSchedulerThreadPrivate
     mutable QMutex sequentialRenderQueueMutex;
     std::list<RenderSequenceArgs> sequentialRenderQueue;
 
+    // Protects the adaptive frame concurrency data below
+    mutable QMutex frameConcurrencyMutex;
+
+    // The current target number of frames rendered concurrently. Starts at 1 for each render
+    // and is adjusted by notifyFrameRenderTime() each time a frame render completes.
+    int nConcurrentFrameRenders;
+
+    // Exponential moving average of the wall time (seconds) spent rendering a single frame
+    double averageFrameRenderTimeSec;
+
+    // Exponential moving average of the tile cache growth (bytes) per rendered frame
+    double averageFrameMemoryGrowth;
+
+    // The size of the tile cache when the last frame render completed
+    std::size_t lastFrameCacheSize;
+
 
     OutputSchedulerThreadPrivate(RenderEngine* engine,
                                  OutputSchedulerThread* publicInterface,
@@ -238,6 +406,7 @@ struct OutputSchedulerThreadPrivate
         , buf()
         , bufEmptyCondition()
         , bufMutex()
+        , skippedPlaybackFrames()
         , mode(mode)
         , timer(new Timer)
         , renderTimer()
@@ -261,6 +430,11 @@ struct OutputSchedulerThreadPrivate
         , lastBufferedOutputSize(0)
         , sequentialRenderQueueMutex()
         , sequentialRenderQueue()
+        , frameConcurrencyMutex()
+        , nConcurrentFrameRenders(1)
+        , averageFrameRenderTimeSec(0)
+        , averageFrameMemoryGrowth(0)
+        , lastFrameCacheSize(0)
     {
     }
 
@@ -309,7 +483,9 @@ struct OutputSchedulerThreadPrivate
         // Instead we explicitly manage them and ensure they do not hold any external strong refs.
         runnable->setAutoDelete(false);
         renderThreads.push_back(r);
-        QThreadPool::globalInstance()->start(runnable.get());
+
+        // Frame render tasks are scheduled behind viewer-interactive tasks, see ThreadPoolTaskPriorityEnum
+        QThreadPool::globalInstance()->start(runnable.get(), (int)eThreadPoolTaskPriorityBackgroundRender);
     }
 
     RenderThreads::iterator getRunnableIterator(RenderThreadTask* runnable)
@@ -554,8 +730,20 @@ OutputSchedulerThread::startTasks(TimeValue startingFrame)
         _imp->lastFrameRequested = startingFrame;
     } else {
 
-        // For now just run one frame concurrently, it is better to try to render one frame the fastest
-        const int nConcurrentFrames = 1;
+        // Launch as many frames as needed to reach the adaptive concurrency target.
+        // The target starts at 1 for each render so the first frame gets all threads,
+        // then notifyFrameRenderTime() adjusts it from the measured per-frame render
+        // time, the thread pool usage and the tile cache memory pressure.
+        int nConcurrentFrames;
+        {
+            QMutexLocker k(&_imp->frameConcurrencyMutex);
+            nConcurrentFrames = _imp->nConcurrentFrameRenders;
+        }
+        {
+            QMutexLocker k(&_imp->renderThreadsMutex);
+            nConcurrentFrames -= (int)_imp->renderThreads.size();
+        }
+        nConcurrentFrames = std::max(1, nConcurrentFrames);
 
         TimeValue frame = startingFrame;
         RenderDirectionEnum newDirection = args->direction;
@@ -598,6 +786,126 @@ OutputSchedulerThread::notifyThreadAboutToQuit(RenderThreadTask* thread)
     }
 }
 
+void
+OutputSchedulerThread::notifyFrameRenderTime(double frameRenderTimeSec)
+{
+    CachePtr tileCache = appPTR->getTileCache();
+    const std::size_t cacheSize = tileCache->getCurrentSize();
+    const std::size_t cacheMaxSize = tileCache->getMaximumCacheSize();
+
+    QThreadPool* tp = QThreadPool::globalInstance();
+    const bool hasIdleThreads = tp->activeThreadCount() < tp->maxThreadCount();
+
+    QMutexLocker k(&_imp->frameConcurrencyMutex);
+
+    // Did this frame take significantly longer than the running average? If so the
+    // concurrent renders are probably contending for threads or cache space.
+    const bool frameTimeDegraded = _imp->averageFrameRenderTimeSec > 0 && frameRenderTimeSec > _imp->averageFrameRenderTimeSec * 1.5;
+
+    if (_imp->averageFrameRenderTimeSec == 0) {
+        _imp->averageFrameRenderTimeSec = frameRenderTimeSec;
+    } else {
+        _imp->averageFrameRenderTimeSec = _imp->averageFrameRenderTimeSec * (1. - NATRON_SCHEDULER_STATS_EMA_WEIGHT) + frameRenderTimeSec * NATRON_SCHEDULER_STATS_EMA_WEIGHT;
+    }
+
+    // Track how much the tile cache grows per rendered frame: this estimates the
+    // working set of a single frame so we do not launch more frames than memory allows.
+    if (cacheSize > _imp->lastFrameCacheSize) {
+        const double growth = (double)(cacheSize - _imp->lastFrameCacheSize);
+        if (_imp->averageFrameMemoryGrowth == 0) {
+            _imp->averageFrameMemoryGrowth = growth;
+        } else {
+            _imp->averageFrameMemoryGrowth = _imp->averageFrameMemoryGrowth * (1. - NATRON_SCHEDULER_STATS_EMA_WEIGHT) + growth * NATRON_SCHEDULER_STATS_EMA_WEIGHT;
+        }
+    }
+    _imp->lastFrameCacheSize = cacheSize;
+
+    int target = _imp->nConcurrentFrameRenders;
+    if (frameTimeDegraded || !hasIdleThreads) {
+        // The thread pool is saturated or frames started taking longer: back off.
+        --target;
+    } else {
+        // A lone frame render leaves part of the thread pool idle: ramp up.
+        ++target;
+    }
+
+    // Never launch more frames than the remaining cache memory can hold.
+    if (_imp->averageFrameMemoryGrowth > 0) {
+        const std::size_t headRoom = cacheMaxSize > cacheSize ? cacheMaxSize - cacheSize : 0;
+        const int memoryBound = (int)(headRoom / _imp->averageFrameMemoryGrowth);
+        target = std::min( target, std::max(1, memoryBound) );
+    }
+
+    _imp->nConcurrentFrameRenders = std::max( 1, std::min(target, NATRON_SCHEDULER_MAX_CONCURRENT_FRAMES) );
+} // notifyFrameRenderTime
+
+std::string
+OutputSchedulerThread::dumpFrameBudgetReport()
+{
+    FrameBudgetLog& log = getFrameBudgetLog();
+    QMutexLocker k(&log.lock);
+
+    std::stringstream finalStream;
+
+    finalStream << "Frames over the playback budget this session: " << log.nMissedFrames << std::endl;
+
+    if ( !log.slowNodes.empty() ) {
+
+        // Order the nodes by decreasing time spent in missed frames
+        std::vector<FrameBudgetNodeTime> nodeTimes;
+        nodeTimes.reserve( log.slowNodes.size() );
+        for (std::map<std::string, FrameBudgetNodeStat>::const_iterator it = log.slowNodes.begin(); it != log.slowNodes.end(); ++it) {
+            FrameBudgetNodeTime t;
+            t.nodeName = it->first;
+            t.timeSpentSec = it->second.timeSpentSec;
+            nodeTimes.push_back(t);
+        }
+        std::sort( nodeTimes.begin(), nodeTimes.end(), FrameBudgetNodeTime_CompareDecreasingTime() );
+
+        finalStream << std::endl;
+        finalStream << "Slowest nodes this session:" << std::endl;
+        finalStream << "_______________________________________________________________________________________" << std::endl;
+        finalStream << "| Time in missed frames | Frames over budget | Node" << std::endl;
+        finalStream << "_______________________________________________________________________________________" << std::endl;
+        for (std::size_t i = 0; i < nodeTimes.size(); ++i) {
+            const FrameBudgetNodeStat& stat = log.slowNodes.find(nodeTimes[i].nodeName)->second;
+            finalStream << "  " <<
+            QString::number(nodeTimes[i].timeSpentSec * 1000, 'f', 1).toStdString() << " ms\t\t" <<
+            stat.nFramesOverBudget << "\t\t" <<
+            nodeTimes[i].nodeName << std::endl;
+            finalStream << "_______________________________________________________________________________________" <<  std::endl;
+        }
+    }
+
+    if ( !log.missedFrames.empty() ) {
+        finalStream << std::endl;
+        finalStream << "Last missed frames:" << std::endl;
+        for (std::list<MissedFrameRecord>::const_iterator it = log.missedFrames.begin(); it != log.missedFrames.end(); ++it) {
+            finalStream << "Frame " << (double)it->frame << ": " <<
+            QString::number(it->renderTimeSec * 1000, 'f', 1).toStdString() << " ms (budget " <<
+            QString::number(it->budgetSec * 1000, 'f', 1).toStdString() << " ms)";
+            for (std::size_t i = 0; i < it->slowestNodes.size(); ++i) {
+                finalStream << (i == 0 ? ": " : ", ");
+                finalStream << it->slowestNodes[i].nodeName << " (" << QString::number(it->slowestNodes[i].timeSpentSec * 1000, 'f', 1).toStdString() << " ms)";
+            }
+            finalStream << std::endl;
+        }
+    }
+
+    return finalStream.str();
+} // dumpFrameBudgetReport
+
+void
+OutputSchedulerThread::resetFrameBudgetReport()
+{
+    FrameBudgetLog& log = getFrameBudgetLog();
+    QMutexLocker k(&log.lock);
+
+    log.missedFrames.clear();
+    log.nMissedFrames = 0;
+    log.slowNodes.clear();
+}
+
 void
 OutputSchedulerThread::startRender()
 {
@@ -639,6 +947,10 @@ OutputSchedulerThread::startRender()
         if (embeddedWriter) {
             node = embeddedWriter;
         }
+
+        // For writers that do not require in-order encoding, activate the background encode
+        // queue so that render threads overlap rendering with encoding.
+        isWrite->renderSequenceStarted();
     }
     SequentialPreferenceEnum pref = node->getEffectInstance()->getSequentialPreference();
     if ( (pref == eSequentialPreferenceOnlySequential) || (pref == eSequentialPreferencePreferSequential) ) {
@@ -668,6 +980,16 @@ OutputSchedulerThread::startRender()
         _imp->schedulerRenderDirection = direction;
     }
 
+    // Reset the adaptive frame concurrency: each render starts with a single
+    // concurrent frame and ramps up from the measured statistics.
+    {
+        QMutexLocker k(&_imp->frameConcurrencyMutex);
+        _imp->nConcurrentFrameRenders = 1;
+        _imp->averageFrameRenderTimeSec = 0;
+        _imp->averageFrameMemoryGrowth = 0;
+        _imp->lastFrameCacheSize = appPTR->getTileCache()->getCurrentSize();
+    }
+
     startTasks(startingFrame);
 
 
@@ -689,6 +1011,9 @@ OutputSchedulerThread::stopRender()
         if (embeddedWriter) {
             node = embeddedWriter;
         }
+
+        // Wait for the background encode queue to drain before notifying that the render finished
+        isWrite->renderSequenceEnd();
     }
     SequentialPreferenceEnum pref = node->getEffectInstance()->getSequentialPreference();
     if ( (pref == eSequentialPreferenceOnlySequential) || (pref == eSequentialPreferencePreferSequential) ) {
@@ -949,9 +1274,24 @@ OutputSchedulerThread::threadLoopOnce(const GenericThreadStartArgsPtr &inArgs)
 
         if (!renderFinished) {
             assert(state == eThreadStateActive);
-            QMutexLocker bufLocker (&_imp->bufMutex);
-            // Wait here for more frames to be rendered, we will be woken up once appendToBuffer is called
-            _imp->bufEmptyCondition.wait(&_imp->bufMutex);
+            bool frameMissedDeadline = false;
+            {
+                QMutexLocker bufLocker (&_imp->bufMutex);
+                // Wait here for more frames to be rendered, we will be woken up once appendToBuffer is called
+                if ( (_imp->timer->playState == ePlayStateRunning) && _imp->engine->isRealtimePlaybackEnabled() ) {
+                    // Realtime playback: wait for the expected frame no longer than one frame
+                    // period. Past that deadline the display must not stall on the unfinished
+                    // render: catch-up on the nearest rendered frame instead.
+                    double fps = _imp->timer->getDesiredFrameRate();
+                    unsigned long deadlineMs = (unsigned long)( 1000. / (fps > 0 ? fps : 24.) );
+                    frameMissedDeadline = !_imp->bufEmptyCondition.wait(&_imp->bufMutex, deadlineMs);
+                } else {
+                    _imp->bufEmptyCondition.wait(&_imp->bufMutex);
+                }
+            }
+            if (frameMissedDeadline) {
+                skipLateFramesAndCatchUp();
+            }
         } else {
             if ( !_imp->engine->isPlaybackAutoRestartEnabled() ) {
                 //Move the timeline to the last rendered frame to keep it in sync with what is displayed
@@ -966,6 +1306,82 @@ OutputSchedulerThread::threadLoopOnce(const GenericThreadStartArgsPtr &inArgs)
     return state;
 } // OutputSchedulerThread::threadLoopOnce
 
+void
+OutputSchedulerThread::skipLateFramesAndCatchUp()
+{
+    OutputSchedulerThreadStartArgsPtr args = getCurrentRunArgs();
+
+    if (!args) {
+        return;
+    }
+    TimeValue expected;
+    {
+        QMutexLocker k(&_imp->lastFrameRequestedMutex);
+        expected = _imp->expectedFrameToRender;
+    }
+
+    // Only the scheduler thread writes schedulerRenderDirection, and this runs on it
+    const bool forward = _imp->schedulerRenderDirection == eRenderDirectionForward;
+
+    // Find the nearest rendered frame in the playback direction. Also prune frames that were
+    // rendered behind the playhead after a previous catch-up: they will never be displayed.
+    bool foundTarget = false;
+    TimeValue skipTarget(0);
+    {
+        QMutexLocker l(&_imp->bufMutex);
+        for (FrameBuffer::iterator it = _imp->buf.begin(); it != _imp->buf.end();) {
+            const TimeValue t = (*it)->time;
+            if ( forward ? (t < expected) : (t > expected) ) {
+                FrameBuffer::iterator next = it;
+                ++next;
+                _imp->buf.erase(it);
+                it = next;
+                continue;
+            }
+            if ( forward ? (t > expected) : (t < expected) ) {
+                if ( !foundTarget || ( forward ? (t < skipTarget) : (t > skipTarget) ) ) {
+                    skipTarget = t;
+                    foundTarget = true;
+                }
+            }
+            ++it;
+        }
+    }
+    if (!foundTarget) {
+        // No frame beyond the late one is rendered yet: the display holds the last processed
+        // frame, there is nothing better to show.
+        return;
+    }
+
+    // The frames in-between missed their deadline: flag them so they can be warmed once
+    // playback stops.
+    const double step = forward ? (double)args->frameStep : -(double)args->frameStep;
+    for (double f = expected; forward ? (f < skipTarget) : (f > skipTarget); f += step) {
+        {
+            QMutexLocker l(&_imp->bufMutex);
+            _imp->skippedPlaybackFrames.insert(f);
+        }
+        _imp->engine->s_playbackFrameSkipped( (int)f );
+    }
+
+    {
+        QMutexLocker k(&_imp->lastFrameRequestedMutex);
+        _imp->expectedFrameToRender = skipTarget;
+    }
+} // OutputSchedulerThread::skipLateFramesAndCatchUp
+
+std::list<double>
+OutputSchedulerThread::takeSkippedPlaybackFrames()
+{
+    std::list<double> ret;
+    QMutexLocker l(&_imp->bufMutex);
+
+    ret.insert( ret.end(), _imp->skippedPlaybackFrames.begin(), _imp->skippedPlaybackFrames.end() );
+    _imp->skippedPlaybackFrames.clear();
+
+    return ret;
+}
+
 void
 OutputSchedulerThread::onAbortRequested(bool /*keepOldestRender*/)
 {
@@ -1009,6 +1425,25 @@ OutputSchedulerThread::notifyFrameRendered(const BufferedFrameContainerPtr& fram
 
     }
 
+    // Frame-budget watchdog: when playback is regulated by the fps timer, check whether the
+    // frame fit in its budget (1/fps) and record the most expensive nodes when it did not.
+    if (_imp->timer->playState == ePlayStateRunning) {
+        double fps = _imp->timer->getDesiredFrameRate();
+        if (fps > 0) {
+            const double budgetSec = 1. / fps;
+            for (std::list<BufferedFramePtr>::const_iterator it = frameContainer->frames.begin(); it != frameContainer->frames.end(); ++it) {
+                if ( !(*it)->stats ) {
+                    continue;
+                }
+                double renderTimeSec = 0.;
+                std::map<NodePtr, NodeRenderStats> statsMap = (*it)->stats->getStats(&renderTimeSec);
+                if (renderTimeSec > budgetSec) {
+                    recordFrameOverBudget(frameContainer->time, renderTimeSec, budgetSec, statsMap);
+                }
+            }
+        }
+    }
+
     bool isBackground = appPTR->isBackground();
     OutputSchedulerThreadStartArgsPtr runArgs = _imp->runArgs.lock();
     assert(runArgs);
@@ -1103,6 +1538,9 @@ OutputSchedulerThread::notifyFrameRendered(const BufferedFrameContainerPtr& fram
         runAfterFrameRenderedCallback(frameContainer->time);
     }
 
+    // Record the frame in the resume manifest of the job, see RenderCheckpointManifest
+    onFrameRenderedCheckpoint(frameContainer->time);
+
 } // OutputSchedulerThread::notifyFrameRendered
 
 void
@@ -1612,7 +2050,23 @@ RenderThreadTask::getScheduler() const
 void
 RenderThreadTask::run()
 {
+    // Baking to the DiskCache node is a background task: lower the thread priority for the
+    // duration of the frame so that it does not compete with interactive renders.
+    NodePtr output = _imp->output.lock();
+    const bool isDiskCacheBake = output && toDiskCacheNode( output->getEffectInstance() );
+    QThread* thisThread = QThread::currentThread();
+    if (isDiskCacheBake) {
+        thisThread->setPriority(QThread::LowPriority);
+    }
+
+    TimeLapse frameRenderTimer;
     renderFrame(_imp->time, _imp->viewsToRender, _imp->useRenderStats);
+    _imp->scheduler->notifyFrameRenderTime( frameRenderTimer.getTimeSinceCreation() );
+
+    if (isDiskCacheBake) {
+        // Thread pool threads are re-used for other renders: restore the default priority
+        thisThread->setPriority(QThread::NormalPriority);
+    }
     _imp->scheduler->notifyThreadAboutToQuit(this);
 }
 
@@ -1627,6 +2081,8 @@ DefaultScheduler::DefaultScheduler(RenderEngine* engine,
     : OutputSchedulerThread(engine, effect, eProcessFrameBySchedulerThread)
     , _currentTimeMutex()
     , _currentTime(0)
+    , _checkpointMutex()
+    , _checkpointManifestPath()
 {
     engine->setPlaybackMode(ePlaybackModeOnce);
 }
@@ -1741,13 +2197,32 @@ protected:
             return eActionStatusFailed;
         }
 
+        // If this is a background render launched from the GUI with a shared memory frame
+        // ring, record the frame now being rendered so that if we crash the GUI can report
+        // the frame that was in flight, and publish a preview of the image once rendered.
+        ProcessFrameRing* frameRing = appPTR->getBackgroundFrameRing();
+        if (frameRing) {
+            frameRing->notifyFrameStarted( (int)time );
+        }
+
         // If the output is a Write node, actually write is the internal write node encoder
-        {
-            WriteNodePtr isWrite = toWriteNode(outputNode->getEffectInstance());
-            if (isWrite) {
-                NodePtr embeddedWriter = isWrite->getEmbeddedWriter();
-                if (embeddedWriter) {
-                    outputNode = embeddedWriter;
+        bool queueEncode = false;
+        WriteNodePtr isWrite = toWriteNode(outputNode->getEffectInstance());
+        if (isWrite) {
+            NodePtr embeddedWriter = isWrite->getEmbeddedWriter();
+            if (embeddedWriter) {
+                outputNode = embeddedWriter;
+
+                // When the encode queue is active, this thread only renders the frame up to the
+                // input of the encoder: the encode itself is handed to the WriteNode encoder
+                // threads so that rendering of the next frames overlaps with the encoding of
+                // this one.
+                if ( isWrite->isEncodeQueueActive() ) {
+                    NodePtr writerInput = embeddedWriter->getInput(0);
+                    if (writerInput) {
+                        outputNode = writerInput;
+                        queueEncode = true;
+                    }
                 }
             }
         }
@@ -1786,9 +2261,23 @@ protected:
             retCode = render->launchRender(&outputRequest);
             if (!isFailureRetCode(retCode)) {
                 *imagePlane = outputRequest->getRequestedScaleImagePlane();
+
+                if (frameRing && *imagePlane) {
+                    // Same colorspace conversion as Node::makePreviewImage: only convert
+                    // when the image is linear.
+                    bool convertToSrgb = outputNode->getApp()->getDefaultColorSpaceForBitDepth( (*imagePlane)->getBitDepth() ) == eViewerColorSpaceLinear;
+                    frameRing->publishFramePreview( (int)time, *imagePlane, convertToSrgb );
+                }
             }
         }
 
+        if (queueEncode && !isFailureRetCode(retCode)) {
+            // The image is now cached up to the input of the encoder: schedule the encode on
+            // the WriteNode encoder threads. This blocks when the bounded queue is full
+            // (backpressure) and reports the failure of previously queued frames, if any.
+            retCode = isWrite->queueFrameEncode(time, view, stats);
+        }
+
         if (isFailureRetCode(retCode)) {
             return retCode;
         } else {
@@ -1819,21 +2308,81 @@ private:
         BufferedFrameContainerPtr frameContainer(new BufferedFrameContainer);
         frameContainer->time = time;
 
+        // Views whose view-aware tree hash are equal are guaranteed to produce the same image:
+        // EffectInstance::appendToHash only hashes the view on view variant effects, hence a
+        // stereo project where both views are identical below a JoinViews/OneView split yields
+        // the same hash for both views. Only render one view of each hash group.
+        // Writers are excluded from the de-duplication: each view must still go through the
+        // encoder to produce its file/part, and the upstream re-render is cheap since the images
+        // are in the cache. For each view this holds -1 if the view must be rendered, or the
+        // index in viewsToRender of the identical view that renders on its behalf.
+        std::vector<int> duplicateOfView(viewsToRender.size(), -1);
+        if ( viewsToRender.size() > 1 && !outputNode->getEffectInstance()->isWriter() ) {
+            std::map<U64, int> viewHashes;
+            for (std::size_t view = 0; view < viewsToRender.size(); ++view) {
+                HashableObject::ComputeHashArgs hashArgs;
+                hashArgs.time = time;
+                hashArgs.view = viewsToRender[view];
+                hashArgs.hashType = HashableObject::eComputeHashTypeTimeViewVariant;
+                U64 hash = outputNode->getEffectInstance()->computeHash(hashArgs);
+                std::map<U64, int>::const_iterator foundHash = viewHashes.find(hash);
+                if ( foundHash != viewHashes.end() ) {
+                    duplicateOfView[view] = foundHash->second;
+                } else {
+                    viewHashes.insert( std::make_pair( hash, (int)view ) );
+                }
+            }
+        }
+
+        // Views that do differ render concurrently: all but the first view to render are
+        // launched on the global thread pool, the first one renders in this thread.
+        std::vector<ImagePtr> viewImages(viewsToRender.size());
+        std::vector<ActionRetCodeEnum> viewStatus(viewsToRender.size(), eActionStatusOK);
+        std::vector<QFuture<ActionRetCodeEnum> > viewFutures(viewsToRender.size());
+        int mainThreadView = -1;
         for (std::size_t view = 0; view < viewsToRender.size(); ++view) {
-            
+            if (duplicateOfView[view] != -1) {
+                continue;
+            }
+            if (mainThreadView == -1) {
+                mainThreadView = (int)view;
+            } else {
+                viewFutures[view] = QtConcurrent::run(this,
+                                                      &DefaultRenderFrameRunnable::renderFrameInternal,
+                                                      outputNode,
+                                                      time,
+                                                      viewsToRender[view],
+                                                      stats,
+                                                      &viewImages[view]);
+            }
+        }
+        if (mainThreadView != -1) {
+            viewStatus[mainThreadView] = renderFrameInternal(outputNode, time, viewsToRender[mainThreadView], stats, &viewImages[mainThreadView]);
+        }
+
+        for (std::size_t view = 0; view < viewsToRender.size(); ++view) {
+
             BufferedFramePtr frame(new BufferedFrame);
             frame->view = viewsToRender[view];
             frame->stats = stats;
-            
-            ImagePtr imagePlane;
-            ActionRetCodeEnum stat = renderFrameInternal(outputNode, time, viewsToRender[view], stats, &imagePlane);
-            if (isFailureRetCode(stat)) {
-                _imp->scheduler->notifyRenderFailure(stat, std::string());
+
+            if (duplicateOfView[view] != -1) {
+                // Nothing was rendered for this view, it shares the image rendered by its
+                // identical sibling view. Do not report the sibling's failure twice.
+                viewStatus[view] = viewStatus[duplicateOfView[view]];
+            } else {
+                if ((int)view != mainThreadView) {
+                    // Waits for the render to finish
+                    viewStatus[view] = viewFutures[view].result();
+                }
+                if ( isFailureRetCode(viewStatus[view]) ) {
+                    _imp->scheduler->notifyRenderFailure(viewStatus[view], std::string());
+                }
             }
-            
+
             frameContainer->frames.push_back(frame);
         }
-        
+
         _imp->scheduler->notifyFrameRendered(frameContainer, eSchedulingPolicyFFA);
 
 
@@ -1913,6 +2462,18 @@ DefaultScheduler::aboutToStartRender()
         QMutexLocker k(&_currentTimeMutex);
         _currentTime  = args->startingFrame;
     }
+
+    // Set-up the resume manifest of the job: if a manifest of the same job already exists its
+    // recorded frames are kept, RenderQueue already removed them from the range to render.
+    {
+        std::string manifestPath = RenderCheckpointManifest::getManifestFilePath(outputNode);
+        if ( !manifestPath.empty() ) {
+            RenderCheckpointManifest::resetForJob( manifestPath, RenderCheckpointManifest::computeJobHash(outputNode) );
+        }
+        QMutexLocker k(&_checkpointMutex);
+        _checkpointManifestPath = manifestPath;
+    }
+
     bool isBackGround = appPTR->isBackground();
 
     if (isBackGround) {
@@ -1979,6 +2540,17 @@ DefaultScheduler::onRenderStopped(bool aborted)
 {
     NodePtr outputNode = getOutputNode();
 
+    // Remove the resume manifest only upon a clean completion: a failed render flags aborted
+    // too (see notifyRenderFailure) so the manifest survives crashes, failures and user aborts
+    // and the next launch of the same job resumes from the first incomplete frame.
+    {
+        QMutexLocker k(&_checkpointMutex);
+        if ( !aborted && !_checkpointManifestPath.empty() ) {
+            RenderCheckpointManifest::removeManifest(_checkpointManifestPath);
+        }
+        _checkpointManifestPath.clear();
+    }
+
     {
         QString longText = QString::fromUtf8( outputNode->getScriptName_mt_safe().c_str() ) + tr(" ==> Rendering finished");
         appPTR->writeToOutputPipe(longText, QString::fromUtf8(kRenderingFinishedStringShort), true);
@@ -2039,6 +2611,25 @@ DefaultScheduler::onRenderStopped(bool aborted)
     }
 } // DefaultScheduler::onRenderStopped
 
+void
+DefaultScheduler::onFrameRenderedCheckpoint(TimeValue frame)
+{
+    NodePtr outputNode = getOutputNode();
+    std::string filename;
+    KnobFilePtr fileKnob = toKnobFile( outputNode->getKnobByName(kOfxImageEffectFileParamName) );
+
+    if (fileKnob) {
+        filename = SequenceParsing::generateFileNameFromPattern(fileKnob->getValue( DimIdx(0), ViewIdx(0) ), outputNode->getApp()->getProject()->getProjectViewNames(), frame, ViewIdx(0) );
+    }
+
+    // FFA render threads may call this concurrently, serialize the appends to the manifest
+    QMutexLocker k(&_checkpointMutex);
+    if ( _checkpointManifestPath.empty() || filename.empty() ) {
+        return;
+    }
+    RenderCheckpointManifest::addFrame(_checkpointManifestPath, frame, filename);
+} // DefaultScheduler::onFrameRenderedCheckpoint
+
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
 //////////////////////// ViewerDisplayScheduler ////////////
@@ -2096,6 +2687,8 @@ public:
     , type(OpenGLViewerI::TextureTransferArgs::eTextureTransferTypeReplace)
     , viewerProcessImages()
     , viewerProcessImageKey()
+    , byPassCache(false)
+    , interactionId(0)
     {
 
     }
@@ -2110,6 +2703,17 @@ public:
     ImagePtr colorPickerInputImages[2];
     ActionRetCodeEnum retCode[2];
     ImageCacheKeyPtr viewerProcessImageKey[2];
+    bool byPassCache;
+
+    // The identifier of the user interaction the renders of this frame were tagged
+    // with, 0 if untagged. Carried to the viewer so that the latency of the edit
+    // can be measured at the texture swap, see InteractionLatencyTracker.
+    U64 interactionId;
+
+    // The tiles rendered so far by a render still in progress, coalesced in rectangles.
+    // They are uploaded as overlay textures on top of the current (coarse) texture,
+    // see ViewerPartialTilesRefreshThread
+    std::list<ImagePtr> partialTileImages;
 };
 
 class ViewerRenderBufferedFrameContainer : public BufferedFrameContainer
@@ -2120,14 +2724,19 @@ public:
     : BufferedFrameContainer()
     , recenterViewer(0)
     , viewerCenter()
+    , isProvisional(false)
     {
-        
+
     }
-    
+
     virtual ~ViewerRenderBufferedFrameContainer() {}
-    
+
     bool recenterViewer;
     Point viewerCenter;
+
+    // True for the coarse pass of a progressive render: the frame is displayed but must not
+    // bump the display age, so that the refined frame sharing the same age is not discarded
+    bool isProvisional;
 };
 
 typedef boost::shared_ptr<ViewerRenderBufferedFrame> ViewerRenderBufferedFramePtr;
@@ -2368,9 +2977,10 @@ public:
             mipMapLevel = viewer->getMipMapLevelFromZoomFactor();
         }
 
-        // If draft mode is enabled, compute the mipmap level according to the auto-proxy setting in the preferences
+        // If draft mode is enabled, compute the mipmap level from the duration of the last
+        // interactive render, capped by the auto-proxy setting in the preferences
         if ( draftModeEnabled && appPTR->getCurrentSettings()->isAutoProxyEnabled() ) {
-            unsigned int autoProxyLevel = appPTR->getCurrentSettings()->getAutoProxyMipMapLevel();
+            unsigned int autoProxyLevel = viewer->getAdaptiveProxyMipMapLevel( appPTR->getCurrentSettings()->getAutoProxyMipMapLevel() );
             if (zoomFactor > 1) {
                 //Decrease draft mode at each inverse mipmaplevel level taken
                 unsigned int invLevel = Image::getLevelFromScale(1. / zoomFactor);
@@ -2396,12 +3006,13 @@ public:
                                               OpenGLViewerI::TextureTransferArgs::TypeEnum type,
                                               const RotoStrokeItemPtr& activeStroke,
                                               const RectD* roiParam,
+                                              const unsigned int* mipMapLevelOverride,
                                               RenderViewerProcessFunctorArgs* outArgs)
     {
 
         bool fullFrameProcessing = viewer->isFullFrameProcessingEnabled();
         bool draftModeEnabled = viewer->getApp()->isDraftRenderEnabled();
-        unsigned int mipMapLevel = getViewerMipMapLevel(viewer, draftModeEnabled, fullFrameProcessing);
+        unsigned int mipMapLevel = mipMapLevelOverride ? *mipMapLevelOverride : getViewerMipMapLevel(viewer, draftModeEnabled, fullFrameProcessing);
         bool byPassCache = viewer->isRenderWithoutCacheEnabledAndTurnOff();
 
         ViewerInstancePtr viewerProcess = viewer->getViewerProcessNode(viewerProcess_i);
@@ -2440,7 +3051,7 @@ private:
     void createAndLaunchRenderInThread(const RenderViewerProcessFunctorArgsPtr& processArgs, int viewerProcess_i, TimeValue time, const RenderStatsPtr& stats, ViewerRenderBufferedFrame* bufferedFrame)
     {
 
-        createRenderViewerProcessArgs(_viewer, viewerProcess_i, time, bufferedFrame->view, true /*isPlayback*/, stats, bufferedFrame->type, RotoStrokeItemPtr(), 0 /*roiParam*/, processArgs.get());
+        createRenderViewerProcessArgs(_viewer, viewerProcess_i, time, bufferedFrame->view, true /*isPlayback*/, stats, bufferedFrame->type, RotoStrokeItemPtr(), 0 /*roiParam*/, 0 /*mipMapLevelOverride*/, processArgs.get());
 
         // Register the render so that it can be aborted in abortRenders()
         {
@@ -2464,6 +3075,10 @@ private:
         bufferedFrame->viewerProcessImages[viewerProcess_i] = processArgs->outputImage;
         bufferedFrame->colorPickerImages[viewerProcess_i] = processArgs->colorPickerImage;
         bufferedFrame->colorPickerInputImages[viewerProcess_i] = processArgs->colorPickerInputImage;
+        bufferedFrame->byPassCache = bufferedFrame->byPassCache || processArgs->byPassCache;
+        if (processArgs->renderObject) {
+            bufferedFrame->interactionId = std::max( bufferedFrame->interactionId, processArgs->renderObject->getInteractionId() );
+        }
 
     }
 
@@ -2575,6 +3190,8 @@ ViewerDisplayScheduler::processFrame(const BufferedFrameContainerPtr& frames)
         args.view = (*it)->view;
         args.type = viewerObject->type;
         args.recenterViewer = false;
+        args.byPassCache = viewerObject->byPassCache;
+        args.interactionId = viewerObject->interactionId;
 
 
         for (int i = 0; i < 2; ++i) {
@@ -2625,6 +3242,21 @@ ViewerDisplayScheduler::onRenderStopped(bool /*/aborted*/)
     if ( effect->getApp()->isGuiFrozen() ) {
         getEngine()->s_refreshAllKnobs();
     }
+
+    // Warm the cache with the frames that realtime playback skipped because they missed their
+    // deadline, so that the next pass over them can be served from the cache.
+    std::list<double> skippedFrames = takeSkippedPlaybackFrames();
+    if ( !skippedFrames.empty() ) {
+        ViewerNodePtr isViewer = effect->isEffectViewerNode();
+        NodePtr aInput = isViewer ? isViewer->getCurrentAInput() : NodePtr();
+        CacheWarmupQueuePtr warmupQueue = effect->getApp()->getCacheWarmupQueue();
+        if (aInput && warmupQueue) {
+            const unsigned int mipMapLevel = isViewer->getMipMapLevelFromZoomFactor();
+            for (std::list<double>::const_iterator it = skippedFrames.begin(); it != skippedFrames.end(); ++it) {
+                warmupQueue->submitWork(aInput, TimeValue(*it), TimeValue(*it), TimeValue(1.), mipMapLevel, -1 /*priority*/, kCacheWarmupGroupPlaybackSkippedFrames);
+            }
+        }
+    }
 }
 
 TimeValue
@@ -2647,6 +3279,11 @@ struct RenderEnginePrivate
     NodeWPtr output;
     mutable QMutex pbModeMutex;
     PlaybackModeEnum pbMode;
+
+    // When true, playback never blocks the display on an unfinished render, see
+    // setRealtimePlaybackEnabled()
+    mutable QMutex realtimePlaybackMutex;
+    bool realtimePlaybackEnabled;
     ViewerCurrentFrameRequestScheduler* currentFrameScheduler;
 
     // Only used on the main-thread
@@ -2672,6 +3309,8 @@ struct RenderEnginePrivate
         , output(output)
         , pbModeMutex()
         , pbMode(ePlaybackModeLoop)
+        , realtimePlaybackMutex()
+        , realtimePlaybackEnabled(false)
         , currentFrameScheduler(0)
         , refreshQueue()
     {
@@ -2860,6 +3499,22 @@ RenderEngine::isPlaybackAutoRestartEnabled() const
     return _imp->canAutoRestartPlayback;
 }
 
+void
+RenderEngine::setRealtimePlaybackEnabled(bool enabled)
+{
+    QMutexLocker k(&_imp->realtimePlaybackMutex);
+
+    _imp->realtimePlaybackEnabled = enabled;
+}
+
+bool
+RenderEngine::isRealtimePlaybackEnabled() const
+{
+    QMutexLocker k(&_imp->realtimePlaybackMutex);
+
+    return _imp->realtimePlaybackEnabled;
+}
+
 void
 RenderEngine::quitEngine(bool allowRestarts)
 {
@@ -3088,6 +3743,7 @@ RenderEngine::reportStats(TimeValue time,
         return;
     }
     std::string filename;
+    std::string traceFilename;
     NodePtr output = getOutput();
     KnobIPtr fileKnob = output->getKnobByName(kOfxImageEffectFileParamName);
 
@@ -3096,6 +3752,7 @@ RenderEngine::reportStats(TimeValue time,
         if  (strKnob) {
             QString qfileName = QString::fromUtf8( SequenceParsing::generateFileNameFromPattern(strKnob->getValue( DimIdx(0), ViewIdx(0) ), output->getApp()->getProject()->getProjectViewNames(), time, ViewIdx(0)).c_str() );
             QtCompat::removeFileExtension(qfileName);
+            traceFilename = ( qfileName + QString::fromUtf8("-trace.json") ).toStdString();
             qfileName.append( QString::fromUtf8("-stats.txt") );
             filename = qfileName.toStdString();
         }
@@ -3127,7 +3784,16 @@ RenderEngine::reportStats(TimeValue time,
     for (std::map<NodePtr, NodeRenderStats >::const_iterator it = statsMap.begin(); it != statsMap.end(); ++it) {
         ofile << "------------------------------- " << it->first->getScriptName_mt_safe() << "------------------------------- " << std::endl;
         ofile << "Time spent rendering: " << Timer::printAsTime(it->second.getTotalTimeSpentRendering(), false).toStdString() << std::endl;
+        int nbDepthConversions = it->second.getNbInputBitDepthConversions();
+        if (nbDepthConversions > 0) {
+            ofile << "Input images converted to another bit-depth: " << nbDepthConversions << std::endl;
+        }
     }
+
+    // Also write the captured render spans (if any) next to the stats file, in the
+    // Chrome trace-event format so the per-thread timeline of the frame can be
+    // visualized in chrome://tracing or Perfetto.
+    stats->exportSpansToChromeTraceFile(traceFilename);
 } // reportStats
 
 OutputSchedulerThread*
@@ -3162,6 +3828,10 @@ public:
     RotoStrokeItemPtr strokeItem;
     U64 age;
 
+    // When true, the render is done at the resolution that would be used without draft mode so the
+    // image settles to full quality after the playhead rested while scrubbing
+    bool settleToFullResolution;
+
     CurrentFrameFunctorArgs()
         : GenericThreadStartArgs()
         , viewsToRender()
@@ -3171,6 +3841,7 @@ public:
         , scheduler(0)
         , strokeItem()
         , age(0)
+        , settleToFullResolution(false)
     {
     }
 
@@ -3188,6 +3859,7 @@ public:
         , scheduler(scheduler)
         , strokeItem(strokeItem)
         , age(0)
+        , settleToFullResolution(false)
     {
         viewsToRender.push_back(view);
     }
@@ -3231,7 +3903,7 @@ struct ViewerCurrentFrameRequestSchedulerPrivate
     QWaitCondition currentFrameRenderTasksCond;
     std::list<boost::shared_ptr<RenderCurrentFrameFunctorRunnable> > currentFrameRenderTasks;
 
-    mutable QMutex renderAgeMutex; // protects renderAge displayAge currentRenders
+    mutable QMutex renderAgeMutex; // protects renderAge displayAge currentRenders lastRenderedFrameTime lastRenderedMipMapLevel
 
     // This is the age to attribute to the next incomming render
     U64 renderAge;
@@ -3242,6 +3914,63 @@ struct ViewerCurrentFrameRequestSchedulerPrivate
     // A set of active renders and their age.
     TreeRenderSetOrderedByAge currentRenders;
 
+    // The time and mipmap level of the last current-frame render that completed successfully:
+    // the image at this level is fully in the cache mipmap pyramid, so when the user zooms to
+    // another mipmap level it can be displayed instantly whilst the exact level renders.
+    // -1 means no render completed yet. Protected by renderAgeMutex
+    TimeValue lastRenderedFrameTime;
+    int lastRenderedMipMapLevel;
+
+    mutable QMutex prefetchDataMutex; // protects lastRequestedFrame lastSeekDirection prefetchEpoch prefetchRenders
+
+    // The frame of the last current-frame render request, used to derive the seek direction. INT_MIN means none yet.
+    int lastRequestedFrame;
+
+    // 1 when the playhead last moved forward, -1 backward
+    int lastSeekDirection;
+
+    // Incremented whenever pending speculative renders become irrelevant, so that
+    // in-flight prefetch tasks stop dequeuing frames.
+    U64 prefetchEpoch;
+
+    // The speculative renders launched ahead of the playhead, so they can be aborted
+    // when the user scrubs elsewhere.
+    std::list<TreeRenderPtr> prefetchRenders;
+
+    // Set to false when the scheduler is asked to quit so that the idle speculation timer
+    // cannot launch renders anymore. Protected by prefetchDataMutex
+    bool idleSpeculationEnabled;
+
+    // Armed (on the main-thread) after each current-frame render request: when it times out and
+    // the application is still idle, the timeline frame range is speculatively rendered into the
+    // cache, see ViewerCurrentFrameRequestScheduler::onIdleSpeculationTimerTimeout()
+    QTimer idleSpeculationTimer;
+
+    // Armed (on the main-thread) after each render request made while scrubbing the timeline in
+    // draft mode: when it times out and the playhead did not move since, a full resolution render
+    // is scheduled so the image settles, see ViewerCurrentFrameRequestScheduler::onFullResSettleTimerTimeout()
+    QTimer fullResSettleTimer;
+
+    // True when the next render request must be done at full resolution, bypassing the draft mode
+    // auto-proxy level. Only used on the main-thread.
+    bool settleToFullResolution;
+
+    // Armed (on the main-thread) when a scrub render request comes in before the minimum
+    // inter-render interval elapsed: when it times out, the deferred render is launched for
+    // the playhead position at that moment, see ViewerCurrentFrameRequestScheduler::onSeekCoalesceTimerTimeout()
+    QTimer seekCoalesceTimer;
+
+    // Measures the time elapsed since the last scrub render was launched, to enforce the
+    // minimum inter-render interval. NULL until the first scrub render. Only used on the main-thread.
+    boost::scoped_ptr<TimeLapse> lastScrubRenderStart;
+
+    // True when a seek was coalesced and a render request is due when seekCoalesceTimer fires.
+    // Only used on the main-thread.
+    bool coalescedRenderPending;
+
+    // Whether any of the coalesced render requests asked for render statistics. Only used on the main-thread.
+    bool coalescedRenderStats;
+
     ViewerCurrentFrameRequestSchedulerPrivate(ViewerCurrentFrameRequestScheduler* publicInterface, const NodePtr& viewer)
         : _publicInterface(publicInterface)
         , viewer(viewer)
@@ -3252,7 +3981,39 @@ struct ViewerCurrentFrameRequestSchedulerPrivate
         , renderAge(1)
         , displayAge(0)
         , currentRenders()
+        , lastRenderedFrameTime(0)
+        , lastRenderedMipMapLevel(-1)
+        , prefetchDataMutex()
+        , lastRequestedFrame(INT_MIN)
+        , lastSeekDirection(1)
+        , prefetchEpoch(0)
+        , prefetchRenders()
+        , idleSpeculationEnabled(true)
+        , idleSpeculationTimer()
+        , fullResSettleTimer()
+        , settleToFullResolution(false)
+        , seekCoalesceTimer()
+        , lastScrubRenderStart()
+        , coalescedRenderPending(false)
+        , coalescedRenderStats(false)
+    {
+    }
+
+    /**
+     * @brief Cancels all speculative renders ahead of the playhead.
+     **/
+    void abortPrefetchRenders()
     {
+        std::list<TreeRenderPtr> renders;
+        {
+            QMutexLocker k(&prefetchDataMutex);
+            ++prefetchEpoch;
+            renders = prefetchRenders;
+            prefetchRenders.clear();
+        }
+        for (std::list<TreeRenderPtr>::const_iterator it = renders.begin(); it != renders.end(); ++it) {
+            (*it)->setRenderAborted();
+        }
     }
 
     void appendRunnableTask(const boost::shared_ptr<RenderCurrentFrameFunctorRunnable>& task)
@@ -3291,6 +4052,217 @@ struct ViewerCurrentFrameRequestSchedulerPrivate
     void processProducedFrame(U64 age, const BufferedFrameContainerPtr& frames);
 };
 
+// The mipmap level at which the coarse pass of a progressive current-frame render is done: the
+// coarse image is displayed as soon as it is ready and then refined in place by the
+// full-resolution render
+#define NATRON_VIEWER_PROGRESSIVE_COARSE_MIPMAP_LEVEL 2
+
+// Interval (in milliseconds) at which the tiles rendered so far by a current-frame render still
+// in progress are uploaded to the viewer
+#define NATRON_VIEWER_PARTIAL_TILES_REFRESH_INTERVAL_MS 500
+
+// When the tiles rendered so far coalesce in more rectangles than this, the refresh is skipped
+// until they merge into larger areas: uploading many small textures would cost more than it shows
+#define NATRON_VIEWER_PARTIAL_TILES_REFRESH_MAX_RECTS 8
+
+/**
+ * @brief While the full-resolution render of the current frame is in progress, this thread
+ * periodically fetches the per-tile status of the image being rendered and uploads the tiles
+ * that are done to the viewer, as overlay textures on top of the coarse pass texture: the user
+ * sees finished areas at full quality immediately whilst unfinished ones keep displaying the
+ * coarse image. The uploads are provisional: they do not bump the display age and are cleared
+ * by the final frame upload.
+ * This thread is deliberately not a thread-pool task: the render saturates the pool and a
+ * pooled refresh task would only be scheduled once the render - that it is supposed to
+ * observe - is done.
+ **/
+class ViewerPartialTilesRefreshThread
+: public QThread
+{
+    ViewerCurrentFrameRequestSchedulerPrivate* _scheduler;
+    U64 _age;
+    TimeValue _time;
+    ViewIdx _view;
+    RenderViewerProcessFunctorArgsPtr _processArgs;
+
+    QMutex _mustQuitMutex;
+    QWaitCondition _mustQuitCond;
+    bool _mustQuit;
+
+public:
+
+    ViewerPartialTilesRefreshThread(ViewerCurrentFrameRequestSchedulerPrivate* scheduler,
+                                    U64 age,
+                                    TimeValue time,
+                                    ViewIdx view,
+                                    const RenderViewerProcessFunctorArgsPtr& processArgs)
+    : QThread()
+    , _scheduler(scheduler)
+    , _age(age)
+    , _time(time)
+    , _view(view)
+    , _processArgs(processArgs)
+    , _mustQuitMutex()
+    , _mustQuitCond()
+    , _mustQuit(false)
+    {
+        setObjectName( QString::fromUtf8("ViewerPartialTilesRefresh") );
+    }
+
+    virtual ~ViewerPartialTilesRefreshThread()
+    {
+    }
+
+    void quitThread()
+    {
+        {
+            QMutexLocker k(&_mustQuitMutex);
+            _mustQuit = true;
+            _mustQuitCond.wakeOne();
+        }
+        wait();
+    }
+
+private:
+
+    /**
+     * @brief Coalesce the tiles marked rendered in the given state in as few rectangles as
+     * possible: maximal runs of consecutive rendered tiles on each tile row, merged with the
+     * rectangle of the row below when both span the same horizontal range.
+     **/
+    static void getRenderedTilesRectangles(const TileStateHeader& tilesState, std::vector<RectI>* rectangles)
+    {
+        const RectI& boundsRounded = tilesState.state->boundsRoundedToTileSize;
+        const int tilesPerLine = boundsRounded.width() / tilesState.tileSizeX;
+        const int nRows = boundsRounded.height() / tilesState.tileSizeY;
+
+        for (int ty = 0; ty < nRows; ++ty) {
+            int tx = 0;
+            while (tx < tilesPerLine) {
+                const TileState& tile = tilesState.state->tiles[ty * tilesPerLine + tx];
+                if (tile.status != eTileStatusRenderedHighestQuality && tile.status != eTileStatusRenderedLowQuality) {
+                    ++tx;
+                    continue;
+                }
+
+                // Extend the run as far as tiles are rendered
+                RectI runRect = tile.bounds;
+                ++tx;
+                while (tx < tilesPerLine) {
+                    const TileState& nextTile = tilesState.state->tiles[ty * tilesPerLine + tx];
+                    if (nextTile.status != eTileStatusRenderedHighestQuality && nextTile.status != eTileStatusRenderedLowQuality) {
+                        break;
+                    }
+                    runRect.merge(nextTile.bounds);
+                    ++tx;
+                }
+
+                // Merge with a rectangle of the row(s) below spanning the same horizontal range
+                bool merged = false;
+                for (std::size_t i = 0; i < rectangles->size(); ++i) {
+                    RectI& prevRect = (*rectangles)[i];
+                    if (prevRect.x1 == runRect.x1 && prevRect.x2 == runRect.x2 && prevRect.y2 == runRect.y1) {
+                        prevRect.y2 = runRect.y2;
+                        merged = true;
+                        break;
+                    }
+                }
+                if (!merged) {
+                    rectangles->push_back(runRect);
+                }
+            }
+        }
+    } // getRenderedTilesRectangles
+
+    virtual void run() OVERRIDE FINAL
+    {
+        TreeRenderPtr renderObject = _processArgs->renderObject;
+        if (!renderObject) {
+            return;
+        }
+
+        std::vector<RectI> lastRefreshedRectangles;
+        for (;;) {
+
+            {
+                QMutexLocker k(&_mustQuitMutex);
+                if (!_mustQuit) {
+                    _mustQuitCond.wait(&_mustQuitMutex, NATRON_VIEWER_PARTIAL_TILES_REFRESH_INTERVAL_MS);
+                }
+                if (_mustQuit) {
+                    return;
+                }
+            }
+
+            if ( renderObject->isRenderAborted() ) {
+                continue;
+            }
+
+            // The root request and its image only exist once the request pass is done
+            FrameViewRequestPtr outputRequest = renderObject->getOutputRequestBeingRendered();
+            if (!outputRequest) {
+                continue;
+            }
+            ImagePtr image = outputRequest->getRequestedScaleImagePlane();
+            if (!image) {
+                continue;
+            }
+            ImageCacheEntryPtr cacheEntry = image->getCacheEntry();
+            if (!cacheEntry) {
+                continue;
+            }
+
+            TileStateHeader tilesState;
+            cacheEntry->getStatus(&tilesState, 0 /*hasUnRenderedTile*/, 0 /*hasPendingResults*/);
+            if ( !tilesState.state || tilesState.state->tiles.empty() ) {
+                continue;
+            }
+
+            std::vector<RectI> renderedRectangles;
+            getRenderedTilesRectangles(tilesState, &renderedRectangles);
+
+            // Nothing done yet, nothing new since the last refresh, or too fragmented to be
+            // worth uploading: the tiles will coalesce as the render progresses
+            if ( renderedRectangles.empty() ||
+                 renderedRectangles == lastRefreshedRectangles ||
+                 (int)renderedRectangles.size() > NATRON_VIEWER_PARTIAL_TILES_REFRESH_MAX_RECTS ) {
+                continue;
+            }
+            lastRefreshedRectangles = renderedRectangles;
+
+            ViewerRenderBufferedFramePtr frame(new ViewerRenderBufferedFrame);
+            frame->view = _view;
+            frame->type = OpenGLViewerI::TextureTransferArgs::eTextureTransferTypeOverlay;
+            // Leave both display textures untouched: only the overlay images are uploaded
+            frame->retCode[0] = eActionStatusAborted;
+            frame->retCode[1] = eActionStatusAborted;
+
+            for (std::size_t i = 0; i < renderedRectangles.size(); ++i) {
+                RectI rect = renderedRectangles[i];
+                if ( !rect.intersect(image->getBounds(), &rect) ) {
+                    continue;
+                }
+                // Copy the pixels out: the render threads keep writing the other tiles of this buffer
+                ImagePtr rectImage = ViewerRenderFrameRunnable::convertImageForViewerDisplay(rect, true /*forceCopy*/, true /*force4Components*/, image);
+                if (rectImage) {
+                    frame->partialTileImages.push_back(rectImage);
+                }
+            }
+            if ( frame->partialTileImages.empty() ) {
+                continue;
+            }
+
+            ViewerRenderBufferedFrameContainerPtr container(new ViewerRenderBufferedFrameContainer);
+            container->time = _time;
+            container->recenterViewer = false;
+            container->isProvisional = true;
+            container->frames.push_back(frame);
+
+            _scheduler->_publicInterface->s_doProcessFrameOnMainThread(_age, container);
+        } // for (;;)
+    } // run
+};
+
 class RenderCurrentFrameFunctorRunnable
     : public QRunnable
 {
@@ -3314,10 +4286,12 @@ public:
                                        const RenderStatsPtr& stats,
                                        const RotoStrokeItemPtr& activeStroke,
                                        const RectD* roiParam,
+                                       const unsigned int* mipMapLevelOverride,
+                                       bool enablePartialTilesRefresh,
                                        ViewerRenderBufferedFrame* bufferedFrame)
     {
 
-        ViewerRenderFrameRunnable::createRenderViewerProcessArgs(viewer, viewerProcess_i, time, bufferedFrame->view, false /*isPlayback*/, stats, bufferedFrame->type, activeStroke, roiParam, processArgs.get());
+        ViewerRenderFrameRunnable::createRenderViewerProcessArgs(viewer, viewerProcess_i, time, bufferedFrame->view, false /*isPlayback*/, stats, bufferedFrame->type, activeStroke, roiParam, mipMapLevelOverride, processArgs.get());
 
         // Register the current renders and their age on the scheduler so that they can be aborted
         {
@@ -3343,7 +4317,27 @@ public:
         if (viewer->isViewerPaused(viewerProcess_i)) {
             processArgs->retCode = eActionStatusAborted;
         } else {
+
+            // While the render is in progress, periodically upload the tiles that are done
+            // on top of the coarse pass texture
+            boost::scoped_ptr<ViewerPartialTilesRefreshThread> partialRefreshThread;
+            if (enablePartialTilesRefresh && viewerProcess_i == 0 && processArgs->renderObject) {
+                partialRefreshThread.reset( new ViewerPartialTilesRefreshThread(_args->scheduler, _args->age, time, bufferedFrame->view, processArgs) );
+                partialRefreshThread->start();
+            }
+
+            TimeLapse renderTimer;
             ViewerRenderFrameRunnable::launchRenderFunctor(processArgs, roiParam);
+
+            if (partialRefreshThread) {
+                partialRefreshThread->quitThread();
+            }
+
+            // Report the render duration so the auto-proxy level can adapt while scrubbing.
+            // Partial updates only render a small region and would skew the measure.
+            if ( !roiParam && !isFailureRetCode(processArgs->retCode) ) {
+                viewer->reportInteractiveRenderDuration(renderTimer.getTimeSinceCreation(), processArgs->viewerMipMapLevel);
+            }
         }
 
         bufferedFrame->retCode[viewerProcess_i] = processArgs->retCode;
@@ -3351,11 +4345,15 @@ public:
         bufferedFrame->viewerProcessImages[viewerProcess_i] = processArgs->outputImage;
         bufferedFrame->colorPickerImages[viewerProcess_i] = processArgs->colorPickerImage;
         bufferedFrame->colorPickerInputImages[viewerProcess_i] = processArgs->colorPickerInputImage;
-        
+        bufferedFrame->byPassCache = bufferedFrame->byPassCache || processArgs->byPassCache;
+        if (processArgs->renderObject) {
+            bufferedFrame->interactionId = std::max( bufferedFrame->interactionId, processArgs->renderObject->getInteractionId() );
+        }
+
     }
 
 
-    void computeViewsForRoI(const ViewerNodePtr &viewer, const RectD* partialUpdateArea, const ViewerRenderBufferedFrameContainerPtr& framesContainer)
+    void computeViewsForRoI(const ViewerNodePtr &viewer, const RectD* partialUpdateArea, const ViewerRenderBufferedFrameContainerPtr& framesContainer, const unsigned int* mipMapLevelOverride)
     {
 
         // Render each view sequentially. For now the viewer always asks to render 1 view since the interface can only allow 1 view at once per view
@@ -3394,6 +4392,10 @@ public:
             ViewerCompositingOperatorEnum viewerBlend = viewer->getCurrentOperator();
             bool viewerBEqualsViewerA = viewer->getCurrentAInput() == viewer->getCurrentBInput();
 
+            // Upload the tiles that are done while the render is in progress, unless this is
+            // the coarse provisional pass (it is fast and displayed whole) or a partial update
+            const bool enablePartialTilesRefresh = !partialUpdateArea && !_args->strokeItem && !framesContainer->isProvisional;
+
             // Launch the 2nd viewer process in a separate thread
             QFuture<void> processBFuture ;
             if (!viewerBEqualsViewerA && viewerBlend != eViewerCompositingOperatorNone) {
@@ -3406,17 +4408,50 @@ public:
                                                                stats,
                                                                _args->strokeItem,
                                                                partialUpdateArea,
+                                                               mipMapLevelOverride,
+                                                               false /*enablePartialTilesRefresh*/,
                                                                bufferObject.get()));
             }
 
             // Launch the 1st viewer process in this thread
-            createAndLaunchRenderInThread(viewer, processArgs[0], 0, _args->time, stats, _args->strokeItem, partialUpdateArea, bufferObject.get());
+            createAndLaunchRenderInThread(viewer, processArgs[0], 0, _args->time, stats, _args->strokeItem, partialUpdateArea, mipMapLevelOverride, enablePartialTilesRefresh, bufferObject.get());
 
             // Wait for the 2nd viewer process
             if (viewerBlend == eViewerCompositingOperatorNone) {
                 bufferObject->retCode[1] = eActionStatusFailed;
             } else {
                 if (!viewerBEqualsViewerA) {
+
+                    // If the A input landed first, show it without waiting for B: the wipe is
+                    // composited against the previously displayed B texture and refreshed again
+                    // once the B render completes below.
+                    if ( bufferObject->type == OpenGLViewerI::TextureTransferArgs::eTextureTransferTypeReplace &&
+                         !processBFuture.isFinished() &&
+                         !isFailureRetCode(processArgs[0]->retCode) ) {
+                        ViewerRenderBufferedFrameContainerPtr aOnlyContainer(new ViewerRenderBufferedFrameContainer);
+                        aOnlyContainer->time = framesContainer->time;
+                        aOnlyContainer->recenterViewer = framesContainer->recenterViewer;
+                        aOnlyContainer->viewerCenter = framesContainer->viewerCenter;
+                        aOnlyContainer->isProvisional = true;
+
+                        ViewerRenderBufferedFramePtr aOnlyFrame(new ViewerRenderBufferedFrame);
+                        aOnlyFrame->view = bufferObject->view;
+                        aOnlyFrame->stats = bufferObject->stats;
+                        aOnlyFrame->type = bufferObject->type;
+                        aOnlyFrame->byPassCache = bufferObject->byPassCache;
+                        aOnlyFrame->interactionId = bufferObject->interactionId;
+                        aOnlyFrame->retCode[0] = processArgs[0]->retCode;
+                        aOnlyFrame->viewerProcessImageKey[0] = processArgs[0]->viewerProcessImageCacheKey;
+                        aOnlyFrame->viewerProcessImages[0] = processArgs[0]->outputImage;
+                        aOnlyFrame->colorPickerImages[0] = processArgs[0]->colorPickerImage;
+                        aOnlyFrame->colorPickerInputImages[0] = processArgs[0]->colorPickerInputImage;
+                        // Leave the B texture untouched in the meantime
+                        aOnlyFrame->retCode[1] = eActionStatusAborted;
+                        aOnlyContainer->frames.push_back(aOnlyFrame);
+
+                        _args->scheduler->_publicInterface->s_doProcessFrameOnMainThread(_args->age, aOnlyContainer);
+                    }
+
                     processBFuture.waitForFinished();
                 } else  {
                     bufferObject->retCode[1] = processArgs[0]->retCode;
@@ -3436,6 +4471,20 @@ public:
 
         ViewerNodePtr viewer = _args->viewer->isEffectViewerNode();
 
+        // If a newer request was posted while this one sat in the thread-pool queue, it is already
+        // doomed: skip it before the request pass even begins instead of aborting it mid-way, as
+        // the abort/cleanup of a deep tree render is not free. Painting ticks and partial updates
+        // accumulate on the displayed texture and must all be rendered, so they are never skipped.
+        if ( !_args->strokeItem && !viewer->isDoingPartialUpdates() ) {
+            QMutexLocker k(&_args->scheduler->renderAgeMutex);
+            if ( (_args->scheduler->renderAge > _args->age + 1) || (_args->age <= _args->scheduler->displayAge) ) {
+                k.unlock();
+                _args->scheduler->removeRunnableTask(this);
+
+                return;
+            }
+        }
+
         // The object that contains frames that we want to upload to the viewer UI all at once
         ViewerRenderBufferedFrameContainerPtr framesContainer(new ViewerRenderBufferedFrameContainer);
         framesContainer->time = _args->time;
@@ -3447,10 +4496,67 @@ public:
             // Then we launch multiple renders over the partial areas
             std::list<RectD> partialUpdates = viewer->getPartialUpdateRects();
             for (std::list<RectD>::const_iterator it = partialUpdates.begin(); it != partialUpdates.end(); ++it) {
-                computeViewsForRoI(viewer, &(*it), framesContainer);
+                computeViewsForRoI(viewer, &(*it), framesContainer, 0 /*mipMapLevelOverride*/);
             }
         } else {
-            computeViewsForRoI(viewer, 0, framesContainer);
+
+            // Coarse-to-fine refinement: if the render is to be done at full resolution, first render at
+            // a coarse mipmap level and display the result immediately, then refine in place with the
+            // full-resolution render below. Playback and painting keep their single-pass behaviour:
+            // they already render at the draft/auto-proxy resolution when enabled.
+            const unsigned int naturalMipMapLevel = ViewerRenderFrameRunnable::getViewerMipMapLevel( viewer, viewer->getApp()->isDraftRenderEnabled(), viewer->isFullFrameProcessingEnabled() );
+
+            // If the playhead rested while scrubbing, render at the resolution that would be used
+            // without draft mode so the image settles to full quality
+            unsigned int settleMipMapLevel = 0;
+            const unsigned int* mipMapLevelOverride = 0;
+            if (_args->settleToFullResolution) {
+                settleMipMapLevel = ViewerRenderFrameRunnable::getViewerMipMapLevel( viewer, false /*draftModeEnabled*/, viewer->isFullFrameProcessingEnabled() );
+                mipMapLevelOverride = &settleMipMapLevel;
+            }
+
+            const unsigned int targetMipMapLevel = mipMapLevelOverride ? *mipMapLevelOverride : naturalMipMapLevel;
+
+            // The mipmap level of the provisional pass: by default the fixed coarse level, but if
+            // this frame was just displayed at a coarser level (the user zoomed in), that level is
+            // fully in the cache mipmap pyramid: reading it back is instant, giving an immediate
+            // zoom response whilst the exact level renders below. Zooming out needs no provisional
+            // pass beyond the coarse one: the exact level is produced by downscaling the cached
+            // finer level, see lookupTileStateInPyramid in ImageCacheEntry.cpp
+            unsigned int provisionalMipMapLevel = NATRON_VIEWER_PROGRESSIVE_COARSE_MIPMAP_LEVEL;
+            bool hasProvisionalLevel = targetMipMapLevel < NATRON_VIEWER_PROGRESSIVE_COARSE_MIPMAP_LEVEL;
+            {
+                QMutexLocker k(&_args->scheduler->renderAgeMutex);
+                if ( (_args->scheduler->lastRenderedMipMapLevel != -1) &&
+                     (_args->scheduler->lastRenderedFrameTime == _args->time) &&
+                     ((unsigned int)_args->scheduler->lastRenderedMipMapLevel > targetMipMapLevel) ) {
+                    provisionalMipMapLevel = _args->scheduler->lastRenderedMipMapLevel;
+                    hasProvisionalLevel = true;
+                }
+            }
+
+            if ( !_args->strokeItem && hasProvisionalLevel ) {
+                ViewerRenderBufferedFrameContainerPtr coarseContainer(new ViewerRenderBufferedFrameContainer);
+                coarseContainer->time = framesContainer->time;
+                coarseContainer->recenterViewer = framesContainer->recenterViewer;
+                coarseContainer->viewerCenter = framesContainer->viewerCenter;
+                coarseContainer->isProvisional = true;
+                computeViewsForRoI(viewer, 0, coarseContainer, &provisionalMipMapLevel);
+                _args->scheduler->_publicInterface->s_doProcessFrameOnMainThread(_args->age, coarseContainer);
+            }
+
+            computeViewsForRoI(viewer, 0, framesContainer, mipMapLevelOverride);
+
+            // Remember the level at which this frame was rendered: all its tiles are now in the
+            // cache mipmap pyramid and can seed the provisional pass of the next zoom render
+            if ( !_args->strokeItem && !framesContainer->frames.empty() ) {
+                ViewerRenderBufferedFrame* frontFrame = dynamic_cast<ViewerRenderBufferedFrame*>( framesContainer->frames.front().get() );
+                if ( frontFrame && !isFailureRetCode(frontFrame->retCode[0]) ) {
+                    QMutexLocker k(&_args->scheduler->renderAgeMutex);
+                    _args->scheduler->lastRenderedFrameTime = _args->time;
+                    _args->scheduler->lastRenderedMipMapLevel = (int)targetMipMapLevel;
+                }
+            }
         }
 
         // Call updateViewer() on the main thread
@@ -3473,10 +4579,105 @@ public:
 };
 
 
+// How many frames ahead of the playhead are speculatively rendered after a seek
+#define NATRON_VIEWER_PREFETCH_NUM_FRAMES 3
+
+// How long (in milliseconds) the application must stay idle before the timeline frame range
+// is speculatively rendered into the cache
+#define NATRON_VIEWER_IDLE_SPECULATION_DELAY_MS 4000
+
+// How long (in milliseconds) the playhead must rest while scrubbing the timeline in draft mode
+// before a full resolution render is scheduled to settle the image
+#define NATRON_VIEWER_FULLRES_SETTLE_DELAY_MS 500
+
+// Bounds (in milliseconds) of the minimum interval between two scrub renders: the actual
+// interval is the measured scrub render latency clamped to this range, so that fast comps are
+// not throttled and heavy comps do not flood the scheduler with renders doomed to be aborted
+#define NATRON_VIEWER_SEEK_COALESCE_MIN_INTERVAL_MS 20
+#define NATRON_VIEWER_SEEK_COALESCE_MAX_INTERVAL_MS 250
+
+/**
+ * @brief Speculatively renders the frames ahead of the playhead in the direction the user
+ * is seeking, at the lowest thread-pool priority. The rendered images are simply dropped:
+ * the point is to warm the cache so that the next current-frame request is a cache hit.
+ **/
+class ViewerPlayheadPrefetchRunnable
+    : public QRunnable
+{
+    NodePtr _viewer;
+    ViewIdx _view;
+    std::vector<TimeValue> _frames;
+    ViewerCurrentFrameRequestSchedulerPrivate* _scheduler;
+    U64 _epoch;
+
+public:
+
+    ViewerPlayheadPrefetchRunnable(const NodePtr& viewer,
+                                   ViewIdx view,
+                                   const std::vector<TimeValue>& frames,
+                                   ViewerCurrentFrameRequestSchedulerPrivate* scheduler,
+                                   U64 epoch)
+        : _viewer(viewer)
+        , _view(view)
+        , _frames(frames)
+        , _scheduler(scheduler)
+        , _epoch(epoch)
+    {
+    }
+
+    virtual ~ViewerPlayheadPrefetchRunnable()
+    {
+    }
+
+    virtual void run() OVERRIDE FINAL
+    {
+        ViewerNodePtr viewerNode = _viewer->isEffectViewerNode();
+        if (!viewerNode) {
+            return;
+        }
+
+        for (std::size_t i = 0; i < _frames.size(); ++i) {
+
+            RenderViewerProcessFunctorArgsPtr processArgs(new RenderViewerProcessFunctorArgs);
+
+            // Pass isPlayback so the render does not try to sample color picker nodes
+            ViewerRenderFrameRunnable::createRenderViewerProcessArgs(viewerNode, 0 /*viewerProcess_i*/, _frames[i], _view, true /*isPlayback*/, RenderStatsPtr(), OpenGLViewerI::TextureTransferArgs::eTextureTransferTypeReplace, RotoStrokeItemPtr(), 0 /*roiParam*/, 0 /*mipMapLevelOverride*/, processArgs.get());
+
+            // Register the render so it can be aborted if the user seeks elsewhere. If the
+            // playhead already moved on, stop dequeuing frames.
+            {
+                QMutexLocker k(&_scheduler->prefetchDataMutex);
+                if (_scheduler->prefetchEpoch != _epoch) {
+                    return;
+                }
+                assert(processArgs->renderObject);
+                _scheduler->prefetchRenders.push_back(processArgs->renderObject);
+            }
+
+            ViewerRenderFrameRunnable::launchRenderFunctor(processArgs, 0);
+
+            // The resulting image is dropped on purpose: it now sits in the cache.
+            {
+                QMutexLocker k(&_scheduler->prefetchDataMutex);
+                _scheduler->prefetchRenders.remove(processArgs->renderObject);
+            }
+        }
+    } // run
+};
+
 ViewerCurrentFrameRequestScheduler::ViewerCurrentFrameRequestScheduler(const NodePtr& viewer)
 : _imp( new ViewerCurrentFrameRequestSchedulerPrivate(this, viewer) )
 {
     QObject::connect(this, SIGNAL(doProcessFrameOnMainThread(U64,BufferedFrameContainerPtr)), this, SLOT(onDoProcessFrameOnMainThreadReceived(U64,BufferedFrameContainerPtr)));
+
+    _imp->idleSpeculationTimer.setSingleShot(true);
+    QObject::connect(&_imp->idleSpeculationTimer, SIGNAL(timeout()), this, SLOT(onIdleSpeculationTimerTimeout()));
+
+    _imp->fullResSettleTimer.setSingleShot(true);
+    QObject::connect(&_imp->fullResSettleTimer, SIGNAL(timeout()), this, SLOT(onFullResSettleTimerTimeout()));
+
+    _imp->seekCoalesceTimer.setSingleShot(true);
+    QObject::connect(&_imp->seekCoalesceTimer, SIGNAL(timeout()), this, SLOT(onSeekCoalesceTimerTimeout()));
 }
 
 ViewerCurrentFrameRequestScheduler::~ViewerCurrentFrameRequestScheduler()
@@ -3529,6 +4730,8 @@ ViewerCurrentFrameRequestSchedulerPrivate::processProducedFrame(U64 age, const B
         args.type = viewerObject->type;
         args.recenterViewer = isViewerFrameContainer->recenterViewer;
         args.viewerCenter = isViewerFrameContainer->viewerCenter;
+        args.byPassCache = viewerObject->byPassCache;
+        args.interactionId = viewerObject->interactionId;
 
         for (int i = 0; i < 2; ++i) {
             ViewerNode::UpdateViewerArgs::TextureUpload upload;
@@ -3543,6 +4746,14 @@ ViewerCurrentFrameRequestSchedulerPrivate::processProducedFrame(U64 age, const B
 
             args.viewerUploads[i].push_back(upload);
         }
+
+        // Tiles rendered so far by a render still in progress: uploaded as overlay textures
+        // on top of the current (coarse) texture of the A input
+        for (std::list<ImagePtr>::const_iterator it3 = viewerObject->partialTileImages.begin(); it3 != viewerObject->partialTileImages.end(); ++it3) {
+            ViewerNode::UpdateViewerArgs::TextureUpload upload;
+            upload.image = *it3;
+            args.viewerUploads[0].push_back(upload);
+        }
         if (!args.viewerUploads[0].empty() || !args.viewerUploads[1].empty()) {
             updateAge = true;
             viewerNode->updateViewer(args);
@@ -3555,7 +4766,9 @@ ViewerCurrentFrameRequestSchedulerPrivate::processProducedFrame(U64 age, const B
         }
 
     }
-    if (updateAge) {
+    // A provisional (coarse) frame must not update the display age: the refined frame carrying
+    // the same age would otherwise be discarded by the check above
+    if (updateAge && !isViewerFrameContainer->isProvisional) {
         QMutexLocker k(&renderAgeMutex);
         // Update the display age
         displayAge = age;
@@ -3572,6 +4785,9 @@ ViewerCurrentFrameRequestScheduler::onAbortRequested(bool keepOldestRender)
 #endif
     _imp->backupThread.abortThreadedTask();
 
+    // Speculative renders ahead of the playhead are always the first to go
+    _imp->abortPrefetchRenders();
+
     ViewerNodePtr viewerNode = _imp->viewer->isEffectViewerNode();
 
     // Do not abort the oldest render while scrubbing timeline or sliders so that the user gets some feedback
@@ -3612,6 +4828,11 @@ ViewerCurrentFrameRequestScheduler::onAbortRequested(bool keepOldestRender)
 void
 ViewerCurrentFrameRequestScheduler::onQuitRequested(bool allowRestarts)
 {
+    {
+        QMutexLocker k(&_imp->prefetchDataMutex);
+        _imp->idleSpeculationEnabled = false;
+    }
+    _imp->abortPrefetchRenders();
     _imp->backupThread.quitThread(allowRestarts);
 }
 
@@ -3669,8 +4890,50 @@ ViewerCurrentFrameRequestScheduler::renderCurrentFrame(bool enableRenderStats)
     }
 
     // We are about to trigger a new render, cancel all other renders except the oldest so user gets some feedback.
+    // This is done before the coalescing below on purpose: stale renders must be aborted right away,
+    // even when the render for this request ends up being deferred.
     onAbortRequested(true /*keepOldestRender*/);
 
+    // Are we tracking ?
+    bool isTracking = viewerNode->isDoingPartialUpdates();
+
+    // Are we painting ?
+    // While painting, use a single render thread and always the same thread.
+    RotoStrokeItemPtr curStroke = _imp->viewer->getApp()->getActiveRotoDrawingStroke();
+
+    // Any pending coalesced render is superseded by this request: either it is rendered now, or
+    // it is re-deferred below with this request merged into it.
+    _imp->coalescedRenderPending = false;
+    bool coalescedStats = _imp->coalescedRenderStats;
+    _imp->coalescedRenderStats = false;
+    enableRenderStats |= coalescedStats;
+
+    // Coalesce seeks while scrubbing the timeline: dragging emits one seekFrame() per mouse move
+    // (see TimeLine.cpp) and each seek would start a render that the next seek aborts moments
+    // later. Launch at most one render per measured frame latency; in between, only remember
+    // that a render is due and let the coalesce timer issue it. The frame to render is read when
+    // the render is actually launched, so the latest seek position always wins.
+    if ( !curStroke && !isTracking && viewerNode->getApp()->isDraftRenderEnabled() ) {
+        double minIntervalMs = NATRON_VIEWER_SEEK_COALESCE_MIN_INTERVAL_MS;
+        double lastDurationSeconds = viewerNode->getLastInteractiveRenderDurationSeconds();
+        if (lastDurationSeconds > 0.) {
+            minIntervalMs = std::max( minIntervalMs, std::min(lastDurationSeconds * 1000., (double)NATRON_VIEWER_SEEK_COALESCE_MAX_INTERVAL_MS) );
+        }
+        if (_imp->lastScrubRenderStart) {
+            double elapsedMs = _imp->lastScrubRenderStart->getTimeSinceCreation() * 1000.;
+            if (elapsedMs < minIntervalMs) {
+                _imp->coalescedRenderPending = true;
+                _imp->coalescedRenderStats = enableRenderStats;
+                if ( !_imp->seekCoalesceTimer.isActive() ) {
+                    _imp->seekCoalesceTimer.start( (int)(minIntervalMs - elapsedMs) + 1 );
+                }
+
+                return;
+            }
+        }
+        _imp->lastScrubRenderStart.reset(new TimeLapse);
+    }
+
     // Get the frame/view to render
     TimeValue frame;
     ViewIdx view;
@@ -3681,15 +4944,6 @@ ViewerCurrentFrameRequestScheduler::renderCurrentFrame(bool enableRenderStats)
     }
 
 
-
-    // Are we tracking ?
-    bool isTracking = viewerNode->isDoingPartialUpdates();
-
-    // Are we painting ?
-    // While painting, use a single render thread and always the same thread.
-    RotoStrokeItemPtr curStroke = _imp->viewer->getApp()->getActiveRotoDrawingStroke();
-
-
     // Ok we have to render at least one of A or B input
     boost::shared_ptr<CurrentFrameFunctorArgs> functorArgs( new CurrentFrameFunctorArgs(view,
                                                                                         frame,
@@ -3698,7 +4952,9 @@ ViewerCurrentFrameRequestScheduler::renderCurrentFrame(bool enableRenderStats)
                                                                                         _imp.get(),
                                                                                         curStroke) );
 
-
+    // When the full resolution settle timer fired, this render bypasses the draft mode auto-proxy level
+    functorArgs->settleToFullResolution = _imp->settleToFullResolution;
+    _imp->settleToFullResolution = false;
 
     // Identify this render request with an age
 
@@ -3716,10 +4972,175 @@ ViewerCurrentFrameRequestScheduler::renderCurrentFrame(bool enableRenderStats)
     // When painting, limit the number of threads to 1 to be sure strokes are painted in the right order
     renderCurrentFrameInternal(functorArgs, curStroke || isTracking);
 
+    // Speculatively warm the cache ahead of the playhead: derive the seek direction from
+    // the previous request and launch low priority renders of the next frames. They are
+    // cancelled in onAbortRequested() as soon as the user goes elsewhere.
+    if (!curStroke && !isTracking) {
+
+        U64 epoch;
+        std::vector<TimeValue> framesToPrefetch;
+        {
+            QMutexLocker k(&_imp->prefetchDataMutex);
+            if (_imp->lastRequestedFrame != INT_MIN && (int)frame != _imp->lastRequestedFrame) {
+                _imp->lastSeekDirection = (int)frame > _imp->lastRequestedFrame ? 1 : -1;
+            }
+            _imp->lastRequestedFrame = (int)frame;
+            ++_imp->prefetchEpoch;
+            epoch = _imp->prefetchEpoch;
+
+            int firstFrame, lastFrame;
+            viewerNode->getTimelineBounds(&firstFrame, &lastFrame);
+            for (int i = 1; i <= NATRON_VIEWER_PREFETCH_NUM_FRAMES; ++i) {
+                int speculatedFrame = (int)frame + i * _imp->lastSeekDirection;
+                if (speculatedFrame < firstFrame || speculatedFrame > lastFrame) {
+                    break;
+                }
+                framesToPrefetch.push_back( TimeValue(speculatedFrame) );
+            }
+        }
+
+        // Only prefetch if the thread pool is not already busy: the current frame render has priority
+        if ( !framesToPrefetch.empty() && (_imp->threadPool->activeThreadCount() < _imp->threadPool->maxThreadCount()) ) {
+            ViewerPlayheadPrefetchRunnable* prefetchTask = new ViewerPlayheadPrefetchRunnable(_imp->viewer, view, framesToPrefetch, _imp.get(), epoch);
+            prefetchTask->setAutoDelete(true);
+            _imp->threadPool->start(prefetchTask, -1 /*priority*/);
+        }
+    }
+
+    // While scrubbing the timeline in draft mode, schedule a full resolution render if the playhead
+    // rests for a while, see onFullResSettleTimerTimeout(). The settle render itself does not re-arm
+    // the timer: only a new scrub render does.
+    if ( !functorArgs->settleToFullResolution && viewerNode->getApp()->isDraftRenderEnabled() ) {
+        _imp->fullResSettleTimer.start(NATRON_VIEWER_FULLRES_SETTLE_DELAY_MS);
+    }
 
+    // Re-arm the idle speculation timer: if no other render request comes in for a while, the
+    // timeline frame range is rendered in the background into the cache, see onIdleSpeculationTimerTimeout()
+    _imp->idleSpeculationTimer.start(NATRON_VIEWER_IDLE_SPECULATION_DELAY_MS);
 
 } // ViewerCurrentFrameRequestScheduler::renderCurrentFrame
 
+void
+ViewerCurrentFrameRequestScheduler::onFullResSettleTimerTimeout()
+{
+    // Always running on the main-thread
+    assert( qApp && qApp->thread() == QThread::currentThread() );
+
+    NodePtr treeRoot = _imp->viewer;
+    ViewerNodePtr viewerNode = treeRoot ? treeRoot->isEffectViewerNode() : ViewerNodePtr();
+    if ( !viewerNode || !viewerNode->isViewerUIVisible() ) {
+        return;
+    }
+
+    // If scrubbing stopped meanwhile, a full quality render was already scheduled upon mouse release
+    if ( !viewerNode->getApp()->isDraftRenderEnabled() ) {
+        return;
+    }
+
+    // The playhead rested while scrubbing: settle to a full resolution render
+    _imp->settleToFullResolution = true;
+    renderCurrentFrame(false /*enableRenderStats*/);
+}
+
+void
+ViewerCurrentFrameRequestScheduler::onSeekCoalesceTimerTimeout()
+{
+    // Always running on the main-thread
+    assert( qApp && qApp->thread() == QThread::currentThread() );
+
+    if (!_imp->coalescedRenderPending) {
+        return;
+    }
+    _imp->coalescedRenderPending = false;
+    bool enableRenderStats = _imp->coalescedRenderStats;
+    _imp->coalescedRenderStats = false;
+
+    // The minimum inter-render interval elapsed: render the frame the playhead is at now. The
+    // seeks that were received in between are never rendered, which is the point.
+    renderCurrentFrame(enableRenderStats);
+}
+
+void
+ViewerCurrentFrameRequestScheduler::onIdleSpeculationTimerTimeout()
+{
+    assert( QThread::currentThread() == qApp->thread() );
+
+    if ( !appPTR->getCurrentSettings()->isIdleRenderAheadEnabled() ) {
+        return;
+    }
+
+    NodePtr treeRoot = _imp->viewer;
+    ViewerNodePtr viewerNode = treeRoot ? treeRoot->isEffectViewerNode() : ViewerNodePtr();
+    if ( !viewerNode || !viewerNode->isViewerUIVisible() ) {
+        return;
+    }
+    AppInstancePtr app = treeRoot->getApp();
+    if (!app) {
+        return;
+    }
+
+    // Check that the artist really went idle: never speculate whilst rendering, painting,
+    // tracking or scrubbing a parameter. If not idle, try again later.
+    bool busy = app->isDraftRenderEnabled() || app->getActiveRotoDrawingStroke() || viewerNode->isDoingPartialUpdates();
+    RenderEnginePtr engine = treeRoot->getRenderEngine();
+    if (engine) {
+        busy |= engine->hasActiveRender() || engine->isDoingSequentialRender();
+    }
+    if (!busy) {
+        QMutexLocker k(&_imp->renderAgeMutex);
+        busy |= !_imp->currentRenders.empty();
+    }
+    if (busy) {
+        _imp->idleSpeculationTimer.start(NATRON_VIEWER_IDLE_SPECULATION_DELAY_MS);
+        return;
+    }
+
+    // Get the frame/view to render, like in renderCurrentFrame()
+    TimeValue frame( viewerNode->getTimeline()->currentFrame() );
+    int viewsCount = viewerNode->getRenderViewsCount();
+    const ViewIdx view = viewsCount > 0 ? viewerNode->getCurrentRenderView() : ViewIdx(0);
+
+    // Render the whole timeline frame range starting at the playhead in the direction the user was
+    // last seeking, wrapping around the bounds. Cached frames are cheap to revisit: their render is
+    // mostly cache look-ups.
+    U64 epoch;
+    std::vector<TimeValue> framesToPrefetch;
+    {
+        QMutexLocker k(&_imp->prefetchDataMutex);
+        if (!_imp->idleSpeculationEnabled) {
+            return;
+        }
+        ++_imp->prefetchEpoch;
+        epoch = _imp->prefetchEpoch;
+
+        int firstFrame, lastFrame;
+        viewerNode->getTimelineBounds(&firstFrame, &lastFrame);
+        const int range = lastFrame - firstFrame + 1;
+        if (range <= 1) {
+            return;
+        }
+        const int base = std::max( firstFrame, std::min( (int)frame, lastFrame ) );
+        const int direction = _imp->lastSeekDirection >= 0 ? 1 : -1;
+        for (int i = 1; i < range; ++i) {
+            int speculatedFrame = base + i * direction;
+            if (speculatedFrame > lastFrame) {
+                speculatedFrame -= range;
+            } else if (speculatedFrame < firstFrame) {
+                speculatedFrame += range;
+            }
+            framesToPrefetch.push_back( TimeValue(speculatedFrame) );
+        }
+    }
+
+    if ( !framesToPrefetch.empty() ) {
+        // Use an even lower priority than the seek-direction prefetch so that it still goes first
+        // if the user resumes scrubbing.
+        ViewerPlayheadPrefetchRunnable* speculationTask = new ViewerPlayheadPrefetchRunnable(_imp->viewer, view, framesToPrefetch, _imp.get(), epoch);
+        speculationTask->setAutoDelete(true);
+        _imp->threadPool->start(speculationTask, -2 /*priority*/);
+    }
+} // ViewerCurrentFrameRequestScheduler::onIdleSpeculationTimerTimeout
+
 bool
 ViewerCurrentFrameRequestScheduler::hasThreadsAlive() const
 {
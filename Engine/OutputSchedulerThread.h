@@ -27,6 +27,7 @@
 
 #include "Global/Macros.h"
 
+#include <list>
 #include <vector>
 
 #if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
@@ -259,6 +260,27 @@ public:
      **/
     void notifyThreadAboutToQuit(RenderThreadTask* thread);
 
+    /**
+     * @brief Called by the render-threads once a frame render completed with the wall time it took.
+     * This adjusts the number of frames rendered concurrently: it is raised when a lone frame render
+     * leaves the thread pool partly idle and the cache memory can hold more in-flight frames, and
+     * lowered when the pool is saturated, the frame time degrades or memory runs short.
+     **/
+    void notifyFrameRenderTime(double frameRenderTimeSec);
+
+    /**
+     * @brief Returns a formatted report of the frames that missed the playback frame budget
+     * (1/fps) this session along with the nodes that were the most expensive in those frames.
+     * The per-node breakdown is only available for renders launched with render stats enabled.
+     * The log is process-wide: all schedulers feed the same report.
+     **/
+    static std::string dumpFrameBudgetReport();
+
+    /**
+     * @brief Discards the frames and nodes recorded by the frame-budget watchdog.
+     **/
+    static void resetFrameBudgetReport();
+
     /**
      *@brief The slot called by the GUI to set the requested fps.
      **/
@@ -351,10 +373,27 @@ protected:
      **/
     virtual void onRenderStopped(bool /*aborted*/) {}
 
+    /**
+     * @brief Callback when a frame finished rendering, so that the scheduler may record it
+     * in the resume manifest of the job, see RenderCheckpointManifest
+     **/
+    virtual void onFrameRenderedCheckpoint(TimeValue /*frame*/) {}
 
+    /**
+     * @brief The frames that realtime playback skipped because they missed their deadline,
+     * cleared by this call. See RenderEngine::setRealtimePlaybackEnabled
+     **/
+    std::list<double> takeSkippedPlaybackFrames();
 
 private:
 
+    /**
+     * @brief Called in realtime playback when the expected frame was not rendered within its
+     * frame deadline: moves the playhead forward onto the nearest rendered frame (if any) so
+     * that the display does not stall, and flags the skipped frames for later cache warming.
+     **/
+    void skipLateFramesAndCatchUp();
+
     virtual void onAbortRequested(bool keepOldestRender) OVERRIDE FINAL;
     virtual void executeOnMainThread(const ExecOnMTArgsPtr& inArgs) OVERRIDE FINAL;
 
@@ -414,11 +453,18 @@ private:
     virtual void handleRenderFailure(ActionRetCodeEnum stat, const std::string& errorMessage) OVERRIDE FINAL;
     virtual void aboutToStartRender() OVERRIDE FINAL;
     virtual void onRenderStopped(bool aborted) OVERRIDE FINAL;
-    
+    virtual void onFrameRenderedCheckpoint(TimeValue frame) OVERRIDE FINAL;
+
 private:
 
     mutable QMutex _currentTimeMutex;
     TimeValue _currentTime;
+
+    // The resume manifest of the current job, written as frames complete so that a
+    // relaunch of a crashed or aborted job does not re-render them. Empty if the
+    // output cannot be resumed (no filename parameter or single-file output).
+    mutable QMutex _checkpointMutex;
+    std::string _checkpointManifestPath;
 };
 
 
@@ -495,6 +541,26 @@ public Q_SLOTS:
 
     void onDoProcessFrameOnMainThreadReceived(U64 age, const BufferedFrameContainerPtr& frames);
 
+    /**
+     * @brief Triggered a few seconds after the last current-frame render request: if the application
+     * is still idle, speculatively render the timeline frame range into the cache, see the
+     * "Render ahead during idle time" setting.
+     **/
+    void onIdleSpeculationTimerTimeout();
+
+    /**
+     * @brief Triggered when the playhead rested for a while during a timeline scrub in draft mode:
+     * schedules a full resolution render so the image settles.
+     **/
+    void onFullResSettleTimerTimeout();
+
+    /**
+     * @brief Triggered when a render request was deferred by the seek coalescing logic of
+     * renderCurrentFrame(): launches the render for the current playhead position, so that
+     * only the latest of the seeks received during the hold-off interval is rendered.
+     **/
+    void onSeekCoalesceTimerTimeout();
+
 Q_SIGNALS:
 
     void doProcessFrameOnMainThread(U64 age, BufferedFrameContainerPtr frames);
@@ -611,6 +677,16 @@ public:
      **/
     void setPlaybackAutoRestartEnabled(bool enabled);
 
+    /**
+     * @brief When enabled, playback never blocks the display on an unfinished render: if the
+     * frame to display is not rendered when it is due according to the desired fps, the
+     * scheduler catches up on the nearest rendered frame in the playback direction instead.
+     * Skipped frames are reported with the playbackFrameSkipped signal and warmed in the cache
+     * once playback stops, so a later pass over them is smooth.
+     **/
+    bool isRealtimePlaybackEnabled() const;
+    void setRealtimePlaybackEnabled(bool enabled);
+
     /**
      * @brief Returns the playback mode of the internal scheduler
      **/
@@ -698,6 +774,8 @@ public:
     void s_frameRendered(int time,
                          double progress) { Q_EMIT frameRendered(time, progress); }
 
+    void s_playbackFrameSkipped(int time) { Q_EMIT playbackFrameSkipped(time); }
+
     void s_renderStarted(bool forward) { Q_EMIT renderStarted(forward); }
 
     void s_renderFinished(int retCode) { Q_EMIT renderFinished(retCode); }
@@ -747,6 +825,12 @@ Q_SIGNALS:
      **/
     void frameRendered(int time, double progress);
 
+    /**
+     * @brief Emitted during realtime playback when the given frame missed its deadline and was
+     * skipped, so that the timeline may flag it.
+     **/
+    void playbackFrameSkipped(int time);
+
 
     /**
      * @brief Emitted when the stopRender() function is called
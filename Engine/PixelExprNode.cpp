@@ -0,0 +1,460 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2013-2017 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "PixelExprNode.h"
+
+#include <cassert>
+#include <list>
+#include <stdexcept>
+#include <string>
+
+#include <QtCore/QMutex>
+
+#include "Engine/Image.h"
+#include "Engine/KnobTypes.h"
+#include "Engine/MultiThread.h"
+#include "Engine/Node.h"
+
+// reduce object size:
+// we only include exprtk.hpp here, as in ExprTk.cpp, and keep the template instanciations
+// local to this translation unit.
+
+// include everything included by exprtk.hpp, because we want to put exprtk itself in an anonymous namespace
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <set>
+#include <stack>
+#include <utility>
+#include <vector>
+#ifdef __GNUC__
+#ifndef __clang__
+#pragma GCC push_options
+#pragma GCC optimize ("-O3")
+#endif
+#pragma GCC visibility push(hidden)
+#endif
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+#include "exprtk.hpp"
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+#ifdef __GNUC__
+#pragma GCC visibility pop
+#ifndef __clang__
+#pragma GCC pop_options
+#endif
+
+#endif
+
+#define kPixelExprNodeParamExprR "exprR"
+#define kPixelExprNodeParamExprRLabel "R"
+
+#define kPixelExprNodeParamExprG "exprG"
+#define kPixelExprNodeParamExprGLabel "G"
+
+#define kPixelExprNodeParamExprB "exprB"
+#define kPixelExprNodeParamExprBLabel "B"
+
+#define kPixelExprNodeParamExprA "exprA"
+#define kPixelExprNodeParamExprALabel "A"
+
+#define kPixelExprNodeParamExprHint "Expression computing this output channel. The available symbols are: " \
+"x, y (pixel coordinates at the current render scale), frame (the current time), width, height " \
+"(the size of the image in pixels), and r, g, b, a (the input channels at the current pixel). " \
+"The syntax is the same exprtk syntax used for parameter expressions. If empty, the input channel " \
+"is passed through unchanged."
+
+#define kNatronPersistentErrorPixelExpr "NatronPersistentErrorPixelExpr"
+
+NATRON_NAMESPACE_ENTER;
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+// Pixels are floats: evaluating in float avoids a double round-trip per channel per pixel.
+typedef float PixelExprScalar;
+typedef exprtk::symbol_table<PixelExprScalar> PixelExprSymbolTable;
+typedef exprtk::expression<PixelExprScalar> PixelExprExpression;
+typedef exprtk::parser<PixelExprScalar> PixelExprParser;
+
+/**
+ * @brief One compiled copy of the channel expressions along with the symbol variables
+ * they are bound to. Evaluating an expression reads the bound variables, hence a state
+ * can never be used by two threads at the same time: each thread of the processor
+ * acquires its own state for the whole of its share of scanlines.
+ **/
+struct PixelExprThreadState
+{
+    PixelExprScalar x, y, frame, width, height;
+    PixelExprScalar r, g, b, a;
+    PixelExprSymbolTable symbols;
+    PixelExprExpression expr[4];
+    bool hasExpr[4];
+
+    PixelExprThreadState()
+    : x(0), y(0), frame(0), width(0), height(0)
+    , r(0), g(0), b(0), a(0)
+    , symbols()
+    {
+        for (int c = 0; c < 4; ++c) {
+            hasExpr[c] = false;
+        }
+    }
+
+    bool compile(const std::string scripts[4], std::string* error)
+    {
+        symbols.add_variable("x", x);
+        symbols.add_variable("y", y);
+        symbols.add_variable("frame", frame);
+        symbols.add_variable("width", width);
+        symbols.add_variable("height", height);
+        symbols.add_variable("r", r);
+        symbols.add_variable("g", g);
+        symbols.add_variable("b", b);
+        symbols.add_variable("a", a);
+        symbols.add_constants();
+
+        PixelExprParser parser;
+        for (int c = 0; c < 4; ++c) {
+            if ( scripts[c].empty() ) {
+                continue;
+            }
+            expr[c].register_symbol_table(symbols);
+            if ( !parser.compile(scripts[c], expr[c]) ) {
+                if (error) {
+                    *error = parser.error();
+                }
+                return false;
+            }
+            hasExpr[c] = true;
+        }
+        return true;
+    }
+};
+
+typedef boost::shared_ptr<PixelExprThreadState> PixelExprThreadStatePtr;
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+
+struct PixelExprNodePrivate
+{
+    KnobStringWPtr channelExpr[4];
+
+    // Compiled expression states ready for re-use by the render processor threads,
+    // see PixelExprThreadState. On a render clone the expressions cannot change,
+    // so states compiled for a previous plane/tile are valid for the whole render.
+    QMutex statesMutex;
+    std::list<PixelExprThreadStatePtr> freeStates;
+
+    PixelExprNodePrivate()
+    : statesMutex()
+    , freeStates()
+    {
+    }
+};
+
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+class PixelExprProcessor : public ImageMultiThreadProcessorBase
+{
+    Image::CPUData _srcImgData, _dstImgData;
+    std::string _scripts[4];
+    TimeValue _time;
+    PixelExprNodePrivate* _imp;
+
+public:
+
+    PixelExprProcessor(const EffectInstancePtr& renderClone)
+    : ImageMultiThreadProcessorBase(renderClone)
+    , _time(0)
+    , _imp(0)
+    {
+    }
+
+    virtual ~PixelExprProcessor()
+    {
+    }
+
+    void setValues(const Image::CPUData& srcImgData,
+                   const Image::CPUData& dstImgData,
+                   const std::string scripts[4],
+                   TimeValue time,
+                   PixelExprNodePrivate* imp)
+    {
+        _srcImgData = srcImgData;
+        _dstImgData = dstImgData;
+        for (int c = 0; c < 4; ++c) {
+            _scripts[c] = scripts[c];
+        }
+        _time = time;
+        _imp = imp;
+    }
+
+private:
+
+    PixelExprThreadStatePtr acquireThreadState()
+    {
+        {
+            QMutexLocker k(&_imp->statesMutex);
+            if ( !_imp->freeStates.empty() ) {
+                PixelExprThreadStatePtr state = _imp->freeStates.front();
+                _imp->freeStates.pop_front();
+                return state;
+            }
+        }
+        // Expressions were validated up-front in render(), a compilation failure
+        // here can only mean we ran out of memory.
+        PixelExprThreadStatePtr state( new PixelExprThreadState() );
+        if ( !state->compile(_scripts, 0) ) {
+            return PixelExprThreadStatePtr();
+        }
+        return state;
+    }
+
+    void releaseThreadState(const PixelExprThreadStatePtr& state)
+    {
+        QMutexLocker k(&_imp->statesMutex);
+        _imp->freeStates.push_back(state);
+    }
+
+    virtual ActionRetCodeEnum multiThreadProcessImages(const RectI& renderWindow) OVERRIDE FINAL
+    {
+        PixelExprThreadStatePtr state = acquireThreadState();
+        if (!state) {
+            return eActionStatusFailed;
+        }
+
+        state->frame = _time;
+        state->width = _dstImgData.bounds.width();
+        state->height = _dstImgData.bounds.height();
+
+        Image::ScanlineIterator<float> src( (const float**)_srcImgData.ptrs, renderWindow.x1, renderWindow.y1, _srcImgData.bounds, _srcImgData.nComps );
+        Image::ScanlineIterator<float> dst( (const float**)_dstImgData.ptrs, renderWindow.x1, renderWindow.y1, _dstImgData.bounds, _dstImgData.nComps );
+
+        const int srcStride = src.getPixelStride();
+        const int dstStride = dst.getPixelStride();
+
+        for (int y = renderWindow.y1; y < renderWindow.y2; ++y) {
+
+            if ( _effect && _effect->isRenderAborted() ) {
+                releaseThreadState(state);
+                return eActionStatusAborted;
+            }
+
+            state->y = y;
+
+            float* srcPix[4];
+            float* dstPix[4];
+            src.pixelsAt(0, srcPix);
+            dst.pixelsAt(0, dstPix);
+
+            for (int x = renderWindow.x1; x < renderWindow.x2; ++x) {
+
+                state->x = x;
+                state->r = srcPix[0] ? *srcPix[0] : 0.f;
+                state->g = srcPix[1] ? *srcPix[1] : 0.f;
+                state->b = srcPix[2] ? *srcPix[2] : 0.f;
+                state->a = srcPix[3] ? *srcPix[3] : 1.f;
+
+                for (int c = 0; c < 4; ++c) {
+                    if (!dstPix[c]) {
+                        continue;
+                    }
+                    if (state->hasExpr[c]) {
+                        *dstPix[c] = state->expr[c].value();
+                    } else {
+                        // No expression for this channel: pass the input channel through
+                        *dstPix[c] = (c == 0) ? state->r : (c == 1) ? state->g : (c == 2) ? state->b : state->a;
+                    }
+                    dstPix[c] += dstStride;
+                }
+                for (int c = 0; c < 4; ++c) {
+                    if (srcPix[c]) {
+                        srcPix[c] += srcStride;
+                    }
+                }
+            }
+            src.nextRow();
+            dst.nextRow();
+        }
+
+        releaseThreadState(state);
+
+        return eActionStatusOK;
+    } // multiThreadProcessImages
+};
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+
+PluginPtr
+PixelExprNode::createPlugin()
+{
+    std::vector<std::string> grouping;
+    grouping.push_back(PLUGIN_GROUP_COLOR);
+    PluginPtr ret = Plugin::create((void*)PixelExprNode::create, (void*)PixelExprNode::createRenderClone, PLUGINID_NATRON_PIXELEXPR, "PixelExpr", 1, 0, grouping);
+
+    QString desc =  tr("Quickly apply a per-pixel math expression to each channel of the input image, "
+                       "without leaving %1 or writing a plug-in. Expressions use the same exprtk syntax as parameter "
+                       "expressions and are compiled once then evaluated in parallel over the image scanlines, "
+                       "so they are suitable for full-resolution sequences. An empty expression leaves the "
+                       "corresponding channel untouched.").arg( QString::fromUtf8(NATRON_APPLICATION_NAME) );
+    ret->setProperty<std::string>(kNatronPluginPropDescription, desc.toStdString());
+    ret->setProperty<int>(kNatronPluginPropRenderSafety, (int)eRenderSafetyFullySafe);
+    return ret;
+}
+
+
+PixelExprNode::PixelExprNode(const NodePtr& node)
+    : EffectInstance(node)
+    , _imp( new PixelExprNodePrivate() )
+{
+}
+
+PixelExprNode::PixelExprNode(const EffectInstancePtr& mainInstance, const FrameViewRenderKey& key)
+: EffectInstance(mainInstance, key)
+, _imp( new PixelExprNodePrivate() )
+{
+}
+
+PixelExprNode::~PixelExprNode()
+{
+}
+
+void
+PixelExprNode::addAcceptedComponents(int /*inputNb*/,
+                                     std::bitset<4>* supported)
+{
+    (*supported)[0] = (*supported)[1] = (*supported)[2] = (*supported)[3] = 1;
+}
+
+void
+PixelExprNode::addSupportedBitDepth(std::list<ImageBitDepthEnum>* depths) const
+{
+    depths->push_back(eImageBitDepthFloat);
+}
+
+void
+PixelExprNode::initializeKnobs()
+{
+    KnobPagePtr page = createKnob<KnobPage>("controlsPage");
+    page->setLabel( tr("Controls") );
+
+    const char* names[4] = {kPixelExprNodeParamExprR, kPixelExprNodeParamExprG, kPixelExprNodeParamExprB, kPixelExprNodeParamExprA};
+    const char* labels[4] = {kPixelExprNodeParamExprRLabel, kPixelExprNodeParamExprGLabel, kPixelExprNodeParamExprBLabel, kPixelExprNodeParamExprALabel};
+    for (int c = 0; c < 4; ++c) {
+        KnobStringPtr knob = createKnob<KnobString>(names[c]);
+        knob->setLabel( tr(labels[c]) );
+        knob->setHintToolTip( tr(kPixelExprNodeParamExprHint) );
+        knob->setAsMultiLine();
+        knob->setAnimationEnabled(false);
+        page->addKnob(knob);
+        _imp->channelExpr[c] = knob;
+    }
+}
+
+void
+PixelExprNode::fetchRenderCloneKnobs()
+{
+    EffectInstance::fetchRenderCloneKnobs();
+    _imp->channelExpr[0] = toKnobString( getKnobByName(kPixelExprNodeParamExprR) );
+    _imp->channelExpr[1] = toKnobString( getKnobByName(kPixelExprNodeParamExprG) );
+    _imp->channelExpr[2] = toKnobString( getKnobByName(kPixelExprNodeParamExprB) );
+    _imp->channelExpr[3] = toKnobString( getKnobByName(kPixelExprNodeParamExprA) );
+}
+
+ActionRetCodeEnum
+PixelExprNode::render(const RenderActionArgs& args)
+{
+    std::string scripts[4];
+    for (int c = 0; c < 4; ++c) {
+        KnobStringPtr knob = _imp->channelExpr[c].lock();
+        if (knob) {
+            scripts[c] = knob->getValue();
+        }
+    }
+
+    // Compile once on this thread so that syntax errors are reported to the user:
+    // the state is then pushed to the pool and re-used by the processor threads.
+    {
+        QMutexLocker k(&_imp->statesMutex);
+        if ( _imp->freeStates.empty() ) {
+            k.unlock();
+            PixelExprThreadStatePtr state( new PixelExprThreadState() );
+            std::string error;
+            if ( !state->compile(scripts, &error) ) {
+                getNode()->setPersistentMessage(eMessageTypeError, kNatronPersistentErrorPixelExpr, error);
+                return eActionStatusFailed;
+            }
+            k.relock();
+            _imp->freeStates.push_back(state);
+        }
+    }
+    getNode()->clearPersistentMessage(kNatronPersistentErrorPixelExpr);
+
+    for (std::list<std::pair<ImagePlaneDesc, ImagePtr > >::const_iterator it = args.outputPlanes.begin(); it != args.outputPlanes.end(); ++it) {
+
+        GetImageInArgs inArgs(&args.mipMapLevel, &args.proxyScale, &args.roi, &args.backendType);
+        inArgs.inputNb = 0;
+        inArgs.plane = &it->first;
+        GetImageOutArgs outArgs;
+        if ( !getImagePlane(inArgs, &outArgs) ) {
+            return eActionStatusInputDisconnected;
+        }
+
+        Image::CPUData srcImgData, dstImgData;
+        outArgs.image->getCPUData(&srcImgData);
+        it->second->getCPUData(&dstImgData);
+
+        RectI renderWindow;
+        if ( !args.roi.intersect(dstImgData.bounds, &renderWindow) ||
+             !renderWindow.intersect(srcImgData.bounds, &renderWindow) ) {
+            continue;
+        }
+
+        PixelExprProcessor processor( shared_from_this() );
+        processor.setValues(srcImgData, dstImgData, scripts, args.time, _imp.get());
+        processor.setRenderWindow(renderWindow);
+        ActionRetCodeEnum stat = processor.process();
+        if ( isFailureRetCode(stat) ) {
+            return stat;
+        }
+    }
+
+    return eActionStatusOK;
+} // render
+
+NATRON_NAMESPACE_EXIT;
@@ -0,0 +1,121 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2013-2017 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef PIXELEXPRNODE_H
+#define PIXELEXPRNODE_H
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/scoped_ptr.hpp>
+#endif
+
+#include "Engine/EffectInstance.h"
+
+#include "Engine/EngineFwd.h"
+
+NATRON_NAMESPACE_ENTER;
+
+struct PixelExprNodePrivate;
+
+/**
+ * @brief A host-native per-pixel expression node: one expression per output channel,
+ * written in the same exprtk language that is used for knob expressions.
+ * Expressions are compiled once per render and evaluated per scanline by the
+ * multi-threaded image processor pool, each thread owning its compiled copy.
+ **/
+class PixelExprNode
+    : public EffectInstance
+{
+private: // derives from EffectInstance
+    // constructors should be privatized in any class that derives from boost::enable_shared_from_this<>
+    PixelExprNode(const NodePtr& node);
+
+    PixelExprNode(const EffectInstancePtr& mainInstance, const FrameViewRenderKey& key);
+
+public:
+    static EffectInstancePtr create(const NodePtr& node) WARN_UNUSED_RETURN
+    {
+        return EffectInstancePtr( new PixelExprNode(node) );
+    }
+
+    static EffectInstancePtr createRenderClone(const EffectInstancePtr& mainInstance, const FrameViewRenderKey& key) WARN_UNUSED_RETURN
+    {
+        return EffectInstancePtr( new PixelExprNode(mainInstance, key) );
+    }
+
+    static PluginPtr createPlugin();
+
+    virtual ~PixelExprNode();
+
+
+    virtual int getMaxInputCount() const OVERRIDE FINAL WARN_UNUSED_RETURN
+    {
+        return 1;
+    }
+
+    virtual std::string getInputLabel (int /*inputNb*/) const OVERRIDE FINAL WARN_UNUSED_RETURN
+    {
+        return "Source";
+    }
+
+    virtual bool isInputOptional(int /*inputNb*/) const OVERRIDE FINAL WARN_UNUSED_RETURN
+    {
+        return false;
+    }
+
+    virtual void addAcceptedComponents(int inputNb, std::bitset<4>* comps) OVERRIDE FINAL;
+
+    virtual void addSupportedBitDepth(std::list<ImageBitDepthEnum>* depths) const OVERRIDE FINAL;
+
+    virtual bool supportsTiles() const OVERRIDE FINAL WARN_UNUSED_RETURN
+    {
+        return true;
+    }
+
+    virtual bool supportsMultiResolution() const OVERRIDE FINAL WARN_UNUSED_RETURN
+    {
+        return true;
+    }
+
+    virtual void initializeKnobs() OVERRIDE FINAL;
+
+private:
+
+    virtual void fetchRenderCloneKnobs() OVERRIDE FINAL;
+
+    virtual ActionRetCodeEnum render(const RenderActionArgs& args) OVERRIDE FINAL;
+
+    boost::scoped_ptr<PixelExprNodePrivate> _imp;
+};
+
+inline PixelExprNodePtr
+toPixelExprNode(const EffectInstancePtr& effect)
+{
+    return boost::dynamic_pointer_cast<PixelExprNode>(effect);
+}
+
+NATRON_NAMESPACE_EXIT;
+
+#endif // PIXELEXPRNODE_H
@@ -24,27 +24,191 @@
 
 #include "PluginMemory.h"
 
+#include <cstdlib>
+#include <map>
 #include <vector>
 #include <cassert>
 #include <stdexcept>
 
 CLANG_DIAG_OFF(deprecated)
 #include <QtCore/QMutex>
+#include <QtCore/QThreadStorage>
 CLANG_DIAG_ON(deprecated)
+#include <algorithm> // max
+
 #include "Engine/AppManager.h"
 #include "Engine/Cache.h"
-#include "Engine/RamBuffer.h"
 NATRON_NAMESPACE_ENTER;
 
+// Buffers are rounded up to the nearest power of two so that a recycled buffer can serve
+// any request of its size class.
+#define NATRON_PLUGIN_MEMORY_POOL_MIN_SIZE (1 << 12) // 4KB
+
+// Maximum amount of free buffers retained by the pool of each thread. Buffers released
+// past this limit are returned to the system immediately.
+#define NATRON_PLUGIN_MEMORY_POOL_MAX_BYTES_PER_THREAD (64 << 20) // 64MB
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+// Process-wide record of the scratch bytes allocated by each plug-in through the memory
+// suite, maintained by PluginMemory::allocateMemoryImpl()/deallocateMemoryImpl()
+struct PluginMemoryUsageRegistry
+{
+    QMutex lock;
+    std::map<std::string, PluginMemoryUsageInfo> infos;
+
+    PluginMemoryUsageRegistry()
+    : lock()
+    , infos()
+    {
+    }
+};
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+static PluginMemoryUsageRegistry&
+getPluginMemoryUsageRegistry()
+{
+    static PluginMemoryUsageRegistry registry;
+
+    return registry;
+}
+
+static void
+registerPluginUsageBytes(const std::string& pluginID,
+                         std::size_t nBytes)
+{
+    PluginMemoryUsageRegistry& registry = getPluginMemoryUsageRegistry();
+    QMutexLocker k(&registry.lock);
+    PluginMemoryUsageInfo& info = registry.infos[pluginID.empty() ? NATRON_MEMORY_ATTRIBUTION_UNTAGGED_NAME : pluginID];
+
+    info.nBytes += nBytes;
+    info.peakNBytes = std::max(info.peakNBytes, info.nBytes);
+}
+
+static void
+unregisterPluginUsageBytes(const std::string& pluginID,
+                           std::size_t nBytes)
+{
+    PluginMemoryUsageRegistry& registry = getPluginMemoryUsageRegistry();
+    QMutexLocker k(&registry.lock);
+    std::map<std::string, PluginMemoryUsageInfo>::iterator found = registry.infos.find(pluginID.empty() ? NATRON_MEMORY_ATTRIBUTION_UNTAGGED_NAME : pluginID);
+
+    if ( found == registry.infos.end() ) {
+        assert(false);
+
+        return;
+    }
+    assert(found->second.nBytes >= nBytes);
+    found->second.nBytes -= nBytes;
+
+    // The entry is kept around even when all buffers are freed: the high-water mark
+    // remains visible in the stats.
+}
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+// Plug-ins typically allocate scratch once per render action (through either the OFX memory
+// suite or EffectInstance::createMemoryChunk) with sizes that are identical from one frame
+// to the next. Freed buffers are recycled through a per-thread, size-classed pool so that
+// the memory suite does not hammer the system allocator when many render threads are active:
+// acquisition and release never take a lock.
+struct PluginMemoryPool
+{
+    // Free buffers, keyed by their size class
+    std::multimap<std::size_t, char*> freeBuffers;
+    std::size_t nbPooledBytes;
+
+    PluginMemoryPool()
+    : freeBuffers()
+    , nbPooledBytes(0)
+    {
+    }
+
+    ~PluginMemoryPool()
+    {
+        for (std::multimap<std::size_t, char*>::iterator it = freeBuffers.begin(); it != freeBuffers.end(); ++it) {
+            CacheBase::unregisterExternalMemory(it->first);
+            std::free(it->second);
+        }
+    }
+
+    char* acquire(std::size_t sizeClass)
+    {
+        std::multimap<std::size_t, char*>::iterator found = freeBuffers.find(sizeClass);
+        if ( found == freeBuffers.end() ) {
+            return 0;
+        }
+        char* data = found->second;
+        freeBuffers.erase(found);
+        nbPooledBytes -= sizeClass;
+
+        return data;
+    }
+
+    bool release(std::size_t sizeClass, char* data)
+    {
+        if (nbPooledBytes + sizeClass > NATRON_PLUGIN_MEMORY_POOL_MAX_BYTES_PER_THREAD) {
+            return false;
+        }
+        freeBuffers.insert( std::make_pair(sizeClass, data) );
+        nbPooledBytes += sizeClass;
+
+        return true;
+    }
+};
+
+static std::size_t
+getSizeClass(std::size_t nBytes)
+{
+    std::size_t sizeClass = NATRON_PLUGIN_MEMORY_POOL_MIN_SIZE;
+    while (sizeClass < nBytes) {
+        sizeClass <<= 1;
+    }
+
+    return sizeClass;
+}
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+// The pointer is owned by QThreadStorage: the pool of a thread is destroyed (returning its
+// buffers to the system) when the thread exits.
+static QThreadStorage<PluginMemoryPool*> perThreadMemoryPool;
+
+static PluginMemoryPool*
+getThreadMemoryPool()
+{
+    if ( !perThreadMemoryPool.hasLocalData() ) {
+        perThreadMemoryPool.setLocalData(new PluginMemoryPool);
+    }
+
+    return perThreadMemoryPool.localData();
+}
+
 struct PluginMemory::Implementation
 {
     Implementation()
-    : data()
+    : data(0)
+    , size(0)
+    , sizeClass(0)
+    , usagePluginID()
     , mutex()
     {
     }
 
-    RamBuffer<char> data;
+    // The buffer made available to the plug-in
+    char* data;
+
+    // The size requested by the plug-in
+    std::size_t size;
+
+    // The actual size of the buffer, rounded up to the pool size class
+    std::size_t sizeClass;
+
+    // The plug-in ID under which the buffer was recorded in the usage registry, so that
+    // exactly what was registered gets unregistered even if the attribution changes.
+    std::string usagePluginID;
+
     QMutex mutex;
 };
 
@@ -56,13 +220,16 @@ PluginMemory::PluginMemory()
 
 PluginMemory::~PluginMemory()
 {
-
+    // If the buffer was not explicitly deallocated, recycle it now
+    deallocateMemoryImpl();
 }
 
 std::size_t
 PluginMemory::getBufferSize() const
 {
-    return _imp->data.size();
+    QMutexLocker l(&_imp->mutex);
+
+    return _imp->size;
 }
 
 void
@@ -72,26 +239,76 @@ PluginMemory::allocateMemoryImpl(const AllocateMemoryArgs& args)
     assert(thisArgs);
 
     QMutexLocker l(&_imp->mutex);
-    _imp->data.resize(thisArgs->_nBytes);
+    assert(!_imp->data);
+
+    std::size_t sizeClass = getSizeClass(thisArgs->_nBytes);
+
+    // Try to recycle a buffer released by this thread before hitting the system allocator
+    char* data = getThreadMemoryPool()->acquire(sizeClass);
+    if (!data) {
+        data = (char*)std::malloc(sizeClass);
+        if (!data) {
+            throw std::bad_alloc();
+        }
+
+        // Count the new buffer against the cache budget (pooled buffers are already
+        // counted) and run an eviction check: if the budget is exceeded the caches evict
+        // their least recently used entries first instead of letting the process footprint
+        // grow unbounded.
+        CacheBase::registerExternalMemory(sizeClass);
+        appPTR->checkCachesMemory();
+    }
+
+    _imp->data = data;
+    _imp->size = thisArgs->_nBytes;
+    _imp->sizeClass = sizeClass;
+
+    // Record the usage of the plug-in and its high-water mark, see getPerPluginMemoryUsage()
+    _imp->usagePluginID = getMemoryAttributionPluginID();
+    registerPluginUsageBytes(_imp->usagePluginID, sizeClass);
 }
 
 void
 PluginMemory::deallocateMemoryImpl()
 {
     QMutexLocker l(&_imp->mutex);
-    _imp->data.clear();
+    if (!_imp->data) {
+        return;
+    }
+
+    // Hand the buffer back to the pool of this thread. If the pool is full, return the
+    // memory to the system instead. Pooled buffers remain counted against the cache budget
+    // since they are still resident.
+    if ( !getThreadMemoryPool()->release(_imp->sizeClass, _imp->data) ) {
+        CacheBase::unregisterExternalMemory(_imp->sizeClass);
+        std::free(_imp->data);
+    }
 
+    unregisterPluginUsageBytes(_imp->usagePluginID, _imp->sizeClass);
+
+    _imp->data = 0;
+    _imp->size = 0;
+    _imp->sizeClass = 0;
 }
 
 
+void
+PluginMemory::getPerPluginMemoryUsage(std::map<std::string, PluginMemoryUsageInfo>* infos)
+{
+    PluginMemoryUsageRegistry& registry = getPluginMemoryUsageRegistry();
+    QMutexLocker k(&registry.lock);
+
+    *infos = registry.infos;
+}
+
 char*
 PluginMemory::getData()
 {
     QMutexLocker l(&_imp->mutex);
 
-    assert( _imp->data.size() == 0 || ( _imp->data.size() > 0 && _imp->data.getData() ) );
+    assert(_imp->size == 0 || (_imp->size > 0 && _imp->data));
 
-    return _imp->data.getData();
+    return _imp->data;
 }
 
 NATRON_NAMESPACE_EXIT;
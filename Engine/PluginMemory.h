@@ -28,6 +28,8 @@
 #include "Global/Macros.h"
 
 #include <cstddef>
+#include <map>
+#include <string>
 #if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
 #include <boost/scoped_ptr.hpp>
 #endif
@@ -39,6 +41,24 @@
 
 NATRON_NAMESPACE_ENTER;
 
+/**
+ * @brief Scratch memory figures of one plug-in, see PluginMemory::getPerPluginMemoryUsage()
+ **/
+struct PluginMemoryUsageInfo
+{
+    // Bytes currently allocated by the plug-in through the memory suite
+    std::size_t nBytes;
+
+    // The high-water mark of nBytes since the process started
+    std::size_t peakNBytes;
+
+    PluginMemoryUsageInfo()
+    : nBytes(0)
+    , peakNBytes(0)
+    {
+    }
+};
+
 class PluginMemAllocateMemoryArgs : public AllocateMemoryArgs
 {
 public:
@@ -75,6 +95,13 @@ public:
 
     virtual std::size_t getBufferSize() const OVERRIDE FINAL;
 
+    /**
+     * @brief Returns the scratch memory currently allocated through the memory suite and
+     * its high-water mark, keyed by plug-in ID (see setMemoryAttribution()). Plug-ins whose
+     * buffers have all been freed keep their entry so the peak remains visible.
+     **/
+    static void getPerPluginMemoryUsage(std::map<std::string, PluginMemoryUsageInfo>* infos);
+
     virtual StorageModeEnum getStorageMode() const OVERRIDE FINAL
     {
         return eStorageModeRAM;
@@ -25,6 +25,7 @@
 #include "PrecompNode.h"
 
 #include <cassert>
+#include <map>
 #include <stdexcept>
 #include <sstream> // stringstream
 
@@ -34,6 +35,7 @@
 CLANG_DIAG_OFF(deprecated)
 CLANG_DIAG_OFF(uninitialized)
 #include <QtCore/QCoreApplication>
+#include <QtCore/QMutex>
 CLANG_DIAG_ON(deprecated)
 CLANG_DIAG_ON(uninitialized)
 
@@ -59,6 +61,68 @@ CLANG_DIAG_ON(uninitialized)
 
 NATRON_NAMESPACE_ENTER;
 
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+// PrecompNodes referencing the same project file share a single background app
+// instance: the sub-project graph is then loaded and rendered once for all of them,
+// and its frames are computed a single time in the process-wide caches instead of
+// once per Precomp node. Entries are ref-counted, the instance is quit when the last
+// Precomp node referencing the project file goes away.
+struct SharedPrecompApp
+{
+    AppInstancePtr app;
+    int refCount;
+
+    // Whether the project file was successfully loaded in the instance: the first
+    // Precomp node acquiring the instance loads it, the others re-use it as is
+    bool projectLoaded;
+
+    SharedPrecompApp()
+        : app()
+        , refCount(0)
+        , projectLoaded(false)
+    {
+    }
+};
+
+// Keyed by main app ID and canonical project file path: Precomp nodes of different
+// open projects each get their own sub-project instance because the sub-project
+// timeline is switched to the timeline of the main app, see
+// PrecompNodePrivate::loadSubProject()
+typedef std::map<std::string, SharedPrecompApp> SharedPrecompAppsMap;
+
+struct SharedPrecompAppsRegistry
+{
+    QMutex lock;
+    SharedPrecompAppsMap apps;
+
+    SharedPrecompAppsRegistry()
+        : lock()
+        , apps()
+    {
+    }
+};
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+static SharedPrecompAppsRegistry&
+getSharedPrecompAppsRegistry()
+{
+    static SharedPrecompAppsRegistry registry;
+
+    return registry;
+}
+
+static std::string
+makeSharedPrecompAppKey(const AppInstancePtr& mainApp,
+                        const QString& canonicalFilePath)
+{
+    std::stringstream ss;
+
+    ss << mainApp->getAppID() << '|' << canonicalFilePath.toStdString();
+
+    return ss.str();
+}
 
 PluginPtr
 PrecompNode::createPlugin()
@@ -87,6 +151,11 @@ struct PrecompNodePrivate
 public:
     PrecompNode* _publicInterface; // can not be a smart ptr
     AppInstanceWPtr app;
+
+    // The key of the entry of the shared pre-comp apps registry this node holds a
+    // reference on, empty if none
+    std::string sharedAppKey;
+
     KnobFileWPtr projectFileNameKnob;
     KnobButtonWPtr editProjectKnob;
     KnobBoolWPtr enablePreRenderKnob;
@@ -97,6 +166,11 @@ public:
     KnobStringWPtr outputNodeNameKnob;
     KnobChoiceWPtr errorBehaviourKnbo;
     KnobStringWPtr subLabelKnob;
+
+    // The images file pattern rendered by the selected Write node, persisted so that a
+    // new session with pre-render enabled can read the baked frames back directly
+    // without spawning the sub-project app, see PrecompNode::onKnobsLoaded()
+    KnobStringWPtr readFilePatternKnob;
     QMutex dataMutex;
 
     // To read-back the pre-comp image sequence/video
@@ -108,6 +182,7 @@ public:
     PrecompNodePrivate(PrecompNode* publicInterface)
     : _publicInterface(publicInterface)
     , app()
+    , sharedAppKey()
     , projectFileNameKnob()
     , editProjectKnob()
     , enablePreRenderKnob()
@@ -119,6 +194,7 @@ public:
     , outputNodeNameKnob()
     , errorBehaviourKnbo()
     , subLabelKnob()
+    , readFilePatternKnob()
     , dataMutex()
     , readNode()
     , subProjectOutputNode()
@@ -128,10 +204,45 @@ public:
 
     void refreshKnobsVisibility();
 
+    /**
+     * @brief Acquires (creating it if needed) the background app instance shared by all
+     * Precomp nodes referencing the given project file, releasing any previously held
+     * one. Returns false on failure. On return projectAlreadyLoaded is set to whether
+     * the project file was already loaded in the instance by another Precomp node.
+     **/
+    bool acquirePrecompApp(const QString& canonicalFilePath, bool* projectAlreadyLoaded);
+
+    /**
+     * @brief Releases the reference on the shared app instance, quitting it if this was
+     * the last Precomp node referencing its project file.
+     **/
+    void releasePrecompApp();
+
+    /**
+     * @brief Acquires the shared app instance for the project filename knob value and
+     * loads the project in it if no other Precomp node did already. Returns false if
+     * the file does not exist or fails to load.
+     **/
+    bool loadSubProject(bool errorIfMissing);
+
+    /**
+     * @brief Loads the sub-project if it was deferred by the warm start in
+     * onKnobsLoaded(), see readFilePatternKnob. Returns false if no sub-project is
+     * available.
+     **/
+    bool ensureProjectLoaded();
+
     void reloadProject(bool setWriteNodeChoice);
 
     void createReadNode();
 
+    /**
+     * @brief Creates the node reading back the given baked images file pattern and
+     * connects it to the group output. Unlike createReadNode() this does not need the
+     * sub-project app. Returns false if no reader can decode the pattern.
+     **/
+    bool createReadNodeFromPattern(const std::string& pattern);
+
     void setReadNodeErrorChoice();
 
     void setFirstAndLastFrame();
@@ -157,11 +268,7 @@ PrecompNode::PrecompNode(const NodePtr& n)
 
 PrecompNode::~PrecompNode()
 {
-    AppInstancePtr app = _imp->app.lock();
-
-    if (app) {
-        app->quit();
-    }
+    _imp->releasePrecompApp();
 }
 
 NodePtr
@@ -201,10 +308,9 @@ PrecompNode::setupInitialSubGraphState()
 void
 PrecompNode::initializeKnobs()
 {
-    {
-        CLArgs args;
-        _imp->app = appPTR->newBackgroundInstance(args, true);
-    }
+    // The sub-project app instance is not created yet: it is acquired (and shared with
+    // the other Precomp nodes referencing the same project file) when a project
+    // filename is set, see PrecompNodePrivate::loadSubProject()
 
     KnobPagePtr mainPage = createKnob<KnobPage>("controlsPage");
     mainPage->setLabel(tr("Controls"));
@@ -319,6 +425,17 @@ PrecompNode::initializeKnobs()
         mainPage->addKnob(param);
         _imp->outputNodeNameKnob = param;
     }
+    {
+        KnobStringPtr param = createKnob<KnobString>("readFilePattern");
+        param->setLabel(tr("Read File Pattern"));
+        param->setHintToolTip( tr("The images file pattern rendered by the selected Write node, resolved the last time the "
+                                  "read-back node was set-up. It is saved in the project so that a new session with pre-render "
+                                  "enabled reads the baked frames back directly without loading the pre-comp project.").toStdString() );
+        param->setAnimationEnabled(false);
+        param->setSecret(true);
+        mainPage->addKnob(param);
+        _imp->readFilePatternKnob = param;
+    }
     {
         KnobStringPtr sublabel = createKnob<KnobString>(kNatronOfxParamStringSublabelName);
         sublabel->setSecret(true);
@@ -330,7 +447,25 @@ PrecompNode::initializeKnobs()
 void
 PrecompNode::onKnobsLoaded()
 {
-    _imp->reloadProject(false);
+    // Warm start: if the frames were already baked by a previous session and this node
+    // just reads them back, create the read-back node from the persisted file pattern
+    // without spawning the sub-project app at all. The sub-project is loaded lazily
+    // the first time something actually needs it (e.g the Render button or disabling
+    // the pre-render), see PrecompNodePrivate::ensureProjectLoaded().
+    bool warmStarted = false;
+
+    if ( _imp->enablePreRenderKnob.lock()->getValue() ) {
+        std::string pattern = _imp->readFilePatternKnob.lock()->getValue();
+        if ( !pattern.empty() ) {
+            warmStarted = _imp->createReadNodeFromPattern(pattern);
+        }
+    }
+    if (warmStarted) {
+        QFileInfo file( QString::fromUtf8( _imp->projectFileNameKnob.lock()->getValue().c_str() ) );
+        _imp->subLabelKnob.lock()->setValue( file.fileName().toStdString() );
+    } else {
+        _imp->reloadProject(false);
+    }
     _imp->refreshKnobsVisibility();
 }
 
@@ -396,39 +531,154 @@ PrecompNodePrivate::refreshKnobsVisibility()
     preRenderGroupKnob.lock()->setSecret(!preRenderEnabled);
 }
 
+bool
+PrecompNodePrivate::acquirePrecompApp(const QString& canonicalFilePath,
+                                      bool* projectAlreadyLoaded)
+{
+    *projectAlreadyLoaded = false;
+
+    std::string key = makeSharedPrecompAppKey(_publicInterface->getApp(), canonicalFilePath);
+    SharedPrecompAppsRegistry& registry = getSharedPrecompAppsRegistry();
+    {
+        QMutexLocker k(&registry.lock);
+        if ( (key == sharedAppKey) && app.lock() ) {
+            // Already holding the instance for this project file
+            *projectAlreadyLoaded = registry.apps[key].projectLoaded;
+
+            return true;
+        }
+    }
+
+    // The project filename changed: drop the reference on the previous instance
+    releasePrecompApp();
+
+    QMutexLocker k(&registry.lock);
+    SharedPrecompApp& entry = registry.apps[key];
+    if (!entry.app) {
+        CLArgs args;
+        entry.app = appPTR->newBackgroundInstance(args, true);
+        if (!entry.app) {
+            registry.apps.erase(key);
+
+            return false;
+        }
+    }
+    ++entry.refCount;
+    app = entry.app;
+    sharedAppKey = key;
+    *projectAlreadyLoaded = entry.projectLoaded;
+
+    return true;
+}
+
 void
-PrecompNodePrivate::reloadProject(bool setWriteNodeChoice)
+PrecompNodePrivate::releasePrecompApp()
+{
+    if ( sharedAppKey.empty() ) {
+        return;
+    }
+
+    AppInstancePtr appToQuit;
+    SharedPrecompAppsRegistry& registry = getSharedPrecompAppsRegistry();
+    {
+        QMutexLocker k(&registry.lock);
+        SharedPrecompAppsMap::iterator found = registry.apps.find(sharedAppKey);
+        if ( found != registry.apps.end() ) {
+            --found->second.refCount;
+            if (found->second.refCount <= 0) {
+                appToQuit = found->second.app;
+                registry.apps.erase(found);
+            }
+        }
+    }
+    sharedAppKey.clear();
+    app.reset();
+
+    if (appToQuit) {
+        appToQuit->quit();
+    }
+}
+
+bool
+PrecompNodePrivate::loadSubProject(bool errorIfMissing)
 {
     std::string filename = projectFileNameKnob.lock()->getValue();
     QFileInfo file( QString::fromUtf8( filename.c_str() ) );
 
     if ( !file.exists() ) {
-        Dialogs::errorDialog( tr("Pre-Comp").toStdString(), tr("Pre-comp file not found.").toStdString() );
+        if (errorIfMissing) {
+            Dialogs::errorDialog( tr("Pre-Comp").toStdString(), tr("Pre-comp file not found.").toStdString() );
+        }
 
-        return;
+        return false;
+    }
+
+    bool projectAlreadyLoaded = false;
+    if ( !acquirePrecompApp(file.canonicalFilePath(), &projectAlreadyLoaded) ) {
+        return false;
     }
+
     QString fileUnPathed = file.fileName();
 
     subLabelKnob.lock()->setValue( fileUnPathed.toStdString());
 
-    QString path = file.path() + QLatin1Char('/');
-
     ProjectPtr project = app.lock()->getProject();
-    project->resetProject();
-    {
-        //Set a temporary timeline that will be used while loading the project.
-        //This is to avoid that the seekFrame call has an effect on this project since they share the same timeline
-        TimeLinePtr tmpTimeline( new TimeLine( project.get() ) );
-        project->setTimeLine(tmpTimeline);
-    }
 
-    bool ok  = project->loadProject( path, fileUnPathed);
-    if (!ok) {
+    if (!projectAlreadyLoaded) {
+        QString path = file.path() + QLatin1Char('/');
+
         project->resetProject();
+        {
+            //Set a temporary timeline that will be used while loading the project.
+            //This is to avoid that the seekFrame call has an effect on this project since they share the same timeline
+            TimeLinePtr tmpTimeline( new TimeLine( project.get() ) );
+            project->setTimeLine(tmpTimeline);
+        }
+
+        bool ok  = project->loadProject( path, fileUnPathed);
+        if (!ok) {
+            project->resetProject();
+        } else {
+            QMutexLocker k(&getSharedPrecompAppsRegistry().lock);
+            getSharedPrecompAppsRegistry().apps[sharedAppKey].projectLoaded = true;
+        }
+
+        //Switch the timeline to this instance's timeline
+        project->setTimeLine( _publicInterface->getApp()->getTimeLine() );
+
+        return ok;
     }
 
-    //Switch the timeline to this instance's timeline
-    project->setTimeLine( _publicInterface->getApp()->getTimeLine() );
+    return true;
+}
+
+bool
+PrecompNodePrivate::ensureProjectLoaded()
+{
+    if ( app.lock() ) {
+        return true;
+    }
+    if ( projectFileNameKnob.lock()->getValue().empty() ) {
+        return false;
+    }
+    if ( !loadSubProject(true) ) {
+        return false;
+    }
+    // Refresh the Write node entries, the choice knob only had its persisted value so far
+    populateWriteNodesChoice(false);
+
+    return true;
+}
+
+void
+PrecompNodePrivate::reloadProject(bool setWriteNodeChoice)
+{
+    bool ok = loadSubProject(true);
+
+    if ( !app.lock() ) {
+        // No sub-project instance: the file does not exist or the instance failed to spawn
+        return;
+    }
 
     populateWriteNodesChoice(setWriteNodeChoice);
 
@@ -472,12 +722,19 @@ PrecompNodePrivate::populateWriteNodesChoice(bool setWriteNodeChoice)
 NodePtr
 PrecompNodePrivate::getWriteNodeFromPreComp() const
 {
+    AppInstancePtr subApp = app.lock();
+
+    if (!subApp) {
+        // The sub-project was not loaded, see ensureProjectLoaded()
+        return NodePtr();
+    }
+
     ChoiceOption userChoiceNodeName =  writeNodesKnob.lock()->getActiveEntry();
 
     if (userChoiceNodeName.id == "None") {
         return NodePtr();
     }
-    NodePtr writeNode = app.lock()->getProject()->getNodeByFullySpecifiedName(userChoiceNodeName.id);
+    NodePtr writeNode = subApp->getProject()->getNodeByFullySpecifiedName(userChoiceNodeName.id);
     if (!writeNode) {
         std::stringstream ss;
         ss << tr("Could not find a node named %1 in the pre-comp project")
@@ -510,8 +767,14 @@ PrecompNodePrivate::createReadNode()
         readNode.reset();
     }
 
+    ensureProjectLoaded();
+
     NodePtr writeNode = getWriteNodeFromPreComp();
     if (!writeNode) {
+        // Invalidate the persisted pattern so the next session does not warm start from
+        // frames that no longer correspond to a Write node
+        readFilePatternKnob.lock()->setValue(std::string());
+
         return;
     }
 
@@ -526,6 +789,17 @@ PrecompNodePrivate::createReadNode()
     }
 
     std::string pattern = fileKnob->getValue();
+
+    // Persist the resolved pattern for the warm start of the next session, see
+    // PrecompNode::onKnobsLoaded()
+    readFilePatternKnob.lock()->setValue(pattern);
+
+    createReadNodeFromPattern(pattern);
+} // PrecompNodePrivate::createReadNode
+
+bool
+PrecompNodePrivate::createReadNodeFromPattern(const std::string& pattern)
+{
     QString qpattern = QString::fromUtf8( pattern.c_str() );
     std::string ext = QtCompat::removeFileExtension(qpattern).toLower().toStdString();
     std::string found = appPTR->getReaderPluginIDForFileType(ext);
@@ -535,7 +809,7 @@ PrecompNodePrivate::createReadNode()
             .arg( QString::fromUtf8( ext.c_str() ) ).toStdString();
         Dialogs::errorDialog( tr("Pre-Comp").toStdString(), ss.str() );
 
-        return;
+        return false;
     }
 
     QString readPluginID = QString::fromUtf8( found.c_str() );
@@ -544,16 +818,27 @@ PrecompNodePrivate::createReadNode()
     fixedNamePrefix.append( QString::fromUtf8("readNode") );
     fixedNamePrefix.append( QLatin1Char('_') );
 
-    CreateNodeArgsPtr args(CreateNodeArgs::create( readPluginID.toStdString(), app.lock()->getProject() ));
+    // Create the reader in the sub-project when one is loaded (as before), otherwise
+    // (warm start without sub-app) in this group
+    AppInstancePtr subApp = app.lock();
+    AppInstancePtr hostApp = subApp ? subApp : _publicInterface->getApp();
+    NodeCollectionPtr collection;
+    if (subApp) {
+        collection = subApp->getProject();
+    } else {
+        collection = toNodeGroup( _publicInterface->EffectInstance::shared_from_this() );
+    }
+
+    CreateNodeArgsPtr args(CreateNodeArgs::create( readPluginID.toStdString(), collection ));
     args->setProperty<bool>(kCreateNodeArgsPropVolatile, true);
     args->setProperty<bool>(kCreateNodeArgsPropNoNodeGUI, true);
     args->setProperty<std::string>(kCreateNodeArgsPropNodeInitialName, fixedNamePrefix.toStdString());
     args->addParamDefaultValue<std::string>(kOfxImageEffectFileParamName, pattern);
 
 
-    NodePtr read = app.lock()->createNode(args);
+    NodePtr read = hostApp->createNode(args);
     if (!read) {
-        return;
+        return false;
     }
 
     groupOutputNode->swapInput(read, 0);
@@ -564,7 +849,9 @@ PrecompNodePrivate::createReadNode()
         QMutexLocker k(&dataMutex);
         readNode = read;
     }
-} // PrecompNodePrivate::createReadNode
+
+    return true;
+} // PrecompNodePrivate::createReadNodeFromPattern
 
 void
 PrecompNodePrivate::refreshOutputNode()
@@ -573,10 +860,16 @@ PrecompNodePrivate::refreshOutputNode()
     NodePtr outputnode;
 
     if (!usePreRender) {
-        KnobStringPtr outputNodeKnob = outputNodeNameKnob.lock();
-        std::string outputNodeName = outputNodeKnob->getValue();
+        // Rendering the full sub-project tree: it must be loaded
+        ensureProjectLoaded();
 
-        outputnode = app.lock()->getProject()->getNodeByFullySpecifiedName(outputNodeName);
+        AppInstancePtr subApp = app.lock();
+        if (subApp) {
+            KnobStringPtr outputNodeKnob = outputNodeNameKnob.lock();
+            std::string outputNodeName = outputNodeKnob->getValue();
+
+            outputnode = subApp->getProject()->getNodeByFullySpecifiedName(outputNodeName);
+        }
 
         groupOutputNode->swapInput(outputnode, 0);
     } else {
@@ -608,6 +901,8 @@ PrecompNodePrivate::refreshOutputNode()
 void
 PrecompNodePrivate::setFirstAndLastFrame()
 {
+    ensureProjectLoaded();
+
     NodePtr writeNode = getWriteNodeFromPreComp();
 
     if (!writeNode) {
@@ -644,6 +939,8 @@ PrecompNodePrivate::refreshReadNodeInput()
 void
 PrecompNodePrivate::launchPreRender()
 {
+    ensureProjectLoaded();
+
     NodePtr output = getWriteNodeFromPreComp();
 
     if (!output) {
@@ -0,0 +1,291 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2013-2017 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "ProcessFrameRing.h"
+
+#include <cstring> // memcpy
+#include <sstream> // stringstream
+#include <stdexcept>
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QCoreApplication>
+
+GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_OFF
+GCC_DIAG_OFF(unused-parameter)
+#include <boost/interprocess/detail/atomic.hpp>
+GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
+GCC_DIAG_ON(unused-parameter)
+
+#include "Engine/IPCCommon.h"
+#include "Engine/Node.h"
+
+NATRON_NAMESPACE_ENTER;
+
+namespace bip = boost::interprocess;
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+// Number of segments created by this process so far, to make segment names unique
+static QAtomicInt nFrameRingsCreated;
+
+// Name of the layout object inside the memory segment
+#define kProcessFrameRingLayoutObjectName "FrameRingLayout"
+
+struct FrameRingSlot
+{
+    // Seqlock guarding the slot: odd while the writer is filling it, even once
+    // committed. A reader retries (or gives up) when the value is odd or changed
+    // across its copy, so a writer never waits for a reader and vice versa.
+    boost::uint32_t seq;
+
+    // The frame this preview corresponds to
+    boost::uint32_t frame;
+
+    // BGRA preview, as produced by Node::makePreviewFromImage()
+    unsigned int pixels[NATRON_PROCESS_FRAME_RING_PREVIEW_WIDTH * NATRON_PROCESS_FRAME_RING_PREVIEW_HEIGHT];
+};
+
+struct FrameRingLayout
+{
+    // Number of calls to notifyFrameStarted(). lastFrameStarted is meaningless until
+    // this is non 0.
+    boost::uint32_t startCount;
+
+    // The frame the writer last started rendering: if the process crashed, this is the
+    // frame that was in flight.
+    boost::uint32_t lastFrameStarted;
+
+    // Number of committed previews. The most recent one is in
+    // slots[(commitCount - 1) % NATRON_PROCESS_FRAME_RING_NB_SLOTS].
+    boost::uint32_t commitCount;
+
+    // The frame of the last committed preview
+    boost::uint32_t lastFrameCommitted;
+
+    FrameRingSlot slots[NATRON_PROCESS_FRAME_RING_NB_SLOTS];
+};
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+
+struct ProcessFrameRingPrivate
+{
+    // Name of the shared memory segment, passed to the renderer on its command line
+    std::string segmentName;
+
+    // True on the GUI side: the segment is removed when this object is destroyed
+    bool ownsSegment;
+
+    boost::scoped_ptr<SharedMemorySegmentType> segment;
+
+    // The ring, living in the shared memory segment
+    FrameRingLayout* layout;
+
+    ProcessFrameRingPrivate()
+    : segmentName()
+    , ownsSegment(false)
+    , segment()
+    , layout(0)
+    {
+    }
+};
+
+ProcessFrameRing::ProcessFrameRing()
+: _imp(new ProcessFrameRingPrivate())
+{
+    std::stringstream ss;
+    ss << NATRON_APPLICATION_NAME << "_frameRing_" << (qint64)QCoreApplication::applicationPid() << "_" << nFrameRingsCreated.fetchAndAddAcquire(1);
+    _imp->segmentName = ss.str();
+    _imp->ownsSegment = true;
+
+    try {
+        // Remove any stale segment left over by a crashed process with the same pid
+        bip::shared_memory_object::remove( _imp->segmentName.c_str() );
+
+        // Add a page worth of room for the segment manager internals
+        std::size_t segmentSize = sizeof(FrameRingLayout) + 4096;
+        _imp->segment.reset( new SharedMemorySegmentType(bip::create_only, _imp->segmentName.c_str(), segmentSize) );
+
+        // POD: value-initialization zeroes all counters and sequence numbers
+        _imp->layout = _imp->segment->construct<FrameRingLayout>(kProcessFrameRingLayoutObjectName)();
+    } catch (...) {
+        _imp->segment.reset();
+        _imp->layout = 0;
+        bip::shared_memory_object::remove( _imp->segmentName.c_str() );
+    }
+}
+
+ProcessFrameRing::ProcessFrameRing(const std::string& segmentName)
+: _imp(new ProcessFrameRingPrivate())
+{
+    _imp->segmentName = segmentName;
+    _imp->ownsSegment = false;
+
+    try {
+        _imp->segment.reset( new SharedMemorySegmentType(bip::open_only, segmentName.c_str()) );
+        std::pair<FrameRingLayout*, SharedMemorySegmentType::size_type> found = _imp->segment->find<FrameRingLayout>(kProcessFrameRingLayoutObjectName);
+        _imp->layout = found.first;
+        if (!_imp->layout) {
+            _imp->segment.reset();
+        }
+    } catch (...) {
+        _imp->segment.reset();
+        _imp->layout = 0;
+    }
+}
+
+ProcessFrameRing::~ProcessFrameRing()
+{
+    _imp->layout = 0;
+    _imp->segment.reset();
+    if (_imp->ownsSegment) {
+        bip::shared_memory_object::remove( _imp->segmentName.c_str() );
+    }
+}
+
+bool
+ProcessFrameRing::isValid() const
+{
+    return _imp->layout != 0;
+}
+
+const std::string&
+ProcessFrameRing::getSegmentName() const
+{
+    return _imp->segmentName;
+}
+
+void
+ProcessFrameRing::notifyFrameStarted(int frame)
+{
+    if (!_imp->layout) {
+        return;
+    }
+    bip::ipcdetail::atomic_write32( &_imp->layout->lastFrameStarted, (boost::uint32_t)frame );
+    bip::ipcdetail::atomic_inc32( &_imp->layout->startCount );
+}
+
+void
+ProcessFrameRing::publishFramePreview(int frame,
+                                      const ImagePtr& image,
+                                      bool convertToSrgb)
+{
+    if (!_imp->layout) {
+        return;
+    }
+
+    boost::uint32_t commitCount = bip::ipcdetail::atomic_read32(&_imp->layout->commitCount);
+    FrameRingSlot& slot = _imp->layout->slots[commitCount % NATRON_PROCESS_FRAME_RING_NB_SLOTS];
+
+    // Mark the slot as being written (odd sequence number)
+    boost::uint32_t seq = bip::ipcdetail::atomic_read32(&slot.seq);
+    bip::ipcdetail::atomic_write32(&slot.seq, seq + 1);
+
+    slot.frame = (boost::uint32_t)frame;
+
+    // Convert the image directly into the mapped slot, no intermediate copy
+    bool ok = Node::makePreviewFromImage(image, convertToSrgb, NATRON_PROCESS_FRAME_RING_PREVIEW_WIDTH, NATRON_PROCESS_FRAME_RING_PREVIEW_HEIGHT, slot.pixels);
+
+    // Mark the slot as committed (even sequence number)
+    bip::ipcdetail::atomic_write32(&slot.seq, seq + 2);
+
+    if (!ok) {
+        // The slot was not filled, do not advance the ring
+        return;
+    }
+
+    bip::ipcdetail::atomic_write32( &_imp->layout->lastFrameCommitted, (boost::uint32_t)frame );
+    bip::ipcdetail::atomic_inc32(&_imp->layout->commitCount);
+}
+
+bool
+ProcessFrameRing::getLatestFramePreview(std::vector<unsigned int>* pixels,
+                                        int* width,
+                                        int* height,
+                                        int* frame) const
+{
+    if (!_imp->layout) {
+        return false;
+    }
+
+    *width = NATRON_PROCESS_FRAME_RING_PREVIEW_WIDTH;
+    *height = NATRON_PROCESS_FRAME_RING_PREVIEW_HEIGHT;
+
+    // The writer may commit new slots while we copy: retry a few times, giving up
+    // rather than spinning since another preview notification will follow.
+    for (int retry = 0; retry < NATRON_PROCESS_FRAME_RING_NB_SLOTS; ++retry) {
+        boost::uint32_t commitCount = bip::ipcdetail::atomic_read32(&_imp->layout->commitCount);
+        if (commitCount == 0) {
+            return false;
+        }
+
+        const FrameRingSlot& slot = _imp->layout->slots[(commitCount - 1) % NATRON_PROCESS_FRAME_RING_NB_SLOTS];
+
+        boost::uint32_t seqBefore = bip::ipcdetail::atomic_read32( const_cast<boost::uint32_t*>(&slot.seq) );
+        if (seqBefore & 1) {
+            // The writer is in the slot
+            continue;
+        }
+
+        pixels->resize(NATRON_PROCESS_FRAME_RING_PREVIEW_WIDTH * NATRON_PROCESS_FRAME_RING_PREVIEW_HEIGHT);
+        std::memcpy( &(*pixels)[0], slot.pixels, pixels->size() * sizeof(unsigned int) );
+        *frame = (int)slot.frame;
+
+        boost::uint32_t seqAfter = bip::ipcdetail::atomic_read32( const_cast<boost::uint32_t*>(&slot.seq) );
+        if (seqAfter == seqBefore) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+unsigned int
+ProcessFrameRing::getCommitCount() const
+{
+    if (!_imp->layout) {
+        return 0;
+    }
+
+    return bip::ipcdetail::atomic_read32(&_imp->layout->commitCount);
+}
+
+void
+ProcessFrameRing::getLastFrames(int* lastFrameStarted,
+                                int* lastFrameCommitted) const
+{
+    *lastFrameStarted = -1;
+    *lastFrameCommitted = -1;
+    if (!_imp->layout) {
+        return;
+    }
+    if ( bip::ipcdetail::atomic_read32(&_imp->layout->startCount) > 0 ) {
+        *lastFrameStarted = (int)bip::ipcdetail::atomic_read32(&_imp->layout->lastFrameStarted);
+    }
+    if ( bip::ipcdetail::atomic_read32(&_imp->layout->commitCount) > 0 ) {
+        *lastFrameCommitted = (int)bip::ipcdetail::atomic_read32(&_imp->layout->lastFrameCommitted);
+    }
+}
+
+NATRON_NAMESPACE_EXIT;
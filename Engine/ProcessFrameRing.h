@@ -0,0 +1,136 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2013-2017 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef NATRON_ENGINE_PROCESSFRAMERING_H
+#define NATRON_ENGINE_PROCESSFRAMERING_H
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <string>
+#include <vector>
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/scoped_ptr.hpp>
+#endif
+
+#include "Global/GlobalDefines.h"
+
+#include "Engine/EngineFwd.h"
+
+NATRON_NAMESPACE_ENTER;
+
+// Dimensions of the preview written to the ring for each rendered frame. The frame is
+// fitted in this box keeping its aspect ratio, see Node::makePreviewFromImage()
+#define NATRON_PROCESS_FRAME_RING_PREVIEW_WIDTH 512
+#define NATRON_PROCESS_FRAME_RING_PREVIEW_HEIGHT 512
+
+// Number of preview slots in the ring
+#define NATRON_PROCESS_FRAME_RING_NB_SLOTS 4
+
+struct ProcessFrameRingPrivate;
+
+/**
+ * @brief A small shared-memory ring buffer transporting previews of the frames rendered
+ * by a background render process to the GUI process, so the GUI can display them live
+ * without re-reading the rendered files from disk.
+ *
+ * The GUI side (ProcessHandler) creates the segment with a process-unique name and
+ * passes the name to the background renderer on its command line; the renderer opens it
+ * and publishes a preview of each frame it renders, see
+ * DefaultScheduler::renderFrameInternal().
+ *
+ * Slots are written with a per-slot sequence counter (seqlock) and plain atomic stores
+ * instead of an interprocess mutex: a crash of the renderer can therefore never leave
+ * the GUI blocked on an abandoned lock, and the header keeps the last started/committed
+ * frame numbers so crashed-render diagnostics can report the frame that was in flight.
+ **/
+class ProcessFrameRing
+{
+public:
+
+    /**
+     * @brief GUI side: creates the shared memory segment with a process-unique name,
+     * retrieved with getSegmentName(). isValid() returns false if the segment could not
+     * be created.
+     **/
+    ProcessFrameRing();
+
+    /**
+     * @brief Renderer side: opens the segment created by the GUI process. isValid()
+     * returns false if the segment does not exist.
+     **/
+    ProcessFrameRing(const std::string& segmentName);
+
+    ~ProcessFrameRing();
+
+    bool isValid() const;
+
+    const std::string& getSegmentName() const;
+
+    ////////// Renderer (writer) side
+
+    /**
+     * @brief Records the frame now being rendered, for crashed-render diagnostics.
+     **/
+    void notifyFrameStarted(int frame);
+
+    /**
+     * @brief Converts the given image to a preview (see Node::makePreviewFromImage) and
+     * commits it to the next slot of the ring. The conversion writes directly into the
+     * shared memory, no intermediate copy is made.
+     **/
+    void publishFramePreview(int frame, const ImagePtr& image, bool convertToSrgb);
+
+    ////////// GUI (reader) side
+
+    /**
+     * @brief Copies out the most recently committed preview. Returns false if no frame
+     * was committed yet or if the writer kept overwriting the slot while reading (the
+     * read is then retried on the next frame notification). pixels is a
+     * NATRON_PROCESS_FRAME_RING_PREVIEW_WIDTH x NATRON_PROCESS_FRAME_RING_PREVIEW_HEIGHT
+     * BGRA buffer as produced by Node::makePreviewImage().
+     **/
+    bool getLatestFramePreview(std::vector<unsigned int>* pixels, int* width, int* height, int* frame) const;
+
+    /**
+     * @brief Returns the number of previews committed so far, used to order the rings
+     * of multiple render workers.
+     **/
+    unsigned int getCommitCount() const;
+
+    /**
+     * @brief Returns the frame the renderer last started and the frame it last
+     * committed: if the process crashed, lastFrameStarted is the frame that was in
+     * flight. Both are -1 when nothing was rendered.
+     **/
+    void getLastFrames(int* lastFrameStarted, int* lastFrameCommitted) const;
+
+private:
+
+    boost::scoped_ptr<ProcessFrameRingPrivate> _imp;
+};
+
+NATRON_NAMESPACE_EXIT;
+
+#endif // NATRON_ENGINE_PROCESSFRAMERING_H
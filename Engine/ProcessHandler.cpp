@@ -24,7 +24,9 @@
 
 #include "ProcessHandler.h"
 
+#include <algorithm> // min, max
 #include <cassert>
+#include <climits> // INT_MIN, INT_MAX
 #include <stdexcept>
 
 #include <QtCore/QProcess>
@@ -41,94 +43,150 @@
 #include "Engine/AppManager.h"
 #include "Engine/Node.h"
 #include "Engine/EffectInstance.h"
+#include "Engine/ProcessFrameRing.h"
 
 NATRON_NAMESPACE_ENTER;
 
 ProcessHandler::ProcessHandler(const QString & projectPath,
-                               const NodePtr& writer)
-    : _process(new QProcess)
+                               const NodePtr& writer,
+                               TimeValue firstFrame,
+                               TimeValue lastFrame,
+                               TimeValue frameStep,
+                               int nProcesses)
+    : _workers()
     , _writer(writer)
-    , _ipcServer(0)
-    , _bgProcessOutputSocket(0)
-    , _bgProcessInputSocket(0)
-    , _earlyCancel(false)
     , _processLog()
-    , _processArgs()
+    , _totalFrames(0)
+    , _lastReportingWorker(-1)
 {
-    ///setup the server used to listen the output of the background process
-    _ipcServer = new QLocalServer();
-    QObject::connect( _ipcServer, SIGNAL(newConnection()), this, SLOT(onNewConnectionPending()) );
-    QString tmpFileName;
+    // The command line cannot express a backward frame range, so only partition forward renders
+    // with a resolved frame range. A single worker launched without a range argument renders the
+    // frame range of the writer knobs, which is the historical behavior.
+    const bool canPartition = frameStep > 0 && firstFrame <= lastFrame && firstFrame != INT_MIN && lastFrame != INT_MAX;
+    int nFrames = 0;
+    if (canPartition) {
+        nFrames = (int)( (lastFrame - firstFrame) / frameStep ) + 1;
+        _totalFrames = nFrames;
+    }
+    const int nWorkers = canPartition ? std::max( 1, std::min(nProcesses, nFrames) ) : 1;
+
+    _workers.resize(nWorkers);
+
+    TimeValue sliceFirst = firstFrame;
+    int framesLeft = nFrames;
+
+    for (std::size_t i = 0; i < _workers.size(); ++i) {
+        BackgroundWorker& w = _workers[i];
+
+        w.process = new QProcess;
+
+        ///setup the server used to listen the output of the background process
+        w.ipcServer = new QLocalServer();
+        QObject::connect( w.ipcServer, SIGNAL(newConnection()), this, SLOT(onNewConnectionPending()) );
+        QString tmpFileName;
 #if defined(Q_OS_WIN)
-    tmpFileName += QString::fromUtf8("//./pipe");
-    tmpFileName += QLatin1Char('/');
-    tmpFileName += QString::fromUtf8(NATRON_APPLICATION_NAME);
-    tmpFileName += QString::fromUtf8("_INPUT_SOCKET");
+        tmpFileName += QString::fromUtf8("//./pipe");
+        tmpFileName += QLatin1Char('/');
+        tmpFileName += QString::fromUtf8(NATRON_APPLICATION_NAME);
+        tmpFileName += QString::fromUtf8("_INPUT_SOCKET");
 #endif
 
-    {
+        {
 #if defined(Q_OS_UNIX)
-        QTemporaryFile tmpf(tmpFileName);
-        tmpf.open();
-        tmpFileName = tmpf.fileName();
-        tmpf.remove();
+            QTemporaryFile tmpf(tmpFileName);
+            tmpf.open();
+            tmpFileName = tmpf.fileName();
+            tmpf.remove();
 #else
-        QTemporaryFile tmpf;
-        tmpf.open();
-        QString tmpFilePath = tmpf.fileName();
-        QString baseName;
-        int lastSlash = tmpFilePath.lastIndexOf( QLatin1Char('/') );
-        if ( (lastSlash != -1) && (lastSlash < tmpFilePath.size() - 1) ) {
-            baseName = tmpFilePath.mid(lastSlash + 1);
-        } else {
-            baseName = tmpFilePath;
-        }
-        tmpFileName += baseName;
-        tmpf.remove();
+            QTemporaryFile tmpf;
+            tmpf.open();
+            QString tmpFilePath = tmpf.fileName();
+            QString baseName;
+            int lastSlash = tmpFilePath.lastIndexOf( QLatin1Char('/') );
+            if ( (lastSlash != -1) && (lastSlash < tmpFilePath.size() - 1) ) {
+                baseName = tmpFilePath.mid(lastSlash + 1);
+            } else {
+                baseName = tmpFilePath;
+            }
+            tmpFileName += baseName;
+            tmpf.remove();
 #endif
-    }
-    _ipcServer->listen(tmpFileName);
+        }
+        w.ipcServer->listen(tmpFileName);
+
+
+        w.processArgs << QString::fromUtf8("-b") << QString::fromUtf8("-w") << QString::fromUtf8( writer->getScriptName_mt_safe().c_str() );
+        if (canPartition) {
+            // Assign a contiguous slice of the range: spread the remaining frames evenly over the remaining workers
+            const int nRemainingWorkers = (int)_workers.size() - (int)i;
+            const int sliceFrames = (framesLeft + nRemainingWorkers - 1) / nRemainingWorkers;
+            w.firstFrame = sliceFirst;
+            w.lastFrame = TimeValue( sliceFirst + (sliceFrames - 1) * frameStep );
+            framesLeft -= sliceFrames;
+            sliceFirst = TimeValue(w.lastFrame + frameStep);
+
+            if (w.firstFrame == w.lastFrame) {
+                w.processArgs << QString::number( (int)w.firstFrame );
+            } else {
+                w.processArgs << QString::fromUtf8("%1-%2:%3").arg( (int)w.firstFrame ).arg( (int)w.lastFrame ).arg( (int)frameStep );
+            }
+        }
+        w.processArgs << QString::fromUtf8("--IPCpipe") <<  tmpFileName;
 
+        // Create the shared memory ring where the process will publish previews of the
+        // frames it renders. If shared memory is not available, render without previews.
+        w.frameRing = new ProcessFrameRing();
+        if ( w.frameRing->isValid() ) {
+            w.processArgs << QString::fromUtf8("--IPCframering") << QString::fromUtf8( w.frameRing->getSegmentName().c_str() );
+        } else {
+            delete w.frameRing;
+            w.frameRing = 0;
+        }
 
-    _processArgs << QString::fromUtf8("-b") << QString::fromUtf8("-w") << QString::fromUtf8( writer->getScriptName_mt_safe().c_str() );
-    _processArgs << QString::fromUtf8("--IPCpipe") <<  tmpFileName;
-    _processArgs << projectPath;
+        w.processArgs << projectPath;
 
-    ///connect the useful slots of the process
-    QObject::connect( _process, SIGNAL(readyReadStandardOutput()), this, SLOT(onStandardOutputBytesWritten()) );
-    QObject::connect( _process, SIGNAL(readyReadStandardError()), this, SLOT(onStandardErrorBytesWritten()) );
-    QObject::connect( _process, SIGNAL(error(QProcess::ProcessError)), this, SLOT(onProcessError(QProcess::ProcessError)) );
-    QObject::connect( _process, SIGNAL(finished(int,QProcess::ExitStatus)), this, SLOT(onProcessEnd(int,QProcess::ExitStatus)) );
+        ///connect the useful slots of the process
+        QObject::connect( w.process, SIGNAL(readyReadStandardOutput()), this, SLOT(onStandardOutputBytesWritten()) );
+        QObject::connect( w.process, SIGNAL(readyReadStandardError()), this, SLOT(onStandardErrorBytesWritten()) );
+        QObject::connect( w.process, SIGNAL(error(QProcess::ProcessError)), this, SLOT(onProcessError(QProcess::ProcessError)) );
+        QObject::connect( w.process, SIGNAL(finished(int,QProcess::ExitStatus)), this, SLOT(onProcessEnd(int,QProcess::ExitStatus)) );
 
 
-    ///start the process
-    _processLog.push_back( tr("Starting background rendering: %1 %2")
-                           .arg( QCoreApplication::applicationFilePath() )
-                           .arg( _processArgs.join( QString::fromUtf8(" ") ) ) );
+        ///start the process
+        _processLog.push_back( tr("Starting background rendering: %1 %2")
+                               .arg( QCoreApplication::applicationFilePath() )
+                               .arg( w.processArgs.join( QString::fromUtf8(" ") ) ) );
+    }
 }
 
 ProcessHandler::~ProcessHandler()
 {
     Q_EMIT deleted();
 
-    if (_ipcServer) {
-        _ipcServer->close();
-        delete _ipcServer;
-    }
-    if (_bgProcessInputSocket) {
-        _bgProcessInputSocket->close();
-        delete _bgProcessInputSocket;
-    }
-    if (_process) {
-        _process->close();
-        delete _process;
+    for (std::size_t i = 0; i < _workers.size(); ++i) {
+        BackgroundWorker& w = _workers[i];
+        if (w.ipcServer) {
+            w.ipcServer->close();
+            delete w.ipcServer;
+        }
+        if (w.inputSocket) {
+            w.inputSocket->close();
+            delete w.inputSocket;
+        }
+        if (w.process) {
+            w.process->close();
+            delete w.process;
+        }
+        delete w.frameRing;
     }
 }
 
 void
 ProcessHandler::startProcess()
 {
-    _process->start(QCoreApplication::applicationFilePath(), _processArgs);
+    for (std::size_t i = 0; i < _workers.size(); ++i) {
+        _workers[i].process->start(QCoreApplication::applicationFilePath(), _workers[i].processArgs);
+    }
 }
 
 const QString &
@@ -137,17 +195,50 @@ ProcessHandler::getProcessLog() const
     return _processLog;
 }
 
+bool
+ProcessHandler::getLatestFramePreview(std::vector<unsigned int>* pixels,
+                                      int* width,
+                                      int* height,
+                                      int* frame) const
+{
+    // Try first the ring of the worker that last reported a rendered frame, then fall
+    // back on the other workers.
+    if (_lastReportingWorker != -1) {
+        const BackgroundWorker& w = _workers[_lastReportingWorker];
+        if ( w.frameRing && w.frameRing->getLatestFramePreview(pixels, width, height, frame) ) {
+            return true;
+        }
+    }
+    for (std::size_t i = 0; i < _workers.size(); ++i) {
+        if ( ( (int)i != _lastReportingWorker ) && _workers[i].frameRing && _workers[i].frameRing->getLatestFramePreview(pixels, width, height, frame) ) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 void
 ProcessHandler::onNewConnectionPending()
 {
-    ///accept only 1 connection!
-    if (_bgProcessOutputSocket) {
-        return;
-    }
+    QLocalServer* server = qobject_cast<QLocalServer*>( sender() );
 
-    _bgProcessOutputSocket = _ipcServer->nextPendingConnection();
+    for (std::size_t i = 0; i < _workers.size(); ++i) {
+        BackgroundWorker& w = _workers[i];
+        if (w.ipcServer != server) {
+            continue;
+        }
+        ///accept only 1 connection per worker!
+        if (w.outputSocket) {
+            return;
+        }
+
+        w.outputSocket = w.ipcServer->nextPendingConnection();
+
+        QObject::connect( w.outputSocket, SIGNAL(readyRead()), this, SLOT(onDataWrittenToSocket()) );
 
-    QObject::connect( _bgProcessOutputSocket, SIGNAL(readyRead()), this, SLOT(onDataWrittenToSocket()) );
+        return;
+    }
 }
 
 void
@@ -156,7 +247,21 @@ ProcessHandler::onDataWrittenToSocket()
     ///always running in the main thread
     assert( QThread::currentThread() == qApp->thread() );
 
-    QString str = QString::fromUtf8( _bgProcessOutputSocket->readLine() );
+    QLocalSocket* socket = qobject_cast<QLocalSocket*>( sender() );
+    BackgroundWorker* worker = 0;
+    int workerIndex = -1;
+    for (std::size_t i = 0; i < _workers.size(); ++i) {
+        if (_workers[i].outputSocket == socket) {
+            worker = &_workers[i];
+            workerIndex = (int)i;
+            break;
+        }
+    }
+    if (!worker) {
+        return;
+    }
+
+    QString str = QString::fromUtf8( worker->outputSocket->readLine() );
     while ( str.endsWith( QLatin1Char('\n') ) ) {
         str.chop(1);
     }
@@ -173,26 +278,46 @@ ProcessHandler::onDataWrittenToSocket()
             str = str.mid(0, foundProgress);
         }
         if ( !str.isEmpty() ) {
+            ++worker->nFramesRendered;
+
+            // When the frame range is partitioned, the progress the worker reports only covers its
+            // own slice: report the merged progress across all workers instead.
+            if (_totalFrames > 0) {
+                int nFramesRendered = 0;
+                for (std::size_t i = 0; i < _workers.size(); ++i) {
+                    nFramesRendered += _workers[i].nFramesRendered;
+                }
+                progressPercent = nFramesRendered / (double)_totalFrames;
+            }
+
             //The report does not have extended timer infos
             Q_EMIT frameRendered(str.toInt(), progressPercent);
+
+            // The preview of the frame is in the shared memory ring by the time the
+            // message is received: let the GUI pick it up zero-copy.
+            if ( worker->frameRing && (worker->frameRing->getCommitCount() > 0) ) {
+                _lastReportingWorker = workerIndex;
+                Q_EMIT previewFrameAvailable( str.toInt() );
+            }
         }
     } else if ( str.startsWith( QString::fromUtf8(kRenderingFinishedStringShort) ) ) {
         ///don't do anything
     } else if ( str.startsWith( QString::fromUtf8(kBgProcessServerCreatedShort) ) ) {
         str = str.remove( QString::fromUtf8(kBgProcessServerCreatedShort) );
         ///the bg process wants us to create the pipe for its input
-        if (!_bgProcessInputSocket) {
-            _bgProcessInputSocket = new QLocalSocket();
-            QObject::connect( _bgProcessInputSocket, SIGNAL(connected()), this, SLOT(onInputPipeConnectionMade()) );
-            _bgProcessInputSocket->connectToServer(str, QLocalSocket::ReadWrite);
+        if (!worker->inputSocket) {
+            worker->inputSocket = new QLocalSocket();
+            QObject::connect( worker->inputSocket, SIGNAL(connected()), this, SLOT(onInputPipeConnectionMade()) );
+            worker->inputSocket->connectToServer(str, QLocalSocket::ReadWrite);
         }
     } else if ( str.startsWith( QString::fromUtf8(kRenderingStartedShort) ) ) {
         ///if the user pressed cancel prior to the pipe being created, wait for it to be created and send the abort
         ///message right away
-        if (_earlyCancel) {
-            _bgProcessInputSocket->waitForConnected(5000);
-            _earlyCancel = false;
-            onProcessCanceled();
+        if (worker->earlyCancel) {
+            worker->inputSocket->waitForConnected(5000);
+            worker->earlyCancel = false;
+            worker->inputSocket->write( ( QString::fromUtf8(kAbortRenderingStringShort) + QLatin1Char('\n') ).toUtf8() );
+            worker->inputSocket->flush();
         }
     } else {
         _processLog.append( QString::fromUtf8("Error: Unable to interpret message.\n") );
@@ -212,7 +337,11 @@ ProcessHandler::onInputPipeConnectionMade()
 void
 ProcessHandler::onStandardOutputBytesWritten()
 {
-    QString str = QString::fromUtf8( _process->readAllStandardOutput().data() );
+    QProcess* process = qobject_cast<QProcess*>( sender() );
+    if (!process) {
+        return;
+    }
+    QString str = QString::fromUtf8( process->readAllStandardOutput().data() );
 
 #ifdef DEBUG
     qDebug() << "Message(stdout):" << str;
@@ -223,7 +352,11 @@ ProcessHandler::onStandardOutputBytesWritten()
 void
 ProcessHandler::onStandardErrorBytesWritten()
 {
-    QString str = QString::fromUtf8( _process->readAllStandardError().data() );
+    QProcess* process = qobject_cast<QProcess*>( sender() );
+    if (!process) {
+        return;
+    }
+    QString str = QString::fromUtf8( process->readAllStandardError().data() );
 
 #ifdef DEBUG
     qDebug() << "Message(stderr):" << str;
@@ -236,11 +369,14 @@ ProcessHandler::onProcessCanceled()
 {
     Q_EMIT processCanceled();
 
-    if (!_bgProcessInputSocket) {
-        _earlyCancel = true;
-    } else {
-        _bgProcessInputSocket->write( ( QString::fromUtf8(kAbortRenderingStringShort) + QLatin1Char('\n') ).toUtf8() );
-        _bgProcessInputSocket->flush();
+    for (std::size_t i = 0; i < _workers.size(); ++i) {
+        BackgroundWorker& w = _workers[i];
+        if (!w.inputSocket) {
+            w.earlyCancel = true;
+        } else {
+            w.inputSocket->write( ( QString::fromUtf8(kAbortRenderingStringShort) + QLatin1Char('\n') ).toUtf8() );
+            w.inputSocket->flush();
+        }
     }
 }
 
@@ -265,7 +401,38 @@ ProcessHandler::onProcessEnd(int exitCode,
     } else if (exitCode == 1) {
         returnCode = 1;
     }
-    Q_EMIT processFinished(returnCode);
+
+    QProcess* process = qobject_cast<QProcess*>( sender() );
+
+    for (std::size_t i = 0; i < _workers.size(); ++i) {
+        if (_workers[i].process == process) {
+            _workers[i].finished = true;
+            _workers[i].returnCode = returnCode;
+
+            // On a crash, report the frame that was in flight: the renderer records in
+            // the shared memory ring each frame it starts before rendering it.
+            if ( (returnCode == 2) && _workers[i].frameRing ) {
+                int lastFrameStarted, lastFrameCommitted;
+                _workers[i].frameRing->getLastFrames(&lastFrameStarted, &lastFrameCommitted);
+                if (lastFrameStarted != -1) {
+                    _processLog.append( tr("The render process crashed while rendering frame %1 (last frame successfully rendered: %2).")
+                                        .arg(lastFrameStarted)
+                                        .arg( lastFrameCommitted != -1 ? QString::number(lastFrameCommitted) : tr("none") ) + QLatin1Char('\n') );
+                }
+            }
+            break;
+        }
+    }
+
+    // Only notify the render as finished once all workers exited, with the worst return code
+    int worstReturnCode = 0;
+    for (std::size_t i = 0; i < _workers.size(); ++i) {
+        if (!_workers[i].finished) {
+            return;
+        }
+        worstReturnCode = std::max(worstReturnCode, _workers[i].returnCode);
+    }
+    Q_EMIT processFinished(worstReturnCode);
 }
 
 ProcessInputChannel::ProcessInputChannel(const QString & mainProcessServerName)
@@ -27,6 +27,8 @@
 
 #include "Global/Macros.h"
 
+#include <vector>
+
 #if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
 #include <boost/shared_ptr.hpp>
 #endif
@@ -43,12 +45,16 @@ CLANG_DIAG_ON(deprecated)
 #include "Global/GlobalDefines.h"
 
 #include "Engine/EngineFwd.h"
+#include "Engine/TimeValue.h"
 
 NATRON_NAMESPACE_ENTER;
 
 /**
- * @brief This class represents a background render process. It starts a render and reports progress via a
- * progress dialog. This class encaspulates an IPC server (a named pipe) where the render process can write to
+ * @brief This class represents a background render. It starts one or several render worker
+ * processes and reports progress via a progress dialog. When several processes are requested, the frame
+ * range is partitioned into contiguous slices, one per worker, and the progress and exit codes of all
+ * workers are merged so that the rest of the application still sees a single background render.
+ * This class encaspulates an IPC server (a named pipe) per worker where the render process can write to
  * in order to communicate withe the main process (the GUI app).
  * @see ProcessInputChannel represents the "input" pipe of the background process, this is where the background
  * app expect messages from the "main" process to come. It listen to messages from the main app to take decisions.
@@ -88,47 +94,94 @@ class ProcessHandler
 {
     Q_OBJECT
 
-    QProcess* _process; //< the process executing the render
+    // One render worker process rendering a slice of the frame range, along with its IPC channels
+    struct BackgroundWorker
+    {
+        QProcess* process; //< the process executing the render
+        QLocalServer* ipcServer; //< the server for IPC with the background process
+        QLocalSocket* outputSocket; //< the socket where data is output by the process
+
+        //the socket where data is read by the process
+        //note that this socket is initialized only when the background process sends the message
+        //kBgProcessServerCreatedShort, meaning it created its server for the input pipe and we can actually open it.
+        QLocalSocket* inputSocket;
+        bool earlyCancel; //< true if the user pressed cancel but the input socket was not created yet
+        QStringList processArgs;
+        TimeValue firstFrame, lastFrame; //< the slice of the frame range assigned to this worker
+        int nFramesRendered; //< the number of rendered frames this worker reported so far
+        bool finished; //< true once the process exited
+        int returnCode; //< the return code of the process, valid once finished is true
+
+        //< shared memory ring where the process publishes previews of the frames it renders,
+        //NULL if the segment could not be created
+        ProcessFrameRing* frameRing;
+
+        BackgroundWorker()
+        : process(0)
+        , ipcServer(0)
+        , outputSocket(0)
+        , inputSocket(0)
+        , earlyCancel(false)
+        , processArgs()
+        , firstFrame(0)
+        , lastFrame(0)
+        , nFramesRendered(0)
+        , finished(false)
+        , returnCode(0)
+        , frameRing(0)
+        {
+        }
+    };
+
+    std::vector<BackgroundWorker> _workers; //< the worker processes, each rendering a slice of the frame range
     NodePtr _writer; //< pointer to the writer that will render in the bg process
-    QLocalServer* _ipcServer; //< the server for IPC with the background process
-    QLocalSocket* _bgProcessOutputSocket; //< the socket where data is output by the process
-
-    //the socket where data is read by the process
-    //note that this socket is initialized only when the background process sends the message
-    //kBgProcessServerCreatedShort, meaning it created its server for the input pipe and we can actually open it.
-    QLocalSocket* _bgProcessInputSocket;
-    bool _earlyCancel; //< true if the user pressed cancel but the _bgProcessInput socket was not created yet
-    QString _processLog; //< used to record the log of the process
-    QStringList _processArgs;
+    QString _processLog; //< used to record the log of the processes
+    int _totalFrames; //< total number of frames to render across all workers, 0 when unknown
+    int _lastReportingWorker; //< index of the worker that last reported a rendered frame, -1 if none yet
 
 public:
 
     /**
-     * @brief Starts a new process which will load the project specified by "projectPath".
-     * The process will render using the effect specified by writer.
+     * @brief Starts up to nProcesses new processes which will load the project specified by "projectPath".
+     * The processes will render using the effect specified by writer, each one a contiguous slice of
+     * the given frame range. A single process rendering the whole range is used when nProcesses is 1
+     * or when the frame range cannot be partitioned (backward renders and unresolved ranges).
      **/
     ProcessHandler(const QString & projectPath,
-                   const NodePtr& writer);
+                   const NodePtr& writer,
+                   TimeValue firstFrame,
+                   TimeValue lastFrame,
+                   TimeValue frameStep,
+                   int nProcesses);
 
     virtual ~ProcessHandler();
 
     const QString & getProcessLog() const;
-    
+
     NodePtr getWriter() const
     {
         return _writer;
     }
 
+    /**
+     * @brief Copies out of shared memory the preview of the frame that a worker process
+     * most recently rendered, so the GUI can display the frames of the background render
+     * live without re-reading them from disk. This is typically called in a slot
+     * connected to the previewFrameAvailable() signal.
+     * Returns false if no frame was published yet.
+     **/
+    bool getLatestFramePreview(std::vector<unsigned int>* pixels, int* width, int* height, int* frame) const;
+
 public Q_SLOTS:
 
     /**
-     * @brief Called whenever the background process requests a new connection to this server,
+     * @brief Called whenever a worker process requests a new connection to its server,
      * i.e: this is when the background process wants to create its output pipe where it will write data to.
      **/
     void onNewConnectionPending();
 
     /**
-     * @brief Slot called whenever the background process writes something to the output socket (pipe).
+     * @brief Slot called whenever a worker process writes something to its output socket (pipe).
      **/
     void onDataWrittenToSocket();
 
@@ -146,7 +199,7 @@ public Q_SLOTS:
 
     /**
      * @brief Called whenever the main GUI app clicked the cancel button of the progress dialog.
-     * It sends a message to the background process via its input pipe to abort the ongoing render.
+     * It sends a message to each worker process via its input pipe to abort the ongoing render.
      **/
     void onProcessCanceled();
 
@@ -156,7 +209,8 @@ public Q_SLOTS:
     void onProcessError(QProcess::ProcessError err);
 
     /**
-     * @brief Called when the process finishes.
+     * @brief Called when a worker process finishes. The processFinished() signal is only emitted
+     * once all workers have finished.
      **/
     void onProcessEnd(int exitCode, QProcess::ExitStatus stat);
 
@@ -166,7 +220,7 @@ public Q_SLOTS:
     void onInputPipeConnectionMade();
 
     /**
-     * @brief Start the process execution
+     * @brief Start the execution of all worker processes
      **/
     void startProcess();
 
@@ -176,10 +230,17 @@ Q_SIGNALS:
 
     void frameRendered(int frame, double progress);
 
+    /**
+     * @brief Emitted when the preview of a newly rendered frame is available in shared
+     * memory, see getLatestFramePreview().
+     **/
+    void previewFrameAvailable(int frame);
+
     void processCanceled();
 
     /**
-     * @brief Emitted when the process terminates. The parameter contains a return code:
+     * @brief Emitted when all worker processes terminated. The parameter contains the worst
+     * return code across the workers:
      * 0: Everything went OK
      * 1: Underminated error
      * 2: Crash.
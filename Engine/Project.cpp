@@ -37,6 +37,7 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_OFF
 #include <boost/math/special_functions/fpclassify.hpp>
 #include <boost/algorithm/string/trim.hpp>
 #include <boost/algorithm/string/predicate.hpp>
+#include <boost/scoped_ptr.hpp>
 GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 #endif
 
@@ -75,6 +76,7 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 #include "Global/FStreamsSupport.h"
 #include "Engine/Hash64.h"
 #include "Engine/KnobFile.h"
+#include "Engine/MemoryFile.h"
 #include "Engine/MemoryInfo.h" // isApplication32Bits
 #include "Engine/Node.h"
 #include "Engine/OutputSchedulerThread.h"
@@ -87,6 +89,7 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 #include "Engine/ViewIdx.h"
 
 #include "Serialization/ProjectSerialization.h"
+#include "Serialization/SerializationBinary.h"
 #include "Serialization/SerializationIO.h"
 
 
@@ -299,10 +302,46 @@ Project::loadProjectInternal(const QString & pathIn,
 
 
     bool ret = false;
-    FStreamsSupport::ifstream ifile;
-    FStreamsSupport::open( &ifile, filePathOut.toStdString() );
-    if (!ifile) {
-        throw std::runtime_error( tr("Failed to open %1").arg(filePathOut).toStdString() );
+
+    // Map the project file in memory so the parsers walk the mapped bytes in-place: a regular
+    // file stream buffers its own copy of the document it reads, which for large projects is
+    // a large part of the peak memory footprint of the load.
+    MemoryFile mappedFile;
+    try {
+        mappedFile.open( filePathOut.toStdString(), MemoryFile::eFileOpenModeOpen );
+    } catch (const std::exception&) {
+        // Fall back on the regular file stream below
+    }
+
+    boost::scoped_ptr<std::istream> ifile;
+    if ( mappedFile.getData() && (mappedFile.size() > 0) ) {
+        mappedFile.advise(MemoryFile::eAdviceTypeSequential);
+        // The mapping holds the raw file bytes, i.e: the equivalent of a stream opened in
+        // binary mode, which both the YAML and the binary decoders accept
+        ifile.reset( new SERIALIZATION_NAMESPACE::RawBufferIStream( mappedFile.getData(), mappedFile.size() ) );
+    } else {
+        // Detect whether the project was saved with the binary encoding: it must then be read from
+        // a stream opened in binary mode (the text mode newline translation on Windows would corrupt it)
+        bool isBinaryProject;
+        {
+            FStreamsSupport::ifstream probe;
+            FStreamsSupport::open( &probe, filePathOut.toStdString(), std::ios_base::in | std::ios_base::binary );
+            if (!probe) {
+                throw std::runtime_error( tr("Failed to open %1").arg(filePathOut).toStdString() );
+            }
+            isBinaryProject = SERIALIZATION_NAMESPACE::isBinarySerializationStream(probe);
+        }
+
+        std::ios_base::openmode mode = std::ios_base::in;
+        if (isBinaryProject) {
+            mode |= std::ios_base::binary;
+        }
+        FStreamsSupport::ifstream* fileStream = new FStreamsSupport::ifstream;
+        ifile.reset(fileStream);
+        FStreamsSupport::open( fileStream, filePathOut.toStdString(), mode );
+        if (!*fileStream) {
+            throw std::runtime_error( tr("Failed to open %1").arg(filePathOut).toStdString() );
+        }
     }
 
 
@@ -310,7 +349,7 @@ Project::loadProjectInternal(const QString & pathIn,
     try {
         // We must keep this boolean for bakcward compatilbility, versinioning cannot help us in that case...
         _imp->lastProjectLoaded.reset(new SERIALIZATION_NAMESPACE::ProjectSerialization);
-        appPTR->loadProjectFromFileFunction(ifile, filePathOut.toStdString(), getApp(), _imp->lastProjectLoaded.get());
+        appPTR->loadProjectFromFileFunction(*ifile, filePathOut.toStdString(), getApp(), _imp->lastProjectLoaded.get());
 
         {
             FlagSetter __raii_loadingProjectInternal__(true, &_imp->isLoadingProjectInternal, &_imp->isLoadingProjectMutex);
@@ -469,6 +508,54 @@ fileCopy(const QString & source,
     return success;
 }
 
+static void
+writeProjectSerialization(const SERIALIZATION_NAMESPACE::ProjectSerializationPtr& serialization,
+                          const QString& tmpFilename,
+                          const QString& filePath,
+                          bool binaryFormat,
+                          bool autoSave)
+{
+    try {
+        {
+            FStreamsSupport::ofstream ofile;
+            std::ios_base::openmode mode = std::ios_base::out;
+            if (binaryFormat) {
+                mode |= std::ios_base::binary;
+            }
+            FStreamsSupport::open( &ofile, tmpFilename.toStdString(), mode );
+            if (!ofile) {
+                throw std::runtime_error( Project::tr("Failed to open file ").toStdString() + tmpFilename.toStdString() );
+            }
+            if (binaryFormat) {
+                SERIALIZATION_NAMESPACE::writeBinary(ofile, *serialization, NATRON_PROJECT_FILE_HEADER);
+            } else {
+                SERIALIZATION_NAMESPACE::write(ofile, *serialization, NATRON_PROJECT_FILE_HEADER);
+            }
+        }
+
+        if ( QFile::exists(filePath) ) {
+            QFile::remove(filePath);
+        }
+        int nAttemps = 0;
+
+        while ( nAttemps < 10 && !fileCopy(tmpFilename, filePath) ) {
+            ++nAttemps;
+        }
+
+        if (nAttemps >= 10) {
+            throw std::runtime_error( "Failed to save to " + filePath.toStdString() );
+        }
+
+        QFile::remove(tmpFilename);
+    } catch (const std::exception & e) {
+        if (!autoSave) {
+            Dialogs::errorDialog( Project::tr("Save").toStdString(), e.what() );
+        } else {
+            qDebug() << "Save failure: " << e.what();
+        }
+    }
+} // writeProjectSerialization
+
 QString
 Project::saveProjectInternal(const QString & path,
                              const QString & name,
@@ -523,12 +610,6 @@ Project::saveProjectInternal(const QString & path,
     tmpFilename.append( QString::number( time.toMSecsSinceEpoch() ) );
 
     {
-        FStreamsSupport::ofstream ofile;
-        FStreamsSupport::open( &ofile, tmpFilename.toStdString() );
-        if (!ofile) {
-            throw std::runtime_error( tr("Failed to open file ").toStdString() + tmpFilename.toStdString() );
-        }
-
         ///Fix file paths before saving.
         QString oldProjectPath = QString::fromUtf8( _imp->getProjectPath().c_str() );
 
@@ -539,35 +620,38 @@ Project::saveProjectInternal(const QString & path,
             _imp->natronVersion->setValue( generateUserFriendlyNatronVersionName());
         }
 
+        SERIALIZATION_NAMESPACE::ProjectSerializationPtr projectSerializationObj( new SERIALIZATION_NAMESPACE::ProjectSerialization );
         try {
-            SERIALIZATION_NAMESPACE::ProjectSerialization projectSerializationObj;
-            toSerialization(&projectSerializationObj);
-            appPTR->aboutToSaveProject(&projectSerializationObj);
-            SERIALIZATION_NAMESPACE::write(ofile, projectSerializationObj, NATRON_PROJECT_FILE_HEADER);
+            // Auto-saves re-use the serialization cached on each node when nothing changed
+            // since the last auto-save, see Project::toSerialization()
+            _imp->isAutoSaveSerialization = autoSave;
+            toSerialization( projectSerializationObj.get() );
+            _imp->isAutoSaveSerialization = false;
+            appPTR->aboutToSaveProject( projectSerializationObj.get() );
         } catch (...) {
+            _imp->isAutoSaveSerialization = false;
             if (!autoSave && updateProjectProperties) {
                 ///Reset the old project path in case of failure.
                 _imp->autoSetProjectDirectory(oldProjectPath);
             }
             throw;
         }
-    } // ofile
-
-    if ( QFile::exists(filePath) ) {
-        QFile::remove(filePath);
-    }
-    int nAttemps = 0;
-
-    while ( nAttemps < 10 && !fileCopy(tmpFilename, filePath) ) {
-        ++nAttemps;
-    }
 
-    if (nAttemps >= 10) {
-        throw std::runtime_error( "Failed to save to " + filePath.toStdString() );
+        // The serialization objects are now a snapshot of the graph (including the workspace
+        // gathered by aboutToSaveProject): YAML emission and file I/O no longer need the live
+        // project and run on a worker thread so that saving a big project does not freeze the
+        // main thread. Auto-saves already run entirely on a worker thread, for them (and for
+        // background saves) the write is done in place.
+        // Wait for any previously scheduled write so saves hit the disk in order.
+        const bool binaryFormat = appPTR->getCurrentSettings()->isSaveProjectsInBinaryFormatEnabled();
+        _imp->projectWriteFuture.waitForFinished();
+        if ( QThread::currentThread() == qApp->thread() ) {
+            _imp->projectWriteFuture = QtConcurrent::run(&writeProjectSerialization, projectSerializationObj, tmpFilename, filePath, binaryFormat, autoSave);
+        } else {
+            writeProjectSerialization(projectSerializationObj, tmpFilename, filePath, binaryFormat, autoSave);
+        }
     }
 
-    QFile::remove(tmpFilename);
-
     if (!autoSave && updateProjectProperties) {
         QString lockFilePath = getLockAbsoluteFilePath();
         if ( QFile::exists(lockFilePath) ) {
@@ -1682,6 +1766,68 @@ Project::isLoadingProjectInternal() const
     return _imp->isLoadingProjectInternal;
 }
 
+void
+Project::beginGraphEditTransaction()
+{
+    assert( QThread::currentThread() == qApp->thread() );
+    ++_imp->graphEditTransactionRecursion;
+}
+
+void
+Project::endGraphEditTransaction()
+{
+    assert( QThread::currentThread() == qApp->thread() );
+    assert(_imp->graphEditTransactionRecursion > 0);
+    if (_imp->graphEditTransactionRecursion > 0) {
+        --_imp->graphEditTransactionRecursion;
+    }
+    if (_imp->graphEditTransactionRecursion > 0) {
+        return;
+    }
+
+    std::set<NodePtr> modifiedNodes;
+    modifiedNodes.swap(_imp->graphEditTransactionNodes);
+    if ( modifiedNodes.empty() ) {
+        return;
+    }
+
+    // Run the work deferred by the topology changes once for the whole batch: the marked sets
+    // ensure each downstream node is visited once, no matter how many of the modified nodes it
+    // is reachable from.
+    std::set<NodePtr> metadataMarkedNodes;
+    std::set<HashableObject*> hashMarkedObjects;
+    for (std::set<NodePtr>::const_iterator it = modifiedNodes.begin(); it != modifiedNodes.end(); ++it) {
+        if ( (*it)->isBeingDestroyed() ) {
+            continue;
+        }
+        EffectInstancePtr effect = (*it)->getEffectInstance();
+        if (!effect) {
+            continue;
+        }
+        effect->invalidateHashCacheRecursive(true /*recurse*/, &hashMarkedObjects);
+        effect->onMetadataChanged_recursive_public(&metadataMarkedNodes);
+        effect->refreshDynamicProperties();
+    }
+
+    getApp()->renderAllViewers();
+}
+
+bool
+Project::isDoingGraphEditTransaction() const
+{
+    assert( QThread::currentThread() == qApp->thread() );
+
+    return _imp->graphEditTransactionRecursion > 0;
+}
+
+void
+Project::addNodeToGraphEditTransaction(const NodePtr& node)
+{
+    assert( QThread::currentThread() == qApp->thread() );
+    assert(_imp->graphEditTransactionRecursion > 0);
+    _imp->graphEditTransactionNodes.insert(node);
+}
+
 bool
 Project::isGraphWorthLess() const
 {
@@ -1915,6 +2061,9 @@ Project::closeProject_blocking(bool aboutToQuit)
 void
 Project::doResetEnd(bool aboutToQuit)
 {
+    // Make sure any pending off-main-thread write of the project file hit the disk
+    _imp->projectWriteFuture.waitForFinished();
+
     _imp->runOnProjectCloseCallback();
 
     QString lockFilePath = getLockAbsoluteFilePath();
@@ -2787,6 +2936,11 @@ Project::toSerialization(SERIALIZATION_NAMESPACE::SerializationObjectBase* seria
                     if (!state) {
                         continue;
                     }
+                } else if (_imp->isAutoSaveSerialization) {
+                    // Differential auto-save: only the nodes whose cached serialization was
+                    // invalidated since the last auto-save are re-serialized, the others
+                    // reuse the cached one. An explicit save always re-serializes everything.
+                    state = (*it)->getOrCreateAutoSaveSerialization();
                 } else {
                     state.reset( new SERIALIZATION_NAMESPACE::NodeSerialization );
                     (*it)->toSerialization(state.get());
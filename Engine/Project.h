@@ -203,6 +203,24 @@ public:
 
     int currentFrame() const WARN_UNUSED_RETURN;
 
+    /**
+     * @brief Brackets a batch of node graph topology changes (pasting nodes, loading a
+     * template...): while the transaction is open, each connection/disconnection defers its
+     * downstream metadata refresh and hash invalidation, and a single deduplicated pass over
+     * the affected sub-graph is run when the outermost endGraphEditTransaction() returns.
+     * Brackets may be nested. Main-thread only.
+     **/
+    void beginGraphEditTransaction();
+    void endGraphEditTransaction();
+
+    bool isDoingGraphEditTransaction() const;
+
+    /**
+     * @brief Called by Node when its inputs changed inside a graph edit transaction, so that
+     * the deferred pass of endGraphEditTransaction() starts from it. Main-thread only.
+     **/
+    void addNodeToGraphEditTransaction(const NodePtr& node);
+
 
     /**
      * @brief Returns true if the project is considered as irrelevant and shouldn't be autosaved anyway.
@@ -92,10 +92,12 @@ ProjectPrivate::ProjectPrivate(Project* project)
     , isLoadingProjectInternal(false)
     , isSavingProjectMutex()
     , isSavingProject(false)
+    , isAutoSaveSerialization(false)
     , autoSaveTimer( new QTimer() )
     , projectClosing(false)
     , tlsData( new TLSHolder<Project::ProjectTLSData>() )
-
+    , graphEditTransactionRecursion(0)
+    , graphEditTransactionNodes()
 {
     autoSaveTimer->setSingleShot(true);
 }
@@ -29,6 +29,7 @@
 
 #include <map>
 #include <list>
+#include <set>
 
 CLANG_DIAG_OFF(deprecated)
 CLANG_DIAG_OFF(uninitialized)
@@ -103,8 +104,10 @@ public:
     bool isLoadingProjectInternal; //< true when loading the internal project (not gui)
     mutable QMutex isSavingProjectMutex;
     bool isSavingProject; //< true when the project is saving
+    bool isAutoSaveSerialization; //< true while serializing for an auto-save: nodes may then reuse their cached serialization, only read/written in the serialization thread
     boost::shared_ptr<QTimer> autoSaveTimer;
     std::list<boost::shared_ptr<QFutureWatcher<void> > > autoSaveFutures;
+    QFuture<void> projectWriteFuture; // pending off-main-thread write of the project file, see Project::saveProjectInternal
     mutable QMutex projectClosingMutex;
     bool projectClosing;
     boost::shared_ptr<TLSHolder<Project::ProjectTLSData> > tlsData;
@@ -119,6 +122,13 @@ public:
 
     std::list<RenderWatcher> renderWatchers;
 
+    // Graph edit transaction state: while graphEditTransactionRecursion > 0, topology changes
+    // defer their downstream metadata refresh and hash invalidation, and the nodes whose inputs
+    // changed are collected here so that a single deduplicated pass can be run when the
+    // outermost Project::endGraphEditTransaction() is called. Only used on the main-thread.
+    int graphEditTransactionRecursion;
+    std::set<NodePtr> graphEditTransactionNodes;
+
     ProjectPrivate(Project* project);
 
         
@@ -41,6 +41,7 @@ GCC_DIAG_ON(unused-parameter)
 
 
 #include "Engine/AppInstance.h"
+#include "Engine/CacheWarmupQueue.h"
 #include "Engine/CreateNodeArgs.h"
 #include "Engine/Project.h"
 #include "Engine/Node.h"
@@ -481,6 +482,62 @@ App::renderInternal(bool forceBlocking,
     }
 }
 
+void
+App::warmCache(Effect* node,
+               int firstFrame,
+               int lastFrame,
+               int frameStep,
+               int mipMapLevel,
+               int priority,
+               const QString& group)
+{
+    if (!node) {
+        std::cerr << tr("Invalid node").toStdString() << std::endl;
+
+        return;
+    }
+    NodePtr internalNode = node->getInternalNode();
+    if (!internalNode) {
+        std::cerr << tr("Invalid node").toStdString() << std::endl;
+
+        return;
+    }
+    if (mipMapLevel < 0) {
+        mipMapLevel = 0;
+    }
+    getInternalApp()->getCacheWarmupQueue()->submitWork(internalNode, TimeValue(firstFrame), TimeValue(lastFrame), TimeValue(frameStep), (unsigned int)mipMapLevel, priority, group.toStdString());
+}
+
+void
+App::cancelCacheWarmup(const QString& group)
+{
+    getInternalApp()->getCacheWarmupQueue()->cancelGroup( group.toStdString() );
+}
+
+std::list<int>
+App::getCachedFrames(Effect* node,
+                     int firstFrame,
+                     int lastFrame) const
+{
+    std::list<int> ret;
+
+    if (!node) {
+        return ret;
+    }
+    NodePtr internalNode = node->getInternalNode();
+    if (!internalNode) {
+        return ret;
+    }
+    CacheWarmupQueuePtr queue = getInternalApp()->getCacheWarmupQueue();
+    for (int i = firstFrame; i <= lastFrame; ++i) {
+        if ( queue->isFrameCached( internalNode, TimeValue(i), ViewIdx(0) ) ) {
+            ret.push_back(i);
+        }
+    }
+
+    return ret;
+}
+
 void
 App::redrawViewer(Effect* viewerNode)
 {
@@ -311,6 +311,29 @@ public:
 
     void render(const std::list<Effect*>& effects, const std::list<int>& firstFrames, const std::list<int>& lastFrames, const std::list<int>& frameSteps);
 
+    /**
+     * @brief Submits a background render of the given node for [firstFrame, lastFrame] at the
+     * given mipmap level to warm the cache: the produced images are dropped, the point is that
+     * a later interactive render of the same frames is a cache hit.
+     * @param priority The thread-pool priority of the task: the default (-1) runs below the
+     * interactive renders.
+     * @param group An arbitrary label that can be passed to cancelCacheWarmup() to cancel the
+     * submission, e.g: when the warmed shot is no longer the next one to review.
+     **/
+    void warmCache(Effect* node, int firstFrame, int lastFrame, int frameStep = 1, int mipMapLevel = 0, int priority = -1, const QString& group = QString());
+
+    /**
+     * @brief Cancels the cache warm-up submissions carrying the given group label and aborts
+     * their in-flight renders. An empty group cancels all submissions.
+     **/
+    void cancelCacheWarmup(const QString& group = QString());
+
+    /**
+     * @brief Returns the frames in [firstFrame, lastFrame] for which the cache holds the image
+     * produced by the given node, i.e: the frames that would be cache hits if rendered.
+     **/
+    std::list<int> getCachedFrames(Effect* node, int firstFrame, int lastFrame) const;
+
     void redrawViewer(Effect* viewerNode);
 
     void refreshViewer(Effect* viewerNode,bool useCache = true);
@@ -28,8 +28,11 @@
 #include "Global/Macros.h"
 
 #include "Engine/AppManager.h"
+#include "Engine/ImageStorage.h" // dumpMemoryAttribution
 #include "Engine/MemoryInfo.h" // isApplication32Bits
+#include "Engine/OutputSchedulerThread.h" // dumpFrameBudgetReport
 #include "Engine/PyAppInstance.h"
+#include "Engine/Timer.h" // ScopedProfiler
 
 
 #include "Engine/EngineFwd.h"
@@ -226,6 +229,69 @@ public:
     {
         appPTR->setOnProjectLoadedCallback( pythonFunctionName.toStdString() );
     }
+
+    /**
+     * @brief Enables or disables a category of the built-in scoped profiler.
+     * The category is one of "cache", "knob", "render" or "gl".
+     **/
+    inline void setProfilerCategoryEnabled(const QString& category, bool enabled)
+    {
+        QString c = category.toLower();
+
+        if ( c == QString::fromUtf8("cache") ) {
+            ScopedProfiler::setCategoryEnabled(eProfilerCategoryCache, enabled);
+        } else if ( c == QString::fromUtf8("knob") ) {
+            ScopedProfiler::setCategoryEnabled(eProfilerCategoryKnob, enabled);
+        } else if ( c == QString::fromUtf8("render") ) {
+            ScopedProfiler::setCategoryEnabled(eProfilerCategoryRender, enabled);
+        } else if ( c == QString::fromUtf8("gl") ) {
+            ScopedProfiler::setCategoryEnabled(eProfilerCategoryGL, enabled);
+        }
+    }
+
+    /**
+     * @brief Returns a formatted table aggregating the samples recorded by the built-in
+     * scoped profiler for the categories enabled with setProfilerCategoryEnabled.
+     **/
+    inline QString dumpProfilerLog() const
+    {
+        return QString::fromUtf8( ScopedProfiler::dump().c_str() );
+    }
+
+    /**
+     * @brief Discards all samples recorded by the built-in scoped profiler.
+     **/
+    inline void resetProfiler()
+    {
+        ScopedProfiler::reset();
+    }
+
+    /**
+     * @brief Returns a formatted table of the image memory currently allocated on behalf of
+     * each node, sorted by decreasing byte count. An entry that keeps growing across renders
+     * indicates a leak.
+     **/
+    inline QString dumpMemoryAttribution() const
+    {
+        return QString::fromUtf8( ImageStorageBase::dumpMemoryAttribution().c_str() );
+    }
+
+    /**
+     * @brief Returns a formatted report of the frames that missed the playback frame budget
+     * (1/fps) this session and the nodes that were the most expensive in those frames.
+     **/
+    inline QString dumpFrameBudgetReport() const
+    {
+        return QString::fromUtf8( OutputSchedulerThread::dumpFrameBudgetReport().c_str() );
+    }
+
+    /**
+     * @brief Discards the frames and nodes recorded by the frame-budget watchdog.
+     **/
+    inline void resetFrameBudgetReport()
+    {
+        OutputSchedulerThread::resetFrameBudgetReport();
+    }
 };
 
 NATRON_PYTHON_NAMESPACE_EXIT;
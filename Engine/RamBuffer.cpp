@@ -0,0 +1,193 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2013-2017 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "RamBuffer.h"
+
+#include <list>
+#include <map>
+#include <utility>
+
+CLANG_DIAG_OFF(deprecated)
+#include <QtCore/QMutex>
+CLANG_DIAG_ON(deprecated)
+
+#include "Engine/Cache.h"
+
+NATRON_NAMESPACE_ENTER;
+
+// Maximum amount of free buffers retained by the pool. Buffers released past this limit are
+// unmapped immediately by the caller.
+#define NATRON_RAM_BUFFER_POOL_MAX_BYTES (512 << 20) // 512MB
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+// A free buffer retained by the pool
+struct PooledBuffer
+{
+    void* ptr;
+
+    // Set by purgeUnusedBuffers() and cleared when the buffer enters the pool: a buffer that
+    // still carries the flag on the next purge pass went unrecycled for a whole pass and is
+    // unmapped.
+    bool unusedSinceLastPurge;
+};
+
+// The equivalent of PluginMemoryPool for the image buffers backed by OS pages, except that it
+// is process-wide and guarded by a mutex: buffers are freed by the StorageDeleterThread and
+// re-acquired by render threads.
+// Note that recycling trades away the NUMA first-touch benefit of fresh pages (see
+// NATRON_RAM_BUFFER_OS_PAGES_THRESHOLD): this is acceptable because a recycled buffer is most
+// often picked up by a thread rendering the very sequence that just released it, and the idle
+// purge bounds how long pages survive in the pool anyway.
+struct RamBufferPoolImpl
+{
+    QMutex lock;
+
+    // Free buffers, keyed by their exact size in bytes
+    std::multimap<std::size_t, PooledBuffer> freeBuffers;
+    std::size_t nbPooledBytes;
+
+    RamBufferPoolImpl()
+    : lock()
+    , freeBuffers()
+    , nbPooledBytes(0)
+    {
+    }
+};
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+static RamBufferPoolImpl&
+getRamBufferPool()
+{
+    static RamBufferPoolImpl pool;
+
+    return pool;
+}
+
+static void
+unmapBuffer(void* ptr,
+            std::size_t nBytes)
+{
+#ifdef __NATRON_UNIX__
+    ::munmap(ptr, nBytes);
+#elif defined(__NATRON_WIN32__)
+    Q_UNUSED(nBytes);
+    ::VirtualFree(ptr, 0, MEM_RELEASE);
+#else
+    Q_UNUSED(ptr);
+    Q_UNUSED(nBytes);
+#endif
+}
+
+void*
+RamBufferPool::acquireBuffer(std::size_t nBytes)
+{
+    RamBufferPoolImpl& pool = getRamBufferPool();
+    QMutexLocker k(&pool.lock);
+    std::multimap<std::size_t, PooledBuffer>::iterator found = pool.freeBuffers.find(nBytes);
+
+    if ( found == pool.freeBuffers.end() ) {
+        return 0;
+    }
+    void* data = found->second.ptr;
+    pool.freeBuffers.erase(found);
+    pool.nbPooledBytes -= nBytes;
+
+    // The buffer is live again: its new owner is responsible for its accounting
+    CacheBase::unregisterExternalMemory(nBytes);
+
+    return data;
+}
+
+bool
+RamBufferPool::releaseBuffer(void* ptr,
+                             std::size_t nBytes)
+{
+    RamBufferPoolImpl& pool = getRamBufferPool();
+    QMutexLocker k(&pool.lock);
+
+    if (pool.nbPooledBytes + nBytes > NATRON_RAM_BUFFER_POOL_MAX_BYTES) {
+        return false;
+    }
+    PooledBuffer buf;
+    buf.ptr = ptr;
+    buf.unusedSinceLastPurge = false;
+    pool.freeBuffers.insert( std::make_pair(nBytes, buf) );
+    pool.nbPooledBytes += nBytes;
+
+    // Pooled buffers are still resident: count them against the cache budget so that the
+    // caches evict their least recently used entries first under memory pressure.
+    CacheBase::registerExternalMemory(nBytes);
+
+    return true;
+}
+
+void
+RamBufferPool::purgeUnusedBuffers()
+{
+    // Collect the aged buffers under the lock but unmap them outside of it, so that render
+    // threads acquiring/releasing buffers are not stalled behind the unmap system calls.
+    std::list<std::pair<std::size_t, void*> > toUnmap;
+    {
+        RamBufferPoolImpl& pool = getRamBufferPool();
+        QMutexLocker k(&pool.lock);
+        std::multimap<std::size_t, PooledBuffer>::iterator it = pool.freeBuffers.begin();
+        while ( it != pool.freeBuffers.end() ) {
+            if (it->second.unusedSinceLastPurge) {
+                toUnmap.push_back( std::make_pair(it->first, it->second.ptr) );
+                pool.nbPooledBytes -= it->first;
+                CacheBase::unregisterExternalMemory(it->first);
+                pool.freeBuffers.erase(it++);
+            } else {
+                it->second.unusedSinceLastPurge = true;
+                ++it;
+            }
+        }
+    }
+    for (std::list<std::pair<std::size_t, void*> >::const_iterator it = toUnmap.begin(); it != toUnmap.end(); ++it) {
+        unmapBuffer(it->second, it->first);
+    }
+}
+
+void
+RamBufferPool::purgeAllBuffers()
+{
+    std::list<std::pair<std::size_t, void*> > toUnmap;
+    {
+        RamBufferPoolImpl& pool = getRamBufferPool();
+        QMutexLocker k(&pool.lock);
+        for (std::multimap<std::size_t, PooledBuffer>::iterator it = pool.freeBuffers.begin(); it != pool.freeBuffers.end(); ++it) {
+            toUnmap.push_back( std::make_pair(it->first, it->second.ptr) );
+            CacheBase::unregisterExternalMemory(it->first);
+        }
+        pool.freeBuffers.clear();
+        pool.nbPooledBytes = 0;
+    }
+    for (std::list<std::pair<std::size_t, void*> >::const_iterator it = toUnmap.begin(); it != toUnmap.end(); ++it) {
+        unmapBuffer(it->second, it->first);
+    }
+}
+
+NATRON_NAMESPACE_EXIT;
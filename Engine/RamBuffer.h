@@ -28,25 +28,135 @@
 #include "Global/Macros.h"
 
 #include <cstdlib>
+#include <cstring>
+#include <algorithm> // min
 #include <stdexcept>
 
+#ifdef __NATRON_UNIX__
+#include <sys/mman.h>
+#ifndef MAP_ANONYMOUS
+// OS X spells it MAP_ANON
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#endif
+#ifdef __NATRON_WIN32__
+#include <windows.h>
+#endif
+
 #include "Global/GlobalDefines.h"
 
 #include "Engine/EngineFwd.h"
 
+// Buffers of at least this size are backed by fresh pages from the OS (mmap/VirtualAlloc)
+// instead of the process heap. Fresh pages are not physically allocated until first touched:
+// on NUMA systems, the pages of an image buffer are thus bound to the memory node local to
+// the render thread that writes the image, instead of the node of whatever thread previously
+// touched the recycled heap memory.
+#define NATRON_RAM_BUFFER_OS_PAGES_THRESHOLD (1 << 20)
+
 NATRON_NAMESPACE_ENTER;
 
+/**
+ * @brief Process-wide pool of the OS pages backed buffers freed by RamBuffer.
+ *
+ * A cache eviction wave frees many image buffers at once. Unmapping each of them individually
+ * and then mapping fresh pages right after for the images of the next renders makes the system
+ * allocator churn (mapping tear-down, TLB shootdowns, page faults on first touch), which shows
+ * up as allocation jitter spikes right after every eviction.
+ * Instead, freed buffers are retained here and recycled on an exact size match: the frames of a
+ * sequence all have the same size, so the buffers freed by an eviction wave typically match the
+ * upcoming demand of the render threads. Buffers that were not recycled for a while are
+ * returned to the OS in one batched pass by the StorageDeleterThread when it is idle, see
+ * purgeUnusedBuffers().
+ **/
+class RamBufferPool
+{
+public:
+
+    /**
+     * @brief Returns a pooled buffer of exactly nBytes, or NULL if none is available in which
+     * case the caller must map fresh pages itself.
+     **/
+    static void* acquireBuffer(std::size_t nBytes);
+
+    /**
+     * @brief Offers the given buffer of nBytes to the pool. Returns false if the pool is full,
+     * in which case ownership is not taken and the caller must unmap the buffer itself.
+     **/
+    static bool releaseBuffer(void* ptr, std::size_t nBytes);
+
+    /**
+     * @brief Unmaps in one batch the pooled buffers that were not recycled since the previous
+     * call. Called periodically by the StorageDeleterThread when it has no work queued.
+     **/
+    static void purgeUnusedBuffers();
+
+    /**
+     * @brief Unmaps all the pooled buffers. Called when the StorageDeleterThread exits.
+     **/
+    static void purgeAllBuffers();
+};
+
 template <typename T>
 class RamBuffer
 {
     T* data;
     U64 count;
+    bool osPagesBacked;
+
+    static T* allocateBuffer(U64 nElements, bool* osPagesBacked)
+    {
+        const std::size_t nBytes = nElements * sizeof(T);
+        *osPagesBacked = nBytes >= NATRON_RAM_BUFFER_OS_PAGES_THRESHOLD;
+        if (*osPagesBacked) {
+            // Recycle a buffer of the same size freed by a previous eviction wave, if any
+            void* pooled = RamBufferPool::acquireBuffer(nBytes);
+            if (pooled) {
+                return (T*)pooled;
+            }
+#ifdef __NATRON_UNIX__
+            void* ptr = ::mmap(0, nBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (ptr != MAP_FAILED) {
+                return (T*)ptr;
+            }
+#elif defined(__NATRON_WIN32__)
+            void* ptr = ::VirtualAlloc(0, nBytes, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+            if (ptr) {
+                return (T*)ptr;
+            }
+#endif
+            // Fall through to the heap if the OS allocation failed
+            *osPagesBacked = false;
+        }
+        return (T*)malloc(nBytes);
+    }
+
+    static void freeBuffer(T* ptr, U64 nElements, bool osPagesBacked)
+    {
+        if (osPagesBacked) {
+            // Hand the buffer to the pool instead of unmapping it: an allocation of the same
+            // size is likely to follow shortly. The pool unmaps it later, in a batch, if it
+            // remains unused.
+            if ( RamBufferPool::releaseBuffer( ptr, nElements * sizeof(T) ) ) {
+                return;
+            }
+#ifdef __NATRON_UNIX__
+            ::munmap(ptr, nElements * sizeof(T));
+#elif defined(__NATRON_WIN32__)
+            Q_UNUSED(nElements);
+            ::VirtualFree(ptr, 0, MEM_RELEASE);
+#endif
+        } else {
+            free(ptr);
+        }
+    }
 
 public:
 
     RamBuffer()
     : data(0)
     , count(0)
+    , osPagesBacked(false)
     {
     }
 
@@ -69,6 +179,7 @@ public:
     {
         std::swap(data, other.data);
         std::swap(count, other.count);
+        std::swap(osPagesBacked, other.osPagesBacked);
     }
 
     U64 size() const
@@ -81,15 +192,15 @@ public:
         if (size == 0) {
             return;
         }
-        count = size;
         if (data) {
-            free(data);
+            freeBuffer(data, count, osPagesBacked);
             data = 0;
         }
+        count = size;
         if (count == 0) {
             return;
         }
-        data = (T*)malloc( size * sizeof(T) );
+        data = allocateBuffer(count, &osPagesBacked);
         if (!data) {
             throw std::bad_alloc();
         }
@@ -100,20 +211,29 @@ public:
         if (size == 0 || size == count) {
             return;
         }
-        count = size;
-        data = (T*)realloc(data,size * sizeof(T));
         if (!data) {
+            resize(size);
+            return;
+        }
+        bool newOsPagesBacked;
+        T* newData = allocateBuffer(size, &newOsPagesBacked);
+        if (!newData) {
             throw std::bad_alloc();
         }
+        std::memcpy( newData, data, std::min(count, size) * sizeof(T) );
+        freeBuffer(data, count, osPagesBacked);
+        data = newData;
+        count = size;
+        osPagesBacked = newOsPagesBacked;
     }
 
     void clear()
     {
-        count = 0;
         if (data) {
-            free(data);
+            freeBuffer(data, count, osPagesBacked);
             data = 0;
         }
+        count = 0;
     }
 
 
@@ -24,6 +24,7 @@
 
 #include "ReadNode.h"
 
+#include <set>
 #include <sstream> // stringstream
 
 #include "Global/QtCompat.h"
@@ -39,7 +40,9 @@ CLANG_DIAG_OFF(deprecated)
 CLANG_DIAG_OFF(uninitialized)
 #include <QtCore/QCoreApplication>
 #include <QtCore/QProcess>
+#include <QtCore/QRunnable>
 #include <QtCore/QThread>
+#include <QtCore/QThreadPool>
 CLANG_DIAG_ON(deprecated)
 CLANG_DIAG_ON(uninitialized)
 
@@ -52,6 +55,7 @@ CLANG_DIAG_ON(uninitialized)
 #include "Engine/Project.h"
 #include "Engine/Plugin.h"
 #include "Engine/Settings.h"
+#include "Engine/TreeRender.h"
 
 #include "Serialization/NodeSerialization.h"
 #include "Serialization/KnobSerialization.h"
@@ -62,6 +66,14 @@ CLANG_DIAG_ON(uninitialized)
 
 #define kNatronPersistentErrorDecoderMissing "NatronPersistentErrorDecoderMissing"
 
+// Number of frames ahead of the playhead for which a decode is issued in advance when frames
+// are requested sequentially (playback or render on disk).
+#define NATRON_READNODE_PREFETCH_NUM_FRAMES 4
+
+// Number of threads dedicated to prefetch decoding. This is kept low on purpose: decoders are
+// themselves multi-threaded and the goal is only to overlap file I/O with rendering.
+#define NATRON_READNODE_PREFETCH_MAX_THREADS 2
+
 NATRON_NAMESPACE_ENTER;
 
 //Generic Reader
@@ -233,6 +245,22 @@ public:
 
     bool wasCreatedAsHiddenNode;
 
+    // Protects all decode prefetch data below
+    QMutex prefetchDataMutex;
+
+    // The last frame at which a render of the decoder was requested, used to detect that frames
+    // are requested sequentially. Valid only if prefetchDirection is non 0.
+    double lastDecodeRequestedTime;
+
+    // 1 when playing forward, -1 when playing backward, 0 when the requests are not sequential
+    int prefetchDirection;
+
+    // Frames for which a decode was scheduled on the prefetch thread pool and did not complete yet
+    std::set<double> prefetchFramesInFlight;
+
+    // Thread pool on which prefetched decodes are issued, created on the first prefetch
+    boost::scoped_ptr<QThreadPool> prefetchThreadPool;
+
 
     ReadNodePrivate(ReadNode* publicInterface)
     : _publicInterface(publicInterface)
@@ -249,6 +277,11 @@ public:
     , creatingReadNode(0)
     , lastPluginIDCreated()
     , wasCreatedAsHiddenNode(false)
+    , prefetchDataMutex()
+    , lastDecodeRequestedTime(0)
+    , prefetchDirection(0)
+    , prefetchFramesInFlight()
+    , prefetchThreadPool()
     {
     }
 
@@ -303,6 +336,87 @@ public:
     }
 };
 
+/**
+ * @brief Decodes a single frame of the embedded decoder on the prefetch thread pool.
+ * The resulting image itself is discarded: decoding it is enough to warm-up the cache
+ * so that render threads find already-decoded planes when the playhead reaches the frame.
+ **/
+class ReadNodeDecodePrefetchRunnable
+    : public QRunnable
+{
+    boost::weak_ptr<ReadNode> _node;
+
+    // The playback render that triggered the prefetch: if it gets aborted, do not decode
+    TreeRenderWPtr _originalRender;
+    double _time;
+    ViewIdx _view;
+
+public:
+
+    ReadNodeDecodePrefetchRunnable(const ReadNodePtr& node,
+                                   const TreeRenderPtr& originalRender,
+                                   double time,
+                                   ViewIdx view)
+        : _node(node)
+        , _originalRender(originalRender)
+        , _time(time)
+        , _view(view)
+    {
+    }
+
+    virtual ~ReadNodeDecodePrefetchRunnable()
+    {
+    }
+
+private:
+
+    virtual void run() OVERRIDE FINAL
+    {
+        ReadNodePtr node = _node.lock();
+
+        if (!node) {
+            return;
+        }
+
+        decodeFrame(node);
+
+        QMutexLocker k(&node->_imp->prefetchDataMutex);
+        node->_imp->prefetchFramesInFlight.erase(_time);
+    }
+
+    void decodeFrame(const ReadNodePtr& node)
+    {
+        TreeRenderPtr originalRender = _originalRender.lock();
+
+        if ( !originalRender || originalRender->isRenderAborted() ) {
+            return;
+        }
+        NodePtr reader = node->getEmbeddedReader();
+        if (!reader) {
+            return;
+        }
+
+        TreeRender::CtorArgsPtr args(new TreeRender::CtorArgs);
+        args->treeRootEffect = reader->getEffectInstance();
+        args->time = TimeValue(_time);
+        args->view = _view;
+        args->proxyScale = originalRender->getProxyScale();
+        args->mipMapLevel = originalRender->getMipMapLevel();
+        args->draftMode = originalRender->isDraftRender();
+        args->playback = true;
+        args->byPassCache = false;
+
+        try {
+            TreeRenderPtr render = TreeRender::create(args);
+            FrameViewRequestPtr outputRequest;
+            render->launchRender(&outputRequest);
+        } catch (...) {
+            // The decode is only a cache warm-up: if it fails, the render threads will
+            // hit the error themselves when reaching the frame.
+        }
+    }
+};
+
 
 ReadNode::ReadNode(const NodePtr& n)
     : NodeGroup(n)
@@ -481,6 +595,12 @@ ReadNodePrivate::destroyReadNode()
     _publicInterface->recreateKnobs(true);
 #pragma message WARN("TODO: if Gui, refresh pluginID, version, help tooltip in DockablePanel to reflect embedded node change")
 
+    // The decoder is gone: forget any playback direction detected with it
+    {
+        QMutexLocker k(&prefetchDataMutex);
+        prefetchDirection = 0;
+    }
+
     QMutexLocker k(&embeddedPluginMutex);
     embeddedPlugin->destroyNode();
     embeddedPlugin.reset();
@@ -1074,6 +1194,82 @@ ReadNode::getFrameRange(double *first, double *last)
     }
 }
 
+void
+ReadNode::onDecoderRenderRequested(TimeValue time,
+                                   ViewIdx view,
+                                   const TreeRenderPtr& render)
+{
+    assert( render && render->isPlayback() );
+    if ( !render || render->isRenderAborted() ) {
+        return;
+    }
+
+    double first, last;
+    {
+        ActionRetCodeEnum stat = getFrameRange(&first, &last);
+        if ( isFailureRetCode(stat) ) {
+            return;
+        }
+    }
+
+    std::list<double> framesToPrefetch;
+    QThreadPool* threadPool = 0;
+    {
+        QMutexLocker k(&_imp->prefetchDataMutex);
+
+        // If the frame is in-flight on the prefetch thread pool, this request comes from the
+        // prefetch render itself: it must not feed back into the direction detection.
+        if ( _imp->prefetchFramesInFlight.find( (double)time ) != _imp->prefetchFramesInFlight.end() ) {
+            return;
+        }
+
+        // Detect the playback direction: only prefetch when 2 consecutive requests are exactly
+        // 1 frame apart. A request at the same frame (e.g: for another plane) keeps the
+        // direction established so far.
+        double delta = time - _imp->lastDecodeRequestedTime;
+        if (delta == 1) {
+            _imp->prefetchDirection = 1;
+        } else if (delta == -1) {
+            _imp->prefetchDirection = -1;
+        } else if (delta != 0) {
+            _imp->prefetchDirection = 0;
+        }
+        _imp->lastDecodeRequestedTime = time;
+
+        if (_imp->prefetchDirection == 0) {
+            return;
+        }
+
+        for (int i = 1; i <= NATRON_READNODE_PREFETCH_NUM_FRAMES; ++i) {
+            double frame = time + i * _imp->prefetchDirection;
+            if ( (frame < first) || (frame > last) ) {
+                continue;
+            }
+            if ( _imp->prefetchFramesInFlight.find(frame) != _imp->prefetchFramesInFlight.end() ) {
+                continue;
+            }
+            _imp->prefetchFramesInFlight.insert(frame);
+            framesToPrefetch.push_back(frame);
+        }
+        if ( framesToPrefetch.empty() ) {
+            return;
+        }
+
+        if (!_imp->prefetchThreadPool) {
+            _imp->prefetchThreadPool.reset(new QThreadPool);
+            _imp->prefetchThreadPool->setMaxThreadCount(NATRON_READNODE_PREFETCH_MAX_THREADS);
+        }
+        threadPool = _imp->prefetchThreadPool.get();
+    }
+
+    ReadNodePtr thisShared = toReadNode(EffectInstance::shared_from_this());
+    assert(thisShared);
+    for (std::list<double>::const_iterator it = framesToPrefetch.begin(); it != framesToPrefetch.end(); ++it) {
+        // The runnable is deleted by the thread pool once run
+        threadPool->start( new ReadNodeDecodePrefetchRunnable(thisShared, render, *it, view) );
+    }
+} // ReadNode::onDecoderRenderRequested
+
 NATRON_NAMESPACE_EXIT;
 
 NATRON_NAMESPACE_USING;
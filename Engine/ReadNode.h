@@ -105,8 +105,19 @@ public:
 
     virtual void setupInitialSubGraphState() OVERRIDE FINAL;
 
+    /**
+     * @brief Called whenever a render of the embedded decoder is initiated at the given frame
+     * as part of a playback (or sequential on-disk) render. When the frames are requested
+     * sequentially, this schedules decodes of the frames ahead of the playhead on a small
+     * I/O thread pool so that render threads find already-decoded planes in the cache.
+     * This may be called on any thread and must remain cheap: it only does book-keeping and
+     * enqueues background tasks.
+     **/
+    void onDecoderRenderRequested(TimeValue time, ViewIdx view, const TreeRenderPtr& render);
+
 private:
 
+    friend class ReadNodeDecodePrefetchRunnable;
 
     virtual void initializeKnobs() OVERRIDE FINAL;
     virtual void onKnobsAboutToBeLoaded(const SERIALIZATION_NAMESPACE::NodeSerialization& serialization) OVERRIDE FINAL;
@@ -114,6 +114,140 @@ std::list<RectI> RectI::splitIntoSmallerRects(int splitsCount) const
     return ret;
 } // RectI::splitIntoSmallerRects
 
+// Order rectangles in row-major order: by bottom scan-line first, then by left edge
+static bool
+isRectBeforeInRowMajorOrder(const RectI& lhs, const RectI& rhs)
+{
+    if (lhs.y1 != rhs.y1) {
+        return lhs.y1 < rhs.y1;
+    }
+
+    return lhs.x1 < rhs.x1;
+}
+
+// Remove null rectangles from the set, preserving the order of the others
+static void
+compactRects(std::vector<RectI>* rects)
+{
+    std::size_t nRects = 0;
+
+    for (std::size_t i = 0; i < rects->size(); ++i) {
+        if ( !(*rects)[i].isNull() ) {
+            (*rects)[nRects] = (*rects)[i];
+            ++nRects;
+        }
+    }
+    rects->resize(nRects);
+}
+
+void
+RectI::intersectMany(const RectI& rect,
+                     std::vector<RectI>* rects)
+{
+    for (std::size_t i = 0; i < rects->size(); ++i) {
+        RectI& r = (*rects)[i];
+        if ( !r.intersect(rect, &r) ) {
+            r.clear();
+        }
+    }
+}
+
+void
+RectI::subtractMany(const RectI& rect,
+                    std::vector<RectI>* rects)
+{
+    std::vector<RectI> results;
+
+    results.reserve( rects->size() );
+    for (std::size_t i = 0; i < rects->size(); ++i) {
+        const RectI& r = (*rects)[i];
+        if ( r.isNull() ) {
+            continue;
+        }
+        if ( !r.intersects(rect) ) {
+            results.push_back(r);
+            continue;
+        }
+
+        // Bottom part, full width
+        if (rect.y1 > r.y1) {
+            results.push_back( RectI(r.x1, r.y1, r.x2, rect.y1) );
+        }
+
+        // Left and right parts, between the bottom and top parts
+        int midY1 = std::max(r.y1, rect.y1);
+        int midY2 = std::min(r.y2, rect.y2);
+        assert(midY1 < midY2); // guaranteed since the rectangles intersect
+        if (rect.x1 > r.x1) {
+            results.push_back( RectI(r.x1, midY1, rect.x1, midY2) );
+        }
+        if (rect.x2 < r.x2) {
+            results.push_back( RectI(rect.x2, midY1, r.x2, midY2) );
+        }
+
+        // Top part, full width
+        if (rect.y2 < r.y2) {
+            results.push_back( RectI(r.x1, rect.y2, r.x2, r.y2) );
+        }
+    }
+    std::sort(results.begin(), results.end(), isRectBeforeInRowMajorOrder);
+    rects->swap(results);
+} // RectI::subtractMany
+
+void
+RectI::coalesceAdjacent(std::vector<RectI>* rects)
+{
+    // Drop null rectangles (e.g: produced by intersectMany) and sort in row-major order
+    compactRects(rects);
+    if (rects->size() <= 1) {
+        return;
+    }
+    std::sort(rects->begin(), rects->end(), isRectBeforeInRowMajorOrder);
+
+    // First merge horizontally: after the sort, rectangles sharing the same scan-line
+    // span and touching edges are consecutive
+    std::size_t lastRect = 0;
+    for (std::size_t i = 1; i < rects->size(); ++i) {
+        RectI& prev = (*rects)[lastRect];
+        const RectI& r = (*rects)[i];
+        if ( (r.y1 == prev.y1) && (r.y2 == prev.y2) && (r.x1 == prev.x2) ) {
+            prev.x2 = r.x2;
+        } else {
+            ++lastRect;
+            (*rects)[lastRect] = r;
+        }
+    }
+    rects->resize(lastRect + 1);
+
+    // Then merge vertically: a rectangle can only be extended by a rectangle with the
+    // same column span lying exactly on top of it, which is located further in the set
+    // since it is sorted on y1
+    for (std::size_t i = 0; i < rects->size(); ++i) {
+        RectI& r = (*rects)[i];
+        if ( r.isNull() ) {
+            continue;
+        }
+        for (std::size_t j = i + 1; j < rects->size(); ++j) {
+            RectI& other = (*rects)[j];
+            if ( other.isNull() ) {
+                continue;
+            }
+            if (other.y1 > r.y2) {
+                // Nothing further can touch the top edge
+                break;
+            }
+            if ( (other.y1 == r.y2) && (other.x1 == r.x1) && (other.x2 == r.x2) ) {
+                // Keep scanning: another rectangle may lie on top of the extended one
+                r.y2 = other.y2;
+                other.clear();
+            }
+        }
+    }
+
+    // Remove the rectangles swallowed by the vertical pass
+    compactRects(rects);
+} // RectI::coalesceAdjacent
+
 void
 RectI::toCanonical(unsigned int thisLevel,
                    double par,
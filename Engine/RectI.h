@@ -445,6 +445,31 @@ public:
 
 #endif
     std::list<RectI> splitIntoSmallerRects(int splitsCount) const;
+
+    /**
+     * @brief Clips each rectangle of the set against the given rectangle, in place.
+     * Rectangles that do not intersect it are set to a null rectangle: the set is
+     * not reordered nor compacted so that indices remain valid for any array kept
+     * in parallel of the set.
+     **/
+    static void intersectMany(const RectI& rect, std::vector<RectI>* rects);
+
+    /**
+     * @brief Removes the given rectangle from each rectangle of the set: each
+     * rectangle may be split in up to 4 smaller ones. The resulting set is compacted
+     * (null rectangles are dropped) and sorted in row-major order (y1, then x1).
+     **/
+    static void subtractMany(const RectI& rect, std::vector<RectI>* rects);
+
+    /**
+     * @brief Merges edge-adjacent rectangles of the set into bigger ones: first
+     * rectangles sharing the same scan-line span, then vertically stacked rectangles
+     * sharing the same column span. Null rectangles are dropped and the set is left
+     * sorted in row-major order (y1, then x1). The area covered by the set is unchanged,
+     * assuming the rectangles do not overlap.
+     **/
+    static void coalesceAdjacent(std::vector<RectI>* rects);
+
     static RectI fromOfxRectI(const OfxRectI & r)
     {
         RectI ret(r.x1, r.y1, r.x2, r.y2);
@@ -0,0 +1,232 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2013-2017 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "RenderImageArena.h"
+
+#include <cassert>
+#include <cstdlib>
+#include <list>
+#include <map>
+#include <new> // std::bad_alloc
+
+#ifdef __NATRON_UNIX__
+#include <sys/mman.h>
+#ifndef MAP_ANONYMOUS
+// OS X spells it MAP_ANON
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#endif
+#ifdef __NATRON_WIN32__
+#include <windows.h>
+#endif
+
+#include <QMutex>
+
+NATRON_NAMESPACE_ENTER;
+
+// Size of the memory mapped slabs out of which image buffers are carved
+#define NATRON_RENDER_ARENA_SLAB_BYTES ( (std::size_t)64 * 1024 * 1024 )
+
+// Buffers larger than this get a private mapping instead of a slab slot so a single
+// huge image does not pin a mostly empty slab
+#define NATRON_RENDER_ARENA_MAX_BLOCK_BYTES (NATRON_RENDER_ARENA_SLAB_BYTES / 2)
+
+// All buffers are rounded up to this size, which keeps them cache-line aligned
+#define NATRON_RENDER_ARENA_ALIGNMENT 64
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+static void*
+allocateOSPages(std::size_t nBytes, bool* osPagesBacked)
+{
+    *osPagesBacked = true;
+#ifdef __NATRON_UNIX__
+    void* ptr = ::mmap(0, nBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ptr != MAP_FAILED) {
+        return ptr;
+    }
+#elif defined(__NATRON_WIN32__)
+    void* ptr = ::VirtualAlloc(0, nBytes, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+    if (ptr) {
+        return ptr;
+    }
+#endif
+    // Fall through to the heap if the OS allocation failed
+    *osPagesBacked = false;
+    return malloc(nBytes);
+}
+
+static void
+freeOSPages(void* ptr, std::size_t nBytes, bool osPagesBacked)
+{
+    if (osPagesBacked) {
+#ifdef __NATRON_UNIX__
+        ::munmap(ptr, nBytes);
+#elif defined(__NATRON_WIN32__)
+        Q_UNUSED(nBytes);
+        ::VirtualFree(ptr, 0, MEM_RELEASE);
+#endif
+    } else {
+        free(ptr);
+    }
+}
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+
+struct RenderImageArenaSlab
+{
+    char* data;
+    std::size_t capacity;
+
+    // Offset of the first byte not carved out yet
+    std::size_t used;
+    bool osPagesBacked;
+
+    RenderImageArenaSlab()
+    : data(0)
+    , capacity(0)
+    , used(0)
+    , osPagesBacked(false)
+    {
+    }
+};
+
+struct RenderImageArenaPrivate
+{
+    QMutex lock;
+
+    // Slabs in allocation order, buffers are carved from the last one
+    std::list<RenderImageArenaSlab> slabs;
+
+    // Size of each buffer carved from a slab, live or released
+    std::map<char*, std::size_t> blockSizes;
+
+    // Released slab buffers available for recycling, keyed by size
+    std::multimap<std::size_t, char*> freeBlocks;
+
+    // Buffers larger than NATRON_RENDER_ARENA_MAX_BLOCK_BYTES, with their own mapping
+    std::map<char*, std::pair<std::size_t, bool> > largeBlocks;
+
+    RenderImageArenaPrivate()
+    : lock()
+    , slabs()
+    , blockSizes()
+    , freeBlocks()
+    , largeBlocks()
+    {
+    }
+};
+
+RenderImageArena::RenderImageArena()
+: _imp(new RenderImageArenaPrivate())
+{
+}
+
+RenderImageArena::~RenderImageArena()
+{
+    // Release everything wholesale: any buffer still live keeps the arena alive through
+    // the shared pointer held by its RAMImageStorage, so nothing points into the slabs anymore.
+    for (std::list<RenderImageArenaSlab>::iterator it = _imp->slabs.begin(); it != _imp->slabs.end(); ++it) {
+        freeOSPages(it->data, it->capacity, it->osPagesBacked);
+    }
+    for (std::map<char*, std::pair<std::size_t, bool> >::iterator it = _imp->largeBlocks.begin(); it != _imp->largeBlocks.end(); ++it) {
+        freeOSPages(it->first, it->second.first, it->second.second);
+    }
+}
+
+void*
+RenderImageArena::allocate(std::size_t nBytes)
+{
+    // Round up so that consecutive buffers within a slab stay cache-line aligned
+    nBytes = ( nBytes + (NATRON_RENDER_ARENA_ALIGNMENT - 1) ) & ~( (std::size_t)NATRON_RENDER_ARENA_ALIGNMENT - 1 );
+
+    QMutexLocker k(&_imp->lock);
+
+    if (nBytes > NATRON_RENDER_ARENA_MAX_BLOCK_BYTES) {
+        bool osPagesBacked;
+        char* data = (char*)allocateOSPages(nBytes, &osPagesBacked);
+        if (!data) {
+            throw std::bad_alloc();
+        }
+        _imp->largeBlocks[data] = std::make_pair(nBytes, osPagesBacked);
+        return data;
+    }
+
+    // Recycle the smallest released buffer that fits, unless it would waste more than
+    // half of its capacity
+    {
+        std::multimap<std::size_t, char*>::iterator found = _imp->freeBlocks.lower_bound(nBytes);
+        if ( found != _imp->freeBlocks.end() && found->first <= nBytes * 2 ) {
+            char* data = found->second;
+            _imp->freeBlocks.erase(found);
+            return data;
+        }
+    }
+
+    // Carve a new buffer out of the last slab
+    if ( _imp->slabs.empty() || (_imp->slabs.back().used + nBytes > _imp->slabs.back().capacity) ) {
+        RenderImageArenaSlab slab;
+        slab.capacity = NATRON_RENDER_ARENA_SLAB_BYTES;
+        slab.data = (char*)allocateOSPages(slab.capacity, &slab.osPagesBacked);
+        if (!slab.data) {
+            throw std::bad_alloc();
+        }
+        _imp->slabs.push_back(slab);
+    }
+
+    RenderImageArenaSlab& slab = _imp->slabs.back();
+    char* data = slab.data + slab.used;
+    slab.used += nBytes;
+    _imp->blockSizes[data] = nBytes;
+    return data;
+}
+
+void
+RenderImageArena::release(void* ptr)
+{
+    if (!ptr) {
+        return;
+    }
+
+    QMutexLocker k(&_imp->lock);
+
+    {
+        std::map<char*, std::pair<std::size_t, bool> >::iterator foundLarge = _imp->largeBlocks.find( (char*)ptr );
+        if ( foundLarge != _imp->largeBlocks.end() ) {
+            freeOSPages(foundLarge->first, foundLarge->second.first, foundLarge->second.second);
+            _imp->largeBlocks.erase(foundLarge);
+            return;
+        }
+    }
+
+    std::map<char*, std::size_t>::iterator found = _imp->blockSizes.find( (char*)ptr );
+    assert( found != _imp->blockSizes.end() );
+    if ( found != _imp->blockSizes.end() ) {
+        _imp->freeBlocks.insert( std::make_pair(found->second, found->first) );
+    }
+}
+
+NATRON_NAMESPACE_EXIT;
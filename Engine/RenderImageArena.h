@@ -0,0 +1,87 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2013-2017 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef NATRON_ENGINE_RENDERIMAGEARENA_H
+#define NATRON_ENGINE_RENDERIMAGEARENA_H
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <cstddef>
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/scoped_ptr.hpp>
+#endif
+
+#include "Engine/EngineFwd.h"
+
+NATRON_NAMESPACE_ENTER;
+
+/**
+ * @brief A slab allocator for the temporary image buffers of a render.
+ *
+ * Every renderRoI cycle allocates and frees temporary RAM image buffers: going through
+ * the general heap for each of them shows up as malloc arena contention in profiles when
+ * many render threads are active. Instead, each TreeRender owns an arena which hands out
+ * buffers carved from large memory mapped slabs: buffers released during the render are
+ * recycled by subsequent allocations, and the slabs themselves are returned to the OS in
+ * one go when the last image referencing the arena dies, eliminating the per-image
+ * mmap/munmap churn.
+ *
+ * Only images with a cache policy of eCacheAccessModeNone allocate from the arena:
+ * buffers of cached images are adopted by the cache and may outlive the render by far.
+ *
+ * This class is thread-safe.
+ **/
+struct RenderImageArenaPrivate;
+class RenderImageArena
+{
+public:
+
+    RenderImageArena();
+
+    ~RenderImageArena();
+
+    /**
+     * @brief Returns a 64 byte aligned buffer of at least nBytes, either recycling a
+     * previously released buffer of this render or carving a new one out of a slab.
+     * This function may throw a std::bad_alloc exception if it could not allocate the
+     * required memory.
+     **/
+    void* allocate(std::size_t nBytes);
+
+    /**
+     * @brief Returns a buffer obtained from allocate() to the arena free-list so that
+     * it can be recycled. The memory itself is only given back to the OS when the
+     * arena is destroyed.
+     **/
+    void release(void* ptr);
+
+private:
+
+    boost::scoped_ptr<RenderImageArenaPrivate> _imp;
+};
+
+NATRON_NAMESPACE_EXIT;
+
+#endif // NATRON_ENGINE_RENDERIMAGEARENA_H
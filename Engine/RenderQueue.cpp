@@ -24,9 +24,19 @@
 
 #include "RenderQueue.h"
 
+#include <iostream>
+#include <sstream>
+
 #include <QCoreApplication>
 #include <QWaitCondition>
 #include <QMutex>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+
+#include <SequenceParsing.h>
+
+#include "Global/FStreamsSupport.h"
+#include "Global/QtCompat.h"
 
 #include "Engine/AppInstance.h"
 #include "Engine/AppManager.h"
@@ -197,6 +207,42 @@ RenderQueuePrivate::validateRenderOptions(RenderQueue::RenderWork& w)
             return false;
         }
     }
+
+    // Resume support: if the manifest of a previous crashed or aborted run of the same job still
+    // exists, skip the frames it recorded (each verified against the output file on disk) and
+    // restart from the first incomplete frame. The manifest is removed when a job completes
+    // successfully, so re-rendering an unchanged project from scratch is not affected.
+    {
+        std::string manifestPath = RenderCheckpointManifest::getManifestFilePath(w.treeRoot);
+        if ( !manifestPath.empty() ) {
+            std::set<double> doneFrames;
+            RenderCheckpointManifest::getVerifiedFrames(manifestPath, RenderCheckpointManifest::computeJobHash(w.treeRoot), &doneFrames);
+            if ( !doneFrames.empty() ) {
+                TimeValue resumeFrame = w.firstFrame;
+                while ( ( (w.frameStep > 0 && resumeFrame <= w.lastFrame) ||
+                          (w.frameStep < 0 && resumeFrame >= w.lastFrame) ) &&
+                        ( doneFrames.find( (double)resumeFrame ) != doneFrames.end() ) ) {
+                    resumeFrame = TimeValue(resumeFrame + w.frameStep);
+                }
+                if (resumeFrame != w.firstFrame) {
+                    const bool allFramesDone = (w.frameStep > 0) ? (resumeFrame > w.lastFrame) : (resumeFrame < w.lastFrame);
+                    if (allFramesDone) {
+                        std::cout << _publicInterface->tr("%1: all frames were already rendered by a previous run, nothing to do. "
+                                                          "Remove %2 to force a full re-render.")
+                        .arg( QString::fromUtf8( w.treeRoot->getScriptName_mt_safe().c_str() ) )
+                        .arg( QString::fromUtf8( manifestPath.c_str() ) ).toStdString() << std::endl;
+
+                        return false;
+                    }
+                    std::cout << _publicInterface->tr("%1: resuming render at frame %2, the previous frames were already rendered by a previous run.")
+                    .arg( QString::fromUtf8( w.treeRoot->getScriptName_mt_safe().c_str() ) )
+                    .arg( QString::number( (double)resumeFrame ) ).toStdString() << std::endl;
+                    w.firstFrame = resumeFrame;
+                }
+            }
+        }
+    }
+
     return true;
 } // validateRenderOptions
 
@@ -241,7 +287,10 @@ RenderQueuePrivate::dispatchQueue(bool doBlockingRender, const std::list<RenderQ
         item.savePath = savePath;
 
         if (renderInSeparateProcess) {
-            item.process.reset( new ProcessHandler(savePath, item.work.treeRoot) );
+            // The frame range was resolved by validateRenderOptions, so it can be partitioned
+            // across several background processes if the user asked for more than one.
+            const int nProcesses = appPTR->getCurrentSettings()->getNumberOfBackgroundRenderProcesses();
+            item.process.reset( new ProcessHandler(savePath, item.work.treeRoot, item.work.firstFrame, item.work.lastFrame, item.work.frameStep, nProcesses) );
             QObject::connect( item.process.get(), SIGNAL(processFinished(int)), _publicInterface, SLOT(onBackgroundRenderProcessFinished()) );
         } else {
             QObject::connect(item.work.treeRoot->getRenderEngine().get(), SIGNAL(renderFinished(int)), _publicInterface, SLOT(onQueuedRenderFinished(int)), Qt::UniqueConnection);
@@ -551,6 +600,146 @@ RenderQueuePrivate::startNextQueuedRender(const NodePtr& finishedWriter)
 
 
 
+// The first line of a resume manifest, followed by the job hash in hexadecimal
+#define kCheckpointManifestHeader "# Natron render resume manifest v1"
+
+std::string
+RenderCheckpointManifest::getManifestFilePath(const NodePtr& treeRoot)
+{
+    KnobFilePtr fileKnob = toKnobFile( treeRoot->getKnobByName(kOfxImageEffectFileParamName) );
+
+    if (!fileKnob) {
+        return std::string();
+    }
+    std::string pattern = fileKnob->getValue( DimIdx(0), ViewIdx(0) );
+    if ( pattern.empty() ) {
+        return std::string();
+    }
+
+    // A pattern that resolves to the same file for every frame (e.g: a video) cannot be
+    // resumed per-frame: a partially written single file is not a set of complete frames
+    const std::vector<std::string>& views = treeRoot->getApp()->getProject()->getProjectViewNames();
+    if ( SequenceParsing::generateFileNameFromPattern( pattern, views, 1, 0 ) ==
+         SequenceParsing::generateFileNameFromPattern( pattern, views, 2, 0 ) ) {
+        return std::string();
+    }
+
+    QString qfileName = QString::fromUtf8( pattern.c_str() );
+    QtCompat::removeFileExtension(qfileName);
+    qfileName.append( QString::fromUtf8("-resume.txt") );
+
+    return qfileName.toStdString();
+}
+
+U64
+RenderCheckpointManifest::computeJobHash(const NodePtr& treeRoot)
+{
+    HashableObject::ComputeHashArgs hashArgs;
+
+    hashArgs.hashType = HashableObject::eComputeHashTypeTimeViewInvariant;
+
+    return treeRoot->getEffectInstance()->computeHash(hashArgs);
+}
+
+void
+RenderCheckpointManifest::resetForJob(const std::string& manifestPath,
+                                      U64 jobHash)
+{
+    // If the existing manifest was written by the same job, keep its recorded frames:
+    // this is the resume case and RenderQueue already skipped them
+    {
+        FStreamsSupport::ifstream ifile;
+        FStreamsSupport::open(&ifile, manifestPath);
+        if (ifile) {
+            std::string header, hashStr;
+            U64 existingHash = 0;
+            if ( std::getline(ifile, header) && std::getline(ifile, hashStr) ) {
+                std::istringstream ss(hashStr);
+                ss >> std::hex >> existingHash;
+            }
+            if ( (header == kCheckpointManifestHeader) && (existingHash == jobHash) ) {
+                return;
+            }
+        }
+    }
+
+    FStreamsSupport::ofstream ofile;
+    FStreamsSupport::open(&ofile, manifestPath);
+    if (!ofile) {
+        return;
+    }
+    ofile << kCheckpointManifestHeader << std::endl;
+    ofile << std::hex << jobHash << std::endl;
+}
+
+void
+RenderCheckpointManifest::addFrame(const std::string& manifestPath,
+                                   TimeValue frame,
+                                   const std::string& frameFilePath)
+{
+    FStreamsSupport::ofstream ofile;
+    FStreamsSupport::open(&ofile, manifestPath, std::ios_base::out | std::ios_base::app);
+    if (!ofile) {
+        return;
+    }
+    QFileInfo info( QString::fromUtf8( frameFilePath.c_str() ) );
+    ofile << (double)frame << ' ' << (long long)( info.exists() ? info.size() : 0 ) << ' ' << frameFilePath << std::endl;
+}
+
+void
+RenderCheckpointManifest::getVerifiedFrames(const std::string& manifestPath,
+                                            U64 jobHash,
+                                            std::set<double>* verifiedFrames)
+{
+    FStreamsSupport::ifstream ifile;
+    FStreamsSupport::open(&ifile, manifestPath);
+
+    if (!ifile) {
+        return;
+    }
+
+    {
+        std::string header, hashStr;
+        U64 existingHash = 0;
+        if ( !std::getline(ifile, header) || !std::getline(ifile, hashStr) ) {
+            return;
+        }
+        std::istringstream ss(hashStr);
+        ss >> std::hex >> existingHash;
+        if ( (header != kCheckpointManifestHeader) || (existingHash != jobHash) ) {
+            return;
+        }
+    }
+
+    std::string line;
+    while ( std::getline(ifile, line) ) {
+        std::istringstream ss(line);
+        double frame;
+        long long recordedSize;
+        if ( !(ss >> frame >> recordedSize) ) {
+            continue;
+        }
+        // The rest of the line is the output file path, which may contain spaces
+        std::string filePath;
+        std::getline(ss, filePath);
+        if ( !filePath.empty() && (filePath[0] == ' ') ) {
+            filePath.erase(0, 1);
+        }
+
+        // Verify the output file was not removed or truncated since
+        QFileInfo info( QString::fromUtf8( filePath.c_str() ) );
+        if ( info.exists() && ( (long long)info.size() == recordedSize ) ) {
+            verifiedFrames->insert(frame);
+        }
+    }
+}
+
+void
+RenderCheckpointManifest::removeManifest(const std::string& manifestPath)
+{
+    QFile::remove( QString::fromUtf8( manifestPath.c_str() ) );
+}
+
 NATRON_NAMESPACE_EXIT;
 
 NATRON_NAMESPACE_USING;
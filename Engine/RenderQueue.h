@@ -29,6 +29,8 @@
 
 #include <cmath>
 #include <climits>
+#include <set>
+#include <string>
 #include <QObject>
 
 
@@ -166,6 +168,57 @@ private:
     boost::scoped_ptr<RenderQueuePrivate> _imp;
 };
 
+/**
+ * @brief The resume manifest of a sequence render job: a text file next to the output files
+ * recording the frames that were completely written, so that relaunching a job that crashed
+ * or was aborted resumes from the first incomplete frame instead of re-rendering everything.
+ * The manifest is written by DefaultScheduler as frames complete, removed when the job
+ * finishes successfully, and consulted by RenderQueue when validating a render request.
+ **/
+class RenderCheckpointManifest
+{
+public:
+
+    /**
+     * @brief Returns the path of the manifest file for the given writer node, derived from its
+     * filename parameter the same way as the render statistics file. Returns an empty string if
+     * the writer has no filename parameter or writes a single file (e.g: a video): such outputs
+     * cannot be resumed per-frame.
+     **/
+    static std::string getManifestFilePath(const NodePtr& treeRoot);
+
+    /**
+     * @brief Identifies the job: the time invariant hash of the tree of the writer, so that a
+     * manifest written by a different version of the project is not resumed from.
+     **/
+    static U64 computeJobHash(const NodePtr& treeRoot);
+
+    /**
+     * @brief Creates the manifest for the given job. If a manifest of the same job already
+     * exists its recorded frames are kept: this is the resume case.
+     **/
+    static void resetForJob(const std::string& manifestPath, U64 jobHash);
+
+    /**
+     * @brief Appends a completed frame along with the size of its output file, which is checked
+     * again upon resume.
+     **/
+    static void addFrame(const std::string& manifestPath, TimeValue frame, const std::string& frameFilePath);
+
+    /**
+     * @brief Returns the frames recorded for the given job whose output file still exists on
+     * disk with the recorded size. Returns nothing if the manifest does not exist or was
+     * written by another job.
+     **/
+    static void getVerifiedFrames(const std::string& manifestPath, U64 jobHash, std::set<double>* verifiedFrames);
+
+    /**
+     * @brief Removes the manifest, called when a job completes successfully so that a later
+     * identical job renders everything again.
+     **/
+    static void removeManifest(const std::string& manifestPath);
+};
+
 NATRON_NAMESPACE_EXIT;
 
 #endif // NATRON_ENGINE_RENDERQUEUE_H
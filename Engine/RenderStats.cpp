@@ -24,17 +24,27 @@
 
 #include "RenderStats.h"
 
+#include <algorithm>
 #include <bitset>
 #include <cassert>
+#include <set>
 #include <stdexcept>
 
 #include <QtCore/QMutex>
+#include <QtCore/QThread>
+
+#include "Global/FStreamsSupport.h"
 
 #include "Engine/Node.h"
 #include "Engine/Timer.h"
 #include "Engine/RectI.h"
 #include "Engine/RectD.h"
 
+// Maximum number of render spans kept in memory: when recording more, the oldest
+// spans are overwritten. At 1 span per render action this is enough to hold several
+// 4K frames worth of tiles.
+#define NATRON_RENDER_SPANS_BUFFER_SIZE 65536
+
 NATRON_NAMESPACE_ENTER;
 
 struct NodeRenderStatsPrivate
@@ -42,9 +52,14 @@ struct NodeRenderStatsPrivate
     //The accumulated time spent in the EffectInstance::renderHandler function
     double totalTimeSpentRendering;
 
+    //The number of input images that had to be converted to another bit-depth
+    //before being passed to the plug-in
+    int nbInputBitDepthConversions;
+
 
     NodeRenderStatsPrivate()
     : totalTimeSpentRendering(0)
+    , nbInputBitDepthConversions(0)
     {
 
     }
@@ -69,6 +84,7 @@ void
 NodeRenderStats::operator=(const NodeRenderStats& other)
 {
     _imp->totalTimeSpentRendering = other._imp->totalTimeSpentRendering;
+    _imp->nbInputBitDepthConversions = other._imp->nbInputBitDepthConversions;
 }
 
 void
@@ -83,6 +99,18 @@ NodeRenderStats::getTotalTimeSpentRendering() const
     return _imp->totalTimeSpentRendering;
 }
 
+void
+NodeRenderStats::addInputBitDepthConversion()
+{
+    ++_imp->nbInputBitDepthConversions;
+}
+
+int
+NodeRenderStats::getNbInputBitDepthConversions() const
+{
+    return _imp->nbInputBitDepthConversions;
+}
+
 
 struct RenderStatsPrivate
 {
@@ -97,12 +125,19 @@ struct RenderStatsPrivate
     typedef std::map<NodeWPtr, NodeRenderStats > NodeInfosMap;
     NodeInfosMap nodeInfos;
 
+    // Ring buffer of captured render spans: spansCount is the total number of spans
+    // recorded, the next span is written at spansCount % spans.size()
+    std::vector<RenderSpan> spans;
+    std::size_t spansCount;
+
 
     RenderStatsPrivate()
         : lock()
         , totalTimeSpentForFrameTimer()
         , doNodesProfiling(false)
         , nodeInfos()
+        , spans()
+        , spansCount(0)
     {
     }
 
@@ -132,6 +167,27 @@ struct RenderStatsPrivate
 
         return ret.first->second;
     }
+
+    RenderSpan& nextSpan()
+    {
+        //Private, shouldn't lock
+        assert( !lock.tryLock() );
+
+        if ( spans.empty() ) {
+            spans.reserve(NATRON_RENDER_SPANS_BUFFER_SIZE);
+        }
+        RenderSpan* span;
+        if (spans.size() < NATRON_RENDER_SPANS_BUFFER_SIZE) {
+            spans.push_back( RenderSpan() );
+            span = &spans.back();
+        } else {
+            // The buffer is full: overwrite the oldest span
+            span = &spans[spansCount % NATRON_RENDER_SPANS_BUFFER_SIZE];
+        }
+        ++spansCount;
+
+        return *span;
+    }
 };
 
 RenderStats::RenderStats(bool enableInDepthProfiling)
@@ -163,6 +219,132 @@ RenderStats::addRenderInfosForNode(const NodePtr& node, double timeSpent)
     stats.addTimeSpentRendering(timeSpent);
 }
 
+void
+RenderStats::addBitDepthConversionForNode(const NodePtr& node)
+{
+    QMutexLocker k(&_imp->lock);
+
+    assert(_imp->doNodesProfiling);
+
+    NodeRenderStats& stats = _imp->findOrCreateNodeStats(node);
+    stats.addInputBitDepthConversion();
+}
+
+void
+RenderStats::addRenderSpanForNode(const NodePtr& node,
+                                  const std::string& planeName,
+                                  const RectI& tileBounds,
+                                  double duration)
+{
+    QMutexLocker k(&_imp->lock);
+
+    assert(_imp->doNodesProfiling);
+
+    RenderSpan& span = _imp->nextSpan();
+
+    QThread* thread = QThread::currentThread();
+    span.threadID = (U64)(quintptr)thread;
+    span.threadName = thread->objectName().toStdString();
+    span.nodeName = node->getScriptName_mt_safe();
+    span.planeName = planeName;
+    span.tileBounds = tileBounds;
+    span.duration = duration;
+    span.startTime = _imp->totalTimeSpentForFrameTimer.getTimeSinceCreation() - duration;
+}
+
+void
+RenderStats::addGLRenderSpanForNode(const NodePtr& node,
+                                    const std::string& planeName,
+                                    const RectI& tileBounds,
+                                    double duration)
+{
+    QMutexLocker k(&_imp->lock);
+
+    assert(_imp->doNodesProfiling);
+
+    RenderSpan& span = _imp->nextSpan();
+
+    // All GPU spans share a single synthetic timeline
+    span.threadID = 0;
+    span.threadName = "GPU";
+    span.nodeName = node->getScriptName_mt_safe();
+    span.planeName = planeName;
+    span.tileBounds = tileBounds;
+    span.duration = duration;
+    span.startTime = _imp->totalTimeSpentForFrameTimer.getTimeSinceCreation() - duration;
+}
+
+static bool
+isSpanBeforeByStartTime(const RenderSpan& lhs, const RenderSpan& rhs)
+{
+    return lhs.startTime < rhs.startTime;
+}
+
+std::vector<RenderSpan>
+RenderStats::getRenderSpans() const
+{
+    std::vector<RenderSpan> ret;
+    {
+        QMutexLocker k(&_imp->lock);
+        ret = _imp->spans;
+    }
+    std::sort(ret.begin(), ret.end(), isSpanBeforeByStartTime);
+
+    return ret;
+}
+
+bool
+RenderStats::exportSpansToChromeTraceFile(const std::string& filePath) const
+{
+    std::vector<RenderSpan> spans = getRenderSpans();
+    if ( spans.empty() ) {
+        return false;
+    }
+
+    FStreamsSupport::ofstream ofile;
+    FStreamsSupport::open(&ofile, filePath);
+    if (!ofile) {
+        return false;
+    }
+
+    ofile << "{\"traceEvents\":[\n";
+
+    bool firstEvent = true;
+
+    // Name the timeline rows with the thread names when available
+    std::set<U64> namedThreads;
+    for (std::size_t i = 0; i < spans.size(); ++i) {
+        const RenderSpan& span = spans[i];
+        if ( !span.threadName.empty() && namedThreads.insert(span.threadID).second ) {
+            if (!firstEvent) {
+                ofile << ",\n";
+            }
+            firstEvent = false;
+            ofile << "{\"ph\":\"M\",\"pid\":1,\"tid\":" << span.threadID
+                  << ",\"name\":\"thread_name\",\"args\":{\"name\":\"" << span.threadName << "\"}}";
+        }
+    }
+
+    // One complete ("X") event per span, timestamps and durations in microseconds
+    for (std::size_t i = 0; i < spans.size(); ++i) {
+        const RenderSpan& span = spans[i];
+        if (!firstEvent) {
+            ofile << ",\n";
+        }
+        firstEvent = false;
+        ofile << "{\"ph\":\"X\",\"pid\":1,\"tid\":" << span.threadID
+              << ",\"ts\":" << span.startTime * 1.e6
+              << ",\"dur\":" << span.duration * 1.e6
+              << ",\"name\":\"" << span.nodeName << "\""
+              << ",\"args\":{\"plane\":\"" << span.planeName << "\""
+              << ",\"tile\":\"" << span.tileBounds.x1 << ' ' << span.tileBounds.y1
+              << ' ' << span.tileBounds.x2 << ' ' << span.tileBounds.y2 << "\"}}";
+    }
+    ofile << "\n]}" << std::endl;
+
+    return true;
+} // exportSpansToChromeTraceFile
+
 std::map<NodePtr, NodeRenderStats >
 RenderStats::getStats(double *totalTimeSpent) const
 {
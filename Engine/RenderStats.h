@@ -31,6 +31,7 @@
 #include <map>
 #include <set>
 #include <string>
+#include <vector>
 #include <bitset>
 
 #if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
@@ -68,12 +69,53 @@ public:
     void addTimeSpentRendering(double time);
     double getTotalTimeSpentRendering() const;
 
+    void addInputBitDepthConversion();
+    int getNbInputBitDepthConversions() const;
+
 
 private:
 
     boost::scoped_ptr<NodeRenderStatsPrivate> _imp;
 };
 
+/**
+ * @brief A single render action execution captured when in-depth profiling is enabled.
+ **/
+struct RenderSpan
+{
+    // Identifies the thread that executed the render action
+    U64 threadID;
+
+    // The objectName() of the thread, if any
+    std::string threadName;
+
+    // The script-name of the node
+    std::string nodeName;
+
+    // The label of the first plane produced by the render action
+    std::string planeName;
+
+    // The portion of the image produced by the render action
+    RectI tileBounds;
+
+    // Start of the span in seconds since the creation of the RenderStats object
+    double startTime;
+
+    // Duration of the span in seconds
+    double duration;
+
+    RenderSpan()
+    : threadID(0)
+    , threadName()
+    , nodeName()
+    , planeName()
+    , tileBounds()
+    , startTime(0)
+    , duration(0)
+    {
+    }
+};
+
 /**
  * @brief Holds render infos for all nodes in a compositing tree for a frame.
  **/
@@ -94,6 +136,43 @@ public:
 
     void addRenderInfosForNode(const NodePtr& node, double timeSpent);
 
+    /**
+     * @brief Records that an input image of the given node had to be converted to another
+     * bit-depth before being passed to the plug-in. These conversions are invisible in the
+     * node-graph and can add up to a significant part of the frame time.
+     **/
+    void addBitDepthConversionForNode(const NodePtr& node);
+
+    /**
+     * @brief Records the execution of one render action for the given node.
+     * The span start time is computed from the creation time of this object and the
+     * given duration (in seconds). Spans are stored in a pre-allocated ring buffer so
+     * the recording cost is O(1) and bounded in memory: when the buffer is full the
+     * oldest spans are overwritten.
+     **/
+    void addRenderSpanForNode(const NodePtr& node, const std::string& planeName, const RectI& tileBounds, double duration);
+
+    /**
+     * @brief Records the GPU time spent executing the GL commands of one render action of
+     * the given node, as measured with an OSGLTimeElapsedQuery. GPU spans are placed on a
+     * single synthetic "GPU" timeline in the trace: the device executes the commands of
+     * all render threads in sequence anyway.
+     **/
+    void addGLRenderSpanForNode(const NodePtr& node, const std::string& planeName, const RectI& tileBounds, double duration);
+
+    /**
+     * @brief Returns the captured render spans, ordered by start time.
+     **/
+    std::vector<RenderSpan> getRenderSpans() const;
+
+    /**
+     * @brief Writes the captured render spans to the given file in the Chrome
+     * trace-event JSON format, which can be loaded in chrome://tracing or Perfetto
+     * to visualize the per-thread render timeline of the frame.
+     * Returns false if no span was recorded or if the file could not be written.
+     **/
+    bool exportSpansToChromeTraceFile(const std::string& filePath) const;
+
     std::map<NodePtr, NodeRenderStats > getStats(double *totalTimeSpent) const;
 
 private:
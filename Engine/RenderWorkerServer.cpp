@@ -0,0 +1,332 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2013-2017 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "RenderWorkerServer.h"
+
+#include <algorithm> // max
+#include <climits> // INT_MIN
+#include <iostream>
+#include <list>
+#include <map>
+#include <stdexcept>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QStringList>
+#include <QtNetwork/QHostAddress>
+
+#include "qhttpserver.h"
+#include "qhttprequest.h"
+#include "qhttpresponse.h"
+
+#include "Engine/AppInstance.h"
+#include "Engine/AppManager.h"
+#include "Engine/Node.h"
+#include "Engine/OutputSchedulerThread.h" // RenderEngine
+#include "Engine/Project.h"
+#include "Engine/RenderQueue.h"
+
+NATRON_NAMESPACE_ENTER;
+
+struct RenderWorkerServerPrivate
+{
+    Q_DECLARE_TR_FUNCTIONS(RenderWorkerServer)
+
+public:
+
+    QHttpServer* server;
+    bool listening;
+
+    // Requests whose body is not fully received yet, and the response to answer them with
+    std::map<QHttpRequest*, QHttpResponse*> pendingRequests;
+
+    // The project currently loaded in the worker app instance: consecutive jobs on the
+    // same project skip the project load and keep the caches warm
+    QString loadedProjectPath;
+
+    // State of the running job, activeResponse is NULL when idle
+    QHttpResponse* activeResponse;
+    std::list<RenderEnginePtr> activeEngines;
+    int nPendingRenders;
+    int worstRetCode;
+
+    RenderWorkerServerPrivate()
+    : server(0)
+    , listening(false)
+    , pendingRequests()
+    , loadedProjectPath()
+    , activeResponse(0)
+    , activeEngines()
+    , nPendingRenders(0)
+    , worstRetCode(0)
+    {
+    }
+};
+
+RenderWorkerServer::RenderWorkerServer(int port)
+: _imp(new RenderWorkerServerPrivate())
+{
+    _imp->server = new QHttpServer(this);
+    QObject::connect( _imp->server, SIGNAL(newRequest(QHttpRequest*,QHttpResponse*)), this, SLOT(onNewRequest(QHttpRequest*,QHttpResponse*)) );
+    _imp->listening = _imp->server->listen( QHostAddress::Any, (quint16)port );
+    if (_imp->listening) {
+        std::cout << tr("Render worker listening on port %1").arg(port).toStdString() << std::endl;
+    } else {
+        std::cout << tr("Could not bind the render worker server to port %1").arg(port).toStdString() << std::endl;
+    }
+}
+
+RenderWorkerServer::~RenderWorkerServer()
+{
+    _imp->server->close();
+}
+
+bool
+RenderWorkerServer::isListening() const
+{
+    return _imp->listening;
+}
+
+void
+RenderWorkerServer::onNewRequest(QHttpRequest* request,
+                                 QHttpResponse* response)
+{
+    // Routing is deferred until the whole request, including its body, is received
+    request->storeBody();
+    _imp->pendingRequests[request] = response;
+    QObject::connect( request, SIGNAL(end()), this, SLOT(onRequestEnd()) );
+}
+
+void
+RenderWorkerServer::onRequestEnd()
+{
+    QHttpRequest* request = qobject_cast<QHttpRequest*>( sender() );
+    std::map<QHttpRequest*, QHttpResponse*>::iterator found = _imp->pendingRequests.find(request);
+
+    if ( found == _imp->pendingRequests.end() ) {
+        return;
+    }
+    QHttpResponse* response = found->second;
+    _imp->pendingRequests.erase(found);
+
+    const QString path = request->path();
+
+    if ( path == QString::fromUtf8("/status") ) {
+        QString status = QString::fromUtf8(NATRON_APPLICATION_NAME " " NATRON_VERSION_STRING "; project: %1; rendering: %2\n")
+                         .arg( _imp->loadedProjectPath.isEmpty() ? QString::fromUtf8("none") : _imp->loadedProjectPath )
+                         .arg( _imp->activeResponse ? 1 : 0 );
+        response->writeHead(QHttpResponse::STATUS_OK);
+        response->end( status.toUtf8() );
+    } else if ( ( path == QString::fromUtf8("/render") ) && ( request->method() == QHttpRequest::HTTP_POST ) ) {
+        if (_imp->activeResponse) {
+            replyError( response, QHttpResponse::STATUS_SERVICE_UNAVAILABLE, tr("A render job is already running") );
+        } else {
+            startRenderJob(request, response);
+        }
+    } else if ( ( path == QString::fromUtf8("/abort") ) && ( request->method() == QHttpRequest::HTTP_POST ) ) {
+        appPTR->abortAnyProcessing();
+        response->writeHead(QHttpResponse::STATUS_OK);
+        response->end();
+    } else {
+        replyError( response, QHttpResponse::STATUS_NOT_FOUND, tr("Unknown request %1").arg(path) );
+    }
+}
+
+void
+RenderWorkerServer::startRenderJob(QHttpRequest* request,
+                                   QHttpResponse* response)
+{
+    AppInstancePtr app = appPTR->getTopLevelInstance();
+
+    if (!app) {
+        replyError( response, QHttpResponse::STATUS_INTERNAL_SERVER_ERROR, tr("No application instance") );
+
+        return;
+    }
+
+    const QString projectPath = request->header( QString::fromUtf8(kWorkerProjectHeader) );
+    if ( projectPath.isEmpty() ) {
+        replyError( response, QHttpResponse::STATUS_BAD_REQUEST, tr("Missing the %1 header").arg( QString::fromUtf8(kWorkerProjectHeader) ) );
+
+        return;
+    }
+
+    // Only load the project when it changed: this is what keeps the worker warm between
+    // chunks of the same farm task, subsequent jobs reuse the loaded node graph and the
+    // images already in the caches.
+    if (projectPath != _imp->loadedProjectPath) {
+        if ( !app->loadProject( projectPath.toStdString() ) ) {
+            _imp->loadedProjectPath.clear();
+            replyError( response, QHttpResponse::STATUS_INTERNAL_SERVER_ERROR, tr("Could not load project %1").arg(projectPath) );
+
+            return;
+        }
+        _imp->loadedProjectPath = projectPath;
+    }
+
+    // The writers to render, all of them when the header is omitted
+    std::list<std::string> writers;
+    {
+        const QString writersStr = request->header( QString::fromUtf8(kWorkerWriterHeader) );
+        if ( !writersStr.isEmpty() ) {
+            QStringList splits = writersStr.split( QLatin1Char(',') );
+            Q_FOREACH(const QString &s, splits) {
+                writers.push_back( s.trimmed().toStdString() );
+            }
+        }
+    }
+
+    // The frame range, formatted as with the -w command line option
+    std::list<std::pair<int, std::pair<int, int> > > frameRanges;
+    {
+        QString rangeStr = request->header( QString::fromUtf8(kWorkerFrameRangeHeader) );
+        if ( !rangeStr.isEmpty() ) {
+            int frameStep = INT_MIN;
+            int foundStep = rangeStr.lastIndexOf( QLatin1Char(':') );
+            if (foundStep != -1) {
+                frameStep = rangeStr.mid(foundStep + 1).toInt();
+                rangeStr = rangeStr.mid(0, foundStep);
+            }
+            bool ok = false;
+            std::pair<int, int> range;
+            int singleFrame = rangeStr.toInt(&ok);
+            if (ok) {
+                range.first = range.second = singleFrame;
+            } else {
+                QStringList splits = rangeStr.split( QLatin1Char('-') );
+                if (splits.size() == 2) {
+                    bool firstOk, lastOk;
+                    range.first = splits[0].trimmed().toInt(&firstOk);
+                    range.second = splits[1].trimmed().toInt(&lastOk);
+                    ok = firstOk && lastOk;
+                }
+            }
+            if (!ok) {
+                replyError( response, QHttpResponse::STATUS_BAD_REQUEST, tr("Wrong formating for the %1 header").arg( QString::fromUtf8(kWorkerFrameRangeHeader) ) );
+
+                return;
+            }
+            frameRanges.push_back( std::make_pair(frameStep, range) );
+        }
+    }
+
+    std::list<RenderQueue::RenderWork> requests;
+    try {
+        app->getRenderQueue()->createRenderRequestsFromCommandLineArgs(false /*enableRenderStats*/, writers, frameRanges, requests);
+    } catch (const std::exception& e) {
+        replyError( response, QHttpResponse::STATUS_BAD_REQUEST, QString::fromUtf8( e.what() ) );
+
+        return;
+    }
+
+    if ( requests.empty() ) {
+        replyError( response, QHttpResponse::STATUS_BAD_REQUEST, tr("The project has no writer to render") );
+
+        return;
+    }
+
+    _imp->activeResponse = response;
+    _imp->nPendingRenders = (int)requests.size();
+    _imp->worstRetCode = 0;
+    QObject::connect( response, SIGNAL(done()), this, SLOT(onActiveResponseDone()) );
+
+    // Stream per-frame status: one chunk per rendered frame, see onFrameRendered()
+    response->setHeader( QString::fromUtf8("Transfer-Encoding"), QString::fromUtf8("chunked") );
+    response->setHeader( QString::fromUtf8("Content-Type"), QString::fromUtf8("application/octet-stream") );
+    response->writeHead(QHttpResponse::STATUS_OK);
+
+    for (std::list<RenderQueue::RenderWork>::const_iterator it = requests.begin(); it != requests.end(); ++it) {
+        RenderEnginePtr engine = it->treeRoot->getRenderEngine();
+        if (engine) {
+            QObject::connect( engine.get(), SIGNAL(frameRendered(int,double)), this, SLOT(onFrameRendered(int,double)), Qt::UniqueConnection );
+            QObject::connect( engine.get(), SIGNAL(renderFinished(int)), this, SLOT(onEngineRenderFinished(int)), Qt::UniqueConnection );
+            _imp->activeEngines.push_back(engine);
+        }
+    }
+
+    app->getRenderQueue()->renderNonBlocking(requests);
+} // startRenderJob
+
+void
+RenderWorkerServer::onFrameRendered(int time,
+                                    double progress)
+{
+    if (!_imp->activeResponse) {
+        return;
+    }
+    QString message = QString::fromUtf8(kFrameRenderedStringShort) + QString::number(time)
+                      + QString::fromUtf8(kProgressChangedStringShort) + QString::number(progress) + QLatin1Char('\n');
+    _imp->activeResponse->write( message.toUtf8() );
+}
+
+void
+RenderWorkerServer::onEngineRenderFinished(int retCode)
+{
+    if (!_imp->activeResponse) {
+        return;
+    }
+    _imp->worstRetCode = std::max(_imp->worstRetCode, retCode);
+    if (--_imp->nPendingRenders > 0) {
+        return;
+    }
+
+    // All writers of the job finished: terminate the chunked response
+    for (std::list<RenderEnginePtr>::const_iterator it = _imp->activeEngines.begin(); it != _imp->activeEngines.end(); ++it) {
+        QObject::disconnect(it->get(), 0, this, 0);
+    }
+    _imp->activeEngines.clear();
+
+    QHttpResponse* response = _imp->activeResponse;
+
+    // Cleared before end() so that the done() signal is not interpreted as a client disconnection
+    _imp->activeResponse = 0;
+
+    QString message = QString::fromUtf8(kRenderingFinishedStringShort) + QLatin1Char(' ') + QString::number(_imp->worstRetCode) + QLatin1Char('\n');
+    response->end( message.toUtf8() );
+}
+
+void
+RenderWorkerServer::onActiveResponseDone()
+{
+    // Only emitted with activeResponse still set when the client disconnected mid-render
+    if ( !_imp->activeResponse || ( sender() != _imp->activeResponse ) ) {
+        return;
+    }
+    _imp->activeResponse = 0;
+    for (std::list<RenderEnginePtr>::const_iterator it = _imp->activeEngines.begin(); it != _imp->activeEngines.end(); ++it) {
+        QObject::disconnect(it->get(), 0, this, 0);
+    }
+    _imp->activeEngines.clear();
+    appPTR->abortAnyProcessing();
+}
+
+void
+RenderWorkerServer::replyError(QHttpResponse* response,
+                               int statusCode,
+                               const QString& message)
+{
+    response->writeHead(statusCode);
+    response->end( message.toUtf8() + "\n" );
+}
+
+NATRON_NAMESPACE_EXIT;
@@ -0,0 +1,140 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2013-2017 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef NATRON_ENGINE_RENDERWORKERSERVER_H
+#define NATRON_ENGINE_RENDERWORKERSERVER_H
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/scoped_ptr.hpp>
+#endif
+
+CLANG_DIAG_OFF(deprecated)
+#include <QtCore/QObject>
+CLANG_DIAG_ON(deprecated)
+
+#include "Global/GlobalDefines.h"
+
+#include "Engine/EngineFwd.h"
+
+// Request headers of the POST /render route, see RenderWorkerServer
+#define kWorkerProjectHeader "x-natron-project"
+#define kWorkerWriterHeader "x-natron-writer"
+#define kWorkerFrameRangeHeader "x-natron-frame-range"
+
+class QHttpRequest;
+class QHttpResponse;
+
+NATRON_NAMESPACE_ENTER;
+
+struct RenderWorkerServerPrivate;
+
+/**
+ * @brief The HTTP server backing the --worker mode of NatronRenderer, used by render
+ * farms. A worker process stays alive between render jobs, so farm tasks do not pay
+ * the process startup (plug-in loading, cache opening) once per chunk of frames, and
+ * consecutive chunks of the same project reuse the loaded project and the warm caches.
+ *
+ * The protocol is built on the in-tree qhttpserver (also used by the documentation
+ * server, see Gui/DocumentationManager):
+ *
+ * - GET /status: returns a single line with the application name/version, the loaded
+ *   project (if any) and whether a job is running.
+ *
+ * - POST /render: assigns a chunk of frames to the worker. The request headers are:
+ *     - kWorkerProjectHeader (required): path of the project file to render. The
+ *       project is only (re)loaded when it differs from the currently loaded one.
+ *     - kWorkerWriterHeader (optional): comma separated script names of the Write
+ *       nodes to render, all of them when omitted.
+ *     - kWorkerFrameRangeHeader (optional): frame range formatted as with the -w
+ *       command line option ("<first>-<last>", "<first>-<last>:<step>" or a single
+ *       frame), the frame range of the writer knobs when omitted.
+ *   The response is chunked: one chunk per rendered frame carrying the same short
+ *   message as the ProcessHandler pipe (kFrameRenderedStringShort followed by the
+ *   frame then kProgressChangedStringShort and the progress), and a final chunk with
+ *   kRenderingFinishedStringShort and the return code (0 on success) terminating the
+ *   job. A 503 is returned if a job is already running.
+ *
+ * - POST /abort: aborts the running job, which terminates its response.
+ **/
+class RenderWorkerServer
+    : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * @brief Creates the server and starts listening on the given TCP port.
+     * isListening() returns false if the port could not be bound.
+     **/
+    RenderWorkerServer(int port);
+
+    virtual ~RenderWorkerServer();
+
+    bool isListening() const;
+
+public Q_SLOTS:
+
+    /**
+     * @brief Called by the http server whenever a request is received. The request is
+     * processed in onRequestEnd() once its body was fully received.
+     **/
+    void onNewRequest(QHttpRequest* request, QHttpResponse* response);
+
+    /**
+     * @brief Called when the body of a request was fully received: routes the request.
+     **/
+    void onRequestEnd();
+
+    /**
+     * @brief Connected to the frameRendered() signal of the render engine of each
+     * writer of the running job, streams a chunk to the client.
+     **/
+    void onFrameRendered(int time, double progress);
+
+    /**
+     * @brief Connected to the renderFinished() signal of the render engine of each
+     * writer of the running job, ends the response once all writers finished.
+     **/
+    void onEngineRenderFinished(int retCode);
+
+    /**
+     * @brief Called if the client of the running job disconnects: aborts the render.
+     **/
+    void onActiveResponseDone();
+
+private:
+
+    void startRenderJob(QHttpRequest* request, QHttpResponse* response);
+
+    void replyError(QHttpResponse* response, int statusCode, const QString& message);
+
+    boost::scoped_ptr<RenderWorkerServerPrivate> _imp;
+};
+
+NATRON_NAMESPACE_EXIT;
+
+#endif // NATRON_ENGINE_RENDERWORKERSERVER_H
@@ -25,7 +25,9 @@
 #include "RotoBezierTriangulation.h"
 
 #include <QDebug>
+#include <QMutex>
 #include <cmath>
+#include <map>
 #include <set>
 #include <boost/cstdint.hpp> // uintptr_t
 #include <cstddef> // size_t
@@ -1161,6 +1163,46 @@ static void originalPolygonCopy(PolygonCSGData& data,
 }
 
 
+// Tesselating is expensive: the winding pre-pass and the CSG of the feather and bezier polygons
+// both run libtess over the full discretized polygons. Since the inner/outter classification is
+// global to the shape (it depends on windings and self-intersections), the mesh cannot soundly be
+// patched locally when a single control point moves: instead, memoize the last tesselation of
+// each Bezier, keyed on the discretized polygons themselves. Anything that did not actually
+// change the polygons (another motion blur division of a non-animated shape, repeated redraws
+// during interaction, successive renders of a static frame) then re-uses the previous mesh, and
+// the cost of an edit reduces to discretizing the polygons plus one comparison.
+struct TesselationCacheEntry
+{
+    // The discretized polygons from which the mesh below was computed
+    std::vector<ParametricPoint> bezierPolygon, featherPolygon;
+    bool clockWise;
+
+    RotoBezierTriangulation::PolygonData data;
+};
+
+typedef boost::shared_ptr<TesselationCacheEntry> TesselationCacheEntryPtr;
+
+static bool
+isSamePolygon(const std::vector<ParametricPoint>& a,
+              const std::vector<ParametricPoint>& b)
+{
+    if ( a.size() != b.size() ) {
+        return false;
+    }
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        if ( (a[i].x != b[i].x) || (a[i].y != b[i].y) || (a[i].t != b[i].t) ) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// One entry per Bezier (keyed on the main instance so all render clones share it), protected by
+// a mutex. Expired entries are purged whenever an entry is stored.
+static QMutex tesselationCacheMutex;
+static std::map<BezierWPtr, TesselationCacheEntryPtr> tesselationCache;
+
 NATRON_NAMESPACE_ANONYMOUS_EXIT;
 
 
@@ -1209,6 +1251,29 @@ RotoBezierTriangulation::tesselate(const BezierPtr& bezier,
     data.bezierBbox.debug();*/
 #endif
 
+    // All render clones share the cache entry of their main instance
+    BezierPtr cacheKey = bezier;
+    {
+        BezierPtr mainInstance = toBezier( bezier->getMainInstance() );
+        if (mainInstance) {
+            cacheKey = mainInstance;
+        }
+    }
+
+    // If the discretized polygons did not change since the last tesselation of this Bezier,
+    // re-use the previous mesh: see the comment on TesselationCacheEntry.
+    {
+        QMutexLocker k(&tesselationCacheMutex);
+        std::map<BezierWPtr, TesselationCacheEntryPtr>::const_iterator found = tesselationCache.find(cacheKey);
+        if ( found != tesselationCache.end() ) {
+            const TesselationCacheEntryPtr& entry = found->second;
+            if ( (entry->clockWise == clockWise) && isSamePolygon(entry->bezierPolygon, bezierPolygonOrig) && isSamePolygon(entry->featherPolygon, featherPolygonOrig) ) {
+                *outArgs = entry->data;
+
+                return;
+            }
+        }
+    }
 
     // Copy the feather and bezier polygon and introduce a isInner flag to determine if a point should be drawn with an inside color (full opacity) or outter
     // color (black)
@@ -1228,6 +1293,28 @@ RotoBezierTriangulation::tesselate(const BezierPtr& bezier,
     // Now that we have the role (inner or outter) for each vertex, compute the feather mesh
     computeFeatherTriangles(data, outArgs);
 
+    // Store the result in the cache, purging entries of deleted Beziers on the way
+    {
+        TesselationCacheEntryPtr entry( new TesselationCacheEntry() );
+        entry->bezierPolygon = bezierPolygonOrig;
+        entry->featherPolygon = featherPolygonOrig;
+        entry->clockWise = clockWise;
+        entry->data = *outArgs;
+
+        QMutexLocker k(&tesselationCacheMutex);
+        for (std::map<BezierWPtr, TesselationCacheEntryPtr>::iterator it = tesselationCache.begin(); it != tesselationCache.end();) {
+            if ( it->first.expired() ) {
+                std::map<BezierWPtr, TesselationCacheEntryPtr>::iterator next = it;
+                ++next;
+                tesselationCache.erase(it);
+                it = next;
+            } else {
+                ++it;
+            }
+        }
+        tesselationCache[cacheKey] = entry;
+    }
+
 } // tesselate
 
 
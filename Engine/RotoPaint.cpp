@@ -3703,10 +3703,9 @@ RotoPaintPrivate::isRotoPaintTreeConcatenatableInternal(const std::list<RotoDraw
 
         MergingFunctionEnum op = (MergingFunctionEnum)(*it)->getOperatorKnob()->getValue();
 
-        // Can only concatenate with over
-        if (op != eMergeOver) {
-            return false;
-        }
+        // Any operator can concatenate as long as it is the same for all items: the global Merge
+        // node stacks its A inputs onto B with the same operator in render order, which is exactly
+        // what the chain of per-item Merge nodes computes, one full-image pass per item.
 
         if (!operatorSet) {
             operatorSet = true;
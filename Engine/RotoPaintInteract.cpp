@@ -25,6 +25,8 @@
 
 #include "RotoPaintPrivate.h"
 
+#include <algorithm>
+
 #include <QtCore/QLineF>
 
 #include "Global/GLIncludes.h"
@@ -1891,12 +1893,39 @@ RotoPaintInteract::drawOverlay(TimeValue time,
 #endif
                 bool finished = isBezier->isCurveFinished(view);
 
-                std::vector< ParametricPoint > points;
-                isBezier->evaluateAtTime(time, view, RenderScale(1.), Bezier::eDeCasteljauAlgorithmIterative, 100, 1., &points, NULL);
-                if (!points.empty() && finished) {
-                    // Repeat the last point so that we can use line strips
-                    points.push_back(points.front());
+                // The shape and feather polygons are tessellated with 100 points per
+                // segment, which dominates the overlay drawing time on complex shapes.
+                // Retain the tessellation across redraws and only re-compute it when the
+                // item hash changes.
+                U64 itemHash;
+                {
+                    HashableObject::ComputeHashArgs hashArgs;
+                    hashArgs.hashType = HashableObject::eComputeHashTypeTimeViewVariant;
+                    hashArgs.time = time;
+                    hashArgs.view = view;
+                    itemHash = isBezier->computeHash(hashArgs);
+                }
+                BezierOverlayGeometry& geom = overlayGeometryCache[isBezier];
+                if ( (geom.itemHash != itemHash) || (featherVisible && !geom.hasFeather) ) {
+                    geom.shapePoints.clear();
+                    isBezier->evaluateAtTime(time, view, RenderScale(1.), Bezier::eDeCasteljauAlgorithmIterative, 100, 1., &geom.shapePoints, NULL);
+                    if (!geom.shapePoints.empty() && finished) {
+                        // Repeat the last point so that we can use line strips
+                        geom.shapePoints.push_back( geom.shapePoints.front() );
+                    }
+
+                    geom.featherPoints.clear();
+                    geom.hasFeather = featherVisible;
+                    if (featherVisible) {
+                        isBezier->evaluateFeatherPointsAtTime(false /*applyFeatherDistance*/, time, view, RenderScale(1.), Bezier::eDeCasteljauAlgorithmIterative, 100, 1., &geom.featherPoints, NULL);
+                        if ( !geom.featherPoints.empty() && finished ) {
+                            // Repeat the last point so that we can use line strips
+                            geom.featherPoints.push_back( geom.featherPoints.front() );
+                        }
+                    }
+                    geom.itemHash = itemHash;
                 }
+                const std::vector< ParametricPoint >& points = geom.shapePoints;
 
                 bool locked = (*it)->isLockedRecursive();
                 ColorRgbaD overlayColor(0.8, 0.8, 0.8, 1.);
@@ -1916,19 +1945,13 @@ RotoPaintInteract::drawOverlay(TimeValue time,
                 GL_GPU::End();
 
                 ///draw the feather points
-                std::vector< ParametricPoint > featherPoints;
+                const std::vector< ParametricPoint >& featherPoints = geom.featherPoints;
                 bool clockWise = isBezier->isClockwiseOriented(time, view);
 
 
                 if (featherVisible) {
                     ///Draw feather only if visible (button is toggled in the user interface)
-                    isBezier->evaluateFeatherPointsAtTime(false /*applyFeatherDistance*/, time, view, RenderScale(1.), Bezier::eDeCasteljauAlgorithmIterative, 100, 1., &featherPoints, NULL);
-
                     if ( !featherPoints.empty() && finished ) {
-                        // Repeat the last point so that we can use line strips
-                        featherPoints.push_back(featherPoints.front());
-
-
                         GL_GPU::LineStipple(2, 0xAAAA);
                         GL_GPU::Enable(GL_LINE_STIPPLE);
                         GL_GPU::Begin(GL_LINE_STRIP);
@@ -2155,6 +2178,16 @@ RotoPaintInteract::drawOverlay(TimeValue time,
             glCheckError(GL_GPU);
         } // for (std::list< RotoDrawableItemPtr >::const_iterator it = drawables.begin(); it != drawables.end(); ++it) {
 
+        // Trim retained geometry of items that are no longer displayed
+        for (std::map<BezierWPtr, BezierOverlayGeometry>::iterator it = overlayGeometryCache.begin(); it != overlayGeometryCache.end();) {
+            BezierPtr cachedItem = it->first.lock();
+            if ( !cachedItem || ( std::find(drawables.begin(), drawables.end(), cachedItem) == drawables.end() ) ) {
+                overlayGeometryCache.erase(it++);
+            } else {
+                ++it;
+            }
+        }
+
 
 
         if ( (_imp->nodeType == RotoPaint::eRotoPaintTypeRotoPaint || _imp->nodeType == RotoPaint::eRotoPaintTypeRoto) &&
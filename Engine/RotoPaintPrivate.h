@@ -28,6 +28,8 @@
 #include "Global/Macros.h"
 
 #include <list>
+#include <map>
+#include <vector>
 #if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
 #include <boost/enable_shared_from_this.hpp>
 #endif
@@ -968,6 +970,30 @@ public:
     bool lastTabletDownTriggeredEraser;
     QPointF mouseCenterOnSizeChange;
 
+    /**
+     * @brief Tessellated overlay geometry of a bezier (shape polygon and optionally the
+     * feather polygon), retained across overlay redraws and re-computed only when the
+     * item hash changes.
+     **/
+    struct BezierOverlayGeometry
+    {
+        U64 itemHash;
+        bool hasFeather;
+        std::vector<ParametricPoint> shapePoints;
+        std::vector<ParametricPoint> featherPoints;
+
+        BezierOverlayGeometry()
+        : itemHash(0)
+        , hasFeather(false)
+        , shapePoints()
+        , featherPoints()
+        {
+        }
+    };
+
+    // Cached overlay geometry for each displayed bezier
+    std::map<BezierWPtr, BezierOverlayGeometry> overlayGeometryCache;
+
 
     //////// Toolbar
     KnobPageWPtr toolbarPage;
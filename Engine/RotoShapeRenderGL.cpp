@@ -81,19 +81,6 @@ static const char* rotoDrawDot_VertexShader =
 ;
 
 
-static const char* roto_AccumulateShader =
-"uniform sampler2D sampleTex;\n"
-"uniform sampler2D accumTex;\n"
-"\n"
-"void main() {\n"
-"   vec4 sampleColor = texture2D(sampleTex,gl_TexCoord[0].st);\n"
-"   vec4 accumColor = texture2D(accumTex,gl_TexCoord[0].st);\n"
-"   gl_FragColor.r = accumColor.r + sampleColor.r;\n"
-"   gl_FragColor.g = accumColor.g + sampleColor.g;\n"
-"   gl_FragColor.b = accumColor.b + sampleColor.b;\n"
-"   gl_FragColor.a = accumColor.a + sampleColor.a;\n"
-"}";
-
 static const char* roto_DivideShader =
 "uniform sampler2D srcTex;\n"
 "uniform float nDivisions;\n"
@@ -199,9 +186,13 @@ RotoShapeRenderNodeOpenGLData::RotoShapeRenderNodeOpenGLData(bool isGPUContext)
 , _vboColorsID(0)
 , _vboHardnessID(0)
 , _vboTexID(0)
+, _vboInternalShapeID(0)
+, _bezierMeshShapeHash(0)
+, _bezierMeshScaleX(0)
+, _bezierMeshScaleY(0)
+, _bezierMeshValid(false)
 , _featherRampShader(5)
 , _strokeDotShader(2)
-, _accumShader()
 {
 
 }
@@ -236,6 +227,14 @@ RotoShapeRenderNodeOpenGLData::cleanup()
         }
     }
 
+    if (_vboInternalShapeID) {
+        if (isGPU) {
+            GL_GPU::DeleteBuffers(1, &_vboInternalShapeID);
+        } else {
+            GL_CPU::DeleteBuffers(1, &_vboInternalShapeID);
+        }
+    }
+
     if (_iboID) {
         if (isGPU) {
             GL_GPU::DeleteBuffers(1, &_iboID);
@@ -243,6 +242,7 @@ RotoShapeRenderNodeOpenGLData::cleanup()
             GL_CPU::DeleteBuffers(1, &_iboID);
         }
     }
+    _bezierMeshValid = false;
 }
 
 
@@ -322,6 +322,41 @@ RotoShapeRenderNodeOpenGLData::getOrCreateVBOTexID()
 
 }
 
+unsigned int
+RotoShapeRenderNodeOpenGLData::getOrCreateVBOInternalShapeID()
+{
+    if (!_vboInternalShapeID) {
+        if (isGPUContext()) {
+            GL_GPU::GenBuffers(1, &_vboInternalShapeID);
+        } else {
+            GL_CPU::GenBuffers(1, &_vboInternalShapeID);
+        }
+    }
+    return _vboInternalShapeID;
+
+}
+
+bool
+RotoShapeRenderNodeOpenGLData::isBezierMeshUploaded(U64 shapeHash, double scaleX, double scaleY) const
+{
+    return _bezierMeshValid && _bezierMeshShapeHash == shapeHash && _bezierMeshScaleX == scaleX && _bezierMeshScaleY == scaleY;
+}
+
+void
+RotoShapeRenderNodeOpenGLData::setBezierMeshUploaded(U64 shapeHash, double scaleX, double scaleY)
+{
+    _bezierMeshShapeHash = shapeHash;
+    _bezierMeshScaleX = scaleX;
+    _bezierMeshScaleY = scaleY;
+    _bezierMeshValid = true;
+}
+
+void
+RotoShapeRenderNodeOpenGLData::invalidateBezierMesh()
+{
+    _bezierMeshValid = false;
+}
+
 template <typename GL>
 static GLShaderBasePtr
 getOrCreateFeatherRampShaderInternal(RampTypeEnum type)
@@ -457,38 +492,6 @@ RotoShapeRenderNodeOpenGLData::getOrCreateStrokeDotShader(bool buildUp)
     return _strokeDotShader[index];
 }
 
-template <typename GL>
-static GLShaderBasePtr
-getOrCreateAccumShaderInternal()
-{
-    boost::shared_ptr<GLShader<GL> > shader( new GLShader<GL>() );
-    bool ok;
-    std::string fragmentSource;
-    fragmentSource += std::string(roto_AccumulateShader);
-#ifdef DEBUG
-    std::string error;
-    ok = shader->addShader(GLShader<GL>::eShaderTypeFragment, fragmentSource.c_str(), &error);
-    if (!ok) {
-        qDebug() << error.c_str();
-    }
-#else
-    ok = shader->addShader(GLShader<GL>::eShaderTypeFragment, fragmentSource.c_str(), 0);
-#endif
-    assert(ok);
-#ifdef DEBUG
-    ok = shader->link(&error);
-    if (!ok) {
-        qDebug() << error.c_str();
-    }
-#else
-    ok = shader->link();
-#endif
-    assert(ok);
-    Q_UNUSED(ok);
-
-    return shader;
-}
-
 template <typename GL>
 static GLShaderBasePtr
 getOrCreateDivideShaderInternal()
@@ -522,20 +525,6 @@ getOrCreateDivideShaderInternal()
     return shader;
 }
 
-GLShaderBasePtr
-RotoShapeRenderNodeOpenGLData::getOrCreateAccumulateShader()
-{
-    if (_accumShader) {
-        return _accumShader;
-    }
-    if (isGPUContext()) {
-        _accumShader = getOrCreateAccumShaderInternal<GL_GPU>();
-    } else {
-        _accumShader = getOrCreateAccumShaderInternal<GL_CPU>();
-    }
-    return _accumShader;
-}
-
 GLShaderBasePtr
 RotoShapeRenderNodeOpenGLData::getOrCreateDivideShader()
 {
@@ -716,7 +705,9 @@ void renderBezier_gl_singleDrawElements(int nbVertices, int nbIds, int vboVertic
     GL::ColorPointer(4, GL_FLOAT, 0, 0);
 
     GL::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, iboID);
-    GL::BufferData(GL_ELEMENT_ARRAY_BUFFER, nbIds * sizeof(GLuint), idsData, GL_DYNAMIC_DRAW);
+    if (uploadVertices) {
+        GL::BufferData(GL_ELEMENT_ARRAY_BUFFER, nbIds * sizeof(GLuint), idsData, GL_DYNAMIC_DRAW);
+    }
 
 
     GL::DrawElements(primitiveType, nbIds, GL_UNSIGNED_INT, 0);
@@ -755,12 +746,10 @@ void renderBezier_gl_multiDrawElements(int nbVertices, int vboVerticesID, unsign
 template <typename GL>
 void motionBlurEndSample(int nDivisions,
                          int d,
-                         const GLShaderBasePtr &accumShader,
                          const GLShaderBasePtr &copyShader,
                          int target,
                          const GLImageStoragePtr& perSampleRenderTexture,
                          const GLImageStoragePtr& accumulationTexture,
-                         const GLImageStoragePtr& tmpAccumulationCpy,
                          const RectI& roi)
 {
     GL::Disable(GL_BLEND);
@@ -769,57 +758,30 @@ void motionBlurEndSample(int nDivisions,
     // If motion-blur is enabled, we still have to accumulate, otherwise we are done.
     if (nDivisions > 1) {
 
-        if (d == 0) {
-            // On the first sample, just copy the sample to the accumulation texture as we need to initialize it.
-
-            GL::BindTexture( target, accumulationTexture->getGLTextureID() );
-            setupTexParams<GL>(target);
-            glCheckError(GL);
-            GL::FramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, target, accumulationTexture->getGLTextureID(), 0 /*LoD*/);
-            glCheckFramebufferError(GL);
-            glCheckError(GL);
-            GL::BindTexture( target, perSampleRenderTexture->getGLTextureID() );
-            copyShader->bind();
-            copyShader->setUniform("srcTex", 0);
-            OSGLContext::applyTextureMapping<GL>(roi, roi, roi);
-            copyShader->unbind();
-
-
-        } else {
-            // If this is not the first sample, duplicate the accumulation texture so we can read the duplicate in input and write to the
-            // accumulation texture in output.
-
-            GL::BindTexture( target, tmpAccumulationCpy->getGLTextureID() );
-            setupTexParams<GL>(target);
-            glCheckError(GL);
-            GL::FramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, target, tmpAccumulationCpy->getGLTextureID(), 0 /*LoD*/);
-            glCheckFramebufferError(GL);
-            glCheckError(GL);
-            GL::BindTexture( target, accumulationTexture->getGLTextureID() );
-            copyShader->bind();
-            copyShader->setUniform("srcTex", 0);
-            OSGLContext::applyTextureMapping<GL>(roi, roi, roi);
-            copyShader->unbind();
-
-
-            // Now do the accumulation
-            GL::BindTexture( target, accumulationTexture->getGLTextureID() );
-            setupTexParams<GL>(target);
-
-            GL::FramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, target, accumulationTexture->getGLTextureID(), 0 /*LoD*/);
-            glCheckFramebufferError(GL);
-
-            GL::ActiveTexture(GL_TEXTURE0);
-            GL::BindTexture( target, tmpAccumulationCpy->getGLTextureID() );
-            GL::ActiveTexture(GL_TEXTURE1);
-            GL::BindTexture( target, perSampleRenderTexture->getGLTextureID() );
-            accumShader->bind();
-            accumShader->setUniform("accumTex", 0);
-            accumShader->setUniform("sampleTex", 1);
-            OSGLContext::applyTextureMapping<GL>(roi, roi, roi);
-            accumShader->unbind();
-            GL::ActiveTexture(GL_TEXTURE0);
+        GL::BindTexture( target, accumulationTexture->getGLTextureID() );
+        setupTexParams<GL>(target);
+        glCheckError(GL);
+        GL::FramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, target, accumulationTexture->getGLTextureID(), 0 /*LoD*/);
+        glCheckFramebufferError(GL);
+        glCheckError(GL);
 
+        if (d > 0) {
+            // On the first sample, the copy initializes the accumulation texture. On subsequent
+            // samples, add the sample on top of it with additive blending: this way we never have
+            // to read the accumulation texture from a shader, which would require duplicating it
+            // to a temporary copy first since a texture cannot be bound both in input and in
+            // output of the same pass.
+            GL::Enable(GL_BLEND);
+            GL::BlendEquation(GL_FUNC_ADD);
+            GL::BlendFunc(GL_ONE, GL_ONE);
+        }
+        GL::BindTexture( target, perSampleRenderTexture->getGLTextureID() );
+        copyShader->bind();
+        copyShader->setUniform("srcTex", 0);
+        OSGLContext::applyTextureMapping<GL>(roi, roi, roi);
+        copyShader->unbind();
+        if (d > 0) {
+            GL::Disable(GL_BLEND);
         }
     } // nDivisions > 1
     glCheckError(GL);
@@ -882,6 +844,7 @@ renderBezier_gl_internal(const OSGLContextPtr& glContext,
     Q_UNUSED(roi);
     int vboVerticesID = glData->getOrCreateVBOVerticesID();
     int vboColorsID = glData->getOrCreateVBOColorsID();
+    int vboInternalShapeID = glData->getOrCreateVBOInternalShapeID();
     int iboID = glData->getOrCreateIBOID();
     int fboID = glContext->getOrCreateFBOId();
 
@@ -897,27 +860,46 @@ renderBezier_gl_internal(const OSGLContextPtr& glContext,
     }
     GLShaderBasePtr rampShader = glData->getOrCreateFeatherRampShader(type);
     GLShaderBasePtr fillShader = glContext->getOrCreateFillShader();
-    GLShaderBasePtr accumShader = glData->getOrCreateAccumulateShader();
     GLShaderBasePtr copyShader = glContext->getOrCreateCopyTexShader();
     GLShaderBasePtr divideShader = glData->getOrCreateDivideShader();
 
     // If we do more than 1 pass, do motion blur
     // When motion-blur is enabled, draw each sample to a temporary texture in a first pass.
     // On the first sample, just copy the sample texture to the accumulation texture.
-    // Then for other samples, copy the accumulation texture so we can read it in input
-    // and add the sample texture to the accumulation copy and write to the original accumulation texture.
+    // Then for other samples, add the sample texture to the accumulation texture with additive blending.
     // After the last sample, copy the accumulation texture to the dst framebuffer by dividing by the number of steps.
 
     double interval = nDivisions >= 1 ? (shutterRange.max - shutterRange.min) / nDivisions : 1.;
 
-    ImagePtr tmpTex[3];
-    GLImageStoragePtr perSampleRenderTexture, accumulationTexture, tmpAccumulationCpy;
+    // When not doing motion-blur, the mesh uploaded to the buffers only depends on the shape at
+    // the render time and on the render scale: if the buffers of this context still hold the very
+    // same mesh from a previous render, skip re-filling and re-uploading them and only issue the
+    // draw calls. During playback over a static shape this removes all buffer uploads.
+    bool reuseUploadedMesh = false;
+    if (nDivisions <= 1) {
+        HashableObject::ComputeHashArgs hashArgs;
+        hashArgs.time = time;
+        hashArgs.view = view;
+        hashArgs.hashType = HashableObject::eComputeHashTypeTimeViewVariant;
+        U64 shapeHash = bezier->computeHash(hashArgs);
+        reuseUploadedMesh = glData->isBezierMeshUploaded(shapeHash, scale.x, scale.y);
+        if (!reuseUploadedMesh) {
+            glData->setBezierMeshUploaded(shapeHash, scale.x, scale.y);
+        }
+    } else {
+        // Each motion-blur sample uploads its own mesh: whatever ends up in the buffers
+        // does not correspond to the shape at the render time.
+        glData->invalidateBezierMesh();
+    }
+
+    ImagePtr tmpTex[2];
+    GLImageStoragePtr perSampleRenderTexture, accumulationTexture;
     if (nDivisions > 1) {
 
-        GLImageStoragePtr *tmpGLEntry[3] = {&perSampleRenderTexture, &accumulationTexture, &tmpAccumulationCpy};
+        GLImageStoragePtr *tmpGLEntry[2] = {&perSampleRenderTexture, &accumulationTexture};
 
         // Make 2 textures of the same size as the dst image.
-        for (int i = 0; i < 3; ++i) {
+        for (int i = 0; i < 2; ++i) {
 
             Image::InitStorageArgs initArgs;
             initArgs.bounds = roi;
@@ -985,44 +967,45 @@ renderBezier_gl_internal(const OSGLContextPtr& glContext,
 
             int nbIds = data.featherTriangles.size();
 
-
-            verticesArray.resize(nbVertices * 2);
-            colorsArray.resize(nbVertices * 4);
-            indicesArray.resize(nbIds);
-
-            // Fill buffer
-            float* v_data = verticesArray.getData();
-            float* c_data = colorsArray.getData();
-            unsigned int* i_data = indicesArray.getData();
-
-            for (std::size_t i = 0; i < data.featherVertices.size(); ++i,
-                 v_data += 2,
-                 c_data += 4) {
-
-                v_data[0] = data.featherVertices[i].x;
-                v_data[1] = data.featherVertices[i].y;
-
-                // The roi was computed from the RoD, it must include the feather points.
-                // If this crashes here, this is likely because either the computation of the RoD is wrong
-                // or the Knobs of the Bezier have changed since the RoD computation or the Bezier shape itself
-                // has changed since the RoD computation. In all cases datas should remain the same thoughout the render
-                // since we are operating on a thread-local render clone.
-                assert(roi.contains(v_data[0], v_data[1]));
-
-                c_data[0] = 1;
-                c_data[1] = 1;
-                c_data[2] = 1;
-                if (data.featherVertices[i].isInner) {
-                    c_data[3] = 1.;
-                } else {
-                    c_data[3] = 0.;
+            if (!reuseUploadedMesh) {
+                verticesArray.resize(nbVertices * 2);
+                colorsArray.resize(nbVertices * 4);
+                indicesArray.resize(nbIds);
+
+                // Fill buffer
+                float* v_data = verticesArray.getData();
+                float* c_data = colorsArray.getData();
+                unsigned int* i_data = indicesArray.getData();
+
+                for (std::size_t i = 0; i < data.featherVertices.size(); ++i,
+                     v_data += 2,
+                     c_data += 4) {
+
+                    v_data[0] = data.featherVertices[i].x;
+                    v_data[1] = data.featherVertices[i].y;
+
+                    // The roi was computed from the RoD, it must include the feather points.
+                    // If this crashes here, this is likely because either the computation of the RoD is wrong
+                    // or the Knobs of the Bezier have changed since the RoD computation or the Bezier shape itself
+                    // has changed since the RoD computation. In all cases datas should remain the same thoughout the render
+                    // since we are operating on a thread-local render clone.
+                    assert(roi.contains(v_data[0], v_data[1]));
+
+                    c_data[0] = 1;
+                    c_data[1] = 1;
+                    c_data[2] = 1;
+                    if (data.featherVertices[i].isInner) {
+                        c_data[3] = 1.;
+                    } else {
+                        c_data[3] = 0.;
+                    }
                 }
-            }
 
-            for (std::size_t i = 0; i < data.featherTriangles.size(); ++i, ++i_data) {
-                *i_data = data.featherTriangles[i];
+                for (std::size_t i = 0; i < data.featherTriangles.size(); ++i, ++i_data) {
+                    *i_data = data.featherTriangles[i];
+                }
             }
-            renderBezier_gl_singleDrawElements<GL>(nbVertices, nbIds, vboVerticesID, vboColorsID, iboID, GL_TRIANGLES, (const void*)verticesArray.getData(), (const void*)colorsArray.getData(), (const void*)indicesArray.getData());
+            renderBezier_gl_singleDrawElements<GL>(nbVertices, nbIds, vboVerticesID, vboColorsID, iboID, GL_TRIANGLES, (const void*)verticesArray.getData(), (const void*)colorsArray.getData(), (const void*)indicesArray.getData(), !reuseUploadedMesh);
 
         }
 
@@ -1043,13 +1026,13 @@ renderBezier_gl_internal(const OSGLContextPtr& glContext,
             continue;
         }
 
-        verticesArray.resize(nbVertices * 2);
+        if (!reuseUploadedMesh) {
+            verticesArray.resize(nbVertices * 2);
 
 
-        // Fill the vertices buffer with all the points of the internal shape polygon
-        // Each 3 pass of render (the triangles pass, the triangles fan pass, and the triangles strip pass)
-        // will reference these vertices.
-        {
+            // Fill the vertices buffer with all the points of the internal shape polygon
+            // Each 3 pass of render (the triangles pass, the triangles fan pass, and the triangles strip pass)
+            // will reference these vertices.
             float* v_data = verticesArray.getData();
 
             for (std::vector<Point>::const_iterator it2 = data.internalShapeVertices.begin(); it2 != data.internalShapeVertices.end(); ++it2, v_data += 2) {
@@ -1061,7 +1044,7 @@ renderBezier_gl_internal(const OSGLContextPtr& glContext,
             }
 
         }
-        bool hasUploadedVertices = false;
+        bool hasUploadedVertices = reuseUploadedMesh;
         {
             // Render internal triangles
             // Merge all set of GL_TRIANGLES into a single call of glMultiDrawElements
@@ -1075,7 +1058,7 @@ renderBezier_gl_internal(const OSGLContextPtr& glContext,
                     perDrawCount[i] = (int)data.internalShapeTriangles[i].size();
                 }
 
-                renderBezier_gl_multiDrawElements<GL>(nbVertices, vboVerticesID, GL_TRIANGLES, (const void*)verticesArray.getData(), (const int*)&perDrawCount[0], (const void**)(&perDrawsIDVec[0]), drawCount);
+                renderBezier_gl_multiDrawElements<GL>(nbVertices, vboInternalShapeID, GL_TRIANGLES, (const void*)verticesArray.getData(), (const int*)&perDrawCount[0], (const void**)(&perDrawsIDVec[0]), drawCount, !hasUploadedVertices);
 
                 hasUploadedVertices = true;
 
@@ -1095,7 +1078,7 @@ renderBezier_gl_internal(const OSGLContextPtr& glContext,
                     perDrawsIDVec[i] = (const void*)(&data.internalShapeTriangleFans[i][0]);
                     perDrawCount[i] = (int)data.internalShapeTriangleFans[i].size();
                 }
-                renderBezier_gl_multiDrawElements<GL>(nbVertices, vboVerticesID, GL_TRIANGLE_FAN, (const void*)verticesArray.getData(), (const int*)&perDrawCount[0], (const void**)(&perDrawsIDVec[0]), drawCount, !hasUploadedVertices);
+                renderBezier_gl_multiDrawElements<GL>(nbVertices, vboInternalShapeID, GL_TRIANGLE_FAN, (const void*)verticesArray.getData(), (const int*)&perDrawCount[0], (const void**)(&perDrawsIDVec[0]), drawCount, !hasUploadedVertices);
                 hasUploadedVertices = true;
             }
 
@@ -1112,14 +1095,14 @@ renderBezier_gl_internal(const OSGLContextPtr& glContext,
                     perDrawsIDVec[i] = (const void*)(&data.internalShapeTriangleStrips[i][0]);
                     perDrawCount[i] = (int)data.internalShapeTriangleStrips[i].size();
                 }
-                renderBezier_gl_multiDrawElements<GL>(nbVertices, vboVerticesID, GL_TRIANGLE_STRIP, (const void*)verticesArray.getData(), (const int*)&perDrawCount[0], (const void**)(&perDrawsIDVec[0]), drawCount, !hasUploadedVertices);
+                renderBezier_gl_multiDrawElements<GL>(nbVertices, vboInternalShapeID, GL_TRIANGLE_STRIP, (const void*)verticesArray.getData(), (const int*)&perDrawCount[0], (const void**)(&perDrawsIDVec[0]), drawCount, !hasUploadedVertices);
                 hasUploadedVertices = true;
             }
             
         }
         Q_UNUSED(hasUploadedVertices);
         glCheckError(GL);
-        motionBlurEndSample<GL>(nDivisions, d, accumShader, copyShader, target, perSampleRenderTexture, accumulationTexture, tmpAccumulationCpy, roi);
+        motionBlurEndSample<GL>(nDivisions, d, copyShader, target, perSampleRenderTexture, accumulationTexture, roi);
 
     } // for all samples
 
@@ -1731,30 +1714,28 @@ RotoShapeRenderGL::renderStroke_gl(const OSGLContextPtr& glContext,
     *distToNextOut = distToNextIn;
     *lastCenterPointOut = lastCenterPointIn;
 
-    GLShaderBasePtr accumShader = glData->getOrCreateAccumulateShader();
     GLShaderBasePtr copyShader = glContext->getOrCreateCopyTexShader();
     GLShaderBasePtr divideShader = glData->getOrCreateDivideShader();
 
     // If we do more than 1 pass, do motion blur
     // When motion-blur is enabled, draw each sample to a temporary texture in a first pass.
     // On the first sample, just copy the sample texture to the accumulation texture.
-    // Then for other samples, copy the accumulation texture so we can read it in input
-    // and add the sample texture to the accumulation copy and write to the original accumulation texture.
+    // Then for other samples, add the sample texture to the accumulation texture with additive blending.
     // After the last sample, copy the accumulation texture to the dst framebuffer by dividing by the number of steps.
 
-    
+
     double interval = nDivisions >= 1 ? (shutterRange.max - shutterRange.min) / nDivisions : 1.;
 
     int target = GL_TEXTURE_2D;
 
-    ImagePtr tmpTex[3];
-    GLImageStoragePtr perSampleRenderTexture, accumulationTexture, tmpAccumulationCpy;
+    ImagePtr tmpTex[2];
+    GLImageStoragePtr perSampleRenderTexture, accumulationTexture;
     if (nDivisions > 1) {
 
-        GLImageStoragePtr *tmpGLEntry[3] = {&perSampleRenderTexture, &accumulationTexture, &tmpAccumulationCpy};
+        GLImageStoragePtr *tmpGLEntry[2] = {&perSampleRenderTexture, &accumulationTexture};
 
         // Make 2 textures of the same size as the dst image.
-        for (int i = 0; i < 3; ++i) {
+        for (int i = 0; i < 2; ++i) {
 
             Image::InitStorageArgs initArgs;
             initArgs.bounds = roi;
@@ -1830,9 +1811,9 @@ RotoShapeRenderGL::renderStroke_gl(const OSGLContextPtr& glContext,
                                                          lastCenterPointOut);
 
         if (glContext->isGPUContext()) {
-            motionBlurEndSample<GL_GPU>(nDivisions, d, accumShader, copyShader, target, perSampleRenderTexture, accumulationTexture, tmpAccumulationCpy, roi);
+            motionBlurEndSample<GL_GPU>(nDivisions, d, copyShader, target, perSampleRenderTexture, accumulationTexture, roi);
         } else {
-            motionBlurEndSample<GL_CPU>(nDivisions, d, accumShader, copyShader, target, perSampleRenderTexture, accumulationTexture, tmpAccumulationCpy, roi);
+            motionBlurEndSample<GL_CPU>(nDivisions, d, copyShader, target, perSampleRenderTexture, accumulationTexture, roi);
         }
 
     } // for each sample
@@ -79,10 +79,16 @@ class RotoShapeRenderNodeOpenGLData : public EffectOpenGLContextData
     unsigned int _vboColorsID;
     unsigned int _vboHardnessID;
     unsigned int _vboTexID;
+    unsigned int _vboInternalShapeID;
+
+    // Identify the bezier mesh currently uploaded to the buffers above so that
+    // playback over a static shape does not re-upload the same mesh every frame
+    U64 _bezierMeshShapeHash;
+    double _bezierMeshScaleX, _bezierMeshScaleY;
+    bool _bezierMeshValid;
 
     std::vector<GLShaderBasePtr> _featherRampShader;
     std::vector<GLShaderBasePtr> _strokeDotShader;
-    GLShaderBasePtr _accumShader;
     GLShaderBasePtr _strokeDotSecondPassShader;
     GLShaderBasePtr _smearShader;
     GLShaderBasePtr _divideShader;
@@ -103,9 +109,26 @@ public:
 
     unsigned int getOrCreateVBOTexID();
 
-    GLShaderBasePtr getOrCreateFeatherRampShader(RampTypeEnum type);
+    unsigned int getOrCreateVBOInternalShapeID();
+
+    /**
+     * @brief Returns whether the vertex/index buffers still hold the mesh of the shape
+     * identified by the given hash at the given render scale.
+     **/
+    bool isBezierMeshUploaded(U64 shapeHash, double scaleX, double scaleY) const;
 
-    GLShaderBasePtr getOrCreateAccumulateShader();
+    /**
+     * @brief Remember which shape mesh was last uploaded to the vertex/index buffers.
+     **/
+    void setBezierMeshUploaded(U64 shapeHash, double scaleX, double scaleY);
+
+    /**
+     * @brief To be called whenever the buffers content no longer corresponds to the shape
+     * at the render time, e.g: when motion-blur uploads one mesh per sample.
+     **/
+    void invalidateBezierMesh();
+
+    GLShaderBasePtr getOrCreateFeatherRampShader(RampTypeEnum type);
 
     GLShaderBasePtr getOrCreateDivideShader();
 
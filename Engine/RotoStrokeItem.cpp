@@ -138,6 +138,15 @@ struct RotoStrokeItemPrivate
     // in the copy ctor.
     mutable RectD lastStrokeStepBbox;
 
+    // While drawing, bounding box and hash of the whole stroke so far, maintained
+    // incrementally across draw steps: each step only folds in the points added since
+    // the previous step, so that setting up a draw step render stays O(1) in the number
+    // of points already drawn.
+    // Mutable since they are updated from the copy ctor of the render clone
+    mutable RectD drawingFullStrokeBbox;
+    mutable U64 drawingStrokesHash;
+    mutable bool drawingIncrementalDataValid;
+
     // Used only when drawing: Index in the xCurve, yCurve, pressureCurve of the last point (included)
     // that was drawn by a previous draw step.
     // This is used when creating a render clone for this stroke in the copy ctor to only
@@ -184,6 +193,9 @@ struct RotoStrokeItemPrivate
     , renderCachedBbox()
     , renderCachedHash()
     , lastStrokeStepBbox()
+    , drawingFullStrokeBbox()
+    , drawingStrokesHash(0)
+    , drawingIncrementalDataValid(false)
     , lastPointIndexInSubStroke(-1)
     , pickupPointIndexInSubStroke(0)
     , currentSubStroke(0)
@@ -343,12 +355,45 @@ RotoStrokeItemPrivate::copyStrokeForRendering(const RotoStrokeItemPrivate& other
 
         // This is the bounding box of the full stroke. Since we only copied from the curve the portion
         // we did not draw yet, we can only compute it on the main instance
+        // This is the bounding box of the full stroke. Recomputing it (and the hash below) over
+        // all the points drawn so far would make the cost of each draw step grow with the length
+        // of the stroke: instead maintain them incrementally on the main instance, folding in
+        // only the points copied at this step.
+        RectD fullStrokeBbox;
+        U64 strokesHash;
+        if (!other.drawingIncrementalDataValid) {
+            fullStrokeBbox = other.computeBoundingBox(time, view);
+            strokesHash = other.computeHashFromStrokes();
+        } else {
+            fullStrokeBbox = other.drawingFullStrokeBbox;
+            strokesHash = other.drawingStrokesHash;
+            if (hasDoneSomething) {
+                if ( !lastStrokeStepBbox.isNull() ) {
+                    fullStrokeBbox.merge(lastStrokeStepBbox);
+                }
+
+                // Chain the previous step hash with the new points: caching is disabled while
+                // drawing, so the value only needs to discriminate successive draw steps, it
+                // does not have to match the hash computed over the full curves once the
+                // stroke is finished.
+                Hash64 hash;
+                hash.append(strokesHash);
+                for (std::vector<RotoStrokeItemPrivate::StrokeCurves>::const_iterator it = strokes.begin(); it != strokes.end(); ++it) {
+                    Hash64::appendCurve(it->xCurve, &hash);
+                    Hash64::appendCurve(it->yCurve, &hash);
+                }
+                hash.computeHash();
+                strokesHash = hash.value();
+            }
+        }
+        other.drawingFullStrokeBbox = fullStrokeBbox;
+        other.drawingStrokesHash = strokesHash;
+        other.drawingIncrementalDataValid = true;
+
         renderCachedBbox.reset(new std::map<TimeValue,RectD>);
-        RectD fullStrokeBbox = other.computeBoundingBox(time, view);
         renderCachedBbox->insert(std::make_pair(time, fullStrokeBbox));
 
         renderCachedHash.reset(new std::map<TimeValue,U64>);
-        U64 strokesHash = other.computeHashFromStrokes();
         renderCachedHash->insert(std::make_pair(time, strokesHash));
     }
     return hasDoneSomething;
@@ -722,6 +767,10 @@ RotoStrokeItem::beginSubStroke()
 
         _imp->strokes.push_back(s);
 
+        // The incremental bbox/hash are re-seeded from the full curves on the first
+        // draw step of each sub-stroke
+        _imp->drawingIncrementalDataValid = false;
+
         // set thread-safety so that we ensure only 1 thread is rendering
         if (!_imp->isCurrentlyDrawing) {
             _imp->isCurrentlyDrawing = true;
@@ -114,6 +114,7 @@ public:
     KnobBoolPtr _enableCrashReports;
     KnobButtonPtr _testCrashReportButton;
     KnobBoolPtr _autoSaveUnSavedProjects;
+    KnobBoolPtr _saveProjectsInBinaryFormat;
     KnobPathPtr _fileDialogSavedPaths;
     KnobIntPtr _autoSaveDelay;
     KnobBoolPtr _saveSafetyMode;
@@ -123,7 +124,10 @@ public:
     // General/Threading
     KnobPagePtr _threadingPage;
     KnobIntPtr _numberOfThreads;
+    KnobIntPtr _trackerSolverThreads;
     KnobBoolPtr _renderInSeparateProcess;
+    KnobIntPtr _nBackgroundRenderProcesses;
+    KnobBoolPtr _prioritizeViewerRenders;
     KnobBoolPtr _queueRenders;
 
     // General/Rendering
@@ -138,6 +142,7 @@ public:
     KnobChoicePtr _availableOpenGLRenderers;
     KnobChoicePtr _osmesaRenderers;
     KnobIntPtr _nOpenGLContexts;
+    KnobBoolPtr _multiDeviceOpenGLRendering;
     KnobChoicePtr _enableOpenGL;
 
 
@@ -146,6 +151,7 @@ public:
     KnobPagePtr _projectsPage;
     KnobBoolPtr _firstReadSetProjectFormat;
     KnobBoolPtr _autoPreviewEnabledForNewProjects;
+    KnobBoolPtr _fastProjectOpen;
     KnobBoolPtr _fixPathsOnProjectPathChanged;
     KnobBoolPtr _enableMappingFromDriveLettersToUNCShareNames;
 
@@ -183,6 +189,16 @@ public:
     KnobIntPtr _maxDiskCacheSizeGb;
     KnobPathPtr _diskCachePath;
 
+    // The RAM allowed for serialized undo states before they spill to disk, see UndoStateStore
+    KnobIntPtr _maxUndoStatesRAMSizeMb;
+
+    // The RAM a single frame render may keep resident before TreeRender renders it in bands, 0 = unlimited
+    KnobIntPtr _maxFrameRenderRAMSizeGb;
+
+    // The read-only shared cache tier baked on shared storage by farm bake jobs, see SharedCacheTier
+    KnobPathPtr _sharedCacheTierPath;
+    KnobBoolPtr _sharedCacheTierBake;
+
     // Viewer
     KnobPagePtr _viewersTab;
     KnobChoicePtr _texturesMode;
@@ -194,6 +210,8 @@ public:
     KnobChoicePtr _autoProxyLevel;
     KnobIntPtr _maximumNodeViewerUIOpened;
     KnobBoolPtr _viewerKeys;
+    KnobBoolPtr _idleRenderAhead;
+    KnobIntPtr _viewerTextureCacheSize;
 
     // Nodegraph
     KnobPagePtr _nodegraphTab;
@@ -812,6 +830,15 @@ SettingsPrivate::initializeKnobsGeneral()
     _autoSaveUnSavedProjects->setDefaultValue(false);
     _generalTab->addKnob(_autoSaveUnSavedProjects);
 
+    _saveProjectsInBinaryFormat = _publicInterface->createKnob<KnobBool>("saveProjectsInBinaryFormat");
+    _saveProjectsInBinaryFormat->setLabel(tr("Save projects in binary format"));
+    _saveProjectsInBinaryFormat->setHintToolTip( tr("When checked, projects are saved in a binary encoding that is much faster "
+                                                    "to load and smaller on disk than the default YAML text encoding, which may matter for "
+                                                    "big projects. %1 transparently opens both formats, but binary project files "
+                                                    "cannot be inspected or edited with a text editor.").arg( QString::fromUtf8(NATRON_APPLICATION_NAME) ) );
+    _saveProjectsInBinaryFormat->setDefaultValue(false);
+    _generalTab->addKnob(_saveProjectsInBinaryFormat);
+
     _fileDialogSavedPaths = _publicInterface->createKnob<KnobPath>("fileDialogPaths");
     _fileDialogSavedPaths->setLabel(tr("File Dialog Paths"));
     _fileDialogSavedPaths->setHintToolTip(tr("These are the paths to directories visible in the favorite view of the file dialog"));
@@ -937,6 +964,18 @@ SettingsPrivate::initializeKnobsThreading()
     _numberOfThreads->setDefaultValue(0);
     _threadingPage->addKnob(_numberOfThreads);
 
+    _trackerSolverThreads = _publicInterface->createKnob<KnobInt>("trackerSolverThreads");
+    _trackerSolverThreads->setLabel(tr("Tracker solver threads (0=\"automatic\")"));
+    _trackerSolverThreads->setHintToolTip( tr("Controls how many threads the minimizer used by the tracker may use for a single marker. \n"
+                                              "0: Use the threads of the pool left idle by the other tracked markers. "
+                                              "Setting an explicit count is mostly useful on machines with many cores "
+                                              "when tracking few markers.") );
+    _trackerSolverThreads->disableSlider();
+    _trackerSolverThreads->setRange(0, hwThreadsCount);
+    _trackerSolverThreads->setDisplayRange(0, hwThreadsCount);
+    _trackerSolverThreads->setDefaultValue(0);
+    _threadingPage->addKnob(_trackerSolverThreads);
+
 
     _renderInSeparateProcess = _publicInterface->createKnob<KnobBool>("renderNewProcess");
     _renderInSeparateProcess->setLabel(tr("Render in a separate process"));
@@ -944,6 +983,25 @@ SettingsPrivate::initializeKnobsThreading()
                                                  "a separate process so that if the main application crashes, the render goes on.").arg( QString::fromUtf8(NATRON_APPLICATION_NAME) ) );
     _threadingPage->addKnob(_renderInSeparateProcess);
 
+    _nBackgroundRenderProcesses = _publicInterface->createKnob<KnobInt>("numRenderProcesses");
+    _nBackgroundRenderProcesses->setLabel(tr("Number of background render processes"));
+    _nBackgroundRenderProcesses->setHintToolTip( tr("When rendering in a separate process, controls how many background processes are "
+                                                    "launched for a single render: the frame range is split evenly across the processes. "
+                                                    "This only applies to renders with a forward frame range.") );
+    _nBackgroundRenderProcesses->disableSlider();
+    _nBackgroundRenderProcesses->setRange(1, hwThreadsCount);
+    _nBackgroundRenderProcesses->setDisplayRange(1, hwThreadsCount);
+    _nBackgroundRenderProcesses->setDefaultValue(1);
+    _threadingPage->addKnob(_nBackgroundRenderProcesses);
+
+    _prioritizeViewerRenders = _publicInterface->createKnob<KnobBool>("prioritizeViewerRenders");
+    _prioritizeViewerRenders->setLabel(tr("Prioritize viewer renders"));
+    _prioritizeViewerRenders->setHintToolTip( tr("When checked, render tasks issued by the viewer are scheduled before tasks of "
+                                                 "background (write node) renders on the render thread pool, so that a render "
+                                                 "queued on disk does not delay the viewer while interacting with it.") );
+    _prioritizeViewerRenders->setDefaultValue(true);
+    _threadingPage->addKnob(_prioritizeViewerRenders);
+
     _queueRenders = _publicInterface->createKnob<KnobBool>("queueRenders");
     _queueRenders->setLabel(tr("Append new renders to queue"));
     _queueRenders->setHintToolTip( tr("When checked, renders will be queued in the Progress Panel and will start only when all "
@@ -992,6 +1050,7 @@ Settings::populateOpenGLRenderers(const std::list<OpenGLRendererInfo>& renderers
 {
     if ( renderers.empty() ) {
         _imp->_availableOpenGLRenderers->setSecret(true);
+        _imp->_multiDeviceOpenGLRendering->setSecret(true);
         _imp->_nOpenGLContexts->setSecret(true);
         _imp->_enableOpenGL->setSecret(true);
         return;
@@ -1008,6 +1067,7 @@ Settings::populateOpenGLRenderers(const std::list<OpenGLRendererInfo>& renderers
     }
     _imp->_availableOpenGLRenderers->populateChoices(entries);
     _imp->_availableOpenGLRenderers->setSecret(renderers.size() == 1);
+    _imp->_multiDeviceOpenGLRendering->setSecret(renderers.size() == 1);
 
 
 #ifdef HAVE_OSMESA
@@ -1077,6 +1137,17 @@ Settings::getActiveOpenGLRendererID() const
     return GLRendererID();
 }
 
+bool
+Settings::isMultiOpenGLDeviceRenderingEnabled() const
+{
+    if ( _imp->_multiDeviceOpenGLRendering->getIsSecret() ) {
+        // A single renderer was detected
+        return false;
+    }
+
+    return _imp->_multiDeviceOpenGLRendering->getValue();
+}
+
 void
 SettingsPrivate::initializeKnobsGPU()
 {
@@ -1098,6 +1169,19 @@ SettingsPrivate::initializeKnobsGPU()
     _knobsRequiringRestart.insert(_availableOpenGLRenderers);
     _gpuPage->addKnob(_availableOpenGLRenderers);
 
+    _multiDeviceOpenGLRendering = _publicInterface->createKnob<KnobBool>("multiDeviceOpenGLRendering");
+    _multiDeviceOpenGLRendering->setLabel(tr("Distribute Renders Across All OpenGL Renderers"));
+    _multiDeviceOpenGLRendering->setHintToolTip( tr("When checked and multiple OpenGL renderers were detected, the OpenGL contexts used for rendering "
+                                                    "are spread evenly across all detected devices instead of being created on the selected renderer only. "
+                                                    "A given render uses a single context, hence a single device: independent renders (e.g: simultaneous "
+                                                    "playback frames or background renders) may then execute on different GPUs concurrently. OpenGL images "
+                                                    "cannot be shared between devices.") +
+                                                 QLatin1Char('\n') +
+                                                 tr("Changing this requires a restart of the application to take effect.") );
+    _multiDeviceOpenGLRendering->setDefaultValue(false);
+    _knobsRequiringRestart.insert(_multiDeviceOpenGLRendering);
+    _gpuPage->addKnob(_multiDeviceOpenGLRendering);
+
     _osmesaRenderers = _publicInterface->createKnob<KnobChoice>("cpuOpenGLRenderer");
     _osmesaRenderers->setLabel(tr("CPU OpenGL renderer"));
     _knobsRequiringRestart.insert(_osmesaRenderers);
@@ -1169,6 +1253,17 @@ SettingsPrivate::initializeKnobsProjectSetup()
 
     _projectsPage->addKnob(_autoPreviewEnabledForNewProjects);
 
+    _fastProjectOpen = _publicInterface->createKnob<KnobBool>("fastProjectOpen");
+    _fastProjectOpen->setLabel(tr("Fast project open (load nodes as stubs)"));
+    _fastProjectOpen->setHintToolTip( tr("If checked, when opening a project every effect node is created as a light-weight "
+                                         "stub holding its saved state instead of instantiating the plug-in: the node-graph "
+                                         "appears almost immediately even on very large projects. Double-click a stub node "
+                                         "to create the real node from its saved state. Stub nodes are pass-through and do "
+                                         "not render the effect until they are loaded.") );
+    _fastProjectOpen->setDefaultValue(false);
+
+    _projectsPage->addKnob(_fastProjectOpen);
+
 
     _fixPathsOnProjectPathChanged = _publicInterface->createKnob<KnobBool>("autoFixRelativePaths");
     _fixPathsOnProjectPathChanged->setHintToolTip( tr("If checked, when a project-path changes (either the name or the value pointed to), %1 checks all file-path parameters in the project and tries to fix them.").arg( QString::fromUtf8(NATRON_APPLICATION_NAME) ) );
@@ -1966,10 +2061,13 @@ SettingsPrivate::initializeKnobsViewers()
     //helpStringsTextureModes.push_back("Not available yet. Similar to 32bits fp.");
     textureModes.push_back(ChoiceOption("32bits floating-point", "",tr("Post-processing done by the viewer (such as colorspace conversion) is done "
                                                                        "by the GPU, using GLSL. As a results, the size of cached textures is larger.").toStdString()));
+    textureModes.push_back(ChoiceOption("Automatic", "", tr("Byte textures are used while the viewer color transform is neutral, and the viewer "
+                                                            "switches to 32bits floating-point textures automatically when the gain, gamma or "
+                                                            "auto-contrast require post-processing, so that it is done by the GPU using GLSL.").toStdString()));
     _texturesMode->populateChoices(textureModes);
     _texturesMode->setHintToolTip( tr("Bit depth of the viewer textures used for rendering."
                                       " Hover each option with the mouse for a detailed description.") );
-    _texturesMode->setDefaultValue(0);
+    _texturesMode->setDefaultValue(2);
     _viewersTab->addKnob(_texturesMode);
 
     _checkerboardTileSize = _publicInterface->createKnob<KnobInt>("checkerboardTileSize");
@@ -2050,6 +2148,28 @@ SettingsPrivate::initializeKnobsViewers()
     _viewerKeys->setDefaultValue(true);
     _viewersTab->addKnob(_viewerKeys);
 
+    _idleRenderAhead = _publicInterface->createKnob<KnobBool>("idleRenderAhead");
+    _idleRenderAhead->setLabel(tr("Render ahead during idle time"));
+    _idleRenderAhead->setHintToolTip( tr("When checked, after a few seconds of inactivity the timeline frame range "
+                                         "is rendered in the background into the cache at the viewer resolution so "
+                                         "that the next playback is mostly read from the cache. These renders run at "
+                                         "the lowest priority and are interrupted immediately when you interact "
+                                         "with the application again.") );
+    _idleRenderAhead->setDefaultValue(true);
+    _viewersTab->addKnob(_idleRenderAhead);
+
+    _viewerTextureCacheSize = _publicInterface->createKnob<KnobInt>("viewerTextureCacheSize");
+    _viewerTextureCacheSize->setLabel(tr("Viewer texture cache size (MiB)"));
+    _viewerTextureCacheSize->setRange(0, INT_MAX);
+    _viewerTextureCacheSize->disableSlider();
+    _viewerTextureCacheSize->setHintToolTip( tr("The amount of video memory (in MiB) that each viewer may use to retain "
+                                                "the textures of the frames it already displayed. When looping over a "
+                                                "sequence that fits in this budget, frames are displayed straight from "
+                                                "the GPU without uploading them again. A value of 0 disables the texture "
+                                                "cache.") );
+    _viewerTextureCacheSize->setDefaultValue(1024);
+    _viewersTab->addKnob(_viewerTextureCacheSize);
+
 
 
 
@@ -2174,6 +2294,54 @@ SettingsPrivate::initializeKnobsCaching()
     _cachingTab->addKnob(_diskCachePath);
 
 
+    _maxUndoStatesRAMSizeMb = _publicInterface->createKnob<KnobInt>("maxUndoStatesRAMSizeMb");
+    _maxUndoStatesRAMSizeMb->setLabel(tr("Maximum Undo States RAM Size (MiB)"));
+    _maxUndoStatesRAMSizeMb->disableSlider();
+    _maxUndoStatesRAMSizeMb->setRange(16, INT_MAX);
+    _maxUndoStatesRAMSizeMb->setHintToolTip( tr("The maximum amount of RAM (in MiB) that may be used to retain the states saved by the "
+                                                "undo stacks, e.g: the state of a node before it is removed. Older states exceeding "
+                                                "this budget are spilled to the disk cache location instead of being kept in memory, "
+                                                "so a long painting or editing session does not grow the undo memory unbounded.") );
+    _maxUndoStatesRAMSizeMb->setDefaultValue(256);
+
+    _cachingTab->addKnob(_maxUndoStatesRAMSizeMb);
+
+
+    _maxFrameRenderRAMSizeGb = _publicInterface->createKnob<KnobInt>("maxFrameRenderRAMGb");
+    _maxFrameRenderRAMSizeGb->setLabel(tr("Maximum Frame Render RAM Size (GiB)"));
+    _maxFrameRenderRAMSizeGb->disableSlider();
+    _maxFrameRenderRAMSizeGb->setRange(0, INT_MAX);
+    _maxFrameRenderRAMSizeGb->setHintToolTip( tr("The maximum amount of RAM (in GiB) that the images of a single frame render may keep "
+                                                 "resident at once. A frame estimated to exceed this budget is rendered in sequential "
+                                                 "bands: completed intermediate tiles are pushed to the cache, which spills them to disk "
+                                                 "under memory pressure, so very large frames are bounded by disk space rather than RAM. "
+                                                 "0 means no limit.") );
+    _maxFrameRenderRAMSizeGb->setDefaultValue(0);
+
+    _cachingTab->addKnob(_maxFrameRenderRAMSizeGb);
+
+
+    _sharedCacheTierPath = _publicInterface->createKnob<KnobPath>("sharedCacheTierPath");
+    _sharedCacheTierPath->setLabel(tr("Shared Cache Path (empty = disabled)"));
+    _sharedCacheTierPath->setMultiPath(false);
+    _sharedCacheTierPath->setHintToolTip( tr("Location of a cache tier shared across the hosts of a render farm, typically on "
+                                             "shared storage (e.g: NFS). When set, image tiles that are not in the local disk "
+                                             "cache are looked up in this tier, so a render done on any host can be reused by "
+                                             "every other host. The tier is only ever read unless \"Populate Shared Cache\" is "
+                                             "also checked, and every tile read from it is verified against its checksum.") );
+    _cachingTab->addKnob(_sharedCacheTierPath);
+
+
+    _sharedCacheTierBake = _publicInterface->createKnob<KnobBool>("sharedCacheTierBake");
+    _sharedCacheTierBake->setLabel(tr("Populate Shared Cache"));
+    _sharedCacheTierBake->setHintToolTip( tr("When checked along with a valid shared cache path, every image tile rendered by this "
+                                             "process is also baked to the shared cache tier. This should only be enabled on the "
+                                             "designated bake jobs of the farm: the tier files are written by a single process, "
+                                             "the other hosts only read them.") );
+    _sharedCacheTierBake->setDefaultValue(false);
+    _cachingTab->addKnob(_sharedCacheTierBake);
+
+
 } // Settings::initializeKnobsCaching
 
 void
@@ -2746,6 +2914,22 @@ Settings::getTileCacheSize() const
     return maxDiskBytes;
 }
 
+std::size_t
+Settings::getUndoStateRAMCacheSize() const
+{
+    std::size_t kb = 1024;
+    std::size_t mb = kb * kb;
+    return (std::size_t)_imp->_maxUndoStatesRAMSizeMb->getValue() * mb;
+}
+
+std::size_t
+Settings::getMaxFrameRenderRAMSize() const
+{
+    std::size_t kb = 1024;
+    std::size_t gb = kb * kb * kb;
+    return (std::size_t)_imp->_maxFrameRenderRAMSizeGb->getValue() * gb;
+}
+
 bool
 Settings::onKnobValueChanged(const KnobIPtr& k,
                              ValueChangedReasonEnum reason,
@@ -2849,10 +3033,23 @@ Settings::getViewersBitDepth() const
     } else if (v == 1) {
         return eImageBitDepthFloat;
     } else {
+        // Automatic: this is the depth used while the viewer color transform is neutral,
+        // the ViewerInstance switches to float on its own when it is not,
+        // see ViewerInstance::getTimeInvariantMetadata
         return eImageBitDepthByte;
     }
 }
 
+bool
+Settings::isViewerBitDepthAutomatic() const
+{
+    if (!appPTR->isTextureFloatSupported()) {
+        return false;
+    }
+
+    return _imp->_texturesMode->getValue() == 2;
+}
+
 int
 Settings::getCheckerboardTileSize() const
 {
@@ -2907,6 +3104,18 @@ Settings::getMaxOpenedNodesViewerContext() const
     return _imp->_maximumNodeViewerUIOpened->getValue();
 }
 
+bool
+Settings::isIdleRenderAheadEnabled() const
+{
+    return _imp->_idleRenderAhead->getValue();
+}
+
+int
+Settings::getViewerTextureCacheSizeMb() const
+{
+    return _imp->_viewerTextureCacheSize->getValue();
+}
+
 bool
 Settings::isViewerKeysEnabled() const
 {
@@ -2928,6 +3137,18 @@ Settings::isAggressiveCachingEnabled() const
     return _imp->_aggressiveCaching->getValue();
 }
 
+std::string
+Settings::getSharedCacheTierPath() const
+{
+    return _imp->_sharedCacheTierPath->getValue();
+}
+
+bool
+Settings::isSharedCacheTierBakeEnabled() const
+{
+    return _imp->_sharedCacheTierBake->getValue();
+}
+
 bool
 Settings::getColorPickerLinear() const
 {
@@ -2946,12 +3167,24 @@ Settings::setNumberOfThreads(int threadsNb)
     _imp->_numberOfThreads->setValue(threadsNb);
 }
 
+int
+Settings::getTrackerSolverThreadCount() const
+{
+    return _imp->_trackerSolverThreads->getValue();
+}
+
 bool
 Settings::isAutoPreviewOnForNewProjects() const
 {
     return _imp->_autoPreviewEnabledForNewProjects->getValue();
 }
 
+bool
+Settings::isFastProjectOpenEnabled() const
+{
+    return _imp->_fastProjectOpen->getValue();
+}
+
 #ifdef NATRON_DOCUMENTATION_ONLINE
 int
 Settings::getDocumentationSource() const
@@ -3157,6 +3390,18 @@ Settings::isRenderInSeparatedProcessEnabled() const
     return _imp->_renderInSeparateProcess->getValue();
 }
 
+int
+Settings::getNumberOfBackgroundRenderProcesses() const
+{
+    return _imp->_nBackgroundRenderProcesses->getValue();
+}
+
+bool
+Settings::isViewerRenderPrioritized() const
+{
+    return _imp->_prioritizeViewerRenders->getValue();
+}
+
 int
 Settings::getMaximumUndoRedoNodeGraph() const
 {
@@ -3175,6 +3420,12 @@ Settings::isAutoSaveEnabledForUnsavedProjects() const
     return _imp->_autoSaveUnSavedProjects->getValue();
 }
 
+bool
+Settings::isSaveProjectsInBinaryFormatEnabled() const
+{
+    return _imp->_saveProjectsInBinaryFormat->getValue();
+}
+
 bool
 Settings::isSnapToNodeEnabled() const
 {
@@ -127,12 +127,22 @@ public:
 
     std::size_t getTileCacheSize() const;
 
+    std::size_t getUndoStateRAMCacheSize() const;
+
+    std::size_t getMaxFrameRenderRAMSize() const;
+
+    std::string getSharedCacheTierPath() const;
+
+    bool isSharedCacheTierBakeEnabled() const;
+
     bool getColorPickerLinear() const;
 
     int getNumberOfThreads() const;
 
     void setNumberOfThreads(int threadsNb);
 
+    int getTrackerSolverThreadCount() const;
+
     void populateSystemFonts(const std::vector<std::string>& fonts);
     
     bool doesKnobChangeRequireRestart(const KnobIPtr& knob);
@@ -166,12 +176,18 @@ public:
 
     bool isAutoPreviewOnForNewProjects() const;
 
+    bool isFastProjectOpenEnabled() const;
+
     void getOpenFXPluginsSearchPaths(std::list<std::string>* paths) const;
 
     bool getUseStdOFXPluginsLocation() const;
 
     bool isRenderInSeparatedProcessEnabled() const;
 
+    int getNumberOfBackgroundRenderProcesses() const;
+
+    bool isViewerRenderPrioritized() const;
+
     bool isRenderQueuingEnabled() const;
 
     void setRenderQueuingEnabled(bool enabled);
@@ -186,6 +202,8 @@ public:
 
     bool isAutoSaveEnabledForUnsavedProjects() const;
 
+    bool isSaveProjectsInBinaryFormatEnabled() const;
+
     bool isSnapToNodeEnabled() const;
 
     bool isCheckForUpdatesEnabled() const;
@@ -246,6 +264,7 @@ public:
     // "Viewers" pane
     KnobChoicePtr getViewerBitDepthKnob() const;
     ImageBitDepthEnum getViewersBitDepth() const;
+    bool isViewerBitDepthAutomatic() const;
     int getCheckerboardTileSize() const;
     void getCheckerboardColor1(double* r, double* g, double* b, double* a) const;
     void getCheckerboardColor2(double* r, double* g, double* b, double* a) const;
@@ -254,6 +273,9 @@ public:
     unsigned int getAutoProxyMipMapLevel() const;
     int getMaxOpenedNodesViewerContext() const;
     bool isViewerKeysEnabled() const;
+    bool isIdleRenderAheadEnabled() const;
+
+    int getViewerTextureCacheSizeMb() const;
     ///////////////////////////////////////////////////////
 
     bool areRGBPixelComponentsSupported() const;
@@ -360,6 +382,8 @@ public:
 
     GLRendererID getActiveOpenGLRendererID() const;
 
+    bool isMultiOpenGLDeviceRenderingEnabled() const;
+
     void populateOpenGLRenderers(const std::list<OpenGLRendererInfo>& renderers);
 
     bool isOpenGLRenderingEnabled() const;
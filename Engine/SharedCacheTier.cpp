@@ -0,0 +1,258 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "SharedCacheTier.h"
+
+#include <cassert>
+#include <cstring>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QMutex>
+#include <QtCore/QMutexLocker>
+
+#include "Global/FStreamsSupport.h"
+
+#include "Engine/AppManager.h"
+#include "Engine/Hash64.h"
+#include "Engine/Settings.h"
+
+NATRON_NAMESPACE_ENTER;
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER;
+
+// A tier file starts with this magic followed by the format version and the tile payload
+// size in bytes, then a sequence of records: {U64 tile key, U64 payload checksum, payload}.
+// Fields and payloads are in host byte order: like the memory mapped files of the local
+// cache, tier files assume the farm hosts share the same architecture.
+static const char sharedTierFileMagic[8] = { 'N', 't', 'r', 'n', 'S', 'h', 'T', '1' };
+static const U32 sharedTierFileVersion = 1;
+
+// Serializes the appends of the render threads of this process to the tier files
+static QMutex sharedTierBakeMutex;
+
+static std::string
+getEntryFilePath(U64 entryHash, std::string* containingDir)
+{
+    std::string rootPath = appPTR->getCurrentSettings()->getSharedCacheTierPath();
+
+    if ( rootPath.empty() ) {
+        return std::string();
+    }
+
+    std::stringstream ss;
+    ss << std::hex << std::setfill('0');
+
+    // Spread the entry files across 256 sub-directories so that no single directory
+    // accumulates the files of a whole show, which directory listings on NFS dislike.
+    ss << rootPath << '/' << std::setw(2) << (int)(entryHash >> 56);
+    if (containingDir) {
+        *containingDir = ss.str();
+    }
+    ss << '/' << std::setw(16) << entryHash << ".ntt";
+
+    return ss.str();
+} // getEntryFilePath
+
+struct TierRecordLocation
+{
+    // Offset of the payload in the tier file
+    std::ios_base::streamoff payloadOffset;
+
+    // The checksum the payload must match
+    U64 checksum;
+};
+
+typedef std::map<U64, TierRecordLocation> TierFileIndex;
+
+// Reads the header and scans the records of an opened tier file, returning the location
+// of the payload of each tile key. A truncated trailing record (e.g: a bake job crashed
+// mid-append) is ignored. Returns false if the file is not a valid tier file or its tile
+// size does not match.
+static bool
+indexTierFile(FStreamsSupport::ifstream& ifile, std::size_t tileSizeBytes, TierFileIndex* index)
+{
+    ifile.seekg(0, std::ios_base::end);
+    const std::ios_base::streamoff fileSize = ifile.tellg();
+    ifile.seekg(0, std::ios_base::beg);
+
+    const std::ios_base::streamoff headerSize = sizeof(sharedTierFileMagic) + 2 * sizeof(U32);
+    if (fileSize < headerSize) {
+        return false;
+    }
+
+    char magic[8];
+    U32 version, fileTileSize;
+    ifile.read( magic, sizeof(magic) );
+    ifile.read( reinterpret_cast<char*>(&version), sizeof(version) );
+    ifile.read( reinterpret_cast<char*>(&fileTileSize), sizeof(fileTileSize) );
+    if ( !ifile ||
+         std::memcmp( magic, sharedTierFileMagic, sizeof(magic) ) != 0 ||
+         version != sharedTierFileVersion ||
+         fileTileSize != (U32)tileSizeBytes ) {
+        return false;
+    }
+
+    const std::ios_base::streamoff recordSize = 2 * sizeof(U64) + tileSizeBytes;
+
+    // A truncated trailing record (e.g: a bake job crashed mid-append) is simply not counted
+    const std::ios_base::streamoff nRecords = (fileSize - headerSize) / recordSize;
+
+    for (std::ios_base::streamoff i = 0; i < nRecords; ++i) {
+        const std::ios_base::streamoff recordOffset = headerSize + i * recordSize;
+        U64 key, checksum;
+        if ( !ifile.seekg(recordOffset, std::ios_base::beg) ||
+             !ifile.read( reinterpret_cast<char*>(&key), sizeof(key) ) ||
+             !ifile.read( reinterpret_cast<char*>(&checksum), sizeof(checksum) ) ) {
+            break;
+        }
+
+        TierRecordLocation loc;
+        loc.payloadOffset = recordOffset + 2 * sizeof(U64);
+        loc.checksum = checksum;
+
+        // Last append wins for duplicate keys
+        (*index)[key] = loc;
+    }
+
+    // Clear any eof/fail bit so the caller can seek back into the file
+    ifile.clear();
+
+    return true;
+} // indexTierFile
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT;
+
+bool
+SharedCacheTier::isReadEnabled()
+{
+    return !appPTR->getCurrentSettings()->getSharedCacheTierPath().empty();
+}
+
+bool
+SharedCacheTier::isBakeEnabled()
+{
+    SettingsPtr settings = appPTR->getCurrentSettings();
+
+    return !settings->getSharedCacheTierPath().empty() && settings->isSharedCacheTierBakeEnabled();
+}
+
+void
+SharedCacheTier::bakeTiles(U64 entryHash,
+                           const std::vector<std::pair<U64, const void*> >& tiles,
+                           std::size_t tileSizeBytes)
+{
+    if ( tiles.empty() ) {
+        return;
+    }
+
+    std::string containingDir;
+    std::string filePath = getEntryFilePath(entryHash, &containingDir);
+    if ( filePath.empty() ) {
+        return;
+    }
+
+    QMutexLocker k(&sharedTierBakeMutex);
+
+    bool fileIsNew = !QFile::exists( QString::fromUtf8( filePath.c_str() ) );
+    if (fileIsNew) {
+        QDir().mkpath( QString::fromUtf8( containingDir.c_str() ) );
+    }
+
+    FStreamsSupport::ofstream ofile;
+    FStreamsSupport::open(&ofile, filePath, std::ios_base::out | std::ios_base::binary | std::ios_base::app);
+    if (!ofile) {
+        return;
+    }
+
+    if (fileIsNew) {
+        ofile.write( sharedTierFileMagic, sizeof(sharedTierFileMagic) );
+        ofile.write( reinterpret_cast<const char*>(&sharedTierFileVersion), sizeof(sharedTierFileVersion) );
+        U32 fileTileSize = (U32)tileSizeBytes;
+        ofile.write( reinterpret_cast<const char*>(&fileTileSize), sizeof(fileTileSize) );
+    }
+
+    for (std::size_t i = 0; i < tiles.size(); ++i) {
+        U64 checksum = Hash64::hashRawBuffer(tiles[i].second, tileSizeBytes);
+        ofile.write( reinterpret_cast<const char*>(&tiles[i].first), sizeof(U64) );
+        ofile.write( reinterpret_cast<const char*>(&checksum), sizeof(U64) );
+        ofile.write( reinterpret_cast<const char*>(tiles[i].second), tileSizeBytes );
+    }
+    ofile.flush();
+} // bakeTiles
+
+void
+SharedCacheTier::fetchTiles(U64 entryHash,
+                            const std::vector<U64>& tileKeys,
+                            std::size_t tileSizeBytes,
+                            const std::vector<void*>& buffers,
+                            std::vector<bool>* fetched)
+{
+    assert( tileKeys.size() == buffers.size() );
+    fetched->clear();
+    fetched->resize(tileKeys.size(), false);
+
+    std::string filePath = getEntryFilePath(entryHash, 0);
+    if ( filePath.empty() ) {
+        return;
+    }
+
+    FStreamsSupport::ifstream ifile;
+    FStreamsSupport::open(&ifile, filePath, std::ios_base::in | std::ios_base::binary);
+    if (!ifile) {
+        return;
+    }
+
+    TierFileIndex index;
+    if ( !indexTierFile(ifile, tileSizeBytes, &index) ) {
+        return;
+    }
+
+    // Read payloads in a scratch buffer first so that the caller buffer of a tile whose
+    // checksum does not match is left untouched.
+    std::vector<char> scratch(tileSizeBytes);
+
+    for (std::size_t i = 0; i < tileKeys.size(); ++i) {
+        TierFileIndex::const_iterator found = index.find(tileKeys[i]);
+        if ( found == index.end() ) {
+            continue;
+        }
+        if ( !ifile.seekg(found->second.payloadOffset, std::ios_base::beg) ||
+             !ifile.read( &scratch[0], tileSizeBytes ) ) {
+            ifile.clear();
+            continue;
+        }
+        if ( Hash64::hashRawBuffer( &scratch[0], tileSizeBytes ) != found->second.checksum ) {
+            // Corrupt record: treat as a miss
+            continue;
+        }
+        std::memcpy( buffers[i], &scratch[0], tileSizeBytes );
+        (*fetched)[i] = true;
+    }
+} // fetchTiles
+
+NATRON_NAMESPACE_EXIT;
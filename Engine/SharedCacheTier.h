@@ -0,0 +1,107 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef NATRON_ENGINE_SHAREDCACHETIER_H
+#define NATRON_ENGINE_SHAREDCACHETIER_H
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Global/GlobalDefines.h"
+
+#include "Engine/EngineFwd.h"
+
+NATRON_NAMESPACE_ENTER;
+
+/**
+ * @brief A read-only cache tier shared across the hosts of a render farm.
+ *
+ * The local tile cache (Cache<true>) is designed for interprocess sharing on one machine:
+ * its structures live in memory mapped files protected by process-shared mutexes, which
+ * cannot be shared across hosts. This tier instead stores baked tile payloads in plain
+ * append-only files on shared storage (e.g: NFS), one file per cache entry hash, so that
+ * a worker can reuse upstream renders done anywhere on the farm without any cross-host
+ * locking: designated bake jobs are the only writers, every other host only reads.
+ *
+ * Each tile record carries a checksum (Hash64::hashRawBuffer) which is verified on read:
+ * a corrupt or torn record (e.g: a bake job crashed mid-append) is simply treated as a
+ * cache miss. Tiles read from the tier are promoted into the local cache by
+ * ImageCacheEntry, so each payload crosses the network only once per host.
+ *
+ * The tier location and the bake switch are configured in the Caching settings,
+ * see Settings::getSharedCacheTierPath() and Settings::isSharedCacheTierBakeEnabled().
+ **/
+class SharedCacheTier
+{
+public:
+
+    /**
+     * @brief Returns whether a shared tier is configured and should be consulted on
+     * local cache misses.
+     **/
+    static bool isReadEnabled();
+
+    /**
+     * @brief Returns whether this process is a designated bake job and should append
+     * the tiles it renders to the tier.
+     **/
+    static bool isBakeEnabled();
+
+    /**
+     * @brief Appends the given tile payloads to the tier file of the cache entry with the
+     * given hash. Each pair is the tile key (as encoded by the caller, identifying the
+     * tile coordinates, mipmap level and channel within the entry) and a pointer to
+     * tileSizeBytes bytes of payload.
+     * Appends of concurrent render threads are serialized process-wide; concurrent bake
+     * jobs on different hosts are not supported, see the class description.
+     **/
+    static void bakeTiles(U64 entryHash,
+                          const std::vector<std::pair<U64, const void*> >& tiles,
+                          std::size_t tileSizeBytes);
+
+    /**
+     * @brief Looks up the tier file of the cache entry with the given hash and reads the
+     * payloads of the requested tile keys into the corresponding caller-provided buffers,
+     * each of tileSizeBytes bytes. (*fetched)[i] is set to true if tileKeys[i] was found
+     * and its checksum verified, false otherwise; the buffer of a non-fetched tile is
+     * left untouched.
+     **/
+    static void fetchTiles(U64 entryHash,
+                           const std::vector<U64>& tileKeys,
+                           std::size_t tileSizeBytes,
+                           const std::vector<void*>& buffers,
+                           std::vector<bool>* fetched);
+
+private:
+
+    // This class only has static functions
+    SharedCacheTier();
+};
+
+NATRON_NAMESPACE_EXIT;
+
+#endif // NATRON_ENGINE_SHAREDCACHETIER_H
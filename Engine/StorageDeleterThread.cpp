@@ -32,14 +32,42 @@
 #include "Engine/AppManager.h"
 #include "Engine/Cache.h"
 #include "Engine/ImageStorage.h"
+#include "Engine/MemoryFile.h"
+#include "Engine/RamBuffer.h"
+#include "Engine/Timer.h"
 
 NATRON_NAMESPACE_ENTER;
 
+// Maximum rate at which dirty storage ranges are flushed on disk. Flushing asynchronously only
+// schedules the writeback, but an unbounded amount of scheduled writeback still saturates the
+// device and slows down the read-side page faults of concurrent cache look-ups, so the flusher
+// paces itself.
+#define NATRON_STORAGE_FLUSH_MAX_BYTES_PER_SECOND (256 * 1024 * 1024)
+
+// Flush in batches of at most this size: between 2 batches the thread re-checks the deletion and
+// eviction queues so that they are never delayed by more than a batch worth of flushing.
+#define NATRON_STORAGE_FLUSH_BATCH_NBYTES (8 * 1024 * 1024)
+
+// When the thread has had no work for this long, the RamBuffer pool buffers that went
+// unrecycled since the previous pass are returned to the OS, see RamBufferPool.
+#define NATRON_STORAGE_POOL_PURGE_INTERVAL_MS 5000
+
+// A dirty byte range of a memory mapped storage file waiting to be flushed on disk.
+// The storage is held with a strong reference: if the file gets closed concurrently the flush
+// of a stale range fails harmlessly instead of operating on a dangling mapping.
+struct DirtyStorageRange
+{
+    MemoryFilePtr storage;
+    char* ptr;
+    std::size_t nBytes;
+};
+
 struct StorageDeleterThreadPrivate
 {
     mutable QMutex entriesQueueMutex;
     std::list<ImageStorageBasePtr> entriesQueue;
     int cacheEvictChecksRequest;
+    std::list<DirtyStorageRange> flushQueue;
     QWaitCondition noworkCond;
     QMutex mustQuitMutex;
     QWaitCondition mustQuitCond;
@@ -49,6 +77,7 @@ struct StorageDeleterThreadPrivate
     : entriesQueueMutex()
     , entriesQueue()
     , cacheEvictChecksRequest(0)
+    , flushQueue()
     , noworkCond()
     , mustQuitMutex()
     , mustQuitCond()
@@ -114,6 +143,40 @@ StorageDeleterThread::checkCachesMemory()
     }
 }
 
+void
+StorageDeleterThread::appendToFlushQueue(const MemoryFilePtr& storage,
+                                         char* ptr,
+                                         std::size_t nBytes)
+{
+    if (!storage || !ptr || nBytes == 0) {
+        return;
+    }
+    {
+        QMutexLocker k(&_imp->entriesQueueMutex);
+
+        // Coalesce with the last queued range when contiguous: tiles of a same frame are inserted
+        // in order so this keeps the queue (and the number of flush system calls) small.
+        if ( !_imp->flushQueue.empty() ) {
+            DirtyStorageRange& back = _imp->flushQueue.back();
+            if ( (back.storage == storage) && (back.ptr + back.nBytes == ptr) ) {
+                back.nBytes += nBytes;
+                return;
+            }
+        }
+        DirtyStorageRange range;
+        range.storage = storage;
+        range.ptr = ptr;
+        range.nBytes = nBytes;
+        _imp->flushQueue.push_back(range);
+    }
+    if ( !isRunning() ) {
+        start();
+    } else {
+        QMutexLocker k(&_imp->entriesQueueMutex);
+        _imp->noworkCond.wakeOne();
+    }
+}
+
 void
 StorageDeleterThread::quitThread()
 {
@@ -146,6 +209,8 @@ StorageDeleterThread::isWorking() const
 void
 StorageDeleterThread::run()
 {
+    TimeLapse flushRateTimer;
+
     for (;;) {
         bool quit;
         {
@@ -154,12 +219,19 @@ StorageDeleterThread::run()
         }
 
         {
-            ImageStorageBasePtr front;
+            std::list<ImageStorageBasePtr> deleteBatch;
             int evictRequest = 0;
+            std::list<DirtyStorageRange> flushBatch;
             {
                 QMutexLocker k(&_imp->entriesQueueMutex);
                 if ( quit && _imp->entriesQueue.empty() ) {
+                    // Pending flushes are dropped on quit: the application flushes the caches
+                    // synchronously with flushCacheOnDisk() when saving/exiting anyway.
                     _imp->entriesQueueMutex.unlock();
+
+                    // Nothing will recycle the pooled buffers anymore: return them to the OS
+                    RamBufferPool::purgeAllBuffers();
+
                     QMutexLocker k(&_imp->mustQuitMutex);
                     assert(_imp->mustQuit);
                     _imp->mustQuit = false;
@@ -167,31 +239,70 @@ StorageDeleterThread::run()
 
                     return;
                 }
-                while ( _imp->entriesQueue.empty() && _imp->cacheEvictChecksRequest <= 0) {
-                    _imp->noworkCond.wait(&_imp->entriesQueueMutex);
+                while ( _imp->entriesQueue.empty() && _imp->cacheEvictChecksRequest <= 0 && _imp->flushQueue.empty() ) {
+                    // The thread is idle: periodically unmap, in one batched pass, the pooled
+                    // buffers that were not recycled since the previous pass. The queue lock is
+                    // released meanwhile so that new work is not delayed by the system calls.
+                    if ( !_imp->noworkCond.wait(&_imp->entriesQueueMutex, NATRON_STORAGE_POOL_PURGE_INTERVAL_MS) ) {
+                        k.unlock();
+                        RamBufferPool::purgeUnusedBuffers();
+                        k.relock();
+                    }
                 }
 
-                if (!_imp->entriesQueue.empty() ) {
-                    front = _imp->entriesQueue.front();
-                    _imp->entriesQueue.pop_front();
-                }
+                // Drain the whole deletion queue at once: the entries of an eviction wave are
+                // freed in one batch, releasing their buffers to the RamBuffer pool before the
+                // render threads allocate for the next frames, and the queue lock is taken once
+                // instead of once per entry.
+                deleteBatch.swap(_imp->entriesQueue);
                 if (_imp->cacheEvictChecksRequest > 0) {
                     evictRequest = _imp->cacheEvictChecksRequest;
                     _imp->cacheEvictChecksRequest = 0;
                 }
+
+                // Only pick up flush work when there is neither a deletion nor an eviction check
+                // pending: the latters are what render threads are waiting on.
+                if (deleteBatch.empty() && evictRequest <= 0) {
+                    std::size_t batchBytes = 0;
+                    while ( !_imp->flushQueue.empty() && batchBytes < NATRON_STORAGE_FLUSH_BATCH_NBYTES ) {
+                        batchBytes += _imp->flushQueue.front().nBytes;
+                        flushBatch.push_back( _imp->flushQueue.front() );
+                        _imp->flushQueue.pop_front();
+                    }
+                }
             }
-            if (front) {
-                // if we are the last owner using this buffer, remove it
-                if (front.use_count() == 1) {
-                    front->deallocateMemory();
+            if ( !deleteBatch.empty() ) {
+                for (std::list<ImageStorageBasePtr>::const_iterator it = deleteBatch.begin(); it != deleteBatch.end(); ++it) {
+                    // The null sentinel pushed by quitThread() carries no storage
+                    // if we are the last owner using this buffer, remove it
+                    if ( *it && (it->use_count() == 1) ) {
+                        (*it)->deallocateMemory();
+                    }
                 }
             } else if (evictRequest > 0) {
                 appPTR->getGeneralPurposeCache()->evictLRUEntries(0);
                 appPTR->getTileCache()->evictLRUEntries(0);
+            } else if ( !flushBatch.empty() ) {
+
+                flushRateTimer.getTimeElapsedReset();
+
+                std::size_t batchBytes = 0;
+                for (std::list<DirtyStorageRange>::const_iterator it = flushBatch.begin(); it != flushBatch.end(); ++it) {
+                    it->storage->flush(MemoryFile::eFlushTypeAsync, it->ptr, it->nBytes);
+                    batchBytes += it->nBytes;
+                }
+
+                // Rate limiting: if this batch was scheduled faster than the maximum flush rate,
+                // sleep the difference before picking up more work.
+                const double elapsed = flushRateTimer.getTimeElapsedReset();
+                const double minBatchTime = batchBytes / (double)NATRON_STORAGE_FLUSH_MAX_BYTES_PER_SECOND;
+                if (elapsed < minBatchTime) {
+                    msleep( (unsigned long)( (minBatchTime - elapsed) * 1000. ) );
+                }
             }
-     
-        } // front. After this scope, the image is guarenteed to be freed
-      
+
+        } // deleteBatch. After this scope, the images are guarenteed to be freed
+
     }
 } // run
 #if 0
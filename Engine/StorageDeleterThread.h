@@ -27,6 +27,7 @@
 
 #include "Global/Macros.h"
 
+#include <cstddef>
 #include <list>
 
 #include <QtCore/QThread>
@@ -61,6 +62,15 @@ public:
 
     void checkCachesMemory();
 
+    /**
+     * @brief Schedule a write-behind flush of the given dirty byte range of a memory mapped cache
+     * storage file. Ranges are batched, coalesced when contiguous and flushed asynchronously with
+     * rate limiting so that heavy cache-write phases (e.g: the first playback of a new project)
+     * do not saturate the disk with writeback competing with cache reads. Pending storage
+     * deletions and cache eviction checks always take precedence over flushes.
+     **/
+    void appendToFlushQueue(const MemoryFilePtr& storage, char* ptr, std::size_t nBytes);
+
     void quitThread();
 
     bool isWorking() const;
@@ -35,11 +35,42 @@
 
 #include <QtCore/QWaitCondition>
 #include <QtCore/QThread>
+#include <QtCore/QThreadStorage>
+#include <QtCore/QAtomicInt>
 #include <QtCore/QDebug>
 
 
 NATRON_NAMESPACE_ENTER;
 
+// Generation of TLS holders: bumped whenever a holder is destroyed so that per-thread cached
+// look-ups keyed on a holder's address cannot alias a new holder re-using the same address.
+static QAtomicInt tlsHoldersGeneration;
+
+// The pointer is owned by QThreadStorage: the look-up cache of a thread is destroyed when
+// the thread exits.
+static QThreadStorage<TLSLookupCache*> perThreadLookupCache;
+
+TLSHolderBase::~TLSHolderBase()
+{
+    // Invalidate cached look-ups referring to this holder on all threads
+    tlsHoldersGeneration.fetchAndAddOrdered(1);
+}
+
+TLSLookupCache*
+AppTLS::getThreadLookupCache()
+{
+    if ( !perThreadLookupCache.hasLocalData() ) {
+        perThreadLookupCache.setLocalData(new TLSLookupCache);
+    }
+
+    return perThreadLookupCache.localData();
+}
+
+int
+AppTLS::getHoldersGeneration()
+{
+    return (int)tlsHoldersGeneration;
+}
 
 AppTLS::AppTLS()
     : _objectMutex()
@@ -104,6 +135,9 @@ AppTLS::cleanupTLSForThread()
 {
     QThread* curThread = QThread::currentThread();
 
+    // The entries of this thread in the per-holder maps are about to be erased: drop the
+    // per-thread look-up cache first, since it points into those maps.
+    getThreadLookupCache()->reset();
 
     // Clean-up any thread data on the TLSHolder
 
@@ -27,6 +27,7 @@
 
 #include "Global/Macros.h"
 
+#include <cstddef>
 #include <list>
 #include <map>
 #include <vector>
@@ -65,7 +66,7 @@ public:
     TLSHolderBase() {}
 
 public:
-    virtual ~TLSHolderBase() {}
+    virtual ~TLSHolderBase();
 
 protected:
 
@@ -91,6 +92,100 @@ protected:
 #endif
 };
 
+// Number of entries in the per-thread look-up cache. Must be a power of two.
+#define NATRON_TLS_LOOKUP_CACHE_SIZE 64
+
+// Maximum number of slots probed on a collision before giving up and falling back
+// to the regular look-up.
+#define NATRON_TLS_LOOKUP_CACHE_MAX_PROBES 4
+
+/**
+ * @brief A small per-thread open-addressing table caching the most recent TLSHolder look-ups.
+ *
+ * EffectInstanceTLSData (among others) goes through TLSHolder::getOrCreateTLSData() on every
+ * single OFX action: with many render threads the read acquisition of perThreadDataMutex shows
+ * up in profiles even though the per-thread map almost never changes. The table is only ever
+ * touched by its owning thread, so the repeated look-up synchronizes with nothing: the regular
+ * locked look-up is only taken the first time a holder is seen on a given thread.
+ *
+ * An entry caches the address of the boost::shared_ptr<T> stored in the holder's per-thread map:
+ * map nodes have stable addresses and the entry of a thread is only ever erased by that same
+ * thread (in AppTLS::cleanupTLSForThread(), which resets the table first). Entries are keyed by
+ * the holder's address: to guard against a deleted holder being re-allocated at the same address,
+ * each entry records the global holders generation, which is bumped whenever a TLSHolderBase is
+ * destroyed.
+ **/
+struct TLSLookupCacheEntry
+{
+    // The holder the cached look-up belongs to
+    const TLSHolderBase* holder;
+
+    // The value of AppTLS::getHoldersGeneration() when the entry was filled
+    int generation;
+
+    // Points to the boost::shared_ptr<T> in the holder's per-thread map
+    const void* value;
+};
+
+struct TLSLookupCache
+{
+    TLSLookupCacheEntry entries[NATRON_TLS_LOOKUP_CACHE_SIZE];
+
+    TLSLookupCache()
+    {
+        reset();
+    }
+
+    void reset()
+    {
+        for (int i = 0; i < NATRON_TLS_LOOKUP_CACHE_SIZE; ++i) {
+            entries[i].holder = 0;
+            entries[i].generation = 0;
+            entries[i].value = 0;
+        }
+    }
+
+    static int hash(const TLSHolderBase* holder)
+    {
+        // The low bits of the address are always zero because of alignment, skip them
+        return (int)( ( (std::size_t)holder >> 4 ) & (NATRON_TLS_LOOKUP_CACHE_SIZE - 1) );
+    }
+
+    const void* find(const TLSHolderBase* holder, int generation) const
+    {
+        int i = hash(holder);
+
+        for (int probe = 0; probe < NATRON_TLS_LOOKUP_CACHE_MAX_PROBES; ++probe) {
+            const TLSLookupCacheEntry& entry = entries[i];
+            if ( (entry.holder == holder) && (entry.generation == generation) ) {
+                return entry.value;
+            }
+            i = (i + 1) & (NATRON_TLS_LOOKUP_CACHE_SIZE - 1);
+        }
+
+        return 0;
+    }
+
+    void insert(const TLSHolderBase* holder, int generation, const void* value)
+    {
+        int i = hash(holder);
+        int slot = i;
+
+        for (int probe = 0; probe < NATRON_TLS_LOOKUP_CACHE_MAX_PROBES; ++probe) {
+            TLSLookupCacheEntry& entry = entries[i];
+            if ( !entry.holder || (entry.holder == holder) || (entry.generation != generation) ) {
+                // The slot is free, stale, or already refers to this holder: take it
+                slot = i;
+                break;
+            }
+            i = (i + 1) & (NATRON_TLS_LOOKUP_CACHE_SIZE - 1);
+        }
+        entries[slot].holder = holder;
+        entries[slot].generation = generation;
+        entries[slot].value = value;
+    }
+};
+
 
 /**
  * @brief Stores globally to the application any thread-local storage object so that it gets
@@ -156,6 +251,18 @@ public:
      **/
     void cleanupTLSForThread();
 
+    /**
+     * @brief Returns the look-up cache of the calling thread, never NULL. The cache is owned
+     * by the thread and destroyed when the thread exits.
+     **/
+    static TLSLookupCache* getThreadLookupCache();
+
+    /**
+     * @brief Returns the current generation of TLS holders. Cached look-ups recorded under an
+     * older generation are stale and must go through the regular locked look-up again.
+     **/
+    static int getHoldersGeneration();
+
 private:
 
     template <typename T>
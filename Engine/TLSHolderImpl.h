@@ -120,6 +120,15 @@ template <typename T>
 boost::shared_ptr<T>
 TLSHolder<T>::getTLSData() const
 {
+    // Fast path: once getOrCreateTLSData() was called on this thread the value is in the
+    // per-thread look-up cache, which only the calling thread ever touches.
+    {
+        const void* cached = AppTLS::getThreadLookupCache()->find( this, AppTLS::getHoldersGeneration() );
+        if (cached) {
+            return *static_cast<const boost::shared_ptr<T>*>(cached);
+        }
+    }
+
     QThread* curThread  = QThread::currentThread();
     return getTLSDataForThread(curThread);
 }
@@ -128,6 +137,17 @@ template <typename T>
 boost::shared_ptr<T>
 TLSHolder<T>::getOrCreateTLSData() const
 {
+    // Fast path: after the first call on a thread the value is in the per-thread look-up
+    // cache, which only the calling thread ever touches: no lock, no shared state.
+    TLSLookupCache* lookupCache = AppTLS::getThreadLookupCache();
+    const int holdersGeneration = AppTLS::getHoldersGeneration();
+    {
+        const void* cached = lookupCache->find(this, holdersGeneration);
+        if (cached) {
+            return *static_cast<const boost::shared_ptr<T>*>(cached);
+        }
+    }
+
     QThread* curThread  = QThread::currentThread();
 
     //This thread might be registered by a spawner thread, copy the TLS and attempt to find the TLS for this holder.
@@ -150,6 +170,10 @@ TLSHolder<T>::getOrCreateTLSData() const
         if ( found != perThreadDataCRef.end() ) {
             assert(found->second.value);
 
+            // Cache the look-up: the address of the shared_ptr in the map is stable and the
+            // entry of this thread is only ever erased by this same thread.
+            lookupCache->insert(this, holdersGeneration, &found->second.value);
+
             return found->second.value;
         }
     }
@@ -161,7 +185,8 @@ TLSHolder<T>::getOrCreateTLSData() const
     data.value.reset(new T);
     {
         QWriteLocker k(&perThreadDataMutex);
-        perThreadData.insert( std::make_pair(curThread, data) );
+        std::pair<typename ThreadDataMap::iterator, bool> ret = perThreadData.insert( std::make_pair(curThread, data) );
+        lookupCache->insert(this, holdersGeneration, &ret.first->second.value);
     }
     assert(data.value);
     return data.value;
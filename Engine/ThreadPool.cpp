@@ -24,6 +24,8 @@
 
 #include "ThreadPool.h"
 
+#include <algorithm> // min, max
+#include <cassert>
 #include <string>
 #include <sstream> // stringstream
 
@@ -37,6 +39,111 @@
 
 NATRON_NAMESPACE_ENTER;
 
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+struct ThreadPoolActivityRegistry
+{
+    QMutex lock;
+    ThreadPoolActivityStats stats;
+
+    // To compute the average render parallelism
+    double parallelismSum;
+    unsigned long long nRendersFinished;
+
+    ThreadPoolActivityRegistry()
+    : lock()
+    , stats()
+    , parallelismSum(0)
+    , nRendersFinished(0)
+    {
+        stats.nTasksDispatched = 0;
+        stats.nTasksExecuted = 0;
+        stats.queueDepth = 0;
+        stats.maxQueueDepth = 0;
+        stats.busyTimeSec = 0;
+        stats.idleWaitTimeSec = 0;
+        stats.lastRenderParallelism = 0;
+        stats.averageRenderParallelism = 0;
+    }
+};
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+static ThreadPoolActivityRegistry&
+getThreadPoolActivityRegistry()
+{
+    static ThreadPoolActivityRegistry registry;
+
+    return registry;
+}
+
+void
+ThreadPoolActivity::notifyTaskDispatched()
+{
+    ThreadPoolActivityRegistry& registry = getThreadPoolActivityRegistry();
+    QMutexLocker k(&registry.lock);
+
+    ++registry.stats.nTasksDispatched;
+    ++registry.stats.queueDepth;
+    registry.stats.maxQueueDepth = std::max(registry.stats.maxQueueDepth, registry.stats.queueDepth);
+}
+
+void
+ThreadPoolActivity::notifyTaskStarted()
+{
+    ThreadPoolActivityRegistry& registry = getThreadPoolActivityRegistry();
+    QMutexLocker k(&registry.lock);
+
+    --registry.stats.queueDepth;
+    assert(registry.stats.queueDepth >= 0);
+}
+
+void
+ThreadPoolActivity::notifyTaskDone(double busyTimeSec)
+{
+    ThreadPoolActivityRegistry& registry = getThreadPoolActivityRegistry();
+    QMutexLocker k(&registry.lock);
+
+    ++registry.stats.nTasksExecuted;
+    registry.stats.busyTimeSec += busyTimeSec;
+}
+
+void
+ThreadPoolActivity::notifyIdleWait(double waitTimeSec)
+{
+    ThreadPoolActivityRegistry& registry = getThreadPoolActivityRegistry();
+    QMutexLocker k(&registry.lock);
+
+    registry.stats.idleWaitTimeSec += waitTimeSec;
+}
+
+void
+ThreadPoolActivity::notifyRenderFinished(double cpuTimeSec,
+                                         double wallTimeSec)
+{
+    if (wallTimeSec <= 0) {
+        return;
+    }
+
+    const double parallelism = cpuTimeSec / wallTimeSec;
+
+    ThreadPoolActivityRegistry& registry = getThreadPoolActivityRegistry();
+    QMutexLocker k(&registry.lock);
+
+    registry.stats.lastRenderParallelism = parallelism;
+    registry.parallelismSum += parallelism;
+    ++registry.nRendersFinished;
+    registry.stats.averageRenderParallelism = registry.parallelismSum / registry.nRendersFinished;
+}
+
+void
+ThreadPoolActivity::getStats(ThreadPoolActivityStats* stats)
+{
+    ThreadPoolActivityRegistry& registry = getThreadPoolActivityRegistry();
+    QMutexLocker k(&registry.lock);
+
+    *stats = registry.stats;
+}
 
 struct AbortableThreadPrivate
 {
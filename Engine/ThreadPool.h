@@ -37,6 +37,22 @@
 
 NATRON_NAMESPACE_ENTER;
 
+/**
+ * @brief Scheduling classes for tasks started on the global thread pool.
+ * QThreadPool dequeues tasks with a higher priority first: tasks of renders issued
+ * by the viewer are scheduled before tasks of background (write node) renders, so
+ * that a queued render on disk does not delay the viewer while the user interacts
+ * with it. This only orders queued tasks, tasks already running are not preempted.
+ **/
+enum ThreadPoolTaskPriorityEnum
+{
+    // Tasks of a render launched by the render queue or a background render process
+    eThreadPoolTaskPriorityBackgroundRender = 0,
+
+    // Tasks of a render issued by the viewer
+    eThreadPoolTaskPriorityViewerInteractive = 1,
+};
+
 /**
  * @brief This class provides a fast way to determine whether a render thread
  * is aborted or not.
@@ -104,6 +120,71 @@ inline bool isRunningInThreadPoolThread()
 #endif
 }
 
+/**
+ * @brief Cumulative activity counters of the global thread pool, as recorded by
+ * ThreadPoolActivity. The counters cover the render workload (tasks of TreeRender and
+ * of the multi-thread suite), not the few housekeeping runnables started elsewhere.
+ **/
+struct ThreadPoolActivityStats
+{
+    // Number of tasks handed to the pool since the process started
+    unsigned long long nTasksDispatched;
+
+    // Number of tasks that finished executing
+    unsigned long long nTasksExecuted;
+
+    // Tasks handed to the pool but not yet picked up by a thread
+    int queueDepth;
+
+    // Highest value reached by queueDepth
+    int maxQueueDepth;
+
+    // Total time in seconds that pool threads spent executing tasks. This includes
+    // the time tasks spent blocked waiting for results computed by other threads,
+    // which is reported separately in idleWaitTimeSec: busy minus idle-wait is the
+    // time the threads actually computed.
+    double busyTimeSec;
+
+    // Total time in seconds that pool threads spent blocked inside a task, waiting
+    // for tasks of other threads to complete
+    double idleWaitTimeSec;
+
+    // Parallelism achieved by the last finished render: the CPU seconds spent in its
+    // tasks divided by the wall time of the render, to compare against maxThreadCount
+    double lastRenderParallelism;
+
+    // Same, averaged over all renders finished since the process started
+    double averageRenderParallelism;
+};
+
+/**
+ * @brief Process-wide busy/idle accounting of the global thread pool.
+ * The notify functions are called once per task, not once per work item, so the mutex
+ * they take is not measurable against tasks that are at least a tile or a kernel slice.
+ **/
+class ThreadPoolActivity
+{
+public:
+
+    // A task was handed to QThreadPool::start()
+    static void notifyTaskDispatched();
+
+    // A dispatched task started executing on a pool thread
+    static void notifyTaskStarted();
+
+    // A task finished after spending busyTimeSec executing
+    static void notifyTaskDone(double busyTimeSec);
+
+    // A pool thread spent waitTimeSec blocked inside a task waiting for other tasks
+    static void notifyIdleWait(double waitTimeSec);
+
+    // A render finished: cpuTimeSec is the accumulated CPU time of its tasks and
+    // wallTimeSec the lifetime of the render
+    static void notifyRenderFinished(double cpuTimeSec, double wallTimeSec);
+
+    static void getStats(ThreadPoolActivityStats* stats);
+};
+
 #define REPORT_CURRENT_THREAD_ACTION(actionName, node) \
     { \
         QThread* thread = QThread::currentThread(); \
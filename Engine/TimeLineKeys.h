@@ -27,7 +27,8 @@
 
 #include "Global/Macros.h"
 
-#include <set>
+#include <algorithm>
+#include <vector>
 
 #include "Engine/EngineFwd.h"
 
@@ -52,26 +53,138 @@ struct TimeLineKey
     }
 };
 
-struct TimeLineKey_compare
+/**
+ * @brief The set of keyframe times displayed on the timeline, sorted by frame.
+ * Frames are stored in a flat sorted vector with a parallel bitset for the user-key flags:
+ * the set is rebuilt wholesale on selection changes and only queried afterwards, so this
+ * is much more compact and cache friendly than a node-based std::set when tens of
+ * thousands of keys are displayed (e.g. dense tracker data).
+ **/
+class TimeLineKeysSet
 {
-    bool operator() (const TimeLineKey& lhs,
-                     const TimeLineKey& rhs) const
+    std::vector<int> _frames; // sorted by increasing frame, no duplicates
+    std::vector<bool> _userKeys; // user-key flag of the frame at the same index
+
+public:
+
+    TimeLineKeysSet()
+    : _frames()
+    , _userKeys()
     {
-        return lhs.frame < rhs.frame;
     }
-};
 
-typedef std::set<TimeLineKey, TimeLineKey_compare> TimeLineKeysSet;
+    void clear()
+    {
+        _frames.clear();
+        _userKeys.clear();
+    }
+
+    bool empty() const
+    {
+        return _frames.empty();
+    }
+
+    std::size_t size() const
+    {
+        return _frames.size();
+    }
+
+    int getKeyFrame(std::size_t index) const
+    {
+        return _frames[index];
+    }
+
+    bool isUserKey(std::size_t index) const
+    {
+        return _userKeys[index];
+    }
+
+    /**
+     * @brief Returns the index of the first key with a frame >= the given frame, or size()
+     * if there is none. Use it to iterate over the keys within the visible time window
+     * instead of iterating over the whole set.
+     **/
+    std::size_t lowerBound(int frame) const
+    {
+        return std::lower_bound(_frames.begin(), _frames.end(), frame) - _frames.begin();
+    }
+
+    /**
+     * @brief Returns whether a key exists exactly at the given frame. If so *isUserKey is
+     * set to its user-key flag.
+     **/
+    bool findKey(int frame, bool* isUserKey) const
+    {
+        std::size_t i = lowerBound(frame);
+        if ( i >= _frames.size() || _frames[i] != frame ) {
+            return false;
+        }
+        if (isUserKey) {
+            *isUserKey = _userKeys[i];
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief Inserts a key. If a key already exists at that frame, ensure we see the user
+     * key if either one is a user key.
+     **/
+    void insert(const TimeLineKey& key)
+    {
+        // Keys are gathered curve by curve in increasing time order: appending is the
+        // common case
+        if ( _frames.empty() || _frames.back() < key.frame ) {
+            _frames.push_back(key.frame);
+            _userKeys.push_back(key.isUserKey);
+
+            return;
+        }
+        std::size_t i = lowerBound(key.frame);
+        if ( i < _frames.size() && _frames[i] == key.frame ) {
+            if (key.isUserKey) {
+                _userKeys[i] = true;
+            }
+
+            return;
+        }
+        _frames.insert(_frames.begin() + i, key.frame);
+        _userKeys.insert(_userKeys.begin() + i, key.isUserKey);
+    }
+
+    /**
+     * @brief Returns the largest key frame strictly before the given frame, if any.
+     **/
+    bool getPreviousKeyFrame(int frame, int* prevKeyFrame) const
+    {
+        std::size_t i = lowerBound(frame);
+        if (i == 0) {
+            return false;
+        }
+        *prevKeyFrame = _frames[i - 1];
+
+        return true;
+    }
+
+    /**
+     * @brief Returns the smallest key frame strictly after the given frame, if any.
+     **/
+    bool getNextKeyFrame(int frame, int* nextKeyFrame) const
+    {
+        std::size_t i = std::upper_bound(_frames.begin(), _frames.end(), frame) - _frames.begin();
+        if ( i >= _frames.size() ) {
+            return false;
+        }
+        *nextKeyFrame = _frames[i];
+
+        return true;
+    }
+};
 
 inline void
 insertTimelineKey(const TimeLineKey& key, TimeLineKeysSet* keysSet)
 {
-    std::pair<TimeLineKeysSet::iterator, bool> ret = keysSet->insert(key);
-    if (!ret.second && key.isUserKey) {
-        // If this is a user key, erase the existing key and ensure we see the user key
-        keysSet->erase(ret.first);
-        keysSet->insert(key);
-    }
+    keysSet->insert(key);
 }
 
 
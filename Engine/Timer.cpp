@@ -32,9 +32,13 @@
 #include <sstream>
 #include <stdexcept>
 #include <set>
+#include <list>
+#include <map>
+#include <vector>
 
 #include <QtCore/QMutex>
 #include <QtCore/QThread>
+#include <QtCore/QThreadStorage>
 #include <QtCore/QMutexLocker>
 
 #include "Global/GlobalDefines.h"
@@ -680,6 +684,216 @@ Profiler::dumpLog() const
     return finalStream.str();
 } // dumpLog
 
+
+// Number of samples retained per thread by the scoped profiler: when a thread records
+// more, its oldest samples are overwritten
+#define NATRON_PROFILER_SAMPLES_PER_THREAD 16384
+
+// Bitmask of the enabled profiler categories: read without any lock when recording a sample
+static volatile int g_enabledProfilerCategories = 0;
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+struct ProfilerSample
+{
+    // The scope name: a string literal, referenced and not copied
+    const char* name;
+    int category;
+    TimestampVal startTimeStamp;
+    TimestampVal endTimeStamp;
+};
+
+// The samples of one thread: only ever written by the owning thread
+struct ProfilerSampleBuffer
+{
+    std::vector<ProfilerSample> samples;
+
+    // Total number of samples recorded: the next sample is written at
+    // samplesCount % NATRON_PROFILER_SAMPLES_PER_THREAD
+    unsigned long long samplesCount;
+
+    ProfilerSampleBuffer()
+    : samples(NATRON_PROFILER_SAMPLES_PER_THREAD)
+    , samplesCount(0)
+    {
+    }
+};
+
+typedef boost::shared_ptr<ProfilerSampleBuffer> ProfilerSampleBufferPtr;
+
+// References the buffers of all threads so dump() can aggregate them, including those
+// of threads that exited
+struct ProfilerSamplesRegistry
+{
+    QMutex lock;
+    std::list<ProfilerSampleBufferPtr> buffers;
+};
+
+// QThreadStorage deletes the holder when the thread exits, but the registry keeps the
+// buffer itself alive
+struct ProfilerSampleBufferHolder
+{
+    ProfilerSampleBufferPtr buffer;
+};
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+
+static ProfilerSamplesRegistry&
+getProfilerSamplesRegistry()
+{
+    static ProfilerSamplesRegistry registry;
+
+    return registry;
+}
+
+static QThreadStorage<ProfilerSampleBufferHolder*>&
+getProfilerThreadStorage()
+{
+    static QThreadStorage<ProfilerSampleBufferHolder*> storage;
+
+    return storage;
+}
+
+void
+ScopedProfiler::setCategoryEnabled(ProfilerCategoryEnum category,
+                                   bool enabled)
+{
+    if (enabled) {
+        g_enabledProfilerCategories |= (int)category;
+    } else {
+        g_enabledProfilerCategories &= ~(int)category;
+    }
+}
+
+bool
+ScopedProfiler::isCategoryEnabled(ProfilerCategoryEnum category)
+{
+    return (g_enabledProfilerCategories & (int)category) != 0;
+}
+
+static const char*
+getProfilerCategoryName(int category)
+{
+    switch (category) {
+    case eProfilerCategoryCache:
+
+        return "cache";
+    case eProfilerCategoryKnob:
+
+        return "knob";
+    case eProfilerCategoryRender:
+
+        return "render";
+    case eProfilerCategoryGL:
+
+        return "gl";
+    default:
+
+        return "unknown";
+    }
+}
+
+std::string
+ScopedProfiler::dump()
+{
+    double frequency = getPerformanceFrequency();
+
+    // Aggregate the samples of all threads per category/scope
+    ProfilerDataBlockStatMap perScopeStats;
+    {
+        ProfilerSamplesRegistry& registry = getProfilerSamplesRegistry();
+        QMutexLocker k(&registry.lock);
+        for (std::list<ProfilerSampleBufferPtr>::const_iterator it = registry.buffers.begin(); it != registry.buffers.end(); ++it) {
+            std::size_t nSamples = (std::size_t)std::min( (*it)->samplesCount, (unsigned long long)NATRON_PROFILER_SAMPLES_PER_THREAD );
+            for (std::size_t i = 0; i < nSamples; ++i) {
+                const ProfilerSample& sample = (*it)->samples[i];
+                double elapsedTime = getTimeElapsed(sample.startTimeStamp, sample.endTimeStamp, frequency);
+
+                std::string scopeName = std::string( getProfilerCategoryName(sample.category) ) + '/' + sample.name;
+                ProfilerDataBlockStat& stats = perScopeStats[scopeName];
+                stats.functionName = scopeName;
+                stats.totalTime += elapsedTime;
+                stats.minTime = std::min(stats.minTime, elapsedTime);
+                stats.maxTime = std::max(stats.maxTime, elapsedTime);
+                ++stats.nbCalls;
+                stats.averageTime = stats.totalTime / stats.nbCalls;
+            }
+        }
+    }
+
+    std::stringstream finalStream;
+
+    finalStream << std::endl << std::endl;
+    finalStream << "Scoped profiler dump:" << std::endl;
+    finalStream << "_______________________________________________________________________________________" << std::endl;
+    finalStream << "| Total time   | Avg Time     |  Min time    |  Max time    | Calls  | Section" << std::endl;
+    finalStream << "_______________________________________________________________________________________" << std::endl;
+
+    for (ProfilerDataBlockStatMap::const_iterator it = perScopeStats.begin(); it != perScopeStats.end(); ++it) {
+        finalStream << "  " <<
+        QString::number(it->second.totalTime * 1000, 'f', 6).toStdString() << "\t\t" <<
+        QString::number(it->second.averageTime * 1000, 'f', 6).toStdString() << "\t\t" <<
+        QString::number(it->second.minTime * 1000, 'f', 6).toStdString() << "\t\t" <<
+        QString::number(it->second.maxTime * 1000, 'f', 6).toStdString() << "\t\t" <<
+        QString::number(it->second.nbCalls).toStdString() << "\t\t" <<
+        it->second.functionName << std::endl;
+        finalStream << "_______________________________________________________________________________________" <<  std::endl;
+    }
+    finalStream << std::endl << std::endl;
+
+    return finalStream.str();
+} // ScopedProfiler::dump
+
+void
+ScopedProfiler::reset()
+{
+    ProfilerSamplesRegistry& registry = getProfilerSamplesRegistry();
+    QMutexLocker k(&registry.lock);
+
+    for (std::list<ProfilerSampleBufferPtr>::const_iterator it = registry.buffers.begin(); it != registry.buffers.end(); ++it) {
+        (*it)->samplesCount = 0;
+    }
+}
+
+ScopedProfilerSample::ScopedProfilerSample(ProfilerCategoryEnum category,
+                                           const char* name)
+: _name(name)
+, _category(g_enabledProfilerCategories & (int)category)
+, _startTimeStamp()
+{
+    if (_category) {
+        _startTimeStamp = getTimestampInSeconds();
+    }
+}
+
+ScopedProfilerSample::~ScopedProfilerSample()
+{
+    if (!_category) {
+        return;
+    }
+    TimestampVal now = getTimestampInSeconds();
+
+    QThreadStorage<ProfilerSampleBufferHolder*>& storage = getProfilerThreadStorage();
+    if ( !storage.hasLocalData() ) {
+        ProfilerSampleBufferHolder* holder = new ProfilerSampleBufferHolder;
+        holder->buffer.reset(new ProfilerSampleBuffer);
+        storage.setLocalData(holder);
+
+        ProfilerSamplesRegistry& registry = getProfilerSamplesRegistry();
+        QMutexLocker k(&registry.lock);
+        registry.buffers.push_back(holder->buffer);
+    }
+
+    ProfilerSampleBuffer* buffer = storage.localData()->buffer.get();
+    ProfilerSample& sample = buffer->samples[buffer->samplesCount % NATRON_PROFILER_SAMPLES_PER_THREAD];
+    sample.name = _name;
+    sample.category = _category;
+    sample.startTimeStamp = _startTimeStamp;
+    sample.endTimeStamp = now;
+    ++buffer->samplesCount;
+}
+
 NATRON_NAMESPACE_EXIT;
 
 NATRON_NAMESPACE_USING;
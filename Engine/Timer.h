@@ -249,7 +249,66 @@ private:
 
     boost::scoped_ptr<ProfilerPrivate> _imp;
 
-    
+
+};
+
+// Categories of the application-wide scoped profiler. The values can be combined in a bitmask.
+enum ProfilerCategoryEnum
+{
+    eProfilerCategoryCache = 0x1,
+    eProfilerCategoryKnob = 0x2,
+    eProfilerCategoryRender = 0x4,
+    eProfilerCategoryGL = 0x8,
+};
+
+/**
+ * @brief Application-wide scoped profiler, always compiled in but virtually free when
+ * disabled: recording a sample costs one check of the enabled categories bitmask and,
+ * when the category is enabled, two timestamps written to a pre-allocated per-thread
+ * ring buffer without taking any lock.
+ * Categories can be enabled at runtime (e.g: from the Python API) so lock and cache
+ * costs can be quantified in production sessions without rebuilding with an external
+ * profiler.
+ **/
+class ScopedProfiler
+{
+public:
+
+    static void setCategoryEnabled(ProfilerCategoryEnum category, bool enabled);
+
+    static bool isCategoryEnabled(ProfilerCategoryEnum category);
+
+    /**
+     * @brief Returns a formatted table aggregating the samples recorded by all threads.
+     * Since the samples are held in fixed-size ring buffers, only the most recent
+     * samples of each thread are taken into account.
+     **/
+    static std::string dump();
+
+    /**
+     * @brief Discards all recorded samples. This should be called while no render is active.
+     **/
+    static void reset();
+};
+
+/**
+ * @brief Records the time spent in the enclosing scope into the per-thread ring buffer
+ * of ScopedProfiler, if the given category is enabled.
+ * The name must be a string literal: it is referenced, not copied.
+ **/
+class ScopedProfilerSample
+{
+public:
+
+    ScopedProfilerSample(ProfilerCategoryEnum category, const char* name);
+
+    ~ScopedProfilerSample();
+
+private:
+
+    const char* _name;
+    int _category; // 0 when the category is disabled: the destructor records nothing
+    TimestampVal _startTimeStamp;
 };
 
 NATRON_NAMESPACE_EXIT;
@@ -33,6 +33,7 @@
 
 CLANG_DIAG_OFF(deprecated)
 CLANG_DIAG_OFF(uninitialized)
+#include <QtCore/QDebug>
 #include <QtCore/QWaitCondition>
 #include <QtCore/QThread>
 #include <QtCore/QCoreApplication>
@@ -155,6 +156,12 @@ TrackScheduler::threadLoopOnce(const GenericThreadStartArgsPtr& inArgs)
     timeval lastProgressUpdateTime;
     gettimeofday(&lastProgressUpdateTime, 0);
 
+    // Benchmark the solves: time spent tracking, excluding viewer refreshes and progress
+    // reports, so that the per-frame cost can be compared when tuning the thread settings
+    TimeLapse solveTimer;
+    double totalSolveTimeSpent = 0.;
+    int framesTracked = 0;
+
     bool allTrackFailed = false;
     {
         ///Use RAII style for setting the isDoingPartialUpdates flag so we're sure it gets removed
@@ -167,6 +174,8 @@ TrackScheduler::threadLoopOnce(const GenericThreadStartArgsPtr& inArgs)
 
 
         while (cur != end) {
+            solveTimer.reset();
+
             ///Launch parallel thread for each track using the global thread pool
             QFuture<bool> future = QtConcurrent::mapped( trackIndexes,
                                                         boost::bind(&TrackerParamsProviderBase::trackStepFunctor,
@@ -176,6 +185,9 @@ TrackScheduler::threadLoopOnce(const GenericThreadStartArgsPtr& inArgs)
                                                                     cur) );
             future.waitForFinished();
 
+            totalSolveTimeSpent += solveTimer.getTimeElapsedReset();
+            ++framesTracked;
+
             allTrackFailed = true;
             for (QFuture<bool>::const_iterator it = future.begin(); it != future.end(); ++it) {
                 if ( (*it) ) {
@@ -223,12 +235,18 @@ TrackScheduler::threadLoopOnce(const GenericThreadStartArgsPtr& inArgs)
 
 
             ///Ok all tracks are finished now for this frame, refresh viewer if needed
+            // The timeline seek and the viewer refresh are both throttled to the progress
+            // report rate: seeking on every tracked frame floods the main thread with
+            // timeline and knob GUI refreshes and ends up throttling the tracking loop
+            // itself, whereas the marker overlays only need to follow at display rate.
+            // The timeline is sought to the last tracked frame below once the sequence
+            // is done in any case.
             if (isUpdateViewerOnTrackingEnabled && viewer) {
-                //This will not refresh the viewer since when tracking, renderCurrentFrame()
-                //is not called on viewers, see Gui::onTimeChanged
-                timeline->seekFrame(cur, true, EffectInstancePtr(), eTimelineChangeReasonOtherSeek);
-
                 if (enoughTimePassedToReportProgress) {
+                    //This will not refresh the viewer since when tracking, renderCurrentFrame()
+                    //is not called on viewers, see Gui::onTimeChanged
+                    timeline->seekFrame(cur, true, EffectInstancePtr(), eTimelineChangeReasonOtherSeek);
+
                     if (doPartialUpdates) {
                         std::list<RectD> updateRects;
 
@@ -266,6 +284,10 @@ TrackScheduler::threadLoopOnce(const GenericThreadStartArgsPtr& inArgs)
 
     paramsProvider->endTrackSequence(args);
 
+    if (framesTracked > 0) {
+        qDebug() << "Tracking:" << numTracks << "track(s) over" << framesTracked << "frame(s) in" << totalSolveTimeSpent
+                 << "sec (" << ( totalSolveTimeSpent * 1000. / framesTracked ) << "ms/frame )";
+    }
 
     //Now that tracking is done update viewer once to refresh the whole visible portion
 
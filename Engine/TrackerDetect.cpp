@@ -24,6 +24,16 @@
 
 #include "TrackerDetect.h"
 
+#include <algorithm>
+
+CLANG_DIAG_OFF(deprecated)
+CLANG_DIAG_OFF(uninitialized)
+#include <QtCore/QThreadPool>
+#include <QFuture>
+#include <QtConcurrentRun> // QtCore on Qt4, QtConcurrent on Qt5
+CLANG_DIAG_ON(deprecated)
+CLANG_DIAG_ON(uninitialized)
+
 #include "Engine/RectI.h"
 #include "Engine/Image.h"
 #include "Engine/KnobItemsTable.h"
@@ -39,6 +49,10 @@ GCC_DIAG_OFF(maybe-uninitialized)
 GCC_DIAG_ON(unused-function)
 GCC_DIAG_ON(unused-parameter)
 
+// Tiles of at most this dimension are detected concurrently on the thread pool when the
+// detection area is larger than a single tile
+#define NATRON_TRACKER_DETECT_TILE_SIZE 1024
+
 NATRON_NAMESPACE_ENTER;
 
 TrackerDetect::DetectionArgs::DetectionArgs()
@@ -85,19 +99,13 @@ static void libmvFeatureToNatronFeature(const libmv::Feature& mvFeature, Tracker
     feature->size = mvFeature.size;
 }
 
-void TrackerDetect::detectFeatures(const ImagePtr& image, const RectI& roi, const DetectionArgs& args, std::vector<Feature>* features)
+static void detectFeaturesInternal(const ImagePtr& image, const RectI& roi, const libmv::DetectOptions& options, std::vector<TrackerDetect::Feature>* features)
 {
-    if (!image) {
-        return;
-    }
     bool enabledChannels[3] = {true,true,true};
 
     MvFloatImage libmvImage;
     TrackerFrameAccessor::natronImageToLibMvFloatImage(enabledChannels, *image, roi, false /*dstFromAlpha*/, libmvImage);
 
-    libmv::DetectOptions options;
-    natronDetectionArgsToLibMvOptions(args, &options);
-
     libmv::vector<libmv::Feature> detected_features;
     libmv::Detect(libmvImage, options, &detected_features);
 
@@ -108,4 +116,116 @@ void TrackerDetect::detectFeatures(const ImagePtr& image, const RectI& roi, cons
     }
 }
 
+static bool featureScoreCompareGreater(const TrackerDetect::Feature& lhs, const TrackerDetect::Feature& rhs)
+{
+    return lhs.score > rhs.score;
+}
+
+void TrackerDetect::detectFeatures(const ImagePtr& image, const RectI& roi, const DetectionArgs& args, std::vector<Feature>* features)
+{
+    if (!image) {
+        return;
+    }
+
+    libmv::DetectOptions options;
+    natronDetectionArgsToLibMvOptions(args, &options);
+
+    int nTilesX = ( roi.width() + NATRON_TRACKER_DETECT_TILE_SIZE - 1 ) / NATRON_TRACKER_DETECT_TILE_SIZE;
+    int nTilesY = ( roi.height() + NATRON_TRACKER_DETECT_TILE_SIZE - 1 ) / NATRON_TRACKER_DETECT_TILE_SIZE;
+
+    if ( (nTilesX * nTilesY <= 1) || (QThreadPool::globalInstance()->maxThreadCount() <= 1) ) {
+        detectFeaturesInternal(image, roi, options, features);
+
+        return;
+    }
+
+    // On large areas, detect each tile concurrently on the thread pool. Each tile gets an
+    // apron around it so that the detector response near a tile edge is computed with the
+    // same neighborhood as in a full-frame detection; a feature is kept only by the tile
+    // owning its position, and the image margin of the arguments is enforced against the
+    // whole detection area when merging below, not against the tiles.
+    const int apron = std::max(16, args.min_distance);
+
+    libmv::DetectOptions tileOptions = options;
+    tileOptions.margin = 0;
+
+    std::vector<RectI> tiles( nTilesX * nTilesY ), interiors( nTilesX * nTilesY );
+    std::vector<std::vector<Feature> > tileFeatures( nTilesX * nTilesY );
+    {
+        std::vector<QFuture<void> > tileFutures( nTilesX * nTilesY );
+        int tileIndex = 0;
+        for (int ty = 0; ty < nTilesY; ++ty) {
+            for (int tx = 0; tx < nTilesX; ++tx, ++tileIndex) {
+                RectI& interior = interiors[tileIndex];
+                interior.x1 = roi.x1 + tx * NATRON_TRACKER_DETECT_TILE_SIZE;
+                interior.y1 = roi.y1 + ty * NATRON_TRACKER_DETECT_TILE_SIZE;
+                interior.x2 = std::min(interior.x1 + NATRON_TRACKER_DETECT_TILE_SIZE, roi.x2);
+                interior.y2 = std::min(interior.y1 + NATRON_TRACKER_DETECT_TILE_SIZE, roi.y2);
+
+                RectI& tile = tiles[tileIndex];
+                tile.x1 = std::max(roi.x1, interior.x1 - apron);
+                tile.y1 = std::max(roi.y1, interior.y1 - apron);
+                tile.x2 = std::min(roi.x2, interior.x2 + apron);
+                tile.y2 = std::min(roi.y2, interior.y2 + apron);
+
+                tileFutures[tileIndex] = QtConcurrent::run(detectFeaturesInternal, image, tile, tileOptions, &tileFeatures[tileIndex]);
+            }
+        }
+        for (std::size_t i = 0; i < tileFutures.size(); ++i) {
+            tileFutures[i].waitForFinished();
+        }
+    }
+
+    // Gather the features of each tile, converted to coordinates relative to the detection
+    // area as in the single-tile case, dropping duplicates from the aprons and features
+    // within the requested margin of the area boundary
+    std::vector<Feature> candidates;
+    for (std::size_t i = 0; i < tileFeatures.size(); ++i) {
+        for (std::size_t j = 0; j < tileFeatures[i].size(); ++j) {
+            Feature feature = tileFeatures[i][j];
+            feature.x += tiles[i].x1 - roi.x1;
+            feature.y += tiles[i].y1 - roi.y1;
+            double absX = feature.x + roi.x1;
+            double absY = feature.y + roi.y1;
+            if ( absX < interiors[i].x1 || absX >= interiors[i].x2 ||
+                 absY < interiors[i].y1 || absY >= interiors[i].y2 ) {
+                continue;
+            }
+            if ( feature.x < args.margin || feature.x > roi.width() - args.margin ||
+                 feature.y < args.margin || feature.y > roi.height() - args.margin ) {
+                continue;
+            }
+            candidates.push_back(feature);
+        }
+    }
+
+    // Merge with the same minimal-distance suppression as libmv FilterFeaturesByDistance:
+    // greedily keep the best-scored features that are not too close to an already kept one
+    std::sort(candidates.begin(), candidates.end(), featureScoreCompareGreater);
+
+    const double minDistanceSquared = (double)args.min_distance * args.min_distance;
+    features->clear();
+    for (std::size_t i = 0; i < candidates.size(); ++i) {
+        bool tooClose = false;
+        for (std::size_t j = 0; j < features->size(); ++j) {
+            double dx = candidates[i].x - (*features)[j].x;
+            double dy = candidates[i].y - (*features)[j].y;
+            if (dx * dx + dy * dy < minDistanceSquared) {
+                tooClose = true;
+                break;
+            }
+        }
+        if (!tooClose) {
+            features->push_back(candidates[i]);
+        }
+    }
+
+    // The MORAVEC detector targets a feature count: enforce it globally since each tile
+    // applied it only to its own features
+    if ( (args.algo == eDetectionAlgorithmLibMVMoravec) && (args.moravec_max_count > 0) &&
+         ( (int)features->size() > args.moravec_max_count ) ) {
+        features->resize(args.moravec_max_count);
+    }
+} // TrackerDetect::detectFeatures
+
 NATRON_NAMESPACE_EXIT;
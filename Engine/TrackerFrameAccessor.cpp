@@ -24,6 +24,8 @@
 
 #include "TrackerFrameAccessor.h"
 
+#include <stdexcept>
+
 GCC_DIAG_OFF(unused-function)
 GCC_DIAG_OFF(unused-parameter)
 #include <libmv/autotrack/region.h>
@@ -32,8 +34,16 @@ GCC_DIAG_ON(unused-function)
 GCC_DIAG_ON(unused-parameter)
 
 #include <QtCore/QDebug>
+#include <QtCore/QThreadPool>
+#include <QtCore/QWaitCondition>
+#include <QtConcurrentRun> // QtCore on Qt4, QtConcurrent on Qt5
 
 #include "Engine/AppInstance.h"
+#include "Engine/AppManager.h"
+#include "Engine/Cache.h"
+#include "Engine/CacheEntryBase.h"
+#include "Engine/CacheEntryKeyBase.h"
+#include "Engine/Hash64.h"
 #include "Engine/Project.h"
 #include "Engine/TimeLine.h"
 #include "Engine/EffectInstance.h"
@@ -104,6 +114,129 @@ struct FrameAccessorCacheEntry
 
 typedef std::multimap<FrameAccessorCacheKey, FrameAccessorCacheEntry, CacheKey_compare_less > FrameAccessorCache;
 
+/**
+ * @brief Key of a converted libmv image in the process-wide cache. The area rendered from a
+ * provider node is identified by the time and view variant hash of that node at the frame,
+ * which changes whenever the images it produces change, along with the type of image, the
+ * mipmap level and the rendered area.
+ **/
+class TrackerFloatImageKey : public CacheEntryKeyBase
+{
+public:
+
+    TrackerFloatImageKey(U64 providerHash,
+                         TrackerFrameAccessor::GetImageTypeEnum type,
+                         int mipMapLevel,
+                         const RectI& roi,
+                         const std::string& pluginID)
+    : CacheEntryKeyBase(pluginID)
+    , _providerHash(providerHash)
+    , _type(type)
+    , _mipMapLevel(mipMapLevel)
+    , _roi(roi)
+    {
+    }
+
+    virtual ~TrackerFloatImageKey()
+    {
+
+    }
+
+    virtual int getUniqueID() const OVERRIDE FINAL
+    {
+        return kCacheKeyUniqueIDTrackerFloatImageResults;
+    }
+
+protected:
+
+    virtual void appendToHash(Hash64* hash) const OVERRIDE FINAL
+    {
+        hash->append(_providerHash);
+        hash->append((int)_type);
+        hash->append(_mipMapLevel);
+        hash->append(_roi.x1);
+        hash->append(_roi.y1);
+        hash->append(_roi.x2);
+        hash->append(_roi.y2);
+    }
+
+private:
+
+    U64 _providerHash;
+    TrackerFrameAccessor::GetImageTypeEnum _type;
+    int _mipMapLevel;
+    RectI _roi;
+};
+
+typedef boost::shared_ptr<TrackerFloatImageKey> TrackerFloatImageKeyPtr;
+
+/**
+ * @brief A rendered and converted libmv image in the process-wide cache. The accessor cache
+ * below only lives for a single track operation and drops its entries once they are released:
+ * this entry is what allows the reference pattern of a marker, which is required again at
+ * each tracking step while its keyframe does not change, as well as any frame re-required by
+ * a subsequent track or solve over an unchanged sequence, to skip the render and conversion.
+ **/
+class TrackerFloatImageResults : public CacheEntryBase
+{
+    TrackerFloatImageResults()
+    : CacheEntryBase( appPTR->getGeneralPurposeCache() )
+    {
+        // The converted image is held by a process local pointer, it may not be cached
+        // in a persistent cache.
+        assert( !getCache()->isPersistent() );
+    }
+
+public:
+
+    static boost::shared_ptr<TrackerFloatImageResults> create(const TrackerFloatImageKeyPtr& key)
+    {
+        boost::shared_ptr<TrackerFloatImageResults> ret( new TrackerFloatImageResults() );
+        ret->setKey(key);
+
+        return ret;
+    }
+
+    virtual ~TrackerFloatImageResults()
+    {
+
+    }
+
+    // This is thread-safe and doesn't require a mutex:
+    // The thread computing this entry and calling the setter is guaranteed
+    // to be the only one interacting with this object. Then all objects
+    // should call the getter.
+    //
+    boost::shared_ptr<MvFloatImage> getImage() const
+    {
+        return _image;
+    }
+
+    void setImage(const boost::shared_ptr<MvFloatImage>& image)
+    {
+        _image = image;
+    }
+
+    virtual void toMemorySegment(IPCPropertyMap* /*properties*/) const OVERRIDE FINAL
+    {
+        assert(false);
+        throw std::runtime_error("TrackerFloatImageResults::toMemorySegment cannot be serialized to a persistent cache");
+    }
+
+    virtual CacheEntryBase::FromMemorySegmentRetCodeEnum fromMemorySegment(bool /*isLockedForWriting*/,
+                                                                           const IPCPropertyMap& /*properties*/) OVERRIDE FINAL
+    {
+        assert(false);
+        throw std::runtime_error("TrackerFloatImageResults::fromMemorySegment cannot be serialized from a persistent cache");
+    }
+
+private:
+
+    boost::shared_ptr<MvFloatImage> _image;
+};
+
+typedef boost::shared_ptr<TrackerFloatImageResults> TrackerFloatImageResultsPtr;
+
 template <bool doR, bool doG, bool doB, int srcNComps, typename PIX, int maxValue>
 void
 natronImageToLibMvFloatImageForDepth(const Image& sourceImage,
@@ -258,13 +391,19 @@ struct TrackerFrameAccessorPrivate
     FrameAccessorCache cache;
     bool enabledChannels[3];
     int formatHeight;
+    int frameStep;
+
+    // Areas currently being prefetched on the thread pool, protected by cacheMutex
+    std::list<std::pair<FrameAccessorCacheKey, RectI> > prefetchesInFlight;
+    QWaitCondition prefetchesInFlightEmptyCond;
 
     TrackerFrameAccessorPrivate(const NodePtr& sourceImageProvider,
                                 const NodePtr& maskImageProvider,
                                 const ImagePlaneDesc& maskImagePlane,
                                 int maskPlaneIndex,
                                 bool enabledChannels[3],
-                                int formatHeight)
+                                int formatHeight,
+                                int frameStep)
         : sourceImageProvider(sourceImageProvider)
         , maskImageProvider(maskImageProvider)
         , maskImagePlane(maskImagePlane)
@@ -273,9 +412,41 @@ struct TrackerFrameAccessorPrivate
         , cache()
         , enabledChannels()
         , formatHeight(formatHeight)
+        , frameStep(frameStep)
+        , prefetchesInFlight()
+        , prefetchesInFlightEmptyCond()
     {
         memcpy(this->enabledChannels, enabledChannels, sizeof(bool) * 3);
     }
+
+    /**
+     * @brief Renders the given area of the frame and converts it to a libmv image, without
+     * touching the accessor cache. The converted image goes through the process-wide cache so
+     * that the same area is not rendered and converted again while the images produced by the
+     * provider node do not change. Returns false if the render failed or was not needed.
+     **/
+    bool renderFrameForCache(TrackerFrameAccessor::GetImageTypeEnum sourceType,
+                             int frame,
+                             int downscale,
+                             const RectI& roi,
+                             FrameAccessorCacheEntry* entry);
+
+    /**
+     * @brief If the thread pool has threads to spare and the area is neither cached nor
+     * already being prefetched, schedules a render of the area at the given frame on the
+     * thread pool. This is called with the frame that the tracking loop will need next, so
+     * that its fetch overlaps with the correlation of the current frame.
+     **/
+    void schedulePrefetchIfNeeded(TrackerFrameAccessor::GetImageTypeEnum sourceType,
+                                  int frame,
+                                  int downscale,
+                                  const RectI& roi);
+
+    // Executed on the thread pool by schedulePrefetchIfNeeded
+    void prefetchFrame(TrackerFrameAccessor::GetImageTypeEnum sourceType,
+                       int frame,
+                       int downscale,
+                       RectI roi);
 };
 
 TrackerFrameAccessor::TrackerFrameAccessor(const NodePtr& sourceImageProvider,
@@ -283,14 +454,21 @@ TrackerFrameAccessor::TrackerFrameAccessor(const NodePtr& sourceImageProvider,
                                            const ImagePlaneDesc& maskImagePlane,
                                            int maskPlaneIndex,
                                            bool enabledChannels[3],
-                                           int formatHeight)
+                                           int formatHeight,
+                                           int frameStep)
     : mv::FrameAccessor()
-    , _imp( new TrackerFrameAccessorPrivate(sourceImageProvider, maskImageProvider, maskImagePlane, maskPlaneIndex, enabledChannels, formatHeight) )
+    , _imp( new TrackerFrameAccessorPrivate(sourceImageProvider, maskImageProvider, maskImagePlane, maskPlaneIndex, enabledChannels, formatHeight, frameStep) )
 {
 }
 
 TrackerFrameAccessor::~TrackerFrameAccessor()
 {
+    // Prefetch tasks reference this object, wait for them before destroying it
+    QMutexLocker k(&_imp->cacheMutex);
+
+    while ( !_imp->prefetchesInFlight.empty() ) {
+        _imp->prefetchesInFlightEmptyCond.wait(&_imp->cacheMutex);
+    }
 }
 
 void
@@ -365,21 +543,86 @@ TrackerFrameAccessor::GetImageInternal(GetImageTypeEnum sourceType,
         }
     }
 
+    FrameAccessorCacheEntry entry;
+    if ( !_imp->renderFrameForCache(sourceType, frame, downscale, roi, &entry) ) {
+        return (mv::FrameAccessor::Key)0;
+    }
+    entry.referenceCount = 1;
+
+    *destination = entry.image.get();
+    //destination->CopyFrom<float>(*entry.image);
+
+    //insert into the cache
+    {
+        QMutexLocker k(&_imp->cacheMutex);
+        _imp->cache.insert( std::make_pair(key, entry) );
+    }
+
+    // While libmv correlates against this frame, fetch the frame that the tracking loop
+    // will need next on the thread pool
+    if ( (_imp->frameStep != 0) && region ) {
+        _imp->schedulePrefetchIfNeeded(sourceType, frame + _imp->frameStep, downscale, roi);
+    }
+
+    return (mv::FrameAccessor::Key)entry.image.get();
+}
+
+bool
+TrackerFrameAccessorPrivate::renderFrameForCache(TrackerFrameAccessor::GetImageTypeEnum sourceType,
+                                                 int frame,
+                                                 int downscale,
+                                                 const RectI& roi,
+                                                 FrameAccessorCacheEntry* entry)
+{
     NodePtr sourceNode;
     switch (sourceType) {
-        case eGetImageTypeSource:
-            sourceNode = _imp->sourceImageProvider;
+        case TrackerFrameAccessor::eGetImageTypeSource:
+            sourceNode = sourceImageProvider;
             break;
-        case eGetImageTypeMask:
-            sourceNode = _imp->maskImageProvider;
+        case TrackerFrameAccessor::eGetImageTypeMask:
+            sourceNode = maskImageProvider;
             break;
     }
 
     if (!sourceNode) {
-        return (mv::FrameAccessor::Key)0;
+        return false;
+    }
+
+    // Not in the accessor cache, check the process-wide cache before rendering: the reference
+    // pattern of a marker is required again at each tracking step while its keyframe does not
+    // change, and a re-track or a new solve over an unchanged sequence requires the same areas
+    // all over again.
+    U64 providerHash;
+    {
+        HashableObject::ComputeHashArgs hashArgs;
+        hashArgs.time = TimeValue(frame);
+        hashArgs.view = ViewIdx(0);
+        hashArgs.hashType = HashableObject::eComputeHashTypeTimeViewVariant;
+        providerHash = sourceNode->getEffectInstance()->computeHash(hashArgs);
     }
 
-    // Not in accessor cache, call renderRoI
+    TrackerFloatImageKeyPtr cacheKey( new TrackerFloatImageKey( providerHash, sourceType, downscale, roi, sourceNode->getPluginID() ) );
+    TrackerFloatImageResultsPtr cachedImage = TrackerFloatImageResults::create(cacheKey);
+
+    CacheEntryLockerBasePtr cacheAccess = cachedImage->getFromCache();
+
+    CacheEntryLockerBase::CacheEntryStatusEnum cacheStatus = cacheAccess->getStatus();
+    while (cacheStatus == CacheEntryLockerBase::eCacheEntryStatusComputationPending) {
+        cacheStatus = cacheAccess->waitForPendingEntry();
+    }
+
+    if (cacheStatus == CacheEntryLockerBase::eCacheEntryStatusCached) {
+        TrackerFloatImageResultsPtr foundImage = boost::dynamic_pointer_cast<TrackerFloatImageResults>( cacheAccess->getProcessLocalEntry() );
+        assert(foundImage);
+        if ( foundImage && foundImage->getImage() ) {
+            entry->image = foundImage->getImage();
+            entry->bounds = roi;
+
+            return true;
+        }
+    }
+
+    // Not in the process-wide cache, call renderRoI
     RenderScale scale;
     scale.y = scale.x = Image::getScaleFromMipMapLevel( (unsigned int)downscale );
 
@@ -396,7 +639,7 @@ TrackerFrameAccessor::GetImageInternal(GetImageTypeEnum sourceType,
         args->view = ViewIdx(0);
 
         // Render all layers produced
-        args->plane = sourceType == eGetImageTypeMask ? &_imp->maskImagePlane : 0;
+        args->plane = sourceType == TrackerFrameAccessor::eGetImageTypeMask ? &maskImagePlane : 0;
         args->mipMapLevel = downscale;
         args->proxyScale = RenderScale(1.);
 
@@ -415,7 +658,7 @@ TrackerFrameAccessor::GetImageInternal(GetImageTypeEnum sourceType,
         qDebug() << QThread::currentThread() << "FrameAccessor::GetImage():" << "Failed to call renderRoI on input at frame" << frame << "with RoI x1="
         << roi.x1 << "y1=" << roi.y1 << "x2=" << roi.x2 << "y2=" << roi.y2;
 #endif
-        return (mv::FrameAccessor::Key)0;
+        return false;
     }
 
 
@@ -428,7 +671,7 @@ TrackerFrameAccessor::GetImageInternal(GetImageTypeEnum sourceType,
         << roi.x1 << "y1=" << roi.y1 << "x2=" << roi.x2 << "y2=" << roi.y2 << ")";
 #endif
 
-        return (mv::FrameAccessor::Key)0;
+        return false;
     }
 
 #ifdef TRACE_LIB_MV
@@ -446,7 +689,7 @@ TrackerFrameAccessor::GetImageInternal(GetImageTypeEnum sourceType,
         initArgs.bitdepth = sourceImage->getBitDepth();
         ImagePtr tmpImage = Image::create(initArgs);
         if (!tmpImage) {
-            return (mv::FrameAccessor::Key)0;
+            return false;
         }
         Image::CopyPixelsArgs cpyArgs;
         cpyArgs.roi = intersectedRoI;
@@ -455,31 +698,112 @@ TrackerFrameAccessor::GetImageInternal(GetImageTypeEnum sourceType,
 
     }
 
-    FrameAccessorCacheEntry entry;
-    entry.image.reset( new MvFloatImage( roi.height(), roi.width() ) );
-    entry.bounds = roi;
-    entry.referenceCount = 1;
-    natronImageToLibMvFloatImage(_imp->enabledChannels,
-                                 *sourceImage,
-                                 roi,
-                                 sourceType == eGetImageTypeMask/*takeDstFromAlpha*/,
-                                 *entry.image);
+    entry->image.reset( new MvFloatImage( roi.height(), roi.width() ) );
+    entry->bounds = roi;
+    TrackerFrameAccessor::natronImageToLibMvFloatImage(enabledChannels,
+                                                       *sourceImage,
+                                                       roi,
+                                                       sourceType == TrackerFrameAccessor::eGetImageTypeMask/*takeDstFromAlpha*/,
+                                                       *entry->image);
     // we ignore the transform parameter and do it in natronImageToLibMvFloatImage instead
 
-    *destination = entry.image.get();
-    //destination->CopyFrom<float>(*entry.image);
-
-    //insert into the cache
-    {
-        QMutexLocker k(&_imp->cacheMutex);
-        _imp->cache.insert( std::make_pair(key, entry) );
+    if (cacheStatus == CacheEntryLockerBase::eCacheEntryStatusMustCompute) {
+        cachedImage->setImage(entry->image);
+        cacheAccess->insertInCache();
     }
+
 #ifdef TRACE_LIB_MV
     qDebug() << QThread::currentThread() << "FrameAccessor::GetImage():" << "Rendered frame" << frame << "with RoI x1="
     << intersectedRoI.x1 << "y1=" << intersectedRoI.y1 << "x2=" << intersectedRoI.x2 << "y2=" << intersectedRoI.y2;
 #endif
-    
-    return (mv::FrameAccessor::Key)entry.image.get();
+
+    return true;
+} // TrackerFrameAccessorPrivate::renderFrameForCache
+
+void
+TrackerFrameAccessorPrivate::schedulePrefetchIfNeeded(TrackerFrameAccessor::GetImageTypeEnum sourceType,
+                                                      int frame,
+                                                      int downscale,
+                                                      const RectI& roi)
+{
+    QThreadPool* tp = QThreadPool::globalInstance();
+
+    if ( tp->activeThreadCount() >= tp->maxThreadCount() ) {
+        return;
+    }
+
+    // The search window on the next frame is the current one offset by the tracked motion,
+    // which is not known yet: render a larger area so that the prefetched image has a good
+    // chance to contain it.
+    RectI paddedRoi = roi;
+    paddedRoi.x1 -= roi.width() / 2;
+    paddedRoi.x2 += roi.width() / 2;
+    paddedRoi.y1 -= roi.height() / 2;
+    paddedRoi.y2 += roi.height() / 2;
+
+    FrameAccessorCacheKey key;
+    key.frame = frame;
+    key.mipMapLevel = downscale;
+    key.mode = mv::FrameAccessor::MONO;
+    key.type = sourceType;
+
+    {
+        QMutexLocker k(&cacheMutex);
+
+        // No need to prefetch if a cached image already encloses the area
+        std::pair<FrameAccessorCache::iterator, FrameAccessorCache::iterator> range = cache.equal_range(key);
+        for (FrameAccessorCache::iterator it = range.first; it != range.second; ++it) {
+            if ( it->second.bounds.contains(paddedRoi) ) {
+                return;
+            }
+        }
+
+        // No need to prefetch if another track already prefetches the area
+        CacheKey_compare_less keyLess;
+        for (std::list<std::pair<FrameAccessorCacheKey, RectI> >::const_iterator it = prefetchesInFlight.begin(); it != prefetchesInFlight.end(); ++it) {
+            if ( !keyLess(it->first, key) && !keyLess(key, it->first) && it->second.contains(paddedRoi) ) {
+                return;
+            }
+        }
+        prefetchesInFlight.push_back( std::make_pair(key, paddedRoi) );
+    }
+
+    QtConcurrent::run(this, &TrackerFrameAccessorPrivate::prefetchFrame, sourceType, frame, downscale, paddedRoi);
+}
+
+void
+TrackerFrameAccessorPrivate::prefetchFrame(TrackerFrameAccessor::GetImageTypeEnum sourceType,
+                                           int frame,
+                                           int downscale,
+                                           RectI roi)
+{
+    FrameAccessorCacheEntry entry;
+    bool gotImage = renderFrameForCache(sourceType, frame, downscale, roi, &entry);
+
+    FrameAccessorCacheKey key;
+    key.frame = frame;
+    key.mipMapLevel = downscale;
+    key.mode = mv::FrameAccessor::MONO;
+    key.type = sourceType;
+
+    QMutexLocker k(&cacheMutex);
+
+    if (gotImage) {
+        // The entry is inserted with a reference count of 0: the cache is local to a track
+        // operation and wiped once the whole sequence track is finished, so an entry that
+        // ends up unused does not accumulate over time.
+        entry.referenceCount = 0;
+        cache.insert( std::make_pair(key, entry) );
+    }
+
+    CacheKey_compare_less keyLess;
+    for (std::list<std::pair<FrameAccessorCacheKey, RectI> >::iterator it = prefetchesInFlight.begin(); it != prefetchesInFlight.end(); ++it) {
+        if ( !keyLess(it->first, key) && !keyLess(key, it->first) && it->second == roi ) {
+            prefetchesInFlight.erase(it);
+            break;
+        }
+    }
+    prefetchesInFlightEmptyCond.wakeAll();
 }
 
 /*
@@ -75,12 +75,16 @@ class TrackerFrameAccessor
 {
 public:
 
+    // frameStep is the step of the track sequence this accessor is used for: when non zero,
+    // each call to GetImage schedules a render of the same area at frame + frameStep on the
+    // thread pool so that the fetch of the next frame overlaps with the tracking of this one.
     TrackerFrameAccessor(const NodePtr& sourceImageProvider,
                          const NodePtr& maskImageProvider,
                          const ImagePlaneDesc& maskImagePlane,
                          int maskPlaneIndex,
                          bool enabledChannels[3],
-                         int formatHeight);
+                         int formatHeight,
+                         int frameStep);
 
     virtual ~TrackerFrameAccessor();
 
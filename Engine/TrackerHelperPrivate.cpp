@@ -29,8 +29,10 @@
 #include <QDebug>
 
 #include "Engine/AppInstance.h"
+#include "Engine/AppManager.h"
 #include "Engine/Curve.h"
 #include "Engine/Project.h"
+#include "Engine/Settings.h"
 #include "Engine/TimeLine.h"
 #include "Engine/KnobTypes.h"
 #include "Engine/Image.h"
@@ -400,18 +402,20 @@ TrackerHelperPrivate::trackStepLibMV(int trackIndex,
     args.getEnabledChannels(&enabledChans[0], &enabledChans[1], &enabledChans[2]);
 
 
-    {
-        // Add a marker to the auto-track at the tracked time: the mv::Marker struct is filled with the values of the Natron TrackMarker at the trackTime
+    // Add a marker to the auto-track at the tracked time: the mv::Marker struct is filled with the values of the Natron TrackMarker at the trackTime.
+    // Since all tracks of a frame are processed concurrently, build the marker outside of the auto-track lock:
+    // natronTrackerToLibMVTracker is expensive (many knob getValue calls) and only writes to this track's marker,
+    // so only the insertion in the shared auto-track needs to be serialized.
+    if ( trackTime == args.getStart() ) {
         QMutexLocker k(autoTrackMutex);
-        if ( trackTime == args.getStart() ) {
-            bool foundStartMarker = autoTrack->GetMarker(0, trackTime, trackIndex, &track->mvMarker);
-            assert(foundStartMarker);
-            Q_UNUSED(foundStartMarker);
-            track->mvMarker.source = mv::Marker::MANUAL;
-        } else {
-            natronTrackerToLibMVTracker(false, enabledChans, *track->natronMarker, trackIndex, TimeValue(trackTime), TimeValue(args.getStep()), args.getFormatHeight(), &track->mvMarker);
-            autoTrack->AddMarker(track->mvMarker);
-        }
+        bool foundStartMarker = autoTrack->GetMarker(0, trackTime, trackIndex, &track->mvMarker);
+        assert(foundStartMarker);
+        Q_UNUSED(foundStartMarker);
+        track->mvMarker.source = mv::Marker::MANUAL;
+    } else {
+        natronTrackerToLibMVTracker(false, enabledChans, *track->natronMarker, trackIndex, TimeValue(trackTime), TimeValue(args.getStep()), args.getFormatHeight(), &track->mvMarker);
+        QMutexLocker k(autoTrackMutex);
+        autoTrack->AddMarker(track->mvMarker);
     }
 
     if (track->mvMarker.source == mv::Marker::MANUAL) {
@@ -422,13 +426,22 @@ TrackerHelperPrivate::trackStepLibMV(int trackIndex,
 #endif
         setKnobKeyframesFromMarker(args.getFormatHeight(), 0, track);
     } else {
-        // Make sure the reference frame is in the auto-track: the mv::Marker struct is filled with the values of the Natron TrackMarker at the reference_frame
+        // Make sure the reference frame is in the auto-track: the mv::Marker struct is filled with the values of the Natron TrackMarker at the reference_frame.
+        // Here as well, build the marker outside of the auto-track lock and re-check under the lock before inserting it.
         {
-            QMutexLocker k(autoTrackMutex);
+            bool foundReferenceMarker;
             mv::Marker m;
-            if ( !autoTrack->GetMarker(0, track->mvMarker.reference_frame, trackIndex, &m) ) {
+            {
+                QMutexLocker k(autoTrackMutex);
+                foundReferenceMarker = autoTrack->GetMarker(0, track->mvMarker.reference_frame, trackIndex, &m);
+            }
+            if (!foundReferenceMarker) {
                 natronTrackerToLibMVTracker(true, enabledChans, *track->natronMarker, track->mvMarker.track, TimeValue(track->mvMarker.reference_frame), TimeValue(args.getStep()), args.getFormatHeight(), &m);
-                autoTrack->AddMarker(m);
+                QMutexLocker k(autoTrackMutex);
+                mv::Marker tmp;
+                if ( !autoTrack->GetMarker(0, track->mvMarker.reference_frame, trackIndex, &tmp) ) {
+                    autoTrack->AddMarker(m);
+                }
             }
         }
 
@@ -444,11 +457,14 @@ TrackerHelperPrivate::trackStepLibMV(int trackIndex,
 
 #ifdef CERES_USE_OPENMP
         // Set the number of threads Ceres may use
-        QThreadPool* tp = QThreadPool::globalInstance();
-
-        // Allocate max threads for tracking and reserve them from the thread pool
-        int nOmpThreads = tp->maxThreadCount() - tp->activeThreadCount() + 1;
+        int nOmpThreads = appPTR->getCurrentSettings()->getTrackerSolverThreadCount();
+        if (nOmpThreads <= 0) {
+            // Automatic: allocate max threads for tracking and reserve them from the thread pool
+            QThreadPool* tp = QThreadPool::globalInstance();
+            nOmpThreads = tp->maxThreadCount() - tp->activeThreadCount() + 1;
+        }
         omp_set_num_threads(nOmpThreads);
+        track->mvOptions.num_threads = nOmpThreads;
 
 #endif
 
@@ -2174,7 +2174,23 @@ TrackerNodePrivate::averageSelectedTracks()
     }
 
     bool hasKeyFrame = keyframesRange.min != INT_MIN && keyframesRange.max != INT_MAX;
-    for (double t = keyframesRange.min; t <= keyframesRange.max; t += 1) {
+    const int nSamples = keyframesRange.max >= keyframesRange.min ? (int)(keyframesRange.max - keyframesRange.min) + 1 : 0;
+
+    // Sample the center curve of each marker over the whole range at once: this resolves each
+    // keyframe segment once instead of once per frame, see Curve::getValueAtBatch()
+    std::list<std::vector<double> > xSamples, ySamples;
+    for (std::list<TrackMarkerPtr >::iterator it = markers.begin(); it != markers.end(); ++it) {
+        KnobDoublePtr markCenter = (*it)->getCenterKnob();
+        xSamples.push_back( std::vector<double>(nSamples) );
+        ySamples.push_back( std::vector<double>(nSamples) );
+        if (nSamples > 0) {
+            markCenter->getAnimationCurve( ViewIdx(0), DimIdx(0) )->getValueAtBatch(TimeValue(keyframesRange.min), TimeValue(keyframesRange.min + nSamples - 1), nSamples, true /*clamp*/, &xSamples.back()[0]);
+            markCenter->getAnimationCurve( ViewIdx(0), DimIdx(1) )->getValueAtBatch(TimeValue(keyframesRange.min), TimeValue(keyframesRange.min + nSamples - 1), nSamples, true /*clamp*/, &ySamples.back()[0]);
+        }
+    }
+
+    for (int i = 0; i < nSamples; ++i) {
+        const TimeValue t = TimeValue(keyframesRange.min + i);
         Point avgCenter;
         avgCenter.x = avgCenter.y = 0.;
 
@@ -2184,8 +2200,9 @@ TrackerNodePrivate::averageSelectedTracks()
 #endif
 
 
-        for (std::list<TrackMarkerPtr >::iterator it = markers.begin(); it != markers.end(); ++it) {
-            KnobDoublePtr markCenter = (*it)->getCenterKnob();
+        std::list<std::vector<double> >::const_iterator xSamplesIt = xSamples.begin();
+        std::list<std::vector<double> >::const_iterator ySamplesIt = ySamples.begin();
+        for (std::list<TrackMarkerPtr >::iterator it = markers.begin(); it != markers.end(); ++it, ++xSamplesIt, ++ySamplesIt) {
 
 #ifdef AVERAGE_ALSO_PATTERN_QUAD
             KnobDoublePtr markTopLeft = (*it)->getPatternTopLeftKnob();
@@ -2194,8 +2211,8 @@ TrackerNodePrivate::averageSelectedTracks()
             KnobDoublePtr markBtmLeft = (*it)->getPatternBtmLeftKnob();
 #endif
 
-            avgCenter.x += markCenter->getValueAtTime(TimeValue(t), DimIdx(0));
-            avgCenter.y += markCenter->getValueAtTime(TimeValue(t), DimIdx(1));
+            avgCenter.x += (*xSamplesIt)[i];
+            avgCenter.y += (*ySamplesIt)[i];
 
 #        ifdef AVERAGE_ALSO_PATTERN_QUAD
             avgTopLeft.x += markTopLeft->getValueAtTime(TimeValue(t), DimIdx(0));
@@ -598,6 +598,31 @@ struct SolveRequest
     bool robustModel;
     double maxFittingError;
     std::vector<TrackMarkerPtr> allMarkers;
+
+    // The fit at a given keyframe only depends on the markers values at that keyframe and
+    // at the reference time, so results of the previous solve are kept here along with the
+    // hash of the inputs that produced them: a new solve only recomputes the keyframes whose
+    // input hash changed, which makes interactive marker cleanup cheap on long sequences.
+    std::map<TimeValue, std::pair<U64, CornerPinData> > cpResultsCache;
+    std::map<TimeValue, std::pair<U64, TransformData> > tResultsCache;
+
+    // Hash of the solver parameters: when it changes the whole cache is invalidated
+    U64 solveParametersHash;
+
+    // The keyframes that the ongoing solve actually recomputes, and their input hashes,
+    // used to update the results cache when the solve finishes
+    std::set<TimeValue> staleKeyframes;
+    std::map<TimeValue, U64> pendingSolveHashes;
+
+    SolveRequest()
+    : refTime(0)
+    , jitterPeriod(0)
+    , jitterAdd(false)
+    , robustModel(false)
+    , maxFittingError(0)
+    , solveParametersHash(0)
+    {
+    }
 };
 
 class TrackerKnobItemsTable;
@@ -50,6 +50,7 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 
 #include "Engine/AppInstance.h"
 #include "Engine/CreateNodeArgs.h"
+#include "Engine/Hash64.h"
 #include "Engine/KnobTypes.h"
 #include "Engine/Node.h"
 #include "Engine/TrackerHelper.h"
@@ -269,6 +270,43 @@ TrackerNodePrivate::exportTrackDataFromExportOptions()
 
 
 
+/**
+ * @brief Hash of everything the fit at the given keyframe depends on besides the solver
+ * parameters: the enabled state, center and error of each marker at the keyframe and at the
+ * reference time, and the normalization rectangle. Only valid when not using jitter, since
+ * with jitter the fit also depends on the markers values at neighbouring keyframes.
+ **/
+static U64
+computeSolveInputsHashAtTime(const std::vector<TrackMarkerPtr>& markers,
+                             const TrackerParamsProviderPtr& params,
+                             TimeValue refTime,
+                             TimeValue time)
+{
+    Hash64 hash;
+
+    hash.append((double)time);
+    RectD rod = params->getNormalizationRoD(time, ViewIdx(0));
+    hash.append( rod.width() );
+    hash.append( rod.height() );
+    for (std::size_t i = 0; i < markers.size(); ++i) {
+        bool enabled = markers[i]->isEnabled(time);
+        hash.append(enabled);
+        if (!enabled) {
+            continue;
+        }
+        KnobDoublePtr centerKnob = markers[i]->getCenterKnob();
+        KnobDoublePtr errorKnob = markers[i]->getErrorKnob();
+        hash.append( centerKnob->getValueAtTime(time, DimIdx(0)) );
+        hash.append( centerKnob->getValueAtTime(time, DimIdx(1)) );
+        hash.append( centerKnob->getValueAtTime(refTime, DimIdx(0)) );
+        hash.append( centerKnob->getValueAtTime(refTime, DimIdx(1)) );
+        hash.append( errorKnob->getValueAtTime(time, DimIdx(0)) );
+    }
+    hash.computeHash();
+
+    return hash.value();
+}
+
 void
 TrackerNodePrivate::solveTransformParamsIfAutomatic()
 {
@@ -377,6 +415,53 @@ TrackerNodePrivate::solveTransformParams()
     lastSolveRequest.robustModel = robust;
     lastSolveRequest.maxFittingError = maxFittingError;
 
+    // Invalidate the results of the previous solve if the solver parameters changed.
+    // With jitter the fit at a keyframe also depends on neighbouring keyframes, so do not
+    // attempt incremental solving at all in that case.
+    {
+        Hash64 solveHash;
+        solveHash.append((double)refTime);
+        solveHash.append(jitterPer);
+        solveHash.append(jitterAdd);
+        solveHash.append(robust);
+        solveHash.append(transformType_i);
+        solveHash.append( (U64)markers.size() );
+        solveHash.computeHash();
+        if ( (solveHash.value() != lastSolveRequest.solveParametersHash) || (jitterPer > 1) ) {
+            lastSolveRequest.cpResultsCache.clear();
+            lastSolveRequest.tResultsCache.clear();
+        }
+        lastSolveRequest.solveParametersHash = solveHash.value();
+    }
+
+    // Only solve the keyframes whose inputs changed since the previous solve; the results
+    // for the other ones are re-used from the cache when assembling the curves.
+    lastSolveRequest.staleKeyframes.clear();
+    lastSolveRequest.pendingSolveHashes.clear();
+    {
+        boost::shared_ptr<TrackerParamsProvider> thisShared = shared_from_this();
+        for (std::set<TimeValue>::const_iterator it = keyframes.begin(); it != keyframes.end(); ++it) {
+            U64 inputsHash = computeSolveInputsHashAtTime(markers, thisShared, refTime, *it);
+            bool upToDate = false;
+            switch (transformType) {
+                case eTrackerTransformNodeCornerPin: {
+                    std::map<TimeValue, std::pair<U64, CornerPinData> >::const_iterator foundCached = lastSolveRequest.cpResultsCache.find(*it);
+                    upToDate = foundCached != lastSolveRequest.cpResultsCache.end() && foundCached->second.first == inputsHash;
+                    break;
+                }
+                case eTrackerTransformNodeTransform: {
+                    std::map<TimeValue, std::pair<U64, TransformData> >::const_iterator foundCached = lastSolveRequest.tResultsCache.find(*it);
+                    upToDate = foundCached != lastSolveRequest.tResultsCache.end() && foundCached->second.first == inputsHash;
+                    break;
+                }
+            }
+            if (!upToDate) {
+                lastSolveRequest.staleKeyframes.insert(*it);
+                lastSolveRequest.pendingSolveHashes[*it] = inputsHash;
+            }
+        }
+    }
+
     switch (transformType) {
         case eTrackerTransformNodeTransform:
             computeTransformParamsFromTracks();
@@ -640,9 +725,40 @@ TrackerNodePrivate::computeCornerParamsFromTracksEnd(double refTime,
                                                      double maxFittingError,
                                                      const QList<CornerPinData>& results)
 {
+    // Fold the fresh solves into the results cache and then assemble the full results list
+    // in time order, re-using the cached result of every keyframe that was not solved again.
+    QList<CornerPinData> allResults;
+    if ( lastSolveRequest.pendingSolveHashes.empty() && lastSolveRequest.cpResultsCache.empty() ) {
+        // Incremental solving was not used
+        allResults = results;
+    } else {
+        for (QList<CornerPinData>::const_iterator it = results.begin(); it != results.end(); ++it) {
+            std::map<TimeValue, U64>::const_iterator foundHash = lastSolveRequest.pendingSolveHashes.find(it->time);
+            if ( foundHash != lastSolveRequest.pendingSolveHashes.end() ) {
+                lastSolveRequest.cpResultsCache[it->time] = std::make_pair(foundHash->second, *it);
+            }
+        }
+        // Drop cached results of keyframes that no longer exist
+        for (std::map<TimeValue, std::pair<U64, CornerPinData> >::iterator it = lastSolveRequest.cpResultsCache.begin(); it != lastSolveRequest.cpResultsCache.end();) {
+            if ( lastSolveRequest.keyframes.find(it->first) == lastSolveRequest.keyframes.end() ) {
+                std::map<TimeValue, std::pair<U64, CornerPinData> >::iterator toErase = it;
+                ++it;
+                lastSolveRequest.cpResultsCache.erase(toErase);
+            } else {
+                ++it;
+            }
+        }
+        for (std::set<TimeValue>::const_iterator it = lastSolveRequest.keyframes.begin(); it != lastSolveRequest.keyframes.end(); ++it) {
+            std::map<TimeValue, std::pair<U64, CornerPinData> >::const_iterator foundCached = lastSolveRequest.cpResultsCache.find(*it);
+            if ( foundCached != lastSolveRequest.cpResultsCache.end() ) {
+                allResults.push_back(foundCached->second.second);
+            }
+        }
+    }
+
     // Make sure we get only valid results
     QList<CornerPinData> validResults;
-    for (QList<CornerPinData>::const_iterator it = results.begin(); it != results.end(); ++it) {
+    for (QList<CornerPinData>::const_iterator it = allResults.begin(); it != allResults.end(); ++it) {
         if (it->valid) {
             validResults.push_back(*it);
         }
@@ -789,7 +905,7 @@ TrackerNodePrivate::computeCornerParamsFromTracks()
     QObject::connect( lastSolveRequest.cpWatcher.get(), SIGNAL(finished()), publicInterface, SLOT(onCornerPinSolverWatcherFinished()) );
     QObject::connect( lastSolveRequest.cpWatcher.get(), SIGNAL(progressValueChanged(int)), publicInterface, SLOT(onCornerPinSolverWatcherProgress(int)) );
 
-    lastSolveRequest.cpWatcher->setFuture( QtConcurrent::mapped( lastSolveRequest.keyframes, boost::bind(&TrackerHelper::computeCornerPinParamsFromTracksAtTime,
+    lastSolveRequest.cpWatcher->setFuture( QtConcurrent::mapped( lastSolveRequest.staleKeyframes, boost::bind(&TrackerHelper::computeCornerPinParamsFromTracksAtTime,
                                                                                                          lastSolveRequest.refTime,
                                                                                                          _1,
                                                                                                          lastSolveRequest.jitterPeriod,
@@ -856,8 +972,39 @@ TrackerNodePrivate::computeTransformParamsFromTracksEnd(double refTime,
                                                         double maxFittingError,
                                                         const QList<TransformData>& results)
 {
+    // Fold the fresh solves into the results cache and then assemble the full results list
+    // in time order, re-using the cached result of every keyframe that was not solved again.
+    QList<TransformData> allResults;
+    if ( lastSolveRequest.pendingSolveHashes.empty() && lastSolveRequest.tResultsCache.empty() ) {
+        // Incremental solving was not used
+        allResults = results;
+    } else {
+        for (QList<TransformData>::const_iterator it = results.begin(); it != results.end(); ++it) {
+            std::map<TimeValue, U64>::const_iterator foundHash = lastSolveRequest.pendingSolveHashes.find(it->time);
+            if ( foundHash != lastSolveRequest.pendingSolveHashes.end() ) {
+                lastSolveRequest.tResultsCache[it->time] = std::make_pair(foundHash->second, *it);
+            }
+        }
+        // Drop cached results of keyframes that no longer exist
+        for (std::map<TimeValue, std::pair<U64, TransformData> >::iterator it = lastSolveRequest.tResultsCache.begin(); it != lastSolveRequest.tResultsCache.end();) {
+            if ( lastSolveRequest.keyframes.find(it->first) == lastSolveRequest.keyframes.end() ) {
+                std::map<TimeValue, std::pair<U64, TransformData> >::iterator toErase = it;
+                ++it;
+                lastSolveRequest.tResultsCache.erase(toErase);
+            } else {
+                ++it;
+            }
+        }
+        for (std::set<TimeValue>::const_iterator it = lastSolveRequest.keyframes.begin(); it != lastSolveRequest.keyframes.end(); ++it) {
+            std::map<TimeValue, std::pair<U64, TransformData> >::const_iterator foundCached = lastSolveRequest.tResultsCache.find(*it);
+            if ( foundCached != lastSolveRequest.tResultsCache.end() ) {
+                allResults.push_back(foundCached->second.second);
+            }
+        }
+    }
+
     QList<TransformData> validResults;
-    for (QList<TransformData>::const_iterator it = results.begin(); it != results.end(); ++it) {
+    for (QList<TransformData>::const_iterator it = allResults.begin(); it != allResults.end(); ++it) {
         if (it->valid) {
             validResults.push_back(*it);
         }
@@ -969,7 +1116,7 @@ TrackerNodePrivate::computeTransformParamsFromTracks()
     QObject::connect( lastSolveRequest.tWatcher.get(), SIGNAL(finished()), publicInterface, SLOT(onTransformSolverWatcherFinished()) );
     QObject::connect( lastSolveRequest.tWatcher.get(), SIGNAL(progressValueChanged(int)), publicInterface, SLOT(onTransformSolverWatcherProgress(int)) );
 
-    lastSolveRequest.tWatcher->setFuture( QtConcurrent::mapped( lastSolveRequest.keyframes, boost::bind(&TrackerHelper::computeTransformParamsFromTracksAtTime,
+    lastSolveRequest.tWatcher->setFuture( QtConcurrent::mapped( lastSolveRequest.staleKeyframes, boost::bind(&TrackerHelper::computeTransformParamsFromTracksAtTime,
                                                                                                         lastSolveRequest.refTime,
                                                                                                         _1,
                                                                                                         lastSolveRequest.jitterPeriod,
@@ -1041,6 +1188,8 @@ TrackerNodePrivate::endSolve()
     lastSolveRequest.tWatcher.reset();
     lastSolveRequest.keyframes.clear();
     lastSolveRequest.allMarkers.clear();
+    lastSolveRequest.staleKeyframes.clear();
+    lastSolveRequest.pendingSolveHashes.clear();
     setSolverParamsEnabled(true);
     NodePtr n = publicInterface->getNode();
     n->getApp()->progressEnd(n);
@@ -25,6 +25,8 @@
 
 #include "TreeRender.h"
 
+#include <algorithm>
+#include <cmath>
 #include <set>
 #include <QtCore/QThread>
 #include <QMutex>
@@ -38,8 +40,10 @@
 #include "Engine/FrameViewRequest.h"
 #include "Engine/GPUContextPool.h"
 #include "Engine/GroupInput.h"
+#include "Engine/InteractionLatency.h"
 #include "Engine/Node.h"
 #include "Engine/NodeGroup.h"
+#include "Engine/RenderImageArena.h"
 #include "Engine/RotoStrokeItem.h"
 #include "Engine/Settings.h"
 #include "Engine/Timer.h"
@@ -136,6 +140,11 @@ struct TreeRenderPrivate
     std::map<NodePtr, FrameViewRequestPtr> extraRequestedResults;
     mutable QMutex extraRequestedResultsMutex;
 
+    // The request created for the tree root by the request pass, valid as soon as the request
+    // pass completed: other threads may use it to observe the image whilst it is being rendered.
+    FrameViewRequestWPtr outputRequestBeingRendered;
+    mutable QMutex outputRequestBeingRenderedMutex;
+
     // While drawing a preview with the RotoPaint node, this is the bounding box of the area
     // to update on the viewer
     // Protected by extraRequestedResultsMutex
@@ -152,6 +161,21 @@ struct TreeRenderPrivate
     bool handleNaNs;
     bool useConcatenations;
 
+    // Arena from which the temporary (non cached) image buffers of this render are allocated.
+    // The slabs are returned to the OS wholesale when the last image referencing it dies.
+    RenderImageArenaPtr imageArena;
+
+    // Wall-clock timer started when the render is created and CPU seconds accumulated by
+    // the thread-pool tasks of this render: their ratio is the parallelism actually achieved
+    TimeLapse lifeTimer;
+    mutable QMutex cpuTimeSpentMutex;
+    double cpuTimeSpentSec;
+
+    // Identifier of the user interaction that triggered this render, 0 for renders
+    // not tagged (playback, background renders). Set once in create(), immutable after.
+    // See InteractionLatencyTracker.
+    U64 interactionId;
+
 
     TreeRenderPrivate(TreeRender* publicInterface)
     : _publicInterface(publicInterface)
@@ -169,6 +193,11 @@ struct TreeRenderPrivate
     , aborted()
     , handleNaNs(true)
     , useConcatenations(true)
+    , imageArena(new RenderImageArena())
+    , lifeTimer()
+    , cpuTimeSpentMutex()
+    , cpuTimeSpentSec(0)
+    , interactionId(0)
     {
         aborted.fetchAndStoreAcquire(0);
 
@@ -223,7 +252,25 @@ TreeRender::TreeRender()
 
 TreeRender::~TreeRender()
 {
+    // Report the parallelism achieved by this render to the pool activity stats.
+    // A render that stayed sequential (e.g: a fully cached frame) has no CPU time recorded
+    // and would only drag the average down: skip it.
+    double cpuTimeSpentSec;
+    {
+        QMutexLocker k(&_imp->cpuTimeSpentMutex);
+        cpuTimeSpentSec = _imp->cpuTimeSpentSec;
+    }
+    if (cpuTimeSpentSec > 0) {
+        ThreadPoolActivity::notifyRenderFinished( cpuTimeSpentSec, _imp->lifeTimer.getTimeSinceCreation() );
+    }
+}
 
+void
+TreeRender::addCpuTimeSpent(double timeSec)
+{
+    QMutexLocker k(&_imp->cpuTimeSpentMutex);
+
+    _imp->cpuTimeSpentSec += timeSec;
 }
 
 
@@ -249,6 +296,13 @@ TreeRender::isExtraResultsRequestedForNode(const NodePtr& node) const
     return true;
 }
 
+FrameViewRequestPtr
+TreeRender::getOutputRequestBeingRendered() const
+{
+    QMutexLocker k(&_imp->outputRequestBeingRenderedMutex);
+    return _imp->outputRequestBeingRendered.lock();
+}
+
 bool
 TreeRender::getRotoPaintActiveStrokeUpdateArea(RectI* updateArea) const
 {
@@ -307,6 +361,12 @@ TreeRender::isPlayback() const
     return _imp->ctorArgs->playback;
 }
 
+U64
+TreeRender::getInteractionId() const
+{
+    return _imp->interactionId;
+}
+
 
 bool
 TreeRender::isDraftRender() const
@@ -351,6 +411,12 @@ TreeRender::getProxyScale() const
     return _imp->ctorArgs->proxyScale;
 }
 
+unsigned int
+TreeRender::getMipMapLevel() const
+{
+    return _imp->ctorArgs->mipMapLevel;
+}
+
 EffectInstancePtr
 TreeRender::getOriginalTreeRoot() const
 {
@@ -363,6 +429,12 @@ TreeRender::getStatsObject() const
     return _imp->ctorArgs->stats;
 }
 
+RenderImageArenaPtr
+TreeRender::getImageArena() const
+{
+    return _imp->imageArena;
+}
+
 void
 TreeRender::registerRenderClone(const KnobHolderPtr& holder)
 {
@@ -465,6 +537,11 @@ TreeRender::create(const CtorArgsPtr& inArgs)
 {
     TreeRenderPtr render(new TreeRender());
 
+    // Tag interactive renders with the identifier of the most recent user edit so that
+    // the viewer can report the edit to screen latency once the frame is displayed
+    if (!inArgs->playback) {
+        render->_imp->interactionId = InteractionLatencyTracker::getCurrentInteractionId();
+    }
 
     if (dynamic_cast<GroupInput*>(inArgs->treeRootEffect.get())) {
         // Hack for the GroupInput node: if the treeRoot passed is a GroupInput node we must forward to the corresponding input of the enclosing
@@ -620,8 +697,22 @@ public:
 
     virtual void run() OVERRIDE FINAL
     {
+#ifndef TREE_RENDER_DISABLE_MT
+        ThreadPoolActivity::notifyTaskStarted();
+#endif
+        // Seconds this task spent executing render requests, for the pool activity stats
+        // and the per-render parallelism accounting
+        double busyTimeSec = 0.;
 
         RequestPassSharedDataPtr sharedData = _sharedData.lock();
+        FrameViewRequestPtr request = _request.lock();
+
+        // Each iteration renders one request. When this request unlocks other requests,
+        // directly continue with one of them on this thread instead of round-tripping
+        // through the thread pool queue: the global Qt thread pool has a single shared
+        // queue and on wide graphs threads would sit idle waiting for the main render
+        // thread to wake up and re-submit runnables one by one.
+        for (;;) {
 
         ActionRetCodeEnum stat;
         {
@@ -629,14 +720,40 @@ public:
             stat = sharedData->_imp->stat;
         }
 
-        FrameViewRequestPtr request = _request.lock();
         EffectInstancePtr renderClone = request->getEffect();
 
         if (!isFailureRetCode(stat)) {
 #ifdef TRACE_RENDER_DEPENDENCIES
             qDebug() << sharedData.get() << "Launching render of" << renderClone->getScriptName_mt_safe().c_str() << request->getPlaneDesc().getPlaneLabel().c_str();
 #endif
+            TimeLapse renderTimer;
             stat = renderClone->launchRender(sharedData, request);
+
+            const double timeSpent = renderTimer.getTimeSinceCreation();
+            busyTimeSec += timeSpent;
+            {
+                QMutexLocker k(&_imp->cpuTimeSpentMutex);
+                _imp->cpuTimeSpentSec += timeSpent;
+            }
+        }
+
+        if (stat == eActionStatusWaitingForResults) {
+            // All tiles left to render for this request are being computed by other threads:
+            // re-queue the request so this thread can process another dependency-free request
+            // instead of blocking. Keep the rendered dependencies around: the retry may still
+            // need them if pending tiles get aborted by the other threads.
+            QMutexLocker k(&sharedData->_imp->dependencyFreeRendersMutex);
+#ifdef TRACE_RENDER_DEPENDENCIES
+            qDebug() << sharedData.get() << "Re-queuing" << renderClone->getScriptName_mt_safe().c_str() << request->getPlaneDesc().getPlaneLabel().c_str() << "(" << request.get() << ") because its tiles are pending in another thread";
+#endif
+            sharedData->_imp->dependencyFreeRenders->insert(request);
+
+            // Notify the main render thread so that it re-launches this request
+            sharedData->_imp->dependencyFreeRendersEmptyCond.wakeOne();
+#ifndef TREE_RENDER_DISABLE_MT
+            ThreadPoolActivity::notifyTaskDone(busyTimeSec);
+#endif
+            return;
         }
 
         // Remove all stashed input frame view requests that we kept around.
@@ -684,8 +801,29 @@ public:
             }
         }
 
-        // Notify the main render thread that some more stuff can be rendered (or that we are done)
-        sharedData->_imp->dependencyFreeRendersEmptyCond.wakeOne();
+        // Pick the next dependency-free request to render on this thread. The set is
+        // ordered so we still dequeue the highest priority request first.
+        FrameViewRequestPtr nextRequest;
+        if ( !sharedData->_imp->dependencyFreeRenders->empty() ) {
+            nextRequest = *sharedData->_imp->dependencyFreeRenders->begin();
+            sharedData->_imp->dependencyFreeRenders->erase( sharedData->_imp->dependencyFreeRenders->begin() );
+        }
+
+        // Notify the main render thread if there are other requests for it to dispatch
+        // to more threads, or if we are done.
+        if ( !nextRequest || !sharedData->_imp->dependencyFreeRenders->empty() || sharedData->_imp->allRenderTasksToProcess.empty() ) {
+            sharedData->_imp->dependencyFreeRendersEmptyCond.wakeOne();
+        }
+
+        if (!nextRequest) {
+#ifndef TREE_RENDER_DISABLE_MT
+            ThreadPoolActivity::notifyTaskDone(busyTimeSec);
+#endif
+            return;
+        }
+        request = nextRequest;
+
+        } // for (;;)
     }
 };
 
@@ -746,6 +884,45 @@ TreeRenderPrivate::launchRenderInternal(bool removeRenderClonesWhenFinished,
             return stat;
         }
     }
+
+    // Out-of-core rendering: when the frame is estimated to exceed the resident image RAM budget,
+    // render it first in sequential vertical bands. Each band goes through the regular request pass
+    // below, so completed intermediate tiles are pushed to the cache, which spills them to its disk
+    // storage under memory pressure. The final full-RoI pass then assembles the frame mostly from
+    // cached tiles instead of holding every intermediate image of the graph in RAM at once, bounding
+    // the frame size by disk space rather than RAM.
+    // This cannot work if the cache is bypassed and is pointless in draft mode which lowers the
+    // resolution anyway.
+    if (removeRenderClonesWhenFinished && !ctorArgs->byPassCache && !ctorArgs->draftMode) {
+        std::size_t residentBudget = appPTR->getCurrentSettings()->getMaxFrameRenderRAMSize();
+        if (residentBudget > 0) {
+            RectI pixelRoI;
+            double par = rootRenderClone->getAspectRatio(-1);
+            canonicalRoI.toPixelEnclosing(scale, par, &pixelRoI);
+            std::size_t frameBytes = (std::size_t)pixelRoI.width() * pixelRoI.height() * plane.getNumComponents() * sizeof(float);
+            if (frameBytes > residentBudget) {
+                int nBands = (int)std::ceil( (double)frameBytes / residentBudget );
+                nBands = std::min( nBands, pixelRoI.width() );
+                double bandWidth = canonicalRoI.width() / nBands;
+                for (int i = 0; i < nBands; ++i) {
+                    if ( _publicInterface->isRenderAborted() ) {
+                        return eActionStatusAborted;
+                    }
+                    RectD bandRoI = canonicalRoI;
+                    bandRoI.x1 = canonicalRoI.x1 + i * bandWidth;
+                    if (i < nBands - 1) {
+                        bandRoI.x2 = bandRoI.x1 + bandWidth;
+                    }
+                    FrameViewRequestPtr bandRequest;
+                    ActionRetCodeEnum bandStat = launchRenderInternal(false /*removeRenderClonesWhenFinished*/, treeRoot, time, view, proxyScale, mipMapLevel, &plane, &bandRoI, &bandRequest);
+                    if (isFailureRetCode(bandStat)) {
+                        return bandStat;
+                    }
+                }
+            }
+        }
+    }
+
     ActionRetCodeEnum stat = eActionStatusOK;
     {
         RequestPassSharedDataPtr requestData(new RequestPassSharedData());
@@ -765,6 +942,13 @@ TreeRenderPrivate::launchRenderInternal(bool removeRenderClonesWhenFinished,
             if (isFailureRetCode(stat)) {
                 return stat;
             }
+
+            // Publish the root request so that getOutputRequestBeingRendered() may return it
+            // whilst the tasks below execute
+            if (treeRoot == ctorArgs->treeRootEffect) {
+                QMutexLocker k(&outputRequestBeingRenderedMutex);
+                outputRequestBeingRendered = *outputRequest;
+            }
         }
 
         // At this point, the request pass should have created the first batch of dependency-free renders.
@@ -783,6 +967,14 @@ TreeRenderPrivate::launchRenderInternal(bool removeRenderClonesWhenFinished,
 #ifndef TREE_RENDER_DISABLE_MT
         QThreadPool* threadPool = QThreadPool::globalInstance();
         bool isThreadPoolThread = isRunningInThreadPoolThread();
+
+        // Scheduling class of this render's tasks: viewer renders are dequeued before
+        // background render tasks so that a queued render on disk does not delay the
+        // viewer while the user interacts with it, see ThreadPoolTaskPriorityEnum.
+        int taskPoolPriority = (int)eThreadPoolTaskPriorityBackgroundRender;
+        if ( appPTR->getCurrentSettings()->isViewerRenderPrioritized() && treeRoot->getNode()->isEffectViewerInstance() ) {
+            taskPoolPriority = (int)eThreadPoolTaskPriorityViewerInteractive;
+        }
 #endif
 
         // See bug https://bugreports.qt.io/browse/QTBUG-20251
@@ -811,7 +1003,8 @@ TreeRenderPrivate::launchRenderInternal(bool removeRenderClonesWhenFinished,
 #else
                 runnable->setAutoDelete(false);
                 runnables.push_back(runnable);
-                threadPool->start(runnable.get());
+                ThreadPoolActivity::notifyTaskDispatched();
+                threadPool->start(runnable.get(), taskPoolPriority);
 #endif
             }
 
@@ -819,15 +1012,20 @@ TreeRenderPrivate::launchRenderInternal(bool removeRenderClonesWhenFinished,
             // If this thread is a threadpool thread, it may wait for a while that results gets available.
             // Release the thread to the thread pool so that it may use this thread for other runnables
             // and reserve it back when done waiting.
+            // The time spent waiting is idle-waiting on the tasks of this render: report
+            // it to the pool activity stats when this thread belongs to the pool.
+            boost::scoped_ptr<TimeLapse> waitTimer;
             if (isThreadPoolThread) {
                 QThreadPool::globalInstance()->releaseThread();
+                waitTimer.reset(new TimeLapse);
             }
 
             // Wait until a task is finished: we should be able to launch more tasks afterwards.
             requestData->_imp->dependencyFreeRendersEmptyCond.wait(&requestData->_imp->dependencyFreeRendersMutex);
-            
+
             if (isThreadPoolThread) {
                 QThreadPool::globalInstance()->reserveThread();
+                ThreadPoolActivity::notifyIdleWait( waitTimer->getTimeSinceCreation() );
             }
 #endif   
             numTasksRemaining = requestData->_imp->allRenderTasksToProcess.size();
@@ -196,6 +196,11 @@ public:
      **/
     const RenderScale& getProxyScale() const;
 
+    /**
+     * @brief The mipmap level requested at the tree root
+     **/
+    unsigned int getMipMapLevel() const;
+
     /**
      * @brief Returns the tre root passed to create()
      **/
@@ -216,6 +221,13 @@ public:
      **/
     bool isPlayback() const;
 
+    /**
+     * @brief Returns the identifier of the user interaction that triggered this render,
+     * or 0 if the render was not tagged (playback and background renders).
+     * See InteractionLatencyTracker.
+     **/
+    U64 getInteractionId() const;
+
     /**
      * @brief Returns whether this render is a bad quality render (typically used when scrubbing a slider or the timeline) or normal quality render
      **/
@@ -248,6 +260,14 @@ public:
      **/
     bool isExtraResultsRequestedForNode(const NodePtr& node) const;
 
+    /**
+     * @brief While launchRender() is executing, returns the request created for the tree root by
+     * the request pass, so that a caller may observe the image as it is being rendered, e.g: to
+     * display the tiles that are done from another thread. Returns NULL until the request pass
+     * completed.
+     **/
+    FrameViewRequestPtr getOutputRequestBeingRendered() const;
+
     /**
      * @brief While drawing a preview with the RotoPaint node, this is the bounding box of the area
      * to update on the viewer.
@@ -261,6 +281,20 @@ public:
      **/
     RenderStatsPtr getStatsObject() const;
 
+    /**
+     * @brief Adds CPU time spent by one of the thread-pool tasks of this render.
+     * The accumulated total is compared to the wall time of the render when it is
+     * destroyed to compute the parallelism factor actually achieved, reported by
+     * ThreadPoolActivity::getStats().
+     **/
+    void addCpuTimeSpent(double timeSec);
+
+    /**
+     * @brief Returns the arena from which the temporary (non cached) image buffers
+     * of this render are allocated
+     **/
+    RenderImageArenaPtr getImageArena() const;
+
     /**
      * @brief Get the OpenGL context associated to this render
      **/
@@ -0,0 +1,441 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2013-2017 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "UndoStateStore.h"
+
+#include <algorithm> // min
+#include <cassert>
+#include <cstring> // memcpy
+#include <map>
+#include <sstream> // stringstream
+#include <stdexcept>
+
+CLANG_DIAG_OFF(deprecated)
+CLANG_DIAG_OFF(uninitialized)
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QMutex>
+#include <QtCore/QString>
+CLANG_DIAG_ON(deprecated)
+CLANG_DIAG_ON(uninitialized)
+
+#include "Global/FStreamsSupport.h"
+#include "Global/QtCompat.h"
+
+#include "Engine/AppManager.h"
+#include "Engine/Hash64.h"
+#include "Engine/Settings.h"
+#include "Engine/StandardPaths.h"
+
+#include "Serialization/KnobSerialization.h"
+#include "Serialization/KnobTableItemSerialization.h"
+#include "Serialization/NodeSerialization.h"
+#include "Serialization/SerializationIO.h"
+
+NATRON_NAMESPACE_ENTER;
+
+struct UndoStateStorePrivate
+{
+    // Protects the index, the LRU list and the payloads data/spill state
+    QMutex lock;
+
+    // Content-addressed index of all live payloads. The list resolves the (unlikely) case of
+    // two different documents hashing to the same value: they are told apart by their size
+    typedef std::map<U64, std::list<UndoStatePayloadWPtr> > PayloadsMap;
+    PayloadsMap index;
+
+    // Payloads ordered from least to most recently stored or fetched, for the spilling decision
+    std::list<UndoStatePayloadWPtr> lru;
+
+    // Where spilled payloads are written; created lazily on the first spill,
+    // removed by the destructor
+    std::string spillDirPath;
+
+    UndoStateStorePrivate()
+    : lock()
+    , index()
+    , lru()
+    , spillDirPath()
+    {
+    }
+
+    // All functions below are called with the lock taken
+
+    std::string getOrCreateSpillDirPath();
+
+    void touch(const UndoStatePayloadPtr& payload);
+
+    bool spill(const UndoStatePayloadPtr& payload);
+
+    bool reload(const UndoStatePayloadPtr& payload);
+
+    void evictIfNeeded();
+};
+
+UndoStatePayload::UndoStatePayload()
+: _hash(0)
+, _size(0)
+, _data()
+, _spillFilePath()
+{
+}
+
+UndoStatePayload::~UndoStatePayload()
+{
+    // Nobody holds a reference anymore hence no concurrent access: the spill file is no
+    // longer needed
+    if ( !_spillFilePath.empty() ) {
+        QFile::remove( QString::fromUtf8( _spillFilePath.c_str() ) );
+    }
+}
+
+UndoStateStore::UndoStateStore()
+: _imp(new UndoStateStorePrivate)
+{
+}
+
+UndoStateStore::~UndoStateStore()
+{
+    if ( !_imp->spillDirPath.empty() ) {
+        QDir dir( QString::fromUtf8( _imp->spillDirPath.c_str() ) );
+        if ( dir.exists() ) {
+            QtCompat::removeRecursively( dir.absolutePath() );
+        }
+    }
+}
+
+/**
+ * @brief Hash the serialized document bytes. The document is hashed as unsigned 64-bit words
+ * (plus its length) because Hash64 appends typed values, it has no raw buffer variant.
+ **/
+static U64 hashPayloadData(const std::string& data)
+{
+    Hash64 hash;
+
+    for (std::size_t i = 0; i < data.size(); i += sizeof(U64)) {
+        U64 word = 0;
+        std::memcpy( &word, data.data() + i, std::min( sizeof(U64), data.size() - i ) );
+        hash.append(word);
+    }
+    hash.append( (U64)data.size() );
+    hash.computeHash();
+
+    return hash.value();
+}
+
+std::string
+UndoStateStorePrivate::getOrCreateSpillDirPath()
+{
+    if ( !spillDirPath.empty() ) {
+        return spillDirPath;
+    }
+
+    // Use the same location as the disk cache, see getCacheDirPath() in Cache.cpp: the
+    // user-provided directory if it exists, otherwise the standard cache location.
+    std::string cachePath = appPTR->getCurrentSettings()->getDiskCachePath();
+    bool userDirExists;
+    if ( cachePath.empty() ) {
+        userDirExists = false;
+    } else {
+        QDir d( QString::fromUtf8( cachePath.c_str() ) );
+        userDirExists = d.exists();
+    }
+    if (!userDirExists) {
+        cachePath = StandardPaths::writableLocation(StandardPaths::eStandardLocationCache).toStdString();
+    }
+
+    // The directory is per-process so that concurrent instances do not delete each other's
+    // spilled states
+    std::stringstream ss;
+    ss << cachePath << '/' << NATRON_APPLICATION_NAME << "UndoStates_" << (qint64)QCoreApplication::applicationPid();
+    QString dirPath = QString::fromUtf8( ss.str().c_str() );
+    QDir().mkpath(dirPath);
+
+    spillDirPath = ss.str();
+
+    return spillDirPath;
+}
+
+void
+UndoStateStorePrivate::touch(const UndoStatePayloadPtr& payload)
+{
+    for (std::list<UndoStatePayloadWPtr>::iterator it = lru.begin(); it != lru.end(); ++it) {
+        if (it->lock() == payload) {
+            lru.erase(it);
+            break;
+        }
+    }
+    lru.push_back(payload);
+}
+
+bool
+UndoStateStorePrivate::spill(const UndoStatePayloadPtr& payload)
+{
+    assert(payload->_data);
+
+    if ( payload->_spillFilePath.empty() ) {
+        std::stringstream ss;
+        ss << getOrCreateSpillDirPath() << '/' << std::hex << payload->_hash << '-' << std::dec << payload->_size;
+
+        FStreamsSupport::ofstream ofile;
+        // Binary mode so that the document size on disk matches _size exactly
+        FStreamsSupport::open( &ofile, ss.str(), std::ios_base::out | std::ios_base::binary );
+        if (!ofile) {
+            return false;
+        }
+        ofile.write( payload->_data->data(), payload->_data->size() );
+        if (!ofile) {
+            return false;
+        }
+        payload->_spillFilePath = ss.str();
+    }
+    // The file already exists if the payload was spilled, reloaded then evicted again
+    payload->_data.reset();
+
+    return true;
+}
+
+bool
+UndoStateStorePrivate::reload(const UndoStatePayloadPtr& payload)
+{
+    assert( !payload->_data && !payload->_spillFilePath.empty() );
+
+    FStreamsSupport::ifstream ifile;
+    FStreamsSupport::open(&ifile, payload->_spillFilePath, std::ios_base::in | std::ios_base::binary);
+    if (!ifile) {
+        return false;
+    }
+    boost::shared_ptr<std::string> data( new std::string() );
+    data->resize(payload->_size);
+    ifile.read( &(*data)[0], payload->_size );
+    if ( (std::size_t)ifile.gcount() != payload->_size ) {
+        return false;
+    }
+    payload->_data = data;
+
+    return true;
+}
+
+void
+UndoStateStorePrivate::evictIfNeeded()
+{
+    const std::size_t maxRAMSize = appPTR->getCurrentSettings()->getUndoStateRAMCacheSize();
+
+    // Compute the RAM retained by live payloads, pruning expired entries along the way
+    std::size_t totalRAMSize = 0;
+    for (std::list<UndoStatePayloadWPtr>::iterator it = lru.begin(); it != lru.end();) {
+        UndoStatePayloadPtr p = it->lock();
+        if (!p) {
+            std::list<UndoStatePayloadWPtr>::iterator toErase = it;
+            ++it;
+            lru.erase(toErase);
+            continue;
+        }
+        if (p->_data) {
+            totalRAMSize += p->_size;
+        }
+        ++it;
+    }
+    for (PayloadsMap::iterator it = index.begin(); it != index.end();) {
+        for (std::list<UndoStatePayloadWPtr>::iterator it2 = it->second.begin(); it2 != it->second.end();) {
+            if ( it2->expired() ) {
+                std::list<UndoStatePayloadWPtr>::iterator toErase = it2;
+                ++it2;
+                it->second.erase(toErase);
+            } else {
+                ++it2;
+            }
+        }
+        if ( it->second.empty() ) {
+            PayloadsMap::iterator toErase = it;
+            ++it;
+            index.erase(toErase);
+        } else {
+            ++it;
+        }
+    }
+
+    // Spill the least recently used payloads until we are back under the cap
+    for (std::list<UndoStatePayloadWPtr>::iterator it = lru.begin(); it != lru.end() && totalRAMSize > maxRAMSize; ++it) {
+        UndoStatePayloadPtr p = it->lock();
+        if (!p || !p->_data) {
+            continue;
+        }
+        if ( spill(p) ) {
+            totalRAMSize -= p->_size;
+        }
+    }
+} // evictIfNeeded
+
+UndoStatePayloadPtr
+UndoStateStore::storeState(const SERIALIZATION_NAMESPACE::SerializationObjectBase& object)
+{
+    boost::shared_ptr<std::string> data( new std::string() );
+    {
+        std::ostringstream ss;
+        SERIALIZATION_NAMESPACE::write( ss, object, std::string() );
+        *data = ss.str();
+    }
+    const U64 hash = hashPayloadData(*data);
+
+    QMutexLocker k(&_imp->lock);
+
+    // Structural sharing: if the exact same document is already stored, hand out the
+    // existing payload
+    UndoStateStorePrivate::PayloadsMap::iterator found = _imp->index.find(hash);
+    if ( found != _imp->index.end() ) {
+        for (std::list<UndoStatePayloadWPtr>::const_iterator it = found->second.begin(); it != found->second.end(); ++it) {
+            UndoStatePayloadPtr p = it->lock();
+            if ( p && (p->_size == data->size()) ) {
+                _imp->touch(p);
+
+                return p;
+            }
+        }
+    }
+
+    UndoStatePayloadPtr payload( new UndoStatePayload() );
+    payload->_hash = hash;
+    payload->_size = data->size();
+    payload->_data = data;
+    _imp->index[hash].push_back(payload);
+    _imp->lru.push_back(payload);
+
+    _imp->evictIfNeeded();
+
+    return payload;
+} // storeState
+
+bool
+UndoStateStore::fetchState(const UndoStatePayloadPtr& payload, SERIALIZATION_NAMESPACE::SerializationObjectBase* obj)
+{
+    if (!payload || !obj) {
+        return false;
+    }
+
+    boost::shared_ptr<std::string> data;
+    {
+        QMutexLocker k(&_imp->lock);
+        if (!payload->_data) {
+            if ( !_imp->reload(payload) ) {
+                return false;
+            }
+        }
+        data = payload->_data;
+        _imp->touch(payload);
+        _imp->evictIfNeeded();
+    }
+
+    try {
+        SERIALIZATION_NAMESPACE::RawBufferIStream ss( data->data(), data->size() );
+        SERIALIZATION_NAMESPACE::read(std::string(), ss, obj);
+    } catch (const std::exception&) {
+        return false;
+    }
+
+    return true;
+} // fetchState
+
+UndoNodeStatePtr
+UndoStateStore::storeNodeState(const SERIALIZATION_NAMESPACE::NodeSerializationPtr& state)
+{
+    assert(state);
+
+    UndoNodeStatePtr ret( new UndoNodeState() );
+
+    // Strip the knobs and the items-table from the document so that the skeleton payload
+    // only changes when the node structure itself does, then restore them on the way out
+    SERIALIZATION_NAMESPACE::KnobSerializationList knobs;
+    knobs.swap(state->_knobsValues);
+    SERIALIZATION_NAMESPACE::KnobItemsTableSerializationPtr table = state->_tableModel;
+    state->_tableModel.reset();
+
+    ret->skeleton = storeState(*state);
+
+    state->_knobsValues.swap(knobs);
+    state->_tableModel = table;
+
+    for (SERIALIZATION_NAMESPACE::KnobSerializationList::const_iterator it = state->_knobsValues.begin(); it != state->_knobsValues.end(); ++it) {
+        ret->knobs.push_back( storeState(**it) );
+    }
+
+    if (table) {
+        ret->hasTable = true;
+        ret->tableNodeScriptName = table->nodeScriptName;
+        ret->tableIdentifier = table->tableIdentifier;
+
+        // Encode each item wrapped in its own single-item table document: the table
+        // encoding carries the item type tag, so decoding goes through the item factory
+        // and re-creates the concrete serialization class (bezier, stroke, track...)
+        for (std::list<SERIALIZATION_NAMESPACE::KnobTableItemSerializationPtr>::const_iterator it = table->items.begin(); it != table->items.end(); ++it) {
+            SERIALIZATION_NAMESPACE::KnobItemsTableSerialization itemTable;
+            itemTable.nodeScriptName = table->nodeScriptName;
+            itemTable.tableIdentifier = table->tableIdentifier;
+            itemTable.items.push_back(*it);
+            ret->items.push_back( storeState(itemTable) );
+        }
+    }
+
+    return ret;
+} // storeNodeState
+
+SERIALIZATION_NAMESPACE::NodeSerializationPtr
+UndoStateStore::fetchNodeState(const UndoNodeStatePtr& state)
+{
+    if (!state) {
+        return SERIALIZATION_NAMESPACE::NodeSerializationPtr();
+    }
+
+    SERIALIZATION_NAMESPACE::NodeSerializationPtr ret( new SERIALIZATION_NAMESPACE::NodeSerialization() );
+    if ( !fetchState( state->skeleton, ret.get() ) ) {
+        return SERIALIZATION_NAMESPACE::NodeSerializationPtr();
+    }
+
+    for (std::list<UndoStatePayloadPtr>::const_iterator it = state->knobs.begin(); it != state->knobs.end(); ++it) {
+        SERIALIZATION_NAMESPACE::KnobSerializationPtr knob( new SERIALIZATION_NAMESPACE::KnobSerialization() );
+        if ( !fetchState( *it, knob.get() ) ) {
+            return SERIALIZATION_NAMESPACE::NodeSerializationPtr();
+        }
+        ret->_knobsValues.push_back(knob);
+    }
+
+    if (state->hasTable) {
+        SERIALIZATION_NAMESPACE::KnobItemsTableSerializationPtr table( new SERIALIZATION_NAMESPACE::KnobItemsTableSerialization() );
+        table->nodeScriptName = state->tableNodeScriptName;
+        table->tableIdentifier = state->tableIdentifier;
+        for (std::list<UndoStatePayloadPtr>::const_iterator it = state->items.begin(); it != state->items.end(); ++it) {
+            SERIALIZATION_NAMESPACE::KnobItemsTableSerialization itemTable;
+            if ( !fetchState(*it, &itemTable) || itemTable.items.empty() ) {
+                return SERIALIZATION_NAMESPACE::NodeSerializationPtr();
+            }
+            table->items.push_back( itemTable.items.front() );
+        }
+        ret->_tableModel = table;
+    }
+
+    return ret;
+} // fetchNodeState
+
+NATRON_NAMESPACE_EXIT;
@@ -0,0 +1,178 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2013-2017 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef NATRON_ENGINE_UNDOSTATESTORE_H
+#define NATRON_ENGINE_UNDOSTATESTORE_H
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <list>
+#include <string>
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/shared_ptr.hpp>
+#include <boost/scoped_ptr.hpp>
+#endif
+
+#include "Global/GlobalDefines.h"
+
+#include "Engine/EngineFwd.h"
+#include "Serialization/SerializationFwd.h"
+
+NATRON_NAMESPACE_ENTER;
+
+struct UndoStateStorePrivate;
+
+/**
+ * @brief A serialized state snapshot held by an undo command in the UndoStateStore.
+ * Payloads are content-addressed: two identical states stored by different commands (or by
+ * successive snapshots of the same object in which that portion did not change) resolve to
+ * the same payload object, so the bytes exist only once. The payload bytes live in RAM until
+ * the store decides to spill them to the disk cache to honor the undo memory cap, which is
+ * transparent to the holder: fetching a spilled payload reloads it.
+ **/
+class UndoStatePayload
+{
+public:
+
+    ~UndoStatePayload();
+
+    /**
+     * @brief The size in bytes of the serialized state.
+     **/
+    std::size_t getSize() const
+    {
+        return _size;
+    }
+
+private:
+
+    friend class UndoStateStore;
+
+    UndoStatePayload();
+
+    // Content hash of the serialized document, the key in the store index
+    U64 _hash;
+
+    // Byte size of the serialized document
+    std::size_t _size;
+
+    // The serialized document; reset when the payload is spilled to disk.
+    // Protected by the store lock
+    boost::shared_ptr<std::string> _data;
+
+    // Non-empty once the payload has been written to the spill directory.
+    // The file is removed by the destructor. Protected by the store lock
+    std::string _spillFilePath;
+};
+
+/**
+ * @brief The delta-friendly decomposition of a node state held by node-level undo commands.
+ * Instead of one monolithic NodeSerialization document, the state is split into one payload
+ * for the node skeleton (inputs, position, user pages...), one payload per knob and one
+ * payload per items-table item (e.g: per paint stroke). Since payloads are content-addressed
+ * by the UndoStateStore, successive snapshots of the same node share every knob and item that
+ * did not change in-between, so e.g: during a painting session each undo step only costs the
+ * newly painted stroke.
+ **/
+struct UndoNodeState
+{
+    // The NodeSerialization with its knobs and items-table stripped out
+    UndoStatePayloadPtr skeleton;
+
+    // One payload per knob of the node
+    std::list<UndoStatePayloadPtr> knobs;
+
+    // Whether the node had an items-table when the state was taken: the table may exist
+    // but be empty, in which case items is empty too but the table must be re-created
+    bool hasTable;
+
+    // Identifiers needed to rebuild an empty KnobItemsTableSerialization
+    std::string tableNodeScriptName, tableIdentifier;
+
+    // One payload per top-level item of the items-table, each encoded as a single-item
+    // table document so that the item type tag round-trips through the item factory
+    std::list<UndoStatePayloadPtr> items;
+
+    UndoNodeState()
+    : skeleton()
+    , knobs()
+    , hasTable(false)
+    , tableNodeScriptName()
+    , tableIdentifier()
+    , items()
+    {
+    }
+};
+
+/**
+ * @brief Process-wide storage for the serialized states retained by undo commands, see
+ * AppManager::getUndoStateStore(). Commands hold UndoStatePayloadPtr handles instead of
+ * serialization objects: the store de-duplicates identical states (structural sharing) and
+ * bounds the total RAM retained by the undo stacks, see Settings::getUndoStateRAMCacheSize(),
+ * by spilling the least recently used payloads to a directory in the disk cache instead of
+ * letting undo history grow unbounded in memory. Only used on the main-thread.
+ **/
+class UndoStateStore
+{
+public:
+
+    UndoStateStore();
+
+    ~UndoStateStore();
+
+    /**
+     * @brief Serialize the given object and store the resulting document, returning a handle
+     * on it. If an identical document is already stored, its existing payload is returned.
+     **/
+    UndoStatePayloadPtr storeState(const SERIALIZATION_NAMESPACE::SerializationObjectBase& object);
+
+    /**
+     * @brief Decode the document held by the given payload into obj, reloading it from the
+     * spill directory first if it was spilled. Returns false if the payload could not be
+     * reloaded or decoded.
+     **/
+    bool fetchState(const UndoStatePayloadPtr& payload, SERIALIZATION_NAMESPACE::SerializationObjectBase* obj);
+
+    /**
+     * @brief Store the given node state split per-knob and per-table-item so that successive
+     * snapshots of the same node share their unchanged parts, see UndoNodeState.
+     * The serialization object is left unchanged.
+     **/
+    UndoNodeStatePtr storeNodeState(const SERIALIZATION_NAMESPACE::NodeSerializationPtr& state);
+
+    /**
+     * @brief Reassemble a NodeSerialization from a state returned by storeNodeState().
+     * Returns a null pointer if any payload could not be fetched.
+     **/
+    SERIALIZATION_NAMESPACE::NodeSerializationPtr fetchNodeState(const UndoNodeStatePtr& state);
+
+private:
+
+    boost::scoped_ptr<UndoStateStorePrivate> _imp;
+};
+
+NATRON_NAMESPACE_EXIT;
+
+#endif // NATRON_ENGINE_UNDOSTATESTORE_H
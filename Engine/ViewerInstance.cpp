@@ -523,6 +523,14 @@ ViewerInstance::appendToHash(const ComputeHashArgs& args, Hash64* hash)
         // We rely on the viewers bit depth setting knob in the getTimeInvariantMetadata() function
         // so make sure it is part of the hash.
         appPTR->getCurrentSettings()->getViewerBitDepthKnob()->appendToHash(args, hash);
+
+        if ( appPTR->getCurrentSettings()->isViewerBitDepthAutomatic() ) {
+            // In automatic bit depth mode, getTimeInvariantMetadata() also depends on whether the
+            // color transform is neutral, so the metadata must be refreshed when these knobs change.
+            _imp->gainKnob.lock()->appendToHash(args, hash);
+            _imp->gammaKnob.lock()->appendToHash(args, hash);
+            _imp->autoContrastKnob.lock()->appendToHash(args, hash);
+        }
     }
 }
 
@@ -538,6 +546,17 @@ ViewerInstance::getTimeInvariantMetadata(NodeMetadata& metadata)
 
     // Output however can be 8-bit
     ImageBitDepthEnum outputDepth = appPTR->getCurrentSettings()->getViewersBitDepth();
+
+    if ( appPTR->getCurrentSettings()->isViewerBitDepthAutomatic() ) {
+        // Automatic bit depth: upload 8-bit textures while the color transform is neutral (4x less
+        // upload bandwidth) and switch to float textures when it is not, so that the transform is
+        // applied by the GPU at draw time and tweaking the gain/gamma does not re-render, see render().
+        // The gain is an exponent (render() applies pow(2, gain)) so 0 is the neutral value.
+        bool colorTransformIsNeutral = _imp->gainKnob.lock()->getValue() == 0. &&
+                                       _imp->gammaKnob.lock()->getValue() == 1. &&
+                                       !_imp->autoContrastKnob.lock()->getValue();
+        outputDepth = colorTransformIsNeutral ? eImageBitDepthByte : eImageBitDepthFloat;
+    }
     metadata.setBitDepth(-1, outputDepth);
 
 
@@ -1626,14 +1645,24 @@ ViewerInstance::render(const RenderActionArgs& args)
 
     dstImage->getCPUData(&renderViewerArgs.dstImage);
 
-    renderViewerArgs.gamma = _imp->gammaKnob.lock()->getValue();
+    bool doAutoContrast = _imp->autoContrastKnob.lock()->getValue();
+
+    // When the output texture is 32-bit floating point, the gain/gamma/colorspace display transform
+    // is applied by the viewer in a fragment shader at draw time, see ViewerGL::Implementation::activateShaderRGB():
+    // keep the pixels linear here so that the image does not have to be re-converted on the CPU.
+    // Auto-contrast is excepted: its gain/offset depend on an analysis of the image which is done here.
+    const bool applyColorTransformOnGPU = bitdepth == eImageBitDepthFloat && !doAutoContrast;
+
+    renderViewerArgs.gamma = applyColorTransformOnGPU ? 1. : _imp->gammaKnob.lock()->getValue();
 
     RamBuffer<float> gammaLut;
     ViewerInstancePrivate::buildGammaLut(renderViewerArgs.gamma, &gammaLut);
     renderViewerArgs.gammaLut = gammaLut.getData();
 
-    bool doAutoContrast = _imp->autoContrastKnob.lock()->getValue();
-    if (!doAutoContrast) {
+    if (applyColorTransformOnGPU) {
+        renderViewerArgs.gain = 1.;
+        renderViewerArgs.offset = 0;
+    } else if (!doAutoContrast) {
         renderViewerArgs.gain = _imp->gainKnob.lock()->getValue();
         renderViewerArgs.gain = std::pow(2, renderViewerArgs.gain);
         renderViewerArgs.offset = 0;
@@ -1664,7 +1693,7 @@ ViewerInstance::render(const RenderActionArgs& args)
     }
 
     renderViewerArgs.srcColorspace = lutFromColorspace(getApp()->getDefaultColorSpaceForBitDepth(getBitDepth(0)));
-    renderViewerArgs.dstColorspace = lutFromColorspace((ViewerColorSpaceEnum)_imp->outputColorspace.lock()->getValue());
+    renderViewerArgs.dstColorspace = applyColorTransformOnGPU ? 0 : lutFromColorspace((ViewerColorSpaceEnum)_imp->outputColorspace.lock()->getValue());
 
 
     ViewerProcessor processor(shared_from_this());
@@ -25,6 +25,9 @@
 #include "ViewerNode.h"
 #include "ViewerNodePrivate.h"
 
+// The latency target (in milliseconds) that getAdaptiveProxyMipMapLevel() tries to meet when
+// choosing the mipmap level for auto-proxy renders while scrubbing the timeline.
+#define NATRON_VIEWER_ADAPTIVE_PROXY_TARGET_LATENCY_MS 50
 
 
 
@@ -670,6 +673,18 @@ ViewerNode::getColorspace() const
     return (ViewerColorSpaceEnum)_imp->colorspaceKnob.lock()->getValue();
 }
 
+double
+ViewerNode::getGain() const
+{
+    return _imp->gainSliderKnob.lock()->getValue();
+}
+
+double
+ViewerNode::getGamma() const
+{
+    return _imp->gammaSliderKnob.lock()->getValue();
+}
+
 OpenGLViewerI*
 ViewerNode::getUiContext() const
 {
@@ -1056,6 +1071,57 @@ ViewerNode::getMipMapLevelFromZoomFactor() const
 
 }
 
+void
+ViewerNode::reportInteractiveRenderDuration(double seconds, unsigned int mipMapLevel)
+{
+    QMutexLocker k(&_imp->lastRenderDurationMutex);
+
+    _imp->lastInteractiveRenderDurationSeconds = seconds;
+    _imp->lastInteractiveRenderMipMapLevel = mipMapLevel;
+}
+
+double
+ViewerNode::getLastInteractiveRenderDurationSeconds() const
+{
+    QMutexLocker k(&_imp->lastRenderDurationMutex);
+
+    return _imp->lastInteractiveRenderDurationSeconds;
+}
+
+unsigned int
+ViewerNode::getAdaptiveProxyMipMapLevel(unsigned int maxMipMapLevel) const
+{
+    double lastDurationSeconds;
+    unsigned int lastMipMapLevel;
+    {
+        QMutexLocker k(&_imp->lastRenderDurationMutex);
+        lastDurationSeconds = _imp->lastInteractiveRenderDurationSeconds;
+        lastMipMapLevel = _imp->lastInteractiveRenderMipMapLevel;
+    }
+
+    if (lastDurationSeconds <= 0.) {
+        // No render was measured yet: fallback on the level set in the preferences
+        return maxMipMapLevel;
+    }
+
+    // Estimate the duration of a full resolution render: each mipmap level divides the number of
+    // pixels to render by 4
+    if (lastMipMapLevel > 15) {
+        lastMipMapLevel = 15;
+    }
+    double fullResSeconds = lastDurationSeconds * (double)(1u << (2 * lastMipMapLevel));
+
+    // Pick the smallest mipmap level for which the estimated render duration meets the latency target
+    const double targetSeconds = NATRON_VIEWER_ADAPTIVE_PROXY_TARGET_LATENCY_MS / 1000.;
+    unsigned int mipMapLevel = 0;
+    while (mipMapLevel < maxMipMapLevel && fullResSeconds > targetSeconds) {
+        fullResSeconds /= 4.;
+        ++mipMapLevel;
+    }
+
+    return mipMapLevel;
+}
+
 void
 ViewerNode::updateViewer(const UpdateViewerArgs& args)
 {
@@ -1088,6 +1154,8 @@ ViewerNode::updateViewer(const UpdateViewerArgs& args)
             transferArgs.viewportCenter = args.viewerCenter;
             transferArgs.viewerProcessNodeKey = it->viewerProcessImageKey;
             transferArgs.type = args.type;
+            transferArgs.byPassCache = args.byPassCache;
+            transferArgs.interactionId = args.interactionId;
             uiContext->transferBufferFromRAMtoGPU(transferArgs);
         }
 
@@ -182,6 +182,10 @@ public:
 
     ViewerColorSpaceEnum getColorspace() const;
 
+    double getGain() const;
+
+    double getGamma() const;
+
     void setRefreshButtonDown(bool down);
 
     bool isViewersSynchroEnabled() const;
@@ -255,6 +259,28 @@ public:
     
     unsigned int getMipMapLevelFromZoomFactor() const;
 
+    /**
+     * @brief Reports the wall time taken by an interactive (non-playback) viewer render and the
+     * mipmap level it was rendered at, so that getAdaptiveProxyMipMapLevel() can estimate the
+     * resolution affordable while scrubbing. Thread-safe.
+     **/
+    void reportInteractiveRenderDuration(double seconds, unsigned int mipMapLevel);
+
+    /**
+     * @brief Returns the mipmap level to render at while scrubbing the timeline in draft mode,
+     * estimated from the duration of the last interactive render so that scrub renders stay
+     * within an interactive latency target. The returned level never exceeds maxMipMapLevel
+     * (the auto-proxy level set in the preferences), which is also returned when no render
+     * was measured yet. Thread-safe.
+     **/
+    unsigned int getAdaptiveProxyMipMapLevel(unsigned int maxMipMapLevel) const;
+
+    /**
+     * @brief Returns the wall time in seconds taken by the last interactive (non-playback)
+     * viewer render, or -1 if no render was measured yet. Thread-safe.
+     **/
+    double getLastInteractiveRenderDurationSeconds() const;
+
     struct UpdateViewerArgs
     {
         TimeValue time;
@@ -276,6 +302,14 @@ public:
         std::list<TextureUpload> viewerUploads[2];
         bool recenterViewer;
         Point viewerCenter;
+
+        // True if the images were rendered with the cache disabled, in which case the viewer
+        // may not re-use previously uploaded textures for them
+        bool byPassCache;
+
+        // The identifier of the user interaction the renders were tagged with, 0 if
+        // untagged. See InteractionLatencyTracker.
+        U64 interactionId;
     };
 
     void updateViewer(const UpdateViewerArgs& args);
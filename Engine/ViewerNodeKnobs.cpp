@@ -625,6 +625,16 @@ ViewerNode::initializeKnobs()
         }
         _imp->playbackModeKnob = param;
     }
+    {
+        KnobButtonPtr param = createKnob<KnobButton>(kViewerNodeParamRealtimePlayback);
+        param->setLabel(tr(kViewerNodeParamRealtimePlaybackLabel));
+        param->setHintToolTip(tr(kViewerNodeParamRealtimePlaybackHint));
+        param->setSecret(true);
+        param->setEvaluateOnChange(false);
+        param->setInViewerContextCanHaveShortcut(true);
+        param->setCheckable(true);
+        _imp->realtimePlaybackButtonKnob = param;
+    }
     {
         KnobButtonPtr param = createKnob<KnobButton>(kViewerNodeParamSyncTimelines);
         param->setLabel(tr(kViewerNodeParamSyncTimelinesLabel));
@@ -845,7 +855,9 @@ ViewerNode::initializeKnobs()
     playerToolbarPage->addKnob(_imp->enableTurboModeButtonKnob.lock());
     _imp->enableTurboModeButtonKnob.lock()->setInViewerContextItemSpacing(0);
     playerToolbarPage->addKnob(_imp->playbackModeKnob.lock());
-    _imp->playbackModeKnob.lock()->setInViewerContextItemSpacing(VIEWER_UI_SECTIONS_SPACING_PX);
+    _imp->playbackModeKnob.lock()->setInViewerContextItemSpacing(0);
+    playerToolbarPage->addKnob(_imp->realtimePlaybackButtonKnob.lock());
+    _imp->realtimePlaybackButtonKnob.lock()->setInViewerContextItemSpacing(VIEWER_UI_SECTIONS_SPACING_PX);
     playerToolbarPage->addKnob(_imp->syncTimelinesButtonKnob.lock());
     _imp->syncTimelinesButtonKnob.lock()->setInViewerContextLayoutType(eViewerContextLayoutTypeStretchAfter);
     playerToolbarPage->addKnob(_imp->firstFrameButtonKnob.lock());
@@ -1768,6 +1780,8 @@ ViewerNode::knobChanged(const KnobIPtr& k, ValueChangedReasonEnum reason,
         PlaybackModeEnum mode = (PlaybackModeEnum)_imp->playbackModeKnob.lock()->getValue();
         getNode()->getRenderEngine()->setPlaybackMode(mode);
 
+    } else if (k == _imp->realtimePlaybackButtonKnob.lock()) {
+        getNode()->getRenderEngine()->setRealtimePlaybackEnabled(_imp->realtimePlaybackButtonKnob.lock()->getValue());
     } else if (k == _imp->syncTimelinesButtonKnob.lock()) {
         if (reason != eValueChangedReasonPluginEdited) {
             getUiContext()->setTripleSyncEnabled(_imp->syncTimelinesButtonKnob.lock()->getValue());
@@ -345,6 +345,11 @@ NATRON_NAMESPACE_ENTER;
 #define kViewerNodeParamPlaybackModeLabel "Playback Mode"
 #define kViewerNodeParamPlaybackModeHint "Behavior to adopt when the playback hit the end of the range: loop,bounce or stop"
 
+#define kViewerNodeParamRealtimePlayback "realtimePlayback"
+#define kViewerNodeParamRealtimePlaybackLabel "Realtime Playback"
+#define kViewerNodeParamRealtimePlaybackHint "When checked, playback never stalls on a frame that is not rendered in time for the set frame rate: " \
+"the nearest rendered frame is displayed instead. Skipped frames are rendered in the background once playback stops so that the next pass over them is smooth"
+
 #define kViewerNodeParamSyncTimelines "syncTimelines"
 #define kViewerNodeParamSyncTimelinesLabel "Sync Timelines"
 #define kViewerNodeParamSyncTimelinesHint "When activated, the timeline frame-range is synchronized with the Dope Sheet and the Curve Editor"
@@ -437,6 +442,7 @@ struct ViewerNodePrivate
     boost::weak_ptr<KnobDouble> fpsKnob;
     boost::weak_ptr<KnobButton> enableTurboModeButtonKnob;
     boost::weak_ptr<KnobChoice> playbackModeKnob;
+    boost::weak_ptr<KnobButton> realtimePlaybackButtonKnob;
     boost::weak_ptr<KnobButton> syncTimelinesButtonKnob;
     boost::weak_ptr<KnobButton> firstFrameButtonKnob;
     boost::weak_ptr<KnobButton> playBackwardButtonKnob;
@@ -522,6 +528,14 @@ struct ViewerNodePrivate
     // True if during tracking, protected by partialUpdatesMutex
     bool isDoingPartialUpdates;
 
+    // Protects lastInteractiveRenderDurationSeconds and lastInteractiveRenderMipMapLevel
+    mutable QMutex lastRenderDurationMutex;
+
+    // Wall time taken by the last interactive (non-playback) viewer render and the mipmap level it
+    // was rendered at. Used to adapt the auto-proxy level while scrubbing, see getAdaptiveProxyMipMapLevel()
+    double lastInteractiveRenderDurationSeconds;
+    unsigned int lastInteractiveRenderMipMapLevel;
+
     ViewerNodePrivate(ViewerNode* publicInterface)
     : _publicInterface(publicInterface)
     , uiContext(0)
@@ -536,6 +550,9 @@ struct ViewerNodePrivate
     , viewportCenter()
     , viewportCenterSet(false)
     , isDoingPartialUpdates(false)
+    , lastRenderDurationMutex()
+    , lastInteractiveRenderDurationSeconds(-1.)
+    , lastInteractiveRenderMipMapLevel(0)
     {
 
     }
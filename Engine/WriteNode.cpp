@@ -38,6 +38,10 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 CLANG_DIAG_OFF(deprecated)
 CLANG_DIAG_OFF(uninitialized)
 #include <QtCore/QCoreApplication>
+#include <QtCore/QMutex>
+#include <QtCore/QRunnable>
+#include <QtCore/QThreadPool>
+#include <QtCore/QWaitCondition>
 CLANG_DIAG_ON(deprecated)
 CLANG_DIAG_ON(uninitialized)
 
@@ -56,6 +60,7 @@ CLANG_DIAG_ON(uninitialized)
 #include "Engine/Project.h"
 #include "Engine/ReadNode.h"
 #include "Engine/Settings.h"
+#include "Engine/TreeRender.h"
 
 //The plug-in that is instanciated whenever this node is created and doesn't point to any valid or known extension
 #define WRITE_NODE_DEFAULT_WRITER PLUGINID_OFX_WRITEOIIO
@@ -63,6 +68,15 @@ CLANG_DIAG_ON(uninitialized)
 
 #define kNatronPersistentErrorEncoderMissing "NatronPersistentErrorEncoderMissing"
 
+// Maximum number of completed frames waiting on the encoder threads: when the queue is full,
+// render threads block in queueFrameEncode() (backpressure) so that rendering cannot run-away
+// from a slow encoder and accumulate frames in memory.
+#define NATRON_WRITENODE_ENCODE_QUEUE_MAX_FRAMES 4
+
+// Number of threads dedicated to encoding. This is kept low on purpose: encoders are themselves
+// multi-threaded and the goal is only to overlap encoding with the rendering of the next frames.
+#define NATRON_WRITENODE_ENCODE_MAX_THREADS 2
+
 NATRON_NAMESPACE_ENTER;
 
 //Generic Writer
@@ -209,6 +223,26 @@ public:
     // If this is different, we do not load serialized knobs
     std::string lastPluginIDCreated;
 
+    // Protects the encode queue data below
+    mutable QMutex encodeQueueMutex;
+
+    // Signaled whenever an encode task finishes, to unblock render threads waiting for a slot
+    // in the bounded queue and renderSequenceEnd() waiting for the queue to drain
+    QWaitCondition encodeTaskFinishedCond;
+
+    // Number of frames handed to the encoder threads and not encoded yet
+    int nEncodeTasksInFlight;
+
+    // True between renderSequenceStarted() and renderSequenceEnd() if the embedded writer
+    // supports out of order encoding
+    bool encodeQueueActive;
+
+    // The first failure returned by an encoder thread, if any
+    ActionRetCodeEnum encodeStatus;
+
+    // Threads dedicated to encoding, created the first time a frame is queued
+    boost::scoped_ptr<QThreadPool> encodeThreadPool;
+
 
     WriteNodePrivate(WriteNode* publicInterface)
         : _publicInterface(publicInterface)
@@ -225,6 +259,12 @@ public:
         , writeNodeKnobs()
         , creatingWriteNode(0)
         , lastPluginIDCreated()
+        , encodeQueueMutex()
+        , encodeTaskFinishedCond()
+        , nEncodeTasksInFlight(0)
+        , encodeQueueActive(false)
+        , encodeStatus(eActionStatusOK)
+        , encodeThreadPool()
     {
     }
 
@@ -266,6 +306,97 @@ public:
     }
 };
 
+/**
+ * @brief Launch the render of the embedded writer at the given frame: this runs the render
+ * action of the encoder, which pulls its input image (expected to be cached already when
+ * called from an encoder thread) and writes the file.
+ **/
+static ActionRetCodeEnum
+launchEncodeRender(const NodePtr& embeddedWriter,
+                   TimeValue time,
+                   ViewIdx view,
+                   const RenderStatsPtr& stats)
+{
+    TreeRender::CtorArgsPtr args(new TreeRender::CtorArgs);
+
+    args->treeRootEffect = embeddedWriter->getEffectInstance();
+    args->time = time;
+    args->view = view;
+    args->plane = 0;
+    args->mipMapLevel = 0;
+    args->proxyScale = RenderScale(1.);
+    args->canonicalRoI = 0;
+    args->stats = stats;
+    args->draftMode = false;
+    args->playback = true;
+    args->byPassCache = false;
+
+    ActionRetCodeEnum retCode = eActionStatusFailed;
+    try {
+        TreeRenderPtr render = TreeRender::create(args);
+        if (render) {
+            FrameViewRequestPtr outputRequest;
+            retCode = render->launchRender(&outputRequest);
+        }
+    } catch (...) {
+    }
+
+    return retCode;
+}
+
+/**
+ * @brief Encodes a single frame on the encoder thread pool, see WriteNode::queueFrameEncode()
+ **/
+class WriteNodeEncodeFrameRunnable
+    : public QRunnable
+{
+    boost::weak_ptr<WriteNode> _node;
+    TimeValue _time;
+    ViewIdx _view;
+    RenderStatsPtr _stats;
+
+public:
+
+    WriteNodeEncodeFrameRunnable(const WriteNodePtr& node,
+                                 TimeValue time,
+                                 ViewIdx view,
+                                 const RenderStatsPtr& stats)
+        : _node(node)
+        , _time(time)
+        , _view(view)
+        , _stats(stats)
+    {
+    }
+
+    virtual ~WriteNodeEncodeFrameRunnable()
+    {
+    }
+
+private:
+
+    virtual void run() OVERRIDE FINAL
+    {
+        WriteNodePtr node = _node.lock();
+
+        if (!node) {
+            return;
+        }
+
+        ActionRetCodeEnum stat = eActionStatusFailed;
+        NodePtr embeddedWriter = node->getEmbeddedWriter();
+        if (embeddedWriter) {
+            stat = launchEncodeRender(embeddedWriter, _time, _view, _stats);
+        }
+
+        QMutexLocker k(&node->_imp->encodeQueueMutex);
+        --node->_imp->nEncodeTasksInFlight;
+        if ( isFailureRetCode(stat) && !isFailureRetCode(node->_imp->encodeStatus) ) {
+            node->_imp->encodeStatus = stat;
+        }
+        node->_imp->encodeTaskFinishedCond.wakeAll();
+    }
+};
+
 
 WriteNode::WriteNode(const NodePtr& n)
     : NodeGroup(n)
@@ -1181,6 +1312,87 @@ WriteNode::getFrameRange(double *first,
 }
 
 
+void
+WriteNode::renderSequenceStarted()
+{
+    QMutexLocker k(&_imp->encodeQueueMutex);
+
+    // Only writers producing one file per frame may encode in the background: sequential
+    // encoders (e.g: WriteFFMPEG) must receive frames in order from a single thread.
+    NodePtr embeddedWriter = _imp->embeddedPlugin.lock();
+    if ( !embeddedWriter || (embeddedWriter->getEffectInstance()->getSequentialPreference() != eSequentialPreferenceNotSequential) ) {
+        return;
+    }
+
+    _imp->encodeQueueActive = true;
+    _imp->nEncodeTasksInFlight = 0;
+    _imp->encodeStatus = eActionStatusOK;
+}
+
+void
+WriteNode::renderSequenceEnd()
+{
+    QMutexLocker k(&_imp->encodeQueueMutex);
+
+    while (_imp->nEncodeTasksInFlight > 0) {
+        _imp->encodeTaskFinishedCond.wait(&_imp->encodeQueueMutex);
+    }
+    _imp->encodeQueueActive = false;
+}
+
+bool
+WriteNode::isEncodeQueueActive() const
+{
+    QMutexLocker k(&_imp->encodeQueueMutex);
+
+    return _imp->encodeQueueActive;
+}
+
+ActionRetCodeEnum
+WriteNode::queueFrameEncode(TimeValue time,
+                            ViewIdx view,
+                            const RenderStatsPtr& stats)
+{
+    {
+        QMutexLocker k(&_imp->encodeQueueMutex);
+        if (_imp->encodeQueueActive) {
+
+            // Backpressure: wait for a slot in the bounded queue. The encoder threads are
+            // guaranteed to make progress so this cannot dead-lock.
+            while ( (_imp->nEncodeTasksInFlight >= NATRON_WRITENODE_ENCODE_QUEUE_MAX_FRAMES) && !isFailureRetCode(_imp->encodeStatus) ) {
+                _imp->encodeTaskFinishedCond.wait(&_imp->encodeQueueMutex);
+            }
+
+            // Report the failure of a previously queued frame
+            if ( isFailureRetCode(_imp->encodeStatus) ) {
+                return _imp->encodeStatus;
+            }
+
+            ++_imp->nEncodeTasksInFlight;
+
+            if (!_imp->encodeThreadPool) {
+                _imp->encodeThreadPool.reset(new QThreadPool);
+                _imp->encodeThreadPool->setMaxThreadCount(NATRON_WRITENODE_ENCODE_MAX_THREADS);
+            }
+            WriteNodePtr thisShared = toWriteNode( EffectInstance::shared_from_this() );
+            assert(thisShared);
+
+            // The runnable is deleted by the thread pool once run
+            _imp->encodeThreadPool->start( new WriteNodeEncodeFrameRunnable(thisShared, time, view, stats) );
+
+            return eActionStatusOK;
+        }
+    }
+
+    // The queue is not active: encode in place
+    NodePtr embeddedWriter = getEmbeddedWriter();
+    if (!embeddedWriter) {
+        return eActionStatusFailed;
+    }
+
+    return launchEncodeRender(embeddedWriter, time, view, stats);
+} // WriteNode::queueFrameEncode
+
 void
 WriteNode::onSequenceRenderStarted()
 {
@@ -112,9 +112,33 @@ public:
 
     virtual void setupInitialSubGraphState() OVERRIDE FINAL;
 
+    /**
+     * @brief Called by the scheduler when a sequential render (render on disk) is started/finished.
+     * For writers that do not require frames to be encoded in order (e.g: one file per frame),
+     * this activates a bounded encode queue: render threads hand completed frames to dedicated
+     * encoder threads with queueFrameEncode() so that rendering of the next frames overlaps with
+     * the encoding of the previous ones. renderSequenceEnd() blocks until all queued frames
+     * are encoded.
+     **/
     void renderSequenceStarted();
     void renderSequenceEnd();
 
+    /**
+     * @brief True if frames may be handed to the background encoder threads with queueFrameEncode()
+     **/
+    bool isEncodeQueueActive() const;
+
+    /**
+     * @brief Schedule the encode of the frame at the given time and view on the encoder threads.
+     * The frame is expected to be already rendered (and cached) up to the input of the embedded
+     * writer: the encoder threads only run the render action of the writer itself.
+     * This blocks when the bounded queue is full (backpressure) so that render threads cannot
+     * run-away from slow encoders. If the queue is not active the encode is done in place.
+     * @returns The status of the encodes scheduled so far: if a previously queued frame failed
+     * to encode, the failure is reported to the caller here.
+     **/
+    ActionRetCodeEnum queueFrameEncode(TimeValue time, ViewIdx view, const RenderStatsPtr& stats);
+
     virtual bool isViewAware() const OVERRIDE FINAL WARN_UNUSED_RETURN;
 
 public Q_SLOTS:
@@ -124,6 +148,7 @@ public Q_SLOTS:
 
 private:
 
+    friend class WriteNodeEncodeFrameRunnable;
 
     virtual ActionRetCodeEnum getFrameRange(double *first, double *last) OVERRIDE FINAL;
     virtual void initializeKnobs() OVERRIDE FINAL;
@@ -147,6 +147,11 @@ enum ActionRetCodeEnum
     // If the action is using a GPU backend, it may re-try the same action on CPU right away
     eActionStatusOutOfMemory,
 
+    // The render could not progress because all tiles left to render are being computed
+    // by other threads or processes. The request should be re-queued on the scheduler and
+    // retried later instead of blocking the calling thread.
+    eActionStatusWaitingForResults,
+
     // The operation completed with default implementation
     eActionStatusReplyDefault
 };
@@ -160,6 +165,7 @@ inline bool isFailureRetCode(ActionRetCodeEnum code)
         case eActionStatusInputDisconnected:
             return true;
         case eActionStatusOK:
+        case eActionStatusWaitingForResults:
         case eActionStatusReplyDefault:
             return false;
     }
@@ -25,8 +25,10 @@
 #include "AnimationModuleViewPrivate.h"
 
 #include <algorithm> // min, max
+#include <cmath>
 #include <limits>
 #include <stdexcept>
+#include <vector>
 
 // Qt includes
 #include <QApplication>
@@ -712,7 +714,68 @@ AnimationModuleViewPrivate::drawDopeSheetKeyframes(QTreeWidgetItem* treeItem, co
     }
 
 
-    for (KeyFrameWithStringSet::const_iterator it = dimViewKeys.begin(); it != dimViewKeys.end(); ++it) {
+    // Restrict the iteration to the visible time range: the keys are sorted by time
+    KeyFrameWithStringSet::const_iterator visibleBegin, visibleEnd;
+    {
+        KeyFrameWithString bound;
+        bound.key = KeyFrame(dopeSheetZoomContext.left(), 0.);
+        visibleBegin = dimViewKeys.lower_bound(bound);
+        bound.key = KeyFrame(dopeSheetZoomContext.right(), 0.);
+        visibleEnd = dimViewKeys.upper_bound(bound);
+    }
+
+    // With auto-tracked markers a single track can hold tens of thousands of keyframes.
+    // When more keys are visible than the row can fit distinguishable key icons,
+    // aggregate them per pixel column and draw one density-coded block per column
+    // instead of one texture per key.
+    const double keyframeTexSize = TO_DPIX( getKeyframeTextureSize() );
+    const double pixelsPerFrame = dopeSheetZoomContext.toWidgetCoordinates(1, 0).x() - dopeSheetZoomContext.toWidgetCoordinates(0, 0).x();
+    const double visibleWidthPx = dopeSheetZoomContext.screenWidth();
+    const std::size_t nVisibleKeys = std::distance(visibleBegin, visibleEnd);
+    const bool aggregatePerColumn = (pixelsPerFrame < keyframeTexSize) && (nVisibleKeys * keyframeTexSize > visibleWidthPx);
+
+    if (aggregatePerColumn) {
+        std::vector<int> columnCounts( std::max( 1, (int)std::ceil(visibleWidthPx) ), 0 );
+        std::vector<bool> columnHasSelected(columnCounts.size(), false);
+        int maxCount = 1;
+        for (KeyFrameWithStringSet::const_iterator it = visibleBegin; it != visibleEnd; ++it) {
+            const TimeValue keyTime = it->key.getTime();
+            int col = (int)std::floor( dopeSheetZoomContext.toWidgetCoordinates(keyTime, 0).x() );
+            if ( (col < 0) || ( col >= (int)columnCounts.size() ) ) {
+                continue;
+            }
+            maxCount = std::max(maxCount, ++columnCounts[col]);
+            if ( !columnHasSelected[col] && selectModel->isKeyframeSelected( item, dimension, view, TimeValue(keyTime) ) ) {
+                columnHasSelected[col] = true;
+            }
+        }
+
+        // The blocks span the same height as the key icons
+        RectD refRect = getKeyFrameBoundingRectCanonical(dopeSheetZoomContext, dopeSheetZoomContext.left(), rowCenterYCanonical);
+        GL_GPU::Begin(GL_QUADS);
+        for (std::size_t col = 0; col < columnCounts.size(); ++col) {
+            if (!columnCounts[col]) {
+                continue;
+            }
+            double x1 = dopeSheetZoomContext.toZoomCoordinates(col, 0).x();
+            double x2 = dopeSheetZoomContext.toZoomCoordinates(col + 1, 0).x();
+            double density = columnCounts[col] / (double)maxCount;
+            double alpha = 0.4 + 0.6 * density;
+            if (columnHasSelected[col]) {
+                GL_GPU::Color4f(selectionColorRGB[0] * alpha, selectionColorRGB[1] * alpha, selectionColorRGB[2] * alpha, 1.);
+            } else {
+                double c = (drawdimed ? 0.5 : 0.8) * alpha;
+                GL_GPU::Color4f(c, c, c, 1.);
+            }
+            GL_GPU::Vertex2f(x1, refRect.y1);
+            GL_GPU::Vertex2f(x1, refRect.y2);
+            GL_GPU::Vertex2f(x2, refRect.y2);
+            GL_GPU::Vertex2f(x2, refRect.y1);
+        }
+        GL_GPU::End();
+    }
+
+    for (KeyFrameWithStringSet::const_iterator it = visibleBegin; !aggregatePerColumn && it != visibleEnd; ++it) {
 
         const TimeValue keyTime = it->key.getTime();
         RectD zoomKfRect = getKeyFrameBoundingRectCanonical(dopeSheetZoomContext, keyTime, rowCenterYCanonical);
@@ -0,0 +1,347 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2013-2017 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "CacheActivityDialog.h"
+
+#include <map>
+#include <string>
+
+CLANG_DIAG_OFF(deprecated)
+CLANG_DIAG_OFF(uninitialized)
+#include <QGridLayout>
+#include <QVBoxLayout>
+#include <QTimer>
+#include <QTreeWidget>
+#include <QHeaderView>
+CLANG_DIAG_ON(deprecated)
+CLANG_DIAG_ON(uninitialized)
+
+#include "Engine/AppManager.h"
+#include "Engine/Cache.h"
+#include "Engine/ImageStorage.h" // getMemoryAttribution
+#include "Engine/MemoryInfo.h" // printAsRAM
+#include "Engine/PluginMemory.h" // getPerPluginMemoryUsage
+#include "Engine/Timer.h"
+
+#include "Gui/Gui.h"
+#include "Gui/Label.h"
+
+#define NATRON_CACHE_ACTIVITY_REFRESH_INTERVAL_MS 1000
+
+NATRON_NAMESPACE_ENTER;
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+// The labels displaying the per-second rates of one cache
+struct CacheRatesRow
+{
+    Label* hitsValue;
+    Label* missesValue;
+    Label* pendingWaitsValue;
+    Label* evictionsValue;
+    Label* sizeValue;
+
+    // The counters at the previous refresh, to derive the per-second rates
+    CacheActivityStats previousStats;
+
+    CacheRatesRow()
+    : hitsValue(0)
+    , missesValue(0)
+    , pendingWaitsValue(0)
+    , evictionsValue(0)
+    , sizeValue(0)
+    , previousStats()
+    {
+    }
+};
+
+// A tree item that sorts on the numeric value stored in the Qt::UserRole data of the column
+// when there is one, so that the memory column orders by bytes and not lexically
+class NumericSortTreeItem : public QTreeWidgetItem
+{
+public:
+
+    NumericSortTreeItem(QTreeWidget* parent)
+    : QTreeWidgetItem(parent)
+    {
+    }
+
+    virtual bool operator<(const QTreeWidgetItem& other) const OVERRIDE FINAL
+    {
+        int column = treeWidget() ? treeWidget()->sortColumn() : 0;
+        QVariant lhs = data(column, Qt::UserRole);
+        QVariant rhs = other.data(column, Qt::UserRole);
+
+        if ( lhs.isValid() && rhs.isValid() ) {
+            return lhs.toULongLong() < rhs.toULongLong();
+        }
+
+        return text(column) < other.text(column);
+    }
+};
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+
+struct CacheActivityDialogPrivate
+{
+    Gui* gui;
+    QVBoxLayout* mainLayout;
+    CacheRatesRow tileCacheRow;
+    CacheRatesRow generalCacheRow;
+    QTreeWidget* perNodeTree;
+    QTreeWidget* imageMemoryTree;
+    QTreeWidget* pluginMemoryTree;
+    QTimer refreshTimer;
+    TimeLapse refreshTimeLapse;
+
+    CacheActivityDialogPrivate(Gui* gui)
+    : gui(gui)
+    , mainLayout(0)
+    , tileCacheRow()
+    , generalCacheRow()
+    , perNodeTree(0)
+    , imageMemoryTree(0)
+    , pluginMemoryTree(0)
+    , refreshTimer()
+    , refreshTimeLapse()
+    {
+    }
+
+    void createRatesRow(QGridLayout* grid, int row, const QString& cacheName, CacheRatesRow* rates);
+
+    void refreshRatesRow(const CacheBasePtr& cache, double timeElapsed, CacheRatesRow* rates);
+
+    void refreshPerNodeTree();
+
+    void refreshImageMemoryTree();
+
+    void refreshPluginMemoryTree();
+};
+
+CacheActivityDialog::CacheActivityDialog(Gui* gui,
+                                         QWidget* parent)
+    : QDialog(parent)
+    , _imp( new CacheActivityDialogPrivate(gui) )
+{
+    setWindowTitle( tr("Cache Activity") );
+    setWindowFlags(Qt::Window);
+    setSizeGripEnabled(true);
+
+    _imp->mainLayout = new QVBoxLayout(this);
+
+    QWidget* ratesContainer = new QWidget(this);
+    QGridLayout* grid = new QGridLayout(ratesContainer);
+
+    grid->addWidget(new Label(tr("Hits/s"), ratesContainer), 0, 1);
+    grid->addWidget(new Label(tr("Misses/s"), ratesContainer), 0, 2);
+    grid->addWidget(new Label(tr("Pending waits/s"), ratesContainer), 0, 3);
+    grid->addWidget(new Label(tr("Evictions/s"), ratesContainer), 0, 4);
+    grid->addWidget(new Label(tr("Size"), ratesContainer), 0, 5);
+
+    _imp->createRatesRow(grid, 1, tr("Image tiles cache"), &_imp->tileCacheRow);
+    _imp->createRatesRow(grid, 2, tr("General purpose cache"), &_imp->generalCacheRow);
+
+    _imp->mainLayout->addWidget(ratesContainer);
+
+    _imp->mainLayout->addWidget( new Label(tr("Cache memory per node:"), this) );
+
+    _imp->perNodeTree = new QTreeWidget(this);
+    _imp->perNodeTree->setColumnCount(3);
+    QStringList headers;
+    headers << tr("Node") << tr("Memory") << tr("Entries");
+    _imp->perNodeTree->setHeaderLabels(headers);
+    _imp->perNodeTree->setRootIsDecorated(false);
+    _imp->perNodeTree->setSortingEnabled(false);
+    _imp->mainLayout->addWidget(_imp->perNodeTree);
+
+    _imp->mainLayout->addWidget( new Label(tr("Image buffers per node:"), this) );
+
+    _imp->imageMemoryTree = new QTreeWidget(this);
+    _imp->imageMemoryTree->setColumnCount(4);
+    QStringList imageMemoryHeaders;
+    imageMemoryHeaders << tr("Node") << tr("Plug-in") << tr("Memory") << tr("Buffers");
+    _imp->imageMemoryTree->setHeaderLabels(imageMemoryHeaders);
+    _imp->imageMemoryTree->setRootIsDecorated(false);
+    _imp->imageMemoryTree->setSortingEnabled(true);
+    _imp->imageMemoryTree->sortByColumn(2, Qt::DescendingOrder);
+    _imp->mainLayout->addWidget(_imp->imageMemoryTree);
+
+    _imp->mainLayout->addWidget( new Label(tr("Plug-in scratch memory:"), this) );
+
+    _imp->pluginMemoryTree = new QTreeWidget(this);
+    _imp->pluginMemoryTree->setColumnCount(3);
+    QStringList pluginMemoryHeaders;
+    pluginMemoryHeaders << tr("Plug-in") << tr("Memory") << tr("Peak");
+    _imp->pluginMemoryTree->setHeaderLabels(pluginMemoryHeaders);
+    _imp->pluginMemoryTree->setRootIsDecorated(false);
+    _imp->pluginMemoryTree->setSortingEnabled(true);
+    _imp->pluginMemoryTree->sortByColumn(1, Qt::DescendingOrder);
+    _imp->mainLayout->addWidget(_imp->pluginMemoryTree);
+
+    _imp->refreshTimer.setInterval(NATRON_CACHE_ACTIVITY_REFRESH_INTERVAL_MS);
+    QObject::connect( &_imp->refreshTimer, SIGNAL(timeout()), this, SLOT(onRefreshTimerTimeout()) );
+
+    resize(600, 600);
+}
+
+CacheActivityDialog::~CacheActivityDialog()
+{
+}
+
+void
+CacheActivityDialogPrivate::createRatesRow(QGridLayout* grid,
+                                           int row,
+                                           const QString& cacheName,
+                                           CacheRatesRow* rates)
+{
+    QWidget* parent = grid->parentWidget();
+
+    grid->addWidget(new Label(cacheName, parent), row, 0);
+    rates->hitsValue = new Label(parent);
+    grid->addWidget(rates->hitsValue, row, 1);
+    rates->missesValue = new Label(parent);
+    grid->addWidget(rates->missesValue, row, 2);
+    rates->pendingWaitsValue = new Label(parent);
+    grid->addWidget(rates->pendingWaitsValue, row, 3);
+    rates->evictionsValue = new Label(parent);
+    grid->addWidget(rates->evictionsValue, row, 4);
+    rates->sizeValue = new Label(parent);
+    grid->addWidget(rates->sizeValue, row, 5);
+}
+
+void
+CacheActivityDialogPrivate::refreshRatesRow(const CacheBasePtr& cache,
+                                            double timeElapsed,
+                                            CacheRatesRow* rates)
+{
+    CacheActivityStats stats;
+
+    cache->getActivityStats(&stats);
+
+    if (timeElapsed > 0) {
+        rates->hitsValue->setText( QString::number( (stats.nHits - rates->previousStats.nHits) / timeElapsed, 'f', 1 ) );
+        rates->missesValue->setText( QString::number( (stats.nMisses - rates->previousStats.nMisses) / timeElapsed, 'f', 1 ) );
+        rates->pendingWaitsValue->setText( QString::number( (stats.nPendingWaits - rates->previousStats.nPendingWaits) / timeElapsed, 'f', 1 ) );
+        rates->evictionsValue->setText( QString::number( (stats.nEvictions - rates->previousStats.nEvictions) / timeElapsed, 'f', 1 ) );
+    }
+    rates->sizeValue->setText( printAsRAM( cache->getCurrentSize() ) );
+    rates->previousStats = stats;
+}
+
+void
+CacheActivityDialogPrivate::refreshPerNodeTree()
+{
+    std::map<std::string, CacheReportInfo> infos;
+
+    appPTR->getTileCache()->getMemoryStats(&infos);
+
+    perNodeTree->clear();
+    for (std::map<std::string, CacheReportInfo>::const_iterator it = infos.begin(); it != infos.end(); ++it) {
+        if (it->second.nBytes == 0) {
+            continue;
+        }
+        QTreeWidgetItem* item = new QTreeWidgetItem(perNodeTree);
+        item->setText( 0, QString::fromUtf8( it->first.c_str() ) );
+        item->setText( 1, printAsRAM(it->second.nBytes) );
+        item->setText( 2, QString::number(it->second.nEntries) );
+    }
+}
+
+void
+CacheActivityDialogPrivate::refreshImageMemoryTree()
+{
+    std::map<std::string, MemoryAttributionInfo> attribution;
+
+    ImageStorageBase::getMemoryAttribution(&attribution);
+
+    // Disable sorting while re-populating, it is restored afterwards
+    imageMemoryTree->setSortingEnabled(false);
+    imageMemoryTree->clear();
+    for (std::map<std::string, MemoryAttributionInfo>::const_iterator it = attribution.begin(); it != attribution.end(); ++it) {
+        QTreeWidgetItem* item = new NumericSortTreeItem(imageMemoryTree);
+        item->setText( 0, QString::fromUtf8( it->first.c_str() ) );
+        item->setText( 1, QString::fromUtf8( it->second.pluginID.c_str() ) );
+        item->setText( 2, printAsRAM(it->second.nBytes) );
+        item->setData( 2, Qt::UserRole, QVariant( (qulonglong)it->second.nBytes ) );
+        item->setText( 3, QString::number(it->second.nBuffers) );
+        item->setData( 3, Qt::UserRole, QVariant( (qulonglong)it->second.nBuffers ) );
+    }
+    imageMemoryTree->setSortingEnabled(true);
+}
+
+void
+CacheActivityDialogPrivate::refreshPluginMemoryTree()
+{
+    std::map<std::string, PluginMemoryUsageInfo> infos;
+
+    PluginMemory::getPerPluginMemoryUsage(&infos);
+
+    // Disable sorting while re-populating, it is restored afterwards
+    pluginMemoryTree->setSortingEnabled(false);
+    pluginMemoryTree->clear();
+    for (std::map<std::string, PluginMemoryUsageInfo>::const_iterator it = infos.begin(); it != infos.end(); ++it) {
+        QTreeWidgetItem* item = new NumericSortTreeItem(pluginMemoryTree);
+        item->setText( 0, QString::fromUtf8( it->first.c_str() ) );
+        item->setText( 1, printAsRAM(it->second.nBytes) );
+        item->setData( 1, Qt::UserRole, QVariant( (qulonglong)it->second.nBytes ) );
+        item->setText( 2, printAsRAM(it->second.peakNBytes) );
+        item->setData( 2, Qt::UserRole, QVariant( (qulonglong)it->second.peakNBytes ) );
+    }
+    pluginMemoryTree->setSortingEnabled(true);
+}
+
+void
+CacheActivityDialog::onRefreshTimerTimeout()
+{
+    double timeElapsed = _imp->refreshTimeLapse.getTimeElapsedReset();
+
+    _imp->refreshRatesRow(appPTR->getTileCache(), timeElapsed, &_imp->tileCacheRow);
+    _imp->refreshRatesRow(appPTR->getGeneralPurposeCache(), timeElapsed, &_imp->generalCacheRow);
+    _imp->refreshPerNodeTree();
+    _imp->refreshImageMemoryTree();
+    _imp->refreshPluginMemoryTree();
+}
+
+void
+CacheActivityDialog::showEvent(QShowEvent* e)
+{
+    // Reset the reference point of the rates and refresh immediately
+    _imp->refreshTimeLapse.reset();
+    onRefreshTimerTimeout();
+    _imp->refreshTimer.start();
+    QDialog::showEvent(e);
+}
+
+void
+CacheActivityDialog::hideEvent(QHideEvent* e)
+{
+    _imp->refreshTimer.stop();
+    QDialog::hideEvent(e);
+}
+
+NATRON_NAMESPACE_EXIT;
+
+NATRON_NAMESPACE_USING;
+#include "moc_CacheActivityDialog.cpp"
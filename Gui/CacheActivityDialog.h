@@ -0,0 +1,77 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2013-2017 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef NATRON_GUI_CACHEACTIVITYDIALOG_H
+#define NATRON_GUI_CACHEACTIVITYDIALOG_H
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/scoped_ptr.hpp>
+#endif
+
+CLANG_DIAG_OFF(deprecated)
+CLANG_DIAG_OFF(uninitialized)
+#include <QDialog>
+CLANG_DIAG_ON(deprecated)
+CLANG_DIAG_ON(uninitialized)
+
+#include "Gui/GuiFwd.h"
+
+NATRON_NAMESPACE_ENTER;
+
+struct CacheActivityDialogPrivate;
+
+/**
+ * @brief A non modal window displaying live statistics of the caches: hit/miss/eviction
+ * rates aggregated per second and the memory footprint per node, both for cached entries
+ * and for the image buffers currently allocated on behalf of each node. The counters
+ * refresh on a timer while the window is visible.
+ **/
+class CacheActivityDialog
+    : public QDialog
+{
+    Q_OBJECT
+
+public:
+
+    CacheActivityDialog(Gui* gui, QWidget* parent = 0);
+
+    virtual ~CacheActivityDialog();
+
+public Q_SLOTS:
+
+    void onRefreshTimerTimeout();
+
+private:
+
+    virtual void showEvent(QShowEvent* e) OVERRIDE FINAL;
+    virtual void hideEvent(QHideEvent* e) OVERRIDE FINAL;
+
+    boost::scoped_ptr<CacheActivityDialogPrivate> _imp;
+};
+
+NATRON_NAMESPACE_EXIT;
+
+#endif // NATRON_GUI_CACHEACTIVITYDIALOG_H
@@ -52,7 +52,7 @@ struct CachedFramesThread::Implementation
     ViewerTab* viewer;
 
     QMutex cachedFramesMutex;
-    std::list<TimeValue> cachedFrames;
+    CachedFramesBitset cachedFrames;
 
     QMutex mustQuitMutex;
     QWaitCondition mustQuitCond;
@@ -123,7 +123,7 @@ CachedFramesThread::quitThread()
 }
 
 void
-CachedFramesThread::getCachedFrames(std::list<TimeValue>* cachedFrames) const
+CachedFramesThread::getCachedFrames(CachedFramesBitset* cachedFrames) const
 {
     QMutexLocker k(&_imp->cachedFramesMutex);
     *cachedFrames = _imp->cachedFrames;
@@ -148,15 +148,7 @@ CachedFramesThread::Implementation::refreshCachedFramesInternal()
     // 2) Check if the cache still has a tile entry for this frame
 
 
-    std::set<TimeValue> existingCachedFrames;
     std::set<TimeValue> updatedCachedFrames;
-    {
-        QMutexLocker k(&cachedFramesMutex);
-        for (std::list<TimeValue>::const_iterator it = cachedFrames.begin(); it!=cachedFrames.end(); ++it) {
-            existingCachedFrames.insert(*it);
-        }
-    }
-    bool hasChanged = false;
     for (ViewerCachedImagesMap::const_iterator it = framesDisplayed.begin(); it != framesDisplayed.end(); ++it) {
 
         bool isValid = true;
@@ -193,34 +185,34 @@ CachedFramesThread::Implementation::refreshCachedFramesInternal()
             viewer->getViewer()->removeViewerProcessHashAtTime(it->first.time, it->first.view);
         } else {
             updatedCachedFrames.insert(it->first.time);
-            std::set<TimeValue>::iterator found = existingCachedFrames.find(it->first.time);
-            if (found == existingCachedFrames.end()) {
-                // We added a keyframe that didnt exist
-                hasChanged = true;
-            }
         }
 
     }
 
-    if (!hasChanged) {
-        // Check if we removed a keyframe that existed
-        for (std::set<TimeValue>::iterator it = existingCachedFrames.begin(); it != existingCachedFrames.end(); ++it) {
-            std::set<TimeValue>::iterator found = updatedCachedFrames.find(*it);
-            if (found == updatedCachedFrames.end()) {
-                // We removed a keyframe
-                hasChanged = true;
-                break;
-            }
+    // Pack the updated frames in a bitset: comparing it against the previous one detects
+    // both added and removed frames in a single pass
+    CachedFramesBitset updatedBitset;
+    if ( !updatedCachedFrames.empty() ) {
+        SequenceTime first = (SequenceTime)*updatedCachedFrames.begin();
+        SequenceTime last = (SequenceTime)*updatedCachedFrames.rbegin();
+        updatedBitset.firstFrame = first;
+        updatedBitset.words.resize( (std::size_t)(last - first) / 64 + 1, 0 );
+        for (std::set<TimeValue>::const_iterator it = updatedCachedFrames.begin(); it != updatedCachedFrames.end(); ++it) {
+            std::size_t i = (std::size_t)( (SequenceTime)*it - first );
+            updatedBitset.words[i / 64] |= ( (U64)1 << (i % 64) );
         }
     }
 
-    if (hasChanged) {
+    {
         QMutexLocker k(&cachedFramesMutex);
-        cachedFrames.clear();
-        cachedFrames.insert(cachedFrames.end(),updatedCachedFrames.begin(), updatedCachedFrames.end());
-        return true;
+        if ( (updatedBitset.firstFrame == cachedFrames.firstFrame) && (updatedBitset.words == cachedFrames.words) ) {
+            return false;
+        }
+        cachedFrames.firstFrame = updatedBitset.firstFrame;
+        cachedFrames.words.swap(updatedBitset.words);
     }
-    return false;
+
+    return true;
 
 } // refreshCachedFramesInternal
 
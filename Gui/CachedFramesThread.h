@@ -25,9 +25,10 @@
 #ifndef NATRON_ENGINE_CACHEDFRAMESTHREADTHREAD_H
 #define NATRON_ENGINE_CACHEDFRAMESTHREADTHREAD_H
 
-#include <list>
+#include <vector>
 
 #include "Gui/GuiFwd.h"
+#include "Global/GlobalDefines.h"
 #include "Global/Macros.h"
 
 #include <QThread>
@@ -41,6 +42,35 @@
 
 NATRON_NAMESPACE_ENTER;
 
+/**
+ * @brief A bitset with one bit per frame, used to pass the set of cached frames to the
+ * timeline GUI in a fixed number of words instead of one list node per frame.
+ **/
+struct CachedFramesBitset
+{
+    // Frame corresponding to the least significant bit of the first word
+    SequenceTime firstFrame;
+
+    // One bit per frame starting at firstFrame, least significant bit first
+    std::vector<U64> words;
+
+    CachedFramesBitset()
+    : firstFrame(0)
+    , words()
+    {
+    }
+
+    bool isFrameCached(SequenceTime frame) const
+    {
+        if ( frame < firstFrame || (std::size_t)(frame - firstFrame) >= words.size() * 64 ) {
+            return false;
+        }
+        std::size_t i = (std::size_t)(frame - firstFrame);
+
+        return ( words[i / 64] >> (i % 64) ) & 1;
+    }
+};
+
 class CachedFramesThread : public QThread
 {
     GCC_DIAG_SUGGEST_OVERRIDE_OFF
@@ -53,7 +83,7 @@ public:
 
     virtual ~CachedFramesThread();
 
-    void getCachedFrames(std::list<TimeValue>* cachedFrames) const;
+    void getCachedFrames(CachedFramesBitset* cachedFrames) const;
 
     void quitThread();
 
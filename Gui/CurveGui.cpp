@@ -36,7 +36,9 @@
 
 #include <QTreeWidgetItem>
 
+#include "Engine/AppManager.h"
 #include "Engine/Curve.h"
+#include "Engine/Hash64.h"
 #include "Engine/KnobTypes.h"
 #include "Engine/Image.h"
 #include "Engine/OSGLFunctions.h"
@@ -78,6 +80,17 @@ struct CurveGuiPrivate
     double color[4]; // the color that must be used to draw the curve
     int lineWidth; // its thickness
 
+    // Tessellated curve geometry, cached across paints: re-tessellating and re-uploading every
+    // curve on each repaint makes the editor a slideshow with hundreds of tracker curves.
+    // The cache is keyed by the hash of the keyframes, the zoom scale and the x-window it was
+    // tessellated for, see drawCurve().
+    std::vector<float> cachedVertices; // (x,y) pairs in curve coordinates
+    U64 cachedCurveHash;
+    double cachedPixPerUnitX, cachedPixPerUnitY; // the zoom scale of the cached tessellation
+    double cachedXMin, cachedXMax; // the x-window (in curve coordinates) covered by cachedVertices
+    bool hasTessellationCache;
+    GLuint vertexBuffer; // VBO holding cachedVertices, lazily created in drawCurve()
+
     CurveGuiPrivate(AnimationModuleView *curveWidget,
                     const AnimItemBasePtr& item, DimIdx dimension, ViewIdx view)
     : curveWidget(curveWidget)
@@ -87,6 +100,14 @@ struct CurveGuiPrivate
     , internalCurve()
     , color()
     , lineWidth(1.)
+    , cachedVertices()
+    , cachedCurveHash(0)
+    , cachedPixPerUnitX(0)
+    , cachedPixPerUnitY(0)
+    , cachedXMin(0)
+    , cachedXMax(0)
+    , hasTessellationCache(false)
+    , vertexBuffer(0)
     {
 
         QColor tmpColor;
@@ -116,6 +137,12 @@ CurveGui::~CurveGui()
 {
     // always running in the main thread
     assert( qApp && qApp->thread() == QThread::currentThread() );
+
+    // The VBO lives in the GL context of the curve widget: make it current before deleting
+    if ( _imp->vertexBuffer && appPTR && appPTR->isOpenGLLoaded() ) {
+        _imp->curveWidget->makeCurrent();
+        GL_GPU::DeleteBuffers(1, &_imp->vertexBuffer);
+    }
 }
 
 AnimItemBasePtr
@@ -254,6 +281,7 @@ CurveGui::nextPointForSegment(const double x, // < in curve coordinates
                               const bool isPeriodic,
                               const double parametricXMin,
                               const double parametricXMax,
+                              const double xWidgetEnd, // < the right bound (in widget coordinates) of the tessellated window
                               KeyFrameSet::const_iterator* lastUpperIt,
                               double* x2WidgetCoords,
                               KeyFrame* x1Key,
@@ -275,7 +303,7 @@ CurveGui::nextPointForSegment(const double x, // < in curve coordinates
         *isx1Key = true;
         return;
     } else if (!isPeriodic && x >= keys.rbegin()->getTime()) {
-        *x2WidgetCoords = _imp->curveWidget->width() - 1;
+        *x2WidgetCoords = xWidgetEnd;
         return;
     }
 
@@ -368,7 +396,7 @@ CurveGui::nextPointForSegment(const double x, // < in curve coordinates
     double normalizeTimeRange = tnext - tprev;
     if (normalizeTimeRange == 0) {
         // Only 1 keyframe, draw a horizontal line
-        *x2WidgetCoords = _imp->curveWidget->width() - 1;
+        *x2WidgetCoords = xWidgetEnd;
         return;
     }
     assert(normalizeTimeRange > 0.);
@@ -460,6 +488,31 @@ drawLineStrip(const std::vector<float>& vertices,
     GL_GPU::End();
 }
 
+// The hash of the keyframes identifying the tessellation of a curve: the same fields
+// Hash64::appendCurve() uses, computed on the already fetched keyframe set
+static U64
+computeKeyFramesHash(const KeyFrameSet& keys)
+{
+    Hash64 h;
+
+    for (KeyFrameSet::const_iterator it = keys.begin(); it != keys.end(); ++it) {
+        h.append<double>( (double)it->getTime() );
+        h.append<double>( it->getValue() );
+        h.append<double>( it->getLeftDerivative() );
+        h.append<double>( it->getRightDerivative() );
+    }
+    h.computeHash();
+
+    return h.value();
+}
+
+static bool
+zoomScalesMatch(double a,
+                double b)
+{
+    return std::abs(a - b) <= std::abs(a) * 1e-6;
+}
+
 class KeyFrameWithStringTimePredicate
 {
 public:
@@ -521,7 +574,11 @@ CurveGui::drawCurve(int curveIndex,
     isPeriodic = getInternalCurve()->isCurvePeriodic();
     parametricRange = getInternalCurve()->getXRange();
 
+    bool mustUploadVbo = false;
     if ( keyframes.empty() ) {
+        _imp->hasTessellationCache = false;
+        _imp->cachedVertices.clear();
+
         // Add a horizontal line for constant knobs, except string knobs.
         KnobIPtr isKnob = boost::dynamic_pointer_cast<KnobI>(item->getInternalAnimItem());
 
@@ -536,42 +593,74 @@ CurveGui::drawCurve(int curveIndex,
             }
         }
     } else {
-        try {
-            double x1 = 0;
-            double x2;
-
-            bool isX1AKey = false;
-            KeyFrame x1Key;
-            KeyFrameSet::const_iterator lastUpperIt = keyframes.end();
-
-            while ( x1 < (widgetWidth - 1) ) {
-                double x, y;
-                if (!isX1AKey) {
-                    x = _imp->curveWidget->toZoomCoordinates(x1, 0).x();
-                    y = evaluate(false, x);
-                } else {
-                    x = x1Key.getTime();
-                    y = x1Key.getValue();
+        // Only re-tessellate when the keyframes, the zoom scale or the covered x-window
+        // changed: repaints triggered by selection changes or by the edit of another curve
+        // re-use the cached geometry untouched.
+        const double pixPerUnitX = (widgetWidth - 1) / ( topRight.x() - btmLeft.x() );
+        const double pixPerUnitY = (_imp->curveWidget->height() - 1) / ( topRight.y() - btmLeft.y() );
+        const U64 curveHash = computeKeyFramesHash(keyframes);
+        bool cacheValid = _imp->hasTessellationCache &&
+                          _imp->cachedCurveHash == curveHash &&
+                          zoomScalesMatch(_imp->cachedPixPerUnitX, pixPerUnitX) &&
+                          zoomScalesMatch(_imp->cachedPixPerUnitY, pixPerUnitY) &&
+                          btmLeft.x() >= _imp->cachedXMin &&
+                          topRight.x() <= _imp->cachedXMax;
+
+        if (!cacheValid) {
+            mustUploadVbo = true;
+            _imp->hasTessellationCache = false;
+            _imp->cachedVertices.clear();
+
+            // Tessellate one widget width of margin on each side of the viewport, so that
+            // panning at constant zoom re-uses the cache instead of re-tessellating every
+            // curve at each mouse move. The vertex density only depends on the zoom scale,
+            // not on the pan offset, so the cached geometry stays exact.
+            const double xWidgetStart = -widgetWidth;
+            const double xWidgetEnd = 2. * widgetWidth - 1;
+            try {
+                double x1 = xWidgetStart;
+                double x2;
+
+                bool isX1AKey = false;
+                KeyFrame x1Key;
+                KeyFrameSet::const_iterator lastUpperIt = keyframes.end();
+
+                while (x1 < xWidgetEnd) {
+                    double x, y;
+                    if (!isX1AKey) {
+                        x = _imp->curveWidget->toZoomCoordinates(x1, 0).x();
+                        y = evaluate(false, x);
+                    } else {
+                        x = x1Key.getTime();
+                        y = x1Key.getValue();
+                    }
+
+                    _imp->cachedVertices.push_back( (float)x );
+                    _imp->cachedVertices.push_back( (float)y );
+                    nextPointForSegment(x, keyframes, isPeriodic, parametricRange.first, parametricRange.second, xWidgetEnd, &lastUpperIt, &x2, &x1Key, &isX1AKey);
+                    x1 = x2;
+                }
+                //also add the last point
+                {
+                    double x = _imp->curveWidget->toZoomCoordinates(x1, 0).x();
+                    double y = evaluate(false, x);
+                    _imp->cachedVertices.push_back( (float)x );
+                    _imp->cachedVertices.push_back( (float)y );
                 }
 
-                vertices.push_back( (float)x );
-                vertices.push_back( (float)y );
-                nextPointForSegment(x, keyframes, isPeriodic, parametricRange.first, parametricRange.second,  &lastUpperIt, &x2, &x1Key, &isX1AKey);
-                x1 = x2;
-            }
-            //also add the last point
-            {
-                double x = _imp->curveWidget->toZoomCoordinates(x1, 0).x();
-                double y = evaluate(false, x);
-                vertices.push_back( (float)x );
-                vertices.push_back( (float)y );
+                _imp->cachedCurveHash = curveHash;
+                _imp->cachedPixPerUnitX = pixPerUnitX;
+                _imp->cachedPixPerUnitY = pixPerUnitY;
+                _imp->cachedXMin = _imp->curveWidget->toZoomCoordinates(xWidgetStart, 0).x();
+                _imp->cachedXMax = _imp->curveWidget->toZoomCoordinates(xWidgetEnd, 0).x();
+                _imp->hasTessellationCache = true;
+            } catch (...) {
             }
-        } catch (...) {
         }
     }
 
     // No Expr curve or no vertices for the curve, don't draw anything else
-    if (exprVertices.empty() && vertices.empty()) {
+    if ( exprVertices.empty() && vertices.empty() && _imp->cachedVertices.empty() ) {
         return;
     }
 
@@ -634,11 +723,30 @@ CurveGui::drawCurve(int curveIndex,
         GL_GPU::LineWidth(1.5);
         glCheckError(GL_GPU);
         if (hasDrawnExpr) {
+            // Expression curves are re-evaluated at each paint, keep the immediate mode path
             drawLineStrip(exprVertices, btmLeft, topRight);
             GL_GPU::LineStipple(2, 0xAAAA);
             GL_GPU::Enable(GL_LINE_STIPPLE);
         }
-        drawLineStrip(vertices, btmLeft, topRight);
+        if ( !vertices.empty() ) {
+            drawLineStrip(vertices, btmLeft, topRight);
+        } else if ( !_imp->cachedVertices.empty() ) {
+            // One buffered draw call per curve instead of one immediate mode call per vertex.
+            // The geometry is only re-uploaded when it was re-tessellated; out-of-viewport
+            // segments are clipped by GL.
+            if (_imp->vertexBuffer == 0) {
+                GL_GPU::GenBuffers(1, &_imp->vertexBuffer);
+            }
+            GL_GPU::BindBuffer(GL_ARRAY_BUFFER, _imp->vertexBuffer);
+            if (mustUploadVbo) {
+                GL_GPU::BufferData(GL_ARRAY_BUFFER, _imp->cachedVertices.size() * sizeof(float), &_imp->cachedVertices[0], GL_DYNAMIC_DRAW);
+            }
+            GL_GPU::EnableClientState(GL_VERTEX_ARRAY);
+            GL_GPU::VertexPointer(2, GL_FLOAT, 0, 0);
+            GL_GPU::DrawArrays( GL_LINE_STRIP, 0, (GLsizei)(_imp->cachedVertices.size() / 2) );
+            GL_GPU::DisableClientState(GL_VERTEX_ARRAY);
+            GL_GPU::BindBuffer(GL_ARRAY_BUFFER, 0);
+        }
         if (hasDrawnExpr) {
             GL_GPU::Disable(GL_LINE_STIPPLE);
         }
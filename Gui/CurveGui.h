@@ -111,6 +111,7 @@ private:
                              const bool isPeriodic,
                              const double parametricXMin,
                              const double parametricXMax,
+                             const double xWidgetEnd,
                              KeyFrameSet::const_iterator* lastUpperIt,
                              double* x2,
                              KeyFrame* key,
@@ -949,6 +949,15 @@ DockablePanel::setClosedInternal(bool closed)
 
     if (!closed) {
         _imp->_gui->addVisibleDockablePanel(this);
+
+        // Knob GUI refreshes are skipped while the panel is closed: catch up on the
+        // pending ones now that the widgets are visible again
+        const KnobsGuiMapping& knobsMapping = getKnobsMapping();
+        for (KnobsGuiMapping::const_iterator it = knobsMapping.begin(); it != knobsMapping.end(); ++it) {
+            if (it->second) {
+                it->second->refreshGuiIfPending();
+            }
+        }
     } else {
         _imp->_gui->removeVisibleDockablePanel(this);
         _imp->_gui->buildTabFocusOrderPropertiesBin();
@@ -26,11 +26,14 @@
 
 #include <QtCore/QFile>
 #include <QtCore/QFileInfo>
+#include <QtCore/QThreadPool>
 #include <QtCore/QVector>
 
 #include <iostream>
 #include <exception>
 #include <cstddef>
+#include <map>
+#include <string>
 
 #include "qhttpserver.h"
 #include "qhttprequest.h"
@@ -38,11 +41,14 @@
 
 #include "Gui/GuiApplicationManager.h" // appPTR
 #include "Engine/AppInstance.h"
+#include "Engine/Cache.h"
+#include "Engine/InteractionLatency.h"
 #include "Engine/CreateNodeArgs.h"
 #include "Engine/Node.h"
 #include "Engine/Project.h"
 #include "Engine/ReadNode.h"
 #include "Engine/Settings.h"
+#include "Engine/ThreadPool.h"
 #include "Engine/WriteNode.h"
 
 #include "Serialization/NodeSerialization.h"
@@ -120,6 +126,28 @@ DocumentationManager::handler(QHttpRequest *req,
     qDebug() << "www client requested" << page;
 #endif
 
+    // live cache statistics, returned as JSON so they can be polled by monitoring tools
+    if ( page == QString::fromUtf8("/_cacheStats.json") ) {
+        body = getCacheStatsJSON().toUtf8();
+        resp->setHeader( QString::fromUtf8("Content-Length"), QString::number( body.size() ) );
+        resp->setHeader( QString::fromUtf8("Content-Type"), QString::fromUtf8("application/json; charset=utf-8") );
+        resp->writeHead(200);
+        resp->end(body);
+
+        return;
+    }
+
+    // interactive latency percentiles, to compare builds against each other
+    if ( page == QString::fromUtf8("/_latencyStats.json") ) {
+        body = getLatencyStatsJSON().toUtf8();
+        resp->setHeader( QString::fromUtf8("Content-Length"), QString::number( body.size() ) );
+        resp->setHeader( QString::fromUtf8("Content-Type"), QString::fromUtf8("application/json; charset=utf-8") );
+        resp->writeHead(200);
+        resp->end(body);
+
+        return;
+    }
+
     // override static docs
     // plugin pages are generated only if they don't exist
     QString staticPage, dynamicPage, pluginID;
@@ -565,6 +593,111 @@ DocumentationManager::handler(QHttpRequest *req,
     resp->end(body);
 }                                             // DocumentationManager::handler
 
+static QString
+cacheToJSON(const QString& name,
+            const CacheBasePtr& cache)
+{
+    CacheActivityStats stats;
+
+    cache->getActivityStats(&stats);
+
+    QString ret;
+    ret += QString::fromUtf8("    \"%1\": {\n").arg(name);
+    ret += QString::fromUtf8("      \"currentSizeBytes\": %1,\n").arg( QString::number( (qulonglong)cache->getCurrentSize() ) );
+    ret += QString::fromUtf8("      \"maximumSizeBytes\": %1,\n").arg( QString::number( (qulonglong)cache->getMaximumCacheSize() ) );
+    ret += QString::fromUtf8("      \"hits\": %1,\n").arg( QString::number( (qulonglong)stats.nHits ) );
+    ret += QString::fromUtf8("      \"misses\": %1,\n").arg( QString::number( (qulonglong)stats.nMisses ) );
+    ret += QString::fromUtf8("      \"pendingWaits\": %1,\n").arg( QString::number( (qulonglong)stats.nPendingWaits ) );
+    ret += QString::fromUtf8("      \"evictions\": %1\n").arg( QString::number( (qulonglong)stats.nEvictions ) );
+    ret += QString::fromUtf8("    }");
+
+    return ret;
+}
+
+QString
+DocumentationManager::getCacheStatsJSON() const
+{
+    // The counters are cumulative: the poller derives per-second rates from the deltas
+    // between two requests
+    QString ret;
+
+    ret += QString::fromUtf8("{\n");
+    ret += QString::fromUtf8("  \"caches\": {\n");
+    ret += cacheToJSON( QString::fromUtf8("tileCache"), appPTR->getTileCache() );
+    ret += QString::fromUtf8(",\n");
+    ret += cacheToJSON( QString::fromUtf8("generalPurposeCache"), appPTR->getGeneralPurposeCache() );
+    ret += QString::fromUtf8("\n  },\n");
+
+    // Thread pool utilization: the busy/idle-wait seconds are cumulative like the cache
+    // counters. busySeconds minus idleWaitSeconds over the polling interval, divided by
+    // maxThreadCount, gives the effective utilization of the pool.
+    ThreadPoolActivityStats poolStats;
+    ThreadPoolActivity::getStats(&poolStats);
+
+    ret += QString::fromUtf8("  \"threadPool\": {\n");
+    ret += QString::fromUtf8("    \"maxThreadCount\": %1,\n").arg( QThreadPool::globalInstance()->maxThreadCount() );
+    ret += QString::fromUtf8("    \"activeThreadCount\": %1,\n").arg( QThreadPool::globalInstance()->activeThreadCount() );
+    ret += QString::fromUtf8("    \"tasksDispatched\": %1,\n").arg( QString::number( (qulonglong)poolStats.nTasksDispatched ) );
+    ret += QString::fromUtf8("    \"tasksExecuted\": %1,\n").arg( QString::number( (qulonglong)poolStats.nTasksExecuted ) );
+    ret += QString::fromUtf8("    \"queueDepth\": %1,\n").arg(poolStats.queueDepth);
+    ret += QString::fromUtf8("    \"maxQueueDepth\": %1,\n").arg(poolStats.maxQueueDepth);
+    ret += QString::fromUtf8("    \"busySeconds\": %1,\n").arg(poolStats.busyTimeSec);
+    ret += QString::fromUtf8("    \"idleWaitSeconds\": %1,\n").arg(poolStats.idleWaitTimeSec);
+    ret += QString::fromUtf8("    \"lastRenderParallelism\": %1,\n").arg(poolStats.lastRenderParallelism);
+    ret += QString::fromUtf8("    \"averageRenderParallelism\": %1\n").arg(poolStats.averageRenderParallelism);
+    ret += QString::fromUtf8("  },\n");
+
+    // Per-node memory footprint of the tile cache
+    std::map<std::string, CacheReportInfo> infos;
+    appPTR->getTileCache()->getMemoryStats(&infos);
+
+    ret += QString::fromUtf8("  \"nodes\": [\n");
+    bool first = true;
+    for (std::map<std::string, CacheReportInfo>::const_iterator it = infos.begin(); it != infos.end(); ++it) {
+        if (it->second.nBytes == 0) {
+            continue;
+        }
+        if (!first) {
+            ret += QString::fromUtf8(",\n");
+        }
+        first = false;
+        ret += QString::fromUtf8("    {\"name\": \"%1\", \"bytes\": %2, \"entries\": %3}")
+               .arg( QString::fromUtf8( it->first.c_str() ) )
+               .arg( QString::number( (qulonglong)it->second.nBytes ) )
+               .arg( QString::number(it->second.nEntries) );
+    }
+    ret += QString::fromUtf8("\n  ]\n");
+    ret += QString::fromUtf8("}\n");
+
+    return ret;
+} // DocumentationManager::getCacheStatsJSON
+
+QString
+DocumentationManager::getLatencyStatsJSON() const
+{
+    InteractionLatencyStats stats;
+
+    InteractionLatencyTracker::getStats(&stats);
+
+    // The percentiles cover a sliding window of the most recent samples, the
+    // interaction counters are cumulative
+    QString ret;
+
+    ret += QString::fromUtf8("{\n");
+    ret += QString::fromUtf8("  \"interactionLatency\": {\n");
+    ret += QString::fromUtf8("    \"interactionsStarted\": %1,\n").arg( QString::number( (qulonglong)stats.nInteractionsStarted ) );
+    ret += QString::fromUtf8("    \"interactionsDisplayed\": %1,\n").arg( QString::number( (qulonglong)stats.nInteractionsDisplayed ) );
+    ret += QString::fromUtf8("    \"samplesInWindow\": %1,\n").arg(stats.nSamplesInWindow);
+    ret += QString::fromUtf8("    \"lastSeconds\": %1,\n").arg(stats.lastSeconds);
+    ret += QString::fromUtf8("    \"p50Seconds\": %1,\n").arg(stats.p50Seconds);
+    ret += QString::fromUtf8("    \"p90Seconds\": %1,\n").arg(stats.p90Seconds);
+    ret += QString::fromUtf8("    \"p99Seconds\": %1\n").arg(stats.p99Seconds);
+    ret += QString::fromUtf8("  }\n");
+    ret += QString::fromUtf8("}\n");
+
+    return ret;
+} // DocumentationManager::getLatencyStatsJSON
+
 QString
 DocumentationManager::parser(QString html,
                              QString path) const
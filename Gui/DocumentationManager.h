@@ -60,6 +60,21 @@ private Q_SLOTS:
     void handler(QHttpRequest *req, QHttpResponse *resp);
 
 private:
+
+    /**
+     * @brief Returns the live cache statistics (activity counters, sizes and per-node
+     * memory usage) and the thread pool utilization counters formatted as JSON for the
+     * /_cacheStats.json endpoint.
+     **/
+    QString getCacheStatsJSON() const;
+
+    /**
+     * @brief Returns the interactive latency figures recorded by InteractionLatencyTracker
+     * (edit to screen percentiles and counters) formatted as JSON for the
+     * /_latencyStats.json endpoint.
+     **/
+    QString getLatencyStatsJSON() const;
+
     QHttpServer *server;
 };
 
@@ -57,6 +57,10 @@
 #define ARROW_SIZE_DISCONNECTED 10
 #define ARROW_HEAD_ANGLE ( (2 * M_PI) / 15 ) // 24 degrees opening angle is a nice thin arrow
 
+// Level of detail: when the arrow head covers fewer pixels than this on screen, the edge is
+// drawn as a plain solid line (same spirit as the thresholds in NodeGraphTextItem.cpp)
+#define NODEGRAPH_EDGE_DETAILS_MIN_SIZE_PX 5
+
 // number of offset pixels from the arrow that determine if a click is contained in the arrow or not
 #define kGraphicalContainerOffset 10
 
@@ -742,7 +746,17 @@ Edge::paint(QPainter *painter,
         }
     }
 
-    if (_imp->paintWithDash) {
+    // When zoomed out so far that the arrow head would cover only a few pixels, draw the
+    // connection as a plain solid line: the dash pattern, the head path filling and the bend
+    // point are not distinguishable at this scale and dominate the repaint time of large graphs.
+    bool drawDetails = true;
+    if (dst) {
+        NodeGraph* graph = dst->getDagGui();
+        QRect arrowBr = graph->mapFromScene( mapToScene( _imp->arrowHead.boundingRect() ).boundingRect() ).boundingRect();
+        drawDetails = std::max( arrowBr.width(), arrowBr.height() ) >= NODEGRAPH_EDGE_DETAILS_MIN_SIZE_PX;
+    }
+
+    if (_imp->paintWithDash && drawDetails) {
         QVector<qreal> dashStyle;
         qreal space = 4;
         dashStyle << 3 << space;
@@ -768,6 +782,10 @@ Edge::paint(QPainter *painter,
 
     painter->drawLine( line() );
 
+    if (!drawDetails) {
+        return;
+    }
+
     myPen.setStyle(Qt::SolidLine);
     painter->setPen(myPen);
 
@@ -108,6 +108,7 @@ Gui::Gui(const GuiAppInstancePtr& app,
     QObject::connect (this, SIGNAL(mustRefreshTimelineGuiKeyframesLater()), this, SLOT(onMustRefreshTimelineGuiKeyframesLaterReceived()), Qt::QueuedConnection);
     QObject::connect (this, SIGNAL(mustRefreshTimelineGuiKeyframesLater()), this, SLOT(onMustRefreshTimelineGuiKeyframesLaterReceived()), Qt::QueuedConnection);
     QObject::connect (this, SIGNAL(mustRefreshViewersAndKnobsLater()), this, SLOT(onMustRefreshViewersAndKnobsLaterReceived()), Qt::QueuedConnection);
+    QObject::connect (this, SIGNAL(mustRefreshDirtyKnobGuisLater()), this, SLOT(onMustRefreshDirtyKnobGuisLaterReceived()), Qt::QueuedConnection);
 
     setAcceptDrops(true);
 
@@ -474,6 +475,9 @@ Gui::createMenuActions()
     _imp->actionShowCacheReport = new ActionWithShortcut(kShortcutGroupGlobal, kShortcutActionShowCacheReport, kShortcutActionShowCacheReportLabel, this);
     QObject::connect( _imp->actionShowCacheReport, SIGNAL(triggered()), appPTR, SLOT(printCacheMemoryStats()) );
 
+    _imp->actionShowCacheActivity = new ActionWithShortcut(kShortcutGroupGlobal, kShortcutActionShowCacheActivity, kShortcutActionShowCacheActivityLabel, this);
+    QObject::connect( _imp->actionShowCacheActivity, SIGNAL(triggered()), this, SLOT(showCacheActivityWindow()) );
+
 
     _imp->actionShowAboutWindow = new ActionWithShortcut(kShortcutGroupGlobal, kShortcutActionShowAbout, kShortcutActionShowAboutLabel, this);
     _imp->actionShowAboutWindow->setMenuRole(QAction::AboutRole);
@@ -641,6 +645,7 @@ Gui::createMenuActions()
     _imp->menuRender->addAction(_imp->enableRenderStats);
 
     _imp->cacheMenu->addAction(_imp->actionShowCacheReport);
+    _imp->cacheMenu->addAction(_imp->actionShowCacheActivity);
     _imp->cacheMenu->addAction(_imp->actionClearAllCaches);
     _imp->cacheMenu->addAction(_imp->actionClearPluginsLoadingCache);
 
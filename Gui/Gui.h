@@ -507,6 +507,13 @@ public:
 
     void refreshTimelineGuiKeyframesNow();
 
+    /**
+     * @brief Registers the given knob GUI to be refreshed in the next batched refresh pass.
+     * All knobs marked dirty during a frame are refreshed in a single pass so that during
+     * playback the main thread is not monopolized by widget updates.
+     **/
+    void refreshKnobGuiLater(const KnobGuiPtr& knob);
+
     const TimeLineKeysSet& getTimelineGuiKeyframes() const;
 
     void setEditExpressionDialogLanguage(ExpressionLanguageEnum lang);
@@ -529,6 +536,8 @@ Q_SIGNALS:
 
     void mustRefreshTimelineGuiKeyframesLater();
 
+    void mustRefreshDirtyKnobGuisLater();
+
     void doDialog(int type, const QString & title, const QString & content, bool useHtml, StandardButtons buttons, int defaultB);
 
     void doDialogWithStopAskingCheckbox(int type, const QString & title, const QString & content, bool useHtml, StandardButtons buttons, int defaultB);
@@ -552,6 +561,8 @@ public Q_SLOTS:
 
     void onMustRefreshTimelineGuiKeyframesLaterReceived();
 
+    void onMustRefreshDirtyKnobGuisLaterReceived();
+
     void onShowLogOnMainThreadReceived();
 
     ///Called whenever the time changes on the timeline
@@ -620,6 +631,8 @@ public Q_SLOTS:
 
     void showAbout();
 
+    void showCacheActivityWindow();
+
     void showErrorLog();
 
     void openRecentFile();
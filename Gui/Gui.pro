@@ -95,6 +95,7 @@ SOURCES += \
     AutoHideToolBar.cpp \
     BackdropGui.cpp \
     Button.cpp \
+    CacheActivityDialog.cpp \
     CachedFramesThread.cpp \
     ClickableLabel.cpp \
     ColoredFrame.cpp \
@@ -249,6 +250,7 @@ HEADERS += \
     AutoHideToolBar.h \
     BackdropGui.h \
     Button.h \
+    CacheActivityDialog.h \
     CachedFramesThread.h \
     ClickableLabel.h \
     ColoredFrame.h \
@@ -58,10 +58,12 @@
 #include "Engine/ViewerNode.h"
 
 #include "Gui/AboutWindow.h"
+#include "Gui/CacheActivityDialog.h"
 #include "Gui/ActionShortcuts.h"
 #include "Gui/GuiAppInstance.h"
 #include "Gui/GuiApplicationManager.h" // appPTR
 #include "Gui/GuiPrivate.h"
+#include "Gui/KnobGui.h"
 #include "Gui/NodeGraph.h"
 #include "Gui/NodeGui.h"
 #include "Gui/ProjectGui.h"
@@ -121,6 +123,18 @@ Gui::showAbout()
     ignore_result( _imp->_aboutWindow->exec() );
 }
 
+void
+Gui::showCacheActivityWindow()
+{
+    if (!_imp->_cacheActivityWindow) {
+        _imp->_cacheActivityWindow = new CacheActivityDialog(this, this);
+    }
+    // Non modal: this is a monitor that should stay up during a render
+    _imp->_cacheActivityWindow->show();
+    _imp->_cacheActivityWindow->raise();
+    _imp->_cacheActivityWindow->activateWindow();
+}
+
 void
 Gui::openRecentFile()
 {
@@ -950,6 +964,32 @@ Gui::refreshTimelineGuiKeyframesNow()
 
 }
 
+void
+Gui::refreshKnobGuiLater(const KnobGuiPtr& knob)
+{
+    // Concatenate refresh requests: all knobs marked dirty during a frame are refreshed
+    // in a single pass once the event loop is processed
+    _imp->dirtyKnobGuis.push_back(knob);
+    Q_EMIT mustRefreshDirtyKnobGuisLater();
+}
+
+void
+Gui::onMustRefreshDirtyKnobGuisLaterReceived()
+{
+    if ( _imp->dirtyKnobGuis.empty() ) {
+        return;
+    }
+    std::list<KnobGuiWPtr> dirtyKnobGuis;
+    dirtyKnobGuis.swap(_imp->dirtyKnobGuis);
+
+    for (std::list<KnobGuiWPtr>::const_iterator it = dirtyKnobGuis.begin(); it != dirtyKnobGuis.end(); ++it) {
+        KnobGuiPtr knob = it->lock();
+        if (knob) {
+            knob->refreshGuiIfPending();
+        }
+    }
+}
+
 const TimeLineKeysSet&
 Gui::getTimelineGuiKeyframes() const
 {
@@ -1125,11 +1125,9 @@ GuiAppInstance::goToPreviousKeyframe()
     if (keys.size() == 0) {
         return;
     }
-    for (TimeLineKeysSet::const_reverse_iterator it = keys.rbegin(); it != keys.rend(); ++it) {
-        if (it->frame < currentFrame) {
-            timeline->seekFrame(it->frame, true, EffectInstancePtr(), eTimelineChangeReasonPlaybackSeek);
-            break;
-        }
+    int prevKeyFrame;
+    if ( keys.getPreviousKeyFrame(currentFrame, &prevKeyFrame) ) {
+        timeline->seekFrame(prevKeyFrame, true, EffectInstancePtr(), eTimelineChangeReasonPlaybackSeek);
     }
 }
 
@@ -1144,11 +1142,9 @@ GuiAppInstance::goToNextKeyframe()
     if (keys.size() == 0) {
         return;
     }
-    for (TimeLineKeysSet::const_iterator it = keys.begin(); it != keys.end(); ++it) {
-        if (it->frame > currentFrame) {
-            timeline->seekFrame(it->frame, true, EffectInstancePtr(), eTimelineChangeReasonPlaybackSeek);
-            break;
-        }
+    int nextKeyFrame;
+    if ( keys.getNextKeyFrame(currentFrame, &nextKeyFrame) ) {
+        timeline->seekFrame(nextKeyFrame, true, EffectInstancePtr(), eTimelineChangeReasonPlaybackSeek);
     }
 }
 
@@ -951,7 +951,9 @@ GuiApplicationManager::initGui(const CLArgs& args)
     QObject::connect( &_imp->updateSplashscreenTimer, SIGNAL(timeout()), this, SLOT(onFontconfigTimerTriggered()) );
     _imp->updateSplashscreenTimer.start(1000);
 
-    _imp->fontconfigUpdateWatcher->setFuture( QtConcurrent::run(_imp.get(), &GuiApplicationManagerPrivate::updateFontConfigCache) );
+    // The warm-up itself was launched on the thread-pool in AppManager::loadInternal(), watch
+    // its future to resume the load once the fontconfig caches are built
+    _imp->fontconfigUpdateWatcher->setFuture( getFontconfigWarmupFuture() );
 
     Gui::loadStyleSheet();
 
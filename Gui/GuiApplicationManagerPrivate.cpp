@@ -26,8 +26,6 @@
 
 #include <stdexcept>
 
-#include <fontconfig/fontconfig.h>
-
 CLANG_DIAG_OFF(deprecated)
 CLANG_DIAG_OFF(uninitialized)
 #include <QtCore/QDebug>
@@ -239,13 +237,4 @@ GuiApplicationManagerPrivate::createLinkMultCursor()
     _linkMultCursor = QCursor(p);
 }
 
-void
-GuiApplicationManagerPrivate::updateFontConfigCache()
-{
-    qDebug() << "Building Fontconfig fonts...";
-    FcConfig *fcConfig = FcInitLoadConfig();
-    FcConfigBuildFonts(fcConfig);
-    qDebug() << "Fontconfig fonts built";
-}
-
 NATRON_NAMESPACE_EXIT;
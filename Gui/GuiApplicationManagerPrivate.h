@@ -112,8 +112,6 @@ struct GuiApplicationManagerPrivate
                                                              const PluginPtr& plugin,
                                                              const QStringList& grouping,
                                                              const QStringList& groupingIcon);
-
-    void updateFontConfigCache();
 };
 
 NATRON_NAMESPACE_EXIT;
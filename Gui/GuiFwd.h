@@ -109,6 +109,8 @@ class AnimationModuleView;
 class BackdropGui;
 class BoundAction;
 class Button;
+class CacheActivityDialog;
+struct CachedFramesBitset;
 class ColoredFrame;
 class ComboBox;
 class CurveGui;
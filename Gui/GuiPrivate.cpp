@@ -160,6 +160,7 @@ GuiPrivate::GuiPrivate(const GuiAppInstancePtr& app,
     , actionClearPluginsLoadingCache(0)
     , actionClearAllCaches(0)
     , actionShowCacheReport(0)
+    , actionShowCacheActivity(0)
     , actionShowAboutWindow(0)
     , actionsOpenRecentFile()
     , renderAllWriters(0)
@@ -224,6 +225,7 @@ GuiPrivate::GuiPrivate(const GuiAppInstancePtr& app,
     , _currentlyDraggedPanel(0)
     , _currentlyDraggedPanelInitialSize()
     , _aboutWindow(0)
+    , _cacheActivityWindow(0)
     , _toolButtonMenuOpened(NULL)
     , aboutToCloseMutex()
     , _aboutToClose(false)
@@ -117,6 +117,7 @@ public:
     ActionWithShortcut *actionClearPluginsLoadingCache;
     ActionWithShortcut *actionClearAllCaches;
     ActionWithShortcut *actionShowCacheReport;
+    ActionWithShortcut *actionShowCacheActivity;
     ActionWithShortcut *actionShowAboutWindow;
     QAction *actionsOpenRecentFile[NATRON_MAX_RECENT_FILES];
     ActionWithShortcut *renderAllWriters;
@@ -228,6 +229,9 @@ public:
     ///The "About" window.
     AboutWindow* _aboutWindow;
 
+    ///The live cache activity window, lazily created
+    CacheActivityDialog* _cacheActivityWindow;
+
     ///list of the currently opened property panels
     QToolButton* _toolButtonMenuOpened;
     QMutex aboutToCloseMutex;
@@ -247,6 +251,9 @@ public:
     // Used to concatenate frameChanged signal reception
     int nKnobsRefreshAfterTimeChangeRequests;
 
+    // Knob GUIs that requested a refresh since the last batched refresh pass
+    std::list<KnobGuiWPtr> dirtyKnobGuis;
+
     // List of keyframes that should be visible on all timeline GUI
     TimeLineKeysSet keyframesVisibleOnTimeline;
 
@@ -49,6 +49,7 @@ GCC_DIAG_UNUSED_PRIVATE_FIELD_ON
 #include "Engine/Image.h"
 #include "Engine/Node.h"
 #include "Engine/OSGLFunctions.h"
+#include "Engine/Smooth1D.h"
 #include "Engine/Texture.h"
 #include "Engine/ViewerInstance.h"
 #include "Engine/ViewerNode.h"
@@ -133,6 +134,17 @@ public:
         , sizeH()
         , showViewerPicker(false)
         , viewerPickerColor()
+        , computeOnGPU(NULL)
+        , gpuBinningFailed(false)
+        , binningShader()
+        , binningSrcTexture(0)
+        , binningSrcTextureW(0)
+        , binningSrcTextureH(0)
+        , binningPointsVbo(0)
+        , binningPointsCount(0)
+        , binningTexture(0)
+        , binningTextureBins(0)
+        , binningFbo(0)
     {
     }
 
@@ -153,6 +165,14 @@ public:
 
     void drawHistogramCPU();
 
+    /**
+     * @brief Bins the given image on the GPU into histogram1/2/3 (according to the mode) and
+     * smooths them like the CPU path does. The widget OpenGL context must be current.
+     * Returns false if the required OpenGL features are not available, in which case the
+     * histograms are left untouched.
+     **/
+    bool computeHistogramOnGPU(const ImagePtr& image, const RectI& roi, int mode, unsigned int binsCount, double vmin, double vmax, int smoothingKernelSize);
+
     //////////////////////////////////
     // data members
 
@@ -200,6 +220,27 @@ public:
     QSize sizeH;
     bool showViewerPicker;
     std::vector<double> viewerPickerColor;
+
+    ///////// GPU binning
+
+    // Toggles binning on the GPU: the image is uploaded to a texture and a scatter pass
+    // accumulates one point per pixel into a binsCount x 1 float framebuffer
+    QAction* computeOnGPU;
+
+    // Set when the GPU binning path failed (missing OpenGL features): the action is
+    // disabled and the CPU path is used from then on
+    bool gpuBinningFailed;
+
+    // The shader positioning each point on the bin of its pixel value, see histogramBinning_vert
+    boost::shared_ptr<QGLShaderProgram> binningShader;
+
+    GLuint binningSrcTexture; //!< the texture holding the image to bin
+    int binningSrcTextureW, binningSrcTextureH;
+    GLuint binningPointsVbo; //!< one 2D vertex per pixel of the source texture
+    std::size_t binningPointsCount;
+    GLuint binningTexture; //!< the binsCount x 1 float accumulation texture
+    int binningTextureBins;
+    GLuint binningFbo; //!< FBO with binningTexture attached
 };
 
 Histogram::Histogram(const std::string& scriptName,
@@ -264,6 +305,13 @@ Histogram::Histogram(const std::string& scriptName,
     QObject::connect( _imp->fullImage, SIGNAL(triggered()), this, SLOT(computeHistogramAndRefresh()) );
     _imp->rightClickMenu->addAction(_imp->fullImage);
 
+    _imp->computeOnGPU = new QAction(_imp->rightClickMenu);
+    _imp->computeOnGPU->setText( tr("Compute on GPU") );
+    _imp->computeOnGPU->setCheckable(true);
+    _imp->computeOnGPU->setChecked(true);
+    QObject::connect( _imp->computeOnGPU, SIGNAL(triggered()), this, SLOT(computeHistogramAndRefresh()) );
+    _imp->rightClickMenu->addAction(_imp->computeOnGPU);
+
     _imp->filterMenu = new Menu(tr("Smoothing"), _imp->rightClickMenu);
     //_imp->filterMenu->setFont( QFont(appFont,appFontSize) );
     _imp->rightClickMenu->addAction( _imp->filterMenu->menuAction() );
@@ -343,6 +391,22 @@ Histogram::~Histogram()
     // always running in the main thread
     assert( qApp && qApp->thread() == QThread::currentThread() );
     makeCurrent();
+
+    _imp->binningShader.reset();
+    if ( appPTR && appPTR->isOpenGLLoaded() ) {
+        if (_imp->binningSrcTexture) {
+            GL_GPU::DeleteTextures(1, &_imp->binningSrcTexture);
+        }
+        if (_imp->binningTexture) {
+            GL_GPU::DeleteTextures(1, &_imp->binningTexture);
+        }
+        if (_imp->binningFbo) {
+            GL_GPU::DeleteFramebuffers(1, &_imp->binningFbo);
+        }
+        if (_imp->binningPointsVbo) {
+            GL_GPU::DeleteBuffers(1, &_imp->binningPointsVbo);
+        }
+    }
 }
 
 int
@@ -963,7 +1027,8 @@ Histogram::computeHistogramAndRefresh(bool forceEvenIfNotVisible)
     QPointF topRight = _imp->zoomCtx.toZoomCoordinates(width() - 1, 0);
     double vmin = btmLeft.x();
     double vmax = topRight.x();
-    _imp->histogramThread.computeHistogram(_imp->mode, viewer->getInternalNode(), textureIndex, roiParam, width(), vmin, vmax, _imp->filterSize);
+    bool gpuBinning = _imp->computeOnGPU->isChecked() && !_imp->gpuBinningFailed;
+    _imp->histogramThread.computeHistogram(_imp->mode, viewer->getInternalNode(), textureIndex, roiParam, width(), vmin, vmax, _imp->filterSize, gpuBinning);
 
     QPointF oldClick_opengl = _imp->zoomCtx.toZoomCoordinates( _imp->oldClick.x(), _imp->oldClick.y() );
     _imp->updatePicker( oldClick_opengl.x() );
@@ -979,12 +1044,29 @@ Histogram::onCPUHistogramComputed()
     assert( qApp && qApp->thread() == QThread::currentThread() );
 
     int mode;
-    bool success = _imp->histogramThread.getMostRecentlyProducedHistogram(&_imp->histogram1, &_imp->histogram2, &_imp->histogram3, &_imp->binsCount, &_imp->pixelsCount, &mode, &_imp->vmin, &_imp->vmax, &_imp->mipMapLevel);
+    ImagePtr imageForGPUBinning;
+    RectI roiForGPUBinning;
+    int smoothingKernelSize = 0;
+    bool success = _imp->histogramThread.getMostRecentlyProducedHistogram(&_imp->histogram1, &_imp->histogram2, &_imp->histogram3, &_imp->binsCount, &_imp->pixelsCount, &mode, &_imp->vmin, &_imp->vmax, &_imp->mipMapLevel, &imageForGPUBinning, &roiForGPUBinning, &smoothingKernelSize);
     assert(success);
-    if (success) {
-        _imp->hasImage = true;
-        update();
+    if (!success) {
+        return;
     }
+    if (imageForGPUBinning) {
+        // The request was made with GPU binning: bin the image on the GPU now
+        makeCurrent();
+        if ( !_imp->computeHistogramOnGPU(imageForGPUBinning, roiForGPUBinning, mode, _imp->binsCount, _imp->vmin, _imp->vmax, smoothingKernelSize) ) {
+            // The required OpenGL features are not available: fall back on the CPU path for good
+            _imp->gpuBinningFailed = true;
+            _imp->computeOnGPU->setChecked(false);
+            _imp->computeOnGPU->setEnabled(false);
+            computeHistogramAndRefresh(true);
+
+            return;
+        }
+    }
+    _imp->hasImage = true;
+    update();
 }
 
 
@@ -1430,6 +1512,227 @@ HistogramPrivate::drawHistogramCPU()
     glCheckError(GL_GPU);
 } // drawHistogramCPU
 
+// Mirrors the tail of the CPU binning path (see computeHistogramStatic in HistogramCPU.cpp):
+// smooth the upscaled histogram and downsample it to obtain the final histogram.
+static void
+smoothAndDownsampleHistogram(std::vector<float>& histoUpscaled,
+                             unsigned int binsCount,
+                             int upscale,
+                             int smoothingKernelSize,
+                             std::vector<float>* histo)
+{
+    double sigma = upscale;
+
+    if (smoothingKernelSize > 1) {
+        sigma *= smoothingKernelSize;
+    }
+    Smooth1D::iir_gaussianFilter1D(histoUpscaled, sigma);
+
+    histo->resize(binsCount);
+    assert(histoUpscaled.size() == histo->size() * upscale);
+    std::vector<float>::const_iterator it_in = histoUpscaled.begin();
+    std::advance(it_in, (upscale - 1) / 2);
+    std::vector<float>::iterator it_out = histo->begin();
+    while ( it_out != histo->end() ) {
+        *it_out = *it_in * upscale;
+        ++it_out;
+        if ( it_out != histo->end() ) {
+            std::advance(it_in, upscale);
+        }
+    }
+}
+
+bool
+HistogramPrivate::computeHistogramOnGPU(const ImagePtr& image,
+                                        const RectI& roi,
+                                        int mode,
+                                        unsigned int binsCount,
+                                        double vmin,
+                                        double vmax,
+                                        int smoothingKernelSize)
+{
+    // always running in the main thread
+    assert( qApp && qApp->thread() == QThread::currentThread() );
+    assert( QGLContext::currentContext() == widget->context() );
+
+    if ( !QGLShaderProgram::hasOpenGLShaderPrograms( widget->context() ) ) {
+        return false;
+    }
+    GLint maxVertexTextures = 0;
+    GL_GPU::GetIntegerv(GL_MAX_VERTEX_TEXTURE_IMAGE_UNITS, &maxVertexTextures);
+    if (maxVertexTextures <= 0) {
+        // The hardware cannot fetch textures from the vertex shader
+        return false;
+    }
+
+    if (!binningShader) {
+        binningShader.reset( new QGLShaderProgram( widget->context() ) );
+        if ( !binningShader->addShaderFromSourceCode(QGLShader::Vertex, histogramBinning_vert) ) {
+            qDebug() << qPrintable( binningShader->log() );
+        }
+        if ( !binningShader->addShaderFromSourceCode(QGLShader::Fragment, histogramBinning_frag) ) {
+            qDebug() << qPrintable( binningShader->log() );
+        }
+        if ( !binningShader->link() ) {
+            qDebug() << qPrintable( binningShader->log() );
+            binningShader.reset();
+
+            return false;
+        }
+    }
+
+    Image::CPUData imageData;
+    image->getCPUData(&imageData);
+    // The engine thread only hands packed RGBA float images to the GPU binning path
+    assert(imageData.nComps == 4 && !imageData.ptrs[1] && imageData.bitDepth == eImageBitDepthFloat);
+
+    RectI srcRect;
+    roi.intersect(imageData.bounds, &srcRect);
+    if ( (binsCount == 0) || (vmax <= vmin) || srcRect.isNull() ) {
+        histogram1.clear();
+        histogram2.clear();
+        histogram3.clear();
+
+        return true;
+    }
+
+    const int w = srcRect.width();
+    const int h = srcRect.height();
+
+    glCheckError(GL_GPU);
+
+    // Upload the region of interest of the image
+    if (binningSrcTexture == 0) {
+        GL_GPU::GenTextures(1, &binningSrcTexture);
+    }
+    GL_GPU::ActiveTexture(GL_TEXTURE0);
+    GL_GPU::BindTexture(GL_TEXTURE_2D, binningSrcTexture);
+    GL_GPU::TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    GL_GPU::TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    GL_GPU::TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    GL_GPU::TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    GL_GPU::PixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    GL_GPU::PixelStorei( GL_UNPACK_ROW_LENGTH, imageData.bounds.width() );
+    GL_GPU::PixelStorei(GL_UNPACK_SKIP_PIXELS, srcRect.x1 - imageData.bounds.x1);
+    GL_GPU::PixelStorei(GL_UNPACK_SKIP_ROWS, srcRect.y1 - imageData.bounds.y1);
+    GL_GPU::TexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F_ARB, w, h, 0, GL_RGBA, GL_FLOAT, imageData.ptrs[0]);
+    GL_GPU::PixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    GL_GPU::PixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+    GL_GPU::PixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+    glCheckError(GL_GPU);
+
+    // (Re)build the grid of points, one per pixel of the source texture
+    if (binningPointsVbo == 0) {
+        GL_GPU::GenBuffers(1, &binningPointsVbo);
+    }
+    GL_GPU::BindBuffer(GL_ARRAY_BUFFER, binningPointsVbo);
+    if ( (w != binningSrcTextureW) || (h != binningSrcTextureH) ) {
+        std::vector<GLshort> points( (std::size_t)w * h * 2 );
+        std::size_t i = 0;
+        for (int y = 0; y < h; ++y) {
+            for (int x = 0; x < w; ++x) {
+                points[i] = x;
+                ++i;
+                points[i] = y;
+                ++i;
+            }
+        }
+        GL_GPU::BufferData(GL_ARRAY_BUFFER, points.size() * sizeof(GLshort), &points[0], GL_STATIC_DRAW);
+        binningPointsCount = (std::size_t)w * h;
+        binningSrcTextureW = w;
+        binningSrcTextureH = h;
+    }
+
+    // Bin at upscale times the resolution like the CPU path, see computeHistogramStatic
+    const int upscale = 5;
+    const int binsCountUpscaled = binsCount * upscale;
+
+    if (binningTexture == 0) {
+        GL_GPU::GenTextures(1, &binningTexture);
+    }
+    if (binningTextureBins != binsCountUpscaled) {
+        GL_GPU::BindTexture(GL_TEXTURE_2D, binningTexture);
+        GL_GPU::TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        GL_GPU::TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        GL_GPU::TexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F_ARB, binsCountUpscaled, 1, 0, GL_RGBA, GL_FLOAT, 0);
+        binningTextureBins = binsCountUpscaled;
+    }
+    if (binningFbo == 0) {
+        GL_GPU::GenFramebuffers(1, &binningFbo);
+    }
+    GL_GPU::BindFramebuffer(GL_FRAMEBUFFER, binningFbo);
+    GL_GPU::FramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, binningTexture, 0);
+    if (GL_GPU::CheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        // Float color attachments are not renderable on this hardware
+        GL_GPU::BindFramebuffer(GL_FRAMEBUFFER, 0);
+        GL_GPU::BindBuffer(GL_ARRAY_BUFFER, 0);
+        GL_GPU::BindTexture(GL_TEXTURE_2D, 0);
+
+        return false;
+    }
+
+    {
+        GLProtectAttrib<GL_GPU> a(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_VIEWPORT_BIT);
+
+        GL_GPU::Viewport(0, 0, binsCountUpscaled, 1);
+        GL_GPU::Disable(GL_SCISSOR_TEST);
+        GL_GPU::Enable(GL_BLEND);
+        GL_GPU::BlendEquationSeparate(GL_FUNC_ADD, GL_FUNC_ADD);
+        GL_GPU::BlendFuncSeparate(GL_ONE, GL_ONE, GL_ONE, GL_ONE);
+
+        GL_GPU::BindTexture(GL_TEXTURE_2D, binningSrcTexture);
+
+        binningShader->bind();
+        binningShader->setUniformValue("Tex", 0);
+        binningShader->setUniformValue( "texSize", (GLfloat)w, (GLfloat)h );
+        binningShader->setUniformValue( "vmin", (GLfloat)vmin );
+        binningShader->setUniformValue( "vmax", (GLfloat)vmax );
+
+        GL_GPU::EnableClientState(GL_VERTEX_ARRAY);
+        GL_GPU::VertexPointer(2, GL_SHORT, 0, 0);
+
+        std::vector<float> accum( (std::size_t)binsCountUpscaled * 4 );
+        std::vector<float> histoUpscaled(binsCountUpscaled);
+
+        /// keep the channel codes in sync with Histogram::DisplayModeEnum
+        int channels[3] = { 0, 0, 0 };
+        std::vector<float>* histos[3] = { &histogram1, NULL, NULL };
+        int nPasses = 1;
+        if (mode == Histogram::eDisplayModeRGB) {
+            channels[0] = 3;     //< R
+            channels[1] = 4;     //< G
+            channels[2] = 5;     //< B
+            histos[1] = &histogram2;
+            histos[2] = &histogram3;
+            nPasses = 3;
+        } else {
+            channels[0] = mode;
+            histogram2.clear();
+            histogram3.clear();
+        }
+
+        for (int i = 0; i < nPasses; ++i) {
+            binningShader->setUniformValue( "channel", (GLint)channels[i] );
+            GL_GPU::ClearColor(0.f, 0.f, 0.f, 0.f);
+            GL_GPU::Clear(GL_COLOR_BUFFER_BIT);
+            GL_GPU::DrawArrays( GL_POINTS, 0, (GLsizei)binningPointsCount );
+            GL_GPU::ReadPixels(0, 0, binsCountUpscaled, 1, GL_RGBA, GL_FLOAT, &accum[0]);
+            for (int b = 0; b < binsCountUpscaled; ++b) {
+                histoUpscaled[b] = accum[b * 4];
+            }
+            smoothAndDownsampleHistogram(histoUpscaled, binsCount, upscale, smoothingKernelSize, histos[i]);
+        }
+
+        GL_GPU::DisableClientState(GL_VERTEX_ARRAY);
+        GL_GPU::BindBuffer(GL_ARRAY_BUFFER, 0);
+        binningShader->release();
+        GL_GPU::BindTexture(GL_TEXTURE_2D, 0);
+    } // GLProtectAttrib a(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_VIEWPORT_BIT);
+    GL_GPU::BindFramebuffer(GL_FRAMEBUFFER, 0);
+    glCheckError(GL_GPU);
+
+    return true;
+} // computeHistogramOnGPU
 
 void
 Histogram::renderText(double x,
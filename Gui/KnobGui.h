@@ -222,6 +222,13 @@ public:
 
     void reflectKnobSelectionState(bool selected);
 
+    /**
+     * @brief If a GUI refresh was requested since the last refresh, update the widgets now.
+     * If the panel containing the knob is closed, the request is left pending and honored
+     * when the panel gets re-opened.
+     **/
+    void refreshGuiIfPending();
+
 public Q_SLOTS:
 
     void onProjectViewsChanged();
@@ -42,6 +42,7 @@ CLANG_DIAG_ON(uninitialized)
 #include "Gui/AnimationModule.h"
 #include "Gui/NodeAnim.h"
 #include "Gui/KnobAnim.h"
+#include "Gui/DockablePanel.h"
 #include "Gui/Gui.h"
 #include "Gui/NodeGraph.h"
 #include "Gui/KnobGuiContainerHelper.h"
@@ -55,17 +56,40 @@ NATRON_NAMESPACE_ENTER;
 void
 KnobGui::onMustRefreshGuiActionTriggered(ViewSetSpec /*view*/, DimSpec /*dimension*/, ValueChangedReasonEnum /*reason*/)
 {
-    ++_imp->refreshGuiRequests;
-    Q_EMIT s_doUpdateGuiLater();
+    if (++_imp->refreshGuiRequests > 1) {
+        // A refresh is already pending
+        return;
+    }
+    Gui* gui = getGui();
+    if (gui) {
+        // During playback every animated knob requests a refresh per frame: batch them on
+        // the Gui so that they are all processed in a single pass
+        gui->refreshKnobGuiLater( shared_from_this() );
+    } else {
+        Q_EMIT s_doUpdateGuiLater();
+    }
 }
 
 void
 KnobGui::onDoUpdateGuiLaterReceived()
+{
+    refreshGuiIfPending();
+}
+
+void
+KnobGui::refreshGuiIfPending()
 {
     if (_imp->guiRemoved || !_imp->widgetCreated || !_imp->refreshGuiRequests) {
         return;
     }
-    
+
+    // Don't spend time refreshing widgets that are not visible: the request is left pending
+    // and honored in setClosedInternal() when the panel gets re-opened.
+    DockablePanel* panel = dynamic_cast<DockablePanel*>( getContainer() );
+    if ( panel && panel->isClosed() ) {
+        return;
+    }
+
     _imp->refreshGuiRequests = 0;
     refreshGuiNow();
 }
@@ -24,6 +24,9 @@
 
 #include "KnobGuiContainerHelper.h"
 
+#include <algorithm>
+#include <map>
+
 CLANG_DIAG_OFF(deprecated)
 CLANG_DIAG_OFF(uninitialized)
 #include <QScrollArea>
@@ -70,6 +73,11 @@ struct KnobGuiContainerHelperPrivate
     PagesMap pages;
     KnobPageGuiPtr unPagedContainer; // used when container is not paged
 
+    // Knobs of pages that are not the current one: their widgets are only instantiated
+    // the first time their page becomes current, which makes opening the panel of
+    // plug-ins with hundreds of knobs much cheaper.
+    std::map<KnobPageWPtr, KnobsVec> pendingPageKnobs;
+
     // When set as a dialog, this is a pointer to the group knob representing the dialog
     KnobGroupWPtr dialogKnob;
 
@@ -90,6 +98,7 @@ struct KnobGuiContainerHelperPrivate
     , currentPage()
     , pages()
     , unPagedContainer()
+    , pendingPageKnobs()
     , dialogKnob()
     , undoStack()
     , cmdBeingPushed(0)
@@ -225,9 +234,26 @@ void
 KnobGuiContainerHelper::setCurrentPage(const KnobPageGuiPtr& curPage)
 {
     _imp->currentPage = curPage;
+    createPendingPageKnobs(curPage);
     _imp->refreshPagesEnabledness();
 }
 
+void
+KnobGuiContainerHelper::createPendingPageKnobs(const KnobPageGuiPtr& page)
+{
+    if (!page) {
+        return;
+    }
+    std::map<KnobPageWPtr, KnobsVec>::iterator found = _imp->pendingPageKnobs.find(page->pageKnob);
+    if ( found == _imp->pendingPageKnobs.end() ) {
+        return;
+    }
+    KnobsVec pending;
+    pending.swap(found->second);
+    _imp->pendingPageKnobs.erase(found);
+    initializeKnobVectorInternal(pending, 0);
+}
+
 KnobPageGuiPtr
 KnobGuiContainerHelper::getOrCreatePage(const KnobPagePtr& page)
 {
@@ -425,6 +451,20 @@ KnobGuiContainerHelper::initializeKnobVectorInternal(const KnobsVec& siblingsVec
     }
 } // KnobGuiContainerHelper::initializeKnobVectorInternal
 
+static void
+appendGroupChildrenRecursively(const KnobsVec& knobs,
+                               KnobsVec* outKnobs)
+{
+    for (KnobsVec::const_iterator it = knobs.begin(); it != knobs.end(); ++it) {
+        KnobGroupPtr isGroup = toKnobGroup(*it);
+        if (isGroup) {
+            KnobsVec children = isGroup->getChildren();
+            outKnobs->insert( outKnobs->end(), children.begin(), children.end() );
+            appendGroupChildrenRecursively(children, outKnobs);
+        }
+    }
+}
+
 void
 KnobGuiContainerHelper::initializeKnobVector(const KnobsVec& knobs)
 {
@@ -443,6 +483,19 @@ KnobGuiContainerHelper::initializeKnobVector(const KnobsVec& knobs)
             regularKnobs.push_back(knobs[i]);
         }
     }
+    // Only instantiate the widgets of the page that is initially current: other pages
+    // get their knob widgets created the first time they become the current tab.
+    KnobPagePtr eagerPage;
+    if ( isPagingEnabled() && (pages.size() > 1) ) {
+        KnobPageGuiPtr curPage = getCurrentPage();
+        if (curPage) {
+            eagerPage = curPage->pageKnob.lock();
+        }
+        if (!eagerPage) {
+            eagerPage = pages.front();
+        }
+    }
+
     for (std::list<KnobPagePtr >::iterator it = pages.begin(); it != pages.end(); ++it) {
         // Create page
         KnobGuiPtr knobGui = findKnobGuiOrCreate(*it);
@@ -450,7 +503,21 @@ KnobGuiContainerHelper::initializeKnobVector(const KnobsVec& knobs)
 
         // Create its children
         KnobsVec children = (*it)->getChildren();
-        initializeKnobVectorInternal(children, &regularKnobs);
+        if (!eagerPage || *it == eagerPage) {
+            initializeKnobVectorInternal(children, &regularKnobs);
+        } else {
+            // Defer the widgets creation: gather the whole knobs sub-tree of the page so
+            // that none of them is created by the page-less knobs pass below.
+            KnobsVec& pending = _imp->pendingPageKnobs[*it];
+            pending = children;
+            appendGroupChildrenRecursively(children, &pending);
+            for (KnobsVec::const_iterator it2 = pending.begin(); it2 != pending.end(); ++it2) {
+                KnobsVec::iterator foundRegular = std::find(regularKnobs.begin(), regularKnobs.end(), *it2);
+                if ( foundRegular != regularKnobs.end() ) {
+                    regularKnobs.erase(foundRegular);
+                }
+            }
+        }
     }
 
     // Remove from the regularKnobs left the knobs that want to be with the knobsTable (if any)
@@ -930,9 +997,20 @@ KnobGuiContainerHelper::createKnobHorizontalFieldContainer(QWidget* parent) cons
 void
 KnobGuiContainerHelper::deleteKnobGui(const KnobIPtr& knob)
 {
+    // If the knob widgets creation was deferred, forget about it
+    for (std::map<KnobPageWPtr, KnobsVec>::iterator it = _imp->pendingPageKnobs.begin(); it != _imp->pendingPageKnobs.end(); ++it) {
+        KnobsVec::iterator foundPending = std::find(it->second.begin(), it->second.end(), knob);
+        if ( foundPending != it->second.end() ) {
+            it->second.erase(foundPending);
+            break;
+        }
+    }
+
     KnobPagePtr isPage = toKnobPage(knob);
 
     if ( isPage && isPagingEnabled() ) {
+        _imp->pendingPageKnobs.erase(isPage);
+
         // Remove the page and all its children
         PagesMap::iterator found = _imp->pages.find(isPage);
         if ( found != _imp->pages.end() ) {
@@ -1030,6 +1108,7 @@ KnobGuiContainerHelper::refreshGuiForKnobsChanges(bool restorePageIndex)
         it->second->tab->deleteLater();
     }
     _imp->pages.clear();
+    _imp->pendingPageKnobs.clear();
 
     //Clear undo/Redo stack so that KnobGui pointers are not lying around
     clearUndoRedoStack();
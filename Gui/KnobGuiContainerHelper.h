@@ -388,6 +388,12 @@ private:
 
     void initializeKnobVectorInternal(const KnobsVec& siblingsVec, KnobsVec* regularKnobsVec);
 
+    /**
+     * @brief Creates the knob widgets of the given page if they were deferred when the
+     * panel was built, see initializeKnobVector()
+     **/
+    void createPendingPageKnobs(const KnobPageGuiPtr& page);
+
     void recreateKnobsInternal(const KnobPageGuiPtr& curPage, bool restorePageIndex);
 
     void onDeleteCurCmdLater();
@@ -759,6 +759,7 @@ KnobItemsTableGui::KnobItemsTableGui(const KnobItemsTablePtr& table, DockablePan
     connect(table.get(), SIGNAL(selectionChanged(std::list<KnobTableItemPtr>,std::list<KnobTableItemPtr>,TableChangeReasonEnum)), this, SLOT(onModelSelectionChanged(std::list<KnobTableItemPtr>,std::list<KnobTableItemPtr>,TableChangeReasonEnum)));
     connect(table.get(), SIGNAL(itemRemoved(KnobTableItemPtr,TableChangeReasonEnum)), this, SLOT(onModelItemRemoved( KnobTableItemPtr,TableChangeReasonEnum)));
     connect(table.get(), SIGNAL(itemInserted(int,KnobTableItemPtr,TableChangeReasonEnum)), this, SLOT(onModelItemInserted(int,KnobTableItemPtr,TableChangeReasonEnum)));
+    connect(table.get(), SIGNAL(bulkItemsEdited(std::list<KnobTableItemPtr>,std::list<KnobTableItemPtr>,TableChangeReasonEnum)), this, SLOT(onModelBulkItemsEdited(std::list<KnobTableItemPtr>,std::list<KnobTableItemPtr>,TableChangeReasonEnum)));
 
 
 
@@ -2108,6 +2109,17 @@ KnobItemsTableGui::onModelItemInserted(int /*index*/, const KnobTableItemPtr& it
 
 }
 
+void
+KnobItemsTableGui::onModelBulkItemsEdited(const std::list<KnobTableItemPtr>& insertedItems, const std::list<KnobTableItemPtr>& removedItems, TableChangeReasonEnum reason)
+{
+    for (std::list<KnobTableItemPtr>::const_iterator it = removedItems.begin(); it != removedItems.end(); ++it) {
+        onModelItemRemoved(*it, reason);
+    }
+    for (std::list<KnobTableItemPtr>::const_iterator it = insertedItems.begin(); it != insertedItems.end(); ++it) {
+        onModelItemInserted((*it)->getIndexInParent(), *it, reason);
+    }
+}
+
 void
 KnobItemsTableGuiPrivate::createItemsVecRecursive(const std::vector<KnobTableItemPtr>& items)
 {
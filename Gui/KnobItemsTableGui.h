@@ -106,6 +106,7 @@ public Q_SLOTS:
     void onModelSelectionChanged(const std::list<KnobTableItemPtr>& addedToSelection, const std::list<KnobTableItemPtr>& removedFromSelection, TableChangeReasonEnum reason);
     void onModelItemRemoved(const KnobTableItemPtr& item, TableChangeReasonEnum reason);
     void onModelItemInserted(int index, const KnobTableItemPtr& item, TableChangeReasonEnum reason);
+    void onModelBulkItemsEdited(const std::list<KnobTableItemPtr>& insertedItems, const std::list<KnobTableItemPtr>& removedItems, TableChangeReasonEnum reason);
 
     void onItemLabelChanged(const QString& label, TableChangeReasonEnum reason);
     void onItemIconChanged(TableChangeReasonEnum reason);
@@ -44,6 +44,7 @@ GCC_DIAG_ON(unused-parameter)
 #include "Engine/Node.h"
 #include "Engine/TimeLine.h"
 #include "Engine/AppInstance.h"
+#include "Engine/UndoStateStore.h"
 #include "Engine/ViewIdx.h"
 
 #include "Gui/GuiApplicationManager.h"
@@ -820,9 +821,9 @@ RestoreDefaultsCommand::RestoreDefaultsCommand(const std::list<KnobIPtr > & knob
             continue;
         }
 
-        SERIALIZATION_NAMESPACE::KnobSerializationPtr s(new SERIALIZATION_NAMESPACE::KnobSerialization());
-        (*it)->toSerialization(s.get());
-        _serializations.push_back(s);
+        SERIALIZATION_NAMESPACE::KnobSerialization s;
+        (*it)->toSerialization(&s);
+        _states.push_back( appPTR->getUndoStateStore()->storeState(s) );
         _knobs.push_back(*it);
 
     }
@@ -831,19 +832,22 @@ RestoreDefaultsCommand::RestoreDefaultsCommand(const std::list<KnobIPtr > & knob
 void
 RestoreDefaultsCommand::undo()
 {
-    assert( _serializations.size() == _knobs.size() );
+    assert( _states.size() == _knobs.size() );
 
     KnobIPtr first = _knobs.front().lock();
     AppInstancePtr app = first->getHolder()->getApp();
     assert(app);
-    SERIALIZATION_NAMESPACE::KnobSerializationList::const_iterator itClone = _serializations.begin();
+    std::list<UndoStatePayloadPtr>::const_iterator itClone = _states.begin();
     for (std::list<KnobIWPtr >::const_iterator it = _knobs.begin(); it != _knobs.end(); ++it, ++itClone) {
         KnobIPtr itKnob = it->lock();
         if (!itKnob) {
             continue;
         }
-       
-        itKnob->fromSerialization(**itClone);
+
+        SERIALIZATION_NAMESPACE::KnobSerialization s;
+        if ( appPTR->getUndoStateStore()->fetchState(*itClone, &s) ) {
+            itKnob->fromSerialization(s);
+        }
     }
 
     if ( first->getHolder()->getApp() ) {
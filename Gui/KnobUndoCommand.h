@@ -401,7 +401,10 @@ private:
     DimSpec _targetDim;
     ViewSetSpec _targetView;
     std::list<KnobIWPtr> _knobs;
-    SERIALIZATION_NAMESPACE::KnobSerializationList _serializations;
+
+    // The serialized state of each knob before the reset, held in the UndoStateStore so
+    // that undo history is de-duplicated and memory capped
+    std::list<UndoStatePayloadPtr> _states;
 };
 
 class SetExpressionCommand
@@ -280,6 +280,7 @@ NodeAnim::initializeTableItems()
 
     connect(internalTable.get(), SIGNAL(itemRemoved(KnobTableItemPtr,TableChangeReasonEnum)), this, SLOT(onTableItemRemoved(KnobTableItemPtr,TableChangeReasonEnum)));
     connect(internalTable.get(), SIGNAL(itemInserted(int,KnobTableItemPtr,TableChangeReasonEnum)), this, SLOT(onTableItemInserted(int,KnobTableItemPtr,TableChangeReasonEnum)));
+    connect(internalTable.get(), SIGNAL(bulkItemsEdited(std::list<KnobTableItemPtr>,std::list<KnobTableItemPtr>,TableChangeReasonEnum)), this, SLOT(onTableBulkItemsEdited(std::list<KnobTableItemPtr>,std::list<KnobTableItemPtr>,TableChangeReasonEnum)));
 
     NodeAnimPtr thisShared = shared_from_this();
 
@@ -379,6 +380,17 @@ NodeAnim::onTableItemInserted(int index, const KnobTableItemPtr& item, TableChan
     _imp->insertItem(index, item, reason);
 }
 
+void
+NodeAnim::onTableBulkItemsEdited(const std::list<KnobTableItemPtr>& insertedItems, const std::list<KnobTableItemPtr>& removedItems, TableChangeReasonEnum reason)
+{
+    for (std::list<KnobTableItemPtr>::const_iterator it = removedItems.begin(); it != removedItems.end(); ++it) {
+        _imp->removeItem(*it, reason);
+    }
+    for (std::list<KnobTableItemPtr>::const_iterator it = insertedItems.begin(); it != insertedItems.end(); ++it) {
+        _imp->insertItem((*it)->getIndexInParent(), *it, reason);
+    }
+}
+
 
 void
 NodeAnim::onNodeLabelChanged(const QString &/*oldName*/, const QString& newName)
@@ -95,9 +95,11 @@ public Q_SLOTS:
     void onNodeLabelChanged(const QString &oldName, const QString& newName);
 
     void onTableItemRemoved(const KnobTableItemPtr& item, TableChangeReasonEnum);
-    
+
     void onTableItemInserted(int index, const KnobTableItemPtr& item, TableChangeReasonEnum);
 
+    void onTableBulkItemsEdited(const std::list<KnobTableItemPtr>& insertedItems, const std::list<KnobTableItemPtr>& removedItems, TableChangeReasonEnum reason);
+
 private:
 
 
@@ -158,6 +158,22 @@ NodeGraph::mouseDoubleClickEvent(QMouseEvent* e)
     NearbyItemEnum nearbyItemCode = hasItemNearbyMouse(e->pos(), &nearbyNode, &nearbyEdge);
 
     if (nearbyItemCode == eNearbyItemNode || nearbyItemCode == eNearbyItemBackdropFrame) {
+        NodePtr internalNode = nearbyNode->getNode();
+        if ( internalNode && internalNode->isEffectStubNode() ) {
+            // A node loaded as a stub (fast project open or missing plug-in at load time):
+            // create the real node now that the user wants to work with it
+            NodePtr realNode = appPTR->recreateNodeFromStub(internalNode);
+            if (!realNode) {
+                return;
+            }
+            if (realNode != internalNode) {
+                NodeGuiPtr realNodeGui = boost::dynamic_pointer_cast<NodeGui>( realNode->getNodeGui() );
+                if (!realNodeGui) {
+                    return;
+                }
+                nearbyNode = realNodeGui;
+            }
+        }
         showNodePanel(modCASIsControl(e), modCASIsShift(e), nearbyNode);
     }
 } // NodeGraph::mouseDoubleClickEvent
@@ -236,7 +236,20 @@ NodeGraph::updateCacheSizeText()
 void
 NodeGraph::onRefreshNodesRenderStateTimerTimeout()
 {
+    // Only refresh the nodes visible in the viewport: refreshing the state indicator and the
+    // edge colors of every node repaints the whole graph at each tick, which makes large
+    // graphs sluggish. The indicators of off-screen nodes are recomputed from the current
+    // rendering counters at the first tick after they are scrolled back into the viewport.
+    // Viewer nodes are always refreshed: their refresh also drives the rendering spinner of
+    // the viewer tab, which stays visible when the node is off-screen.
+    QRectF visibleScene = visibleSceneRect();
+
     for (NodesGuiList::const_iterator it = _imp->_nodes.begin(); it != _imp->_nodes.end(); ++it) {
+        NodePtr internalNode = (*it)->getNode();
+        bool isViewer = internalNode && internalNode->isEffectViewerNode();
+        if ( !isViewer && !(*it)->sceneBoundingRect().intersects(visibleScene) ) {
+            continue;
+        }
         (*it)->refreshRenderingIndicator();
     }
 }
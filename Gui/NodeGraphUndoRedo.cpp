@@ -25,6 +25,7 @@
 #include "NodeGraphUndoRedo.h"
 
 #include <algorithm> // min, max
+#include <set>
 #include <stdexcept>
 
 CLANG_DIAG_OFF(deprecated)
@@ -40,6 +41,7 @@ CLANG_DIAG_ON(uninitialized)
 #include "Engine/Project.h"
 #include "Engine/RotoLayer.h"
 #include "Engine/TimeLine.h"
+#include "Engine/UndoStateStore.h"
 #include "Engine/ViewerNode.h"
 #include "Engine/ViewerInstance.h"
 
@@ -154,9 +156,10 @@ AddMultipleNodesCommand::undo()
         if (!node) {
             continue;
         }
-        it->serialization.reset(new SERIALIZATION_NAMESPACE::NodeSerialization);
-        it->serialization->_encodeFlags = SERIALIZATION_NAMESPACE::NodeSerialization::eNodeSerializationFlagsSerializeOutputs;
-        node->toSerialization(it->serialization.get());
+        SERIALIZATION_NAMESPACE::NodeSerializationPtr serialization(new SERIALIZATION_NAMESPACE::NodeSerialization);
+        serialization->_encodeFlags = SERIALIZATION_NAMESPACE::NodeSerialization::eNodeSerializationFlagsSerializeOutputs;
+        node->toSerialization(serialization.get());
+        it->state = appPTR->getUndoStateStore()->storeNodeState(serialization);
         if (_nodes.size() == 1) {
             node->connectOutputsToMainInput();
         }
@@ -182,8 +185,10 @@ AddMultipleNodesCommand::redo()
         SERIALIZATION_NAMESPACE::NodeSerializationList serializationList;
 
         for (std::list<NodeToAdd>::iterator it = _nodes.begin(); it != _nodes.end(); ++it) {
-            assert(it->serialization && !it->node.lock());
-            serializationList.push_back(it->serialization);
+            assert(it->state && !it->node.lock());
+            SERIALIZATION_NAMESPACE::NodeSerializationPtr serialization = appPTR->getUndoStateStore()->fetchNodeState(it->state);
+            assert(serialization);
+            serializationList.push_back(serialization);
         }
         _graph->getGroup()->createNodesFromSerialization(serializationList, NodeCollection::eCreateNodesFromSerializationFlagsConnectToExternalNodes, &createdNodes);
 
@@ -240,8 +245,10 @@ RemoveMultipleNodesCommand::undo()
 
     SERIALIZATION_NAMESPACE::NodeSerializationList serializationList;
     for (std::list<NodeToRemove>::iterator it = _nodes.begin(); it != _nodes.end(); ++it) {
-        assert(it->serialization && !it->node.lock());
-        serializationList.push_back(it->serialization);
+        assert(it->state && !it->node.lock());
+        SERIALIZATION_NAMESPACE::NodeSerializationPtr serialization = appPTR->getUndoStateStore()->fetchNodeState(it->state);
+        assert(serialization);
+        serializationList.push_back(serialization);
     }
 
     
@@ -277,9 +284,10 @@ RemoveMultipleNodesCommand::redo()
         if (!node) {
             continue;
         }
-        it->serialization.reset(new SERIALIZATION_NAMESPACE::NodeSerialization);
-        it->serialization->_encodeFlags = SERIALIZATION_NAMESPACE::NodeSerialization::eNodeSerializationFlagsSerializeOutputs;
-        node->toSerialization(it->serialization.get());
+        SERIALIZATION_NAMESPACE::NodeSerializationPtr serialization(new SERIALIZATION_NAMESPACE::NodeSerialization);
+        serialization->_encodeFlags = SERIALIZATION_NAMESPACE::NodeSerialization::eNodeSerializationFlagsSerializeOutputs;
+        node->toSerialization(serialization.get());
+        it->state = appPTR->getUndoStateStore()->storeNodeState(serialization);
         if (_nodes.size() == 1) {
             node->connectOutputsToMainInput();
         }
@@ -644,19 +652,22 @@ typedef std::pair<NodeGuiPtr, QPointF> TreeNode; ///< all points are expressed a
 class Tree
 {
     std::list<TreeNode> nodes;
+    // Membership index of the nodes list, to make lookups logarithmic on large graphs
+    std::set<NodeGui*> nodesSet;
     QPointF topLevelNodeCenter; //< in scene coords
 
 public:
 
     Tree()
         : nodes()
+        , nodesSet()
         , topLevelNodeCenter(0, INT_MAX)
     {
     }
 
     void buildTree(const NodeGuiPtr & output,
-                   const NodesGuiList& selectedNodes,
-                   std::list<NodeGui*> & usedNodes)
+                   const std::set<NodeGui*>& selectedNodes,
+                   std::set<NodeGui*> & usedNodes)
     {
         QPointF outputPos = output->pos();
         QSize nodeSize = output->getSize();
@@ -690,19 +701,20 @@ private:
                  const QPointF & point)
     {
         nodes.push_back( std::make_pair(node, point) );
+        nodesSet.insert( node.get() );
     }
 
-    void buildTreeInternal(const NodesGuiList& selectedNodes,
-                           NodeGui* currentNode, const QPointF & currentNodeScenePos, std::list<NodeGui*> & usedNodes);
+    void buildTreeInternal(const std::set<NodeGui*>& selectedNodes,
+                           NodeGui* currentNode, const QPointF & currentNodeScenePos, std::set<NodeGui*> & usedNodes);
 };
 
 typedef std::list< boost::shared_ptr<Tree> > TreeList;
 
 void
-Tree::buildTreeInternal(const NodesGuiList& selectedNodes,
+Tree::buildTreeInternal(const std::set<NodeGui*>& selectedNodes,
                         NodeGui* currentNode,
                         const QPointF & currentNodeScenePos,
-                        std::list<NodeGui*> & usedNodes)
+                        std::set<NodeGui*> & usedNodes)
 {
     QSize nodeSize = currentNode->getSize();
     NodePtr internalNode = currentNode->getNode();
@@ -715,41 +727,23 @@ Tree::buildTreeInternal(const NodesGuiList& selectedNodes,
         NodeGuiPtr source = inputs[i]->getSource();
 
         ///Check if the source is selected
-        NodesGuiList::const_iterator foundSelected = std::find(selectedNodes.begin(), selectedNodes.end(), source);
-        if ( foundSelected == selectedNodes.end() ) {
+        if ( !source || !selectedNodes.count( source.get() ) ) {
             continue;
         }
 
-        if (source) {
+        {
             bool isMask = internalNode->getEffectInstance()->isInputMask(i);
+            bool alreadyInTree = nodesSet.count( source.get() );
             if (!firstNonMaskInput && !isMask) {
-                firstNonMaskInput = source;
-                for (std::list<TreeNode>::iterator it2 = nodes.begin(); it2 != nodes.end(); ++it2) {
-                    if (it2->first == firstNonMaskInput) {
-                        firstNonMaskInput.reset();
-                        break;
-                    }
+                if (!alreadyInTree) {
+                    firstNonMaskInput = source;
                 }
             } else if (!isMask) {
-                bool found = false;
-                for (std::list<TreeNode>::iterator it2 = nodes.begin(); it2 != nodes.end(); ++it2) {
-                    if (it2->first == source) {
-                        found = true;
-                        break;
-                    }
-                }
-                if (!found) {
+                if (!alreadyInTree) {
                     otherNonMaskInputs.push_back(source);
                 }
             } else if (isMask) {
-                bool found = false;
-                for (std::list<TreeNode>::iterator it2 = nodes.begin(); it2 != nodes.end(); ++it2) {
-                    if (it2->first == source) {
-                        found = true;
-                        break;
-                    }
-                }
-                if (!found) {
+                if (!alreadyInTree) {
                     maskInputs.push_back(source);
                 }
             } else {
@@ -761,9 +755,7 @@ Tree::buildTreeInternal(const NodesGuiList& selectedNodes,
 
 
     ///The node has already been processed in another tree, skip it.
-    if ( std::find(usedNodes.begin(), usedNodes.end(), currentNode) == usedNodes.end() ) {
-        ///mark it
-        usedNodes.push_back(currentNode);
+    if ( usedNodes.insert(currentNode).second ) {
 
 
         QPointF firstNonMaskInputPos;
@@ -856,6 +848,24 @@ hasNodeOutputsInList(const std::list<NodeGuiPtr >& nodes,
     return false;
 }
 
+// Same as hasNodeOutputsInList but with a precomputed set of the internal nodes, to
+// avoid a quadratic scan when rearranging large selections
+static bool
+hasNodeOutputsInSet(const std::set<NodePtr>& internalNodes,
+                    const NodeGuiPtr& node)
+{
+    NodePtr thisNode = node->getNode();
+    OutputNodesMap outputs;
+    thisNode->getOutputs(outputs);
+    for (OutputNodesMap::const_iterator it = outputs.begin(); it != outputs.end(); ++it) {
+        if ( (it->first != thisNode) && internalNodes.count(it->first) ) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 static bool
 hasNodeInputsInList(const std::list<NodeGuiPtr >& nodes,
                     const NodeGuiPtr& node)
@@ -900,7 +910,16 @@ RearrangeNodesCommand::RearrangeNodesCommand(const std::list<NodeGuiPtr > & node
     ///(the input that is at the highest position in the Y coordinate) is at the same
     ///Y level (node centers have the same Y)
 
-    std::list<NodeGui*> usedNodes;
+    std::set<NodeGui*> usedNodes;
+
+    // Index the selection so that the membership tests below are logarithmic: the naive
+    // list scans made rearranging a several-hundred-node graph take seconds.
+    std::set<NodeGui*> selectedSet;
+    std::set<NodePtr> selectedInternalNodes;
+    for (std::list<NodeGuiPtr >::const_iterator it = nodes.begin(); it != nodes.end(); ++it) {
+        selectedSet.insert( it->get() );
+        selectedInternalNodes.insert( (*it)->getNode() );
+    }
 
     ///A list of Tree
     ///Each tree is a lit of nodes with a boolean indicating if it was already positionned( "used" ) by another tree, if set to
@@ -909,9 +928,9 @@ RearrangeNodesCommand::RearrangeNodesCommand(const std::list<NodeGuiPtr > & node
     TreeList trees;
 
     for (std::list<NodeGuiPtr >::const_iterator it = nodes.begin(); it != nodes.end(); ++it) {
-        if ( !hasNodeOutputsInList( nodes, (*it) ) ) {
+        if ( !hasNodeOutputsInSet( selectedInternalNodes, (*it) ) ) {
             boost::shared_ptr<Tree> newTree(new Tree);
-            newTree->buildTree(*it, nodes, usedNodes);
+            newTree->buildTree(*it, selectedSet, usedNodes);
             trees.push_back(newTree);
         }
     }
@@ -1859,8 +1878,9 @@ RestoreNodeToDefaultCommand::RestoreNodeToDefaultCommand(const NodesGuiList & no
     for (NodesGuiList::const_iterator it = nodes.begin(); it != nodes.end(); ++it) {
         NodeDefaults d;
         d.node = *it;
-        d.serialization.reset(new SERIALIZATION_NAMESPACE::NodeSerialization);
-        (*it)->getNode()->toSerialization(d.serialization.get());
+        SERIALIZATION_NAMESPACE::NodeSerializationPtr serialization(new SERIALIZATION_NAMESPACE::NodeSerialization);
+        (*it)->getNode()->toSerialization(serialization.get());
+        d.state = appPTR->getUndoStateStore()->storeNodeState(serialization);
         _nodes.push_back(d);
     }
     setText(tr("Restore node(s) to default"));
@@ -1883,7 +1903,11 @@ RestoreNodeToDefaultCommand::undo()
         if (!internalNode) {
             continue;
         }
-        internalNode->loadKnobsFromSerialization(*it->serialization, false);
+        SERIALIZATION_NAMESPACE::NodeSerializationPtr serialization = appPTR->getUndoStateStore()->fetchNodeState(it->state);
+        assert(serialization);
+        if (serialization) {
+            internalNode->loadKnobsFromSerialization(*serialization, false);
+        }
     }
 }
 
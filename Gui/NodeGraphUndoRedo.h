@@ -111,7 +111,10 @@ private:
     {
 
         NodeWPtr node;
-        SERIALIZATION_NAMESPACE::NodeSerializationPtr serialization;
+
+        // The state of the node while it is destroyed by undo(), held in the
+        // UndoStateStore so that undo history is de-duplicated and memory capped
+        UndoNodeStatePtr state;
     };
 
     std::list<NodeToAdd> _nodes;
@@ -142,7 +145,10 @@ private:
     {
 
         NodeWPtr node;
-        SERIALIZATION_NAMESPACE::NodeSerializationPtr serialization;
+
+        // The state of the node while it is destroyed by redo(), held in the
+        // UndoStateStore so that undo history is de-duplicated and memory capped
+        UndoNodeStatePtr state;
     };
 
     std::list<NodeToRemove> _nodes;
@@ -507,7 +513,10 @@ private:
     struct NodeDefaults
     {
         NodeGuiWPtr node;
-        SERIALIZATION_NAMESPACE::NodeSerializationPtr serialization;
+
+        // The state of the node before the reset, held in the UndoStateStore so that
+        // undo history is de-duplicated and memory capped
+        UndoNodeStatePtr state;
     };
     
     std::list<NodeDefaults> _nodes;
@@ -511,6 +511,12 @@ NodeGui::createGui()
     _boundingBox = new NodeGraphRectItem(this, cornerRadiusPx);
     _boundingBox->setZValue(depth);
 
+    // Children are painted individually: cache the body rectangle in a device coordinate
+    // pixmap so that panning the graph (which only translates the items) blits the pixmap
+    // instead of re-painting the rounded rectangle of every node. The cache is invalidated
+    // by Qt when the item is update()d on a state change or when the view is zoomed.
+    _boundingBox->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
+
     if ( mustFrameName() ) {
         _nameFrame = new QGraphicsRectItem(this);
         _nameFrame->setZValue(depth + 1);
@@ -565,6 +571,10 @@ NodeGui::createGui()
     //_nameItem->setFont( QFont(appFont,appFontSize) );
     _nameItem->setZValue(depth + 1);
 
+    // Text layout is by far the most expensive part of the node painting: cache it like the
+    // body rectangle, it only changes when the label is renamed
+    _nameItem->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
+
     _persistentMessage = new NodeGraphSimpleTextItem(getDagGui(), this, false);
     _persistentMessage->setZValue(depth + 3);
     QFont f = _persistentMessage->font();
@@ -578,6 +588,7 @@ NodeGui::createGui()
 
     _stateIndicator = new NodeGraphRectItem(this, cornerRadiusPx);
     _stateIndicator->setZValue(depth - 1);
+    _stateIndicator->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
     _stateIndicator->hide();
 
     QRectF bbox = boundingRect();
@@ -216,4 +216,46 @@ const char *histogramMaximum_frag =
     "}\n"
 ;
 
+// Scatter pass used by the Histogram panel to bin an image on the GPU: one point is drawn per
+// pixel of the source texture; the vertex shader fetches the pixel, selects the channel and
+// positions the point on its bin, and additive blending accumulates the point counts.
+const char *histogramBinning_vert =
+    "uniform sampler2D Tex;\n"
+    "uniform vec2 texSize;\n"
+    // Channel codes match Histogram::DisplayModeEnum: 1 = A, 2 = Y, 3 = R, 4 = G, 5 = B
+    "uniform int channel;\n"
+    "uniform float vmin;\n"
+    "uniform float vmax;\n"
+    "void main()\n"
+    "{\n"
+    // gl_Vertex.xy holds the integer coordinates of the pixel to bin
+    "    vec4 c = texture2DLod( Tex, (gl_Vertex.xy + 0.5) / texSize, 0.0 );\n"
+    "    float sel = 0.0;\n"
+    "    if (channel == 1) {\n"
+    "        sel = c.a;\n"
+    "    } else if (channel == 2) {\n"
+    "        sel = 0.299 * c.r + 0.587 * c.g + 0.114 * c.b;\n"
+    "    } else if (channel == 3) {\n"
+    "        sel = c.r;\n"
+    "    } else if (channel == 4) {\n"
+    "        sel = c.g;\n"
+    "    } else if (channel == 5) {\n"
+    "        sel = c.b;\n"
+    "    }\n"
+    "    float t = (sel - vmin) / (vmax - vmin);\n"
+    "    if (t < 0.0 || t >= 1.0) {\n"
+    // The value is out of the histogram range: clip the point away
+    "        gl_Position = vec4(-2.0, -2.0, 0.0, 1.0);\n"
+    "    } else {\n"
+    "        gl_Position = vec4(t * 2.0 - 1.0, 0.0, 0.0, 1.0);\n"
+    "    }\n"
+    "}\n"
+;
+const char *histogramBinning_frag =
+    "void main()\n"
+    "{\n"
+    "    gl_FragColor = vec4(1.0, 1.0, 1.0, 1.0);\n"
+    "}\n"
+;
+
 NATRON_NAMESPACE_EXIT;
@@ -42,6 +42,8 @@ extern const char *histogramRendering_frag;
 extern const char *histogramRenderingVertex_vert;
 extern const char* minimal_vert;
 extern const char *histogramMaximum_frag;
+extern const char *histogramBinning_vert;
+extern const char *histogramBinning_frag;
 
 NATRON_NAMESPACE_EXIT;
 
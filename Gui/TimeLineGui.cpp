@@ -24,6 +24,7 @@
 
 #include "TimeLineGui.h"
 
+#include <algorithm>
 #include <cmath>
 #include <set>
 #include <stdexcept>
@@ -489,10 +490,11 @@ TimeLineGui::paintGL()
             QPoint mouseNumberWidgetCoord(currentPosBtmWidgetCoordX,
                                           currentPosBtmWidgetCoordY - cursorHeight);
             QPointF mouseNumberPos = toTimeLineCoordinates( mouseNumberWidgetCoord.x(), mouseNumberWidgetCoord.y() );
-            TimeLineKeysSet::iterator foundHoveredAsKeyframe = keyframes.find( TimeLineKey(hoveredTime) );
+            bool hoveredIsUserKey = false;
+            bool foundHoveredAsKeyframe = keyframes.findKey(hoveredTime, &hoveredIsUserKey);
             QColor currentColor;
-            if ( foundHoveredAsKeyframe != keyframes.end() ) {
-                if (foundHoveredAsKeyframe->isUserKey) {
+            if (foundHoveredAsKeyframe) {
+                if (hoveredIsUserKey) {
                     GL_GPU::Color4f(userkfR, userkfG, userkfB, 0.4);
                     currentColor.setRgbF( Image::clamp<qreal>(userkfR, 0., 1.),
                                           Image::clamp<qreal>(userkfG, 0., 1.),
@@ -523,10 +525,11 @@ TimeLineGui::paintGL()
         }
 
         //draw the bounds and the current time cursor
-        TimeLineKeysSet::iterator isCurrentTimeAKeyframe = keyframes.find( TimeLineKey(currentTime) );
+        bool currentTimeIsUserKey = false;
+        bool isCurrentTimeAKeyframe = keyframes.findKey(currentTime, &currentTimeIsUserKey);
         QColor actualCursorColor;
-        if ( isCurrentTimeAKeyframe != keyframes.end() ) {
-            if (isCurrentTimeAKeyframe->isUserKey) {
+        if (isCurrentTimeAKeyframe) {
+            if (currentTimeIsUserKey) {
                 GL_GPU::Color4f(userkfR, userkfG, userkfB, 1.);
                 actualCursorColor.setRgbF( Image::clamp<qreal>(userkfR, 0., 1.),
                                            Image::clamp<qreal>(userkfG, 0., 1.),
@@ -607,14 +610,38 @@ TimeLineGui::paintGL()
         glCheckError(GL_GPU);
         GL_GPU::Begin(GL_LINES);
 
-        std::list<TimeValue> cachedFrames;
+        CachedFramesBitset cachedFrames;
         _imp->viewerTab->getTimeLineCachedFrames(&cachedFrames);
-        for (std::list<TimeValue>::const_iterator i = cachedFrames.begin(); i != cachedFrames.end(); ++i) {
-            if ( ( *i >= btmLeft.x() ) && ( *i <= topRight.x() ) ) {
-                GL_GPU::Color4f(cachedR, cachedG, cachedB, 1.);
-
-                GL_GPU::Vertex2f((int)*i, cachedLineYPos);
-                GL_GPU::Vertex2f((int)*i + 1, cachedLineYPos);
+        if ( !cachedFrames.words.empty() ) {
+            GL_GPU::Color4f(cachedR, cachedG, cachedB, 1.);
+
+            // Only visit the frames within the visible time window, merging runs of
+            // consecutive cached frames in a single segment
+            SequenceTime visibleFirst = std::max( cachedFrames.firstFrame, (SequenceTime)std::ceil( btmLeft.x() ) );
+            SequenceTime visibleLast = std::min( (SequenceTime)(cachedFrames.firstFrame + cachedFrames.words.size() * 64 - 1), (SequenceTime)std::floor( topRight.x() ) );
+            SequenceTime runStart = 0;
+            bool inRun = false;
+            for (SequenceTime t = visibleFirst; t <= visibleLast; ++t) {
+                std::size_t i = (std::size_t)(t - cachedFrames.firstFrame);
+                if ( !inRun && (i % 64 == 0) && (cachedFrames.words[i / 64] == 0) ) {
+                    // Fast skip over 64 frames without any cached frame
+                    t += 63;
+                    continue;
+                }
+                if ( cachedFrames.isFrameCached(t) ) {
+                    if (!inRun) {
+                        runStart = t;
+                        inRun = true;
+                    }
+                } else if (inRun) {
+                    GL_GPU::Vertex2f(runStart, cachedLineYPos);
+                    GL_GPU::Vertex2f(t, cachedLineYPos);
+                    inRun = false;
+                }
+            }
+            if (inRun) {
+                GL_GPU::Vertex2f(runStart, cachedLineYPos);
+                GL_GPU::Vertex2f(visibleLast + 1, cachedLineYPos);
             }
         }
         GL_GPU::End();
@@ -623,14 +650,14 @@ TimeLineGui::paintGL()
         GL_GPU::Begin(GL_LINES);
         GL_GPU::Color4f(kfR, kfG, kfB, 1.);
         std::list<SequenceTime> remainingUserKeys;
-        for (TimeLineKeysSet::const_iterator i = keyframes.begin(); i != keyframes.end(); ++i) {
-            if ( ( i->frame >= btmLeft.x() ) && ( i->frame <= topRight.x() ) ) {
-                if (!i->isUserKey) {
-                    GL_GPU::Vertex2f(i->frame, lineYpos);
-                    GL_GPU::Vertex2f(i->frame + 1, lineYpos);
-                } else {
-                    remainingUserKeys.push_back(i->frame);
-                }
+        // Only visit the keys within the visible time window
+        for (std::size_t i = keyframes.lowerBound( (int)std::ceil( btmLeft.x() ) ); i < keyframes.size() && keyframes.getKeyFrame(i) <= topRight.x(); ++i) {
+            const int frame = keyframes.getKeyFrame(i);
+            if ( !keyframes.isUserKey(i) ) {
+                GL_GPU::Vertex2f(frame, lineYpos);
+                GL_GPU::Vertex2f(frame + 1, lineYpos);
+            } else {
+                remainingUserKeys.push_back(frame);
             }
         }
         GL_GPU::End();
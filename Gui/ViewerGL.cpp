@@ -31,6 +31,7 @@
 #include <stdexcept>
 
 #include <QThread>
+#include <QtConcurrentMap> // QtCore on Qt4, QtConcurrent on Qt5
 
 #if QT_VERSION >= 0x050000
 #include <QtWidgets/QMenu>
@@ -59,6 +60,7 @@ GCC_DIAG_UNUSED_PRIVATE_FIELD_ON
 #include "Engine/NodeGuiI.h"
 #include "Engine/Image.h"
 #include "Engine/ImagePrivate.h"
+#include "Engine/InteractionLatency.h"
 #include "Engine/Project.h"
 #include "Engine/OfxOverlayInteract.h"
 #include "Engine/KnobTypes.h"
@@ -94,6 +96,11 @@ GCC_DIAG_UNUSED_PRIVATE_FIELD_ON
 
 #define PERSISTENT_MESSAGE_LEFT_OFFSET_PIXELS 20
 
+// Number of pixel buffer objects cycled through by transferBufferFromRAMtoGPU(). With more than
+// one PBO the glTexSubImage2D transfer of a frame can still be in flight on the GPU whilst we
+// already memcpy the next frame into another buffer, making the upload an asynchronous DMA.
+#define NATRON_VIEWER_PBO_RING_SIZE 4
+
 #ifndef M_PI
 #define M_PI        3.14159265358979323846264338327950288   /* pi             */
 #endif
@@ -508,12 +515,24 @@ ViewerGL::paintGL()
 
                     GL_GPU::ActiveTexture(GL_TEXTURE0);
                     GL_GPU::BindTexture( GL_TEXTURE_2D, _imp->partialUpdateTextures[i].texture->getTexID() );
+
+                    // Like the main display texture, 32-bit float partial textures get the
+                    // gain/gamma/colorspace display transform at draw time
+                    const bool shaderBound = _imp->partialUpdateTextures[i].texture->getBitDepth() == eImageBitDepthFloat &&
+                                             !viewerNode->isAutoContrastEnabled() &&
+                                             _imp->activateShaderRGB();
+
                     GL_GPU::Begin(GL_POLYGON);
                     GL_GPU::TexCoord2d(0, 0); GL_GPU::Vertex2d(canonicalTexRect.x1, canonicalTexRect.y1);
                     GL_GPU::TexCoord2d(0, 1); GL_GPU::Vertex2d(canonicalTexRect.x1, canonicalTexRect.y2);
                     GL_GPU::TexCoord2d(1, 1); GL_GPU::Vertex2d(canonicalTexRect.x2, canonicalTexRect.y2);
                     GL_GPU::TexCoord2d(1, 0); GL_GPU::Vertex2d(canonicalTexRect.x2, canonicalTexRect.y1);
                     GL_GPU::End();
+
+                    if (shaderBound) {
+                        _imp->shaderRGB->release();
+                    }
+
                     GL_GPU::BindTexture(GL_TEXTURE_2D, 0);
                     
                     glCheckError(GL_GPU);
@@ -925,6 +944,7 @@ ViewerGL::getPboID(int index)
         GLuint handle;
         GL_GPU::GenBuffers(1, &handle);
         _imp->pboIds.push_back(handle);
+        _imp->pboAllocatedBytes.push_back(0);
 
         return handle;
     } else {
@@ -1086,6 +1106,19 @@ ViewerGL::removeViewerProcessHashAtTime(TimeValue time, ViewIdx view)
     }
 }
 
+// A chunk of the staging copy into the mapped PBO, see transferBufferFromRAMtoGPU()
+struct PboCopyChunk
+{
+    const unsigned char* src;
+    unsigned char* dst;
+    std::size_t bytesCount;
+};
+
+static void
+copyPboChunk(PboCopyChunk& chunk)
+{
+    std::memcpy(chunk.dst, chunk.src, chunk.bytesCount);
+}
 
 void
 ViewerGL::transferBufferFromRAMtoGPU(const TextureTransferArgs& args)
@@ -1102,7 +1135,7 @@ ViewerGL::transferBufferFromRAMtoGPU(const TextureTransferArgs& args)
     GL_GPU::GetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING_ARB, &currentBoundPBO);
     glCheckError(GL_GPU);
 
-    // We use 2 PBOs to make use of asynchronous data uploading
+    // We cycle through a ring of PBOs to make use of asynchronous data uploading
     GLuint pboId = getPboID(_imp->updateViewerPboIndex);
 
     assert(args.textureIndex == 0 || args.textureIndex == 1);
@@ -1134,6 +1167,17 @@ ViewerGL::transferBufferFromRAMtoGPU(const TextureTransferArgs& args)
 
 
     GLTexturePtr tex;
+
+    // When non 0, the key hash under which the uploaded texture is to be stored in the texture cache
+    U64 textureCacheKeyHash = 0;
+
+    // True if the frame could be re-displayed from a texture still resident in the texture cache
+    bool textureServedFromCache = false;
+
+    // True if this is a full frame replace: the pixels then go to the back texture set and are
+    // flipped to displayTextures once entirely resident, see comment on Implementation::backTextures
+    bool uploadToBackTexture = false;
+    TextureInfo backInfo;
     {
         QMutexLocker displayDataLocker(&_imp->displayDataMutex);
         if (args.type == TextureTransferArgs::eTextureTransferTypeOverlay) {
@@ -1166,16 +1210,71 @@ ViewerGL::transferBufferFromRAMtoGPU(const TextureTransferArgs& args)
             // Update time otherwise overlays won't refresh since we are not updating the displayTextures
             _imp->displayTextures[0].time = args.time;
             _imp->displayTextures[1].time = args.time;
+        } else if (args.type == TextureTransferArgs::eTextureTransferTypeReplace && args.image) {
+
+            // Full frame replace: build the new frame state in the back texture set. paintGL
+            // keeps sampling the front set until the flip below, so a repaint triggered while
+            // the transfer is in flight can never show a resized-but-not-yet-filled texture
+            // or half of a transfer.
+            uploadToBackTexture = true;
+            backInfo = _imp->backTextures[args.textureIndex];
+
+            // Fields that are not owned by the transfer keep their current display value
+            backInfo.premult = _imp->displayTextures[args.textureIndex].premult;
+            backInfo.pixelAspectRatio = _imp->displayTextures[args.textureIndex].pixelAspectRatio;
+            backInfo.rod = _imp->displayTextures[args.textureIndex].rod;
+            backInfo.format = _imp->displayTextures[args.textureIndex].format;
+
+            backInfo.colorPickerImage = args.colorPickerImage;
+            backInfo.colorPickerInputImage = args.colorPickerInputImage;
+            backInfo.isPartialImage = false;
+            backInfo.mipMapLevel = args.image->getMipMapLevel();
+            backInfo.time = args.time;
+            backInfo.isVisible = true;
+
+            // Try to serve the frame from the texture cache: if the texture uploaded for this
+            // image is still resident we can re-display it without any transfer.
+            if (args.viewerProcessNodeKey) {
+                textureCacheKeyHash = args.viewerProcessNodeKey->getHash();
+                if (!args.byPassCache) {
+                    GLTexturePtr cachedTexture = _imp->findCachedTexture(textureCacheKeyHash);
+                    if ( cachedTexture && (cachedTexture->getBitDepth() == bitdepth) ) {
+                        backInfo.texture = cachedTexture;
+                        backInfo.cacheKeyHash = textureCacheKeyHash;
+                        tex = cachedTexture;
+                        textureServedFromCache = true;
+                    }
+                }
+            }
+
+            if (!textureServedFromCache) {
+
+                if ( (backInfo.cacheKeyHash != 0) || !backInfo.texture || (backInfo.texture->getBitDepth() != bitdepth) ) {
+                    // Never upload in-place into a texture that is shared with the texture cache:
+                    // that would overwrite the pixels of the cache entry
+                    int format, internalFormat, glType;
+
+                    if (bitdepth == eImageBitDepthFloat) {
+                        Texture::getRecommendedTexParametersForRGBAFloatTexture(&format, &internalFormat, &glType);
+                    } else {
+                        Texture::getRecommendedTexParametersForRGBAByteTexture(&format, &internalFormat, &glType);
+                    }
+                    backInfo.texture.reset( new Texture(GL_TEXTURE_2D, GL_LINEAR, GL_NEAREST, GL_CLAMP_TO_EDGE, bitdepth, format, internalFormat, glType, true) );
+                    backInfo.cacheKeyHash = 0;
+                }
+                backInfo.texture->ensureTextureHasSize(imageData.bounds, 0);
+                tex = backInfo.texture;
+            }
         } else {
 
             if (args.type == TextureTransferArgs::eTextureTransferTypeReplace) {
+                // Replace with a NULL image: this input is disconnected for the viewer
                 _imp->displayTextures[args.textureIndex].colorPickerImage = args.colorPickerImage;
                 _imp->displayTextures[args.textureIndex].colorPickerInputImage = args.colorPickerInputImage;
-            }
-            // re-use the existing texture if possible
-            if (!args.image) {
                 _imp->displayTextures[args.textureIndex].isVisible = false;
-            } else {
+            } else if (args.image) {
+                // eTextureTransferTypeModify: progressive partial refreshes (e.g: while drawing)
+                // intentionally modify the displayed texture in-place
 
                 int format, internalFormat, glType;
 
@@ -1185,6 +1284,13 @@ ViewerGL::transferBufferFromRAMtoGPU(const TextureTransferArgs& args)
                     Texture::getRecommendedTexParametersForRGBAByteTexture(&format, &internalFormat, &glType);
                 }
 
+                if (_imp->displayTextures[args.textureIndex].cacheKeyHash != 0) {
+                    // A partial update must modify the texture in-place:
+                    // withdraw it from the texture cache instead
+                    _imp->removeTextureFromCache(_imp->displayTextures[args.textureIndex].cacheKeyHash);
+                    _imp->displayTextures[args.textureIndex].cacheKeyHash = 0;
+                }
+
                 if (_imp->displayTextures[args.textureIndex].texture->getBitDepth() != bitdepth) {
                     _imp->displayTextures[args.textureIndex].texture.reset( new Texture(GL_TEXTURE_2D, GL_LINEAR, GL_NEAREST, GL_CLAMP_TO_EDGE, bitdepth, format, internalFormat, glType, true) );
                 }
@@ -1192,7 +1298,7 @@ ViewerGL::transferBufferFromRAMtoGPU(const TextureTransferArgs& args)
                 tex = _imp->displayTextures[args.textureIndex].texture;
 
 
-                if (args.type == TextureTransferArgs::eTextureTransferTypeReplace || tex->getBounds().isNull()) {
+                if (tex->getBounds().isNull()) {
                     tex->ensureTextureHasSize(imageData.bounds, 0);
                 } else {
                     // If we just want to update a portion of the texture, check if we are inside the bounds of the texture, otherwise create a new one.
@@ -1220,7 +1326,6 @@ ViewerGL::transferBufferFromRAMtoGPU(const TextureTransferArgs& args)
                     }
                 }
 
-
                 _imp->displayTextures[args.textureIndex].isVisible = true;
                 _imp->displayTextures[args.textureIndex].mipMapLevel = args.image->getMipMapLevel();
                 _imp->displayTextures[args.textureIndex].time = args.time;
@@ -1249,6 +1354,15 @@ ViewerGL::transferBufferFromRAMtoGPU(const TextureTransferArgs& args)
         return;
     }
 
+    if (textureServedFromCache) {
+        // The pixels are already resident on the GPU, no transfer needed: only the
+        // flip below remains to be done
+        if (uploadToBackTexture) {
+            flipBackTextureToFront(args, backInfo);
+        }
+        return;
+    }
+
     // bind PBO to update texture source
     GL_GPU::BindBufferARB( GL_PIXEL_UNPACK_BUFFER_ARB, pboId );
 
@@ -1259,10 +1373,16 @@ ViewerGL::transferBufferFromRAMtoGPU(const TextureTransferArgs& args)
     // If you do that, the previous data in PBO will be discarded and
     // glMapBufferARB() returns a new allocated pointer immediately
     // even if GPU is still working with the previous data.
+    // We keep the buffer allocated at its high-water mark instead of sizing it to each frame:
+    // re-specifying the same size lets the driver rename the buffer (recycle the old storage
+    // once the pending transfer completed) instead of allocating fresh memory every frame.
     int dataSizeOf = getSizeOfForBitDepth(imageData.bitDepth);
     std::size_t bytesCount = imageData.bounds.area() * imageData.nComps * dataSizeOf;
     assert(bytesCount > 0);
-    GL_GPU::BufferDataARB(GL_PIXEL_UNPACK_BUFFER_ARB, bytesCount, NULL, GL_DYNAMIC_DRAW_ARB);
+    assert( _imp->updateViewerPboIndex < (int)_imp->pboAllocatedBytes.size() );
+    std::size_t& pboCapacity = _imp->pboAllocatedBytes[_imp->updateViewerPboIndex];
+    pboCapacity = std::max(pboCapacity, bytesCount);
+    GL_GPU::BufferDataARB(GL_PIXEL_UNPACK_BUFFER_ARB, pboCapacity, NULL, GL_DYNAMIC_DRAW_ARB);
 
     // map the buffer object into client's memory
     assert(QGLContext::currentContext() == context());
@@ -1272,7 +1392,25 @@ ViewerGL::transferBufferFromRAMtoGPU(const TextureTransferArgs& args)
     if (ret) {
         // update data directly on the mapped buffer
         unsigned char* srcpixels = Image::pixelAtStatic(imageData.bounds.x1, imageData.bounds.y1, imageData.bounds, imageData.nComps, dataSizeOf, (unsigned char*)imageData.ptrs[0]);
-        std::memcpy(ret, srcpixels, bytesCount);
+
+        // The staging copy of a full 4K float frame is a significant part of the frame budget at
+        // full-rate playback: split it across cores. The chunks are disjoint so the writes need
+        // no synchronization, and glUnmapBufferARB happens after all of them completed.
+        const std::size_t minBytesPerChunk = 4 * 1024 * 1024;
+        int idealThreadCount = std::max( 1, QThread::idealThreadCount() );
+        int nChunks = (int)std::min( (std::size_t)idealThreadCount, bytesCount / minBytesPerChunk );
+        if (nChunks > 1) {
+            std::vector<PboCopyChunk> chunks(nChunks);
+            std::size_t chunkSize = bytesCount / nChunks;
+            for (int i = 0; i < nChunks; ++i) {
+                chunks[i].src = srcpixels + i * chunkSize;
+                chunks[i].dst = (unsigned char*)ret + i * chunkSize;
+                chunks[i].bytesCount = (i == nChunks - 1) ? bytesCount - i * chunkSize : chunkSize;
+            }
+            QtConcurrent::blockingMap(chunks, copyPboChunk);
+        } else {
+            std::memcpy(ret, srcpixels, bytesCount);
+        }
         GLboolean result = GL_GPU::UnmapBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB); // release the mapped buffer
         assert(result == GL_TRUE);
         Q_UNUSED(result);
@@ -1289,10 +1427,48 @@ ViewerGL::transferBufferFromRAMtoGPU(const TextureTransferArgs& args)
     //glBindTexture(GL_TEXTURE_2D, 0); // why should we bind texture 0?
     glCheckError(GL_GPU);
 
-    _imp->updateViewerPboIndex = (_imp->updateViewerPboIndex + 1) % 2;
+    // Keep the uploaded texture alive in the texture cache so that looped playback can re-display
+    // it without another transfer
+    if (textureCacheKeyHash != 0) {
+        _imp->insertTextureInCache(textureCacheKeyHash, tex);
+        backInfo.cacheKeyHash = textureCacheKeyHash;
+    }
+
+    _imp->updateViewerPboIndex = (_imp->updateViewerPboIndex + 1) % NATRON_VIEWER_PBO_RING_SIZE;
+
+    if (uploadToBackTexture) {
+        flipBackTextureToFront(args, backInfo);
+    }
 
 } // ViewerGL::transferBufferFromRAMtoGPU
 
+void
+ViewerGL::flipBackTextureToFront(const TextureTransferArgs& args, const TextureInfo& backInfo)
+{
+    // The frame is entirely resident on the GPU: atomically flip the back texture to the
+    // front. The old front texture becomes the back buffer re-used by the next transfer.
+    {
+        QMutexLocker displayDataLocker(&_imp->displayDataMutex);
+        TextureInfo oldFront = _imp->displayTextures[args.textureIndex];
+        _imp->displayTextures[args.textureIndex] = backInfo;
+        _imp->backTextures[args.textureIndex] = oldFront;
+        // Do not retain the color picker images of the flipped-out frame
+        _imp->backTextures[args.textureIndex].colorPickerImage.reset();
+        _imp->backTextures[args.textureIndex].colorPickerInputImage.reset();
+    }
+    if (args.colorPickerImage) {
+        getViewerTab()->setImageFormat(args.textureIndex, args.colorPickerImage->getLayer(), args.colorPickerImage->getBitDepth());
+    }
+    setRegionOfDefinition(args.rod, backInfo.pixelAspectRatio, args.textureIndex);
+
+    Q_EMIT imageChanged(args.textureIndex);
+
+    // The frame is now the one sampled by paintGL: close the latency sample of the user
+    // interaction that triggered its render. The repaint that follows is issued
+    // synchronously by the caller.
+    InteractionLatencyTracker::notifyFrameDisplayed(args.interactionId);
+} // ViewerGL::flipBackTextureToFront
+
 
 void
 ViewerGL::disconnectInputTexture(int textureIndex, bool clearRoD)
@@ -52,6 +52,8 @@ CLANG_DIAG_ON(uninitialized)
 
 NATRON_NAMESPACE_ENTER;
 
+struct TextureInfo;
+
 typedef std::map<FrameViewPair, ImageCacheKeyPtr, FrameView_compare_less> ViewerCachedImagesMap;
 
 /**
@@ -469,6 +471,13 @@ private:
 
     void setParametricParamsPickerColor(const ColorRgba<double>& color, bool setColor, bool hasColor);
 
+    /**
+     *@brief Atomically publishes the given back texture state as the front display texture
+     * of args.textureIndex once its pixels are entirely resident on the GPU, then emits the
+     * notifications associated to the new frame. See transferBufferFromRAMtoGPU().
+     **/
+    void flipBackTextureToFront(const TextureTransferArgs& args, const TextureInfo& backInfo);
+
     int getMipMapLevelFromZoomFactor() const;
 
     bool checkIfViewPortRoIValidOrRenderForInput(int texIndex);
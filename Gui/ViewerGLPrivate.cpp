@@ -32,6 +32,7 @@
 
 #include <QThread>
 #include <QApplication> // qApp
+#include <QtCore/QDebug>
 #include "Global/GLIncludes.h" //!<must be included before QGLWidget
 #include <QtOpenGL/QGLWidget>
 #include <QtOpenGL/QGLShaderProgram>
@@ -47,6 +48,7 @@
 #include "Gui/Gui.h"
 #include "Gui/GuiApplicationManager.h" // appFont
 #include "Gui/Menu.h"
+#include "Gui/Shaders.h"
 #include "Gui/ViewerTab.h"
 
 #ifndef M_PI
@@ -69,6 +71,7 @@ ViewerGL::Implementation::Implementation(ViewerGL* this_,
                                          ViewerTab* parent)
     : _this(this_)
     , pboIds()
+    , pboAllocatedBytes()
     , vboVerticesId(0)
     , vboTexturesId(0)
     , iboTriangleStripId(0)
@@ -112,6 +115,9 @@ ViewerGL::Implementation::Implementation(ViewerGL* this_,
     , isUpdatingTexture(false)
     , renderOnPenUp(false)
     , updateViewerPboIndex(0)
+    , shaderRGB()
+    , textureCache()
+    , textureCacheSize(0)
 {
     infoViewer[0] = 0;
     infoViewer[1] = 0;
@@ -137,8 +143,12 @@ ViewerGL::Implementation::~Implementation()
 
     for (int i = 0; i < 2; ++i) {
         displayTextures[i].texture.reset();
+        backTextures[i].texture.reset();
     }
     partialUpdateTextures.clear();
+    shaderRGB.reset();
+    textureCache.clear();
+    textureCacheSize = 0;
 
     if ( appPTR && appPTR->isOpenGLLoaded() ) {
         glCheckError(GL_GPU);
@@ -229,6 +239,13 @@ ViewerGL::Implementation::drawRenderingVAO(unsigned int mipMapLevel,
     ViewerNodePtr internalNode = _this->getViewerTab()->getInternalNode();
     bool clipToDisplayWindow = internalNode->isClipToFormatEnabled();
 
+    // When the display texture is 32-bit floating point, ViewerInstance::render() did not bake in
+    // the gain/gamma/colorspace display transform: it is applied here by a fragment shader, so
+    // changing those parameters only requires a redraw instead of a CPU reconversion of the image.
+    // When auto-contrast is enabled the transform is still baked in on the CPU since it depends on
+    // an analysis of the image.
+    const bool useShader = this->displayTextures[textureIndex].texture->getBitDepth() == eImageBitDepthFloat && !internalNode->isAutoContrastEnabled();
+
     RectD rectClippedToRoI(canonicalRoIRoundedToTileSize);
     rectClippedToRoI.intersect(rod, &rectClippedToRoI);
 
@@ -287,6 +304,8 @@ ViewerGL::Implementation::drawRenderingVAO(unsigned int mipMapLevel,
             GL_GPU::GetIntegerv(GL_TEXTURE_BINDING_2D, (GLint*)&prevBoundTexture);
             GL_GPU::BindTexture( GL_TEXTURE_2D, displayTextures[textureIndex].texture->getTexID() );
 
+            const bool shaderBound = useShader && activateShaderRGB();
+
             GL_GPU::Begin(GL_POLYGON);
             for (int i = 0; i < polygonTexCoords.size(); ++i) {
                 const QPointF & tCoord = polygonTexCoords[i];
@@ -296,6 +315,10 @@ ViewerGL::Implementation::drawRenderingVAO(unsigned int mipMapLevel,
             }
             GL_GPU::End();
 
+            if (shaderBound) {
+                shaderRGB->release();
+            }
+
             GL_GPU::BindTexture( GL_TEXTURE_2D, prevBoundTexture);
 
         } else {
@@ -388,10 +411,16 @@ ViewerGL::Implementation::drawRenderingVAO(unsigned int mipMapLevel,
 
         GL_GPU::BindBuffer(GL_ARRAY_BUFFER, 0);
 
+        const bool shaderBound = useShader && activateShaderRGB();
+
         GL_GPU::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->iboTriangleStripId);
         GL_GPU::DrawElements(GL_TRIANGLE_STRIP, 28, GL_UNSIGNED_BYTE, 0);
         glCheckErrorIgnoreOSXBug(GL_GPU);
 
+        if (shaderBound) {
+            shaderRGB->release();
+        }
+
         GL_GPU::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
         GL_GPU::DisableClientState(GL_VERTEX_ARRAY);
         GL_GPU::DisableClientState(GL_TEXTURE_COORD_ARRAY);
@@ -449,6 +478,141 @@ ViewerGL::Implementation::initAndCheckGlExtensions()
     return true;
 }
 
+void
+ViewerGL::Implementation::initShaderGLSL()
+{
+    // always running in the main thread
+    assert( qApp && qApp->thread() == QThread::currentThread() );
+    assert( QGLContext::currentContext() == _this->context() );
+
+    if (shaderRGB) {
+        return;
+    }
+
+    shaderRGB.reset( new QGLShaderProgram( _this->context() ) );
+    if ( !shaderRGB->addShaderFromSourceCode(QGLShader::Vertex, vertRGB) ) {
+        qDebug() << qPrintable( shaderRGB->log() );
+    }
+    if ( !shaderRGB->addShaderFromSourceCode(QGLShader::Fragment, fragRGB) ) {
+        qDebug() << qPrintable( shaderRGB->log() );
+    }
+    if ( !shaderRGB->link() ) {
+        qDebug() << qPrintable( shaderRGB->log() );
+        shaderRGB.reset();
+    }
+}
+
+bool
+ViewerGL::Implementation::activateShaderRGB()
+{
+    // always running in the main thread
+    assert( qApp && qApp->thread() == QThread::currentThread() );
+
+    if (!shaderRGB) {
+        initShaderGLSL();
+    }
+    if (!shaderRGB) {
+        return false;
+    }
+
+    if ( !shaderRGB->bind() ) {
+        qDebug() << qPrintable( shaderRGB->log() );
+
+        return false;
+    }
+
+    ViewerNodePtr internalNode = _this->getViewerTab()->getInternalNode();
+
+    // The gain parameter is an exponent, like in ViewerInstance::render()
+    const double gain = std::pow( 2., internalNode->getGain() );
+    const double gamma = internalNode->getGamma();
+
+    // The lut uniform matches the branches of fragRGB: 0 = sRGB, 2 = Rec.709, anything else is linear
+    int lut;
+    switch ( internalNode->getColorspace() ) {
+    case eViewerColorSpaceSRGB:
+        lut = 0;
+        break;
+    case eViewerColorSpaceRec709:
+        lut = 2;
+        break;
+    case eViewerColorSpaceLinear:
+    default:
+        lut = 1;
+        break;
+    }
+
+    shaderRGB->setUniformValue("Tex", 0);
+    shaderRGB->setUniformValue( "gain", (float)gain );
+    shaderRGB->setUniformValue( "offset", (float)0. );
+    shaderRGB->setUniformValue("lut", lut);
+    shaderRGB->setUniformValue( "gamma", (float)gamma );
+
+    return true;
+}
+
+GLTexturePtr
+ViewerGL::Implementation::findCachedTexture(U64 keyHash)
+{
+    // always running in the main thread
+    assert( qApp && qApp->thread() == QThread::currentThread() );
+
+    for (std::list<CachedTexture>::iterator it = textureCache.begin(); it != textureCache.end(); ++it) {
+        if (it->keyHash == keyHash) {
+            CachedTexture entry = *it;
+            // Bump the entry to the front of the LRU list
+            textureCache.erase(it);
+            textureCache.push_front(entry);
+
+            return entry.texture;
+        }
+    }
+
+    return GLTexturePtr();
+}
+
+void
+ViewerGL::Implementation::insertTextureInCache(U64 keyHash, const GLTexturePtr& texture)
+{
+    // always running in the main thread
+    assert( qApp && qApp->thread() == QThread::currentThread() );
+    assert(texture);
+
+    const std::size_t budget = (std::size_t)appPTR->getCurrentSettings()->getViewerTextureCacheSizeMb() * 1024 * 1024;
+    if (budget == 0) {
+        // The texture cache is disabled in the preferences
+        return;
+    }
+
+    removeTextureFromCache(keyHash);
+
+    CachedTexture entry = {keyHash, texture};
+    textureCache.push_front(entry);
+    textureCacheSize += texture->getSize();
+
+    // Evict the least recently used textures until we fit in the budget. Note that an evicted
+    // texture is only deleted once the viewer no longer displays it.
+    while ( textureCacheSize > budget && !textureCache.empty() ) {
+        textureCacheSize -= textureCache.back().texture->getSize();
+        textureCache.pop_back();
+    }
+}
+
+void
+ViewerGL::Implementation::removeTextureFromCache(U64 keyHash)
+{
+    // always running in the main thread
+    assert( qApp && qApp->thread() == QThread::currentThread() );
+
+    for (std::list<CachedTexture>::iterator it = textureCache.begin(); it != textureCache.end(); ++it) {
+        if (it->keyHash == keyHash) {
+            textureCacheSize -= it->texture->getSize();
+            textureCache.erase(it);
+
+            return;
+        }
+    }
+}
 
 void
 ViewerGL::Implementation::getPolygonTextureCoordinates(const QPolygonF & polygonPoints,
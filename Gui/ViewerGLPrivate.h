@@ -87,6 +87,7 @@ struct TextureInfo
     , pixelAspectRatio(1.)
     , isPartialImage(false)
     , isVisible(false)
+    , cacheKeyHash(0)
     {
     }
 
@@ -107,6 +108,10 @@ struct TextureInfo
 
     // false if this input is disconnected for the viewer
     bool isVisible;
+
+    // When non 0, the texture is shared with the viewer texture cache and is stored in it under
+    // this key hash: it may not be mutated in-place by a subsequent upload
+    U64 cacheKeyHash;
 };
 
 struct ViewerGL::Implementation
@@ -121,6 +126,7 @@ struct ViewerGL::Implementation
     /////////////////////////////////////////////////////////
     // The following are only accessed from the main thread:
     std::vector<GLuint> pboIds; //!< PBO's id's used by the OpenGL context
+    std::vector<std::size_t> pboAllocatedBytes; //!< High-water mark of the storage allocated for each PBO in pboIds
     GLuint vboVerticesId; //!< VBO holding the vertices for the texture mapping.
     GLuint vboTexturesId; //!< VBO holding texture coordinates.
     GLuint iboTriangleStripId; /*!< IBOs holding vertices indexes for triangle strip sets*/
@@ -129,6 +135,13 @@ struct ViewerGL::Implementation
     mutable QMutex displayDataMutex;
 
     TextureInfo displayTextures[2]; /*!< A pointer to the textures that would be used if A and B are displayed*/
+
+    // The back buffer of displayTextures: a full frame replace transfers the pixels into this
+    // set while paintGL keeps sampling displayTextures, then the two are flipped atomically
+    // under displayDataMutex once the frame is entirely resident on the GPU. A repaint can
+    // therefore never observe a resized-but-not-yet-filled texture or half of a transfer.
+    // Only touched by transferBufferFromRAMtoGPU() on the main thread.
+    TextureInfo backTextures[2];
     std::vector<TextureInfo> partialUpdateTextures; /*!< Pointer to the partial rectangle textures overlayed onto the displayed texture when tracking*/
     InfoViewerWidget* infoViewer[2]; /*!< Pointer to the info bar below the viewer holding pixel/mouse/format related info*/
     ViewerTab* const viewerTab; /*!< Pointer to the viewer tab GUI*/
@@ -193,6 +206,25 @@ struct ViewerGL::Implementation
     // as with OSGLContext
     boost::shared_ptr<GuiGLContext> glContextWrapper;
 
+    // The shader applying the gain/gamma/colorspace display transform at draw time when the
+    // display texture is 32-bit floating point. Lazily created by activateShaderRGB()
+    boost::shared_ptr<QGLShaderProgram> shaderRGB;
+
+    struct CachedTexture
+    {
+        U64 keyHash;
+        GLTexturePtr texture;
+    };
+
+    // An LRU list (most recently used in front) of the textures uploaded for viewer process images,
+    // keyed by the hash of their image cache key. When looping over frames that are still resident,
+    // the display is fed straight from these textures, skipping the RAM to VRAM transfer.
+    // Only accessed from the main-thread; mutations require the OpenGL context to be current.
+    std::list<CachedTexture> textureCache;
+
+    // The VRAM (in bytes) taken by the textures in textureCache
+    std::size_t textureCacheSize;
+
 
 public:
 
@@ -230,12 +262,40 @@ public:
 
     void drawCheckerboardTexture(const QPolygonF& polygon);
 
+    /**
+     *@brief Binds the shaderRGB program and sets its uniforms from the current values of the
+     * viewer gain/gamma/colorspace parameters. Returns false if the shader could not be used.
+     **/
+    bool activateShaderRGB() WARN_UNUSED_RETURN;
+
+    /**
+     *@brief Returns the cached texture stored under the given key hash, or a NULL pointer if there
+     * is none, bumping the entry to the front of the LRU list.
+     **/
+    GLTexturePtr findCachedTexture(U64 keyHash);
+
+    /**
+     *@brief Stores the given texture in the texture cache under the given key hash, evicting the
+     * least recently used textures if the budget set in the preferences is exceeded.
+     **/
+    void insertTextureInCache(U64 keyHash, const GLTexturePtr& texture);
+
+    /**
+     *@brief Removes the entry stored under the given key hash from the texture cache, if any.
+     **/
+    void removeTextureFromCache(U64 keyHash);
+
 
 private:
     /**
      *@brief Checks extensions and init glew on windows. Called by  initializeGL()
      **/
     bool initAndCheckGlExtensions ();
+
+    /**
+     *@brief Compiles and links the shaderRGB program. Called by activateShaderRGB()
+     **/
+    void initShaderGLSL();
 };
 
 NATRON_NAMESPACE_EXIT;
@@ -265,7 +265,7 @@ ViewerTab::~ViewerTab()
 }
 
 void
-ViewerTab::getTimeLineCachedFrames(std::list<TimeValue>* cachedFrames) const
+ViewerTab::getTimeLineCachedFrames(CachedFramesBitset* cachedFrames) const
 {
     _imp->cachedFramesThread->getCachedFrames(cachedFrames);
 }
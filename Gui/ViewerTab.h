@@ -79,7 +79,7 @@ public:
 
     void getTimelineBounds(int* first, int* last) const;
 
-    void getTimeLineCachedFrames(std::list<TimeValue>* cachedFrames) const;
+    void getTimeLineCachedFrames(CachedFramesBitset* cachedFrames) const;
 
     virtual void notifyGuiClosing() OVERRIDE FINAL;
     virtual void onPanelMadeCurrent() OVERRIDE FINAL;
@@ -38,6 +38,7 @@ SUBDIRS += \
     Renderer \
     Gui \
     Tests \
+    Benchmarks \
     ProjectConverter \
     PythonBin \
     App
@@ -60,9 +61,10 @@ libmv.depends = gflags ceres
 openMVG.depends = ceres
 Serialization.depends = yaml-cpp
 Engine.depends = libmv openMVG HostSupport libtess ceres Serialization
-Renderer.depends = Engine
+Renderer.depends = Engine qhttpserver
 Gui.depends = Engine qhttpserver
 Tests.depends = Gui Engine
+Benchmarks.depends = Gui Engine
 App.depends = Gui Engine
 ProjectConverter.depends = Gui Engine
 
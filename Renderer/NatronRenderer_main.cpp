@@ -33,15 +33,83 @@
 #include <cstdio>  // perror
 #include <cstdlib> // exit
 #include <iostream>
+#include <string>
 
 #include <QtCore/QCoreApplication>
 
+#if defined(Q_OS_UNIX)
+#include <sys/resource.h> // getrusage
+#endif
+
+#include "Global/FStreamsSupport.h"
+
 #include "Engine/AppManager.h"
+#include "Engine/Cache.h"
 #include "Engine/CLArgs.h"
+#include "Engine/MemoryInfo.h" // getPeakRSS
+#include "Engine/Timer.h" // TimeLapse
 
 NATRON_NAMESPACE_USING
 
 
+static void
+writeCacheActivityJSON(FStreamsSupport::ofstream& ofile,
+                       const char* name,
+                       const CacheBasePtr& cache)
+{
+    CacheActivityStats stats;
+
+    cache->getActivityStats(&stats);
+    ofile << "  \"" << name << "\": {"
+          << "\"currentSizeBytes\": " << cache->getCurrentSize()
+          << ", \"hits\": " << stats.nHits
+          << ", \"misses\": " << stats.nMisses
+          << ", \"pendingWaits\": " << stats.nPendingWaits
+          << ", \"evictions\": " << stats.nEvictions
+          << "}";
+}
+
+/*
+ Write the process-wide performance metrics of this render as JSON, see the --perf-log
+ option. The A/B regression harness in tools/perf renders a manifest of projects with
+ this option and diffs the metrics against a stored baseline.
+ */
+static void
+writePerfLog(const std::string& filePath,
+             double wallTimeSec,
+             bool success)
+{
+    FStreamsSupport::ofstream ofile;
+
+    FStreamsSupport::open(&ofile, filePath);
+    if (!ofile) {
+        std::cerr << "Could not write the performance log to " << filePath << std::endl;
+
+        return;
+    }
+
+    // CPU time consumed by the whole process (all threads), user + system
+    double cpuTimeSec = 0.;
+#if defined(Q_OS_UNIX)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        cpuTimeSec = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec * 1e-6
+                     + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec * 1e-6;
+    }
+#endif
+
+    ofile << "{\n";
+    ofile << "  \"success\": " << (success ? "true" : "false") << ",\n";
+    ofile << "  \"wallTimeSeconds\": " << wallTimeSec << ",\n";
+    ofile << "  \"cpuTimeSeconds\": " << cpuTimeSec << ",\n";
+    ofile << "  \"peakRSSBytes\": " << getPeakRSS() << ",\n";
+    writeCacheActivityJSON( ofile, "tileCache", appPTR->getTileCache() );
+    ofile << ",\n";
+    writeCacheActivityJSON( ofile, "generalPurposeCache", appPTR->getGeneralPurposeCache() );
+    ofile << "\n}" << std::endl;
+}
+
+
 #ifdef Q_OS_WIN
 // g++ knows nothing about wmain
 // https://sourceforge.net/p/mingw-w64/wiki2/Unicode%20apps/
@@ -81,6 +149,10 @@ extern "C" {
     }
 #endif
 
+    // Started before loading so that the --perf-log wall time covers the whole run,
+    // startup included
+    TimeLapse wallTimer;
+
     CLArgs args(argc, argv, true);
 
     if (args.getError() > 0) {
@@ -91,16 +163,22 @@ extern "C" {
 
     // coverity[tainted_data]
 #ifdef Q_OS_WIN
-        if ( !manager.loadW(argc, argv, args) ) {
+    bool success = manager.loadW(argc, argv, args);
 #else
-        if ( !manager.load(argc, argv, args) ) {
+    bool success = manager.load(argc, argv, args);
 #endif
-        return 1;
-    } else {
-        return 0;
+
+    // In render farm worker mode the process stays alive serving render jobs over the
+    // worker http server until it is asked to quit, see RenderWorkerServer.
+    if ( success && (args.getWorkerPort() > 0) ) {
+        manager.exec();
+    }
+
+    if ( !args.getPerfLogFilePath().isEmpty() ) {
+        writePerfLog(args.getPerfLogFilePath().toStdString(), wallTimer.getTimeSinceCreation(), success);
     }
 
-    return 0;
+    return success ? 0 : 1;
 } //main
 #ifdef Q_OS_WIN
 } // extern "C"
@@ -25,18 +25,71 @@
 
 #include "CurveSerialization.h"
 
+#include <cmath>
+
 GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_OFF
 #include <yaml-cpp/yaml.h>
 GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 
 SERIALIZATION_NAMESPACE_ENTER;
 
+// A curve with at least this many keyframes is checked for the compact dense encoding
+#define CURVE_SERIALIZATION_DENSE_MIN_KEYS 10
+
+// Returns whether the keyframes all share the same interpolation and are spaced at a
+// uniform interval, in which case *step is set to that interval.
+static bool
+curveIsDense(const std::list<KeyFrameSerialization>& keys, double* step)
+{
+    if (keys.size() < CURVE_SERIALIZATION_DENSE_MIN_KEYS) {
+        return false;
+    }
+
+    std::list<KeyFrameSerialization>::const_iterator it = keys.begin();
+
+    // Free and broken keyframes carry derivatives which the dense encoding does not store
+    const std::string& interpolation = it->interpolation;
+    if (interpolation == kKeyframeSerializationTypeFree || interpolation == kKeyframeSerializationTypeBroken) {
+        return false;
+    }
+
+    double prevTime = it->time;
+    ++it;
+    *step = it->time - prevTime;
+    for (; it != keys.end(); ++it) {
+        if (it->interpolation != interpolation) {
+            return false;
+        }
+        if (std::abs( (it->time - prevTime) - *step ) > 1e-8) {
+            return false;
+        }
+        prevTime = it->time;
+    }
+
+    return true;
+} // curveIsDense
+
 void
 CurveSerialization::encode(YAML::Emitter& em) const
 {
     em << YAML::Flow;
     em << YAML::BeginSeq;
 
+    double denseStep;
+    if ( !keys.empty() && curveIsDense(keys, &denseStep) ) {
+        // Compact encoding: a single interpolation tag, the start time and the uniform
+        // interval replace the per-keyframe times, followed by the packed values.
+        em << kKeyframeSerializationDenseTag;
+        em << keys.front().interpolation;
+        em << keys.front().time;
+        em << denseStep;
+        for (std::list<KeyFrameSerialization>::const_iterator it = keys.begin(); it != keys.end(); ++it) {
+            em << it->value;
+        }
+        em << YAML::EndSeq;
+        return;
+    }
+
     std::string prevInterpolation; // No valid interpolation set yet
     for (std::list<KeyFrameSerialization>::const_iterator it = keys.begin(); it!=keys.end(); ++it) {
 
@@ -84,6 +137,25 @@ CurveSerialization::decode(const YAML::Node& node)
     if (node.size() == 0) {
         return;
     }
+
+    // Compact dense encoding, see encode(). The tag cannot be confused with an
+    // interpolation letter or a time.
+    if ( node.size() >= 4 && node[0].as<std::string>() == kKeyframeSerializationDenseTag ) {
+        KeyFrameSerialization keyframe;
+        keyframe.interpolation = node[1].as<std::string>();
+        keyframe.leftDerivative = keyframe.rightDerivative = 0.;
+
+        const double start = node[2].as<double>();
+        const double step = node[3].as<double>();
+        for (std::size_t i = 4; i < node.size(); ++i) {
+            keyframe.time = start + (i - 4) * step;
+            keyframe.value = node[i].as<double>();
+            keys.push_back(keyframe);
+        }
+
+        return;
+    }
+
     CurveDecodeStateEnum state = eCurveDecodeStateMayExpectInterpolation;
     std::string interpolation;
     KeyFrameSerialization keyframe;
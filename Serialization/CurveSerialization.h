@@ -39,6 +39,12 @@ SERIALIZATION_NAMESPACE_ENTER;
 #define kKeyframeSerializationTypeFree "F"
 #define kKeyframeSerializationTypeBroken "X"
 
+// Tag opening the compact encoding of a dense curve: a curve whose keyframes all share the
+// same interpolation and are spaced at a uniform interval (e.g: tracker or expression bakes
+// with a keyframe per frame) is written as [tag, interpolation, start, step, value...]
+// instead of one (time, value) pair per keyframe, see CurveSerialization::encode()
+#define kKeyframeSerializationDenseTag "D"
+
 /**
  * @brief Basically just the same as a Keyframe but without all member functions and extracted to remove any dependency to Natron.
  * This class i contained into CurveSerialization
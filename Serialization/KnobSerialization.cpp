@@ -750,7 +750,7 @@ KnobSerialization::checkForDefaultValueNode(const YAML::Node& node, const std::s
     if (dataTypeSet) {
         SerializationValueVariantTypeEnum type = dataTypeFromString(nodeType);
         if (type != _dataType) {
-            throw std::invalid_argument(_scriptName + ": Default value and value type differ!");
+            throw std::invalid_argument(_scriptName.str() + ": Default value and value type differ!");
         }
     } else {
         _dataType = dataTypeFromString(nodeType);
@@ -37,6 +37,7 @@
 #include "Serialization/CurveSerialization.h"
 #include "Serialization/SerializationBase.h"
 #include "Serialization/SerializationFwd.h"
+#include "Serialization/StringInterning.h"
 
 #define kInViewerContextItemLayoutSpacing "Spacing"
 #define kInViewerContextItemLayoutStretchAfter "Stretch"
@@ -404,8 +405,9 @@ class KnobSerialization
 
 public:
 
-    std::string _typeName; // used for user knobs only to re-create the appropriate knob type
-    std::string _scriptName; // the unique script-name of the knob
+    // Identifiers shared by many knobs are interned so all copies share their storage, see InternedString
+    InternedString _typeName; // used for user knobs only to re-create the appropriate knob type
+    InternedString _scriptName; // the unique script-name of the knob
     int _dimension; // the number of dimensions held by the knob
     bool _isSecret; // true if the knob is hidden, only serialized for user knob,s
     bool _disabled; // true if the knob is disabled, only serialized for user knobs
@@ -430,7 +432,7 @@ public:
     // The flag is useful to force a knob to be serialized as a user knob: i.e: all its description is
     // entirely saved. This is used in Natron when serializing a PyPlug
     bool _forceUserKnob;
-    std::string _label; // only serialized for user knobs
+    InternedString _label; // only serialized for user knobs
     std::string _iconFilePath[2]; // only serialized for user knobs
     bool _triggerNewLine; // only serialized for user knobs
     bool _evaluatesOnChange; // only serialized for user knobs
@@ -520,8 +522,8 @@ class GroupKnobSerialization
 public:
 
     std::list <boost::shared_ptr<KnobSerializationBase> > _children;
-    std::string _typeName;
-    std::string _name, _label;
+    InternedString _typeName;
+    InternedString _name, _label;
     bool _secret;
     bool _isSetAsTab; //< only valid for groups
     bool _isOpened; //< only for groups
@@ -62,9 +62,11 @@ HEADERS += \
     RotoStrokeItemSerialization.h \
     SettingsSerialization.h \
     SerializationBase.h \
+    SerializationBinary.h \
     SerializationFwd.h \
     SerializationIO.h \
     SerializationCompat.h \
+    StringInterning.h \
     WorkspaceSerialization.h
 
 
@@ -81,5 +83,7 @@ SOURCES += \
     RectDSerialization.cpp \
     RectISerialization.cpp \
     RotoStrokeItemSerialization.cpp \
+    SerializationBinary.cpp \
     SettingsSerialization.cpp \
+    StringInterning.cpp \
     WorkspaceSerialization.cpp
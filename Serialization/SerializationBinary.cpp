@@ -0,0 +1,275 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2013-2017 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "SerializationBinary.h"
+
+#include <cassert>
+#include <cstring>
+#include <map>
+#include <vector>
+
+#include <stdint.h>
+
+SERIALIZATION_NAMESPACE_ENTER
+
+// Bump when changing the encoding below. Old versions are refused with an
+// InvalidSerializationFileException, the YAML format remains the long-term interchange format.
+#define NATRON_BINARY_SERIALIZATION_VERSION 1
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+enum BinaryNodeTypeEnum
+{
+    eBinaryNodeTypeNull = 0,
+    eBinaryNodeTypeScalar = 1,
+    eBinaryNodeTypeSequence = 2,
+    eBinaryNodeTypeMap = 3
+};
+
+// All integers are written in little-endian order regardless of the host so that files can
+// travel between platforms.
+static void
+writeU32(std::ostream& stream, uint32_t v)
+{
+    char bytes[4] = {
+        (char)(v & 0xff),
+        (char)( (v >> 8) & 0xff ),
+        (char)( (v >> 16) & 0xff ),
+        (char)( (v >> 24) & 0xff )
+    };
+
+    stream.write(bytes, 4);
+}
+
+static uint32_t
+readU32(std::istream& stream)
+{
+    unsigned char bytes[4];
+
+    stream.read((char*)bytes, 4);
+    if (!stream) {
+        throw std::runtime_error("Corrupted binary serialization file");
+    }
+
+    return (uint32_t)bytes[0] | ( (uint32_t)bytes[1] << 8 ) | ( (uint32_t)bytes[2] << 16 ) | ( (uint32_t)bytes[3] << 24 );
+}
+
+static void
+writeStdString(std::ostream& stream, const std::string& str)
+{
+    writeU32( stream, (uint32_t)str.size() );
+    if ( !str.empty() ) {
+        stream.write( str.data(), str.size() );
+    }
+}
+
+static std::string
+readStdString(std::istream& stream)
+{
+    uint32_t size = readU32(stream);
+    std::string ret;
+
+    if (size > 0) {
+        ret.resize(size);
+        stream.read(&ret[0], size);
+        if (!stream) {
+            throw std::runtime_error("Corrupted binary serialization file");
+        }
+    }
+
+    return ret;
+}
+
+// Collect every scalar of the tree in the string table. Map keys and most values repeat a lot
+// across nodes and knobs, de-duplicating them is what roughly halves the file size compared to
+// the text format.
+static void
+collectScalars(const YAML::Node& node,
+               std::map<std::string, uint32_t>* table,
+               std::vector<const std::string*>* orderedStrings)
+{
+    if (node.IsScalar()) {
+        const std::string& s = node.Scalar();
+        if ( table->find(s) == table->end() ) {
+            std::pair<std::map<std::string, uint32_t>::iterator, bool> it = table->insert( std::make_pair( s, (uint32_t)orderedStrings->size() ) );
+            orderedStrings->push_back(&it.first->first);
+        }
+    } else if (node.IsSequence()) {
+        for (YAML::Node::const_iterator it = node.begin(); it != node.end(); ++it) {
+            collectScalars(*it, table, orderedStrings);
+        }
+    } else if (node.IsMap()) {
+        for (YAML::Node::const_iterator it = node.begin(); it != node.end(); ++it) {
+            collectScalars(it->first, table, orderedStrings);
+            collectScalars(it->second, table, orderedStrings);
+        }
+    }
+}
+
+static void
+encodeNode(std::ostream& stream,
+           const YAML::Node& node,
+           const std::map<std::string, uint32_t>& table)
+{
+    if (node.IsScalar()) {
+        stream.put( (char)eBinaryNodeTypeScalar );
+        std::map<std::string, uint32_t>::const_iterator found = table.find( node.Scalar() );
+        assert( found != table.end() );
+        writeU32(stream, found->second);
+    } else if (node.IsSequence()) {
+        stream.put( (char)eBinaryNodeTypeSequence );
+        writeU32( stream, (uint32_t)node.size() );
+        for (YAML::Node::const_iterator it = node.begin(); it != node.end(); ++it) {
+            encodeNode(stream, *it, table);
+        }
+    } else if (node.IsMap()) {
+        stream.put( (char)eBinaryNodeTypeMap );
+        writeU32( stream, (uint32_t)node.size() );
+        for (YAML::Node::const_iterator it = node.begin(); it != node.end(); ++it) {
+            encodeNode(stream, it->first, table);
+            encodeNode(stream, it->second, table);
+        }
+    } else {
+        // Undefined or null
+        stream.put( (char)eBinaryNodeTypeNull );
+    }
+}
+
+static YAML::Node
+decodeNode(std::istream& stream,
+           const std::vector<std::string>& table)
+{
+    int tag = stream.get();
+
+    if (!stream) {
+        throw std::runtime_error("Corrupted binary serialization file");
+    }
+    switch (tag) {
+        case eBinaryNodeTypeNull:
+
+            return YAML::Node(YAML::NodeType::Null);
+        case eBinaryNodeTypeScalar: {
+            uint32_t index = readU32(stream);
+            if ( index >= table.size() ) {
+                throw std::runtime_error("Corrupted binary serialization file");
+            }
+            YAML::Node ret;
+            ret = table[index];
+
+            return ret;
+        }
+        case eBinaryNodeTypeSequence: {
+            uint32_t size = readU32(stream);
+            YAML::Node ret(YAML::NodeType::Sequence);
+            for (uint32_t i = 0; i < size; ++i) {
+                ret.push_back( decodeNode(stream, table) );
+            }
+
+            return ret;
+        }
+        case eBinaryNodeTypeMap: {
+            uint32_t size = readU32(stream);
+            YAML::Node ret(YAML::NodeType::Map);
+            for (uint32_t i = 0; i < size; ++i) {
+                YAML::Node key = decodeNode(stream, table);
+                YAML::Node value = decodeNode(stream, table);
+                ret.force_insert(key, value);
+            }
+
+            return ret;
+        }
+        default:
+            throw std::runtime_error("Corrupted binary serialization file");
+    }
+}
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+bool
+isBinarySerializationStream(std::istream& stream)
+{
+    std::istream::pos_type pos = stream.tellg();
+    char magic[sizeof(NATRON_BINARY_SERIALIZATION_MAGIC) - 1];
+
+    stream.read( magic, sizeof(magic) );
+    bool isBinary = (bool)stream && std::memcmp( magic, NATRON_BINARY_SERIALIZATION_MAGIC, sizeof(magic) ) == 0;
+
+    stream.clear();
+    stream.seekg(pos);
+
+    return isBinary;
+}
+
+void
+writeBinaryNode(std::ostream& stream,
+                const YAML::Node& node,
+                const std::string& header)
+{
+    stream.write(NATRON_BINARY_SERIALIZATION_MAGIC, sizeof(NATRON_BINARY_SERIALIZATION_MAGIC) - 1);
+    writeU32(stream, NATRON_BINARY_SERIALIZATION_VERSION);
+    writeStdString(stream, header);
+
+    std::map<std::string, uint32_t> table;
+    std::vector<const std::string*> orderedStrings;
+    collectScalars(node, &table, &orderedStrings);
+
+    writeU32( stream, (uint32_t)orderedStrings.size() );
+    for (std::size_t i = 0; i < orderedStrings.size(); ++i) {
+        writeStdString(stream, *orderedStrings[i]);
+    }
+
+    encodeNode(stream, node, table);
+}
+
+YAML::Node
+readBinaryNode(const std::string& header,
+               std::istream& stream)
+{
+    {
+        char magic[sizeof(NATRON_BINARY_SERIALIZATION_MAGIC) - 1];
+        stream.read( magic, sizeof(magic) );
+        if ( !stream || std::memcmp( magic, NATRON_BINARY_SERIALIZATION_MAGIC, sizeof(magic) ) != 0 ) {
+            throw InvalidSerializationFileException();
+        }
+    }
+    uint32_t version = readU32(stream);
+    if (version == 0 || version > NATRON_BINARY_SERIALIZATION_VERSION) {
+        throw InvalidSerializationFileException();
+    }
+
+    std::string fileHeader = readStdString(stream);
+    if ( !header.empty() && (fileHeader != header) ) {
+        throw InvalidSerializationFileException();
+    }
+
+    uint32_t nStrings = readU32(stream);
+    std::vector<std::string> table(nStrings);
+    for (uint32_t i = 0; i < nStrings; ++i) {
+        table[i] = readStdString(stream);
+    }
+
+    return decodeNode(stream, table);
+}
+
+SERIALIZATION_NAMESPACE_EXIT
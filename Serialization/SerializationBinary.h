@@ -0,0 +1,99 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2013-2017 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef SERIALIZATIONBINARY_H
+#define SERIALIZATIONBINARY_H
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include "Global/Macros.h"
+
+#include "Serialization/SerializationIO.h"
+
+SERIALIZATION_NAMESPACE_ENTER
+
+// Magic bytes at the start of binary-encoded serialization files, also used to detect
+// the format when opening a file.
+#define NATRON_BINARY_SERIALIZATION_MAGIC "NtrnBinF"
+
+/**
+ * @brief Returns true if the stream starts with the binary serialization magic bytes.
+ * The stream read position is left unchanged.
+ **/
+bool isBinarySerializationStream(std::istream& stream);
+
+/**
+ * @brief Write the given document tree to the stream in the flat binary encoding:
+ * scalars are de-duplicated in a string table (keys repeat a lot across nodes/knobs, which
+ * is also what makes the text format so large) and the tree itself is a compact tag+index
+ * encoding that can be read back without the YAML text parser.
+ * @param header The same header string that would be written to the equivalent YAML file,
+ * stored in the file and matched again on read.
+ **/
+void writeBinaryNode(std::ostream& stream, const YAML::Node& node, const std::string& header);
+
+/**
+ * @brief Read back a document tree written with writeBinaryNode. Upon failure (wrong magic,
+ * version or header) an InvalidSerializationFileException is thrown; a truncated or corrupted
+ * file throws a std::runtime_error.
+ **/
+YAML::Node readBinaryNode(const std::string& header, std::istream& stream);
+
+/**
+ * @brief Write any serialization object to a binary encoded file.
+ * This is the binary counterpart of write() in SerializationIO.h, the YAML format remains
+ * the interchange format.
+ **/
+template <typename T>
+void writeBinary(std::ostream& stream, const T& obj, const std::string& header)
+{
+    // The serialization object model only knows how to encode itself to a YAML emitter:
+    // emit in memory and re-parse the document into a node tree that the binary codec can
+    // walk. The extra parse is paid once by the writer (which runs on a worker thread for
+    // projects); readers get a file that loads without the YAML text parser.
+    YAML::Emitter em;
+    obj.encode(em);
+    writeBinaryNode(stream, YAML::Load( em.c_str() ), header);
+}
+
+/**
+ * @brief Read any serialization object from a binary encoded file.
+ * This is the binary counterpart of read() in SerializationIO.h and throws the same
+ * InvalidSerializationFileException when the file does not match the expected header.
+ **/
+template <typename T>
+void readBinary(const std::string& header, std::istream& stream, T* obj)
+{
+    if (!obj) {
+        throw std::invalid_argument("Invalid serialization object");
+    }
+    YAML::Node node = readBinaryNode(header, stream);
+    obj->decode(node);
+}
+
+SERIALIZATION_NAMESPACE_EXIT
+
+#endif // SERIALIZATIONBINARY_H
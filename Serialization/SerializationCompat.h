@@ -1113,8 +1113,14 @@ SERIALIZATION_NAMESPACE::KnobSerialization::serialize(Archive & ar,
     _boostSerializationVersion = version;
     _mustSerialize = true;
 
-    ar & ::boost::serialization::make_nvp("Name", _scriptName);
-    ar & ::boost::serialization::make_nvp("Type", _typeName);
+    {
+        // Interned strings must be loaded through a temporary
+        std::string scriptName, typeName;
+        ar & ::boost::serialization::make_nvp("Name", scriptName);
+        ar & ::boost::serialization::make_nvp("Type", typeName);
+        _scriptName = scriptName;
+        _typeName = typeName;
+    }
     ar & ::boost::serialization::make_nvp("Dimension", _dimension);
 
     bool secret;
@@ -1314,7 +1320,12 @@ SERIALIZATION_NAMESPACE::KnobSerialization::serialize(Archive & ar,
 
         ar & ::boost::serialization::make_nvp("UserKnob", _isUserKnob);
         if (_isUserKnob) {
-            ar & ::boost::serialization::make_nvp("Label", _label);
+            {
+                // Interned strings must be loaded through a temporary
+                std::string label;
+                ar & ::boost::serialization::make_nvp("Label", label);
+                _label = label;
+            }
             ar & ::boost::serialization::make_nvp("Help", _tooltip);
             ar & ::boost::serialization::make_nvp("NewLine", _triggerNewLine);
             ar & ::boost::serialization::make_nvp("Evaluate", _evaluatesOnChange);
@@ -1432,10 +1443,18 @@ void
 SERIALIZATION_NAMESPACE::GroupKnobSerialization::serialize(Archive & ar, const unsigned int version)
 {
     if (version >= GROUP_KNOB_SERIALIZATION_INTRODUCES_TYPENAME) {
-        ar & ::boost::serialization::make_nvp("TypeName", _typeName);
+        // Interned strings must be loaded through a temporary
+        std::string typeName;
+        ar & ::boost::serialization::make_nvp("TypeName", typeName);
+        _typeName = typeName;
+    }
+    {
+        std::string name, label;
+        ar & ::boost::serialization::make_nvp("Name", name);
+        ar & ::boost::serialization::make_nvp("Label", label);
+        _name = name;
+        _label = label;
     }
-    ar & ::boost::serialization::make_nvp("Name", _name);
-    ar & ::boost::serialization::make_nvp("Label", _label);
     ar & ::boost::serialization::make_nvp("Secret", _secret);
     ar & ::boost::serialization::make_nvp("IsTab", _isSetAsTab);
     ar & ::boost::serialization::make_nvp("IsOpened", _isOpened);
@@ -1523,7 +1542,7 @@ SERIALIZATION_NAMESPACE::NodeSerialization::serialize(Archive & ar,
             continue;
         }
 
-        std::string stringParamName = (*it)->_scriptName + "Choice";
+        std::string stringParamName = (*it)->_scriptName.str() + "Choice";
         for (SERIALIZATION_NAMESPACE::KnobSerializationList::iterator it2 = _knobsValues.begin(); it2 != _knobsValues.end(); ++it2) {
             if ( (*it2)->_scriptName == stringParamName && (*it2)->_dataType == SERIALIZATION_NAMESPACE::eSerializationValueVariantTypeString) {
 
@@ -56,6 +56,7 @@ class RectDSerialization;
 class RectISerialization;
 class RotoContextSerialization;
 class RotoStrokeItemSerialization;
+class SerializationObjectBase;
 class TabWidgetSerialization;
 struct ValueSerialization;
 class ViewportData;
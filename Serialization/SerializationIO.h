@@ -27,8 +27,10 @@
 
 #include <istream>
 #include <ostream>
+#include <streambuf>
 #include <stdexcept>
 #include <locale>
+#include <cstddef>
 #include "Global/Macros.h"
 
 GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_OFF
@@ -59,6 +61,71 @@ void write(std::ostream& stream, const T& obj, const std::string& header)
     stream << em.c_str();
 }
 
+/**
+ * @brief A read-only stream buffer over an externally owned contiguous buffer, typically a
+ * memory-mapped file: the parser walks the buffer bytes in-place, whereas a file stream (or
+ * an istringstream constructed from the buffer) buffers its own copy of the document, which
+ * accounts for a large part of the peak memory footprint when opening big project files.
+ * The buffer must out-live the stream and is never written to.
+ **/
+class RawBufferStreamBuf : public std::streambuf
+{
+public:
+
+    RawBufferStreamBuf(const char* data, std::size_t size)
+    : std::streambuf()
+    {
+        // setg() wants non-const pointers but this buffer is read-only: no member ever writes to it
+        char* begin = const_cast<char*>(data);
+        setg(begin, begin, begin + size);
+    }
+
+private:
+
+    virtual pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) OVERRIDE FINAL
+    {
+        if ( !(which & std::ios_base::in) ) {
+            return pos_type( off_type(-1) );
+        }
+        char* newPos;
+        if (dir == std::ios_base::beg) {
+            newPos = eback() + off;
+        } else if (dir == std::ios_base::cur) {
+            newPos = gptr() + off;
+        } else {
+            newPos = egptr() + off;
+        }
+        if ( (newPos < eback()) || (newPos > egptr()) ) {
+            return pos_type( off_type(-1) );
+        }
+        setg(eback(), newPos, egptr());
+
+        return pos_type( off_type(newPos - eback()) );
+    }
+
+    virtual pos_type seekpos(pos_type pos, std::ios_base::openmode which) OVERRIDE FINAL
+    {
+        return seekoff(off_type(pos), std::ios_base::beg, which);
+    }
+};
+
+/**
+ * @brief An input stream reading in-place from an externally owned buffer, see RawBufferStreamBuf.
+ **/
+class RawBufferIStream : public std::istream
+{
+    RawBufferStreamBuf _buf;
+
+public:
+
+    RawBufferIStream(const char* data, std::size_t size)
+    : std::istream(0)
+    , _buf(data, size)
+    {
+        rdbuf(&_buf);
+    }
+};
+
 class InvalidSerializationFileException : public std::exception
 {
     std::string _what;
@@ -95,6 +162,11 @@ void read(const std::string& header, std::istream& stream, T* obj)
     {
         std::string firstLine;
         std::getline(stream, firstLine);
+        // The stream may carry the raw file bytes (e.g: a binary mode stream or a memory-mapped
+        // file): strip the carriage return of a file written on Windows so the header still matches
+        if ( !firstLine.empty() && (firstLine[firstLine.size() - 1] == '\r') ) {
+            firstLine.resize(firstLine.size() - 1);
+        }
         if (!header.empty()) {
             if (firstLine != header) {
                 throw InvalidSerializationFileException();
@@ -0,0 +1,67 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2013-2017 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#include "StringInterning.h"
+
+#include <map>
+
+#include <QtCore/QMutex>
+
+SERIALIZATION_NAMESPACE_ENTER;
+
+// Maps each distinct string to its canonical shared copy. The map key duplicates the storage of
+// the value, but since the table only ever contains the distinct identifiers (a few hundreds at
+// most) this is negligible compared to the thousands of per-knob copies it replaces.
+typedef std::map<std::string, boost::shared_ptr<const std::string> > InternTableMap;
+
+static InternTableMap internTable;
+static QMutex internTableMutex;
+
+boost::shared_ptr<const std::string>
+internString(const std::string& str)
+{
+    QMutexLocker k(&internTableMutex);
+    InternTableMap::iterator found = internTable.find(str);
+
+    if ( found == internTable.end() ) {
+        boost::shared_ptr<const std::string> canonical( new std::string(str) );
+        found = internTable.insert( std::make_pair(str, canonical) ).first;
+    }
+
+    return found->second;
+}
+
+InternedString::InternedString()
+    : _storage( internString( std::string() ) )
+{
+}
+
+InternedString::InternedString(const std::string& str)
+    : _storage( internString(str) )
+{
+}
+
+InternedString&
+InternedString::operator=(const std::string& str)
+{
+    _storage = internString(str);
+
+    return *this;
+}
+
+SERIALIZATION_NAMESPACE_EXIT;
@@ -0,0 +1,131 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2013-2017 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef SERIALIZATION_STRINGINTERNING_H
+#define SERIALIZATION_STRINGINTERNING_H
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include <string>
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/shared_ptr.hpp>
+#endif
+
+#include "Serialization/SerializationFwd.h"
+
+SERIALIZATION_NAMESPACE_ENTER;
+
+/**
+ * @brief Returns the process-wide canonical copy of the given string, creating it on the first
+ * call. The table is never purged: it is meant for identifiers that only take a bounded number
+ * of distinct values project-wide. This function is thread-safe.
+ **/
+boost::shared_ptr<const std::string> internString(const std::string& str);
+
+/**
+ * @brief A string whose storage is shared by all equal strings through the internString() table.
+ * Serialization structures hold one instance per knob of identifiers that only take a handful
+ * of distinct values project-wide (knob type names, script-names, labels...): interning them
+ * makes all copies point to the same heap block, cutting both the peak memory and the
+ * allocation count when loading or saving large projects.
+ *
+ * The class converts implicitly from and to std::string so that it can be dropped in place of
+ * a plain string member. Comparing two InternedString is a pointer comparison.
+ **/
+class InternedString
+{
+public:
+
+    InternedString();
+
+    InternedString(const std::string& str);
+
+    InternedString& operator=(const std::string& str);
+
+    operator const std::string&() const
+    {
+        return *_storage;
+    }
+
+    const std::string& str() const
+    {
+        return *_storage;
+    }
+
+    bool empty() const
+    {
+        return _storage->empty();
+    }
+
+    bool operator==(const InternedString& other) const
+    {
+        // The interning table guarantees that equal strings share their storage
+        return _storage == other._storage;
+    }
+
+    bool operator!=(const InternedString& other) const
+    {
+        return _storage != other._storage;
+    }
+
+    bool operator==(const std::string& other) const
+    {
+        return *_storage == other;
+    }
+
+    bool operator!=(const std::string& other) const
+    {
+        return *_storage != other;
+    }
+
+    bool operator==(const char* other) const
+    {
+        return *_storage == other;
+    }
+
+    bool operator!=(const char* other) const
+    {
+        return *_storage != other;
+    }
+
+private:
+
+    // Points into the interning table, never null
+    boost::shared_ptr<const std::string> _storage;
+};
+
+inline bool
+operator==(const std::string& lhs, const InternedString& rhs)
+{
+    return rhs == lhs;
+}
+
+inline bool
+operator!=(const std::string& lhs, const InternedString& rhs)
+{
+    return rhs != lhs;
+}
+
+SERIALIZATION_NAMESPACE_EXIT;
+
+#endif // SERIALIZATION_STRINGINTERNING_H
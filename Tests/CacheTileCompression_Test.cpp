@@ -0,0 +1,125 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2013-2017 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "Engine/CacheTileCompression.h"
+
+NATRON_NAMESPACE_USING
+
+static void
+roundTrip(const std::vector<unsigned char>& src)
+{
+    // Worst case LZ4 expansion is bounded by srcSize + srcSize / 255 + 16
+    std::vector<unsigned char> compressed(src.size() + src.size() / 255 + 16);
+    std::size_t compressedSize = CacheTileCompression::compress(src.empty() ? 0 : &src[0], src.size(), &compressed[0], compressed.size());
+    ASSERT_GT(compressedSize, 0u);
+
+    std::vector<unsigned char> decompressed( src.size() );
+    std::size_t decompressedSize = CacheTileCompression::decompress(&compressed[0], compressedSize, decompressed.empty() ? 0 : &decompressed[0], decompressed.size());
+    ASSERT_EQ(src.size(), decompressedSize);
+    if ( !src.empty() ) {
+        ASSERT_EQ( 0, std::memcmp(&src[0], &decompressed[0], src.size()) );
+    }
+}
+
+TEST(CacheTileCompression,
+     RoundTripConstant)
+{
+    std::vector<unsigned char> src(16384, 42);
+    roundTrip(src);
+}
+
+TEST(CacheTileCompression,
+     RoundTripPeriodic)
+{
+    std::vector<unsigned char> src(16384);
+    for (std::size_t i = 0; i < src.size(); ++i) {
+        src[i] = (unsigned char)(i % 7);
+    }
+    roundTrip(src);
+}
+
+TEST(CacheTileCompression,
+     RoundTripRandom)
+{
+    srand(2000);
+    std::vector<unsigned char> src(16384);
+    for (std::size_t i = 0; i < src.size(); ++i) {
+        // coverity[dont_call]
+        src[i] = (unsigned char)rand();
+    }
+    roundTrip(src);
+}
+
+TEST(CacheTileCompression,
+     RoundTripRandomSizes)
+{
+    srand(2001);
+    for (int attempt = 0; attempt < 100; ++attempt) {
+        // coverity[dont_call]
+        std::vector<unsigned char> src(rand() % 4096);
+        for (std::size_t i = 0; i < src.size(); ++i) {
+            // coverity[dont_call]
+            src[i] = (attempt % 2 == 0) ? (unsigned char)rand() : (unsigned char)(i % 11);
+        }
+        roundTrip(src);
+    }
+}
+
+TEST(CacheTileCompression,
+     IncompressibleDoesNotFit)
+{
+    srand(2002);
+    std::vector<unsigned char> src(16384);
+    for (std::size_t i = 0; i < src.size(); ++i) {
+        // coverity[dont_call]
+        src[i] = (unsigned char)rand();
+    }
+    // Random data does not compress: requesting a destination buffer of the source size must fail
+    std::vector<unsigned char> compressed( src.size() );
+    std::size_t compressedSize = CacheTileCompression::compress(&src[0], src.size(), &compressed[0], compressed.size());
+    ASSERT_EQ(0u, compressedSize);
+}
+
+TEST(CacheTileCompression,
+     CorruptedBlockFails)
+{
+    std::vector<unsigned char> src(16384, 42);
+    std::vector<unsigned char> compressed(src.size() + src.size() / 255 + 16);
+    std::size_t compressedSize = CacheTileCompression::compress(&src[0], src.size(), &compressed[0], compressed.size());
+    ASSERT_GT(compressedSize, 0u);
+
+    // Truncated blocks must be rejected, not crash
+    std::vector<unsigned char> decompressed( src.size() );
+    for (std::size_t truncated = 0; truncated + 1 < compressedSize; ++truncated) {
+        std::size_t decompressedSize = CacheTileCompression::decompress(&compressed[0], truncated, &decompressed[0], decompressed.size());
+        ASSERT_NE( src.size(), (std::size_t)decompressedSize );
+    }
+}
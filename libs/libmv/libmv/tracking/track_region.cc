@@ -136,6 +136,7 @@ TrackRegionOptions::TrackRegionOptions()
     : mode(TRANSLATION),
       minimum_correlation(0),
       max_iterations(20),
+      num_threads(1),
       use_esm(true),
       use_brute_initialization(true),
       attempt_refine_before_brute(true),
@@ -1254,6 +1255,28 @@ bool BruteTranslationOnlyInitialize(const FloatImage &image1,
   // Use Eigen on the images via maps for strong vectorization.
   Map<const FloatArray> search(image2.Data(), image2.Height(), image2.Width());
 
+  // When the mask is identically one over the pattern footprint, the windowed
+  // sum of the masked search image reduces to a plain box sum, which a summed
+  // area table turns into an O(1) lookup per shift instead of an O(w*h)
+  // reduction. This implements the TODO below for the common case; general
+  // masks keep the exact per-shift computation.
+  bool mask_is_all_ones = use_normalized_intensities &&
+                          (mask == 1.0f).all();
+  Eigen::ArrayXXd search_integral;
+  if (mask_is_all_ones) {
+    // Accumulate in double; a float table loses too much precision on large
+    // search areas.
+    search_integral = Eigen::ArrayXXd::Zero(image2.Height() + 1,
+                                            image2.Width() + 1);
+    for (int r = 0; r < image2.Height(); ++r) {
+      double row_sum = 0.0;
+      for (int c = 0; c < image2.Width(); ++c) {
+        row_sum += search(r, c);
+        search_integral(r + 1, c + 1) = search_integral(r, c + 1) + row_sum;
+      }
+    }
+  }
+
   // Try all possible locations inside the search area. Yes, everywhere.
   //
   // TODO(keir): There are a number of possible optimizations here. One choice
@@ -1285,8 +1308,17 @@ bool BruteTranslationOnlyInitialize(const FloatImage &image1,
         // TODO(keir): It's really dumb to recompute the search mean for every
         // shift. A smarter implementation would use summed area tables
         // instead, reducing the mean calculation to an O(1) operation.
-        double inverse_search_mean =
-            mask_sum / ((mask * search.block(r, c, h, w)).sum());
+        // EDIT: done above for the all-ones mask case.
+        double search_block_sum;
+        if (mask_is_all_ones) {
+          search_block_sum = search_integral(r + h, c + w)
+                           - search_integral(r, c + w)
+                           - search_integral(r + h, c)
+                           + search_integral(r, c);
+        } else {
+          search_block_sum = (mask * search.block(r, c, h, w)).sum();
+        }
+        double inverse_search_mean = mask_sum / search_block_sum;
         sad = (mask * (pattern - (search.block(r, c, h, w) *
                                   inverse_search_mean))).abs().sum();
       } else {
@@ -1501,6 +1533,7 @@ void TemplatedTrackRegion(const FloatImage &image1,
   ceres::Solver::Options solver_options;
   solver_options.linear_solver_type = ceres::DENSE_QR;
   solver_options.max_num_iterations = options.max_iterations;
+  solver_options.num_threads = options.num_threads;
   solver_options.update_state_every_iteration = true;
   solver_options.parameter_tolerance = 1e-16;
   solver_options.function_tolerance = 1e-16;
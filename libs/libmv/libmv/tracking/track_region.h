@@ -51,6 +51,10 @@ struct TrackRegionOptions {
   // Maximum number of Ceres iterations to run for the inner minimization.
   int max_iterations;
 
+  // Number of threads Ceres may use to evaluate the residuals of the inner
+  // minimization. Only effective when Ceres is built with OpenMP support.
+  int num_threads;
+
   // Use the "Efficient Second-order Minimization" scheme. This increases
   // convergence speed at the cost of more per-iteration work.
   bool use_esm;
@@ -0,0 +1,172 @@
+#!/usr/bin/env python
+# ***** BEGIN LICENSE BLOCK *****
+# This file is part of Natron <http://www.natron.fr/>,
+# Copyright (C) 2013-2017 INRIA and Alexandre Gauthier-Foichat
+#
+# Natron is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# Natron is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+# ***** END LICENSE BLOCK *****
+
+"""A/B performance regression harness for NatronRenderer.
+
+Renders a manifest of representative projects with NatronRenderer under pinned
+settings, records the performance metrics written by the --perf-log option
+(wall/CPU time, peak RSS, cache activity) and compares them against a stored
+baseline with a relative threshold. Intended to be run nightly:
+
+    perfRegression.py --renderer /path/to/NatronRenderer \\
+                      --manifest manifest.json --baseline baseline.json
+
+The first run (or any run with --update-baseline) stores the measured metrics
+as the new baseline. Subsequent runs exit non-zero if any project got slower
+or bigger than baseline by more than the threshold, so the nightly job fails
+before artists notice the slowdown.
+
+See manifest-example.json for the manifest format.
+"""
+
+from __future__ import print_function
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+import tempfile
+
+# Metrics diffed against the baseline: higher than baseline by more than the
+# threshold is a regression. Cache counters are recorded for investigation but
+# not thresholded: they vary legitimately with eviction timing.
+CHECKED_METRICS = ["wallTimeSeconds", "cpuTimeSeconds", "peakRSSBytes"]
+
+
+def render_project(renderer, entry, settings, verbose):
+    """Renders one manifest entry and returns the metrics dict from --perf-log."""
+    perf_log = tempfile.mktemp(suffix=".json", prefix="natron-perf-")
+    cmd = [renderer, "-b", "--no-settings", "--perf-log", perf_log]
+    for setting in settings:
+        cmd += ["--settings", setting]
+    if "writer" in entry:
+        cmd += ["-w", entry["writer"]]
+    if "frameRange" in entry:
+        cmd += [entry["frameRange"]]
+    cmd += entry.get("extraArgs", [])
+    cmd += [entry["project"]]
+
+    if verbose:
+        print("+ " + " ".join(cmd))
+    output = None if verbose else subprocess.PIPE
+    process = subprocess.Popen(cmd, stdout=output, stderr=output)
+    process.communicate()
+
+    try:
+        if process.returncode != 0 or not os.path.exists(perf_log):
+            return None
+        with open(perf_log) as f:
+            metrics = json.load(f)
+        if not metrics.get("success", False):
+            return None
+        return metrics
+    finally:
+        if os.path.exists(perf_log):
+            os.remove(perf_log)
+
+
+def diff_metrics(name, metrics, baseline_metrics, threshold):
+    """Returns the list of regression messages for one project."""
+    regressions = []
+    for metric in CHECKED_METRICS:
+        current = metrics.get(metric)
+        reference = baseline_metrics.get(metric)
+        if current is None or not reference:
+            continue
+        relative = (current - reference) / float(reference)
+        marker = "REGRESSION" if relative > threshold else "ok"
+        print("  %-16s %-14s %12.3f -> %12.3f (%+6.1f%%)"
+              % (metric, marker, reference, current, relative * 100.))
+        if relative > threshold:
+            regressions.append("%s: %s +%.1f%% (threshold %.1f%%)"
+                               % (name, metric, relative * 100., threshold * 100.))
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--renderer", required=True,
+                        help="path to the NatronRenderer binary")
+    parser.add_argument("--manifest", required=True,
+                        help="JSON manifest of projects to render")
+    parser.add_argument("--baseline", required=True,
+                        help="JSON file holding the baseline metrics")
+    parser.add_argument("--threshold", type=float, default=10.,
+                        help="relative regression threshold in percent (default: 10)")
+    parser.add_argument("--update-baseline", action="store_true",
+                        help="store the measured metrics as the new baseline")
+    parser.add_argument("--results",
+                        help="optionally write the measured metrics to this JSON file")
+    parser.add_argument("--verbose", action="store_true",
+                        help="show the renderer output")
+    args = parser.parse_args()
+
+    with open(args.manifest) as f:
+        manifest = json.load(f)
+
+    baseline = {}
+    if os.path.exists(args.baseline):
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+
+    threshold = args.threshold / 100.
+    results = {}
+    regressions = []
+    failures = []
+
+    for entry in manifest["projects"]:
+        name = entry["name"]
+        print("%s (%s):" % (name, entry["project"]))
+        metrics = render_project(args.renderer, entry, manifest.get("settings", []),
+                                 args.verbose)
+        if metrics is None:
+            print("  RENDER FAILED")
+            failures.append(name)
+            continue
+        results[name] = metrics
+        if name in baseline:
+            regressions += diff_metrics(name, metrics, baseline[name], threshold)
+        else:
+            print("  no baseline, recorded %.3fs wall / %.3fs cpu"
+                  % (metrics["wallTimeSeconds"], metrics["cpuTimeSeconds"]))
+
+    if args.results:
+        with open(args.results, "w") as f:
+            json.dump(results, f, indent=2, sort_keys=True)
+
+    if args.update_baseline or not baseline:
+        if not failures:
+            with open(args.baseline, "w") as f:
+                json.dump(results, f, indent=2, sort_keys=True)
+            print("Baseline written to " + args.baseline)
+        else:
+            print("Baseline NOT updated: some renders failed")
+
+    if failures:
+        print("FAILED renders: " + ", ".join(failures))
+    for regression in regressions:
+        print("REGRESSION: " + regression)
+
+    return 1 if (failures or regressions) else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())